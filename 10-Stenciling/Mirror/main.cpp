@@ -8,6 +8,7 @@
 #include "GeometryGenerator.h"
 #include "LightHelper.h"
 #include "MathHelper.h"
+#include "PlanarReflection.h"
 #include "RenderStates.h"
 #include "Vertex.h"
 #include "Waves.h"
@@ -70,6 +71,12 @@ private:
     UINT mSkullIndexCount;
     XMFLOAT3 mSkullTranslation;
 
+    // Bounding sphere of the skull model, before its world transform.
+    XMFLOAT3 mSkullCenter;
+    float mSkullRadius;
+
+    PlanarReflection mMirror;
+
     XMFLOAT4X4 mView;
     XMFLOAT4X4 mProj;
 
@@ -107,6 +114,7 @@ int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE prevInstance,
 
 App::App( HINSTANCE hInstance )
     : D3DApp( hInstance ), mRoomVB( 0 ), mSkullVB( 0 ), mSkullIB( 0 ), mSkullIndexCount( 0 ), mSkullTranslation( 0.0f, 1.0f, -5.0f ),
+    mSkullCenter( 0.0f, 0.0f, 0.0f ), mSkullRadius( 0.0f ),
     mFloorDiffuseMapSRV( 0 ), mWallDiffuseMapSRV( 0 ), mMirrorDiffuseMapSRV( 0 ),
     mEyePosW( 0.0f, 0.0f, 0.0f ), mRenderOptions( RenderOptions::Textures ),
     mTheta( 1.24f*MathHelper::Pi ), mPhi( 0.42f*MathHelper::Pi ), mRadius( 12.0f )
@@ -154,6 +162,15 @@ App::App( HINSTANCE hInstance )
     mShadowMat.ambient = XMFLOAT4( 0.0f, 0.0f, 0.0f, 1.0f );
     mShadowMat.diffuse = XMFLOAT4( 0.0f, 0.0f, 0.0f, 0.5f );
     mShadowMat.specular = XMFLOAT4( 0.0f, 0.0f, 0.0f, 16.0f );
+
+    // The mirror quad of the room vertex buffer.
+    const XMFLOAT3 mirrorCorners[PlanarReflection::MirrorCorners] = {
+        XMFLOAT3( -2.5f, 0.0f, 0.0f ),
+        XMFLOAT3( -2.5f, 4.0f, 0.0f ),
+        XMFLOAT3( 2.5f, 4.0f, 0.0f ),
+        XMFLOAT3( 2.5f, 0.0f, 0.0f )
+    };
+    mMirror.SetMirror( mirrorCorners, XMFLOAT3( 0.0f, 0.0f, -1.0f ) );
 }
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -297,6 +314,9 @@ void App::updateScene( const float dt )
 
 void App::drawScene( void )
 {
+    // Picks up edits to the .fx files while the demo runs.
+    Effects::ReloadChanged();
+
     mD3DImmediateContext->ClearRenderTargetView( mRenderTargetView,
                                                  reinterpret_cast<const float*>( &Colors::Black ) );
     mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView,
@@ -315,6 +335,14 @@ void App::drawScene( void )
     XMMATRIX proj = XMLoadFloat4x4( &mProj );
     const XMMATRIX viewProj = view * proj;
 
+    // The mirror and its reflection are only drawn when the mirror faces
+    // the camera, is on screen, and the reflected skull can show in it.
+    // The skull's world transform scales it by 0.45.
+    XMFLOAT3 skullCenter;
+    XMStoreFloat3( &skullCenter, XMVector3Transform( XMLoadFloat3( &mSkullCenter ), XMLoadFloat4x4( &mSkullWorld ) ) );
+    const bool drawReflection = mMirror.Update( mEyePosW, view, proj ) &&
+                                mMirror.IsSphereVisible( skullCenter, 0.45f * mSkullRadius );
+
     // Set per-frame constants.
     Effects::BasicFX->SetDirLights( mDirLights );
     Effects::BasicFX->SetEyePosW( mEyePosW );
@@ -402,7 +430,7 @@ void App::drawScene( void )
     // Draw the mirror into the stencil buffer only.
 
     tech->GetDesc( &techDesc );
-    for ( UINT p = 0; p < techDesc.Passes; ++p ) {
+    for ( UINT p = 0; drawReflection && p < techDesc.Passes; ++p ) {
         ID3DX11EffectPass* pass = tech->GetPassByIndex( 0 );
 
         mD3DImmediateContext->IASetVertexBuffers( 0, 1, &mRoomVB, &stride, &offset );
@@ -439,18 +467,19 @@ void App::drawScene( void )
     // Draw skull reflection to back buffer.
 
     activeSkullTech->GetDesc( &techDesc );
-    for ( UINT p = 0; p < techDesc.Passes; ++p ) {
+    for ( UINT p = 0; drawReflection && p < techDesc.Passes; ++p ) {
         ID3DX11EffectPass* pass = activeSkullTech->GetPassByIndex( p );
 
         mD3DImmediateContext->IASetVertexBuffers( 0, 1, &mSkullVB, &stride, &offset );
         mD3DImmediateContext->IASetIndexBuffer( mSkullIB, DXGI_FORMAT_R32_UINT, 0 );
 
-        XMVECTOR mirrorPlane = XMVectorSet( 0.0f, 0.0f, 1.0f, 0.0f ); // xy plane
-        XMMATRIX R = XMMatrixReflect( mirrorPlane );
-        //XMMATRIX world = XMMatrixRotationY( MathHelper::Pi ) * XMLoadFloat4x4( &mSkullWorld )  * R;
+        XMMATRIX R = mMirror.GetReflection();
         XMMATRIX world = XMLoadFloat4x4( &mSkullWorld ) * R;
         XMMATRIX worldInvTranspose = MathHelper::InverseTranspose( world );
-        XMMATRIX worldViewProj = world*view*proj;
+
+        // The reflected camera's oblique near plane is the mirror, so
+        // nothing behind it comes through.
+        XMMATRIX worldViewProj = XMLoadFloat4x4( &mSkullWorld ) * mMirror.GetReflectedViewProj();
 
         Effects::BasicFX->SetWorld( world );
         Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
@@ -511,10 +540,17 @@ void App::drawScene( void )
         Effects::BasicFX->SetMaterial( mMirrorMat );
         Effects::BasicFX->SetDiffuseMap( mMirrorDiffuseMapSRV );
 
-        // Mirror
+        // Mirror. Over a reflection, only the marked pixels are blended and
+        // the depth test is skipped: the reflection's oblique depth is
+        // nearer than the mirror.
         mD3DImmediateContext->OMSetBlendState( RenderStates::TransparentBS, blendFactor, 0xffffffff );
+        if ( drawReflection ) {
+            mD3DImmediateContext->OMSetDepthStencilState( RenderStates::DrawMirrorDSS, 1 );
+        }
         pass->Apply( 0, mD3DImmediateContext );
         mD3DImmediateContext->Draw( 6, 24 );
+
+        mD3DImmediateContext->OMSetDepthStencilState( nullptr, 0 );
     }
 
     // Draw skull shadow.
@@ -701,12 +737,27 @@ void App::BuildSkullGeometryBuffers( void )
     fin >> ignore >> ignore >> ignore >> ignore;
 
     std::vector<Vertex::Basic32> vertices( vcount );
+    XMFLOAT3 vMin( +MathHelper::Infinity, +MathHelper::Infinity, +MathHelper::Infinity );
+    XMFLOAT3 vMax( -MathHelper::Infinity, -MathHelper::Infinity, -MathHelper::Infinity );
     for ( UINT i = 0; i < vcount; ++i )
     {
         fin >> vertices[i].pos.x >> vertices[i].pos.y >> vertices[i].pos.z;
         fin >> vertices[i].normal.x >> vertices[i].normal.y >> vertices[i].normal.z;
+
+        vMin = XMFLOAT3( MathHelper::Min( vMin.x, vertices[i].pos.x ),
+                         MathHelper::Min( vMin.y, vertices[i].pos.y ),
+                         MathHelper::Min( vMin.z, vertices[i].pos.z ) );
+        vMax = XMFLOAT3( MathHelper::Max( vMax.x, vertices[i].pos.x ),
+                         MathHelper::Max( vMax.y, vertices[i].pos.y ),
+                         MathHelper::Max( vMax.z, vertices[i].pos.z ) );
     }
 
+    // A sphere around the bounding box, for culling the reflection.
+    mSkullCenter = XMFLOAT3( 0.5f * ( vMin.x + vMax.x ), 0.5f * ( vMin.y + vMax.y ), 0.5f * ( vMin.z + vMax.z ) );
+    mSkullRadius = 0.5f * sqrtf( ( vMax.x - vMin.x ) * ( vMax.x - vMin.x ) +
+                                 ( vMax.y - vMin.y ) * ( vMax.y - vMin.y ) +
+                                 ( vMax.z - vMin.z ) * ( vMax.z - vMin.z ) );
+
     fin >> ignore;
     fin >> ignore;
     fin >> ignore;
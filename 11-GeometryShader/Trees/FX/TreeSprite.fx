@@ -59,7 +59,7 @@ struct GeoOut {
     float3 PosW : POSITION;
     float3 NormalW : NORMAL;
     float2 Tex : TEXCOORD;
-    uint PrimID : SV_PrimitiveID;
+    nointerpolation uint TreeType : TREETYPE;
 };
 
 // ================================================= //
@@ -80,7 +80,6 @@ VertexOut VS( VertexIn vin )
 // We output a max of 4 vertices per tree.
 [maxvertexcount(4)]
 void GS( point VertexOut gin[1],
-         uint primID : SV_PrimitiveID,
          inout TriangleStream<GeoOut> triStream )
 {
     //
@@ -99,6 +98,12 @@ void GS( point VertexOut gin[1],
     float halfWidth = 0.5f * gin[0].SizeW.x;
     float halfHeight = 0.5f * gin[0].SizeW.y;
 
+    //
+    // Pick the texture from where the tree stands rather than its place in
+    // the draw, which changes as trees are culled and sorted each frame.
+
+    uint treeType = ( asuint( gin[0].CenterW.x ) * 73856093u ^ asuint( gin[0].CenterW.z ) * 19349663u ) % 4;
+
     float4 v[4];
     v[0] = float4( gin[0].CenterW + halfWidth * right - halfHeight * up, 1.f );
     v[1] = float4( gin[0].CenterW + halfWidth * right + halfHeight * up, 1.0f );
@@ -115,7 +120,7 @@ void GS( point VertexOut gin[1],
         gout.PosW = v[i].xyz;
         gout.NormalW = look;
         gout.Tex = gTexC[i];
-        gout.PrimID = primID;
+        gout.TreeType = treeType;
 
         triStream.Append( gout );
     }
@@ -146,7 +151,7 @@ float4 PS( GeoOut pin,
     if ( gUseTexure )
     {
         // Sample texture.
-        float3 uvw = float3( pin.Tex, pin.PrimID % 4 );
+        float3 uvw = float3( pin.Tex, pin.TreeType );
         texColor = gTreeMapArray.Sample( samLinear, uvw );
 
         if ( gAlphaClip )
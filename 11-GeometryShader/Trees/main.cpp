@@ -2,13 +2,19 @@
 /// \file main.cpp
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
+#include <cstring>
+#include <vector>
+
 #include "D3DApp.h"
 #include "d3dx11Effect.h"
+#include "DynamicRingBuffer.h"
 #include "Effects.h"
 #include "GeometryGenerator.h"
+#include "JobSystem.h"
 #include "LightHelper.h"
 #include "MathHelper.h"
 #include "RenderStates.h"
+#include "Vegetation.h"
 #include "Vertex.h"
 #include "Waves.h"
 
@@ -16,6 +22,8 @@
 
 using namespace DirectX;
 
+static_assert( sizeof( VegetationSprite ) == sizeof( Vertex::TreePointSprite ), "Visible trees are copied straight into the vertex buffer" );
+
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
 enum RenderOptions {
@@ -49,7 +57,7 @@ private:
     void BuildLandGeometryBuffers();
     void BuildWaveGeometryBuffers();
     void BuildCrateGeometryBuffers();
-    void BuildTreeSpritesBuffer();
+    void PlaceTrees();
     void DrawTreeSprites( CXMMATRIX viewProj );
 
 private:
@@ -63,7 +71,15 @@ private:
     ID3D11Buffer* mBoxVB;
     ID3D11Buffer* mBoxIB;
 
-    ID3D11Buffer* mTreeSpritesVB;
+    // The trees in view this frame, nearest first.
+    Vegetation mVegetation;
+    std::vector<VegetationSprite> mVisibleTrees;
+    DynamicRingBuffer mTreeSpritesVB;
+
+    // Frustum planes the trees are culled with, and the view-projection
+    // they were taken from; the camera only moves while it is dragged.
+    XMFLOAT4X4 mCullViewProj;
+    XMFLOAT4 mCullPlanes[6];
 
     ID3D11ShaderResourceView* mGrassMapSRV;
     ID3D11ShaderResourceView* mWavesMapSRV;
@@ -91,8 +107,6 @@ private:
 
     XMFLOAT2 mWaterTexOffset;
 
-    static const UINT TreeCount = 16;
-
     bool mAlphaToCoverageOn;    
 
     RenderOptions mRenderOptions;
@@ -126,7 +140,7 @@ int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE prevInstance,
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
 App::App( HINSTANCE hInstance )
-    : D3DApp( hInstance ), mLandVB( 0 ), mLandIB( 0 ), mWavesVB( 0 ), mWavesIB( 0 ), mBoxVB( 0 ), mBoxIB( 0 ), mTreeSpritesVB( 0 ),
+    : D3DApp( hInstance ), mLandVB( 0 ), mLandIB( 0 ), mWavesVB( 0 ), mWavesIB( 0 ), mBoxVB( 0 ), mBoxIB( 0 ),
     mGrassMapSRV( 0 ), mWavesMapSRV( 0 ), mBoxMapSRV( 0 ), mAlphaToCoverageOn( true ),
     mWaterTexOffset( 0.0f, 0.0f ), mEyePosW( 0.0f, 0.0f, 0.0f ), mLandIndexCount( 0 ), mRenderOptions( RenderOptions::TexturesAndFog ),
     mTheta( 1.3f*MathHelper::Pi ), mPhi( 0.4f*MathHelper::Pi ), mRadius( 80.0f )
@@ -142,6 +156,11 @@ App::App( HINSTANCE hInstance )
     XMStoreFloat4x4( &mView, I );
     XMStoreFloat4x4( &mProj, I );
 
+    // No camera has a zero view-projection, so the first frame takes its
+    // planes.
+    ZeroMemory( &mCullViewProj, sizeof( mCullViewProj ) );
+    ZeroMemory( mCullPlanes, sizeof( mCullPlanes ) );
+
     XMMATRIX boxScale = XMMatrixScaling( 15.0f, 15.0f, 15.0f );
     XMMATRIX boxOffset = XMMatrixTranslation( 8.0f, 5.0f, -15.0f );
     XMStoreFloat4x4( &mBoxWorld, boxScale*boxOffset );
@@ -192,7 +211,7 @@ App::~App( void )
     ReleaseCOM( mWavesIB );
     ReleaseCOM( mBoxVB );
     ReleaseCOM( mBoxIB );
-    ReleaseCOM( mTreeSpritesVB );
+    mTreeSpritesVB.Release();
     ReleaseCOM( mGrassMapSRV );
     ReleaseCOM( mWavesMapSRV );
     ReleaseCOM( mBoxMapSRV );
@@ -258,90 +277,12 @@ bool App::init( void )
     trees.push_back( L"Textures/tree2.dds" );
     trees.push_back( L"Textures/tree3.dds" );    
 
-    std::vector<ID3D11Texture2D*> textures;
-    textures.resize( trees.size() );
-    for ( auto& i : trees ) {     
-        static int j = 0;
-
-        HR( CreateDDSTextureFromFileEx( mD3DDevice,
-                                        i.c_str(),
-                                        0,
-                                        D3D11_USAGE_STAGING,
-                                        0,
-                                        D3D11_CPU_ACCESS_WRITE | D3D11_CPU_ACCESS_READ,
-                                        0,
-                                        0,
-                                        reinterpret_cast<ID3D11Resource**>( &textures[j++] ),
-                                        nullptr ) );
-
-
-    }
-
-    // Create texture array.
-    D3D11_TEXTURE2D_DESC desc;
-    textures[0]->GetDesc( &desc );
-
-    D3D11_TEXTURE2D_DESC arrayDesc;
-    arrayDesc.Width = desc.Width;
-    arrayDesc.Height = desc.Height;
-    arrayDesc.MipLevels = desc.MipLevels;
-    arrayDesc.ArraySize = textures.size();
-    arrayDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    arrayDesc.SampleDesc.Count = 1;
-    arrayDesc.SampleDesc.Quality = 0;
-    arrayDesc.Usage = D3D11_USAGE_DEFAULT;
-    arrayDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-    arrayDesc.CPUAccessFlags = 0;
-    arrayDesc.MiscFlags = 0;
-
-    ID3D11Texture2D* texArray = nullptr;
-    HR( mD3DDevice->CreateTexture2D( &arrayDesc, 0, &texArray ) );
-
-    // Copy individual texture elements into array.
-    for ( UINT texElement = 0; texElement < textures.size(); ++texElement ) {
-        for ( UINT mipLevel = 0; mipLevel < desc.MipLevels; ++mipLevel ) {
-            D3D11_MAPPED_SUBRESOURCE mappedTex2D;
-            HR( mD3DImmediateContext->Map( textures[texElement], 
-                                           mipLevel,
-                                           D3D11_MAP_READ,
-                                           0,
-                                           &mappedTex2D ) );
-
-            mD3DImmediateContext->UpdateSubresource( texArray,
-                                                     D3D11CalcSubresource( mipLevel,
-                                                                           texElement,
-                                                                           desc.MipLevels ),
-                                                     0,
-                                                     mappedTex2D.pData,
-                                                     mappedTex2D.RowPitch,
-                                                     mappedTex2D.DepthPitch );
-            mD3DImmediateContext->Unmap( textures[texElement], mipLevel );
-        }
-    }
-
-    // Create resource view to texture array.
-    D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
-    viewDesc.Format = arrayDesc.Format;
-    viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
-    viewDesc.Texture2DArray.MostDetailedMip = 0;
-    viewDesc.Texture2DArray.MipLevels = arrayDesc.MipLevels;
-    viewDesc.Texture2DArray.FirstArraySlice = 0;
-    viewDesc.Texture2DArray.ArraySize = textures.size();
-
-    HR( mD3DDevice->CreateShaderResourceView( texArray,
-                                              &viewDesc,
-                                              &mTreeTextureMapArraySRV ) );
-
-    // Cleanup textures.
-    ReleaseCOM( texArray );
-    for ( auto& i : textures ) {
-        ReleaseCOM( i );
-    }
+    HR( TextureHelper::CreateTexture2DArraySRV( mD3DDevice, trees, &mTreeTextureMapArraySRV ) );
 
     BuildLandGeometryBuffers();
     BuildWaveGeometryBuffers();
     BuildCrateGeometryBuffers();
-    BuildTreeSpritesBuffer();
+    PlaceTrees();
 
     return true;
 }
@@ -445,6 +386,9 @@ void App::updateScene( const float dt )
 
 void App::drawScene( void )
 {
+    // Picks up edits to the .fx files while the demo runs.
+    Effects::ReloadChanged();
+
     mD3DImmediateContext->ClearRenderTargetView( mRenderTargetView,
                                                  reinterpret_cast<const float*>( &Colors::Silver ) );
     mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView,
@@ -803,36 +747,40 @@ void App::BuildCrateGeometryBuffers()
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
-void App::BuildTreeSpritesBuffer()
+void App::PlaceTrees()
 {
-    Vertex::TreePointSprite v[TreeCount];
-
-    for ( UINT i = 0; i < TreeCount; ++i )
-    {
-        float x = MathHelper::RandF( -35.0f, 35.0f );
-        float z = MathHelper::RandF( -35.0f, 35.0f );
-        float y = GetHillHeight( x, z );
-
-        // Move tree slightly above land height.
-        y += 10.0f;
-
-        v[i].pos = XMFLOAT3( x, y, z );
-        v[i].size = XMFLOAT2( 24.0f, 24.0f );
+    // Trees wherever the hills are above the water, no two closer than
+    // the spacing.
+    Vegetation::Desc desc;
+    desc.minX = -75.f;
+    desc.minZ = -75.f;
+    desc.maxX = 75.f;
+    desc.maxZ = 75.f;
+    desc.spacing = 8.f;
+    desc.cellSize = 30.f;
+    desc.size = XMFLOAT2( 24.f, 24.f );
+    desc.centerHeight = 10.f;
+    desc.minHeight = 1.f;
+
+    mVegetation.Place( desc, [this]( float x, float z ) { return GetHillHeight( x, z ); } );
+
+    // No trees (all under water) would mean an empty buffer, which
+    // CreateBuffer() refuses.
+    if ( mVegetation.GetTreeCount() > 0 ) {
+        mTreeSpritesVB.Create( mD3DDevice,
+                               static_cast<UINT>( 3 * mVegetation.GetTreeCount() * sizeof( Vertex::TreePointSprite ) ),
+                               D3D11_BIND_VERTEX_BUFFER );
     }
-
-    D3D11_BUFFER_DESC vbd;
-    vbd.Usage = D3D11_USAGE_IMMUTABLE;
-    vbd.ByteWidth = sizeof( Vertex::TreePointSprite ) * TreeCount;
-    vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    vbd.CPUAccessFlags = 0;
-    vbd.MiscFlags = 0;
-    D3D11_SUBRESOURCE_DATA vinitData;
-    vinitData.pSysMem = v;
-    HR( mD3DDevice->CreateBuffer( &vbd, &vinitData, &mTreeSpritesVB ) );
 }
 
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
 void App::DrawTreeSprites( CXMMATRIX viewProj )
 {
+    if ( mVegetation.GetTreeCount() == 0 ) {
+        return;
+    }
+
     Effects::TreeSpriteFX->SetDirLights( mDirLights );
     Effects::TreeSpriteFX->SetEyePosW( mEyePosW );
     Effects::TreeSpriteFX->SetFogColor( Colors::Silver );
@@ -842,10 +790,42 @@ void App::DrawTreeSprites( CXMMATRIX viewProj )
     Effects::TreeSpriteFX->SetMaterial( mTreeMat );
     Effects::TreeSpriteFX->SetTreeTextureMapArray( mTreeTextureMapArraySRV );
 
+    // Only the trees in view go to the geometry shader, nearest first so
+    // the ones behind fail the depth test. They shrink away between
+    // fadeStart and the end of the fog.
+    XMFLOAT4X4 cullViewProj;
+    XMStoreFloat4x4( &cullViewProj, viewProj );
+    if ( std::memcmp( &cullViewProj, &mCullViewProj, sizeof( cullViewProj ) ) != 0 ) {
+        mCullViewProj = cullViewProj;
+        ExtractFrustumPlanes( mCullPlanes, viewProj );
+    }
+
+    const float fadeStart = 150.f;
+    const float fadeEnd = 190.f;
+    mVegetation.Gather( mCullPlanes, mEyePosW, fadeStart, fadeEnd, mVisibleTrees, &JobSystem::Instance() );
+    if ( mVisibleTrees.empty() ) {
+        return;
+    }
+
+    mTreeSpritesVB.Begin( mD3DImmediateContext );
+    UINT offset = 0;
+    Vertex::TreePointSprite* v = mTreeSpritesVB.Allocate<Vertex::TreePointSprite>( static_cast<UINT>( mVisibleTrees.size() ), offset );
+    if ( v != nullptr ) {
+        std::memcpy( v, mVisibleTrees.data(), mVisibleTrees.size() * sizeof( Vertex::TreePointSprite ) );
+    }
+    mTreeSpritesVB.Unmap( mD3DImmediateContext );
+    if ( v == nullptr ) {
+        return;
+    }
+
+    const UINT treeCount = static_cast<UINT>( mVisibleTrees.size() );
+    const UINT firstTree = offset / sizeof( Vertex::TreePointSprite );
+
     mD3DImmediateContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_POINTLIST );
     mD3DImmediateContext->IASetInputLayout( InputLayouts::TreePointSprite );
     UINT stride = sizeof( Vertex::TreePointSprite );
-    UINT offset = 0;
+    UINT vbOffset = 0;
+    ID3D11Buffer* vb = mTreeSpritesVB.Get();
 
     ID3DX11EffectTechnique* tech = Effects::TreeSpriteFX->Light3Tech;
     switch ( mRenderOptions )
@@ -866,9 +846,9 @@ void App::DrawTreeSprites( CXMMATRIX viewProj )
     for ( UINT p = 0; p < desc.Passes; ++p ) {
         mD3DImmediateContext->IASetVertexBuffers( 0,
                                                   1,
-                                                  &mTreeSpritesVB,
+                                                  &vb,
                                                   &stride,
-                                                  &offset );
+                                                  &vbOffset );
 
         float blendFactor[4] = { 0.f, 0.f, 0.f, 0.f };
 
@@ -879,7 +859,7 @@ void App::DrawTreeSprites( CXMMATRIX viewProj )
         }
 
         tech->GetPassByIndex( 0 )->Apply( 0, mD3DImmediateContext );
-        mD3DImmediateContext->Draw( TreeCount, 0 );
+        mD3DImmediateContext->Draw( treeCount, firstTree );
 
         mD3DImmediateContext->OMSetBlendState( nullptr, blendFactor, 0xffffffff );
     }
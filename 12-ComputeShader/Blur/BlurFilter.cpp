@@ -3,6 +3,7 @@
 //***************************************************************************************
 
 #include "BlurFilter.h"
+#include "BlurKernel.h"
 #include "Effects.h"
 
 BlurFilter::BlurFilter()
@@ -23,28 +24,12 @@ ID3D11ShaderResourceView* BlurFilter::GetBlurredOutput()
 
 void BlurFilter::SetGaussianWeights(float sigma)
 {
-	float d = 2.0f*sigma*sigma;
+	std::vector<float> weights = BlurKernel::Gaussian(sigma, BlurRadius);
 
-	float weights[9];
-	float sum = 0.0f;
-	for(int i = 0; i < 8; ++i)
-	{
-		float x = (float)i;
-		weights[i] = expf(-x*x/d);
-
-		sum += weights[i];
-	}
-
-	// Divide by the sum so all the weights add up to 1.0.
-	for(int i = 0; i < 8; ++i)
-	{
-		weights[i] /= sum;
-	}
-
-	Effects::BlurFX->SetWeights(weights);
+	Effects::BlurFX->SetWeights(&weights[0]);
 }
 
-void BlurFilter::SetWeights(const float weights[9])
+void BlurFilter::SetWeights(const float weights[2*BlurRadius + 1])
 {
 	Effects::BlurFX->SetWeights(weights);
 }
@@ -102,6 +87,18 @@ void BlurFilter::BlurInPlace(ID3D11DeviceContext* dc,
 							 ID3D11ShaderResourceView* inputSRV, 
 	                         ID3D11UnorderedAccessView* inputUAV,
 							 int blurCount)
+{
+	BlurInPlace(dc, inputSRV, inputUAV, mBlurredOutputTexSRV, mBlurredOutputTexUAV, mWidth, mHeight, blurCount);
+}
+
+void BlurFilter::BlurInPlace(ID3D11DeviceContext* dc,
+							 ID3D11ShaderResourceView* inputSRV,
+							 ID3D11UnorderedAccessView* inputUAV,
+							 ID3D11ShaderResourceView* tempSRV,
+							 ID3D11UnorderedAccessView* tempUAV,
+							 UINT width,
+							 UINT height,
+							 int blurCount)
 {
 	//
 	// Run the compute shader to blur the offscreen texture.
@@ -115,13 +112,13 @@ void BlurFilter::BlurInPlace(ID3D11DeviceContext* dc,
 		for(UINT p = 0; p < techDesc.Passes; ++p)
 		{
 			Effects::BlurFX->SetInputMap(inputSRV);
-			Effects::BlurFX->SetOutputMap(mBlurredOutputTexUAV);
+			Effects::BlurFX->SetOutputMap(tempUAV);
 			Effects::BlurFX->HorzBlurTech->GetPassByIndex(p)->Apply(0, dc);
 
 			// How many groups do we need to dispatch to cover a row of pixels, where each
 			// group covers 256 pixels (the 256 is defined in the ComputeShader).
-			UINT numGroupsX = (UINT)ceilf(mWidth / 256.0f);
-			dc->Dispatch(numGroupsX, mHeight, 1);
+			UINT numGroupsX = (UINT)ceilf(width / 256.0f);
+			dc->Dispatch(numGroupsX, height, 1);
 		}
 	
 		// Unbind the input texture from the CS for good housekeeping.
@@ -137,14 +134,14 @@ void BlurFilter::BlurInPlace(ID3D11DeviceContext* dc,
 		Effects::BlurFX->VertBlurTech->GetDesc( &techDesc );
 		for(UINT p = 0; p < techDesc.Passes; ++p)
 		{
-			Effects::BlurFX->SetInputMap(mBlurredOutputTexSRV);
+			Effects::BlurFX->SetInputMap(tempSRV);
 			Effects::BlurFX->SetOutputMap(inputUAV);
 			Effects::BlurFX->VertBlurTech->GetPassByIndex(p)->Apply(0, dc);
 
 			// How many groups do we need to dispatch to cover a column of pixels, where each
 			// group covers 256 pixels  (the 256 is defined in the ComputeShader).
-			UINT numGroupsY = (UINT)ceilf(mHeight / 256.0f);
-			dc->Dispatch(mWidth, numGroupsY, 1);
+			UINT numGroupsY = (UINT)ceilf(height / 256.0f);
+			dc->Dispatch(width, numGroupsY, 1);
 		}
 	
 		dc->CSSetShaderResources( 0, 1, nullSRV );
@@ -154,3 +151,76 @@ void BlurFilter::BlurInPlace(ID3D11DeviceContext* dc,
 	// Disable compute shader.
 	dc->CSSetShader(0, 0, 0);
 }
+
+void BlurFilter::BoxBlurInPlace(ID3D11DeviceContext* dc,
+								ID3D11ShaderResourceView* inputSRV,
+								ID3D11UnorderedAccessView* inputUAV,
+								float sigma,
+								int passes)
+{
+	BoxBlurInPlace(dc, inputSRV, inputUAV, mBlurredOutputTexSRV, mBlurredOutputTexUAV, mWidth, mHeight, sigma, passes);
+}
+
+void BlurFilter::BoxBlurInPlace(ID3D11DeviceContext* dc,
+								ID3D11ShaderResourceView* inputSRV,
+								ID3D11UnorderedAccessView* inputUAV,
+								ID3D11ShaderResourceView* tempSRV,
+								ID3D11UnorderedAccessView* tempUAV,
+								UINT width,
+								UINT height,
+								float sigma,
+								int passes)
+{
+	// The ComputeShader caches at most MaxBoxRadius texels either side of its
+	// tile; spread a wider blur over more, narrower passes instead.
+	std::vector<int> radii = BlurKernel::BoxRadiiForGaussian(sigma, passes);
+	while( radii.back() > MaxBoxRadius )
+	{
+		radii = BlurKernel::BoxRadiiForGaussian(sigma, ++passes);
+	}
+
+	ID3D11ShaderResourceView* nullSRV[1] = { 0 };
+	ID3D11UnorderedAccessView* nullUAV[1] = { 0 };
+
+	// Each group blurs a tile of BoxThreads texels of one row (horizontal) or
+	// one column (vertical), as defined in the ComputeShader.
+	UINT numTilesX = (UINT)ceilf(width / (float)BoxThreads);
+	UINT numTilesY = (UINT)ceilf(height / (float)BoxThreads);
+
+	for(size_t i = 0; i < radii.size(); ++i)
+	{
+		Effects::BlurFX->SetBoxRadius(radii[i]);
+
+		// HORIZONTAL box pass.
+		D3DX11_TECHNIQUE_DESC techDesc;
+		Effects::BlurFX->HorzBoxBlurTech->GetDesc( &techDesc );
+		for(UINT p = 0; p < techDesc.Passes; ++p)
+		{
+			Effects::BlurFX->SetInputMap(inputSRV);
+			Effects::BlurFX->SetOutputMap(tempUAV);
+			Effects::BlurFX->HorzBoxBlurTech->GetPassByIndex(p)->Apply(0, dc);
+
+			dc->Dispatch(numTilesX, height, 1);
+		}
+
+		dc->CSSetShaderResources( 0, 1, nullSRV );
+		dc->CSSetUnorderedAccessViews( 0, 1, nullUAV, 0 );
+
+		// VERTICAL box pass.
+		Effects::BlurFX->VertBoxBlurTech->GetDesc( &techDesc );
+		for(UINT p = 0; p < techDesc.Passes; ++p)
+		{
+			Effects::BlurFX->SetInputMap(tempSRV);
+			Effects::BlurFX->SetOutputMap(inputUAV);
+			Effects::BlurFX->VertBoxBlurTech->GetPassByIndex(p)->Apply(0, dc);
+
+			dc->Dispatch(width, numTilesY, 1);
+		}
+
+		dc->CSSetShaderResources( 0, 1, nullSRV );
+		dc->CSSetUnorderedAccessViews( 0, 1, nullUAV, 0 );
+	}
+
+	// Disable compute shader.
+	dc->CSSetShader(0, 0, 0);
+}
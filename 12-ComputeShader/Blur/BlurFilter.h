@@ -19,11 +19,18 @@ public:
 
 	ID3D11ShaderResourceView* GetBlurredOutput();
 
+	// Must match gBlurRadius in Blur.fx.
+	static const int BlurRadius = 5;
+
+	// Must match BoxThreads and MaxBoxRadius in Blur.fx.
+	static const int BoxThreads = 256;
+	static const int MaxBoxRadius = 128;
+
 	// Generate Gaussian blur weights.
 	void SetGaussianWeights(float sigma);
 
 	// Manually specify blur weights.
-	void SetWeights(const float weights[9]);
+	void SetWeights(const float weights[2*BlurRadius + 1]);
 
 	///<summary>
 	/// The width and height should match the dimensions of the input texture to blur.
@@ -37,6 +44,23 @@ public:
 	///</summary>
 	void BlurInPlace(ID3D11DeviceContext* dc, ID3D11ShaderResourceView* inputSRV, ID3D11UnorderedAccessView* inputUAV, int blurCount);
 
+	///<summary>
+	/// Approximates a Gaussian blur of the given sigma with a few box blurs.
+	/// The cost per pixel does not depend on sigma, so large radii do not need many
+	/// BlurInPlace() iterations; very large sigmas take extra passes to keep each
+	/// box within MaxBoxRadius.  Note that this modifies the input texture, not a copy of it.
+	///</summary>
+	void BoxBlurInPlace(ID3D11DeviceContext* dc, ID3D11ShaderResourceView* inputSRV, ID3D11UnorderedAccessView* inputUAV, float sigma, int passes = 3);
+
+	///<summary>
+	/// Same as above, but ping-pong through a caller-provided texture of the input's size
+	/// and format (e.g. a FrameGraph transient) instead of the one allocated by Init().
+	///</summary>
+	void BlurInPlace(ID3D11DeviceContext* dc, ID3D11ShaderResourceView* inputSRV, ID3D11UnorderedAccessView* inputUAV,
+		ID3D11ShaderResourceView* tempSRV, ID3D11UnorderedAccessView* tempUAV, UINT width, UINT height, int blurCount);
+	void BoxBlurInPlace(ID3D11DeviceContext* dc, ID3D11ShaderResourceView* inputSRV, ID3D11UnorderedAccessView* inputUAV,
+		ID3D11ShaderResourceView* tempSRV, ID3D11UnorderedAccessView* tempUAV, UINT width, UINT height, float sigma, int passes = 3);
+
 private:
 
 	UINT mWidth;
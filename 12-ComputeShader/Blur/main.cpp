@@ -7,10 +7,12 @@
 #include "BlurFilter.h"
 #include "d3dx11Effect.h"
 #include "Effects.h"
+#include "FrameGraph.h"
 #include "GeometryGenerator.h"
 #include "LightHelper.h"
 #include "MathHelper.h"
 #include "RenderStates.h"
+#include "TransientTexturePool.h"
 #include "Vertex.h"
 #include "Waves.h"
 
@@ -48,14 +50,14 @@ private:
 
     void UpdateWaves();
     void DrawWrapper();
-    void DrawScreenQuad();
+    void DrawScreenQuad( ID3D11ShaderResourceView* srv );
     float GetHillHeight( float x, float z ) const;
     XMFLOAT3 GetHillNormal( float x, float z ) const;
     void BuildLandGeometryBuffers();
     void BuildWaveGeometryBuffers();
     void BuildCrateGeometryBuffers();
     void BuildScreenQuadGeometryBuffers();
-    void BuildOffscreenViews();
+    void BuildFrameGraph();
 
 private:
 
@@ -75,9 +77,12 @@ private:
     ID3D11ShaderResourceView* mWavesMapSRV;
     ID3D11ShaderResourceView* mCrateSRV;
 
-    ID3D11ShaderResourceView* mOffscreenSRV;
-    ID3D11UnorderedAccessView* mOffscreenUAV;
-    ID3D11RenderTargetView* mOffscreenRTV;
+    // Scene -> Blur -> Composite. The offscreen and blur temp textures are
+    // transients owned by mTransients and rebuilt on resize.
+    FrameGraph mFrameGraph;
+    TransientTexturePool mTransients;
+    FrameGraph::ResourceHandle mOffscreen;
+    FrameGraph::ResourceHandle mBlurTemp;
 
     BlurFilter mBlur;
     Waves mWaves;
@@ -105,6 +110,9 @@ private:
 
     int mBlurStrength;
 
+    // Use the sliding-window box blur instead of iterating the 11-tap kernel.
+    bool mBoxBlur;
+
     XMFLOAT3 mEyePosW;
 
     float mTheta;
@@ -138,10 +146,10 @@ int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE prevInstance,
 App::App( HINSTANCE hInstance )
     : D3DApp( hInstance ), mLandVB( 0 ), mLandIB( 0 ), mWavesVB( 0 ), mWavesIB( 0 ),
     mBoxVB( 0 ), mBoxIB( 0 ), mScreenQuadVB( 0 ), mScreenQuadIB( 0 ),
-    mGrassMapSRV( 0 ), mWavesMapSRV( 0 ), mCrateSRV( 0 ), mOffscreenSRV( 0 ), mOffscreenUAV( 0 ), mOffscreenRTV( 0 ),
+    mGrassMapSRV( 0 ), mWavesMapSRV( 0 ), mCrateSRV( 0 ), mOffscreen( FrameGraph::Invalid ), mBlurTemp( FrameGraph::Invalid ),
     mWaterTexOffset( 0.0f, 0.0f ), mEyePosW( 0.0f, 0.0f, 0.0f ), mLandIndexCount( 0 ), mWaveIndexCount( 0 ),
     mRenderOptions( RenderOptions::TexturesAndFog ),
-    mTheta( 1.3f*MathHelper::Pi ), mPhi( 0.4f*MathHelper::Pi ), mRadius( 80.0f ), mBlurStrength( 8 )
+    mTheta( 1.3f*MathHelper::Pi ), mPhi( 0.4f*MathHelper::Pi ), mRadius( 80.0f ), mBlurStrength( 8 ), mBoxBlur( false )
 {
     mMainWindowCaption = L"Blur Demo";
 
@@ -207,9 +215,7 @@ App::~App( void )
     ReleaseCOM( mWavesMapSRV );
     ReleaseCOM( mCrateSRV );
 
-    ReleaseCOM( mOffscreenSRV );
-    ReleaseCOM( mOffscreenUAV );
-    ReleaseCOM( mOffscreenRTV );
+    mTransients.ReleaseAll();
 
     Effects::DestroyAll();
     InputLayouts::DestroyAll();
@@ -269,7 +275,6 @@ bool App::init( void )
     BuildWaveGeometryBuffers();
     BuildCrateGeometryBuffers();
     BuildScreenQuadGeometryBuffers();
-    BuildOffscreenViews();
 
     return true;
 }
@@ -281,8 +286,7 @@ void App::onResize( void )
     D3DApp::onResize();
 
     // Recreate the resources that depend on the client area size.
-    BuildOffscreenViews();
-    mBlur.Init( mD3DDevice, mClientWidth, mClientHeight, DXGI_FORMAT_R8G8B8A8_UNORM );
+    BuildFrameGraph();
 
     // Update the aspect ratio and recompute the projection matrix.
     XMMATRIX P = XMMatrixPerspectiveFovLH( 0.25f * MathHelper::Pi,
@@ -380,39 +384,23 @@ void App::updateScene( const float dt )
 
     if ( GetAsyncKeyState( '3' ) & 0x8000 )
         mRenderOptions = RenderOptions::TexturesAndFog;
+
+    // Switch between the iterated Gaussian and the box blur.
+    if ( GetAsyncKeyState( 'G' ) & 0x8000 )
+        mBoxBlur = false;
+
+    if ( GetAsyncKeyState( 'B' ) & 0x8000 )
+        mBoxBlur = true;
 }
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
 void App::drawScene( void )
 {
-    // Render to offscreen buffer.
-    ID3D11RenderTargetView* renderTargets[1] = { mOffscreenRTV };
-    mD3DImmediateContext->OMSetRenderTargets( 1, renderTargets, mDepthStencilView );
-
-    mD3DImmediateContext->ClearRenderTargetView( mOffscreenRTV,
-                                                 reinterpret_cast<const float*>( &Colors::Silver ) );
-    mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView,
-                                                 D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL,
-                                                 1.f,
-                                                 0 );
-
-    // Draw scene to offscreen buffer.
-    DrawWrapper();
-
-    // Restore back buffer. The offscreen render target will serve as input to compute
-    // shader for blurring, so we must unbind it from the OM stage before we can use
-    // it as an input into the compute shader.
-    renderTargets[0] = mRenderTargetView;
-    mD3DImmediateContext->OMSetRenderTargets( 1, renderTargets, mDepthStencilView );
-
-    // Blur offscreen buffer.
-    mBlur.BlurInPlace( mD3DImmediateContext, mOffscreenSRV, mOffscreenUAV, mBlurStrength );
-
-    mD3DImmediateContext->ClearRenderTargetView( mRenderTargetView, reinterpret_cast<const float*>( &Colors::Silver ) );
-    mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
+    // Picks up edits to the .fx files while the demo runs.
+    Effects::ReloadChanged();
 
-    DrawScreenQuad();
+    mFrameGraph.Execute();
 
     HR( mSwapChain->Present( 0, 0 ) );
 }
@@ -548,7 +536,7 @@ void App::DrawWrapper( void )
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
-void App::DrawScreenQuad()
+void App::DrawScreenQuad( ID3D11ShaderResourceView* srv )
 {
     mD3DImmediateContext->IASetInputLayout( InputLayouts::Basic32 );
     mD3DImmediateContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
@@ -571,7 +559,7 @@ void App::DrawScreenQuad()
         Effects::BasicFX->SetWorldInvTranspose( identity );
         Effects::BasicFX->SetWorldViewProj( identity );
         Effects::BasicFX->SetTexTransform( identity );
-        Effects::BasicFX->SetDiffuseMap( mBlur.GetBlurredOutput() );
+        Effects::BasicFX->SetDiffuseMap( srv );
 
         texOnlyTech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
         mD3DImmediateContext->DrawIndexed( 6, 0, 0 );
@@ -847,39 +835,67 @@ void App::BuildScreenQuadGeometryBuffers( void )
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
-void App::BuildOffscreenViews( void )
+void App::BuildFrameGraph( void )
 {
-    // We call this function everytime the window is resized so that the render target is a quarter
-    // the client area dimensions.  So Release the previous views before we create new ones.
-    ReleaseCOM( mOffscreenSRV );
-    ReleaseCOM( mOffscreenRTV );
-    ReleaseCOM( mOffscreenUAV );
-
-    D3D11_TEXTURE2D_DESC texDesc;
-
-    texDesc.Width = mClientWidth;
-    texDesc.Height = mClientHeight;
-    texDesc.MipLevels = 1;
-    texDesc.ArraySize = 1;
-    texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    texDesc.SampleDesc.Count = 1;
-    texDesc.SampleDesc.Quality = 0;
-    texDesc.Usage = D3D11_USAGE_DEFAULT;
-    texDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-    texDesc.CPUAccessFlags = 0;
-    texDesc.MiscFlags = 0;
-
-    ID3D11Texture2D* offscreenTex = 0;
-    HR( mD3DDevice->CreateTexture2D( &texDesc, 0, &offscreenTex ) );
-
-    // Null description means to create a view to all mipmap levels using 
-    // the format the texture was created with.
-    HR( mD3DDevice->CreateShaderResourceView( offscreenTex, 0, &mOffscreenSRV ) );
-    HR( mD3DDevice->CreateRenderTargetView( offscreenTex, 0, &mOffscreenRTV ) );
-    HR( mD3DDevice->CreateUnorderedAccessView( offscreenTex, 0, &mOffscreenUAV ) );
-
-    // View saves a reference to the texture so we can release our reference.
-    ReleaseCOM( offscreenTex );
-}
+    // The graph only depends on the client area size, so it is declared
+    // again on resize rather than every frame.
+    mFrameGraph.Reset();
+
+    const FrameGraph::TextureDesc desc( mClientWidth,
+                                        mClientHeight,
+                                        DXGI_FORMAT_R8G8B8A8_UNORM,
+                                        D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS );
+
+    mOffscreen = mFrameGraph.CreateTexture( "Offscreen", desc );
+    mBlurTemp = mFrameGraph.CreateTexture( "BlurTemp", desc );
+    FrameGraph::ResourceHandle backBuffer = mFrameGraph.ImportTexture( "BackBuffer" );
+
+    // Draw the scene to the offscreen texture.
+    mFrameGraph.AddPass( "Scene", { }, { mOffscreen }, [this]( ) {
+        ID3D11RenderTargetView* rtv = mTransients.Get( mFrameGraph, mOffscreen ).rtv;
+        mD3DImmediateContext->OMSetRenderTargets( 1, &rtv, mDepthStencilView );
+
+        mD3DImmediateContext->ClearRenderTargetView( rtv,
+                                                     reinterpret_cast<const float*>( &Colors::Silver ) );
+        mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView,
+                                                     D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL,
+                                                     1.f,
+                                                     0 );
+
+        DrawWrapper();
+    } );
+
+    // Blur the offscreen texture in place, ping-ponging through BlurTemp.
+    mFrameGraph.AddPass( "Blur", { mOffscreen }, { mOffscreen, mBlurTemp }, [this]( ) {
+        // The offscreen render target will serve as input to the compute shader,
+        // so we must unbind it from the OM stage first.
+        ID3D11RenderTargetView* renderTargets[1] = { mRenderTargetView };
+        mD3DImmediateContext->OMSetRenderTargets( 1, renderTargets, mDepthStencilView );
+
+        const TransientTexturePool::Texture& offscreen = mTransients.Get( mFrameGraph, mOffscreen );
+        const TransientTexturePool::Texture& temp = mTransients.Get( mFrameGraph, mBlurTemp );
+
+        if ( mBoxBlur ) {
+            // Variances add, so mBlurStrength iterations of the default weights
+            // (variance 6.9 texels^2) equal a single Gaussian of this sigma.
+            float sigma = sqrtf( 6.9f * mBlurStrength );
+            mBlur.BoxBlurInPlace( mD3DImmediateContext, offscreen.srv, offscreen.uav,
+                                  temp.srv, temp.uav, mClientWidth, mClientHeight, sigma );
+        }
+        else {
+            mBlur.BlurInPlace( mD3DImmediateContext, offscreen.srv, offscreen.uav,
+                               temp.srv, temp.uav, mClientWidth, mClientHeight, mBlurStrength );
+        }
+    } );
 
-// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
\ No newline at end of file
+    // Draw the blurred result to the back buffer.
+    mFrameGraph.AddPass( "Composite", { mOffscreen }, { backBuffer }, [this]( ) {
+        mD3DImmediateContext->ClearRenderTargetView( mRenderTargetView, reinterpret_cast<const float*>( &Colors::Silver ) );
+        mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
+
+        DrawScreenQuad( mTransients.Get( mFrameGraph, mOffscreen ).srv );
+    } );
+
+    mFrameGraph.Compile();
+    mTransients.Realize( mD3DDevice, mFrameGraph );
+}
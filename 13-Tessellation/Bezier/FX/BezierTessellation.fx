@@ -59,32 +59,31 @@ struct PatchTess
 	float InsideTess[2] : SV_InsideTessFactor;
 };
 
+// Factors per patch, indexed by SV_PrimitiveID. They are worked out on the
+// CPU (TessellationFactors) from the on-screen length and the curvature of
+// each edge; patches that share an edge read the same factor for it.
+struct PatchFactors
+{
+    float4 Edges;
+    float2 Inside;
+    float2 Pad;
+};
+
+StructuredBuffer<PatchFactors> gPatchFactors;
+
 PatchTess ConstantHS(InputPatch<VertexOut, 16> patch, uint patchID : SV_PrimitiveID)
 {
     PatchTess pt;
 
-    float3 centerL = 0.25f*( patch[0].PosL + patch[1].PosL + patch[2].PosL + patch[3].PosL );
-    float3 centerW = mul( float4( centerL, 1.0f ), gWorld ).xyz;
-
-    float d = distance( centerW, gEyePosW );
-
-    // Tessellate the patch based on distance from the eye such that
-    // the tessellation is 0 if d >= d1 and 60 if d <= d0.  The interval
-    // [d0, d1] defines the range we tessellate in.
-
-    const float d0 = 20.0f;
-    const float d1 = 100.0f;
-    float tess = 64.0f*saturate( ( d1 - d ) / ( d1 - d0 ) );
-
-    // Uniformly tessellate the patch.
+    PatchFactors factors = gPatchFactors[patchID];
 
-    pt.EdgeTess[0] = tess;
-    pt.EdgeTess[1] = tess;
-    pt.EdgeTess[2] = tess;
-    pt.EdgeTess[3] = tess;
+    pt.EdgeTess[0] = factors.Edges.x;
+    pt.EdgeTess[1] = factors.Edges.y;
+    pt.EdgeTess[2] = factors.Edges.z;
+    pt.EdgeTess[3] = factors.Edges.w;
 
-    pt.InsideTess[0] = tess;
-    pt.InsideTess[1] = tess;
+    pt.InsideTess[0] = factors.Inside.x;
+    pt.InsideTess[1] = factors.Inside.y;
 
     return pt;
 }
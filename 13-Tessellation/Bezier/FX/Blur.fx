@@ -115,6 +115,119 @@ void VertBlurCS( int3 groupThreadID : SV_GroupThreadID,
     gOutput[dispatchThreadID.xy] = blurColor;
 }
 
+// ================================================= //
+// Box blur. A group of BoxThreads threads blurs a tile of BoxThreads texels
+// of one row (or column): it caches the tile and MaxBoxRadius texels either
+// side, turns the cache into a prefix sum, and each window sum is then the
+// difference of two prefixes, so the cost per pixel is the same at any
+// radius. Sums only run over one tile's cache, so float error does not
+// build up along the row the way a single running sum would.
+// ================================================= //
+
+cbuffer cbBox {
+    int gBoxRadius;
+};
+
+#define BoxThreads 256
+#define MaxBoxRadius 128
+#define BoxCacheSize ( BoxThreads + 2 * MaxBoxRadius )
+
+groupshared float4 gBoxCache[BoxCacheSize];
+groupshared float4 gBoxPairs[BoxThreads];
+
+// Turns gBoxCache into its inclusive prefix sum. Each thread adds up two
+// texels, the pair sums are scanned (Hillis-Steele, log2(BoxThreads)
+// steps), and each thread writes its two prefixes back.
+void BoxPrefixSum( int t )
+{
+    float4 first = gBoxCache[2 * t];
+    gBoxPairs[t] = first + gBoxCache[2 * t + 1];
+    GroupMemoryBarrierWithGroupSync();
+
+    [unroll]
+    for ( int offset = 1; offset < BoxThreads; offset *= 2 ) {
+        // Not a ?: -- HLSL evaluates both sides, and t - offset can be
+        // out of bounds.
+        float4 add = float4( 0.f, 0.f, 0.f, 0.f );
+        if ( t >= offset ) {
+            add = gBoxPairs[t - offset];
+        }
+        GroupMemoryBarrierWithGroupSync();
+
+        gBoxPairs[t] += add;
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    float4 before = float4( 0.f, 0.f, 0.f, 0.f );
+    if ( t > 0 ) {
+        before = gBoxPairs[t - 1];
+    }
+    gBoxCache[2 * t] = before + first;
+    gBoxCache[2 * t + 1] = gBoxPairs[t];
+    GroupMemoryBarrierWithGroupSync();
+}
+
+// Average of the 2r + 1 cached texels around tile texel t.
+float4 BoxWindow( int t, int r )
+{
+    int hi = t + MaxBoxRadius + r;
+    int lo = t + MaxBoxRadius - r - 1;
+
+    float4 sum = gBoxCache[hi];
+    if ( lo >= 0 ) {
+        sum -= gBoxCache[lo];
+    }
+    return sum / ( 2 * r + 1 );
+}
+
+// ================================================= //
+
+[numthreads( BoxThreads, 1, 1 )]
+void HorzBoxBlurCS( int3 groupThreadID : SV_GroupThreadID,
+                    int3 groupID : SV_GroupID )
+{
+    int t = groupThreadID.x;
+    int y = groupID.y;
+    int tileStart = groupID.x * BoxThreads;
+    int lastX = gInput.Length.x - 1;
+
+    // Cache entry c holds texel tileStart - MaxBoxRadius + c, clamped at
+    // the borders.
+    gBoxCache[t] = gInput[int2( clamp( tileStart - MaxBoxRadius + t, 0, lastX ), y )];
+    gBoxCache[t + BoxThreads] = gInput[int2( clamp( tileStart - MaxBoxRadius + BoxThreads + t, 0, lastX ), y )];
+    GroupMemoryBarrierWithGroupSync();
+
+    BoxPrefixSum( t );
+
+    int x = tileStart + t;
+    if ( x <= lastX ) {
+        gOutput[int2( x, y )] = BoxWindow( t, min( gBoxRadius, MaxBoxRadius ) );
+    }
+}
+
+// ================================================= //
+
+[numthreads( 1, BoxThreads, 1 )]
+void VertBoxBlurCS( int3 groupThreadID : SV_GroupThreadID,
+                    int3 groupID : SV_GroupID )
+{
+    int t = groupThreadID.y;
+    int x = groupID.x;
+    int tileStart = groupID.y * BoxThreads;
+    int lastY = gInput.Length.y - 1;
+
+    gBoxCache[t] = gInput[int2( x, clamp( tileStart - MaxBoxRadius + t, 0, lastY ) )];
+    gBoxCache[t + BoxThreads] = gInput[int2( x, clamp( tileStart - MaxBoxRadius + BoxThreads + t, 0, lastY ) )];
+    GroupMemoryBarrierWithGroupSync();
+
+    BoxPrefixSum( t );
+
+    int y = tileStart + t;
+    if ( y <= lastY ) {
+        gOutput[int2( x, y )] = BoxWindow( t, min( gBoxRadius, MaxBoxRadius ) );
+    }
+}
+
 // ================================================= //
 
 technique11 HorzBlur {
@@ -134,3 +247,21 @@ technique11 VertBlur {
 }
 
 // ================================================= //
+
+technique11 HorzBoxBlur {
+    pass P0 {
+        SetVertexShader( NULL );
+        SetPixelShader( NULL );
+        SetComputeShader( CompileShader( cs_5_0, HorzBoxBlurCS() ) );
+    }
+}
+
+technique11 VertBoxBlur {
+    pass P0 {
+        SetVertexShader( NULL );
+        SetPixelShader( NULL );
+        SetComputeShader( CompileShader( cs_5_0, VertBoxBlurCS() ) );
+    }
+}
+
+// ================================================= //
@@ -4,13 +4,16 @@
 
 #include "D3DApp.h"
 
+#include "BezierPatch.h"
 #include "BlurFilter.h"
 #include "d3dx11Effect.h"
 #include "Effects.h"
 #include "GeometryGenerator.h"
 #include "LightHelper.h"
 #include "MathHelper.h"
+#include "PatchFactorBuffer.h"
 #include "RenderStates.h"
+#include "TessellationFactors.h"
 #include "Vertex.h"
 #include "Waves.h"
 
@@ -47,11 +50,32 @@ public:
 private:
 
     void BuildQuadPatchBuffer();
+    void BuildBakedPatchBuffers();
+
+    bool IsPatchVisible( const XMFLOAT4 planes[6] ) const;
 
 private:
 
     ID3D11Buffer* mQuadPatchVB;
 
+    // The same patch baked to triangles on the CPU, drawn instead of the
+    // tessellated one with '2' ('1' goes back), as it would be on hardware
+    // without hull and domain shaders.
+    BezierPatch mPatch;
+    XMFLOAT3 mPatchBoundsMin;
+    XMFLOAT3 mPatchBoundsMax;
+    ID3D11Buffer* mBakedPatchVB;
+    ID3D11Buffer* mBakedPatchIB;
+    UINT mBakedPatchIndexCount;
+    bool mDrawBaked;
+
+    DirectionalLight mDirLights[3];
+    Material mPatchMat;
+
+    // Edge and inside factors of the patch for the current view.
+    TessellationFactors mTessFactors;
+    PatchFactorBuffer mPatchFactorBuffer;
+
     XMFLOAT4X4 mView;
     XMFLOAT4X4 mProj;
 
@@ -87,6 +111,8 @@ int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE prevInstance,
 
 App::App( HINSTANCE hInstance )
     : D3DApp( hInstance ), mQuadPatchVB( 0 ),
+    mPatchBoundsMin( 0.0f, 0.0f, 0.0f ), mPatchBoundsMax( 0.0f, 0.0f, 0.0f ),
+    mBakedPatchVB( 0 ), mBakedPatchIB( 0 ), mBakedPatchIndexCount( 0 ), mDrawBaked( false ),
     mEyePosW( 0.0f, 0.0f, 0.0f ), mTheta( 1.3f*MathHelper::Pi ), mPhi( 0.4f*MathHelper::Pi ), mRadius( 80.0f )
 {
     mMainWindowCaption = L"Bezier Surface Demo";
@@ -98,6 +124,15 @@ App::App( HINSTANCE hInstance )
     XMMATRIX I = XMMatrixIdentity();
     XMStoreFloat4x4( &mView, I );
     XMStoreFloat4x4( &mProj, I );
+
+    mDirLights[0].ambient = XMFLOAT4( 0.2f, 0.2f, 0.2f, 1.0f );
+    mDirLights[0].diffuse = XMFLOAT4( 0.5f, 0.5f, 0.5f, 1.0f );
+    mDirLights[0].specular = XMFLOAT4( 0.5f, 0.5f, 0.5f, 1.0f );
+    mDirLights[0].direction = XMFLOAT3( 0.57735f, -0.57735f, 0.57735f );
+
+    mPatchMat.ambient = XMFLOAT4( 0.2f, 0.2f, 0.2f, 1.0f );
+    mPatchMat.diffuse = XMFLOAT4( 0.2f, 0.2f, 0.2f, 1.0f );
+    mPatchMat.specular = XMFLOAT4( 0.2f, 0.2f, 0.2f, 16.0f );
 }
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -106,6 +141,9 @@ App::~App( void )
 {
     mD3DImmediateContext->ClearState();
     ReleaseCOM( mQuadPatchVB );
+    ReleaseCOM( mBakedPatchVB );
+    ReleaseCOM( mBakedPatchIB );
+    mPatchFactorBuffer.Release();
 
     Effects::DestroyAll();
     InputLayouts::DestroyAll();
@@ -126,6 +164,7 @@ bool App::init( void )
     RenderStates::InitAll( mD3DDevice );
 
     BuildQuadPatchBuffer();
+    BuildBakedPatchBuffers();
 
     return true;
 }
@@ -148,6 +187,13 @@ void App::onResize( void )
 
 void App::updateScene( const float dt )
 {
+    if ( GetAsyncKeyState( '1' ) & 0x8000 ) {
+        mDrawBaked = false;
+    }
+    if ( GetAsyncKeyState( '2' ) & 0x8000 ) {
+        mDrawBaked = true;
+    }
+
     // Convert spherical to cartesian.
     float x = mRadius * sinf( mPhi ) * cosf( mTheta );
     float y = mRadius * sinf( mPhi ) * sinf( mTheta );
@@ -168,6 +214,9 @@ void App::updateScene( const float dt )
 
 void App::drawScene( void )
 {
+    // Picks up edits to the .fx files while the demo runs.
+    Effects::ReloadChanged();
+
     mD3DImmediateContext->ClearRenderTargetView( mRenderTargetView, reinterpret_cast<const float*>( &Colors::Silver ) );
     mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
 
@@ -180,12 +229,58 @@ void App::drawScene( void )
     XMMATRIX proj = XMLoadFloat4x4( &mProj );
     XMMATRIX viewProj = view*proj;
 
+    XMFLOAT4 planes[6];
+    ExtractFrustumPlanes( planes, viewProj );
+
+    if ( mDrawBaked ) {
+        if ( IsPatchVisible( planes ) ) {
+            UINT stride = sizeof( Vertex::Basic32 );
+            UINT offset = 0;
+
+            XMMATRIX world = XMMatrixIdentity();
+
+            Effects::BasicFX->SetDirLights( mDirLights );
+            Effects::BasicFX->SetEyePosW( mEyePosW );
+            Effects::BasicFX->SetWorld( world );
+            Effects::BasicFX->SetWorldInvTranspose( MathHelper::InverseTranspose( world ) );
+            Effects::BasicFX->SetWorldViewProj( world*view*proj );
+            Effects::BasicFX->SetTexTransform( XMMatrixIdentity() );
+            Effects::BasicFX->SetMaterial( mPatchMat );
+
+            mD3DImmediateContext->IASetVertexBuffers( 0, 1, &mBakedPatchVB, &stride, &offset );
+            mD3DImmediateContext->IASetIndexBuffer( mBakedPatchIB, DXGI_FORMAT_R32_UINT, 0 );
+            mD3DImmediateContext->RSSetState( RenderStates::WireframeRS );
+
+            D3DX11_TECHNIQUE_DESC techDesc;
+            Effects::BasicFX->Light1Tech->GetDesc( &techDesc );
+            for ( UINT p = 0; p < techDesc.Passes; ++p ) {
+                Effects::BasicFX->Light1Tech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
+                mD3DImmediateContext->DrawIndexed( mBakedPatchIndexCount, 0, 0 );
+            }
+        }
+
+        HR( mSwapChain->Present( 0, 0 ) );
+        return;
+    }
+
     mD3DImmediateContext->IASetInputLayout( InputLayouts::Pos );
     mD3DImmediateContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_16_CONTROL_POINT_PATCHLIST );
 
     UINT stride = sizeof( Vertex::Pos );
     UINT offset = 0;
 
+    // Factors from how large the patch edges are on screen and how far
+    // they curve away from straight lines.
+    XMFLOAT4X4 P;
+    XMStoreFloat4x4( &P, proj );
+
+    TessellationFactors::View tessView;
+    tessView.eye = mEyePosW;
+    tessView.pixelScale = 0.5f * mClientHeight * P._22;
+    tessView.frustumPlanes = planes;
+    mTessFactors.Compute( tessView, TessellationFactors::Settings() );
+    mPatchFactorBuffer.Update( mD3DImmediateContext, mTessFactors.GetFactors() );
+
     // Set per frame constants.
     Effects::BezierTessellationFX->SetEyePosW( mEyePosW );
     Effects::BezierTessellationFX->SetFogColor( Colors::Silver );
@@ -210,6 +305,7 @@ void App::drawScene( void )
         Effects::BezierTessellationFX->SetTexTransform( XMMatrixIdentity() );
         //Effects::BezierTessellationFX->SetMaterial(0);
         Effects::BezierTessellationFX->SetDiffuseMap( 0 );
+        Effects::BezierTessellationFX->SetPatchFactors( mPatchFactorBuffer.GetSRV() );
 
         Effects::BezierTessellationFX->TessTech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
 
@@ -311,6 +407,71 @@ void App::BuildQuadPatchBuffer()
     D3D11_SUBRESOURCE_DATA vinitData;
     vinitData.pSysMem = vertices;
     HR( mD3DDevice->CreateBuffer( &vbd, &vinitData, &mQuadPatchVB ) );
+
+    mTessFactors.Clear();
+    mTessFactors.AddBezierPatch( vertices );
+    mPatchFactorBuffer.Create( mD3DDevice, static_cast<UINT>( mTessFactors.GetPatchCount() ) );
+
+    mPatch.Set( vertices );
+    mPatch.GetBounds( mPatchBoundsMin, mPatchBoundsMax, 3 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void App::BuildBakedPatchBuffers()
+{
+    // About as fine as the tessellated patch gets up close.
+    GeometryGenerator::MeshData patch;
+    mPatch.Bake( 32, patch );
+
+    std::vector<Vertex::Basic32> vertices( patch.vertices.size() );
+    for ( size_t i = 0; i < patch.vertices.size(); ++i ) {
+        vertices[i].pos = patch.vertices[i].position;
+        vertices[i].normal = patch.vertices[i].normal;
+        vertices[i].tex = patch.vertices[i].texC;
+    }
+
+    D3D11_BUFFER_DESC vbd;
+    vbd.Usage = D3D11_USAGE_IMMUTABLE;
+    vbd.ByteWidth = static_cast<UINT>( sizeof( Vertex::Basic32 ) * vertices.size() );
+    vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    vbd.CPUAccessFlags = 0;
+    vbd.MiscFlags = 0;
+
+    D3D11_SUBRESOURCE_DATA vinitData;
+    vinitData.pSysMem = &vertices[0];
+    HR( mD3DDevice->CreateBuffer( &vbd, &vinitData, &mBakedPatchVB ) );
+
+    mBakedPatchIndexCount = static_cast<UINT>( patch.indices.size() );
+
+    D3D11_BUFFER_DESC ibd;
+    ibd.Usage = D3D11_USAGE_IMMUTABLE;
+    ibd.ByteWidth = sizeof( UINT ) * mBakedPatchIndexCount;
+    ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+    ibd.CPUAccessFlags = 0;
+    ibd.MiscFlags = 0;
+
+    D3D11_SUBRESOURCE_DATA iinitData;
+    iinitData.pSysMem = &patch.indices[0];
+    HR( mD3DDevice->CreateBuffer( &ibd, &iinitData, &mBakedPatchIB ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool App::IsPatchVisible( const XMFLOAT4 planes[6] ) const
+{
+    // Outside if the corner of the box furthest along some plane normal is
+    // still behind that plane.
+    for ( int i = 0; i < 6; ++i ) {
+        const XMFLOAT4& p = planes[i];
+        const float x = p.x >= 0.0f ? mPatchBoundsMax.x : mPatchBoundsMin.x;
+        const float y = p.y >= 0.0f ? mPatchBoundsMax.y : mPatchBoundsMin.y;
+        const float z = p.z >= 0.0f ? mPatchBoundsMax.z : mPatchBoundsMin.z;
+        if ( p.x * x + p.y * y + p.z * z + p.w < 0.0f ) {
+            return false;
+        }
+    }
+    return true;
 }
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
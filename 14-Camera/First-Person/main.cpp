@@ -298,6 +298,9 @@ void App::updateScene( const float dt )
 
 void App::drawScene( void )
 {
+    // Picks up edits to the .fx files while the demo runs.
+    Effects::ReloadChanged();
+
     mD3DImmediateContext->ClearRenderTargetView( mRenderTargetView, reinterpret_cast<const float*>( &Colors::Silver ) );
     mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
 
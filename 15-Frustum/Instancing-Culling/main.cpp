@@ -7,6 +7,7 @@
 #include "d3dx11Effect.h"
 #include "Effects.h"
 #include "GeometryGenerator.h"
+#include "JobSystem.h"
 #include "LightHelper.h"
 #include "MathHelper.h"
 #include "Vertex.h"
@@ -19,6 +20,14 @@ using namespace DirectX;
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
+// The skull grid is placed 20 km from the world origin, far enough that
+// absolute float coordinates would visibly jitter. The camera renders
+// relative to itself and the instances are rebased against it.
+static const double GridCenterX = 20000.0;
+static const double GridCenterZ = 20000.0;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
 struct InstancedData {
     XMFLOAT4X4 World;
     XMFLOAT4 Color;
@@ -59,11 +68,18 @@ private:
 
     UINT mVisibleObjectCount;
 
-    // Keep a system memory copy of the world matrices for culling.
+    // World placement of every instance, and a system memory copy of their
+    // camera-relative world matrices for culling.
+    std::vector<LargeWorld::Instance> mInstances;
     std::vector<InstancedData> mInstancedData;
 
     bool mFrustumCullingEnabled;
 
+    // The instances never move, so the visible set only needs rebuilding when
+    // the camera or the culling toggle changes.
+    UINT mCulledCamVersion;
+    bool mCulledWithFrustum;
+
     DirectionalLight mDirLights[3];
     Material mSkullMat;
 
@@ -100,7 +116,8 @@ int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE prevInstance,
 
 App::App( HINSTANCE hInstance )
     : D3DApp( hInstance ), mSkullVB( 0 ), mSkullIB( 0 ), mSkullIndexCount( 0 ), mInstancedBuffer( 0 ),
-    mVisibleObjectCount( 0 ), mFrustumCullingEnabled( true )
+    mVisibleObjectCount( 0 ), mFrustumCullingEnabled( true ),
+    mCulledCamVersion( 0 ), mCulledWithFrustum( false )
 {
     mMainWindowCaption = L"Instancing and Culling Demo";
 
@@ -109,7 +126,8 @@ App::App( HINSTANCE hInstance )
     mLastMousePos.x = 0;
     mLastMousePos.y = 0;
 
-    mCam.SetPosition( 0.0f, 2.0f, -15.0f );
+    mCam.SetCameraRelative( true );
+    mCam.SetWorldPosition( WorldPosition::FromDouble( GridCenterX, 2.0, GridCenterZ - 15.0 ) );
 
     XMMATRIX I = XMMatrixIdentity();
 
@@ -213,52 +231,63 @@ void App::updateScene( const float dt )
     // Perform frustum culling.
 
     mCam.UpdateViewMatrix();
-    mVisibleObjectCount = 0;
 
-    if ( mFrustumCullingEnabled ) {
-        XMVECTOR detView = XMMatrixDeterminant( mCam.View() );
-        XMMATRIX invView = XMMatrixInverse( &detView, mCam.View() );
+    if ( mCam.GetVersion() != mCulledCamVersion || mFrustumCullingEnabled != mCulledWithFrustum ) {
+        mCulledCamVersion = mCam.GetVersion();
+        mCulledWithFrustum = mFrustumCullingEnabled;
+        mVisibleObjectCount = 0;
 
-        D3D11_MAPPED_SUBRESOURCE mappedData;
-        mD3DImmediateContext->Map( mInstancedBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData );
+        LargeWorld::RebaseWorldMatrices( &mInstances[0],
+                                         mInstances.size(),
+                                         mCam.GetWorldPosition(),
+                                         &mInstancedData[0].World,
+                                         sizeof( InstancedData ),
+                                         &JobSystem::Instance() );
 
-        InstancedData* dataView = reinterpret_cast<InstancedData*>( mappedData.pData );
+        if ( mFrustumCullingEnabled ) {
+            XMMATRIX invView = mCam.InvView();
 
-        for ( UINT i = 0; i < mInstancedData.size(); ++i ) {
-            XMMATRIX W = XMLoadFloat4x4( &mInstancedData[i].World );
-            XMMATRIX invWorld = XMMatrixInverse( &XMMatrixDeterminant( W ), W );
+            D3D11_MAPPED_SUBRESOURCE mappedData;
+            mD3DImmediateContext->Map( mInstancedBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData );
 
-            // View space to local space.
-            XMMATRIX toLocal = XMMatrixMultiply( invView, invWorld );
+            InstancedData* dataView = reinterpret_cast<InstancedData*>( mappedData.pData );
 
-            // Decompose the matrix into individual parts.
-            XMVECTOR scale, rotation, translation;
-            XMMatrixDecompose( &scale, &rotation, &translation, toLocal );
+            for ( UINT i = 0; i < mInstancedData.size(); ++i ) {
+                XMMATRIX W = XMLoadFloat4x4( &mInstancedData[i].World );
+                XMMATRIX invWorld = XMMatrixInverse( &XMMatrixDeterminant( W ), W );
 
-            // Transform the camera frustum from view space to object's local space.
-            BoundingFrustum localFrust;
-            mCamFrustum.Transform( localFrust, XMVectorGetX( scale ), rotation, translation );
+                // View space to local space.
+                XMMATRIX toLocal = XMMatrixMultiply( invView, invWorld );
 
-            // Test intersection of frustum with box.
-            if ( localFrust.Contains( mSkullBox ) ) {
-                dataView[mVisibleObjectCount++] = mInstancedData[i];
+                // Decompose the matrix into individual parts.
+                XMVECTOR scale, rotation, translation;
+                XMMatrixDecompose( &scale, &rotation, &translation, toLocal );
+
+                // Transform the camera frustum from view space to object's local space.
+                BoundingFrustum localFrust;
+                mCamFrustum.Transform( localFrust, XMVectorGetX( scale ), rotation, translation );
+
+                // Test intersection of frustum with box.
+                if ( localFrust.Contains( mSkullBox ) ) {
+                    dataView[mVisibleObjectCount++] = mInstancedData[i];
+                }
             }
+
+            mD3DImmediateContext->Unmap( mInstancedBuffer, 0 );
         }
+        else {
+            D3D11_MAPPED_SUBRESOURCE mappedData;
+            mD3DImmediateContext->Map( mInstancedBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData );
 
-        mD3DImmediateContext->Unmap( mInstancedBuffer, 0 );
-    }
-    else {
-        D3D11_MAPPED_SUBRESOURCE mappedData;
-        mD3DImmediateContext->Map( mInstancedBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData );
+            InstancedData* dataView = reinterpret_cast<InstancedData*>( mappedData.pData );
 
-        InstancedData* dataView = reinterpret_cast<InstancedData*>( mappedData.pData );
+            for ( UINT i = 0; i < mInstancedData.size(); ++i )
+            {
+                dataView[mVisibleObjectCount++] = mInstancedData[i];
+            }
 
-        for ( UINT i = 0; i < mInstancedData.size(); ++i )
-        {
-            dataView[mVisibleObjectCount++] = mInstancedData[i];
+            mD3DImmediateContext->Unmap( mInstancedBuffer, 0 );
         }
-
-        mD3DImmediateContext->Unmap( mInstancedBuffer, 0 );
     }
 
     std::wostringstream outs;
@@ -273,6 +302,9 @@ void App::updateScene( const float dt )
 
 void App::drawScene( void )
 {
+    // Picks up edits to the .fx files while the demo runs.
+    Effects::ReloadChanged();
+
     mD3DImmediateContext->ClearRenderTargetView( mRenderTargetView, reinterpret_cast<const float*>( &Colors::Silver ) );
     mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
 
@@ -437,8 +469,13 @@ void App::BuildSkullGeometryBuffers()
 void App::BuildInstancedBuffer()
 {
     const int n = 5;
+    mInstances.resize( n*n*n );
     mInstancedData.resize( n*n*n );
 
+    const XMFLOAT3X3 identity( 1.0f, 0.0f, 0.0f,
+                               0.0f, 1.0f, 0.0f,
+                               0.0f, 0.0f, 1.0f );
+
     float width = 200.0f;
     float height = 200.0f;
     float depth = 200.0f;
@@ -455,12 +492,12 @@ void App::BuildInstancedBuffer()
         {
             for ( int j = 0; j < n; ++j )
             {
-                // Position instanced along a 3D grid.
-                mInstancedData[k*n*n + i*n + j].World = XMFLOAT4X4(
-                    1.0f, 0.0f, 0.0f, 0.0f,
-                    0.0f, 1.0f, 0.0f, 0.0f,
-                    0.0f, 0.0f, 1.0f, 0.0f,
-                    x + j*dx, y + i*dy, z + k*dz, 1.0f );
+                // Position instanced along a 3D grid. The world matrices are
+                // filled in relative to the camera every time it moves.
+                mInstances[k*n*n + i*n + j].axes = identity;
+                mInstances[k*n*n + i*n + j].position = WorldPosition::FromDouble( GridCenterX + x + j*dx,
+                                                                                  y + i*dy,
+                                                                                  GridCenterZ + z + k*dz );
 
                 // Random color.
                 mInstancedData[k*n*n + i*n + j].Color.x = MathHelper::RandF( 0.0f, 1.0f );
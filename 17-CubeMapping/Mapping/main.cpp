@@ -10,6 +10,7 @@
 #include "GeometryGenerator.h"
 #include "LightHelper.h"
 #include "MathHelper.h"
+#include "ReflectionProbes.h"
 #include "RenderStates.h"
 #include "Sky.h"
 #include "Vertex.h"
@@ -20,6 +21,19 @@ using namespace DirectX;
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
+// What the cube map can see, in the order the probe scheduler is given it.
+enum SceneObject {
+    GridObject = 0,
+    BoxObject = 1,
+    FirstCylinderObject = 2,
+    FirstSphereObject = 12,
+    SkullObject = 22,
+    CenterSphereObject = 23,
+    SceneObjectCount = 24
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
 class App : public D3DApp {
 
 public:
@@ -38,8 +52,9 @@ public:
 
 private:
 
-    void drawScene( const Camera& camera, bool drawSkull );
+    void drawScene( const Camera& camera, const bool visible[SceneObjectCount] );
     void BuildCubeFaceCamera( float x, float y, float z );
+    void BuildSceneObjects();
     void BuildDynamicCubeMapViews();
     void BuildShapeGeometryBuffers();
     void BuildSkullGeometryBuffers();
@@ -105,6 +120,12 @@ private:
     Camera mCam;
     Camera mCubeMapCamera[6];
 
+    // Picks the cube map faces to render each frame, and what each sees.
+    ReflectionProbes mProbes;
+    std::vector<ReflectionProbes::Object> mSceneObjects;
+    XMFLOAT3 mSkullCenter;
+    float mSkullRadius;
+
     POINT mLastMousePos;
 
 };
@@ -134,7 +155,8 @@ App::App( HINSTANCE hInstance )
     mShapesVB( 0 ), mShapesIB( 0 ), mSkullVB( 0 ), mSkullIB( 0 ),
     mFloorTexSRV( 0 ), mStoneTexSRV( 0 ), mBrickTexSRV( 0 ),
     mDynamicCubeMapDSV( 0 ), mDynamicCubeMapSRV( 0 ),
-    mSkullIndexCount( 0 ), mLightCount( 3 )
+    mSkullIndexCount( 0 ), mLightCount( 3 ),
+    mSkullCenter( 0.0f, 0.0f, 0.0f ), mSkullRadius( 0.0f )
 {
     mMainWindowCaption = L"Cube Mapping Demo";
 
@@ -214,6 +236,9 @@ App::App( HINSTANCE hInstance )
     mCenterSphereMat.diffuse = XMFLOAT4( 0.2f, 0.2f, 0.2f, 1.0f );
     mCenterSphereMat.specular = XMFLOAT4( 0.8f, 0.8f, 0.8f, 16.0f );
     mCenterSphereMat.reflect = XMFLOAT4( 0.8f, 0.8f, 0.8f, 1.0f );
+
+    BuildSceneObjects();
+    mProbes.AddProbe( XMFLOAT3( 0.0f, 2.0f, 0.0f ), 1.0f, CenterSphereObject );
 }
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -341,7 +366,12 @@ void App::updateScene( const float dt )
     XMMATRIX skullOffset = XMMatrixTranslation( 3.0f, 2.0f, 0.0f );
     XMMATRIX skullLocalRotate = XMMatrixRotationY( 2.0f*mTimer.totalTime() );
     XMMATRIX skullGlobalRotate = XMMatrixRotationY( 0.5f*mTimer.totalTime() );
-    XMStoreFloat4x4( &mSkullWorld, skullScale*skullLocalRotate*skullOffset*skullGlobalRotate );
+    XMMATRIX skullWorld = skullScale*skullLocalRotate*skullOffset*skullGlobalRotate;
+    XMStoreFloat4x4( &mSkullWorld, skullWorld );
+
+    ReflectionProbes::Object& skull = mSceneObjects[SkullObject];
+    XMStoreFloat3( &skull.center, XMVector3Transform( XMLoadFloat3( &mSkullCenter ), skullWorld ) );
+    skull.radius = 0.2f * mSkullRadius;
 
     mCam.UpdateViewMatrix();
 }
@@ -350,12 +380,38 @@ void App::updateScene( const float dt )
 
 void App::drawScene( void )
 {
+    // Picks up edits to the .fx files while the demo runs.
+    Effects::ReloadChanged();
+
     ID3D11RenderTargetView* renderTargets[1];
 
+    // Only the cube map faces the scheduler picks are rendered: those
+    // something moved in, a couple per frame at most, each drawing only
+    // what its frustum holds. The rest keep what they last had.
+    XMFLOAT4X4 P;
+    XMStoreFloat4x4( &P, mCam.Proj() );
+
+    ReflectionProbes::View probeView;
+    probeView.eye = mCam.GetPosition();
+    probeView.pixelScale = 0.5f * mClientHeight * P._22;
+    probeView.frustumPlanes = mCam.GetFrustumPlanes();
+    mProbes.Schedule( probeView, &mSceneObjects[0], mSceneObjects.size(), ReflectionProbes::Settings() );
+
+    const std::vector<ReflectionProbes::FaceUpdate>& updates = mProbes.GetUpdates();
+    const std::vector<uint32_t>& drawList = mProbes.GetDrawList();
+
     // Generate the cube map.
     mD3DImmediateContext->RSSetViewports( 1, &mCubeMapViewport );
-    for ( int i = 0; i < 6; ++i )
+    for ( size_t u = 0; u < updates.size(); ++u )
     {
+        const uint32_t i = updates[u].face;
+
+        bool visible[SceneObjectCount] = { false };
+        for ( size_t k = 0; k < updates[u].count; ++k )
+        {
+            visible[drawList[updates[u].first + k]] = true;
+        }
+
         // Clear cube map face and depth buffer.
         mD3DImmediateContext->ClearRenderTargetView( mDynamicCubeMapRTV[i], reinterpret_cast<const float*>( &Colors::Silver ) );
         mD3DImmediateContext->ClearDepthStencilView( mDynamicCubeMapDSV, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
@@ -364,8 +420,8 @@ void App::drawScene( void )
         renderTargets[0] = mDynamicCubeMapRTV[i];
         mD3DImmediateContext->OMSetRenderTargets( 1, renderTargets, mDynamicCubeMapDSV );
 
-        // Draw the scene with the exception of the center sphere to this cube map face.
-        drawScene( mCubeMapCamera[i], false );
+        // Draw what the face sees, which never includes the center sphere.
+        drawScene( mCubeMapCamera[i], visible );
     }
 
     // Restore old viewport and render targets.
@@ -374,18 +430,22 @@ void App::drawScene( void )
     mD3DImmediateContext->OMSetRenderTargets( 1, renderTargets, mDepthStencilView );
 
     // Have hardware generate lower mipmap levels of cube map.
-    mD3DImmediateContext->GenerateMips( mDynamicCubeMapSRV );
+    if ( !updates.empty() )
+        mD3DImmediateContext->GenerateMips( mDynamicCubeMapSRV );
 
     // Now draw the scene as normal, but with the center sphere.
     mD3DImmediateContext->ClearRenderTargetView( mRenderTargetView, reinterpret_cast<const float*>( &Colors::Silver ) );
     mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
 
-    drawScene( mCam, true );
+    bool visible[SceneObjectCount];
+    for ( int i = 0; i < SceneObjectCount; ++i )
+        visible[i] = true;
+    drawScene( mCam, visible );
 
     HR( mSwapChain->Present( 0, 0 ) );
 }
 
-void App::drawScene( const Camera& camera, bool drawCenterSphere )
+void App::drawScene( const Camera& camera, const bool visible[SceneObjectCount] )
 {
     mD3DImmediateContext->IASetInputLayout( InputLayouts::Basic32 );
     mD3DImmediateContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
@@ -444,38 +504,47 @@ void App::drawScene( const Camera& camera, bool drawCenterSphere )
     for ( UINT p = 0; p < techDesc.Passes; ++p )
     {
         // Draw the grid.
-        world = XMLoadFloat4x4( &mGridWorld );
-        worldInvTranspose = MathHelper::InverseTranspose( world );
-        worldViewProj = world*view*proj;
+        if ( visible[GridObject] )
+        {
+            world = XMLoadFloat4x4( &mGridWorld );
+            worldInvTranspose = MathHelper::InverseTranspose( world );
+            worldViewProj = world*view*proj;
 
-        Effects::BasicFX->SetWorld( world );
-        Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-        Effects::BasicFX->SetWorldViewProj( worldViewProj );
-        Effects::BasicFX->SetTexTransform( XMMatrixScaling( 6.0f, 8.0f, 1.0f ) );
-        Effects::BasicFX->SetMaterial( mGridMat );
-        Effects::BasicFX->SetDiffuseMap( mFloorTexSRV );
+            Effects::BasicFX->SetWorld( world );
+            Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
+            Effects::BasicFX->SetWorldViewProj( worldViewProj );
+            Effects::BasicFX->SetTexTransform( XMMatrixScaling( 6.0f, 8.0f, 1.0f ) );
+            Effects::BasicFX->SetMaterial( mGridMat );
+            Effects::BasicFX->SetDiffuseMap( mFloorTexSRV );
 
-        activeTexTech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-        mD3DImmediateContext->DrawIndexed( mGridIndexCount, mGridIndexOffset, mGridVertexOffset );
+            activeTexTech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
+            mD3DImmediateContext->DrawIndexed( mGridIndexCount, mGridIndexOffset, mGridVertexOffset );
+        }
 
         // Draw the box.
-        world = XMLoadFloat4x4( &mBoxWorld );
-        worldInvTranspose = MathHelper::InverseTranspose( world );
-        worldViewProj = world*view*proj;
+        if ( visible[BoxObject] )
+        {
+            world = XMLoadFloat4x4( &mBoxWorld );
+            worldInvTranspose = MathHelper::InverseTranspose( world );
+            worldViewProj = world*view*proj;
 
-        Effects::BasicFX->SetWorld( world );
-        Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-        Effects::BasicFX->SetWorldViewProj( worldViewProj );
-        Effects::BasicFX->SetTexTransform( XMMatrixIdentity() );
-        Effects::BasicFX->SetMaterial( mBoxMat );
-        Effects::BasicFX->SetDiffuseMap( mStoneTexSRV );
+            Effects::BasicFX->SetWorld( world );
+            Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
+            Effects::BasicFX->SetWorldViewProj( worldViewProj );
+            Effects::BasicFX->SetTexTransform( XMMatrixIdentity() );
+            Effects::BasicFX->SetMaterial( mBoxMat );
+            Effects::BasicFX->SetDiffuseMap( mStoneTexSRV );
 
-        activeTexTech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-        mD3DImmediateContext->DrawIndexed( mBoxIndexCount, mBoxIndexOffset, mBoxVertexOffset );
+            activeTexTech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
+            mD3DImmediateContext->DrawIndexed( mBoxIndexCount, mBoxIndexOffset, mBoxVertexOffset );
+        }
 
         // Draw the cylinders.
         for ( int i = 0; i < 10; ++i )
         {
+            if ( !visible[FirstCylinderObject + i] )
+                continue;
+
             world = XMLoadFloat4x4( &mCylWorld[i] );
             worldInvTranspose = MathHelper::InverseTranspose( world );
             worldViewProj = world*view*proj;
@@ -498,6 +567,9 @@ void App::drawScene( const Camera& camera, bool drawCenterSphere )
         // Draw the spheres.
         for ( int i = 0; i < 10; ++i )
         {
+            if ( !visible[FirstSphereObject + i] )
+                continue;
+
             world = XMLoadFloat4x4( &mSphereWorld[i] );
             worldInvTranspose = MathHelper::InverseTranspose( world );
             worldViewProj = world*view*proj;
@@ -518,7 +590,7 @@ void App::drawScene( const Camera& camera, bool drawCenterSphere )
     // Draw the skull.
     //    
     activeRTech->GetDesc( &techDesc );
-    for ( UINT p = 0; p < techDesc.Passes; ++p )
+    for ( UINT p = 0; p < techDesc.Passes && visible[SkullObject]; ++p )
     {
         mD3DImmediateContext->IASetVertexBuffers( 0, 1, &mSkullVB, &stride, &offset );
         mD3DImmediateContext->IASetIndexBuffer( mSkullIB, DXGI_FORMAT_R32_UINT, 0 );
@@ -540,7 +612,7 @@ void App::drawScene( const Camera& camera, bool drawCenterSphere )
     //
     // Draw the center sphere with the dynamic cube map.
     //
-    if ( drawCenterSphere )
+    if ( visible[CenterSphereObject] )
     {
         mD3DImmediateContext->IASetVertexBuffers( 0, 1, &mShapesVB, &stride, &offset );
         mD3DImmediateContext->IASetIndexBuffer( mShapesIB, DXGI_FORMAT_R32_UINT, 0 );
@@ -652,6 +724,41 @@ void App::BuildCubeFaceCamera( float x, float y, float z )
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
+void App::BuildSceneObjects()
+{
+    // Bounding spheres of the shapes as BuildShapeGeometryBuffers() makes
+    // them, placed by their world matrices. Only the skull moves; its
+    // sphere follows it in updateScene().
+    mSceneObjects.resize( SceneObjectCount );
+
+    auto place = [this]( const int object, const XMFLOAT4X4& world, const float radius, const bool moving ) {
+        ReflectionProbes::Object& o = mSceneObjects[object];
+        o.center = XMFLOAT3( world._41, world._42, world._43 );
+        o.radius = radius;
+        o.moving = moving;
+    };
+
+    // 20 x 30 grid, 3 x 1 x 3 box.
+    place( GridObject, mGridWorld, sqrtf( 10.0f*10.0f + 15.0f*15.0f ), false );
+    place( BoxObject, mBoxWorld, sqrtf( 1.5f*1.5f + 0.5f*0.5f + 1.5f*1.5f ), false );
+
+    for ( int i = 0; i < 10; ++i )
+    {
+        // Cylinders 3 high and 0.5 across at the base; spheres of 0.5.
+        place( FirstCylinderObject + i, mCylWorld[i], sqrtf( 1.5f*1.5f + 0.5f*0.5f ), false );
+        place( FirstSphereObject + i, mSphereWorld[i], 0.5f, false );
+    }
+
+    ReflectionProbes::Object& skull = mSceneObjects[SkullObject];
+    skull.center = XMFLOAT3( 0.0f, 0.0f, 0.0f );
+    skull.radius = 0.0f;
+    skull.moving = true;
+
+    place( CenterSphereObject, mCenterSphereWorld, 1.0f, false );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
 void App::BuildDynamicCubeMapViews()
 {
     //
@@ -901,6 +1008,24 @@ void App::BuildSkullGeometryBuffers()
 
     fin.close();
 
+    // Bounding sphere of the model, around the middle of its box, for
+    // culling it out of cube map faces.
+    XMFLOAT3 vMin( +MathHelper::Infinity, +MathHelper::Infinity, +MathHelper::Infinity );
+    XMFLOAT3 vMax( -MathHelper::Infinity, -MathHelper::Infinity, -MathHelper::Infinity );
+    for ( UINT i = 0; i < vcount; ++i )
+    {
+        XMStoreFloat3( &vMin, XMVectorMin( XMLoadFloat3( &vMin ), XMLoadFloat3( &vertices[i].pos ) ) );
+        XMStoreFloat3( &vMax, XMVectorMax( XMLoadFloat3( &vMax ), XMLoadFloat3( &vertices[i].pos ) ) );
+    }
+
+    mSkullCenter = XMFLOAT3( 0.5f*( vMin.x + vMax.x ), 0.5f*( vMin.y + vMax.y ), 0.5f*( vMin.z + vMax.z ) );
+    mSkullRadius = 0.0f;
+    for ( UINT i = 0; i < vcount; ++i )
+    {
+        const XMVECTOR d = XMVectorSubtract( XMLoadFloat3( &vertices[i].pos ), XMLoadFloat3( &mSkullCenter ) );
+        mSkullRadius = MathHelper::Max( mSkullRadius, XMVectorGetX( XMVector3Length( d ) ) );
+    }
+
     D3D11_BUFFER_DESC vbd;
     vbd.Usage = D3D11_USAGE_IMMUTABLE;
     vbd.ByteWidth = sizeof( Vertex::Basic32 ) * vcount;
@@ -9,24 +9,10 @@ cbuffer cbPerFrame {
     float  gFogRange;
     float4 gFogColor;
 
-    // When distance is minimum, the tessellation is maximum.
-    // When distance is maximum, the tessellation is minimum.
-    float gMinDist;
-    float gMaxDist;
-
-    // Exponents for power of 2 tessellation.  The tessellation
-    // range is [2^(gMinTess), 2^(gMaxTess)].  Since the maximum
-    // tessellation is 64, this means gMaxTess can be at most 6
-    // since 2^6 = 64.
-    float gMinTess;
-    float gMaxTess;
-
     float gTexelCellSpaceU;
     float gTexelCellSpaceV;
     float gWorldCellSpace;
     float2 gTexScale = 50.0f;
-
-    float4 gWorldFrustumPlanes[6];
 };
 
 cbuffer cbPerObject {
@@ -86,50 +72,18 @@ VertexOut VS( VertexIn vin )
     return vout;
 }
 
-float CalcTessFactor( float3 p )
-{
-    float d = distance( p, gEyePosW );
-
-    // max norm in xz plane (useful to see detail levels from a bird's eye).
-    //float d = max( abs(p.x-gEyePosW.x), abs(p.z-gEyePosW.z) );
-
-    float s = saturate( ( d - gMinDist ) / ( gMaxDist - gMinDist ) );
-
-    return pow( 2, ( lerp( gMaxTess, gMinTess, s ) ) );
-}
-
-// Returns true if the box is completely behind (in negative half space) of plane.
-bool AabbBehindPlaneTest( float3 center, float3 extents, float4 plane )
-{
-    float3 n = abs( plane.xyz );
-
-    // This is always positive.
-    float r = dot( extents, n );
-
-    // signed distance from center point to plane.
-    float s = dot( float4( center, 1.0f ), plane );
-
-    // If the center point of the box is a distance of e or more behind the
-    // plane (in which case s is negative since it is behind the plane),
-    // then the box is completely in the negative half space of the plane.
-    return ( s + r ) < 0.0f;
-}
-
-// Returns true if the box is completely outside the frustum.
-bool AabbOutsideFrustumTest( float3 center, float3 extents, float4 frustumPlanes[6] )
-{
-    for ( int i = 0; i < 6; ++i )
-    {
-        // If the box is completely behind any of the frustum planes
-        // then it is outside the frustum.
-        if ( AabbBehindPlaneTest( center, extents, frustumPlanes[i] ) )
-        {
-            return true;
-        }
-    }
+// Factors per patch, indexed by SV_PrimitiveID. They are worked out on the
+// CPU (TessellationFactors) from the on-screen length of each edge and how
+// far the heightmap along it strays from a straight line; patches that
+// share an edge read the same factor for it. Patches outside the frustum
+// have factors of 0 and are dropped.
+struct PatchFactors {
+    float4 Edges;
+    float2 Inside;
+    float2 Pad;
+};
 
-    return false;
-}
+StructuredBuffer<PatchFactors> gPatchFactors;
 
 struct PatchTess {
     float EdgeTess[4]   : SV_TessFactor;
@@ -140,59 +94,17 @@ PatchTess ConstantHS( InputPatch<VertexOut, 4> patch, uint patchID : SV_Primitiv
 {
     PatchTess pt;
 
-    //
-    // Frustum cull
-    //
+    PatchFactors factors = gPatchFactors[patchID];
 
-    // We store the patch BoundsY in the first control point.
-    float minY = patch[0].BoundsY.x;
-    float maxY = patch[0].BoundsY.y;
+    pt.EdgeTess[0] = factors.Edges.x;
+    pt.EdgeTess[1] = factors.Edges.y;
+    pt.EdgeTess[2] = factors.Edges.z;
+    pt.EdgeTess[3] = factors.Edges.w;
 
-    // Build axis-aligned bounding box.  patch[2] is lower-left corner
-    // and patch[1] is upper-right corner.
-    float3 vMin = float3( patch[2].PosW.x, minY, patch[2].PosW.z );
-    float3 vMax = float3( patch[1].PosW.x, maxY, patch[1].PosW.z );
+    pt.InsideTess[0] = factors.Inside.x;
+    pt.InsideTess[1] = factors.Inside.y;
 
-    float3 boxCenter = 0.5f*( vMin + vMax );
-    float3 boxExtents = 0.5f*( vMax - vMin );
-    if ( AabbOutsideFrustumTest( boxCenter, boxExtents, gWorldFrustumPlanes ) )
-    {
-        pt.EdgeTess[0] = 0.0f;
-        pt.EdgeTess[1] = 0.0f;
-        pt.EdgeTess[2] = 0.0f;
-        pt.EdgeTess[3] = 0.0f;
-
-        pt.InsideTess[0] = 0.0f;
-        pt.InsideTess[1] = 0.0f;
-
-        return pt;
-    }
-    //
-    // Do normal tessellation based on distance.
-    //
-    else
-    {
-        // It is important to do the tess factor calculation based on the
-        // edge properties so that edges shared by more than one patch will
-        // have the same tessellation factor.  Otherwise, gaps can appear.
-
-        // Compute midpoint on edges, and patch center
-        float3 e0 = 0.5f*( patch[0].PosW + patch[2].PosW );
-        float3 e1 = 0.5f*( patch[0].PosW + patch[1].PosW );
-        float3 e2 = 0.5f*( patch[1].PosW + patch[3].PosW );
-        float3 e3 = 0.5f*( patch[2].PosW + patch[3].PosW );
-        float3  c = 0.25f*( patch[0].PosW + patch[1].PosW + patch[2].PosW + patch[3].PosW );
-
-        pt.EdgeTess[0] = CalcTessFactor( e0 );
-        pt.EdgeTess[1] = CalcTessFactor( e1 );
-        pt.EdgeTess[2] = CalcTessFactor( e2 );
-        pt.EdgeTess[3] = CalcTessFactor( e3 );
-
-        pt.InsideTess[0] = CalcTessFactor( c );
-        pt.InsideTess[1] = pt.InsideTess[0];
-
-        return pt;
-    }
+    return pt;
 }
 
 struct HullOut {
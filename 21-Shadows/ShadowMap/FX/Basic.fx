@@ -66,6 +66,14 @@ struct VertexIn {
     float2 Tex : TEXCOORD;
 };
 
+struct InstancedVertexIn {
+    float3 PosL : POSITION;
+    float3 NormalL : NORMAL;
+    float2 Tex : TEXCOORD;
+    row_major float4x4 World : WORLD;
+    row_major float4x4 WorldInvTranspose : WORLDINVTRANSPOSE;
+};
+
 struct VertexOut {
     float4 PosH : SV_POSITION;
     float3 PosW : POSITION;
@@ -97,6 +105,28 @@ VertexOut VS( VertexIn vin )
     return vout;
 }
 
+// Instanced Vertex Shader. gWorldViewProj holds only view * proj and
+// gShadowTransform only the light's transform here.
+VertexOut InstancedVS( InstancedVertexIn vin )
+{
+    VertexOut vout;
+
+    // Transform to world space.
+    vout.PosW = mul( float4( vin.PosL, 1.f ), vin.World ).xyz;
+    vout.NormalW = mul( vin.NormalL, ( float3x3 )vin.WorldInvTranspose );
+
+    // Transform to homogeneous clip space.
+    vout.PosH = mul( float4( vout.PosW, 1.f ), gWorldViewProj );
+
+    // Output vertex attributes for interpolation across triangle.
+    vout.Tex = mul( float4( vin.Tex, 0.f, 1.f ), gTexTransform ).xy;
+
+    // Generate projective tex-coords to project shadow map onto scene.
+    vout.ShadowPosH = mul( float4( vout.PosW, 1.0f ), gShadowTransform );
+
+    return vout;
+}
+
 // ================================================= //
 
 // Pixel Shader.
@@ -550,4 +580,20 @@ technique11 Light3TexAlphaClipFogReflect {
     }
 }
 
-// ================================================= //
\ No newline at end of file
+// ================================================= //
+
+technique11 Light3TexInstanced {
+    pass P0 {
+        SetVertexShader( CompileShader( vs_5_0, InstancedVS() ) );
+        SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS( 3, true, false, false, false ) ) );
+    }
+}
+
+technique11 Light3ReflectInstanced {
+    pass P0 {
+        SetVertexShader( CompileShader( vs_5_0, InstancedVS() ) );
+        SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS( 3, false, false, false, true ) ) );
+    }
+}
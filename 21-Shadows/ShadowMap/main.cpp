@@ -2,13 +2,20 @@
 /// \file main.cpp
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
+#include <algorithm>
+#include <vector>
+
 #include "Camera.h"
 #include "D3DApp.h"
+#include "D3DRenderBackend.h"
 #include "d3dx11Effect.h"
 #include "Effects.h"
 #include "GeometryGenerator.h"
+#include "InstanceBatcher.h"
+#include "InstanceBuffer.h"
 #include "LightHelper.h"
 #include "MathHelper.h"
+#include "RenderQueue.h"
 #include "RenderStates.h"
 #include "Sky.h"
 #include "Terrain.h"
@@ -55,9 +62,31 @@ private:
     void BuildShapeGeometryBuffers();
     void BuildSkullGeometryBuffers();
     void BuildScreenQuadGeometryBuffers();
+    void BuildSceneObjects();
 
 private:
 
+    // What drawScene() queues for each object. Ids go into the sort key;
+    // mapped objects are drawn with the technique the render options pick,
+    // the others reflect the sky.
+    struct SceneObject {
+        const XMFLOAT4X4* world;
+        const Material* material;
+        XMFLOAT4X4 texTransform;
+        ID3D11ShaderResourceView* diffuseMap;
+        ID3D11ShaderResourceView* normalMap;
+        bool mapped;
+        unsigned int materialId;
+        unsigned int meshId;
+        ID3D11InputLayout* inputLayout;
+        ID3D11Buffer* vb;
+        UINT vertexStride;
+        ID3D11Buffer* ib;
+        UINT indexCount;
+        UINT startIndex;
+        int baseVertex;
+    };
+
     Sky* mSky;
 
     ID3D11Buffer* mShapesVB;
@@ -121,6 +150,11 @@ private:
 
     RenderOptions mRenderOptions;
 
+    std::vector<SceneObject> mObjects;
+    InstanceBatcher mBatcher;
+    InstanceBuffer mInstanceBuffer;
+    RenderQueue mRenderQueue;
+
     Camera mCam;
 
     POINT mLastMousePos;
@@ -257,6 +291,7 @@ App::~App( void )
     ReleaseCOM( mBrickTexSRV );
     ReleaseCOM( mStoneNormalTexSRV );
     ReleaseCOM( mBrickNormalTexSRV );
+    mInstanceBuffer.Release();
 
     Effects::DestroyAll();
     InputLayouts::DestroyAll();
@@ -327,6 +362,9 @@ bool App::init( void )
     BuildShapeGeometryBuffers();
     BuildSkullGeometryBuffers();
     BuildScreenQuadGeometryBuffers();
+    BuildSceneObjects();
+
+    mInstanceBuffer.Create( mD3DDevice, sizeof( InstanceBatcher::Instance ), 1024 );
     
     return true;
 }
@@ -402,6 +440,9 @@ void App::updateScene( const float dt )
 
 void App::drawScene( void )
 {
+    // Picks up edits to the .fx files while the demo runs.
+    Effects::ReloadChanged();
+
     mSmap->BindDsvAndSetNullRenderTarget( mD3DImmediateContext );
 
     DrawSceneToShadowMap();
@@ -419,16 +460,19 @@ void App::drawScene( void )
     mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
 
     XMMATRIX view = mCam.View();
-    XMMATRIX proj = mCam.Proj();
     XMMATRIX viewProj = mCam.ViewProj();
 
     float blendFactor [] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
-    // Set per frame constants.
-    Effects::BasicFX->SetDirLights( mDirLights );
-    Effects::BasicFX->SetEyePosW( mCam.GetPosition() );
-    Effects::BasicFX->SetCubeMap( mSky->CubeMapSRV() );
-    Effects::BasicFX->SetShadowMap( mSmap->DepthMapSRV() );
+    // Set per frame constants. The basic effect reads its lights and eye
+    // position from the shared per-frame buffer, uploaded by Apply().
+    CBPerFrame& perFrame = Effects::PerFrame.Edit();
+    std::copy( mDirLights, mDirLights + 3, perFrame.DirLights );
+    perFrame.EyePosW = mCam.GetPosition();
+
+    BasicEffect* basicFX = Effects::BasicFX.Get();
+    basicFX->SetCubeMap( mSky->CubeMapSRV() );
+    basicFX->SetShadowMap( mSmap->DepthMapSRV() );
 
     Effects::NormalMapFX->SetDirLights( mDirLights );
     Effects::NormalMapFX->SetEyePosW( mCam.GetPosition() );
@@ -447,121 +491,179 @@ void App::drawScene( void )
     Effects::DisplacementMapFX->SetMinTessFactor( 1.0f );
     Effects::DisplacementMapFX->SetMaxTessFactor( 5.0f );
 
-    // Figure out which technique to use for different geometry.
-
-    ID3DX11EffectTechnique* tech = Effects::DisplacementMapFX->Light3TexTech;
-    ID3DX11EffectTechnique* activeSphereTech = Effects::BasicFX->Light3ReflectTech;
-    ID3DX11EffectTechnique* activeSkullTech = Effects::BasicFX->Light3ReflectTech;
+    // Figure out which technique to use for the grid, box and cylinders;
+    // the spheres and the skull always reflect the sky.
+    ID3DX11EffectTechnique* mappedTech = Effects::DisplacementMapFX->Light3TexTech;
+    D3D11_PRIMITIVE_TOPOLOGY mappedTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
     switch ( mRenderOptions )
     {
     case RenderOptionsBasic:
-        tech = Effects::BasicFX->Light3TexTech;
-        mD3DImmediateContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+        mappedTech = basicFX->Light3TexTech;
         break;
     case RenderOptionsNormalMap:
-        tech = Effects::NormalMapFX->Light3TexTech;
-        mD3DImmediateContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+        mappedTech = Effects::NormalMapFX->Light3TexTech;
         break;
     case RenderOptionsDisplacementMap:
-        tech = Effects::DisplacementMapFX->Light3TexTech;
-        mD3DImmediateContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST );
+        mappedTech = Effects::DisplacementMapFX->Light3TexTech;
+        mappedTopology = D3D11_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST;
         break;
     }
+    ID3DX11EffectTechnique* reflectTech = basicFX->Light3ReflectTech;
 
-    XMMATRIX world;
-    XMMATRIX worldInvTranspose;
-    XMMATRIX worldViewProj;
+    // The shapes are drawn in wireframe while '1' is held.
+    ID3D11RasterizerState* shapesRS = ( GetAsyncKeyState( '1' ) & 0x8000 ) ? RenderStates::WireframeRS : nullptr;
 
     XMMATRIX shadowTransform = XMLoadFloat4x4( &mShadowTransform );
 
-    //
-    // Draw the grid, cylinders, and box without any cubemap reflection.
-    // 
-
-    UINT stride = sizeof( Vertex::PosNormalTexTan );
-    UINT offset = 0;
+    // Stages one object's constants for the basic effect. gShadowTransform
+    // is not part of CBPerObject, so it is still set on its own.
+    auto setBasicObject = [basicFX, &viewProj, &shadowTransform]( CXMMATRIX world, CXMMATRIX texTransform, const Material& mat ) {
+        CBPerObject perObject;
+        perObject.SetTransforms( world, viewProj );
+        perObject.SetTexTransform( texTransform );
+        perObject.Mat = mat;
+        basicFX->PerObject.Set( perObject );
+        basicFX->SetShadowTransform( world*shadowTransform );
+    };
+
+    // Group the objects sharing a mesh and a material. The spheres, and the
+    // cylinders while they use the basic effect, are drawn one instanced
+    // draw per group, from instance data written for all groups at once.
+    bool instancing = InputLayouts::InstancedPosNormalTexTan != nullptr;
+
+    mBatcher.Clear();
+    for ( const SceneObject& object : mObjects )
+    {
+        mBatcher.Add( object.meshId, object.materialId, *object.world, &object );
+    }
+    mBatcher.Build( nullptr );
 
-    mD3DImmediateContext->IASetInputLayout( InputLayouts::PosNormalTexTan );
-    mD3DImmediateContext->IASetVertexBuffers( 0, 1, &mShapesVB, &stride, &offset );
-    mD3DImmediateContext->IASetIndexBuffer( mShapesIB, DXGI_FORMAT_R32_UINT, 0 );
+    mInstanceBuffer.Begin( mD3DImmediateContext );
 
-    if ( GetAsyncKeyState( '1' ) & 0x8000 )
-        mD3DImmediateContext->RSSetState( RenderStates::WireframeRS );
+    const std::vector<InstanceBatcher::Instance>& instances = mBatcher.GetInstances();
+    UINT startInstance = 0;
+    if ( instancing && !instances.empty() )
+    {
+        if ( !mInstanceBuffer.Upload( instances.data(), static_cast<UINT>( instances.size() ), startInstance ) )
+        {
+            // No room left this frame; draw one by one.
+            instancing = false;
+        }
+    }
 
+    mInstanceBuffer.Unmap( mD3DImmediateContext );
+
+    auto makeItem = [this, mappedTech, reflectTech, mappedTopology, shapesRS]( const SceneObject& object ) {
+        RenderItem item;
+        item.topology = object.mapped ? mappedTopology : D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+        item.inputLayout = object.inputLayout;
+        item.vertexBuffer = object.vb;
+        item.vertexStride = object.vertexStride;
+        item.indexBuffer = object.ib;
+        item.indexFormat = DXGI_FORMAT_R32_UINT;
+        item.rasterizerState = object.vb == mShapesVB ? shapesRS : nullptr;
+        item.technique = object.mapped ? mappedTech : reflectTech;
+        item.object = &object;
+        item.indexCount = object.indexCount;
+        item.startIndex = object.startIndex;
+        item.baseVertex = object.baseVertex;
+        return item;
+    };
+
+    // Queues an item for each pass of its technique. Technique ids: the
+    // mapped technique sorts first, so the tessellated draws come before
+    // the rest, then the reflecting and the instanced ones.
     D3DX11_TECHNIQUE_DESC techDesc;
-    tech->GetDesc( &techDesc );
-    for ( UINT p = 0; p < techDesc.Passes; ++p )
+    auto submit = [this, &view, &techDesc]( RenderItem& item, unsigned int techniqueId ) {
+        const SceneObject& object = *static_cast<const SceneObject*>( item.object );
+
+        const float depth = XMVectorGetZ( XMVector3Transform( XMLoadFloat3( reinterpret_cast<const XMFLOAT3*>( &object.world->_41 ) ), view ) );
+        const unsigned int quantized = RenderQueue::QuantizeDepth( depth, 1.f, 1000.f, false );
+        const unsigned int state = item.rasterizerState != nullptr ? 1 : 0;
+
+        ID3DX11EffectTechnique* tech = static_cast<ID3DX11EffectTechnique*>( const_cast<void*>( item.technique ) );
+        tech->GetDesc( &techDesc );
+        for ( UINT p = 0; p < techDesc.Passes; ++p )
+        {
+            item.pass = p;
+            mRenderQueue.Submit( RenderQueue::MakeKey( p, techniqueId, state, object.materialId, object.meshId, quantized ), item );
+        }
+    };
+
+    // Queue every object, front to back within each technique; a group is
+    // sorted by where its first object is.
+    mRenderQueue.Clear();
+
+    for ( const InstanceBatcher::Batch& batch : mBatcher.GetBatches() )
     {
-        // Draw the grid.
-        world = XMLoadFloat4x4( &mGridWorld );
-        worldInvTranspose = MathHelper::InverseTranspose( world );
-        worldViewProj = world*view*proj;
+        const SceneObject& first = *static_cast<const SceneObject*>( batch.object );
+        const bool instanceable = first.inputLayout == InputLayouts::PosNormalTexTan &&
+                                  ( !first.mapped || mRenderOptions == RenderOptionsBasic );
 
-        switch ( mRenderOptions )
+        if ( instancing && instanceable && batch.instanceCount > 1 )
         {
-        case RenderOptionsBasic:
-            Effects::BasicFX->SetWorld( world );
-            Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-            Effects::BasicFX->SetWorldViewProj( worldViewProj );
-            Effects::BasicFX->SetShadowTransform( world*shadowTransform );
-            Effects::BasicFX->SetTexTransform( XMMatrixScaling( 8.0f, 10.0f, 1.0f ) );
-            Effects::BasicFX->SetMaterial( mGridMat );
-            Effects::BasicFX->SetDiffuseMap( mStoneTexSRV );
-            break;
-        case RenderOptionsNormalMap:
-            Effects::NormalMapFX->SetWorld( world );
-            Effects::NormalMapFX->SetWorldInvTranspose( worldInvTranspose );
-            Effects::NormalMapFX->SetWorldViewProj( worldViewProj );
-            Effects::NormalMapFX->SetShadowTransform( world*shadowTransform );
-            Effects::NormalMapFX->SetTexTransform( XMMatrixScaling( 8.0f, 10.0f, 1.0f ) );
-            Effects::NormalMapFX->SetMaterial( mGridMat );
-            Effects::NormalMapFX->SetDiffuseMap( mStoneTexSRV );
-            Effects::NormalMapFX->SetNormalMap( mStoneNormalTexSRV );
-            break;
-        case RenderOptionsDisplacementMap:
-            Effects::DisplacementMapFX->SetWorld( world );
-            Effects::DisplacementMapFX->SetWorldInvTranspose( worldInvTranspose );
-            Effects::DisplacementMapFX->SetViewProj( viewProj );
-            Effects::DisplacementMapFX->SetWorldViewProj( worldViewProj );
+            RenderItem item = makeItem( first );
+            item.inputLayout = InputLayouts::InstancedPosNormalTexTan;
+            item.technique = first.mapped ? basicFX->Light3TexInstancedTech : basicFX->Light3ReflectInstancedTech;
+            item.instanceBuffer = mInstanceBuffer.Get();
+            item.instanceStride = mInstanceBuffer.GetStride();
+            item.instanceCount = static_cast<UINT>( batch.instanceCount );
+            item.startInstance = startInstance + static_cast<UINT>( batch.firstInstance );
+            submit( item, 2 );
+            continue;
+        }
 
-            // Note: No world pre-multiply for displacement mapping since the DS computes the world
-            // space position, we just need the light view/proj.
-            Effects::DisplacementMapFX->SetShadowTransform( shadowTransform );
-            Effects::DisplacementMapFX->SetTexTransform( XMMatrixScaling( 8.0f, 10.0f, 1.0f ) );
-            Effects::DisplacementMapFX->SetMaterial( mGridMat );
-            Effects::DisplacementMapFX->SetDiffuseMap( mStoneTexSRV );
-            Effects::DisplacementMapFX->SetNormalMap( mStoneNormalTexSRV );
-            break;
+        for ( size_t i = batch.firstInstance; i < batch.firstInstance + batch.instanceCount; ++i )
+        {
+            const SceneObject& object = *static_cast<const SceneObject*>( mBatcher.GetInstanceObject( i ) );
+            RenderItem item = makeItem( object );
+            submit( item, object.mapped ? 0 : 1 );
         }
+    }
 
-        tech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-        mD3DImmediateContext->DrawIndexed( mGridIndexCount, mGridIndexOffset, mGridVertexOffset );
+    mRenderQueue.Sort( nullptr );
 
-        // Draw the box.
-        world = XMLoadFloat4x4( &mBoxWorld );
-        worldInvTranspose = MathHelper::InverseTranspose( world );
-        worldViewProj = world*view*proj;
+    bool tessellated = false;
+    D3DRenderBackend backend( mD3DImmediateContext, [&]( ID3D11DeviceContext* context, const RenderItem& item ) {
+        const SceneObject& object = *static_cast<const SceneObject*>( item.object );
+        ID3DX11EffectTechnique* technique = static_cast<ID3DX11EffectTechnique*>( const_cast<void*>( item.technique ) );
+        ID3DX11EffectPass* pass = technique->GetPassByIndex( item.pass );
 
-        switch ( mRenderOptions )
+        const RenderOptions options = object.mapped ? mRenderOptions : RenderOptionsBasic;
+
+        // FX sets tessellation stages, but it does not disable them. So do
+        // that here, after the last tessellated draw.
+        if ( tessellated && options != RenderOptionsDisplacementMap )
+        {
+            context->HSSetShader( 0, 0, 0 );
+            context->DSSetShader( 0, 0, 0 );
+            tessellated = false;
+        }
+
+        // Instances bring their own world transforms.
+        XMMATRIX world = item.instanceCount > 0 ? XMMatrixIdentity() : XMLoadFloat4x4( object.world );
+        XMMATRIX worldInvTranspose = MathHelper::InverseTranspose( world );
+        XMMATRIX worldViewProj = world*viewProj;
+        XMMATRIX texTransform = XMLoadFloat4x4( &object.texTransform );
+
+        switch ( options )
         {
         case RenderOptionsBasic:
-            Effects::BasicFX->SetWorld( world );
-            Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-            Effects::BasicFX->SetWorldViewProj( worldViewProj );
-            Effects::BasicFX->SetShadowTransform( world*shadowTransform );
-            Effects::BasicFX->SetTexTransform( XMMatrixScaling( 2.0f, 1.0f, 1.0f ) );
-            Effects::BasicFX->SetMaterial( mBoxMat );
-            Effects::BasicFX->SetDiffuseMap( mBrickTexSRV );
+            setBasicObject( world, texTransform, *object.material );
+            if ( object.diffuseMap )
+                basicFX->SetDiffuseMap( object.diffuseMap );
+            basicFX->Apply( pass, context );
             break;
         case RenderOptionsNormalMap:
             Effects::NormalMapFX->SetWorld( world );
             Effects::NormalMapFX->SetWorldInvTranspose( worldInvTranspose );
             Effects::NormalMapFX->SetWorldViewProj( worldViewProj );
             Effects::NormalMapFX->SetShadowTransform( world*shadowTransform );
-            Effects::NormalMapFX->SetTexTransform( XMMatrixScaling( 2.0f, 1.0f, 1.0f ) );
-            Effects::NormalMapFX->SetMaterial( mBoxMat );
-            Effects::NormalMapFX->SetDiffuseMap( mBrickTexSRV );
-            Effects::NormalMapFX->SetNormalMap( mBrickNormalTexSRV );
+            Effects::NormalMapFX->SetTexTransform( texTransform );
+            Effects::NormalMapFX->SetMaterial( *object.material );
+            Effects::NormalMapFX->SetDiffuseMap( object.diffuseMap );
+            Effects::NormalMapFX->SetNormalMap( object.normalMap );
+            pass->Apply( 0, context );
             break;
         case RenderOptionsDisplacementMap:
             Effects::DisplacementMapFX->SetWorld( world );
@@ -572,126 +674,26 @@ void App::drawScene( void )
             // Note: No world pre-multiply for displacement mapping since the DS computes the world
             // space position, we just need the light view/proj.
             Effects::DisplacementMapFX->SetShadowTransform( shadowTransform );
-            Effects::DisplacementMapFX->SetTexTransform( XMMatrixScaling( 2.0f, 1.0f, 1.0f ) );
-            Effects::DisplacementMapFX->SetMaterial( mBoxMat );
-            Effects::DisplacementMapFX->SetDiffuseMap( mBrickTexSRV );
-            Effects::DisplacementMapFX->SetNormalMap( mBrickNormalTexSRV );
+            Effects::DisplacementMapFX->SetTexTransform( texTransform );
+            Effects::DisplacementMapFX->SetMaterial( *object.material );
+            Effects::DisplacementMapFX->SetDiffuseMap( object.diffuseMap );
+            Effects::DisplacementMapFX->SetNormalMap( object.normalMap );
+            pass->Apply( 0, context );
+            tessellated = true;
             break;
         }
+    } );
+    mRenderQueue.Execute( backend );
 
-        tech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-        mD3DImmediateContext->DrawIndexed( mBoxIndexCount, mBoxIndexOffset, mBoxVertexOffset );
-
-        // Draw the cylinders.
-        for ( int i = 0; i < 10; ++i )
-        {
-            world = XMLoadFloat4x4( &mCylWorld[i] );
-            worldInvTranspose = MathHelper::InverseTranspose( world );
-            worldViewProj = world*view*proj;
-
-            switch ( mRenderOptions )
-            {
-            case RenderOptionsBasic:
-                Effects::BasicFX->SetWorld( world );
-                Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-                Effects::BasicFX->SetWorldViewProj( worldViewProj );
-                Effects::BasicFX->SetShadowTransform( world*shadowTransform );
-                Effects::BasicFX->SetTexTransform( XMMatrixScaling( 1.0f, 2.0f, 1.0f ) );
-                Effects::BasicFX->SetMaterial( mCylinderMat );
-                Effects::BasicFX->SetDiffuseMap( mBrickTexSRV );
-                break;
-            case RenderOptionsNormalMap:
-                Effects::NormalMapFX->SetWorld( world );
-                Effects::NormalMapFX->SetWorldInvTranspose( worldInvTranspose );
-                Effects::NormalMapFX->SetWorldViewProj( worldViewProj );
-                Effects::NormalMapFX->SetShadowTransform( world*shadowTransform );
-                Effects::NormalMapFX->SetTexTransform( XMMatrixScaling( 1.0f, 2.0f, 1.0f ) );
-                Effects::NormalMapFX->SetMaterial( mCylinderMat );
-                Effects::NormalMapFX->SetDiffuseMap( mBrickTexSRV );
-                Effects::NormalMapFX->SetNormalMap( mBrickNormalTexSRV );
-                break;
-            case RenderOptionsDisplacementMap:
-                Effects::DisplacementMapFX->SetWorld( world );
-                Effects::DisplacementMapFX->SetWorldInvTranspose( worldInvTranspose );
-                Effects::DisplacementMapFX->SetViewProj( viewProj );
-                Effects::DisplacementMapFX->SetWorldViewProj( worldViewProj );
-
-                // Note: No world pre-multiply for displacement mapping since the DS computes the world
-                // space position, we just need the light view/proj.
-                Effects::DisplacementMapFX->SetShadowTransform( shadowTransform );
-                Effects::DisplacementMapFX->SetTexTransform( XMMatrixScaling( 1.0f, 2.0f, 1.0f ) );
-                Effects::DisplacementMapFX->SetMaterial( mCylinderMat );
-                Effects::DisplacementMapFX->SetDiffuseMap( mBrickTexSRV );
-                Effects::DisplacementMapFX->SetNormalMap( mBrickNormalTexSRV );
-                break;
-            }
-
-
-            tech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-            mD3DImmediateContext->DrawIndexed( mCylinderIndexCount, mCylinderIndexOffset, mCylinderVertexOffset );
-        }
-    }
-
-    // FX sets tessellation stages, but it does not disable them.  So do that here
-    // to turn off tessellation.
-    mD3DImmediateContext->HSSetShader( 0, 0, 0 );
-    mD3DImmediateContext->DSSetShader( 0, 0, 0 );
-
-    mD3DImmediateContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-
-    //
-    // Draw the spheres with cubemap reflection.
-    //
-
-    activeSphereTech->GetDesc( &techDesc );
-    for ( UINT p = 0; p < techDesc.Passes; ++p )
+    if ( tessellated )
     {
-        // Draw the spheres.
-        for ( int i = 0; i < 10; ++i )
-        {
-            world = XMLoadFloat4x4( &mSphereWorld[i] );
-            worldInvTranspose = MathHelper::InverseTranspose( world );
-            worldViewProj = world*view*proj;
-
-            Effects::BasicFX->SetWorld( world );
-            Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-            Effects::BasicFX->SetWorldViewProj( worldViewProj );
-            Effects::BasicFX->SetShadowTransform( world*shadowTransform );
-            Effects::BasicFX->SetTexTransform( XMMatrixIdentity() );
-            Effects::BasicFX->SetMaterial( mSphereMat );
-
-            activeSphereTech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-            mD3DImmediateContext->DrawIndexed( mSphereIndexCount, mSphereIndexOffset, mSphereVertexOffset );
-        }
+        mD3DImmediateContext->HSSetShader( 0, 0, 0 );
+        mD3DImmediateContext->DSSetShader( 0, 0, 0 );
     }
 
-    stride = sizeof( Vertex::Basic32 );
-    offset = 0;
-
+    // The queue leaves the last object's states bound.
     mD3DImmediateContext->RSSetState( 0 );
 
-    mD3DImmediateContext->IASetInputLayout( InputLayouts::Basic32 );
-    mD3DImmediateContext->IASetVertexBuffers( 0, 1, &mSkullVB, &stride, &offset );
-    mD3DImmediateContext->IASetIndexBuffer( mSkullIB, DXGI_FORMAT_R32_UINT, 0 );
-
-    activeSkullTech->GetDesc( &techDesc );
-    for ( UINT p = 0; p < techDesc.Passes; ++p )
-    {
-        // Draw the skull.
-        world = XMLoadFloat4x4( &mSkullWorld );
-        worldInvTranspose = MathHelper::InverseTranspose( world );
-        worldViewProj = world*view*proj;
-
-        Effects::BasicFX->SetWorld( world );
-        Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-        Effects::BasicFX->SetWorldViewProj( worldViewProj );
-        Effects::BasicFX->SetMaterial( mSkullMat );
-        Effects::BasicFX->SetShadowTransform( world*shadowTransform );
-
-        activeSkullTech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-        mD3DImmediateContext->DrawIndexed( mSkullIndexCount, 0, 0 );
-    }
-
     // Debug view depth buffer.
     //	if( GetAsyncKeyState('Z') & 0x8000 )
     {
@@ -1211,3 +1213,43 @@ void App::BuildScreenQuadGeometryBuffers()
 }
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void App::BuildSceneObjects()
+{
+    enum { GridMaterial, BoxMaterial, CylinderMaterial, SphereMaterial, SkullMaterial };
+    enum { GridMesh, BoxMesh, CylinderMesh, SphereMesh, SkullMesh };
+
+    auto addShape = [this]( const XMFLOAT4X4& world, const Material& material, CXMMATRIX texTransform,
+                            ID3D11ShaderResourceView* diffuseMap, ID3D11ShaderResourceView* normalMap,
+                            bool mapped, unsigned int materialId, unsigned int meshId,
+                            UINT indexCount, UINT startIndex, int baseVertex ) {
+        SceneObject object = { &world, &material, XMFLOAT4X4(), diffuseMap, normalMap, mapped, materialId, meshId,
+                               InputLayouts::PosNormalTexTan, mShapesVB, sizeof( Vertex::PosNormalTexTan ), mShapesIB,
+                               indexCount, startIndex, baseVertex };
+        XMStoreFloat4x4( &object.texTransform, texTransform );
+        mObjects.push_back( object );
+    };
+
+    mObjects.clear();
+
+    addShape( mGridWorld, mGridMat, XMMatrixScaling( 8.0f, 10.0f, 1.0f ), mStoneTexSRV, mStoneNormalTexSRV,
+              true, GridMaterial, GridMesh, mGridIndexCount, mGridIndexOffset, mGridVertexOffset );
+    addShape( mBoxWorld, mBoxMat, XMMatrixScaling( 2.0f, 1.0f, 1.0f ), mBrickTexSRV, mBrickNormalTexSRV,
+              true, BoxMaterial, BoxMesh, mBoxIndexCount, mBoxIndexOffset, mBoxVertexOffset );
+
+    for ( int i = 0; i < 10; ++i )
+    {
+        addShape( mCylWorld[i], mCylinderMat, XMMatrixScaling( 1.0f, 2.0f, 1.0f ), mBrickTexSRV, mBrickNormalTexSRV,
+                  true, CylinderMaterial, CylinderMesh, mCylinderIndexCount, mCylinderIndexOffset, mCylinderVertexOffset );
+        addShape( mSphereWorld[i], mSphereMat, XMMatrixIdentity(), nullptr, nullptr,
+                  false, SphereMaterial, SphereMesh, mSphereIndexCount, mSphereIndexOffset, mSphereVertexOffset );
+    }
+
+    SceneObject skull = { &mSkullWorld, &mSkullMat, XMFLOAT4X4(), nullptr, nullptr, false, SkullMaterial, SkullMesh,
+                          InputLayouts::Basic32, mSkullVB, sizeof( Vertex::Basic32 ), mSkullIB,
+                          mSkullIndexCount, 0, 0 };
+    XMStoreFloat4x4( &skull.texTransform, XMMatrixIdentity() );
+    mObjects.push_back( skull );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -15,17 +15,16 @@ cbuffer cbPerFrame
 	float gTexelHeight;
 };
 
-cbuffer cbSettings
-{
-	float gWeights[11] = 
-	{
-		0.05f, 0.05f, 0.1f, 0.1f, 0.1f, 0.2f, 0.1f, 0.1f, 0.1f, 0.05f, 0.05f
-	};
-};
+// Taps generated by BlurKernel::DiscreteTaps().  Each tap is x = offset in
+// texels from the center, y = weight; the center tap has offset 0.  Offsets
+// are whole texels: the edge test below keeps or drops each texel on its
+// own, which linearly merged taps (two texels per fetch) would defeat.
+#define MaxBlurTaps 16
 
-cbuffer cbFixed
+cbuffer cbSettings
 {
-	static const int gBlurRadius = 5;
+	float4 gTaps[MaxBlurTaps];
+	int    gTapCount;
 };
  
 // Nonnumeric values cannot be added to a cbuffer.
@@ -87,19 +86,14 @@ float4 PS(VertexOut pin, uniform bool gHorizontalBlur) : SV_Target
 		texOffset = float2(0.0f, gTexelHeight);
 	}
 
-	// The center value always contributes to the sum.
-	float4 color      = gWeights[5]*gInputImage.SampleLevel(samInputImage, pin.Tex, 0.0);
-	float totalWeight = gWeights[5];
+	float4 color      = float4(0.0f, 0.0f, 0.0f, 0.0f);
+	float totalWeight = 0.0f;
 	 
 	float4 centerNormalDepth = gNormalDepthMap.SampleLevel(samNormalDepth, pin.Tex, 0.0f);
 
-	for(float i = -gBlurRadius; i <=gBlurRadius; ++i)
+	for(int i = 0; i < gTapCount; ++i)
 	{
-		// We already added in the center weight.
-		if( i == 0 )
-			continue;
-
-		float2 tex = pin.Tex + i*texOffset;
+		float2 tex = pin.Tex + gTaps[i].x*texOffset;
 
 		float4 neighborNormalDepth = gNormalDepthMap.SampleLevel(
 			samNormalDepth, tex, 0.0f);
@@ -107,13 +101,15 @@ float4 PS(VertexOut pin, uniform bool gHorizontalBlur) : SV_Target
 		//
 		// If the center value and neighbor values differ too much (either in 
 		// normal or depth), then we assume we are sampling across a discontinuity.
-		// We discard such samples from the blur.
+		// We discard such samples from the blur.  The center value always
+		// contributes to the sum.
 		//
 	
-		if( dot(neighborNormalDepth.xyz, centerNormalDepth.xyz) >= 0.8f &&
-		    abs(neighborNormalDepth.a - centerNormalDepth.a) <= 0.2f )
+		if( gTaps[i].x == 0.0f ||
+		    ( dot(neighborNormalDepth.xyz, centerNormalDepth.xyz) >= 0.8f &&
+		      abs(neighborNormalDepth.a - centerNormalDepth.a) <= 0.2f ) )
 		{
-			float weight = gWeights[i+gBlurRadius];
+			float weight = gTaps[i].y;
 
 			// Add neighbor pixel to blur.
 			color += weight*gInputImage.SampleLevel(
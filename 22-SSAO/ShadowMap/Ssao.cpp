@@ -1,4 +1,5 @@
 #include "Ssao.h"
+#include "BlurKernel.h"
 #include "Camera.h"
 #include "Effects.h"
 #include "Vertex.h"
@@ -10,7 +11,7 @@ using namespace DirectX;
 
 Ssao::Ssao( ID3D11Device* device, ID3D11DeviceContext* dc, int width, int height, float fovy, float farZ )
     : mD3DDevice( device ), mDC( dc ), mScreenQuadVB( 0 ), mScreenQuadIB( 0 ), mRandomVectorSRV( 0 ),
-    mNormalDepthRTV( 0 ), mNormalDepthSRV( 0 ), mAmbientRTV0( 0 ), mAmbientSRV0( 0 ), mAmbientRTV1( 0 ), mAmbientSRV1( 0 )
+    mBlurTapCount( 0 )
 
 {
     OnSize( width, height, fovy, farZ );
@@ -18,6 +19,7 @@ Ssao::Ssao( ID3D11Device* device, ID3D11DeviceContext* dc, int width, int height
     BuildFullScreenQuad();
     BuildOffsetVectors();
     BuildRandomVectorTexture();
+    BuildBlurTaps( 2.5f, 5 );
 }
 
 Ssao::~Ssao()
@@ -25,18 +27,19 @@ Ssao::~Ssao()
     ReleaseCOM( mScreenQuadVB );
     ReleaseCOM( mScreenQuadIB );
     ReleaseCOM( mRandomVectorSRV );
-
-    ReleaseTextureViews();
 }
 
-ID3D11ShaderResourceView* Ssao::NormalDepthSRV()
+FrameGraph::TextureDesc Ssao::NormalDepthDesc( int width, int height )
 {
-    return mNormalDepthSRV;
+    return FrameGraph::TextureDesc( width, height, DXGI_FORMAT_R16G16B16A16_FLOAT,
+                                    D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET );
 }
 
-ID3D11ShaderResourceView* Ssao::AmbientSRV()
+FrameGraph::TextureDesc Ssao::AmbientDesc( int width, int height )
 {
-    return mAmbientSRV0;
+    // Render ambient map at half resolution.
+    return FrameGraph::TextureDesc( width / 2, height / 2, DXGI_FORMAT_R16_FLOAT,
+                                    D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET );
 }
 
 void Ssao::OnSize( int width, int height, float fovy, float farZ )
@@ -53,27 +56,26 @@ void Ssao::OnSize( int width, int height, float fovy, float farZ )
     mAmbientMapViewport.MaxDepth = 1.0f;
 
     BuildFrustumFarCorners( fovy, farZ );
-    BuildTextureViews();
 }
 
-void Ssao::SetNormalDepthRenderTarget( ID3D11DepthStencilView* dsv )
+void Ssao::SetNormalDepthRenderTarget( ID3D11RenderTargetView* normalDepthRTV, ID3D11DepthStencilView* dsv )
 {
-    ID3D11RenderTargetView* renderTargets[1] = { mNormalDepthRTV };
+    ID3D11RenderTargetView* renderTargets[1] = { normalDepthRTV };
     mDC->OMSetRenderTargets( 1, renderTargets, dsv );
 
     // Clear view space normal to (0,0,-1) and clear depth to be very far away.  
     float clearColor [] = { 0.0f, 0.0f, -1.0f, 1e5f };
-    mDC->ClearRenderTargetView( mNormalDepthRTV, clearColor );
+    mDC->ClearRenderTargetView( normalDepthRTV, clearColor );
 }
 
-void Ssao::ComputeSsao( const Camera& camera )
+void Ssao::ComputeSsao( const Camera& camera, ID3D11ShaderResourceView* normalDepthSRV, ID3D11RenderTargetView* ambientRTV )
 {
     // Bind the ambient map as the render target.  Observe that this pass does not bind 
     // a depth/stencil buffer--it does not need it, and without one, no depth test is
     // performed, which is what we want.
-    ID3D11RenderTargetView* renderTargets[1] = { mAmbientRTV0 };
+    ID3D11RenderTargetView* renderTargets[1] = { ambientRTV };
     mDC->OMSetRenderTargets( 1, renderTargets, 0 );
-    mDC->ClearRenderTargetView( mAmbientRTV0, reinterpret_cast<const float*>( &Colors::Black ) );
+    mDC->ClearRenderTargetView( ambientRTV, reinterpret_cast<const float*>( &Colors::Black ) );
     mDC->RSSetViewports( 1, &mAmbientMapViewport );
 
     // Transform NDC space [-1,+1]^2 to texture space [0,1]^2
@@ -89,7 +91,7 @@ void Ssao::ComputeSsao( const Camera& camera )
     Effects::SsaoFX->SetViewToTexSpace( PT );
     Effects::SsaoFX->SetOffsetVectors( mOffsets );
     Effects::SsaoFX->SetFrustumCorners( mFrustumFarCorner );
-    Effects::SsaoFX->SetNormalDepthMap( mNormalDepthSRV );
+    Effects::SsaoFX->SetNormalDepthMap( normalDepthSRV );
     Effects::SsaoFX->SetRandomVecMap( mRandomVectorSRV );
 
     UINT stride = sizeof( Vertex::Basic32 );
@@ -111,18 +113,23 @@ void Ssao::ComputeSsao( const Camera& camera )
     }
 }
 
-void Ssao::BlurAmbientMap( int blurCount )
+void Ssao::BlurAmbientMap( int blurCount, ID3D11ShaderResourceView* normalDepthSRV,
+                           ID3D11ShaderResourceView* ambientSRV, ID3D11RenderTargetView* ambientRTV,
+                           ID3D11ShaderResourceView* tempSRV, ID3D11RenderTargetView* tempRTV )
 {
+    Effects::SsaoBlurFX->SetTaps( mBlurTaps, mBlurTapCount );
+
     for ( int i = 0; i < blurCount; ++i )
     {
-        // Ping-pong the two ambient map textures as we apply
+        // Ping-pong the ambient and temp textures as we apply
         // horizontal and vertical blur passes.
-        BlurAmbientMap( mAmbientSRV0, mAmbientRTV1, true );
-        BlurAmbientMap( mAmbientSRV1, mAmbientRTV0, false );
+        BlurAmbientMap( ambientSRV, normalDepthSRV, tempRTV, true );
+        BlurAmbientMap( tempSRV, normalDepthSRV, ambientRTV, false );
     }
 }
 
-void Ssao::BlurAmbientMap( ID3D11ShaderResourceView* inputSRV, ID3D11RenderTargetView* outputRTV, bool horzBlur )
+void Ssao::BlurAmbientMap( ID3D11ShaderResourceView* inputSRV, ID3D11ShaderResourceView* normalDepthSRV,
+                           ID3D11RenderTargetView* outputRTV, bool horzBlur )
 {
     ID3D11RenderTargetView* renderTargets[1] = { outputRTV };
     mDC->OMSetRenderTargets( 1, renderTargets, 0 );
@@ -131,7 +138,7 @@ void Ssao::BlurAmbientMap( ID3D11ShaderResourceView* inputSRV, ID3D11RenderTarge
 
     Effects::SsaoBlurFX->SetTexelWidth( 1.0f / mAmbientMapViewport.Width );
     Effects::SsaoBlurFX->SetTexelHeight( 1.0f / mAmbientMapViewport.Height );
-    Effects::SsaoBlurFX->SetNormalDepthMap( mNormalDepthSRV );
+    Effects::SsaoBlurFX->SetNormalDepthMap( normalDepthSRV );
     Effects::SsaoBlurFX->SetInputImage( inputSRV );
 
     ID3DX11EffectTechnique* tech;
@@ -231,64 +238,6 @@ void Ssao::BuildFullScreenQuad()
     HR( mD3DDevice->CreateBuffer( &ibd, &iinitData, &mScreenQuadIB ) );
 }
 
-void Ssao::BuildTextureViews()
-{
-    ReleaseTextureViews();
-
-    D3D11_TEXTURE2D_DESC texDesc;
-    texDesc.Width = mRenderTargetWidth;
-    texDesc.Height = mRenderTargetHeight;
-    texDesc.MipLevels = 1;
-    texDesc.ArraySize = 1;
-    texDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-    texDesc.SampleDesc.Count = 1;
-    texDesc.SampleDesc.Quality = 0;
-    texDesc.Usage = D3D11_USAGE_DEFAULT;
-    texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
-    texDesc.CPUAccessFlags = 0;
-    texDesc.MiscFlags = 0;
-
-
-    ID3D11Texture2D* normalDepthTex = 0;
-    HR( mD3DDevice->CreateTexture2D( &texDesc, 0, &normalDepthTex ) );
-    HR( mD3DDevice->CreateShaderResourceView( normalDepthTex, 0, &mNormalDepthSRV ) );
-    HR( mD3DDevice->CreateRenderTargetView( normalDepthTex, 0, &mNormalDepthRTV ) );
-
-    // view saves a reference.
-    ReleaseCOM( normalDepthTex );
-
-    // Render ambient map at half resolution.
-    texDesc.Width = mRenderTargetWidth / 2;
-    texDesc.Height = mRenderTargetHeight / 2;
-    texDesc.Format = DXGI_FORMAT_R16_FLOAT;
-    ID3D11Texture2D* ambientTex0 = 0;
-    HR( mD3DDevice->CreateTexture2D( &texDesc, 0, &ambientTex0 ) );
-    HR( mD3DDevice->CreateShaderResourceView( ambientTex0, 0, &mAmbientSRV0 ) );
-    HR( mD3DDevice->CreateRenderTargetView( ambientTex0, 0, &mAmbientRTV0 ) );
-
-    ID3D11Texture2D* ambientTex1 = 0;
-    HR( mD3DDevice->CreateTexture2D( &texDesc, 0, &ambientTex1 ) );
-    HR( mD3DDevice->CreateShaderResourceView( ambientTex1, 0, &mAmbientSRV1 ) );
-    HR( mD3DDevice->CreateRenderTargetView( ambientTex1, 0, &mAmbientRTV1 ) );
-
-
-    // view saves a reference.
-    ReleaseCOM( ambientTex0 );
-    ReleaseCOM( ambientTex1 );
-}
-
-void Ssao::ReleaseTextureViews()
-{
-    ReleaseCOM( mNormalDepthRTV );
-    ReleaseCOM( mNormalDepthSRV );
-
-    ReleaseCOM( mAmbientRTV0 );
-    ReleaseCOM( mAmbientSRV0 );
-
-    ReleaseCOM( mAmbientRTV1 );
-    ReleaseCOM( mAmbientSRV1 );
-}
-
 void Ssao::BuildRandomVectorTexture()
 {
     D3D11_TEXTURE2D_DESC texDesc;
@@ -307,15 +256,14 @@ void Ssao::BuildRandomVectorTexture()
     D3D11_SUBRESOURCE_DATA initData = { 0 };
     initData.SysMemPitch = 256 * sizeof( DirectX::PackedVector::XMCOLOR );
 
+    // Fixed seed, so the noise pattern is the same every run.
+    std::vector<float> noise( 3 * 256 * 256 );
+    Random( 0x55a0 ).FillFloats( &noise[0], noise.size() );
+
     DirectX::PackedVector::XMCOLOR color[256 * 256];
-    for ( int i = 0; i < 256; ++i )
+    for ( int i = 0; i < 256 * 256; ++i )
     {
-        for ( int j = 0; j < 256; ++j )
-        {
-            XMFLOAT3 v( MathHelper::RandF(), MathHelper::RandF(), MathHelper::RandF() );
-
-            color[i * 256 + j] = DirectX::PackedVector::XMCOLOR( v.x, v.y, v.z, 0.0f );
-        }
+        color[i] = DirectX::PackedVector::XMCOLOR( noise[3 * i + 0], noise[3 * i + 1], noise[3 * i + 2], 0.0f );
     }
 
     initData.pSysMem = color;
@@ -368,4 +316,19 @@ void Ssao::BuildOffsetVectors()
 
         XMStoreFloat4( &mOffsets[i], v );
     }
+}
+
+void Ssao::BuildBlurTaps( float sigma, int radius )
+{
+    // One tap per texel. The blur is bilateral: each neighbor is kept or
+    // dropped on its own normal and depth, so two texels cannot share a
+    // merged bilinear fetch without leaking across edges.
+    std::vector<BlurKernel::Tap> taps = BlurKernel::DiscreteTaps( BlurKernel::Gaussian( sigma, radius ) );
+    assert( taps.size() <= MaxBlurTaps );
+
+    mBlurTapCount = static_cast<int>( taps.size() );
+    for ( int i = 0; i < mBlurTapCount; ++i )
+    {
+        mBlurTaps[i] = XMFLOAT4( taps[i].offset, taps[i].weight, 0.0f, 0.0f );
+    }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #define SSAO_H
 
 #include "d3dUtil.h"
+#include "FrameGraph.h"
 
 // Should we render AO at half resolution?
 
@@ -14,8 +15,13 @@ public:
     Ssao( ID3D11Device* device, ID3D11DeviceContext* dc, int width, int height, float fovy, float farZ );
     ~Ssao();
 
-    ID3D11ShaderResourceView* NormalDepthSRV();
-    ID3D11ShaderResourceView* AmbientSRV();
+    ///<summary>
+    /// Descriptions of the textures the caller provides (e.g. FrameGraph
+    /// transients): the view space normal/depth map at the back buffer size,
+    /// and the ambient maps at half of it.
+    ///</summary>
+    static FrameGraph::TextureDesc NormalDepthDesc( int width, int height );
+    static FrameGraph::TextureDesc AmbientDesc( int width, int height );
 
     ///<summary>
     /// Call when the backbuffer is resized.  
@@ -23,12 +29,12 @@ public:
     void OnSize( int width, int height, float fovy, float farZ );
 
     ///<summary>
-    /// Changes the render target to the NormalDepth render target.  Pass the 
+    /// Changes the render target to the given NormalDepth render target.  Pass the 
     /// main depth buffer as the depth buffer to use when we render to the
     /// NormalDepth map.  This pass lays down the scene depth so that there in
     /// no overdraw in the subsequent rendering pass.
     ///</summary>
-    void SetNormalDepthRenderTarget( ID3D11DepthStencilView* dsv );
+    void SetNormalDepthRenderTarget( ID3D11RenderTargetView* normalDepthRTV, ID3D11DepthStencilView* dsv );
 
     ///<summary>
     /// Changes the render target to the Ambient render target and draws a fullscreen
@@ -36,32 +42,36 @@ public:
     /// main depth buffer binded to the pipeline, but depth buffer read/writes
     /// are disabled, as we do not need the depth buffer computing the Ambient map.
     ///</summary>
-    void ComputeSsao( const Camera& camera );
+    void ComputeSsao( const Camera& camera, ID3D11ShaderResourceView* normalDepthSRV, ID3D11RenderTargetView* ambientRTV );
 
     ///<summary>
     /// Blurs the ambient map to smooth out the noise caused by only taking a
     /// few random samples per pixel.  We use an edge preserving blur so that 
     /// we do not blur across discontinuities--we want edges to remain edges.
+    /// The result ends up back in the ambient map; the temp map (same description)
+    /// is used for ping-ponging.
     ///</summary>
-    void BlurAmbientMap( int blurCount );
+    void BlurAmbientMap( int blurCount, ID3D11ShaderResourceView* normalDepthSRV,
+                         ID3D11ShaderResourceView* ambientSRV, ID3D11RenderTargetView* ambientRTV,
+                         ID3D11ShaderResourceView* tempSRV, ID3D11RenderTargetView* tempRTV );
 
 public:
     Ssao( const Ssao& rhs );
     Ssao& operator=( const Ssao& rhs );
 
-    void BlurAmbientMap( ID3D11ShaderResourceView* inputSRV, ID3D11RenderTargetView* outputRTV, bool horzBlur );
+    void BlurAmbientMap( ID3D11ShaderResourceView* inputSRV, ID3D11ShaderResourceView* normalDepthSRV,
+                         ID3D11RenderTargetView* outputRTV, bool horzBlur );
 
     void BuildFrustumFarCorners( float fovy, float farZ );
 
     void BuildFullScreenQuad();
 
-    void BuildTextureViews();
-    void ReleaseTextureViews();
-
     void BuildRandomVectorTexture();
 
     void BuildOffsetVectors();
 
+    void BuildBlurTaps( float sigma, int radius );
+
     void DrawFullScreenQuad();
 
 private:
@@ -73,17 +83,6 @@ private:
 
     ID3D11ShaderResourceView* mRandomVectorSRV;
 
-    ID3D11RenderTargetView* mNormalDepthRTV;
-    ID3D11ShaderResourceView* mNormalDepthSRV;
-
-    // Need two for ping-ponging during blur.
-    ID3D11RenderTargetView* mAmbientRTV0;
-    ID3D11ShaderResourceView* mAmbientSRV0;
-
-    ID3D11RenderTargetView* mAmbientRTV1;
-    ID3D11ShaderResourceView* mAmbientSRV1;
-
-
     UINT mRenderTargetWidth;
     UINT mRenderTargetHeight;
 
@@ -91,6 +90,13 @@ private:
 
     DirectX::XMFLOAT4 mOffsets[14];
 
+    // Must match MaxBlurTaps in SsaoBlur.fx.
+    static const int MaxBlurTaps = 16;
+
+    // Blur taps at whole texel offsets, packed as ( offset, weight, 0, 0 ).
+    DirectX::XMFLOAT4 mBlurTaps[MaxBlurTaps];
+    int mBlurTapCount;
+
     D3D11_VIEWPORT mAmbientMapViewport;
 };
 
@@ -6,12 +6,14 @@
 #include "D3DApp.h"
 #include "d3dx11Effect.h"
 #include "Effects.h"
+#include "FrameGraph.h"
 #include "GeometryGenerator.h"
 #include "LightHelper.h"
 #include "MathHelper.h"
 #include "RenderStates.h"
 #include "Sky.h"
 #include "Terrain.h"
+#include "TransientTexturePool.h"
 #include "Vertex.h"
 
 #include "ShadowMap.h"
@@ -50,8 +52,10 @@ public:
 
 private:
 
+    void BuildFrameGraph();
     void DrawSceneToSsaoNormalDepthMap();
     void DrawSceneToShadowMap();
+    void DrawLitScene( ID3D11ShaderResourceView* ambientSRV );
     void DrawScreenQuad( ID3D11ShaderResourceView* srv );
     void BuildShadowTransform();
     void BuildShapeGeometryBuffers();
@@ -90,6 +94,14 @@ private:
 
     Ssao* mSsao;
 
+    // Shadow map -> normal/depth -> SSAO -> blur -> lit scene. The normal/depth
+    // and ambient maps are transients owned by mTransients and rebuilt on resize.
+    FrameGraph mFrameGraph;
+    TransientTexturePool mTransients;
+    FrameGraph::ResourceHandle mNormalDepth;
+    FrameGraph::ResourceHandle mAmbient;
+    FrameGraph::ResourceHandle mAmbientTemp;
+
     float mLightRotationAngle;
     XMFLOAT3 mOriginalLightDir[3];
     DirectionalLight mDirLights[3];
@@ -157,6 +169,7 @@ App::App( HINSTANCE hInstance )
     mStoneTexSRV( 0 ), mBrickTexSRV( 0 ),
     mStoneNormalTexSRV( 0 ), mBrickNormalTexSRV( 0 ),
     mSkullIndexCount( 0 ), mRenderOptions( RenderOptionsNormalMap ), mSmap( 0 ), mSsao( 0 ),
+    mNormalDepth( FrameGraph::Invalid ), mAmbient( FrameGraph::Invalid ), mAmbientTemp( FrameGraph::Invalid ),
     mLightRotationAngle( 0.0f )
 {
     mMainWindowCaption = L"Shadows Demo";
@@ -263,6 +276,8 @@ App::~App( void )
     ReleaseCOM( mStoneNormalTexSRV );
     ReleaseCOM( mBrickNormalTexSRV );
 
+    mTransients.ReleaseAll();
+
     Effects::DestroyAll();
     InputLayouts::DestroyAll();
     RenderStates::DestroyAll();
@@ -351,6 +366,9 @@ void App::onResize( void )
     {
         mSsao->OnSize( mClientWidth, mClientHeight, mCam.GetFovY(), mCam.GetFarZ() );
     }
+
+    // Recreate the targets that depend on the client area size.
+    BuildFrameGraph();
 }
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -415,11 +433,70 @@ void App::updateScene( const float dt )
 
 void App::drawScene( void )
 {
-    mSmap->BindDsvAndSetNullRenderTarget( mD3DImmediateContext );
+    // Picks up edits to the .fx files while the demo runs.
+    Effects::ReloadChanged();
 
-    DrawSceneToShadowMap();
+    mFrameGraph.Execute();
 
-    mD3DImmediateContext->RSSetState( 0 );
+    HR( mSwapChain->Present( 0, 0 ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void App::onMouseDown( WPARAM btnState, int x, int y )
+{
+    mLastMousePos.x = x;
+    mLastMousePos.y = y;
+
+    SetCapture( mMainWindow );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void App::onMouseUp( WPARAM btnState, int x, int y )
+{
+    ReleaseCapture();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void App::onMouseMove( WPARAM btnState, int x, int y )
+{
+    if ( ( btnState & MK_LBUTTON ) != 0 ) {
+        // Each pixel corresponds to quarter of degree.
+        const float dx = XMConvertToRadians( 0.25f * static_cast<float>( x - mLastMousePos.x ) );
+        const float dy = XMConvertToRadians( 0.25f * static_cast<float>( y - mLastMousePos.y ) );
+
+        mCam.Pitch( dy );
+        mCam.RotateY( dx );
+    }
+
+    mLastMousePos.x = x;
+    mLastMousePos.y = y;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void App::BuildFrameGraph()
+{
+    // The graph only depends on the client area size, so it is declared
+    // again on resize rather than every frame.
+    mFrameGraph.Reset();
+
+    mNormalDepth = mFrameGraph.CreateTexture( "NormalDepth", Ssao::NormalDepthDesc( mClientWidth, mClientHeight ) );
+    mAmbient = mFrameGraph.CreateTexture( "Ambient", Ssao::AmbientDesc( mClientWidth, mClientHeight ) );
+    mAmbientTemp = mFrameGraph.CreateTexture( "AmbientTemp", Ssao::AmbientDesc( mClientWidth, mClientHeight ) );
+    FrameGraph::ResourceHandle shadowMap = mFrameGraph.ImportTexture( "ShadowMap" );
+    FrameGraph::ResourceHandle depthBuffer = mFrameGraph.ImportTexture( "DepthBuffer" );
+    FrameGraph::ResourceHandle backBuffer = mFrameGraph.ImportTexture( "BackBuffer" );
+
+    mFrameGraph.AddPass( "ShadowMap", { }, { shadowMap }, [this]() {
+        mSmap->BindDsvAndSetNullRenderTarget( mD3DImmediateContext );
+
+        DrawSceneToShadowMap();
+
+        mD3DImmediateContext->RSSetState( 0 );
+    } );
 
     //
     // Render the view space normals and depths.  This render target has the
@@ -427,20 +504,45 @@ void App::drawScene( void )
     // This render pass is needed to compute the ambient occlusion.
     // Notice that we use the main depth/stencil buffer in this pass.  
     //
+    mFrameGraph.AddPass( "NormalDepth", { }, { mNormalDepth, depthBuffer }, [this]() {
+        mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
+        mD3DImmediateContext->RSSetViewports( 1, &mViewport );
+        mSsao->SetNormalDepthRenderTarget( mTransients.Get( mFrameGraph, mNormalDepth ).rtv, mDepthStencilView );
 
-    mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
-    mD3DImmediateContext->RSSetViewports( 1, &mViewport );
-    mSsao->SetNormalDepthRenderTarget( mDepthStencilView );
-
-    DrawSceneToSsaoNormalDepthMap();
+        DrawSceneToSsaoNormalDepthMap();
+    } );
 
     //
-    // Now compute the ambient occlusion.
+    // Now compute the ambient occlusion, and blur it in place through
+    // AmbientTemp.
     //
+    mFrameGraph.AddPass( "Ssao", { mNormalDepth }, { mAmbient }, [this]() {
+        PROFILE_ZONE( "Ssao" );
+        mSsao->ComputeSsao( mCam,
+                            mTransients.Get( mFrameGraph, mNormalDepth ).srv,
+                            mTransients.Get( mFrameGraph, mAmbient ).rtv );
+    } );
+
+    mFrameGraph.AddPass( "SsaoBlur", { mAmbient, mNormalDepth }, { mAmbient, mAmbientTemp }, [this]() {
+        PROFILE_ZONE( "SsaoBlur" );
+        const TransientTexturePool::Texture& ambient = mTransients.Get( mFrameGraph, mAmbient );
+        const TransientTexturePool::Texture& temp = mTransients.Get( mFrameGraph, mAmbientTemp );
+        mSsao->BlurAmbientMap( 4, mTransients.Get( mFrameGraph, mNormalDepth ).srv,
+                               ambient.srv, ambient.rtv, temp.srv, temp.rtv );
+    } );
+
+    mFrameGraph.AddPass( "Scene", { mAmbient, shadowMap, depthBuffer }, { backBuffer }, [this]() {
+        DrawLitScene( mTransients.Get( mFrameGraph, mAmbient ).srv );
+    } );
+
+    mFrameGraph.Compile();
+    mTransients.Realize( mD3DDevice, mFrameGraph );
+}
 
-    mSsao->ComputeSsao( mCam );
-    mSsao->BlurAmbientMap( 4 );
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
+void App::DrawLitScene( ID3D11ShaderResourceView* ambientSRV )
+{
     //
     // Restore the back and depth buffer and viewport to the OM stage.
     //
@@ -467,13 +569,13 @@ void App::drawScene( void )
     Effects::BasicFX->SetEyePosW( mCam.GetPosition() );
     Effects::BasicFX->SetCubeMap( mSky->CubeMapSRV() );
     Effects::BasicFX->SetShadowMap( mSmap->DepthMapSRV() );
-    Effects::BasicFX->SetSsaoMap( mSsao->AmbientSRV() );
+    Effects::BasicFX->SetSsaoMap( ambientSRV );
 
     Effects::NormalMapFX->SetDirLights( mDirLights );
     Effects::NormalMapFX->SetEyePosW( mCam.GetPosition() );
     Effects::NormalMapFX->SetCubeMap( mSky->CubeMapSRV() );
     Effects::NormalMapFX->SetShadowMap( mSmap->DepthMapSRV() );
-    Effects::NormalMapFX->SetSsaoMap( mSsao->AmbientSRV() );
+    Effects::NormalMapFX->SetSsaoMap( ambientSRV );
 
     Effects::DisplacementMapFX->SetDirLights( mDirLights );
     Effects::DisplacementMapFX->SetEyePosW( mCam.GetPosition() );
@@ -751,7 +853,7 @@ void App::drawScene( void )
     mD3DImmediateContext->OMSetDepthStencilState( 0, 0 );
 
     // Debug view SSAO map.
-    DrawScreenQuad( mSsao->AmbientSRV() );
+    DrawScreenQuad( ambientSRV );
 
     mSky->Draw( mD3DImmediateContext, mCam );
 
@@ -763,46 +865,14 @@ void App::drawScene( void )
     // to it next frame.  These textures can be at any slot, so clear all slots.
     ID3D11ShaderResourceView* nullSRV[16] = { 0 };
     mD3DImmediateContext->PSSetShaderResources( 0, 16, nullSRV );
-
-    HR( mSwapChain->Present( 0, 0 ) );
-}
-
-// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
-
-void App::onMouseDown( WPARAM btnState, int x, int y )
-{
-    mLastMousePos.x = x;
-    mLastMousePos.y = y;
-
-    SetCapture( mMainWindow );
-}
-
-// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
-
-void App::onMouseUp( WPARAM btnState, int x, int y )
-{
-    ReleaseCapture();
 }
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
-void App::onMouseMove( WPARAM btnState, int x, int y )
-{
-    if ( ( btnState & MK_LBUTTON ) != 0 ) {
-        // Each pixel corresponds to quarter of degree.
-        const float dx = XMConvertToRadians( 0.25f * static_cast<float>( x - mLastMousePos.x ) );
-        const float dy = XMConvertToRadians( 0.25f * static_cast<float>( y - mLastMousePos.y ) );
-
-        mCam.Pitch( dy );
-        mCam.RotateY( dx );
-    }
-
-    mLastMousePos.x = x;
-    mLastMousePos.y = y;
-}
-
 void App::DrawSceneToSsaoNormalDepthMap()
 {
+    PROFILE_ZONE( "DrawSceneToSsaoNormalDepthMap" );
+
     XMMATRIX view = mCam.View();
     XMMATRIX proj = mCam.Proj();
     XMMATRIX viewProj = XMMatrixMultiply( view, proj );
@@ -929,6 +999,8 @@ void App::DrawSceneToSsaoNormalDepthMap()
 
 void App::DrawSceneToShadowMap()
 {
+    PROFILE_ZONE( "DrawSceneToShadowMap" );
+
     XMMATRIX view = XMLoadFloat4x4( &mLightView );
     XMMATRIX proj = XMLoadFloat4x4( &mLightProj );
     XMMATRIX viewProj = XMMatrixMultiply( view, proj );
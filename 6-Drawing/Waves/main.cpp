@@ -8,6 +8,8 @@
 #include "MathHelper.h"
 #include "Waves.h"
 
+#include <vector>
+
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
 struct Vertex {
@@ -15,6 +17,11 @@ struct Vertex {
     DirectX::XMFLOAT4 color;
 };
 
+// Everything drawScene() takes from the simulation for one frame.
+struct FramePacket {
+    std::vector<DirectX::XMFLOAT3> wavePositions;
+};
+
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
 class App : public D3DApp {
@@ -27,6 +34,7 @@ public:
     virtual bool init( void ) override;
     virtual void onResize( void ) override;
     virtual void updateScene( const float dt ) override;
+    virtual void buildFramePacket( const unsigned int slot ) override;
     virtual void drawScene( void ) override;
 
     virtual void onMouseDown( WPARAM btnState, int x, int y ) override;
@@ -65,6 +73,11 @@ private:
 
     float mTheta, mPhi, mRadius;
 
+    float mSimTime;
+    float mLastDisturbTime;
+
+    FramePacket mPackets[FramePipeline::SlotCount];
+
     POINT mLastMousePos;
 
 };
@@ -103,6 +116,8 @@ App::App( HINSTANCE hInstance )
     , mTheta( 1.5f * MathHelper::Pi )
     , mPhi( 0.1f * MathHelper::Pi )
     , mRadius( 200.0f )
+    , mSimTime( 0.f )
+    , mLastDisturbTime( 0.f )
 {
     mMainWindowCaption = L"Waves Demo";
 
@@ -138,6 +153,13 @@ bool App::init( void )
 
     mWaves.Init( 200, 200, 0.8f, 0.03f, 3.25f, 0.4f );
 
+    // Step the simulation at the waves' own time step, independent of the
+    // frame rate, and interpolate between steps when drawing.
+    setFixedTimestep( 0.03 );
+
+    // Simulate on the update thread while the previous frame is drawn.
+    setPipelined( true );
+
     buildLandBuffers();
     buildWaveBuffers();
     buildFX();
@@ -173,12 +195,47 @@ void App::onResize( void )
 
 void App::updateScene( const float dt )
 {
-    // Convert spherical to cartesian.
+    // Generate a random wave every 0.25 seconds of simulated time (mTimer
+    // belongs to the main thread).
+    mSimTime += dt;
+    if ( ( mSimTime - mLastDisturbTime ) >= 0.25f ) {
+        mLastDisturbTime += 0.25f;
+
+        DWORD i = 5 + rand() % 190;
+        DWORD j = 5 + rand() % 190;
+
+        float r = MathHelper::RandF( 1.f, 2.f );
+
+        mWaves.Disturb( i, j, r );
+    }
+
+    mWaves.Update( dt );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void App::buildFramePacket( const unsigned int slot )
+{
+    // Blend between the last two simulation steps.
+    const float alpha = getInterpolationAlpha( slot );
+
+    std::vector<DirectX::XMFLOAT3>& positions = mPackets[slot].wavePositions;
+    positions.resize( mWaves.VertexCount() );
+
+    for ( UINT i = 0; i < mWaves.VertexCount(); ++i ) {
+        positions[i] = mWaves.Interpolated( i, alpha );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void App::drawScene( void )
+{
+    // The camera follows the mouse every frame rather than every step.
     float x = mRadius * sinf( mPhi ) * cosf( mTheta );
     float y = mRadius * sinf( mPhi ) * sinf( mTheta );
     float z = mRadius * cosf( mPhi );
 
-    // Build the view matrix.
     DirectX::XMVECTOR pos = DirectX::XMVectorSet( x, y, z, 1.f );
     DirectX::XMVECTOR target = DirectX::XMVectorZero();
     DirectX::XMVECTOR up = DirectX::XMVectorSet( 0.f, 1.f, 0.f, 0.f );
@@ -186,38 +243,20 @@ void App::updateScene( const float dt )
     DirectX::XMMATRIX V = DirectX::XMMatrixLookAtLH( pos, target, up );
     XMStoreFloat4x4( &mView, V );
 
-    // Generate a random wave every 0.25 seconds.
-    static float t_base = 0.f;
-    if ( ( mTimer.totalTime() - t_base ) >= 0.25f ) {
-        t_base += 0.25f;
-
-        DWORD i = 5 + rand() % 190;
-        DWORD j = 5 + rand() % 190;
-
-        float r = MathHelper::RandF( 1.f, 2.f );
-
-        mWaves.Disturb( i, j, r );
-    }
-
-    mWaves.Update( dt );
+    // Upload the waves from this frame's packet.
+    const std::vector<DirectX::XMFLOAT3>& positions = mPackets[getDrawSlot()].wavePositions;
 
-    // Update wave vertex buffer.
     D3D11_MAPPED_SUBRESOURCE mappedData;
     HR( mD3DImmediateContext->Map( mWavesVB, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData ) );
 
     Vertex* v = reinterpret_cast<Vertex*>( mappedData.pData );
-    for ( UINT i = 0; i < mWaves.VertexCount(); ++i ) {
-        v[i].pos = mWaves[i];
+    for ( size_t i = 0; i < positions.size(); ++i ) {
+        v[i].pos = positions[i];
         v[i].color = DirectX::XMFLOAT4( 0.f, 0.f, 0.f, 1.f );
     }
 
     mD3DImmediateContext->Unmap( mWavesVB, 0 );
-}
-
-// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
-void App::drawScene( void )
-{
     mD3DImmediateContext->ClearRenderTargetView( mRenderTargetView,
                                                  reinterpret_cast<const float*>( &Colors::LightSteelBlue ) );
     mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView,
@@ -45,6 +45,15 @@ struct VertexIn {
     float3 NormalL : NORMAL;
 };
 
+// Many copies of one mesh in one draw: the world matrix and its inverse
+// transpose come with each instance instead of from cbPerObject.
+struct InstancedVertexIn {
+    float3 PosL : POSITION;
+    float3 NormalL : NORMAL;
+    row_major float4x4 World : WORLD;
+    row_major float4x4 WorldInvTranspose : WORLDINVTRANSPOSE;
+};
+
 struct VertexOut {
     float4 PosH : SV_POSITION;
     float3 PosW : POSITION;
@@ -68,6 +77,21 @@ VertexOut VS( VertexIn vin )
     return vout;
 }
 
+// Instanced Vertex Shader. gWorldViewProj holds only view * proj here.
+VertexOut InstancedVS( InstancedVertexIn vin )
+{
+    VertexOut vout;
+
+    // Transform to world space.
+    vout.PosW = mul( float4( vin.PosL, 1.f ), vin.World ).xyz;
+    vout.NormalW = mul( vin.NormalL, ( float3x3 )vin.WorldInvTranspose );
+
+    // Transform to homogeneous clip space.
+    vout.PosH = mul( float4( vout.PosW, 1.f ), gWorldViewProj );
+
+    return vout;
+}
+
 // ================================================= //
 
 // Pixel Shader.
@@ -143,4 +167,30 @@ technique11 Light3 {
     }
 }
 
+// ================================================= //
+
+technique11 Light1Instanced {
+    pass P0 {
+        SetVertexShader( CompileShader( vs_5_0, InstancedVS() ) );
+        SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS( 1 ) ) );
+    }
+}
+
+technique11 Light2Instanced {
+    pass P0 {
+        SetVertexShader( CompileShader( vs_5_0, InstancedVS() ) );
+        SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS( 2 ) ) );
+    }
+}
+
+technique11 Light3Instanced {
+    pass P0 {
+        SetVertexShader( CompileShader( vs_5_0, InstancedVS() ) );
+        SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS( 3 ) ) );
+    }
+}
+
 // ================================================= //
\ No newline at end of file
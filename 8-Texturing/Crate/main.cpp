@@ -8,6 +8,7 @@
 #include "GeometryGenerator.h"
 #include "LightHelper.h"
 #include "MathHelper.h"
+#include "TextureMgr.h"
 #include "Vertex.h"
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -41,7 +42,8 @@ private:
     ID3D11Buffer* mBoxVB;
     ID3D11Buffer* mBoxIB;
 
-    ID3D11ShaderResourceView* mDiffuseMapSRV;
+    TextureMgr mTexMgr;
+    TextureMgr::Handle mDiffuseMap;
 
     DirectionalLight mDirLights[3];
     Material mBoxMat;
@@ -89,7 +91,7 @@ App::App( HINSTANCE hInstance )
     : D3DApp( hInstance )
     , mBoxVB( nullptr )
     , mBoxIB( nullptr )
-    , mDiffuseMapSRV( nullptr )
+    , mDiffuseMap( TextureMgr::InvalidHandle )
     , mLightCount( 1 )
     , mEyePosW( 0.f, 0.f, 0.f )
     , mTheta( 1.5f * MathHelper::Pi )
@@ -127,7 +129,6 @@ App::~App( void )
 {
     ReleaseCOM( mBoxVB );
     ReleaseCOM( mBoxIB );   
-    ReleaseCOM( mDiffuseMapSRV );
 
     Effects::DestroyAll();
     InputLayouts::DestroyAll();
@@ -144,18 +145,10 @@ bool App::init( void )
     Effects::InitAll( mD3DDevice );
     InputLayouts::InitAll( mD3DDevice );
 
-    //HR (D3DX11CreateShader)
-    TexMetadata data;
-    std::unique_ptr<ScratchImage> image( new ScratchImage() );
-    HR( LoadFromDDSFile( L"Textures/WoodCrate01.dds",
-                         DDS_FLAGS_NONE,
-                         &data,
-                         *image ) );
-    HR( CreateShaderResourceView( mD3DDevice,
-                                  image->GetImages(),
-                                  image->GetImageCount(),
-                                  data,
-                                  &mDiffuseMapSRV ) );
+    // Streams in the background; the box is drawn with a placeholder until
+    // the texture is resident.
+    mTexMgr.Init( mD3DDevice );
+    mDiffuseMap = mTexMgr.Request( L"Textures/WoodCrate01.dds" );
 
     buildGeometryBuffers();
 
@@ -205,6 +198,12 @@ void App::updateScene( const float dt )
 
 void App::drawScene( void )
 {
+    // Picks up edits to the .fx files while the demo runs.
+    Effects::ReloadChanged();
+
+    // Create GPU textures for any loads that finished since last frame.
+    mTexMgr.Update();
+
     mD3DImmediateContext->ClearRenderTargetView( mRenderTargetView,
                                                  reinterpret_cast<const float*>( &Colors::LightSteelBlue ) );
     mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView,
@@ -247,7 +246,7 @@ void App::drawScene( void )
         Effects::BasicFX->SetWorldViewProj( worldViewProj );
         Effects::BasicFX->SetTexTransform( XMLoadFloat4x4( &mTexTransform ) );
         Effects::BasicFX->SetMaterial( mBoxMat );
-        Effects::BasicFX->SetDiffuseMap( mDiffuseMapSRV );
+        Effects::BasicFX->SetDiffuseMap( mTexMgr.GetSRV( mDiffuseMap ) );
 
         tech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
         mD3DImmediateContext->DrawIndexed( mBoxIndexCount, mBoxIndexOffset, mBoxVertexOffset );
@@ -3,12 +3,15 @@
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
 #include "D3DApp.h"
+#include "D3DRenderBackend.h"
 #include "d3dx11Effect.h"
 #include "Effects.h"
 #include "GeometryGenerator.h"
+#include "JobSystem.h"
 #include "LightHelper.h"
 #include "MathHelper.h"
 #include "RenderStates.h"
+#include "TransparencySorter.h"
 #include "Vertex.h"
 #include "Waves.h"
 
@@ -52,12 +55,24 @@ private:
 
 private:
 
+    // What a blended draw sets before it is issued.
+    struct TransparentObject {
+        const XMFLOAT4X4* world;
+        const XMFLOAT4X4* texTransform;
+        const Material* material;
+        ID3D11ShaderResourceView* diffuseMap;
+    };
+
     ID3D11Buffer* mLandVB;
     ID3D11Buffer* mLandIB;
 
     ID3D11Buffer* mWavesVB;
     ID3D11Buffer* mWavesIB;
 
+    // The waves' triangles, back to front, rewritten every frame.
+    ID3D11Buffer* mWavesSortedIB;
+    std::vector<UINT> mWavesIndices;
+
     ID3D11Buffer* mBoxVB;
     ID3D11Buffer* mBoxIB;
 
@@ -66,6 +81,10 @@ private:
     ID3D11ShaderResourceView* mBoxMapSRV;
 
     Waves mWaves;
+    TransparentObject mWavesObject;
+
+    TransparencySorter mTransparency;
+    bool mSortWaveTriangles;
 
     DirectionalLight mDirLights[3];
     Material mLandMat;
@@ -116,9 +135,9 @@ int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE prevInstance,
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
 App::App( HINSTANCE hInstance )
-    : D3DApp( hInstance ), mLandVB( 0 ), mLandIB( 0 ), mWavesVB( 0 ), mWavesIB( 0 ), mBoxVB( 0 ), mBoxIB( 0 ), mGrassMapSRV( 0 ), mWavesMapSRV( 0 ), mBoxMapSRV( 0 ),
+    : D3DApp( hInstance ), mLandVB( 0 ), mLandIB( 0 ), mWavesVB( 0 ), mWavesIB( 0 ), mWavesSortedIB( 0 ), mBoxVB( 0 ), mBoxIB( 0 ), mGrassMapSRV( 0 ), mWavesMapSRV( 0 ), mBoxMapSRV( 0 ),
     mWaterTexOffset( 0.0f, 0.0f ), mEyePosW( 0.0f, 0.0f, 0.0f ), mLandIndexCount( 0 ), mRenderOptions( RenderOptions::TexturesAndFog ),
-    mTheta( 1.3f*MathHelper::Pi ), mPhi( 0.4f*MathHelper::Pi ), mRadius( 80.0f )
+    mTheta( 1.3f*MathHelper::Pi ), mPhi( 0.4f*MathHelper::Pi ), mRadius( 80.0f ), mSortWaveTriangles( false )
 {
     mMainWindowCaption = L"Blending Demo";
 
@@ -163,6 +182,11 @@ App::App( HINSTANCE hInstance )
     mBoxMat.ambient = XMFLOAT4( 0.5f, 0.5f, 0.5f, 1.0f );
     mBoxMat.diffuse = XMFLOAT4( 1.0f, 1.0f, 1.0f, 1.0f );
     mBoxMat.specular = XMFLOAT4( 0.4f, 0.4f, 0.4f, 16.0f );
+
+    mWavesObject.world = &mWavesWorld;
+    mWavesObject.texTransform = &mWaterTexTransform;
+    mWavesObject.material = &mWavesMat;
+    mWavesObject.diffuseMap = nullptr;
 }
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -174,6 +198,7 @@ App::~App( void )
     ReleaseCOM( mLandIB );
     ReleaseCOM( mWavesVB );
     ReleaseCOM( mWavesIB );
+    ReleaseCOM( mWavesSortedIB );
     ReleaseCOM( mBoxVB );
     ReleaseCOM( mBoxIB );
     ReleaseCOM( mGrassMapSRV );
@@ -222,6 +247,7 @@ bool App::init( void )
                                   image->GetImageCount(),
                                   data,
                                   &mWavesMapSRV ) );
+    mWavesObject.diffuseMap = mWavesMapSRV;
     image.reset( new ScratchImage() );
     ZeroMemory( &data, sizeof( data ) );
     HR( LoadFromDDSFile( L"Textures/WireFence.dds",
@@ -330,12 +356,23 @@ void App::updateScene( const float dt )
 
     if ( GetAsyncKeyState( '3' ) & 0x8000 )
         mRenderOptions = RenderOptions::TexturesAndFog;
+
+    // Sort the waves by triangle, or only by row (the default: a full
+    // triangle sort every frame costs more than the crests are worth).
+    if ( GetAsyncKeyState( '4' ) & 0x8000 )
+        mSortWaveTriangles = true;
+
+    if ( GetAsyncKeyState( '5' ) & 0x8000 )
+        mSortWaveTriangles = false;
 }
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
 void App::drawScene( void )
 {
+    // Picks up edits to the .fx files while the demo runs.
+    Effects::ReloadChanged();
+
     mD3DImmediateContext->ClearRenderTargetView( mRenderTargetView,
                                                  reinterpret_cast<const float*>( &Colors::Silver ) );
     mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView,
@@ -433,32 +470,80 @@ void App::drawScene( void )
 
         landAndWavesTech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
         mD3DImmediateContext->DrawIndexed( mLandIndexCount, 0, 0 );
+    }
 
-        //
-        // Draw the waves.
-        //
-        mD3DImmediateContext->IASetVertexBuffers( 0, 1, &mWavesVB, &stride, &offset );
-        mD3DImmediateContext->IASetIndexBuffer( mWavesIB, DXGI_FORMAT_R32_UINT, 0 );
+    //
+    // Blended draws go last, back to front.
+    //
+    mTransparency.Begin( view, 1.f, 1000.f );
+
+    ID3D11Buffer* wavesIB = mWavesIB;
+    if ( mSortWaveTriangles ) {
+        // The waves overlap themselves where they crest, so ordering the
+        // mesh as a whole is not enough; order its triangles.
+        D3D11_MAPPED_SUBRESOURCE md;
+        HR( mD3DImmediateContext->Map( mWavesSortedIB, 0, D3D11_MAP_WRITE_DISCARD, 0, &md ) );
+        mTransparency.SortTriangles( &mWaves[0],
+                                     &mWavesIndices[0],
+                                     mWaves.TriangleCount(),
+                                     XMLoadFloat4x4( &mWavesWorld ) * view,
+                                     &JobSystem::Instance(),
+                                     reinterpret_cast<UINT*>( md.pData ) );
+        mD3DImmediateContext->Unmap( mWavesSortedIB, 0 );
+
+        wavesIB = mWavesSortedIB;
+    }
 
-        // Set per object constants.
-        world = XMLoadFloat4x4( &mWavesWorld );
-        worldInvTranspose = MathHelper::InverseTranspose( world );
-        worldViewProj = world*view*proj;
+    RenderItem wavesItem;
+    wavesItem.topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    wavesItem.inputLayout = InputLayouts::Basic32;
+    wavesItem.vertexBuffer = mWavesVB;
+    wavesItem.vertexStride = stride;
+    wavesItem.indexBuffer = wavesIB;
+    wavesItem.indexFormat = DXGI_FORMAT_R32_UINT;
+    wavesItem.blendState = RenderStates::TransparentBS;
+    wavesItem.technique = landAndWavesTech;
+    wavesItem.object = &mWavesObject;
+
+    // Unsorted, each row of quads is a draw of its own; rows that end up
+    // in index order are merged back together.
+    const UINT rowCount = mSortWaveTriangles ? 1 : mWaves.RowCount() - 1;
+    const UINT rowIndexCount = 3 * mWaves.TriangleCount() / rowCount;
+
+    for ( UINT p = 0; p < techDesc.Passes; ++p ) {
+        for ( UINT row = 0; row < rowCount; ++row ) {
+            wavesItem.pass = p;
+            wavesItem.indexCount = rowIndexCount;
+            wavesItem.startIndex = row * rowIndexCount;
+
+            const UINT rowMiddle = ( 2 * row + 1 ) * mWaves.ColumnCount() / 2;
+            XMFLOAT3 center = mSortWaveTriangles ? XMFLOAT3( 0.f, 0.f, 0.f ) : mWaves[rowMiddle];
+            XMStoreFloat3( &center, XMVector3Transform( XMLoadFloat3( &center ), XMLoadFloat4x4( &mWavesWorld ) ) );
+
+            mTransparency.Submit( wavesItem, center, p );
+        }
+    }
+
+    mTransparency.Sort( &JobSystem::Instance() );
+
+    D3DRenderBackend backend( mD3DImmediateContext, [&viewProj]( ID3D11DeviceContext* context, const RenderItem& item ) {
+        const TransparentObject& object = *static_cast<const TransparentObject*>( item.object );
 
+        XMMATRIX world = XMLoadFloat4x4( object.world );
         Effects::BasicFX->SetWorld( world );
-        Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-        Effects::BasicFX->SetWorldViewProj( worldViewProj );
-        Effects::BasicFX->SetTexTransform( XMLoadFloat4x4( &mWaterTexTransform ) );
-        Effects::BasicFX->SetMaterial( mWavesMat );
-        Effects::BasicFX->SetDiffuseMap( mWavesMapSRV );
+        Effects::BasicFX->SetWorldInvTranspose( MathHelper::InverseTranspose( world ) );
+        Effects::BasicFX->SetWorldViewProj( world * viewProj );
+        Effects::BasicFX->SetTexTransform( XMLoadFloat4x4( object.texTransform ) );
+        Effects::BasicFX->SetMaterial( *object.material );
+        Effects::BasicFX->SetDiffuseMap( object.diffuseMap );
 
-        mD3DImmediateContext->OMSetBlendState( RenderStates::TransparentBS, blendFactor, 0xffffffff );
-        landAndWavesTech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-        mD3DImmediateContext->DrawIndexed( 3 * mWaves.TriangleCount(), 0, 0 );
+        ID3DX11EffectTechnique* technique = static_cast<ID3DX11EffectTechnique*>( const_cast<void*>( item.technique ) );
+        technique->GetPassByIndex( item.pass )->Apply( 0, context );
+    } );
+    mTransparency.Execute( backend );
 
-        // Restore default blend state
-        mD3DImmediateContext->OMSetBlendState( nullptr, blendFactor, 0xffffffff );
-    }
+    // Restore default blend state
+    mD3DImmediateContext->OMSetBlendState( nullptr, blendFactor, 0xffffffff );
 
     HR( mSwapChain->Present( 0, 0 ) );
 }
@@ -634,6 +719,13 @@ void App::BuildWaveGeometryBuffers()
     D3D11_SUBRESOURCE_DATA iinitData;
     iinitData.pSysMem = &indices[0];
     HR( mD3DDevice->CreateBuffer( &ibd, &iinitData, &mWavesIB ) );
+
+    // The same indices, sorted back to front every frame.
+    ibd.Usage = D3D11_USAGE_DYNAMIC;
+    ibd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    HR( mD3DDevice->CreateBuffer( &ibd, 0, &mWavesSortedIB ) );
+
+    mWavesIndices.swap( indices );
 }
 
 void App::BuildCrateGeometryBuffers()
@@ -0,0 +1,453 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file BezierPatch.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "BezierPatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // Below this, relative to |dP/du|^2 |dP/dv|^2, the cross product is too
+    // short to give a direction: the derivatives vanish or are parallel.
+    const float DegenerateNormal = 1e-12f;
+
+    // How far inside the patch a degenerate normal is taken instead.
+    const float NormalNudge = 1e-3f;
+
+    // Cubic Bernstein polynomials at t and their derivatives.
+    void Basis( const float t, float b[4], float d[4] )
+    {
+        const float s = 1.f - t;
+
+        b[0] = s * s * s;
+        b[1] = 3.f * t * s * s;
+        b[2] = 3.f * t * t * s;
+        b[3] = t * t * t;
+
+        d[0] = -3.f * s * s;
+        d[1] = 3.f * s * s - 6.f * t * s;
+        d[2] = 6.f * t * s - 3.f * t * t;
+        d[3] = 3.f * t * t;
+    }
+
+    // The same for four values of t, one per lane.
+    void Basis( FXMVECTOR t, XMVECTOR b[4], XMVECTOR d[4] )
+    {
+        const XMVECTOR s = XMVectorSubtract( XMVectorReplicate( 1.f ), t );
+        const XMVECTOR tt = XMVectorMultiply( t, t );
+        const XMVECTOR ss = XMVectorMultiply( s, s );
+        const XMVECTOR ts = XMVectorMultiply( t, s );
+
+        b[0] = XMVectorMultiply( ss, s );
+        b[1] = XMVectorScale( XMVectorMultiply( ss, t ), 3.f );
+        b[2] = XMVectorScale( XMVectorMultiply( tt, s ), 3.f );
+        b[3] = XMVectorMultiply( tt, t );
+
+        d[0] = XMVectorScale( ss, -3.f );
+        d[1] = XMVectorSubtract( XMVectorScale( ss, 3.f ), XMVectorScale( ts, 6.f ) );
+        d[2] = XMVectorSubtract( XMVectorScale( ts, 6.f ), XMVectorScale( tt, 3.f ) );
+        d[3] = XMVectorScale( tt, 3.f );
+    }
+
+    XMFLOAT3 Cross( const XMFLOAT3& a, const XMFLOAT3& b )
+    {
+        return XMFLOAT3( a.y * b.z - a.z * b.y,
+                         a.z * b.x - a.x * b.z,
+                         a.x * b.y - a.y * b.x );
+    }
+
+    float Dot( const XMFLOAT3& a, const XMFLOAT3& b )
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    // a / |a|, or zero for a zero vector.
+    XMFLOAT3 Normalized( const XMFLOAT3& a )
+    {
+        const float length = std::sqrt( Dot( a, a ) );
+        if ( length == 0.f ) {
+            return XMFLOAT3( 0.f, 0.f, 0.f );
+        }
+        return XMFLOAT3( a.x / length, a.y / length, a.z / length );
+    }
+
+    bool IsDegenerate( const float nn, const float uu, const float vv )
+    {
+        return nn <= DegenerateNormal * uu * vv;
+    }
+
+    // The position and derivatives at (u, v) by the formula.
+    void Sum( const XMFLOAT3 cp[16], const float u, const float v,
+              XMFLOAT3& position, XMFLOAT3& dPdu, XMFLOAT3& dPdv )
+    {
+        float bu[4], du[4], bv[4], dv[4];
+        Basis( u, bu, du );
+        Basis( v, bv, dv );
+
+        position = dPdu = dPdv = XMFLOAT3( 0.f, 0.f, 0.f );
+
+        for ( int j = 0; j < 4; ++j ) {
+            XMFLOAT3 row( 0.f, 0.f, 0.f );
+            XMFLOAT3 rowDu( 0.f, 0.f, 0.f );
+            for ( int i = 0; i < 4; ++i ) {
+                const XMFLOAT3& p = cp[j * 4 + i];
+                row.x += bu[i] * p.x;
+                row.y += bu[i] * p.y;
+                row.z += bu[i] * p.z;
+                rowDu.x += du[i] * p.x;
+                rowDu.y += du[i] * p.y;
+                rowDu.z += du[i] * p.z;
+            }
+
+            position.x += bv[j] * row.x;
+            position.y += bv[j] * row.y;
+            position.z += bv[j] * row.z;
+            dPdu.x += bv[j] * rowDu.x;
+            dPdu.y += bv[j] * rowDu.y;
+            dPdu.z += bv[j] * rowDu.z;
+            dPdv.x += dv[j] * row.x;
+            dPdv.y += dv[j] * row.y;
+            dPdv.z += dv[j] * row.z;
+        }
+    }
+
+    // The unit normal at (u, v), taken a little toward the middle of the
+    // patch where the derivatives do not give one.
+    XMFLOAT3 Normal( const XMFLOAT3 cp[16], const float u, const float v, const XMFLOAT3& dPdu, const XMFLOAT3& dPdv )
+    {
+        XMFLOAT3 n = Cross( dPdu, dPdv );
+        if ( IsDegenerate( Dot( n, n ), Dot( dPdu, dPdu ), Dot( dPdv, dPdv ) ) ) {
+            const float nu = u + ( u < 0.5f ? NormalNudge : -NormalNudge );
+            const float nv = v + ( v < 0.5f ? NormalNudge : -NormalNudge );
+
+            XMFLOAT3 position, du, dv;
+            Sum( cp, nu, nv, position, du, dv );
+            n = Cross( du, dv );
+        }
+        return Normalized( n );
+    }
+
+    // Splits the cubic a, b, c, d at t = 1/2 by de Casteljau; left and right
+    // get the control points of each half.
+    void SplitCubic( const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c, const XMFLOAT3& d,
+                     XMFLOAT3 left[4], XMFLOAT3 right[4] )
+    {
+        auto mid = []( const XMFLOAT3& p, const XMFLOAT3& q ) {
+            return XMFLOAT3( 0.5f * ( p.x + q.x ), 0.5f * ( p.y + q.y ), 0.5f * ( p.z + q.z ) );
+        };
+
+        const XMFLOAT3 ab = mid( a, b );
+        const XMFLOAT3 bc = mid( b, c );
+        const XMFLOAT3 cd = mid( c, d );
+        const XMFLOAT3 abc = mid( ab, bc );
+        const XMFLOAT3 bcd = mid( bc, cd );
+        const XMFLOAT3 abcd = mid( abc, bcd );
+
+        left[0] = a;
+        left[1] = ab;
+        left[2] = abc;
+        left[3] = abcd;
+
+        right[0] = abcd;
+        right[1] = bcd;
+        right[2] = cd;
+        right[3] = d;
+    }
+
+    // Splits a patch in half across u (rows split) or across v (columns).
+    void SplitPatch( const XMFLOAT3 cp[16], const bool alongU, XMFLOAT3 first[16], XMFLOAT3 second[16] )
+    {
+        for ( int k = 0; k < 4; ++k ) {
+            // Element n of row or column k.
+            const int stride = alongU ? 1 : 4;
+            const int start = alongU ? k * 4 : k;
+
+            XMFLOAT3 left[4], right[4];
+            SplitCubic( cp[start], cp[start + stride], cp[start + 2 * stride], cp[start + 3 * stride], left, right );
+
+            for ( int n = 0; n < 4; ++n ) {
+                first[start + n * stride] = left[n];
+                second[start + n * stride] = right[n];
+            }
+        }
+    }
+
+    void GrowBounds( const XMFLOAT3 cp[16], const unsigned int subdivisions, XMFLOAT3& boundsMin, XMFLOAT3& boundsMax )
+    {
+        if ( subdivisions == 0 ) {
+            for ( int i = 0; i < 16; ++i ) {
+                boundsMin = XMFLOAT3( std::min( boundsMin.x, cp[i].x ), std::min( boundsMin.y, cp[i].y ), std::min( boundsMin.z, cp[i].z ) );
+                boundsMax = XMFLOAT3( std::max( boundsMax.x, cp[i].x ), std::max( boundsMax.y, cp[i].y ), std::max( boundsMax.z, cp[i].z ) );
+            }
+            return;
+        }
+
+        XMFLOAT3 halves[2][16];
+        SplitPatch( cp, true, halves[0], halves[1] );
+
+        for ( int h = 0; h < 2; ++h ) {
+            XMFLOAT3 quarters[2][16];
+            SplitPatch( halves[h], false, quarters[0], quarters[1] );
+            GrowBounds( quarters[0], subdivisions - 1, boundsMin, boundsMax );
+            GrowBounds( quarters[1], subdivisions - 1, boundsMin, boundsMax );
+        }
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+BezierPatch::BezierPatch( void )
+{
+    std::memset( mControlPoints, 0, sizeof( mControlPoints ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+BezierPatch::BezierPatch( const XMFLOAT3 controlPoints[16] )
+{
+    Set( controlPoints );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void BezierPatch::Set( const XMFLOAT3 controlPoints[16] )
+{
+    std::copy( controlPoints, controlPoints + 16, mControlPoints );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const XMFLOAT3* BezierPatch::GetControlPoints( void ) const
+{
+    return mControlPoints;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+XMFLOAT3 BezierPatch::Evaluate( const float u, const float v ) const
+{
+    XMFLOAT3 position;
+    Evaluate( u, v, &position, nullptr, nullptr, nullptr );
+    return position;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void BezierPatch::Evaluate( const float u, const float v,
+                            XMFLOAT3* position,
+                            XMFLOAT3* dPdu,
+                            XMFLOAT3* dPdv,
+                            XMFLOAT3* normal ) const
+{
+    XMFLOAT3 p, du, dv;
+    Sum( mControlPoints, u, v, p, du, dv );
+
+    if ( position != nullptr ) {
+        *position = p;
+    }
+    if ( dPdu != nullptr ) {
+        *dPdu = du;
+    }
+    if ( dPdv != nullptr ) {
+        *dPdv = dv;
+    }
+    if ( normal != nullptr ) {
+        *normal = Normal( mControlPoints, u, v, du, dv );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void BezierPatch::EvaluateBatch( const XMFLOAT2* uv,
+                                 const size_t count,
+                                 XMFLOAT3* positions,
+                                 XMFLOAT3* dPdu,
+                                 XMFLOAT3* dPdv,
+                                 XMFLOAT3* normals ) const
+{
+    const bool needDu = dPdu != nullptr || normals != nullptr;
+    const bool needDv = dPdv != nullptr || normals != nullptr;
+
+    // Each control point coordinate in all four lanes.
+    XMVECTOR cx[16], cy[16], cz[16];
+    for ( int i = 0; i < 16; ++i ) {
+        cx[i] = XMVectorReplicate( mControlPoints[i].x );
+        cy[i] = XMVectorReplicate( mControlPoints[i].y );
+        cz[i] = XMVectorReplicate( mControlPoints[i].z );
+    }
+
+    const XMVECTOR zero = XMVectorZero();
+
+    // Stores x, y, z (lane k of each) to out[k] for the four lanes.
+    auto store = [zero]( FXMVECTOR x, FXMVECTOR y, FXMVECTOR z, XMFLOAT3* out ) {
+        const XMMATRIX points = XMMatrixTranspose( XMMATRIX( x, y, z, zero ) );
+        for ( int k = 0; k < 4; ++k ) {
+            XMStoreFloat3( &out[k], points.r[k] );
+        }
+    };
+
+    size_t i = 0;
+    for ( ; i + 4 <= count; i += 4 ) {
+        const XMVECTOR u = XMVectorSet( uv[i].x, uv[i + 1].x, uv[i + 2].x, uv[i + 3].x );
+        const XMVECTOR v = XMVectorSet( uv[i].y, uv[i + 1].y, uv[i + 2].y, uv[i + 3].y );
+
+        XMVECTOR bu[4], du[4], bv[4], dv[4];
+        Basis( u, bu, du );
+        Basis( v, bv, dv );
+
+        // Rows are summed along u first, then the rows along v, the way
+        // Sum() does, so rounding matches the reference closely.
+        XMVECTOR px = zero, py = zero, pz = zero;
+        XMVECTOR ux = zero, uy = zero, uz = zero;
+        XMVECTOR vx = zero, vy = zero, vz = zero;
+
+        for ( int j = 0; j < 4; ++j ) {
+            XMVECTOR rx = zero, ry = zero, rz = zero;
+            XMVECTOR rdx = zero, rdy = zero, rdz = zero;
+            for ( int k = 0; k < 4; ++k ) {
+                const int c = j * 4 + k;
+                rx = XMVectorMultiplyAdd( bu[k], cx[c], rx );
+                ry = XMVectorMultiplyAdd( bu[k], cy[c], ry );
+                rz = XMVectorMultiplyAdd( bu[k], cz[c], rz );
+                if ( needDu ) {
+                    rdx = XMVectorMultiplyAdd( du[k], cx[c], rdx );
+                    rdy = XMVectorMultiplyAdd( du[k], cy[c], rdy );
+                    rdz = XMVectorMultiplyAdd( du[k], cz[c], rdz );
+                }
+            }
+
+            px = XMVectorMultiplyAdd( bv[j], rx, px );
+            py = XMVectorMultiplyAdd( bv[j], ry, py );
+            pz = XMVectorMultiplyAdd( bv[j], rz, pz );
+            if ( needDu ) {
+                ux = XMVectorMultiplyAdd( bv[j], rdx, ux );
+                uy = XMVectorMultiplyAdd( bv[j], rdy, uy );
+                uz = XMVectorMultiplyAdd( bv[j], rdz, uz );
+            }
+            if ( needDv ) {
+                vx = XMVectorMultiplyAdd( dv[j], rx, vx );
+                vy = XMVectorMultiplyAdd( dv[j], ry, vy );
+                vz = XMVectorMultiplyAdd( dv[j], rz, vz );
+            }
+        }
+
+        if ( positions != nullptr ) {
+            store( px, py, pz, positions + i );
+        }
+        if ( dPdu != nullptr ) {
+            store( ux, uy, uz, dPdu + i );
+        }
+        if ( dPdv != nullptr ) {
+            store( vx, vy, vz, dPdv + i );
+        }
+
+        if ( normals != nullptr ) {
+            const XMVECTOR nx = XMVectorSubtract( XMVectorMultiply( uy, vz ), XMVectorMultiply( uz, vy ) );
+            const XMVECTOR ny = XMVectorSubtract( XMVectorMultiply( uz, vx ), XMVectorMultiply( ux, vz ) );
+            const XMVECTOR nz = XMVectorSubtract( XMVectorMultiply( ux, vy ), XMVectorMultiply( uy, vx ) );
+
+            XMVECTOR nn = XMVectorMultiply( nx, nx );
+            nn = XMVectorMultiplyAdd( ny, ny, nn );
+            nn = XMVectorMultiplyAdd( nz, nz, nn );
+
+            XMVECTOR uu = XMVectorMultiply( ux, ux );
+            uu = XMVectorMultiplyAdd( uy, uy, uu );
+            uu = XMVectorMultiplyAdd( uz, uz, uu );
+
+            XMVECTOR vv = XMVectorMultiply( vx, vx );
+            vv = XMVectorMultiplyAdd( vy, vy, vv );
+            vv = XMVectorMultiplyAdd( vz, vz, vv );
+
+            // Degenerate lanes divide by zero here and are redone below.
+            const XMVECTOR inverseLength = XMVectorDivide( XMVectorReplicate( 1.f ), XMVectorSqrt( nn ) );
+            store( XMVectorMultiply( nx, inverseLength ),
+                   XMVectorMultiply( ny, inverseLength ),
+                   XMVectorMultiply( nz, inverseLength ),
+                   normals + i );
+
+            XMFLOAT4 lengths, scales;
+            XMStoreFloat4( &lengths, nn );
+            XMStoreFloat4( &scales, XMVectorMultiply( uu, vv ) );
+            const float laneLengths[4] = { lengths.x, lengths.y, lengths.z, lengths.w };
+            const float laneScales[4] = { scales.x, scales.y, scales.z, scales.w };
+
+            for ( int k = 0; k < 4; ++k ) {
+                if ( IsDegenerate( laneLengths[k], 1.f, laneScales[k] ) ) {
+                    Evaluate( uv[i + k].x, uv[i + k].y, nullptr, nullptr, nullptr, &normals[i + k] );
+                }
+            }
+        }
+    }
+
+    for ( ; i < count; ++i ) {
+        Evaluate( uv[i].x, uv[i].y,
+                  positions != nullptr ? &positions[i] : nullptr,
+                  dPdu != nullptr ? &dPdu[i] : nullptr,
+                  dPdv != nullptr ? &dPdv[i] : nullptr,
+                  normals != nullptr ? &normals[i] : nullptr );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void BezierPatch::GetBounds( XMFLOAT3& boundsMin, XMFLOAT3& boundsMax, const unsigned int subdivisions ) const
+{
+    boundsMin = boundsMax = mControlPoints[0];
+    GrowBounds( mControlPoints, subdivisions, boundsMin, boundsMax );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void BezierPatch::Bake( const UINT resolution, GeometryGenerator::MeshData& meshData ) const
+{
+    const UINT cells = std::max( resolution, 1u );
+    const UINT n = cells + 1;
+
+    std::vector<XMFLOAT2> uv( n * n );
+    for ( UINT j = 0; j < n; ++j ) {
+        for ( UINT i = 0; i < n; ++i ) {
+            uv[j * n + i] = XMFLOAT2( static_cast<float>( i ) / cells, static_cast<float>( j ) / cells );
+        }
+    }
+
+    std::vector<XMFLOAT3> positions( n * n );
+    std::vector<XMFLOAT3> tangents( n * n );
+    std::vector<XMFLOAT3> normals( n * n );
+    EvaluateBatch( uv.data(), uv.size(), positions.data(), tangents.data(), nullptr, normals.data() );
+
+    meshData.vertices.resize( n * n );
+    for ( UINT k = 0; k < n * n; ++k ) {
+        meshData.vertices[k] = GeometryGenerator::Vertex( positions[k], normals[k], Normalized( tangents[k] ), uv[k] );
+    }
+
+    // Two triangles per cell, wound as GeometryGenerator::createGrid()
+    // winds its rows, which faces them along dP/du x dP/dv.
+    meshData.indices.resize( cells * cells * 6 );
+    UINT k = 0;
+    for ( UINT j = 0; j < cells; ++j ) {
+        for ( UINT i = 0; i < cells; ++i ) {
+            const UINT a = j * n + i;
+
+            meshData.indices[k++] = a;
+            meshData.indices[k++] = a + 1;
+            meshData.indices[k++] = a + n;
+
+            meshData.indices[k++] = a + n;
+            meshData.indices[k++] = a + 1;
+            meshData.indices[k++] = a + n + 1;
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,77 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file BezierPatch.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <cstddef>
+
+#include <DirectXMath.h>
+
+#include "GeometryGenerator.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Bicubic Bezier patch evaluated on the CPU, for what the tessellation
+/// stages cannot help with: collision, culling, and a mesh to draw where
+/// hull and domain shaders are not used.
+///
+/// Control points are row by row (v), u along a row, as
+/// BezierTessellation.fx evaluates them, so P( u, v ) here is the point
+/// the domain shader outputs for the same (u, v). Normals are
+/// dP/du x dP/dv, which faces up for the demo patch and matches the
+/// winding Bake() gives its triangles.
+///
+/// Evaluate() is the plain formula; EvaluateBatch() does four (u, v) at a
+/// time across SIMD lanes and gives the same results to rounding.
+///</summary>
+class BezierPatch {
+public:
+
+    BezierPatch( void );
+    explicit BezierPatch( const DirectX::XMFLOAT3 controlPoints[16] );
+
+    void Set( const DirectX::XMFLOAT3 controlPoints[16] );
+
+    const DirectX::XMFLOAT3* GetControlPoints( void ) const;
+
+    DirectX::XMFLOAT3 Evaluate( const float u, const float v ) const;
+
+    // Any output may be null. Where the derivatives vanish, at a corner
+    // whose edges collapse, the normal is taken just inside the patch.
+    void Evaluate( const float u, const float v,
+                   DirectX::XMFLOAT3* position,
+                   DirectX::XMFLOAT3* dPdu,
+                   DirectX::XMFLOAT3* dPdv,
+                   DirectX::XMFLOAT3* normal ) const;
+
+    // Evaluate() for count (u, v) pairs; null outputs are not computed.
+    void EvaluateBatch( const DirectX::XMFLOAT2* uv,
+                        const size_t count,
+                        DirectX::XMFLOAT3* positions,
+                        DirectX::XMFLOAT3* dPdu,
+                        DirectX::XMFLOAT3* dPdv,
+                        DirectX::XMFLOAT3* normals ) const;
+
+    // Box around the patch. The control points hold the patch in their
+    // hull; each subdivision splits the patch in four and boxes the pieces,
+    // which brings the box about four times closer to the surface.
+    void GetBounds( DirectX::XMFLOAT3& boundsMin,
+                    DirectX::XMFLOAT3& boundsMax,
+                    const unsigned int subdivisions = 0 ) const;
+
+    // A ( resolution + 1 )^2 grid of vertices at even steps of u and v,
+    // row by row (v), and two triangles per cell. texC is (u, v), tangentU
+    // the unit dP/du.
+    void Bake( const UINT resolution, GeometryGenerator::MeshData& meshData ) const;
+
+private:
+
+    DirectX::XMFLOAT3 mControlPoints[16];
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,887 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file BlockCompressor.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "BlockCompressor.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    const size_t BlockRowsPerJob = 4;
+
+    // BC7 index weights for 4-bit indices, out of 64.
+    const int BC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    inline int Clamp( const int v, const int lo, const int hi )
+    {
+        return v < lo ? lo : ( v > hi ? hi : v );
+    }
+
+    inline int Round( const float v )
+    {
+        return static_cast<int>( std::floor( v + 0.5f ) );
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    ///<summary>
+    /// Mean and principal axis of up to 16 points with `channels` components,
+    /// found by power iteration on the covariance matrix. The axis is zero
+    /// when all points are equal.
+    ///</summary>
+    void PrincipalAxis( const float points[][4], const int count, const int channels, float mean[4], float axis[4] )
+    {
+        for ( int c = 0; c < 4; ++c ) {
+            mean[c] = 0.0f;
+            axis[c] = 0.0f;
+        }
+        if ( count == 0 ) {
+            return;
+        }
+
+        for ( int i = 0; i < count; ++i ) {
+            for ( int c = 0; c < channels; ++c ) {
+                mean[c] += points[i][c];
+            }
+        }
+        for ( int c = 0; c < channels; ++c ) {
+            mean[c] /= static_cast<float>( count );
+        }
+
+        float cov[4][4] = { };
+        for ( int i = 0; i < count; ++i ) {
+            for ( int r = 0; r < channels; ++r ) {
+                for ( int c = 0; c < channels; ++c ) {
+                    cov[r][c] += ( points[i][r] - mean[r] ) * ( points[i][c] - mean[c] );
+                }
+            }
+        }
+
+        // Start from the channel with the largest spread; the dominant
+        // eigenvector is seldom orthogonal to it.
+        int widest = 0;
+        for ( int c = 1; c < channels; ++c ) {
+            if ( cov[c][c] > cov[widest][widest] ) {
+                widest = c;
+            }
+        }
+        if ( cov[widest][widest] <= 0.0f ) {
+            return;
+        }
+
+        float v[4] = { };
+        v[widest] = 1.0f;
+
+        for ( int iteration = 0; iteration < 8; ++iteration ) {
+            float next[4] = { };
+            for ( int r = 0; r < channels; ++r ) {
+                for ( int c = 0; c < channels; ++c ) {
+                    next[r] += cov[r][c] * v[c];
+                }
+            }
+
+            float length = 0.0f;
+            for ( int c = 0; c < channels; ++c ) {
+                length += next[c] * next[c];
+            }
+            if ( length <= 0.0f ) {
+                return;
+            }
+
+            length = 1.0f / std::sqrt( length );
+            for ( int c = 0; c < channels; ++c ) {
+                v[c] = next[c] * length;
+            }
+        }
+
+        for ( int c = 0; c < channels; ++c ) {
+            axis[c] = v[c];
+        }
+    }
+
+    ///<summary>
+    /// Endpoints at the extremes of the points projected onto the axis.
+    ///</summary>
+    void AxisEndpoints( const float points[][4], const int count, const int channels,
+                        const float mean[4], const float axis[4], float e0[4], float e1[4] )
+    {
+        float lo = 0.0f;
+        float hi = 0.0f;
+
+        for ( int i = 0; i < count; ++i ) {
+            float t = 0.0f;
+            for ( int c = 0; c < channels; ++c ) {
+                t += ( points[i][c] - mean[c] ) * axis[c];
+            }
+            lo = std::min( lo, t );
+            hi = std::max( hi, t );
+        }
+
+        for ( int c = 0; c < 4; ++c ) {
+            e0[c] = mean[c] + axis[c] * lo;
+            e1[c] = mean[c] + axis[c] * hi;
+        }
+    }
+
+    ///<summary>
+    /// Least-squares endpoints for fixed interpolation weights: minimizes
+    /// sum |p_i - ((1 - w_i) e0 + w_i e1)|^2. Returns false if the weights
+    /// do not determine both endpoints.
+    ///</summary>
+    bool RefineEndpoints( const float points[][4], const float weights[], const int count, const int channels,
+                          float e0[4], float e1[4] )
+    {
+        float aa = 0.0f;
+        float ab = 0.0f;
+        float bb = 0.0f;
+        float ax[4] = { };
+        float bx[4] = { };
+
+        for ( int i = 0; i < count; ++i ) {
+            const float b = weights[i];
+            const float a = 1.0f - b;
+
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for ( int c = 0; c < channels; ++c ) {
+                ax[c] += a * points[i][c];
+                bx[c] += b * points[i][c];
+            }
+        }
+
+        const float det = aa * bb - ab * ab;
+        if ( std::fabs( det ) < 1e-6f ) {
+            return false;
+        }
+
+        const float inv = 1.0f / det;
+        for ( int c = 0; c < channels; ++c ) {
+            e0[c] = ( ax[c] * bb - bx[c] * ab ) * inv;
+            e1[c] = ( bx[c] * aa - ax[c] * ab ) * inv;
+        }
+
+        return true;
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+    // BC1
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    inline uint16_t Pack565( const float c[4] )
+    {
+        const int r = Clamp( Round( c[0] * 31.0f / 255.0f ), 0, 31 );
+        const int g = Clamp( Round( c[1] * 63.0f / 255.0f ), 0, 63 );
+        const int b = Clamp( Round( c[2] * 31.0f / 255.0f ), 0, 31 );
+
+        return static_cast<uint16_t>( ( r << 11 ) | ( g << 5 ) | b );
+    }
+
+    inline void Unpack565( const uint16_t v, int rgb[3] )
+    {
+        const int r = ( v >> 11 ) & 31;
+        const int g = ( v >> 5 ) & 63;
+        const int b = v & 31;
+
+        rgb[0] = ( r << 3 ) | ( r >> 2 );
+        rgb[1] = ( g << 2 ) | ( g >> 4 );
+        rgb[2] = ( b << 3 ) | ( b >> 2 );
+    }
+
+    // Palette as the decoder builds it. In three-color mode entry 3 is
+    // transparent black.
+    void BC1Palette( const uint16_t c0, const uint16_t c1, const bool threeColor, int palette[4][3] )
+    {
+        Unpack565( c0, palette[0] );
+        Unpack565( c1, palette[1] );
+
+        for ( int c = 0; c < 3; ++c ) {
+            if ( threeColor ) {
+                palette[2][c] = ( palette[0][c] + palette[1][c] ) / 2;
+                palette[3][c] = 0;
+            }
+            else {
+                palette[2][c] = ( 2 * palette[0][c] + palette[1][c] ) / 3;
+                palette[3][c] = ( palette[0][c] + 2 * palette[1][c] ) / 3;
+            }
+        }
+    }
+
+    ///<summary>
+    /// Picks the nearest palette entry for every opaque texel and returns the
+    /// total squared error. Transparent texels get index 3.
+    ///</summary>
+    float BC1SelectIndices( const uint8_t texels[64], const bool transparent[16],
+                            const uint16_t c0, const uint16_t c1, const bool threeColor, int indices[16] )
+    {
+        int palette[4][3];
+        BC1Palette( c0, c1, threeColor, palette );
+
+        const int choices = threeColor ? 3 : 4;
+        float total = 0.0f;
+
+        for ( int i = 0; i < 16; ++i ) {
+            if ( transparent[i] ) {
+                indices[i] = 3;
+                continue;
+            }
+
+            int best = 0;
+            int bestError = std::numeric_limits<int>::max();
+            for ( int k = 0; k < choices; ++k ) {
+                int error = 0;
+                for ( int c = 0; c < 3; ++c ) {
+                    const int d = texels[i * 4 + c] - palette[k][c];
+                    error += d * d;
+                }
+                if ( error < bestError ) {
+                    bestError = error;
+                    best = k;
+                }
+            }
+
+            indices[i] = best;
+            total += static_cast<float>( bestError );
+        }
+
+        return total;
+    }
+
+    void WriteBC1( uint16_t c0, uint16_t c1, int indices[16], const bool threeColor, uint8_t block[8] )
+    {
+        // The decoder tells the modes apart by the endpoint order: c0 > c1
+        // for four colors, c0 <= c1 for three.
+        if ( threeColor ? ( c0 > c1 ) : ( c0 < c1 ) ) {
+            std::swap( c0, c1 );
+            for ( int i = 0; i < 16; ++i ) {
+                if ( indices[i] < 2 ) {
+                    indices[i] ^= 1;
+                }
+                else if ( !threeColor ) {
+                    indices[i] ^= 1; // 2 <-> 3
+                }
+            }
+        }
+        else if ( !threeColor && c0 == c1 ) {
+            // Equal endpoints decode as three-color; index 0 is the color.
+            for ( int i = 0; i < 16; ++i ) {
+                indices[i] = 0;
+            }
+        }
+
+        uint32_t bits = 0;
+        for ( int i = 0; i < 16; ++i ) {
+            bits |= static_cast<uint32_t>( indices[i] ) << ( 2 * i );
+        }
+
+        block[0] = static_cast<uint8_t>( c0 & 0xff );
+        block[1] = static_cast<uint8_t>( c0 >> 8 );
+        block[2] = static_cast<uint8_t>( c1 & 0xff );
+        block[3] = static_cast<uint8_t>( c1 >> 8 );
+        for ( int i = 0; i < 4; ++i ) {
+            block[4 + i] = static_cast<uint8_t>( bits >> ( 8 * i ) );
+        }
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+    // BC4
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    void BC4Palette( const int a0, const int a1, int palette[8] )
+    {
+        palette[0] = a0;
+        palette[1] = a1;
+
+        if ( a0 > a1 ) {
+            for ( int k = 2; k < 8; ++k ) {
+                palette[k] = ( ( 8 - k ) * a0 + ( k - 1 ) * a1 + 3 ) / 7;
+            }
+        }
+        else {
+            for ( int k = 2; k < 6; ++k ) {
+                palette[k] = ( ( 6 - k ) * a0 + ( k - 1 ) * a1 + 2 ) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    int BC4SelectIndices( const uint8_t values[16], const int a0, const int a1, int indices[16] )
+    {
+        int palette[8];
+        BC4Palette( a0, a1, palette );
+
+        int total = 0;
+        for ( int i = 0; i < 16; ++i ) {
+            int best = 0;
+            int bestError = std::numeric_limits<int>::max();
+            for ( int k = 0; k < 8; ++k ) {
+                const int d = values[i] - palette[k];
+                if ( d * d < bestError ) {
+                    bestError = d * d;
+                    best = k;
+                }
+            }
+            indices[i] = best;
+            total += bestError;
+        }
+
+        return total;
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+    // BC7 mode 6
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    // 7-bit endpoints plus a shared low bit (p-bit) per endpoint.
+    struct BC7Endpoints {
+        int e[2][4];  // 7-bit values
+        int p[2];
+    };
+
+    inline int BC7Expand( const BC7Endpoints& ep, const int which, const int c )
+    {
+        return ( ep.e[which][c] << 1 ) | ep.p[which];
+    }
+
+    float BC7SelectIndices( const uint8_t texels[64], const BC7Endpoints& ep, int indices[16] )
+    {
+        int palette[16][4];
+        for ( int c = 0; c < 4; ++c ) {
+            const int a = BC7Expand( ep, 0, c );
+            const int b = BC7Expand( ep, 1, c );
+            for ( int k = 0; k < 16; ++k ) {
+                palette[k][c] = ( ( 64 - BC7Weights4[k] ) * a + BC7Weights4[k] * b + 32 ) >> 6;
+            }
+        }
+
+        float total = 0.0f;
+        for ( int i = 0; i < 16; ++i ) {
+            int best = 0;
+            int bestError = std::numeric_limits<int>::max();
+            for ( int k = 0; k < 16; ++k ) {
+                int error = 0;
+                for ( int c = 0; c < 4; ++c ) {
+                    const int d = texels[i * 4 + c] - palette[k][c];
+                    error += d * d;
+                }
+                if ( error < bestError ) {
+                    bestError = error;
+                    best = k;
+                }
+            }
+            indices[i] = best;
+            total += static_cast<float>( bestError );
+        }
+
+        return total;
+    }
+
+    ///<summary>
+    /// Quantizes float endpoints with each of the four p-bit combinations and
+    /// keeps the one with the lowest error.
+    ///</summary>
+    float BC7Quantize( const uint8_t texels[64], const float e0[4], const float e1[4],
+                       BC7Endpoints& best, int bestIndices[16] )
+    {
+        float bestError = std::numeric_limits<float>::max();
+
+        for ( int pbits = 0; pbits < 4; ++pbits ) {
+            BC7Endpoints ep;
+            ep.p[0] = pbits & 1;
+            ep.p[1] = pbits >> 1;
+
+            for ( int c = 0; c < 4; ++c ) {
+                ep.e[0][c] = Clamp( Round( ( e0[c] - ep.p[0] ) * 0.5f ), 0, 127 );
+                ep.e[1][c] = Clamp( Round( ( e1[c] - ep.p[1] ) * 0.5f ), 0, 127 );
+            }
+
+            int indices[16];
+            const float error = BC7SelectIndices( texels, ep, indices );
+            if ( error < bestError ) {
+                bestError = error;
+                best = ep;
+                std::copy( indices, indices + 16, bestIndices );
+            }
+        }
+
+        return bestError;
+    }
+
+    // Little-endian bit stream over a 16-byte block.
+    class BitWriter {
+    public:
+        explicit BitWriter( uint8_t* bytes ) : mBytes( bytes ), mPosition( 0 ) { std::memset( bytes, 0, 16 ); }
+
+        void Write( const uint32_t value, const int bits )
+        {
+            for ( int i = 0; i < bits; ++i, ++mPosition ) {
+                if ( ( value >> i ) & 1 ) {
+                    mBytes[mPosition >> 3] |= static_cast<uint8_t>( 1 << ( mPosition & 7 ) );
+                }
+            }
+        }
+
+    private:
+        uint8_t* mBytes;
+        int mPosition;
+    };
+
+    class BitReader {
+    public:
+        explicit BitReader( const uint8_t* bytes ) : mBytes( bytes ), mPosition( 0 ) { }
+
+        uint32_t Read( const int bits )
+        {
+            uint32_t value = 0;
+            for ( int i = 0; i < bits; ++i, ++mPosition ) {
+                value |= static_cast<uint32_t>( ( mBytes[mPosition >> 3] >> ( mPosition & 7 ) ) & 1 ) << i;
+            }
+            return value;
+        }
+
+    private:
+        const uint8_t* mBytes;
+        int mPosition;
+    };
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    // Gathers a 4x4 block, clamping coordinates to the surface.
+    void LoadBlock( const uint8_t* rgba, const unsigned int width, const unsigned int height, const size_t rowPitch,
+                    const unsigned int bx, const unsigned int by, uint8_t texels[64] )
+    {
+        for ( unsigned int y = 0; y < 4; ++y ) {
+            const unsigned int sy = std::min( by * 4 + y, height - 1 );
+            for ( unsigned int x = 0; x < 4; ++x ) {
+                const unsigned int sx = std::min( bx * 4 + x, width - 1 );
+                std::memcpy( texels + ( y * 4 + x ) * 4, rgba + sy * rowPitch + sx * 4, 4 );
+            }
+        }
+    }
+
+    void StoreBlock( const uint8_t texels[64], const unsigned int width, const unsigned int height, const size_t rowPitch,
+                     const unsigned int bx, const unsigned int by, uint8_t* rgba )
+    {
+        for ( unsigned int y = 0; y < 4 && by * 4 + y < height; ++y ) {
+            for ( unsigned int x = 0; x < 4 && bx * 4 + x < width; ++x ) {
+                std::memcpy( rgba + ( by * 4 + y ) * rowPitch + ( bx * 4 + x ) * 4, texels + ( y * 4 + x ) * 4, 4 );
+            }
+        }
+    }
+
+    void Channel( const uint8_t texels[64], const int channel, uint8_t values[16] )
+    {
+        for ( int i = 0; i < 16; ++i ) {
+            values[i] = texels[i * 4 + channel];
+        }
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t BlockCompressor::BlockBytes( const Format format )
+{
+    return format == BC1 ? 8 : 16;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t BlockCompressor::SurfaceBytes( const Format format, const unsigned int width, const unsigned int height )
+{
+    const size_t blocksWide = std::max( 1u, ( width + 3 ) / 4 );
+    const size_t blocksHigh = std::max( 1u, ( height + 3 ) / 4 );
+
+    return blocksWide * blocksHigh * BlockBytes( format );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void BlockCompressor::Compress( const Format format,
+                                const uint8_t* rgba,
+                                const unsigned int width,
+                                const unsigned int height,
+                                const size_t rowPitch,
+                                uint8_t* blocks )
+{
+    const unsigned int blocksWide = std::max( 1u, ( width + 3 ) / 4 );
+    const unsigned int blocksHigh = std::max( 1u, ( height + 3 ) / 4 );
+    const size_t blockBytes = BlockBytes( format );
+
+    JobSystem::Instance().ParallelFor( 0, blocksHigh, BlockRowsPerJob, [=]( size_t first, size_t last ) {
+        uint8_t texels[64];
+        uint8_t values[16];
+
+        for ( size_t by = first; by < last; ++by ) {
+            for ( unsigned int bx = 0; bx < blocksWide; ++bx ) {
+                LoadBlock( rgba, width, height, rowPitch, bx, static_cast<unsigned int>( by ), texels );
+                uint8_t* block = blocks + ( by * blocksWide + bx ) * blockBytes;
+
+                switch ( format ) {
+                case BC1:
+                    EncodeBC1Block( texels, true, block );
+                    break;
+
+                case BC3:
+                    Channel( texels, 3, values );
+                    EncodeBC4Block( values, block );
+                    EncodeBC1Block( texels, false, block + 8 );
+                    break;
+
+                case BC5:
+                    Channel( texels, 0, values );
+                    EncodeBC4Block( values, block );
+                    Channel( texels, 1, values );
+                    EncodeBC4Block( values, block + 8 );
+                    break;
+
+                case BC7:
+                    EncodeBC7Block( texels, block );
+                    break;
+                }
+            }
+        }
+    } );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void BlockCompressor::Decompress( const Format format,
+                                  const uint8_t* blocks,
+                                  const unsigned int width,
+                                  const unsigned int height,
+                                  uint8_t* rgba,
+                                  const size_t rowPitch )
+{
+    const unsigned int blocksWide = std::max( 1u, ( width + 3 ) / 4 );
+    const unsigned int blocksHigh = std::max( 1u, ( height + 3 ) / 4 );
+    const size_t blockBytes = BlockBytes( format );
+
+    for ( unsigned int by = 0; by < blocksHigh; ++by ) {
+        for ( unsigned int bx = 0; bx < blocksWide; ++bx ) {
+            const uint8_t* block = blocks + ( by * blocksWide + bx ) * blockBytes;
+            uint8_t texels[64];
+            uint8_t values[16];
+
+            switch ( format ) {
+            case BC1:
+                DecodeBC1Block( block, true, texels );
+                break;
+
+            case BC3:
+                DecodeBC1Block( block + 8, false, texels );
+                DecodeBC4Block( block, values );
+                for ( int i = 0; i < 16; ++i ) {
+                    texels[i * 4 + 3] = values[i];
+                }
+                break;
+
+            case BC5:
+                DecodeBC4Block( block, values );
+                for ( int i = 0; i < 16; ++i ) {
+                    texels[i * 4 + 0] = values[i];
+                    texels[i * 4 + 2] = 0;
+                    texels[i * 4 + 3] = 255;
+                }
+                DecodeBC4Block( block + 8, values );
+                for ( int i = 0; i < 16; ++i ) {
+                    texels[i * 4 + 1] = values[i];
+                }
+                break;
+
+            case BC7:
+                DecodeBC7Block( block, texels );
+                break;
+            }
+
+            StoreBlock( texels, width, height, rowPitch, bx, by, rgba );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void BlockCompressor::EncodeBC1Block( const uint8_t texels[64], const bool allowAlpha, uint8_t block[8] )
+{
+    bool transparent[16];
+    float points[16][4];
+    int count = 0;
+
+    for ( int i = 0; i < 16; ++i ) {
+        transparent[i] = allowAlpha && texels[i * 4 + 3] < 128;
+        if ( !transparent[i] ) {
+            for ( int c = 0; c < 3; ++c ) {
+                points[count][c] = texels[i * 4 + c];
+            }
+            points[count][3] = 0.0f;
+            ++count;
+        }
+    }
+
+    const bool threeColor = ( count < 16 );
+
+    int indices[16];
+    if ( count == 0 ) {
+        for ( int i = 0; i < 16; ++i ) {
+            indices[i] = 3;
+        }
+        WriteBC1( 0, 0, indices, true, block );
+        return;
+    }
+
+    float mean[4];
+    float axis[4];
+    float e0[4];
+    float e1[4];
+    PrincipalAxis( points, count, 3, mean, axis );
+    AxisEndpoints( points, count, 3, mean, axis, e0, e1 );
+
+    uint16_t best0 = Pack565( e0 );
+    uint16_t best1 = Pack565( e1 );
+    int bestIndices[16];
+    float bestError = BC1SelectIndices( texels, transparent, best0, best1, threeColor, bestIndices );
+
+    // Refit the endpoints to the chosen indices a couple of times.
+    const float fourColorWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    const float threeColorWeights[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+    const float* indexWeights = threeColor ? threeColorWeights : fourColorWeights;
+
+    for ( int iteration = 0; iteration < 2 && bestError > 0.0f; ++iteration ) {
+        float weights[16];
+        int n = 0;
+        for ( int i = 0; i < 16; ++i ) {
+            if ( !transparent[i] ) {
+                weights[n++] = indexWeights[bestIndices[i]];
+            }
+        }
+
+        if ( !RefineEndpoints( points, weights, count, 3, e0, e1 ) ) {
+            break;
+        }
+
+        const uint16_t c0 = Pack565( e0 );
+        const uint16_t c1 = Pack565( e1 );
+        int candidate[16];
+        const float error = BC1SelectIndices( texels, transparent, c0, c1, threeColor, candidate );
+        if ( error >= bestError ) {
+            break;
+        }
+
+        best0 = c0;
+        best1 = c1;
+        bestError = error;
+        std::copy( candidate, candidate + 16, bestIndices );
+    }
+
+    WriteBC1( best0, best1, bestIndices, threeColor, block );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void BlockCompressor::EncodeBC4Block( const uint8_t values[16], uint8_t block[8] )
+{
+    int lo = 255;
+    int hi = 0;
+    int innerLo = 255;
+    int innerHi = 0;
+
+    for ( int i = 0; i < 16; ++i ) {
+        lo = std::min( lo, static_cast<int>( values[i] ) );
+        hi = std::max( hi, static_cast<int>( values[i] ) );
+        if ( values[i] != 0 && values[i] != 255 ) {
+            innerLo = std::min( innerLo, static_cast<int>( values[i] ) );
+            innerHi = std::max( innerHi, static_cast<int>( values[i] ) );
+        }
+    }
+
+    int a0 = hi;
+    int a1 = lo;
+    int indices[16];
+    int error = BC4SelectIndices( values, a0, a1, indices );
+
+    // Six interpolated values plus exact 0 and 255, for blocks that hit the
+    // extremes (cut-out alpha, mostly).
+    if ( error > 0 && ( lo == 0 || hi == 255 ) ) {
+        const int b0 = ( innerLo <= innerHi ) ? innerLo : lo;
+        const int b1 = ( innerLo <= innerHi ) ? innerHi : lo;
+
+        int candidate[16];
+        const int candidateError = BC4SelectIndices( values, b0, b1, candidate );
+        if ( candidateError < error ) {
+            a0 = b0;
+            a1 = b1;
+            error = candidateError;
+            std::copy( candidate, candidate + 16, indices );
+        }
+    }
+
+    block[0] = static_cast<uint8_t>( a0 );
+    block[1] = static_cast<uint8_t>( a1 );
+
+    uint64_t bits = 0;
+    for ( int i = 0; i < 16; ++i ) {
+        bits |= static_cast<uint64_t>( indices[i] ) << ( 3 * i );
+    }
+    for ( int i = 0; i < 6; ++i ) {
+        block[2 + i] = static_cast<uint8_t>( bits >> ( 8 * i ) );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void BlockCompressor::EncodeBC7Block( const uint8_t texels[64], uint8_t block[16] )
+{
+    float points[16][4];
+    for ( int i = 0; i < 16; ++i ) {
+        for ( int c = 0; c < 4; ++c ) {
+            points[i][c] = texels[i * 4 + c];
+        }
+    }
+
+    float mean[4];
+    float axis[4];
+    float e0[4];
+    float e1[4];
+    PrincipalAxis( points, 16, 4, mean, axis );
+    AxisEndpoints( points, 16, 4, mean, axis, e0, e1 );
+
+    BC7Endpoints best;
+    int bestIndices[16];
+    float bestError = BC7Quantize( texels, e0, e1, best, bestIndices );
+
+    for ( int iteration = 0; iteration < 2 && bestError > 0.0f; ++iteration ) {
+        float weights[16];
+        for ( int i = 0; i < 16; ++i ) {
+            weights[i] = BC7Weights4[bestIndices[i]] / 64.0f;
+        }
+
+        if ( !RefineEndpoints( points, weights, 16, 4, e0, e1 ) ) {
+            break;
+        }
+
+        BC7Endpoints candidate;
+        int candidateIndices[16];
+        const float error = BC7Quantize( texels, e0, e1, candidate, candidateIndices );
+        if ( error >= bestError ) {
+            break;
+        }
+
+        best = candidate;
+        bestError = error;
+        std::copy( candidateIndices, candidateIndices + 16, bestIndices );
+    }
+
+    // The anchor (first) index is stored without its top bit, so it must be
+    // below 8; mirror the endpoints and indices if it is not.
+    if ( bestIndices[0] & 8 ) {
+        std::swap( best.e[0], best.e[1] );
+        std::swap( best.p[0], best.p[1] );
+        for ( int i = 0; i < 16; ++i ) {
+            bestIndices[i] = 15 - bestIndices[i];
+        }
+    }
+
+    BitWriter out( block );
+    out.Write( 1 << 6, 7 ); // Mode 6.
+
+    for ( int c = 0; c < 4; ++c ) {
+        out.Write( best.e[0][c], 7 );
+        out.Write( best.e[1][c], 7 );
+    }
+
+    out.Write( best.p[0], 1 );
+    out.Write( best.p[1], 1 );
+
+    out.Write( bestIndices[0], 3 );
+    for ( int i = 1; i < 16; ++i ) {
+        out.Write( bestIndices[i], 4 );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void BlockCompressor::DecodeBC1Block( const uint8_t block[8], const bool allowAlpha, uint8_t texels[64] )
+{
+    const uint16_t c0 = static_cast<uint16_t>( block[0] | ( block[1] << 8 ) );
+    const uint16_t c1 = static_cast<uint16_t>( block[2] | ( block[3] << 8 ) );
+
+    // BC2/BC3 color blocks are always four-color.
+    const bool threeColor = allowAlpha && c0 <= c1;
+
+    int palette[4][3];
+    BC1Palette( c0, c1, threeColor, palette );
+
+    const uint32_t bits = block[4] | ( block[5] << 8 ) | ( block[6] << 16 ) | ( static_cast<uint32_t>( block[7] ) << 24 );
+
+    for ( int i = 0; i < 16; ++i ) {
+        const int index = ( bits >> ( 2 * i ) ) & 3;
+        for ( int c = 0; c < 3; ++c ) {
+            texels[i * 4 + c] = static_cast<uint8_t>( palette[index][c] );
+        }
+        texels[i * 4 + 3] = ( threeColor && index == 3 ) ? 0 : 255;
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void BlockCompressor::DecodeBC4Block( const uint8_t block[8], uint8_t values[16] )
+{
+    int palette[8];
+    BC4Palette( block[0], block[1], palette );
+
+    uint64_t bits = 0;
+    for ( int i = 0; i < 6; ++i ) {
+        bits |= static_cast<uint64_t>( block[2 + i] ) << ( 8 * i );
+    }
+
+    for ( int i = 0; i < 16; ++i ) {
+        values[i] = static_cast<uint8_t>( palette[( bits >> ( 3 * i ) ) & 7] );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool BlockCompressor::DecodeBC7Block( const uint8_t block[16], uint8_t texels[64] )
+{
+    BitReader in( block );
+
+    if ( in.Read( 7 ) != ( 1 << 6 ) ) {
+        // Another mode; not produced by EncodeBC7Block(). Decode as magenta.
+        for ( int i = 0; i < 16; ++i ) {
+            texels[i * 4 + 0] = 255;
+            texels[i * 4 + 1] = 0;
+            texels[i * 4 + 2] = 255;
+            texels[i * 4 + 3] = 255;
+        }
+        return false;
+    }
+
+    BC7Endpoints ep;
+    for ( int c = 0; c < 4; ++c ) {
+        ep.e[0][c] = static_cast<int>( in.Read( 7 ) );
+        ep.e[1][c] = static_cast<int>( in.Read( 7 ) );
+    }
+    ep.p[0] = static_cast<int>( in.Read( 1 ) );
+    ep.p[1] = static_cast<int>( in.Read( 1 ) );
+
+    for ( int i = 0; i < 16; ++i ) {
+        const int index = static_cast<int>( in.Read( i == 0 ? 3 : 4 ) );
+        for ( int c = 0; c < 4; ++c ) {
+            const int a = BC7Expand( ep, 0, c );
+            const int b = BC7Expand( ep, 1, c );
+            texels[i * 4 + c] = static_cast<uint8_t>( ( ( 64 - BC7Weights4[index] ) * a + BC7Weights4[index] * b + 32 ) >> 6 );
+        }
+    }
+
+    return true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
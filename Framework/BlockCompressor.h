@@ -0,0 +1,76 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file BlockCompressor.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <cstddef>
+#include <cstdint>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// CPU encoder for the block-compressed formats the demos use, for the
+/// offline texture pipeline. Surfaces are split into 4x4 blocks and block
+/// rows are encoded in parallel on the job system.
+///
+///   BC1  rgb, 1-bit alpha          8 bytes per block
+///   BC3  rgb + interpolated alpha  16 bytes per block
+///   BC5  two channels (normals)    16 bytes per block
+///   BC7  rgba                      16 bytes per block
+///
+/// Color endpoints are fitted along the principal axis of the block and
+/// refined by least squares against the chosen indices. BC7 is encoded in
+/// mode 6 only (one subset, 7-bit endpoints with p-bits, 16 levels), which
+/// covers most game textures well; the partitioned modes are not searched.
+///
+/// The decoders exist to measure the encoders and decode exactly what they
+/// write, so DecodeBC7Block() only understands mode 6.
+///</summary>
+class BlockCompressor {
+public:
+
+    enum Format {
+        BC1,
+        BC3,
+        BC5,
+        BC7
+    };
+
+    static size_t BlockBytes( const Format format );
+
+    // Bytes of a width x height surface; partial blocks are padded.
+    static size_t SurfaceBytes( const Format format, const unsigned int width, const unsigned int height );
+
+    // Encodes an 8-bit RGBA surface into rows of blocks. Texels of partial
+    // edge blocks are clamped to the surface. BC5 encodes red and green.
+    static void Compress( const Format format,
+                          const uint8_t* rgba,
+                          const unsigned int width,
+                          const unsigned int height,
+                          const size_t rowPitch,
+                          uint8_t* blocks );
+
+    // The reverse of Compress(), for verification.
+    static void Decompress( const Format format,
+                            const uint8_t* blocks,
+                            const unsigned int width,
+                            const unsigned int height,
+                            uint8_t* rgba,
+                            const size_t rowPitch );
+
+    // Single blocks. texels are 16 RGBA8 texels in row order; values are 16
+    // single-channel texels.
+    static void EncodeBC1Block( const uint8_t texels[64], const bool allowAlpha, uint8_t block[8] );
+    static void EncodeBC4Block( const uint8_t values[16], uint8_t block[8] );
+    static void EncodeBC7Block( const uint8_t texels[64], uint8_t block[16] );
+
+    static void DecodeBC1Block( const uint8_t block[8], const bool allowAlpha, uint8_t texels[64] );
+    static void DecodeBC4Block( const uint8_t block[8], uint8_t values[16] );
+    static bool DecodeBC7Block( const uint8_t block[16], uint8_t texels[64] );
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
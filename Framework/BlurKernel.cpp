@@ -0,0 +1,150 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file BlurKernel.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "BlurKernel.h"
+
+#include <cassert>
+#include <cmath>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+int BlurKernel::RadiusForSigma( const float sigma )
+{
+    assert( sigma > 0.0f );
+
+    int radius = static_cast<int>( ceilf( 3.0f * sigma ) );
+    return radius < 1 ? 1 : radius;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+std::vector<float> BlurKernel::Gaussian( const float sigma, const int radius )
+{
+    assert( sigma > 0.0f );
+    assert( radius >= 0 );
+
+    const float twoSigma2 = 2.0f * sigma * sigma;
+
+    std::vector<float> weights( 2 * radius + 1 );
+    float sum = 0.0f;
+
+    // Evaluate one side and mirror it so the kernel is exactly symmetric.
+    for ( int i = 0; i <= radius; ++i ) {
+        const float x = static_cast<float>( i );
+        const float w = expf( -x * x / twoSigma2 );
+
+        weights[radius + i] = w;
+        weights[radius - i] = w;
+
+        sum += ( i == 0 ) ? w : 2.0f * w;
+    }
+
+    // Divide by the sum so all the weights add up to 1.0.
+    for ( auto& w : weights ) {
+        w /= sum;
+    }
+
+    return weights;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+std::vector<float> BlurKernel::Gaussian( const float sigma )
+{
+    return Gaussian( sigma, RadiusForSigma( sigma ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+std::vector<BlurKernel::Tap> BlurKernel::MergeLinearTaps( const std::vector<float>& weights )
+{
+    assert( weights.size() % 2 == 1 );
+
+    const int radius = static_cast<int>( weights.size() / 2 );
+
+    // Build the positive side; the negative side is its mirror.
+    std::vector<Tap> side;
+    for ( int i = 1; i <= radius; i += 2 ) {
+        const float w0 = weights[radius + i];
+
+        if ( i + 1 > radius ) {
+            // Odd tap left over at the edge of the kernel.
+            Tap t = { static_cast<float>( i ), w0 };
+            side.push_back( t );
+            break;
+        }
+
+        const float w1 = weights[radius + i + 1];
+        const float w = w0 + w1;
+
+        // Bilinear fetch at i + w1/w returns (w0*texel[i] + w1*texel[i+1]) / w.
+        Tap t = { ( w > 0.0f ) ? ( i * w0 + ( i + 1 ) * w1 ) / w : static_cast<float>( i ), w };
+        side.push_back( t );
+    }
+
+    std::vector<Tap> taps;
+    taps.reserve( 2 * side.size() + 1 );
+
+    for ( auto it = side.rbegin(); it != side.rend(); ++it ) {
+        Tap t = { -it->offset, it->weight };
+        taps.push_back( t );
+    }
+
+    Tap center = { 0.0f, weights[radius] };
+    taps.push_back( center );
+
+    taps.insert( taps.end(), side.begin(), side.end() );
+
+    return taps;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+std::vector<int> BlurKernel::BoxRadiiForGaussian( const float sigma, const int passes )
+{
+    assert( sigma > 0.0f );
+    assert( passes > 0 );
+
+    // A box of width w has variance (w^2 - 1)/12 and variances add, so pick
+    // the ideal width, round down to odd wl, then use the next odd width wu
+    // for as many passes as needed to make up the difference.
+    const float n = static_cast<float>( passes );
+    const float variance = 12.0f * sigma * sigma;
+
+    int wl = static_cast<int>( floorf( sqrtf( variance / n + 1.0f ) ) );
+    if ( wl % 2 == 0 ) {
+        --wl;
+    }
+    if ( wl < 1 ) {
+        wl = 1;
+    }
+    const int wu = wl + 2;
+
+    const float mIdeal = ( variance - n * wl * wl - 4.0f * n * wl - 3.0f * n ) / ( -4.0f * wl - 4.0f );
+    const int m = static_cast<int>( floorf( mIdeal + 0.5f ) );
+
+    std::vector<int> radii( passes );
+    for ( int i = 0; i < passes; ++i ) {
+        radii[i] = ( ( i < m ) ? wl : wu ) / 2;
+    }
+
+    return radii;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+std::vector<BlurKernel::Tap> BlurKernel::DiscreteTaps( const std::vector<float>& weights )
+{
+    const int radius = static_cast<int>( weights.size() / 2 );
+
+    std::vector<Tap> taps( weights.size() );
+    for ( int i = -radius; i <= radius; ++i ) {
+        taps[radius + i].offset = static_cast<float>( i );
+        taps[radius + i].weight = weights[radius + i];
+    }
+
+    return taps;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,60 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file BlurKernel.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <vector>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Generates 1D blur kernels for the separable blur passes. Kernels are
+/// stored as 2*radius + 1 weights with the center tap at index radius, and
+/// are always symmetric and normalized to sum to 1.
+///</summary>
+class BlurKernel {
+public:
+
+    // A single texture fetch: offset in texels from the center, and weight.
+    struct Tap {
+        float offset;
+        float weight;
+    };
+
+    // Smallest radius that keeps ~99.7% (3 sigma) of the Gaussian's mass.
+    static int RadiusForSigma( const float sigma );
+
+    // Returns 2*radius + 1 normalized Gaussian weights.
+    static std::vector<float> Gaussian( const float sigma, const int radius );
+
+    // Returns 2*radius + 1 normalized Gaussian weights, with the radius
+    // derived from sigma.
+    static std::vector<float> Gaussian( const float sigma );
+
+    ///<summary>
+    /// Merges each pair of adjacent taps on either side of the center into a
+    /// single tap placed between them, so that one bilinear fetch returns the
+    /// weighted sum of both texels. A kernel of radius r then needs
+    /// 1 + 2*ceil(r/2) fetches instead of 2r + 1. Only valid when the input is
+    /// sampled with a linear filter, and not for edge-aware (bilateral)
+    /// blurs, which must weigh each texel on its own.
+    ///</summary>
+    static std::vector<Tap> MergeLinearTaps( const std::vector<float>& weights );
+
+    ///<summary>
+    /// Radii of `passes` successive box blurs whose combined variance best
+    /// matches a Gaussian of the given sigma. Box widths are odd and differ by
+    /// at most 2, so three passes are already visually indistinguishable from
+    /// the Gaussian.
+    ///</summary>
+    static std::vector<int> BoxRadiiForGaussian( const float sigma, const int passes );
+
+    // Expands weights into unmerged taps at integer offsets.
+    static std::vector<Tap> DiscreteTaps( const std::vector<float>& weights );
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
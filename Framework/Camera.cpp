@@ -11,7 +11,10 @@ Camera::Camera()
 	: mPosition(0.0f, 0.0f, 0.0f), 
 	  mRight(1.0f, 0.0f, 0.0f),
 	  mUp(0.0f, 1.0f, 0.0f),
-	  mLook(0.0f, 0.0f, 1.0f)
+	  mLook(0.0f, 0.0f, 1.0f),
+	  mCameraRelative(false),
+	  mViewDirty(true),
+	  mVersion(0)
 {
 	SetLens(0.25f*MathHelper::Pi, 1.0f, 1.0f, 1000.0f);
 }
@@ -33,11 +36,61 @@ XMFLOAT3 Camera::GetPosition()const
 void Camera::SetPosition(float x, float y, float z)
 {
 	mPosition = XMFLOAT3(x, y, z);
+	mViewDirty = true;
 }
 
 void Camera::SetPosition(const XMFLOAT3& v)
 {
 	mPosition = v;
+	mViewDirty = true;
+}
+
+void Camera::SetCameraRelative(bool enable)
+{
+	if(enable == mCameraRelative)
+		return;
+
+	if(enable)
+	{
+		mOrigin = WorldPosition::FromDouble(mPosition.x, mPosition.y, mPosition.z);
+		mPosition = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	}
+	else
+	{
+		XMStoreFloat3(&mPosition, LargeWorld::RelativeTo(GetWorldPosition(), WorldPosition()));
+		mOrigin = WorldPosition();
+	}
+
+	mCameraRelative = enable;
+	mViewDirty = true;
+}
+
+bool Camera::IsCameraRelative()const
+{
+	return mCameraRelative;
+}
+
+WorldPosition Camera::GetWorldPosition()const
+{
+	if(mCameraRelative)
+		return mOrigin.Offset(XMLoadFloat3(&mPosition));
+
+	return WorldPosition::FromDouble(mPosition.x, mPosition.y, mPosition.z);
+}
+
+void Camera::SetWorldPosition(const WorldPosition& p)
+{
+	if(mCameraRelative)
+	{
+		mOrigin = p;
+		mPosition = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	}
+	else
+	{
+		XMStoreFloat3(&mPosition, LargeWorld::RelativeTo(p, WorldPosition()));
+	}
+
+	mViewDirty = true;
 }
 
 XMVECTOR Camera::GetRightXM()const
@@ -129,6 +182,11 @@ void Camera::SetLens(float fovY, float aspect, float zn, float zf)
 
 	XMMATRIX P = XMMatrixPerspectiveFovLH(mFovY, mAspect, mNearZ, mFarZ);
 	XMStoreFloat4x4(&mProj, P);
+
+	// Rebuild the view matrix too so the cached values stay consistent even if
+	// the camera moved since the last UpdateViewMatrix().
+	mViewDirty = true;
+	UpdateViewMatrix();
 }
 
 void Camera::LookAt(FXMVECTOR pos, FXMVECTOR target, FXMVECTOR worldUp)
@@ -141,6 +199,7 @@ void Camera::LookAt(FXMVECTOR pos, FXMVECTOR target, FXMVECTOR worldUp)
 	XMStoreFloat3(&mLook, L);
 	XMStoreFloat3(&mRight, R);
 	XMStoreFloat3(&mUp, U);
+	mViewDirty = true;
 }
 
 void Camera::LookAt(const XMFLOAT3& pos, const XMFLOAT3& target, const XMFLOAT3& up)
@@ -164,7 +223,27 @@ XMMATRIX Camera::Proj()const
 
 XMMATRIX Camera::ViewProj()const
 {
-	return XMMatrixMultiply(View(), Proj());
+	return XMLoadFloat4x4(&mViewProj);
+}
+
+XMMATRIX Camera::InvView()const
+{
+	return XMLoadFloat4x4(&mInvView);
+}
+
+const XMFLOAT4* Camera::GetFrustumPlanes()const
+{
+	return mFrustumPlanes;
+}
+
+const XMFLOAT3* Camera::GetFrustumCorners()const
+{
+	return mFrustumCorners;
+}
+
+UINT Camera::GetVersion()const
+{
+	return mVersion;
 }
 
 void Camera::Strafe(float d)
@@ -174,6 +253,7 @@ void Camera::Strafe(float d)
 	XMVECTOR r = XMLoadFloat3(&mRight);
 	XMVECTOR p = XMLoadFloat3(&mPosition);
 	XMStoreFloat3(&mPosition, XMVectorMultiplyAdd(s, r, p));
+	mViewDirty = true;
 }
 
 void Camera::Walk(float d)
@@ -183,6 +263,7 @@ void Camera::Walk(float d)
 	XMVECTOR l = XMLoadFloat3(&mLook);
 	XMVECTOR p = XMLoadFloat3(&mPosition);
 	XMStoreFloat3(&mPosition, XMVectorMultiplyAdd(s, l, p));
+	mViewDirty = true;
 }
 
 void Camera::Climb( float d )
@@ -192,6 +273,7 @@ void Camera::Climb( float d )
     XMVECTOR u = XMLoadFloat3( &XMFLOAT3( 0.f, 1.f, 0.f ) );
     XMVECTOR p = XMLoadFloat3( &mPosition );
     XMStoreFloat3( &mPosition, XMVectorMultiplyAdd( s, u, p ) );
+    mViewDirty = true;
 }
 
 void Camera::Pitch(float angle)
@@ -202,6 +284,7 @@ void Camera::Pitch(float angle)
 
 	XMStoreFloat3(&mUp,   XMVector3TransformNormal(XMLoadFloat3(&mUp), R));
 	XMStoreFloat3(&mLook, XMVector3TransformNormal(XMLoadFloat3(&mLook), R));
+	mViewDirty = true;
 }
 
 void Camera::RotateY(float angle)
@@ -213,10 +296,22 @@ void Camera::RotateY(float angle)
 	XMStoreFloat3(&mRight,   XMVector3TransformNormal(XMLoadFloat3(&mRight), R));
 	XMStoreFloat3(&mUp, XMVector3TransformNormal(XMLoadFloat3(&mUp), R));
 	XMStoreFloat3(&mLook, XMVector3TransformNormal(XMLoadFloat3(&mLook), R));
+	mViewDirty = true;
 }
 
 void Camera::UpdateViewMatrix()
 {
+	if(!mViewDirty)
+		return;
+
+	// Move the render origin to the camera, so the view has no translation
+	// and everything near the eye keeps full float precision.
+	if(mCameraRelative)
+	{
+		mOrigin = mOrigin.Offset(XMLoadFloat3(&mPosition));
+		mPosition = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	}
+
 	XMVECTOR R = XMLoadFloat3(&mRight);
 	XMVECTOR U = XMLoadFloat3(&mUp);
 	XMVECTOR L = XMLoadFloat3(&mLook);
@@ -263,6 +358,55 @@ void Camera::UpdateViewMatrix()
 	mView(1,3) = 0.0f;
 	mView(2,3) = 0.0f;
 	mView(3,3) = 1.0f;
+
+	mViewDirty = false;
+	UpdateDerived();
+}
+
+void Camera::UpdateDerived()
+{
+	XMMATRIX V = XMLoadFloat4x4(&mView);
+	XMMATRIX P = XMLoadFloat4x4(&mProj);
+	XMMATRIX VP = XMMatrixMultiply(V, P);
+	XMStoreFloat4x4(&mViewProj, VP);
+
+	// The camera basis is orthonormal, so the inverse view matrix is just the
+	// basis vectors and position as rows; no general inverse needed.
+	XMVECTOR R = XMLoadFloat3(&mRight);
+	XMVECTOR U = XMLoadFloat3(&mUp);
+	XMVECTOR L = XMLoadFloat3(&mLook);
+	XMVECTOR Pos = XMLoadFloat3(&mPosition);
+
+	XMMATRIX invView(
+		XMVectorSetW(R, 0.0f),
+		XMVectorSetW(U, 0.0f),
+		XMVectorSetW(L, 0.0f),
+		XMVectorSetW(Pos, 1.0f));
+	XMStoreFloat4x4(&mInvView, invView);
+
+	ExtractFrustumPlanes(mFrustumPlanes, VP);
+	for(int i = 0; i < 6; ++i)
+	{
+		XMStoreFloat4(&mFrustumPlanes[i], XMPlaneNormalize(XMLoadFloat4(&mFrustumPlanes[i])));
+	}
+
+	// Corners from the near/far window dimensions, offset along the camera basis.
+	const float z[2]  = { mNearZ, mFarZ };
+	const float hh[2] = { 0.5f*mNearWindowHeight, 0.5f*mFarWindowHeight };
+
+	for(int i = 0; i < 2; ++i)
+	{
+		XMVECTOR center = XMVectorMultiplyAdd(XMVectorReplicate(z[i]), L, Pos);
+		XMVECTOR up     = XMVectorScale(U, hh[i]);
+		XMVECTOR right  = XMVectorScale(R, mAspect*hh[i]);
+
+		XMStoreFloat3(&mFrustumCorners[4*i + 0], XMVectorSubtract(XMVectorSubtract(center, right), up));
+		XMStoreFloat3(&mFrustumCorners[4*i + 1], XMVectorAdd(XMVectorSubtract(center, right), up));
+		XMStoreFloat3(&mFrustumCorners[4*i + 2], XMVectorAdd(XMVectorAdd(center, right), up));
+		XMStoreFloat3(&mFrustumCorners[4*i + 3], XMVectorSubtract(XMVectorAdd(center, right), up));
+	}
+
+	++mVersion;
 }
 
 
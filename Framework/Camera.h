@@ -12,6 +12,7 @@
 #define CAMERA_H
 
 #include "d3dUtil.h"
+#include "LargeWorld.h"
 
 class Camera
 {
@@ -19,12 +20,21 @@ public:
 	Camera();
 	~Camera();
 
-	// Get/Set world camera position.
+	// Get/Set world camera position. In camera-relative mode these are relative
+	// to the render origin, which is the camera itself after UpdateViewMatrix().
     DirectX::XMVECTOR GetPositionXM()const;
     DirectX::XMFLOAT3 GetPosition()const;
 	void SetPosition(float x, float y, float z);
 	void SetPosition(const DirectX::XMFLOAT3& v);
 	
+	// Camera-relative mode for large worlds. The camera's world position is kept
+	// as a WorldPosition and the view matrix is built with the eye at the origin,
+	// so world matrices must be rebased against GetWorldPosition() (see LargeWorld).
+	void SetCameraRelative(bool enable);
+	bool IsCameraRelative()const;
+	WorldPosition GetWorldPosition()const;
+	void SetWorldPosition(const WorldPosition& p);
+	
 	// Get camera basis vectors.
     DirectX::XMVECTOR GetRightXM()const;
     DirectX::XMFLOAT3 GetRight()const;
@@ -57,6 +67,20 @@ public:
     DirectX::XMMATRIX View()const;
     DirectX::XMMATRIX Proj()const;
     DirectX::XMMATRIX ViewProj()const;
+    DirectX::XMMATRIX InvView()const;
+
+	// Frustum planes (left, right, bottom, top, near, far), normalized with
+	// normals pointing inside the frustum. World space, or relative to the
+	// render origin in camera-relative mode; test bounds rebased the same way.
+	const DirectX::XMFLOAT4* GetFrustumPlanes()const;
+
+	// Frustum corners, in the same space as the planes: near plane first, then
+	// far plane, each in the order bottom-left, top-left, top-right, bottom-right.
+	const DirectX::XMFLOAT3* GetFrustumCorners()const;
+
+	// Incremented whenever the cached matrices and frustum change, so callers
+	// can skip per-frame work while the camera is still.
+	UINT GetVersion()const;
 
 	// Strafe/Walk the camera a distance d.
 	void Strafe(float d);
@@ -68,10 +92,14 @@ public:
 	void RotateY(float angle);
 
 	// After modifying camera position/orientation, call to rebuild the view matrix.
+	// Does nothing if the camera has not moved since the last call.
 	void UpdateViewMatrix();
 
 private:
 
+	// Rebuilds everything derived from the view and projection matrices.
+	void UpdateDerived();
+
 	// Camera coordinate system with coordinates relative to world space.
     DirectX::XMFLOAT3 mPosition;
     DirectX::XMFLOAT3 mRight;
@@ -89,6 +117,20 @@ private:
 	// Cache View/Proj matrices.
     DirectX::XMFLOAT4X4 mView;
     DirectX::XMFLOAT4X4 mProj;
+
+	// Cache values derived from View/Proj.
+    DirectX::XMFLOAT4X4 mViewProj;
+    DirectX::XMFLOAT4X4 mInvView;
+    DirectX::XMFLOAT4 mFrustumPlanes[6];
+    DirectX::XMFLOAT3 mFrustumCorners[8];
+
+	// World position of the render origin in camera-relative mode.
+	WorldPosition mOrigin;
+	bool mCameraRelative;
+
+	// Set when the position or orientation changes, cleared by UpdateViewMatrix().
+	bool mViewDirty;
+	UINT mVersion;
 };
 
 #endif // CAMERA_H
\ No newline at end of file
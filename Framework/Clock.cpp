@@ -0,0 +1,160 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file Clock.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Clock.h"
+
+#include <Windows.h>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+// Windows 10 1803+; older SDKs do not define it and older systems reject it.
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const Clock& Clock::system( void )
+{
+    static const PerformanceClock clock;
+    return clock;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Clock::waitUntil( const int64_t ticks ) const
+{
+    while ( now() < ticks ) {
+        YieldProcessor();
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+PerformanceClock::PerformanceClock( void )
+: mFrequency( 0 )
+, mWaitTimer( nullptr )
+, mSpinTicks( 0 )
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency( &frequency );
+    mFrequency = frequency.QuadPart;
+
+    // A high resolution timer wakes within about half a millisecond; a
+    // regular one only on the next scheduler tick (up to 15.6 ms).
+    mWaitTimer = CreateWaitableTimerExW( nullptr,
+                                         nullptr,
+                                         CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                         TIMER_ALL_ACCESS );
+    double spinSeconds = 0.001;
+
+    if ( !mWaitTimer ) {
+        mWaitTimer = CreateWaitableTimerExW( nullptr, nullptr, 0, TIMER_ALL_ACCESS );
+        spinSeconds = 0.016;
+    }
+
+    mSpinTicks = static_cast<int64_t>( spinSeconds * mFrequency );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+PerformanceClock::~PerformanceClock( void )
+{
+    if ( mWaitTimer ) {
+        CloseHandle( mWaitTimer );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+int64_t PerformanceClock::now( void ) const
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter( &counter );
+    return counter.QuadPart;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+int64_t PerformanceClock::frequency( void ) const
+{
+    return mFrequency;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void PerformanceClock::waitUntil( const int64_t ticks ) const
+{
+    const int64_t remaining = ticks - now();
+    if ( remaining <= 0 ) {
+        return;
+    }
+
+    if ( mWaitTimer && remaining > mSpinTicks ) {
+        // Relative due times are negative, in 100 ns units.
+        LARGE_INTEGER due;
+        due.QuadPart = -( ( remaining - mSpinTicks ) * 10000000 / mFrequency );
+
+        if ( SetWaitableTimer( mWaitTimer, &due, 0, nullptr, nullptr, FALSE ) ) {
+            WaitForSingleObject( mWaitTimer, INFINITE );
+        }
+    }
+
+    Clock::waitUntil( ticks );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+MockClock::MockClock( const int64_t frequency )
+: mFrequency( frequency )
+, mTime( 0 )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+int64_t MockClock::now( void ) const
+{
+    return mTime;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+int64_t MockClock::frequency( void ) const
+{
+    return mFrequency;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void MockClock::waitUntil( const int64_t ticks ) const
+{
+    if ( ticks > mTime ) {
+        mTime = ticks;
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void MockClock::setTime( const int64_t ticks )
+{
+    mTime = ticks;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void MockClock::advance( const int64_t ticks )
+{
+    mTime += ticks;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void MockClock::advanceSeconds( const double seconds )
+{
+    mTime += static_cast<int64_t>( seconds * mFrequency );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,104 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file Clock.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <cstdint>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Source of high resolution timestamps. GameTimer and the Profiler read time
+/// through this interface, so they can be driven by something other than the
+/// hardware counter.
+///</summary>
+class Clock
+{
+
+public:
+
+    virtual ~Clock( void ) { }
+
+    // Current time in ticks.
+    virtual int64_t now( void ) const = 0;
+
+    // Ticks per second.
+    virtual int64_t frequency( void ) const = 0;
+
+    // Blocks until now() >= ticks. The default spins on now().
+    virtual void waitUntil( const int64_t ticks ) const;
+
+    // The process-wide PerformanceClock.
+    static const Clock& system( void );
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Clock backed by QueryPerformanceCounter.
+///
+/// waitUntil() sleeps on a waitable timer (high resolution where the OS
+/// supports it) and spins only for the last stretch, so a frame cap neither
+/// burns a core nor overshoots by a whole scheduler quantum like Sleep().
+///</summary>
+class PerformanceClock : public Clock
+{
+
+public:
+
+    PerformanceClock( void );
+    virtual ~PerformanceClock( void );
+
+    virtual int64_t now( void ) const override;
+    virtual int64_t frequency( void ) const override;
+    virtual void waitUntil( const int64_t ticks ) const override;
+
+private:
+
+    PerformanceClock( const PerformanceClock& rhs );
+    PerformanceClock& operator=( const PerformanceClock& rhs );
+
+    int64_t mFrequency;
+
+    void* mWaitTimer;
+
+    // How long before the deadline to stop sleeping and start spinning.
+    int64_t mSpinTicks;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Manually driven clock for tests. Time only moves through setTime(),
+/// advance() and waitUntil(), which jumps straight to the deadline.
+///</summary>
+class MockClock : public Clock
+{
+
+public:
+
+    explicit MockClock( const int64_t frequency = 1000000 );
+
+    virtual int64_t now( void ) const override;
+    virtual int64_t frequency( void ) const override;
+    virtual void waitUntil( const int64_t ticks ) const override;
+
+    void setTime( const int64_t ticks );
+    void advance( const int64_t ticks );
+    void advanceSeconds( const double seconds );
+
+private:
+
+    int64_t mFrequency;
+
+    // Mutable so that waitUntil() can move time like a real wait would.
+    mutable int64_t mTime;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,216 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file ConstantBuffers.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <DirectXMath.h>
+
+#include "LightHelper.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Where HLSL places a member of the given size that would start at offset:
+/// members are packed into 16-byte registers and may not straddle one, and
+/// arrays, structures and matrices always start a new register.
+///</summary>
+constexpr size_t HlslPackOffset( const size_t offset, const size_t size, const bool startsRegister )
+{
+    return ( startsRegister || offset % 16 + size > 16 ) ? ( offset + 15 ) / 16 * 16 : offset;
+}
+
+///<summary>
+/// A cbuffer member by name, where the mirror struct keeps it.
+///</summary>
+struct ConstantBufferMember {
+    const char* name;
+    size_t offset;
+    size_t size;
+};
+
+///<summary>
+/// The cbuffer a mirror struct stands for, to check it against the layout
+/// an effect was compiled with and to set its members one by one where it
+/// does not match.
+///</summary>
+struct ConstantBufferLayout {
+    const char* name;
+    size_t size;
+    const ConstantBufferMember* members;
+    size_t memberCount;
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// CPU copy of cbPerFrame in Basic.fx and the effects that share its
+/// lighting: three directional lights, the eye and the fog.
+///</summary>
+struct CBPerFrame {
+
+    CBPerFrame( void ) { std::memset( this, 0, sizeof( *this ) ); }
+
+    static const ConstantBufferLayout& Layout( void );
+
+    DirectionalLight DirLights[3];
+    DirectX::XMFLOAT3 EyePosW;
+    float FogStart;
+    float FogRange;
+    float Pad0[3];
+    DirectX::XMFLOAT4 FogColor;
+
+};
+
+static_assert( offsetof( CBPerFrame, EyePosW ) == HlslPackOffset( offsetof( CBPerFrame, DirLights ) + sizeof( CBPerFrame::DirLights ), 12, false ), "CBPerFrame::EyePosW misplaced" );
+static_assert( offsetof( CBPerFrame, FogStart ) == HlslPackOffset( offsetof( CBPerFrame, EyePosW ) + 12, 4, false ), "CBPerFrame::FogStart misplaced" );
+static_assert( offsetof( CBPerFrame, FogRange ) == HlslPackOffset( offsetof( CBPerFrame, FogStart ) + 4, 4, false ), "CBPerFrame::FogRange misplaced" );
+static_assert( offsetof( CBPerFrame, FogColor ) == HlslPackOffset( offsetof( CBPerFrame, FogRange ) + 4, 16, false ), "CBPerFrame::FogColor misplaced" );
+static_assert( sizeof( CBPerFrame ) == offsetof( CBPerFrame, FogColor ) + 16, "CBPerFrame has trailing bytes" );
+static_assert( sizeof( CBPerFrame ) == 240, "CBPerFrame does not match cbPerFrame" );
+
+inline const ConstantBufferLayout& CBPerFrame::Layout( void )
+{
+    static const ConstantBufferMember members[] = {
+        { "gDirLights", offsetof( CBPerFrame, DirLights ), sizeof( DirLights ) },
+        { "gEyePosW",   offsetof( CBPerFrame, EyePosW ),   12 },
+        { "gFogStart",  offsetof( CBPerFrame, FogStart ),  4 },
+        { "gFogRange",  offsetof( CBPerFrame, FogRange ),  4 },
+        { "gFogColor",  offsetof( CBPerFrame, FogColor ),  16 }
+    };
+    static const ConstantBufferLayout layout = {
+        "cbPerFrame", sizeof( CBPerFrame ), members, sizeof( members ) / sizeof( members[0] )
+    };
+    return layout;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// CPU copy of cbPerObject in Basic.fx. Matrices are kept transposed, the
+/// way HLSL stores them by default (column major); SetTransforms() takes
+/// them as the rest of the code builds them.
+///</summary>
+struct CBPerObject {
+
+    CBPerObject( void )
+    {
+        std::memset( this, 0, sizeof( *this ) );
+        DirectX::XMStoreFloat4x4( &TexTransform, DirectX::XMMatrixIdentity() );
+    }
+
+    static const ConstantBufferLayout& Layout( void );
+
+    // World, its inverse transpose for normals (ignoring translation) and
+    // world * viewProj.
+    void SetTransforms( DirectX::FXMMATRIX world, DirectX::CXMMATRIX viewProj )
+    {
+        using namespace DirectX;
+
+        XMMATRIX linear = world;
+        linear.r[3] = XMVectorSet( 0.f, 0.f, 0.f, 1.f );
+
+        XMStoreFloat4x4( &World, XMMatrixTranspose( world ) );
+        // The inverse transpose, stored transposed.
+        XMStoreFloat4x4( &WorldInvTranspose, XMMatrixInverse( nullptr, linear ) );
+        XMStoreFloat4x4( &WorldViewProj, XMMatrixTranspose( XMMatrixMultiply( world, viewProj ) ) );
+    }
+
+    void SetTexTransform( DirectX::FXMMATRIX texTransform )
+    {
+        DirectX::XMStoreFloat4x4( &TexTransform, DirectX::XMMatrixTranspose( texTransform ) );
+    }
+
+    DirectX::XMFLOAT4X4 World;
+    DirectX::XMFLOAT4X4 WorldInvTranspose;
+    DirectX::XMFLOAT4X4 WorldViewProj;
+    DirectX::XMFLOAT4X4 TexTransform;
+    Material Mat;
+
+};
+
+static_assert( offsetof( CBPerObject, WorldInvTranspose ) == HlslPackOffset( offsetof( CBPerObject, World ) + 64, 64, true ), "CBPerObject::WorldInvTranspose misplaced" );
+static_assert( offsetof( CBPerObject, WorldViewProj ) == HlslPackOffset( offsetof( CBPerObject, WorldInvTranspose ) + 64, 64, true ), "CBPerObject::WorldViewProj misplaced" );
+static_assert( offsetof( CBPerObject, TexTransform ) == HlslPackOffset( offsetof( CBPerObject, WorldViewProj ) + 64, 64, true ), "CBPerObject::TexTransform misplaced" );
+static_assert( offsetof( CBPerObject, Mat ) == HlslPackOffset( offsetof( CBPerObject, TexTransform ) + 64, sizeof( Material ), true ), "CBPerObject::Mat misplaced" );
+static_assert( sizeof( CBPerObject ) == 320, "CBPerObject does not match cbPerObject" );
+
+inline const ConstantBufferLayout& CBPerObject::Layout( void )
+{
+    static const ConstantBufferMember members[] = {
+        { "gWorld",             offsetof( CBPerObject, World ),             64 },
+        { "gWorldInvTranspose", offsetof( CBPerObject, WorldInvTranspose ), 64 },
+        { "gWorldViewProj",     offsetof( CBPerObject, WorldViewProj ),     64 },
+        { "gTexTransform",      offsetof( CBPerObject, TexTransform ),      64 },
+        { "gMaterial",          offsetof( CBPerObject, Mat ),               sizeof( Material ) }
+    };
+    static const ConstantBufferLayout layout = {
+        "cbPerObject", sizeof( CBPerObject ), members, sizeof( members ) / sizeof( members[0] )
+    };
+    return layout;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// CPU copy of a constant buffer with a version that changes whenever it
+/// is edited. Each place the data is uploaded to remembers the version it
+/// has, so however many setters run between two draws the data goes up at
+/// most once, and not at all if it did not change. Not thread safe; it
+/// belongs to the thread that draws.
+///</summary>
+template<typename T>
+class ConstantBufferMirror {
+public:
+
+    static_assert( sizeof( T ) % 16 == 0, "Constant buffers are made of 16-byte registers" );
+
+    ConstantBufferMirror( void ) : mVersion( 1 ) { }
+
+    const T& Get( void ) const { return mData; }
+
+    // Marks the data changed; write to it before the next Flush().
+    T& Edit( void )
+    {
+        ++mVersion;
+        return mData;
+    }
+
+    // Only marks the data changed if it is different.
+    void Set( const T& data )
+    {
+        if ( std::memcmp( &mData, &data, sizeof( T ) ) != 0 ) {
+            mData = data;
+            ++mVersion;
+        }
+    }
+
+    uint64_t GetVersion( void ) const { return mVersion; }
+
+    // Calls upload( data, size ) if uploaded is behind, and brings it up to
+    // date. uploaded starts at 0, which no mirror has.
+    template<typename Upload>
+    bool Flush( uint64_t& uploaded, Upload upload ) const
+    {
+        if ( uploaded == mVersion ) {
+            return false;
+        }
+        upload( static_cast<const void*>( &mData ), sizeof( T ) );
+        uploaded = mVersion;
+        return true;
+    }
+
+private:
+
+    T mData;
+    uint64_t mVersion;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,414 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file CpuBlur.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "CpuBlur.h"
+#include "BlurKernel.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    inline int ClampIndex( const int i, const int n )
+    {
+        return i < 0 ? 0 : ( i >= n ? n - 1 : i );
+    }
+
+    // Splits [0, count) into threadCount contiguous ranges and runs
+    // fn( begin, end ) on each through the shared job system; the calling
+    // thread takes part. One thread runs it all on the calling thread.
+    template<typename Fn>
+    void ParallelRange( const unsigned int count, unsigned int threadCount, Fn fn )
+    {
+        if ( threadCount == 0 ) {
+            threadCount = CpuBlur::DefaultThreadCount();
+        }
+        threadCount = std::min( threadCount, count );
+
+        if ( threadCount <= 1 ) {
+            fn( 0u, count );
+            return;
+        }
+
+        const unsigned int chunk = ( count + threadCount - 1 ) / threadCount;
+
+        JobSystem::Instance().ParallelFor( 0, count, chunk, [&]( size_t begin, size_t end ) {
+            fn( static_cast<unsigned int>( begin ), static_cast<unsigned int>( end ) );
+        } );
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    void SeparableRowH( const XMFLOAT4* in,
+                        XMFLOAT4* out,
+                        const int width,
+                        const float* weights,
+                        const int radius )
+    {
+        for ( int x = 0; x < width; ++x ) {
+            XMVECTOR acc = XMVectorZero();
+
+            if ( x >= radius && x + radius < width ) {
+                // Interior: no clamping needed.
+                const XMFLOAT4* p = in + x - radius;
+                for ( int k = 0; k <= 2 * radius; ++k ) {
+                    acc = XMVectorMultiplyAdd( XMVectorReplicate( weights[k] ), XMLoadFloat4( p + k ), acc );
+                }
+            }
+            else {
+                for ( int k = -radius; k <= radius; ++k ) {
+                    const XMFLOAT4* p = in + ClampIndex( x + k, width );
+                    acc = XMVectorMultiplyAdd( XMVectorReplicate( weights[k + radius] ), XMLoadFloat4( p ), acc );
+                }
+            }
+
+            XMStoreFloat4( out + x, acc );
+        }
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    void SeparableRowV( const CpuBlur::Image& in,
+                        XMFLOAT4* out,
+                        const int y,
+                        const float* weights,
+                        const int radius )
+    {
+        const int width = static_cast<int>( in.width );
+        const int height = static_cast<int>( in.height );
+
+        // Accumulate whole source rows so memory is read sequentially
+        // instead of walking down columns.
+        std::fill( out, out + width, XMFLOAT4( 0.0f, 0.0f, 0.0f, 0.0f ) );
+
+        for ( int k = -radius; k <= radius; ++k ) {
+            const XMFLOAT4* row = &in.texels[ClampIndex( y + k, height ) * width];
+            const XMVECTOR w = XMVectorReplicate( weights[k + radius] );
+
+            for ( int x = 0; x < width; ++x ) {
+                XMStoreFloat4( out + x, XMVectorMultiplyAdd( w, XMLoadFloat4( row + x ), XMLoadFloat4( out + x ) ) );
+            }
+        }
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    inline bool SameSurface( FXMVECTOR centerNormalDepth,
+                             FXMVECTOR neighborNormalDepth,
+                             const CpuBlur::BilateralParams& params )
+    {
+        const float nDotN = XMVectorGetX( XMVector3Dot( neighborNormalDepth, centerNormalDepth ) );
+        const float dz = fabsf( XMVectorGetW( neighborNormalDepth ) - XMVectorGetW( centerNormalDepth ) );
+
+        return nDotN >= params.normalThreshold && dz <= params.depthThreshold;
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    void BilateralRowH( const CpuBlur::Image& in,
+                        const CpuBlur::Image& normalDepth,
+                        XMFLOAT4* out,
+                        const int y,
+                        const float* weights,
+                        const int radius,
+                        const CpuBlur::BilateralParams& params )
+    {
+        const int width = static_cast<int>( in.width );
+        const XMFLOAT4* src = &in.texels[y * width];
+        const XMFLOAT4* nd = &normalDepth.texels[y * width];
+
+        for ( int x = 0; x < width; ++x ) {
+            const XMVECTOR center = XMLoadFloat4( nd + x );
+
+            // The center value always contributes to the sum.
+            XMVECTOR acc = XMVectorScale( XMLoadFloat4( src + x ), weights[radius] );
+            float total = weights[radius];
+
+            for ( int k = -radius; k <= radius; ++k ) {
+                if ( k == 0 ) {
+                    continue;
+                }
+
+                const int xi = ClampIndex( x + k, width );
+                if ( SameSurface( center, XMLoadFloat4( nd + xi ), params ) ) {
+                    const float w = weights[k + radius];
+                    acc = XMVectorMultiplyAdd( XMVectorReplicate( w ), XMLoadFloat4( src + xi ), acc );
+                    total += w;
+                }
+            }
+
+            XMStoreFloat4( out + x, XMVectorScale( acc, 1.0f / total ) );
+        }
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    void BilateralRowV( const CpuBlur::Image& in,
+                        const CpuBlur::Image& normalDepth,
+                        XMFLOAT4* out,
+                        std::vector<float>& totals,
+                        const int y,
+                        const float* weights,
+                        const int radius,
+                        const CpuBlur::BilateralParams& params )
+    {
+        const int width = static_cast<int>( in.width );
+        const int height = static_cast<int>( in.height );
+        const XMFLOAT4* centerND = &normalDepth.texels[y * width];
+
+        std::fill( out, out + width, XMFLOAT4( 0.0f, 0.0f, 0.0f, 0.0f ) );
+        std::fill( totals.begin(), totals.end(), 0.0f );
+
+        for ( int k = -radius; k <= radius; ++k ) {
+            const int sy = ClampIndex( y + k, height );
+            const XMFLOAT4* row = &in.texels[sy * width];
+            const XMFLOAT4* rowND = &normalDepth.texels[sy * width];
+            const float w = weights[k + radius];
+            const XMVECTOR wv = XMVectorReplicate( w );
+
+            for ( int x = 0; x < width; ++x ) {
+                if ( k == 0 || SameSurface( XMLoadFloat4( centerND + x ), XMLoadFloat4( rowND + x ), params ) ) {
+                    XMStoreFloat4( out + x, XMVectorMultiplyAdd( wv, XMLoadFloat4( row + x ), XMLoadFloat4( out + x ) ) );
+                    totals[x] += w;
+                }
+            }
+        }
+
+        for ( int x = 0; x < width; ++x ) {
+            XMStoreFloat4( out + x, XMVectorScale( XMLoadFloat4( out + x ), 1.0f / totals[x] ) );
+        }
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    // The box passes recompute their running sums from scratch every this
+    // many texels, so float error does not build up along long rows; the
+    // compute shader's tiles are the same length.
+    const int BoxResyncInterval = 256;
+
+    // Sum of the 2r + 1 texels of a row centered on x, clamped at the borders.
+    XMVECTOR BoxWindowH( const XMFLOAT4* in,
+                         const int x,
+                         const int last,
+                         const int radius )
+    {
+        XMVECTOR sum = XMVectorZero();
+        for ( int i = -radius; i <= radius; ++i ) {
+            sum = XMVectorAdd( sum, XMLoadFloat4( in + ClampIndex( x + i, last + 1 ) ) );
+        }
+        return sum;
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    void BoxRowH( const XMFLOAT4* in,
+                  XMFLOAT4* out,
+                  const int width,
+                  const int radius )
+    {
+        const int last = width - 1;
+        const float scale = 1.0f / static_cast<float>( 2 * radius + 1 );
+
+        XMVECTOR sum = XMVectorZero();
+        for ( int x = 0; x < width; ++x ) {
+            if ( x % BoxResyncInterval == 0 ) {
+                sum = BoxWindowH( in, x, last, radius );
+            }
+
+            XMStoreFloat4( out + x, XMVectorScale( sum, scale ) );
+
+            sum = XMVectorAdd( sum, XMLoadFloat4( in + std::min( x + radius + 1, last ) ) );
+            sum = XMVectorSubtract( sum, XMLoadFloat4( in + std::max( x - radius, 0 ) ) );
+        }
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    // Sets sums to the windows centered on row y of the columns [x0, x1).
+    void BoxWindowsV( const CpuBlur::Image& in,
+                      std::vector<XMFLOAT4>& sums,
+                      const int x0,
+                      const int x1,
+                      const int y,
+                      const int radius )
+    {
+        const int width = static_cast<int>( in.width );
+        const int height = static_cast<int>( in.height );
+        const int n = x1 - x0;
+
+        std::fill( sums.begin(), sums.begin() + n, XMFLOAT4( 0.0f, 0.0f, 0.0f, 0.0f ) );
+        for ( int i = -radius; i <= radius; ++i ) {
+            const XMFLOAT4* row = &in.texels[ClampIndex( y + i, height ) * width + x0];
+            for ( int x = 0; x < n; ++x ) {
+                XMStoreFloat4( &sums[x], XMVectorAdd( XMLoadFloat4( &sums[x] ), XMLoadFloat4( row + x ) ) );
+            }
+        }
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    // Slides a window down the columns [x0, x1), keeping one running sum per
+    // column so each step reads and writes whole row segments.
+    void BoxColumnsV( const CpuBlur::Image& in,
+                      CpuBlur::Image& out,
+                      std::vector<XMFLOAT4>& sums,
+                      const int x0,
+                      const int x1,
+                      const int radius )
+    {
+        const int width = static_cast<int>( in.width );
+        const int last = static_cast<int>( in.height ) - 1;
+        const float scale = 1.0f / static_cast<float>( 2 * radius + 1 );
+        const int n = x1 - x0;
+
+        for ( int y = 0; y <= last; ++y ) {
+            if ( y % BoxResyncInterval == 0 ) {
+                BoxWindowsV( in, sums, x0, x1, y, radius );
+            }
+
+            XMFLOAT4* dst = &out.texels[y * width + x0];
+            const XMFLOAT4* enter = &in.texels[std::min( y + radius + 1, last ) * width + x0];
+            const XMFLOAT4* leave = &in.texels[std::max( y - radius, 0 ) * width + x0];
+
+            for ( int x = 0; x < n; ++x ) {
+                XMVECTOR sum = XMLoadFloat4( &sums[x] );
+                XMStoreFloat4( dst + x, XMVectorScale( sum, scale ) );
+
+                sum = XMVectorAdd( sum, XMLoadFloat4( enter + x ) );
+                XMStoreFloat4( &sums[x], XMVectorSubtract( sum, XMLoadFloat4( leave + x ) ) );
+            }
+        }
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void CpuBlur::Separable( const Image& src,
+                         Image& dst,
+                         const std::vector<float>& weights,
+                         const unsigned int threadCount )
+{
+    assert( weights.size() % 2 == 1 );
+    assert( &src != &dst );
+
+    const int radius = static_cast<int>( weights.size() / 2 );
+    const int width = static_cast<int>( src.width );
+
+    Image tmp( src.width, src.height );
+    dst = Image( src.width, src.height );
+
+    ParallelRange( src.height, threadCount, [&]( unsigned int begin, unsigned int end ) {
+        for ( unsigned int y = begin; y < end; ++y ) {
+            SeparableRowH( &src.texels[y * width], &tmp.texels[y * width], width, weights.data(), radius );
+        }
+    } );
+
+    ParallelRange( src.height, threadCount, [&]( unsigned int begin, unsigned int end ) {
+        for ( unsigned int y = begin; y < end; ++y ) {
+            SeparableRowV( tmp, &dst.texels[y * width], static_cast<int>( y ), weights.data(), radius );
+        }
+    } );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void CpuBlur::Bilateral( const Image& src,
+                         const Image& normalDepth,
+                         Image& dst,
+                         const std::vector<float>& weights,
+                         const BilateralParams& params,
+                         const unsigned int threadCount )
+{
+    assert( weights.size() % 2 == 1 );
+    assert( src.width == normalDepth.width && src.height == normalDepth.height );
+    assert( &src != &dst );
+
+    const int radius = static_cast<int>( weights.size() / 2 );
+    const int width = static_cast<int>( src.width );
+
+    Image tmp( src.width, src.height );
+    dst = Image( src.width, src.height );
+
+    ParallelRange( src.height, threadCount, [&]( unsigned int begin, unsigned int end ) {
+        for ( unsigned int y = begin; y < end; ++y ) {
+            BilateralRowH( src, normalDepth, &tmp.texels[y * width], static_cast<int>( y ), weights.data(), radius, params );
+        }
+    } );
+
+    ParallelRange( src.height, threadCount, [&]( unsigned int begin, unsigned int end ) {
+        std::vector<float> totals( width );
+        for ( unsigned int y = begin; y < end; ++y ) {
+            BilateralRowV( tmp, normalDepth, &dst.texels[y * width], totals, static_cast<int>( y ), weights.data(), radius, params );
+        }
+    } );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void CpuBlur::Box( const Image& src,
+                   Image& dst,
+                   const int radius,
+                   const unsigned int threadCount )
+{
+    assert( radius >= 0 );
+    assert( &src != &dst );
+
+    const int width = static_cast<int>( src.width );
+
+    Image tmp( src.width, src.height );
+    dst = Image( src.width, src.height );
+
+    ParallelRange( src.height, threadCount, [&]( unsigned int begin, unsigned int end ) {
+        for ( unsigned int y = begin; y < end; ++y ) {
+            BoxRowH( &src.texels[y * width], &tmp.texels[y * width], width, radius );
+        }
+    } );
+
+    // The vertical pass is sequential down each column, so split the image
+    // into column strips instead of row ranges.
+    ParallelRange( src.width, threadCount, [&]( unsigned int begin, unsigned int end ) {
+        std::vector<XMFLOAT4> sums( end - begin );
+        BoxColumnsV( tmp, dst, sums, static_cast<int>( begin ), static_cast<int>( end ), radius );
+    } );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void CpuBlur::IteratedBox( const Image& src,
+                           Image& dst,
+                           const float sigma,
+                           const int passes,
+                           const unsigned int threadCount )
+{
+    const std::vector<int> radii = BlurKernel::BoxRadiiForGaussian( sigma, passes );
+
+    Image tmp;
+    const Image* in = &src;
+    for ( size_t i = 0; i < radii.size(); ++i ) {
+        Box( *in, dst, radii[i], threadCount );
+
+        std::swap( tmp, dst );
+        in = &tmp;
+    }
+
+    std::swap( tmp, dst );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+unsigned int CpuBlur::DefaultThreadCount( void )
+{
+    return JobSystem::Instance().GetWorkerCount() + 1;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,86 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file CpuBlur.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <DirectXMath.h>
+
+#include <vector>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// CPU implementation of the separable and box blurs in Blur.fx and
+/// SsaoBlur.fx.
+/// Texels are processed four channels at a time with DirectXMath and rows are
+/// split over the shared JobSystem. It does not depend on a device, so it can be
+/// used to verify the GPU passes headless or to blur images offline.
+/// Borders are clamped, matching the compute shader.
+///</summary>
+class CpuBlur {
+public:
+
+    // Tightly packed, row-major float4 image.
+    struct Image {
+        Image( void ) : width( 0 ), height( 0 ) { }
+        Image( const unsigned int w, const unsigned int h )
+            : width( w ), height( h ), texels( w * h ) { }
+
+        DirectX::XMFLOAT4& at( const unsigned int x, const unsigned int y ) { return texels[y * width + x]; }
+        const DirectX::XMFLOAT4& at( const unsigned int x, const unsigned int y ) const { return texels[y * width + x]; }
+
+        unsigned int width;
+        unsigned int height;
+        std::vector<DirectX::XMFLOAT4> texels;
+    };
+
+    // Edge-stopping thresholds, the same as SsaoBlur.fx. The normal-depth
+    // image stores the view space normal in xyz and view space depth in w.
+    struct BilateralParams {
+        BilateralParams( void ) : normalThreshold( 0.8f ), depthThreshold( 0.2f ) { }
+
+        float normalThreshold;
+        float depthThreshold;
+    };
+
+    // Horizontal then vertical pass with the given 2r+1 weights.
+    static void Separable( const Image& src,
+                           Image& dst,
+                           const std::vector<float>& weights,
+                           const unsigned int threadCount = 0 );
+
+    // Horizontal then vertical pass that discards neighbors across normal or
+    // depth discontinuities and renormalizes by the accepted weight.
+    static void Bilateral( const Image& src,
+                           const Image& normalDepth,
+                           Image& dst,
+                           const std::vector<float>& weights,
+                           const BilateralParams& params = BilateralParams(),
+                           const unsigned int threadCount = 0 );
+
+    // Horizontal then vertical sliding-window box blur of the given radius.
+    // Each pass keeps a running sum, recomputed every 256 texels to bound the
+    // float error, so the cost per pixel barely depends on the radius.
+    static void Box( const Image& src,
+                     Image& dst,
+                     const int radius,
+                     const unsigned int threadCount = 0 );
+
+    // Approximates a Gaussian of the given sigma with `passes` box blurs,
+    // see BlurKernel::BoxRadiiForGaussian.
+    static void IteratedBox( const Image& src,
+                             Image& dst,
+                             const float sigma,
+                             const int passes = 3,
+                             const unsigned int threadCount = 0 );
+
+    // Number of ranges work is split into when threadCount is 0: one per
+    // job system worker plus the calling thread.
+    static unsigned int DefaultThreadCount( void );
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -6,6 +6,8 @@
 
 #include <windowsx.h>
 
+#include <chrono>
+
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -40,6 +42,15 @@ D3DApp::D3DApp( HINSTANCE hInstance )
 , mResizing( false )
 , m4xMsaaQuality( 0 )
 , mTimer( )
+, mScheduler( )
+, mPipelined( false )
+, mPipeline( )
+, mUpdateThread( )
+, mUpdateRunning( false )
+, mUpdatePaused( false )
+, mPacketAlpha( )
+, mStatsFrameCount( 0 )
+, mStatsElapsedTime( 0.0f )
 , mD3DDevice( nullptr )
 , mD3DImmediateContext( nullptr )
 , mSwapChain( nullptr )
@@ -104,27 +115,187 @@ int D3DApp::run( void )
     MSG msg = { 0 };
 
     mTimer.reset();
+    mScheduler.reset();
+
+    if ( mPipelined ) {
+        mPipeline.reset();
+        mUpdatePaused = mPaused;
+        mUpdateRunning = true;
+        mUpdateThread = std::thread( &D3DApp::updateThreadMain, this );
+    }
 
     while ( msg.message != WM_QUIT ) {
         if ( PeekMessage( &msg, nullptr, 0, 0, PM_REMOVE ) ) {
             TranslateMessage( &msg );
             DispatchMessage( &msg );
         }
+        else if ( mPipelined ) {
+            runPipelinedFrame();
+        }
         else {
-            mTimer.tick();
+            runFrame();
+        }
+    }
 
-            if ( !mPaused ) {
-                calculateFrameStats();
-                updateScene( mTimer.deltaTime() );
-                drawScene();
-            }
-            else {
-                Sleep( 100 );
+    if ( mUpdateThread.joinable() ) {
+        mUpdateRunning = false;
+        mUpdateThread.join();
+    }
+
+    return static_cast<int>( msg.wParam );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DApp::runFrame( void )
+{
+    if ( !mPaused ) {
+        mScheduler.waitForNextFrame();
+    }
+
+    mTimer.tick();
+
+    if ( mPaused ) {
+        // Nothing to do until a message (e.g. reactivation) arrives.
+        WaitMessage();
+        return;
+    }
+
+    Profiler::instance().beginFrame();
+    {
+        PROFILE_ZONE( "updateScene" );
+
+        // The timer excludes paused time, so unpausing does not dump the
+        // whole pause into the accumulator.
+        const unsigned int steps = mScheduler.advance( mTimer.deltaTime() );
+        for ( unsigned int i = 0; i < steps; ++i ) {
+            updateScene( mScheduler.getStepTime() );
+        }
+
+        mPacketAlpha[getDrawSlot()] = mScheduler.getAlpha();
+        buildFramePacket( getDrawSlot() );
+    }
+    {
+        PROFILE_ZONE( "drawScene" );
+        drawScene();
+    }
+    Profiler::instance().endFrame();
+
+    calculateFrameStats();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DApp::runPipelinedFrame( void )
+{
+    mTimer.tick();
+    mUpdatePaused = mPaused;
+
+    if ( mPaused ) {
+        WaitMessage();
+        return;
+    }
+
+    // Short timeout to keep pumping messages while the update thread works.
+    if ( !mPipeline.waitForPacket( 10 ) ) {
+        return;
+    }
+
+    Profiler::instance().beginFrame();
+    {
+        PROFILE_ZONE( "drawScene" );
+        drawScene();
+    }
+    Profiler::instance().endFrame();
+
+    calculateFrameStats();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DApp::updateThreadMain( void )
+{
+    // The update thread keeps its own timer; mTimer is stopped and started by
+    // the window procedure on the main thread.
+    GameTimer timer;
+    timer.reset();
+
+    while ( mUpdateRunning ) {
+        if ( mUpdatePaused ) {
+            timer.stop();
+            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+            continue;
+        }
+        timer.start();
+
+        // Start the next packet once the renderer has taken the last one, so
+        // update runs exactly one frame ahead and never builds packets that
+        // would be dropped.
+        if ( !mPipeline.waitForConsumer( 10 ) ) {
+            continue;
+        }
+
+        mScheduler.waitForNextFrame();
+        timer.tick();
+
+        {
+            PROFILE_ZONE( "updateScene" );
+
+            const unsigned int steps = mScheduler.advance( timer.deltaTime() );
+            for ( unsigned int i = 0; i < steps; ++i ) {
+                updateScene( mScheduler.getStepTime() );
             }
+
+            mPacketAlpha[mPipeline.getWriteSlot()] = mScheduler.getAlpha();
+            buildFramePacket( mPipeline.getWriteSlot() );
         }
+
+        mPipeline.publish();
     }
+}
 
-    return static_cast<int>( msg.wParam );
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DApp::setFixedTimestep( const double seconds, const unsigned int maxStepsPerFrame )
+{
+    mScheduler.setFixedStep( seconds, maxStepsPerFrame );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DApp::setFrameCap( const double framesPerSecond )
+{
+    mScheduler.setFrameCap( framesPerSecond );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+float D3DApp::getInterpolationAlpha( const unsigned int slot ) const
+{
+    assert( slot < FramePipeline::SlotCount );
+    return mPacketAlpha[slot];
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DApp::setPipelined( const bool pipelined )
+{
+    assert( !mUpdateThread.joinable() );
+    mPipelined = pipelined;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool D3DApp::isPipelined( void ) const
+{
+    return mPipelined;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+unsigned int D3DApp::getDrawSlot( void ) const
+{
+    return mPipelined ? mPipeline.getReadSlot() : 0;
 }
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -300,6 +471,17 @@ LRESULT D3DApp::msgProc( HWND hwnd,
         case VK_END:
             PostQuitMessage( 0 );
             break;
+
+            // Start/stop a profiler capture, written next to the executable.
+        case VK_F9:
+            if ( Profiler::instance().isCapturing() ) {
+                Profiler::instance().endCapture();
+                Profiler::instance().writeChromeTrace( "profile.json" );
+            }
+            else {
+                Profiler::instance().beginCapture();
+            }
+            break;
         }
         return 0;
 
@@ -507,25 +689,30 @@ bool D3DApp::initDirect3D( void )
 
 void D3DApp::calculateFrameStats( void )
 {
-    static int frameCount = 0;
-    static float elapsedTime = 0.0f;
-
-    ++frameCount;
+    ++mStatsFrameCount;
 
-    // Get averages over one second period.
-    if ( ( mTimer.totalTime() - elapsedTime ) >= 1.0f ) {
-        float fps = static_cast<float>( frameCount );
+    // Get averages over one second period. The percentiles cover the
+    // profiler's frame history, so spikes show up even when the average
+    // looks fine.
+    if ( ( mTimer.totalTime() - mStatsElapsedTime ) >= 1.0f ) {
+        float fps = static_cast<float>( mStatsFrameCount );
         float mspf = 1000.0f / fps;
 
+        Profiler::FrameStats stats = Profiler::instance().getFrameStats();
+
         std::wostringstream oss;
-        oss.precision( 6 );
+        oss.precision( 4 );
         oss << mMainWindowCaption << L"    "
             << L"FPS: " << fps << L"    "
-            << L"Frame Time: " << mspf << L" (ms)";
+            << L"Frame Time: " << mspf << L" (ms)    "
+            << L"p50/p95/p99: " << stats.p50Ms << L"/" << stats.p95Ms << L"/" << stats.p99Ms << L" (ms)";
+        if ( Profiler::instance().isCapturing() ) {
+            oss << L"    [capturing]";
+        }
         SetWindowText( mMainWindow, oss.str().c_str() );
 
-        frameCount = 0;
-        elapsedTime += 1.0f;
+        mStatsFrameCount = 0;
+        mStatsElapsedTime += 1.0f;
     }
 }
 
@@ -7,7 +7,13 @@
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
 #include "D3DUtil.h"
+#include "FramePipeline.h"
+#include "FrameScheduler.h"
 #include "GameTimer.h"
+#include "Profiler.h"
+
+#include <atomic>
+#include <thread>
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
@@ -30,12 +36,41 @@
 
         int run( void );
 
+        // Runs updateScene() at a fixed rate (seconds per step) instead of
+        // once per frame; 0 restores the variable timestep. The last two
+        // simulation states can be blended with getInterpolationAlpha().
+        void setFixedTimestep( const double seconds, const unsigned int maxStepsPerFrame = 5 );
+
+        // Caps the frame rate without Sleep()'s coarse granularity; 0 disables.
+        void setFrameCap( const double framesPerSecond );
+
+        // Interpolation factor of the packet at slot, recorded when its
+        // update steps ran: buildFramePacket() passes its own slot and
+        // drawScene() getDrawSlot(). The scheduler itself belongs to the
+        // update thread while pipelined, so it is never read from here.
+        float getInterpolationAlpha( const unsigned int slot ) const;
+
+        // Runs updateScene() and buildFramePacket() on an update thread, one
+        // frame ahead of drawScene() on the main thread. Call before run().
+        //
+        // While pipelined, updateScene() must not touch the device context or
+        // anything the main thread writes (input, mTimer); buildFramePacket()
+        // writes everything drawScene() needs into the packet at its slot, and
+        // drawScene() reads only the packet at getDrawSlot().
+        void setPipelined( const bool pipelined );
+        bool isPipelined( void ) const;
+
         // Framework methods:
 
         virtual bool init( void );
         virtual void onResize( void );
         virtual void updateScene( const float dt ) = 0;
         virtual void drawScene( void ) = 0;
+
+        // Fills the frame packet at slot (0 to FramePipeline::SlotCount - 1)
+        // after the frame's update steps. Runs on the update thread when
+        // pipelined, and right before drawScene() otherwise.
+        virtual void buildFramePacket( const unsigned int slot ) { }
         virtual LRESULT msgProc( HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam );
 
         virtual void onMouseDown( WPARAM btnState, int x, int y ) { }
@@ -49,6 +84,13 @@
 
         void calculateFrameStats( void );
 
+        // Slot of the packet drawScene() should draw.
+        unsigned int getDrawSlot( void ) const;
+
+        void runFrame( void );
+        void runPipelinedFrame( void );
+        void updateThreadMain( void );
+
     protected:
 
         HINSTANCE mAppInstance;
@@ -57,6 +99,23 @@
         UINT m4xMsaaQuality;
 
         GameTimer mTimer;
+        FrameScheduler mScheduler;
+
+        // Pipelined mode. mScheduler belongs to the update thread while it
+        // runs.
+        bool mPipelined;
+        FramePipeline mPipeline;
+        std::thread mUpdateThread;
+        std::atomic<bool> mUpdateRunning;
+        std::atomic<bool> mUpdatePaused;
+
+        // getInterpolationAlpha() per packet slot; written with the packet
+        // and handed over by the same publish().
+        float mPacketAlpha[FramePipeline::SlotCount];
+
+        // Frame statistics shown in the caption, refreshed once a second.
+        int mStatsFrameCount;
+        float mStatsElapsedTime;
 
         // Direct3D:
 
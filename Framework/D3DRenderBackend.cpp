@@ -0,0 +1,89 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file D3DRenderBackend.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "D3DRenderBackend.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+D3DRenderBackend::D3DRenderBackend( ID3D11DeviceContext* context, const PrepareFunc& prepare )
+: mContext( context )
+, mPrepare( prepare )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DRenderBackend::SetTopology( const unsigned int topology )
+{
+    mContext->IASetPrimitiveTopology( static_cast<D3D11_PRIMITIVE_TOPOLOGY>( topology ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DRenderBackend::SetInputLayout( const void* layout )
+{
+    mContext->IASetInputLayout( Handle<ID3D11InputLayout>( layout ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DRenderBackend::SetVertexBuffer( const void* buffer, const unsigned int stride )
+{
+    ID3D11Buffer* vb = Handle<ID3D11Buffer>( buffer );
+    const UINT offset = 0;
+    mContext->IASetVertexBuffers( 0, 1, &vb, &stride, &offset );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DRenderBackend::SetInstanceBuffer( const void* buffer, const unsigned int stride )
+{
+    ID3D11Buffer* vb = Handle<ID3D11Buffer>( buffer );
+    const UINT offset = 0;
+    mContext->IASetVertexBuffers( 1, 1, &vb, &stride, &offset );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DRenderBackend::SetIndexBuffer( const void* buffer, const unsigned int format )
+{
+    mContext->IASetIndexBuffer( Handle<ID3D11Buffer>( buffer ), static_cast<DXGI_FORMAT>( format ), 0 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DRenderBackend::SetRasterizerState( const void* state )
+{
+    mContext->RSSetState( Handle<ID3D11RasterizerState>( state ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DRenderBackend::SetBlendState( const void* state )
+{
+    const float blendFactor[] = { 0.f, 0.f, 0.f, 0.f };
+    mContext->OMSetBlendState( Handle<ID3D11BlendState>( state ), blendFactor, 0xffffffff );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DRenderBackend::SetDepthStencilState( const void* state, const unsigned int stencilRef )
+{
+    mContext->OMSetDepthStencilState( Handle<ID3D11DepthStencilState>( state ), stencilRef );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void D3DRenderBackend::Draw( const RenderItem& item )
+{
+    mPrepare( mContext, item );
+    if ( item.instanceCount > 0 ) {
+        mContext->DrawIndexedInstanced( item.indexCount, item.instanceCount, item.startIndex, item.baseVertex, item.startInstance );
+    } else {
+        mContext->DrawIndexed( item.indexCount, item.startIndex, item.baseVertex );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,57 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file D3DRenderBackend.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <functional>
+
+#include "D3DUtil.h"
+#include "RenderQueue.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Issues a RenderQueue on a device context. The handles of each RenderItem
+/// are the D3D objects themselves; blending uses a zero blend factor and
+/// all samples, as the demos do.
+///
+/// Before each draw, prepare sets the per-object constants of item.object
+/// and applies pass item.pass of item.technique. Effects whose passes set
+/// rasterizer, blend or depth state themselves (Sky, BuildShadowMap) change
+/// state behind the queue's back; call RenderQueue::InvalidateState() after
+/// drawing with them outside of the queue, and do not queue them.
+///
+/// Instance data goes to input slot 1, next to the vertices in slot 0.
+///</summary>
+class D3DRenderBackend : public RenderBackend {
+public:
+
+    typedef std::function<void( ID3D11DeviceContext*, const RenderItem& )> PrepareFunc;
+
+    D3DRenderBackend( ID3D11DeviceContext* context, const PrepareFunc& prepare );
+
+    void SetTopology( const unsigned int topology ) override;
+    void SetInputLayout( const void* layout ) override;
+    void SetVertexBuffer( const void* buffer, const unsigned int stride ) override;
+    void SetInstanceBuffer( const void* buffer, const unsigned int stride ) override;
+    void SetIndexBuffer( const void* buffer, const unsigned int format ) override;
+    void SetRasterizerState( const void* state ) override;
+    void SetBlendState( const void* state ) override;
+    void SetDepthStencilState( const void* state, const unsigned int stencilRef ) override;
+    void Draw( const RenderItem& item ) override;
+
+private:
+
+    // Handles are stored const; D3D takes its objects non-const.
+    template<typename T>
+    static T* Handle( const void* handle ) { return static_cast<T*>( const_cast<void*>( handle ) ); }
+
+    ID3D11DeviceContext* mContext;
+    PrepareFunc mPrepare;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,72 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file D3DUtil.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "D3DUtil.h"
+#include "JobSystem.h"
+#include "TextureArrayBuilder.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+HRESULT TextureHelper::CreateTexture2DArraySRV( ID3D11Device* device,
+                                                const std::vector<std::wstring>& filenames,
+                                                ID3D11ShaderResourceView** srv )
+{
+    *srv = nullptr;
+
+    TextureArrayBuilder builder;
+    for ( auto& filename : filenames ) {
+        builder.AddFile( filename );
+    }
+
+    if ( builder.Build( &JobSystem::Instance() ) != TextureArrayBuilder::Ok ) {
+        return HRESULT_FROM_WIN32( ERROR_INVALID_DATA );
+    }
+
+    const std::vector<DDS::Subresource>& subresources = builder.GetSubresources();
+
+    std::vector<D3D11_SUBRESOURCE_DATA> initData( subresources.size() );
+    for ( size_t i = 0; i < subresources.size(); ++i ) {
+        initData[i].pSysMem = subresources[i].data;
+        initData[i].SysMemPitch = static_cast<UINT>( subresources[i].rowPitch );
+        initData[i].SysMemSlicePitch = static_cast<UINT>( subresources[i].slicePitch );
+    }
+
+    D3D11_TEXTURE2D_DESC arrayDesc;
+    arrayDesc.Width = static_cast<UINT>( builder.GetWidth() );
+    arrayDesc.Height = static_cast<UINT>( builder.GetHeight() );
+    arrayDesc.MipLevels = static_cast<UINT>( builder.GetMipLevels() );
+    arrayDesc.ArraySize = static_cast<UINT>( builder.GetArraySize() );
+    arrayDesc.Format = builder.GetFormat();
+    arrayDesc.SampleDesc.Count = 1;
+    arrayDesc.SampleDesc.Quality = 0;
+    arrayDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    arrayDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    arrayDesc.CPUAccessFlags = 0;
+    arrayDesc.MiscFlags = 0;
+
+    ID3D11Texture2D* texArray = nullptr;
+    HRESULT hr = device->CreateTexture2D( &arrayDesc, initData.data(), &texArray );
+    if ( FAILED( hr ) ) {
+        return hr;
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+    viewDesc.Format = arrayDesc.Format;
+    viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+    viewDesc.Texture2DArray.MostDetailedMip = 0;
+    viewDesc.Texture2DArray.MipLevels = arrayDesc.MipLevels;
+    viewDesc.Texture2DArray.FirstArraySlice = 0;
+    viewDesc.Texture2DArray.ArraySize = arrayDesc.ArraySize;
+
+    hr = device->CreateShaderResourceView( texArray, &viewDesc, srv );
+
+    // The view keeps the texture alive.
+    ReleaseCOM( texArray );
+
+    return hr;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
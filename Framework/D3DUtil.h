@@ -89,6 +89,19 @@ public:
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
+class TextureHelper {
+public:
+
+    // Creates a 2D texture array with one layer per DDS file, uploading every
+    // mip of every layer with the creation call. The files must agree in
+    // format, size and mip count; see TextureArrayBuilder.
+    static HRESULT CreateTexture2DArraySRV( ID3D11Device* device,
+                                            const std::vector<std::wstring>& filenames,
+                                            ID3D11ShaderResourceView** srv );
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
 static void ExtractFrustumPlanes( DirectX::XMFLOAT4 planes[6], DirectX::CXMMATRIX M )
 {
     //
@@ -0,0 +1,1109 @@
+//--------------------------------------------------------------------------------------
+// File: DDSParser.cpp
+//
+// Device-independent DDS parsing used by DDSTextureLoader
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include "DDSParser.h"
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace DirectX;
+
+//--------------------------------------------------------------------------------------
+// Direct3D 11 hardware limits (D3D11_REQ_*), repeated here so parsing needs no
+// Direct3D headers
+//--------------------------------------------------------------------------------------
+namespace
+{
+
+const size_t REQ_MIP_LEVELS                     = 15;
+const size_t REQ_TEXTURE1D_ARRAY_AXIS_DIMENSION = 2048;
+const size_t REQ_TEXTURE1D_U_DIMENSION          = 16384;
+const size_t REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION = 2048;
+const size_t REQ_TEXTURE2D_U_OR_V_DIMENSION     = 16384;
+const size_t REQ_TEXTURECUBE_DIMENSION          = 16384;
+const size_t REQ_TEXTURE3D_U_V_OR_W_DIMENSION   = 2048;
+
+const uint32_t RESOURCE_MISC_TEXTURECUBE        = 0x4L;
+
+};
+
+//--------------------------------------------------------------------------------------
+// Return the BPP for a particular format
+//--------------------------------------------------------------------------------------
+size_t DDS::BitsPerPixel( _In_ DXGI_FORMAT fmt )
+{
+    switch( fmt )
+    {
+    case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+    case DXGI_FORMAT_R32G32B32A32_SINT:
+        return 128;
+
+    case DXGI_FORMAT_R32G32B32_TYPELESS:
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+    case DXGI_FORMAT_R32G32B32_UINT:
+    case DXGI_FORMAT_R32G32B32_SINT:
+        return 96;
+
+    case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+    case DXGI_FORMAT_R16G16B16A16_SNORM:
+    case DXGI_FORMAT_R16G16B16A16_SINT:
+    case DXGI_FORMAT_R32G32_TYPELESS:
+    case DXGI_FORMAT_R32G32_FLOAT:
+    case DXGI_FORMAT_R32G32_UINT:
+    case DXGI_FORMAT_R32G32_SINT:
+    case DXGI_FORMAT_R32G8X24_TYPELESS:
+    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+    case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+    case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+    case DXGI_FORMAT_Y416:
+    case DXGI_FORMAT_Y210:
+    case DXGI_FORMAT_Y216:
+        return 64;
+
+    case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+    case DXGI_FORMAT_R10G10B10A2_UINT:
+    case DXGI_FORMAT_R11G11B10_FLOAT:
+    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_R8G8B8A8_UINT:
+    case DXGI_FORMAT_R8G8B8A8_SNORM:
+    case DXGI_FORMAT_R8G8B8A8_SINT:
+    case DXGI_FORMAT_R16G16_TYPELESS:
+    case DXGI_FORMAT_R16G16_FLOAT:
+    case DXGI_FORMAT_R16G16_UNORM:
+    case DXGI_FORMAT_R16G16_UINT:
+    case DXGI_FORMAT_R16G16_SNORM:
+    case DXGI_FORMAT_R16G16_SINT:
+    case DXGI_FORMAT_R32_TYPELESS:
+    case DXGI_FORMAT_D32_FLOAT:
+    case DXGI_FORMAT_R32_FLOAT:
+    case DXGI_FORMAT_R32_UINT:
+    case DXGI_FORMAT_R32_SINT:
+    case DXGI_FORMAT_R24G8_TYPELESS:
+    case DXGI_FORMAT_D24_UNORM_S8_UINT:
+    case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+    case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+    case DXGI_FORMAT_R8G8_B8G8_UNORM:
+    case DXGI_FORMAT_G8R8_G8B8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+    case DXGI_FORMAT_AYUV:
+    case DXGI_FORMAT_Y410:
+    case DXGI_FORMAT_YUY2:
+        return 32;
+
+    case DXGI_FORMAT_P010:
+    case DXGI_FORMAT_P016:
+        return 24;
+
+    case DXGI_FORMAT_R8G8_TYPELESS:
+    case DXGI_FORMAT_R8G8_UNORM:
+    case DXGI_FORMAT_R8G8_UINT:
+    case DXGI_FORMAT_R8G8_SNORM:
+    case DXGI_FORMAT_R8G8_SINT:
+    case DXGI_FORMAT_R16_TYPELESS:
+    case DXGI_FORMAT_R16_FLOAT:
+    case DXGI_FORMAT_D16_UNORM:
+    case DXGI_FORMAT_R16_UNORM:
+    case DXGI_FORMAT_R16_UINT:
+    case DXGI_FORMAT_R16_SNORM:
+    case DXGI_FORMAT_R16_SINT:
+    case DXGI_FORMAT_B5G6R5_UNORM:
+    case DXGI_FORMAT_B5G5R5A1_UNORM:
+    case DXGI_FORMAT_A8P8:
+    case DXGI_FORMAT_B4G4R4A4_UNORM:
+        return 16;
+
+    case DXGI_FORMAT_NV12:
+    case DXGI_FORMAT_420_OPAQUE:
+    case DXGI_FORMAT_NV11:
+        return 12;
+
+    case DXGI_FORMAT_R8_TYPELESS:
+    case DXGI_FORMAT_R8_UNORM:
+    case DXGI_FORMAT_R8_UINT:
+    case DXGI_FORMAT_R8_SNORM:
+    case DXGI_FORMAT_R8_SINT:
+    case DXGI_FORMAT_A8_UNORM:
+    case DXGI_FORMAT_AI44:
+    case DXGI_FORMAT_IA44:
+    case DXGI_FORMAT_P8:
+        return 8;
+
+    case DXGI_FORMAT_R1_UNORM:
+        return 1;
+
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+        return 4;
+
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return 8;
+
+    default:
+        return 0;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Get surface information for a particular format
+//--------------------------------------------------------------------------------------
+void DDS::GetSurfaceInfo( _In_ size_t width,
+                          _In_ size_t height,
+                          _In_ DXGI_FORMAT fmt,
+                          _Out_opt_ size_t* outNumBytes,
+                          _Out_opt_ size_t* outRowBytes,
+                          _Out_opt_ size_t* outNumRows )
+{
+    size_t numBytes = 0;
+    size_t rowBytes = 0;
+    size_t numRows = 0;
+
+    bool bc = false;
+    bool packed = false;
+    bool planar = false;
+    size_t bpe = 0;
+    switch (fmt)
+    {
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+        bc=true;
+        bpe = 8;
+        break;
+
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        bc = true;
+        bpe = 16;
+        break;
+
+    case DXGI_FORMAT_R8G8_B8G8_UNORM:
+    case DXGI_FORMAT_G8R8_G8B8_UNORM:
+    case DXGI_FORMAT_YUY2:
+        packed = true;
+        bpe = 4;
+        break;
+
+    case DXGI_FORMAT_Y210:
+    case DXGI_FORMAT_Y216:
+        packed = true;
+        bpe = 8;
+        break;
+
+    case DXGI_FORMAT_NV12:
+    case DXGI_FORMAT_420_OPAQUE:
+        planar = true;
+        bpe = 2;
+        break;
+
+    case DXGI_FORMAT_P010:
+    case DXGI_FORMAT_P016:
+        planar = true;
+        bpe = 4;
+        break;
+    }
+
+    if (bc)
+    {
+        size_t numBlocksWide = 0;
+        if (width > 0)
+        {
+            numBlocksWide = std::max<size_t>( 1, (width + 3) / 4 );
+        }
+        size_t numBlocksHigh = 0;
+        if (height > 0)
+        {
+            numBlocksHigh = std::max<size_t>( 1, (height + 3) / 4 );
+        }
+        rowBytes = numBlocksWide * bpe;
+        numRows = numBlocksHigh;
+        numBytes = rowBytes * numBlocksHigh;
+    }
+    else if (packed)
+    {
+        rowBytes = ( ( width + 1 ) >> 1 ) * bpe;
+        numRows = height;
+        numBytes = rowBytes * height;
+    }
+    else if ( fmt == DXGI_FORMAT_NV11 )
+    {
+        rowBytes = ( ( width + 3 ) >> 2 ) * 4;
+        numRows = height * 2; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
+        numBytes = rowBytes * numRows;
+    }
+    else if (planar)
+    {
+        rowBytes = ( ( width + 1 ) >> 1 ) * bpe;
+        numBytes = ( rowBytes * height ) + ( ( rowBytes * height + 1 ) >> 1 );
+        numRows = height + ( ( height + 1 ) >> 1 );
+    }
+    else
+    {
+        size_t bpp = BitsPerPixel( fmt );
+        rowBytes = ( width * bpp + 7 ) / 8; // round up to nearest byte
+        numRows = height;
+        numBytes = rowBytes * height;
+    }
+
+    if (outNumBytes)
+    {
+        *outNumBytes = numBytes;
+    }
+    if (outRowBytes)
+    {
+        *outRowBytes = rowBytes;
+    }
+    if (outNumRows)
+    {
+        *outNumRows = numRows;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+#define ISBITMASK( r,g,b,a ) ( ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a )
+
+DXGI_FORMAT DDS::GetDXGIFormat( const DDS_PIXELFORMAT& ddpf )
+{
+    if (ddpf.flags & DDS_RGB)
+    {
+        // Note that sRGB formats are written using the "DX10" extended header
+
+        switch (ddpf.RGBBitCount)
+        {
+        case 32:
+            if (ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0xff000000))
+            {
+                return DXGI_FORMAT_R8G8B8A8_UNORM;
+            }
+
+            if (ISBITMASK(0x00ff0000,0x0000ff00,0x000000ff,0xff000000))
+            {
+                return DXGI_FORMAT_B8G8R8A8_UNORM;
+            }
+
+            if (ISBITMASK(0x00ff0000,0x0000ff00,0x000000ff,0x00000000))
+            {
+                return DXGI_FORMAT_B8G8R8X8_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0x00000000) aka D3DFMT_X8B8G8R8
+
+            // Note that many common DDS reader/writers (including D3DX) swap the
+            // the RED/BLUE masks for 10:10:10:2 formats. We assume
+            // below that the 'backwards' header mask is being used since it is most
+            // likely written by D3DX. The more robust solution is to use the 'DX10'
+            // header extension and specify the DXGI_FORMAT_R10G10B10A2_UNORM format directly
+
+            // For 'correct' writers, this should be 0x000003ff,0x000ffc00,0x3ff00000 for RGB data
+            if (ISBITMASK(0x3ff00000,0x000ffc00,0x000003ff,0xc0000000))
+            {
+                return DXGI_FORMAT_R10G10B10A2_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x000003ff,0x000ffc00,0x3ff00000,0xc0000000) aka D3DFMT_A2R10G10B10
+
+            if (ISBITMASK(0x0000ffff,0xffff0000,0x00000000,0x00000000))
+            {
+                return DXGI_FORMAT_R16G16_UNORM;
+            }
+
+            if (ISBITMASK(0xffffffff,0x00000000,0x00000000,0x00000000))
+            {
+                // Only 32-bit color channel format in D3D9 was R32F
+                return DXGI_FORMAT_R32_FLOAT; // D3DX writes this out as a FourCC of 114
+            }
+            break;
+
+        case 24:
+            // No 24bpp DXGI formats aka D3DFMT_R8G8B8
+            break;
+
+        case 16:
+            if (ISBITMASK(0x7c00,0x03e0,0x001f,0x8000))
+            {
+                return DXGI_FORMAT_B5G5R5A1_UNORM;
+            }
+            if (ISBITMASK(0xf800,0x07e0,0x001f,0x0000))
+            {
+                return DXGI_FORMAT_B5G6R5_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x7c00,0x03e0,0x001f,0x0000) aka D3DFMT_X1R5G5B5
+
+            if (ISBITMASK(0x0f00,0x00f0,0x000f,0xf000))
+            {
+                return DXGI_FORMAT_B4G4R4A4_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x0f00,0x00f0,0x000f,0x0000) aka D3DFMT_X4R4G4B4
+
+            // No 3:3:2, 3:3:2:8, or paletted DXGI formats aka D3DFMT_A8R3G3B2, D3DFMT_R3G3B2, D3DFMT_P8, D3DFMT_A8P8, etc.
+            break;
+        }
+    }
+    else if (ddpf.flags & DDS_LUMINANCE)
+    {
+        if (8 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x000000ff,0x00000000,0x00000000,0x00000000))
+            {
+                return DXGI_FORMAT_R8_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+
+            // No DXGI format maps to ISBITMASK(0x0f,0x00,0x00,0xf0) aka D3DFMT_A4L4
+        }
+
+        if (16 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x0000ffff,0x00000000,0x00000000,0x00000000))
+            {
+                return DXGI_FORMAT_R16_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+            if (ISBITMASK(0x000000ff,0x00000000,0x00000000,0x0000ff00))
+            {
+                return DXGI_FORMAT_R8G8_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+        }
+    }
+    else if (ddpf.flags & DDS_ALPHA)
+    {
+        if (8 == ddpf.RGBBitCount)
+        {
+            return DXGI_FORMAT_A8_UNORM;
+        }
+    }
+    else if (ddpf.flags & DDS_BUMPDUDV)
+    {
+        if (16 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x00ff, 0xff00, 0x0000, 0x0000))
+            {
+                return DXGI_FORMAT_R8G8_SNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+        }
+
+        if (32 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+            {
+                return DXGI_FORMAT_R8G8B8A8_SNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+            if (ISBITMASK(0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
+            {
+                return DXGI_FORMAT_R16G16_SNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+
+            // No DXGI format maps to ISBITMASK(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000) aka D3DFMT_A2W10V10U10
+        }
+    }
+    else if (ddpf.flags & DDS_FOURCC)
+    {
+        if (MAKEFOURCC( 'D', 'X', 'T', '1' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC1_UNORM;
+        }
+        if (MAKEFOURCC( 'D', 'X', 'T', '3' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC2_UNORM;
+        }
+        if (MAKEFOURCC( 'D', 'X', 'T', '5' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC3_UNORM;
+        }
+
+        // While pre-multiplied alpha isn't directly supported by the DXGI formats,
+        // they are basically the same as these BC formats so they can be mapped
+        if (MAKEFOURCC( 'D', 'X', 'T', '2' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC2_UNORM;
+        }
+        if (MAKEFOURCC( 'D', 'X', 'T', '4' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC3_UNORM;
+        }
+
+        if (MAKEFOURCC( 'A', 'T', 'I', '1' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC4_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '4', 'U' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC4_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '4', 'S' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC4_SNORM;
+        }
+
+        if (MAKEFOURCC( 'A', 'T', 'I', '2' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC5_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '5', 'U' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC5_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '5', 'S' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC5_SNORM;
+        }
+
+        // BC6H and BC7 are written using the "DX10" extended header
+
+        if (MAKEFOURCC( 'R', 'G', 'B', 'G' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_R8G8_B8G8_UNORM;
+        }
+        if (MAKEFOURCC( 'G', 'R', 'G', 'B' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_G8R8_G8B8_UNORM;
+        }
+
+        if (MAKEFOURCC('Y','U','Y','2') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_YUY2;
+        }
+
+        // Check for D3DFORMAT enums being set here
+        switch( ddpf.fourCC )
+        {
+        case 36: // D3DFMT_A16B16G16R16
+            return DXGI_FORMAT_R16G16B16A16_UNORM;
+
+        case 110: // D3DFMT_Q16W16V16U16
+            return DXGI_FORMAT_R16G16B16A16_SNORM;
+
+        case 111: // D3DFMT_R16F
+            return DXGI_FORMAT_R16_FLOAT;
+
+        case 112: // D3DFMT_G16R16F
+            return DXGI_FORMAT_R16G16_FLOAT;
+
+        case 113: // D3DFMT_A16B16G16R16F
+            return DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+        case 114: // D3DFMT_R32F
+            return DXGI_FORMAT_R32_FLOAT;
+
+        case 115: // D3DFMT_G32R32F
+            return DXGI_FORMAT_R32G32_FLOAT;
+
+        case 116: // D3DFMT_A32B32G32R32F
+            return DXGI_FORMAT_R32G32B32A32_FLOAT;
+        }
+    }
+
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+
+//--------------------------------------------------------------------------------------
+DXGI_FORMAT DDS::MakeSRGB( _In_ DXGI_FORMAT format )
+{
+    switch( format )
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+        return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC1_UNORM:
+        return DXGI_FORMAT_BC1_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC2_UNORM:
+        return DXGI_FORMAT_BC2_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC3_UNORM:
+        return DXGI_FORMAT_BC3_UNORM_SRGB;
+
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+        return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+        return DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC7_UNORM:
+        return DXGI_FORMAT_BC7_UNORM_SRGB;
+
+    default:
+        return format;
+    }
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+DDS::Result DDS::ParseHeader( const uint8_t* ddsData,
+                              size_t ddsDataSize,
+                              TextureInfo& info )
+{
+    memset( &info, 0, sizeof( info ) );
+
+    if ( !ddsData )
+    {
+        return Result::Fail;
+    }
+
+    // Need at least enough data to fill the header and magic number to be a valid DDS
+    if (ddsDataSize < (sizeof(uint32_t) + sizeof(DDS_HEADER)))
+    {
+        return Result::Fail;
+    }
+
+    // DDS files always start with the same magic number ("DDS ")
+    uint32_t dwMagicNumber = 0;
+    memcpy( &dwMagicNumber, ddsData, sizeof( uint32_t ) );
+    if (dwMagicNumber != DDS_MAGIC)
+    {
+        return Result::Fail;
+    }
+
+    auto header = reinterpret_cast<const DDS_HEADER*>( ddsData + sizeof( uint32_t ) );
+
+    // Verify header to validate DDS file
+    if (header->size != sizeof(DDS_HEADER) ||
+        header->ddspf.size != sizeof(DDS_PIXELFORMAT))
+    {
+        return Result::Fail;
+    }
+
+    // Check for DX10 extension
+    bool bDXT10Header = false;
+    if ((header->ddspf.flags & DDS_FOURCC) &&
+        (MAKEFOURCC( 'D', 'X', '1', '0' ) == header->ddspf.fourCC) )
+    {
+        // Must be long enough for both headers and magic value
+        if (ddsDataSize < (sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10)))
+        {
+            return Result::Fail;
+        }
+
+        bDXT10Header = true;
+    }
+
+    size_t offset = sizeof( uint32_t )
+                    + sizeof( DDS_HEADER )
+                    + (bDXT10Header ? sizeof( DDS_HEADER_DXT10 ) : 0);
+
+    size_t width = header->width;
+    size_t height = header->height;
+    size_t depth = header->depth;
+
+    uint32_t resDim = RESOURCE_DIMENSION_UNKNOWN;
+    size_t arraySize = 1;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    bool isCubeMap = false;
+
+    size_t mipCount = header->mipMapCount;
+    if (0 == mipCount)
+    {
+        mipCount = 1;
+    }
+
+    if (bDXT10Header)
+    {
+        auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>( (const char*)header + sizeof(DDS_HEADER) );
+
+        arraySize = d3d10ext->arraySize;
+        if (arraySize == 0)
+        {
+           return Result::InvalidData;
+        }
+
+        switch( d3d10ext->dxgiFormat )
+        {
+        case DXGI_FORMAT_AI44:
+        case DXGI_FORMAT_IA44:
+        case DXGI_FORMAT_P8:
+        case DXGI_FORMAT_A8P8:
+            return Result::NotSupported;
+
+        default:
+            if ( BitsPerPixel( d3d10ext->dxgiFormat ) == 0 )
+            {
+                return Result::NotSupported;
+            }
+        }
+
+        format = d3d10ext->dxgiFormat;
+
+        switch ( d3d10ext->resourceDimension )
+        {
+        case RESOURCE_DIMENSION_TEXTURE1D:
+            // D3DX writes 1D textures with a fixed Height of 1
+            if ((header->flags & DDS_HEIGHT) && height != 1)
+            {
+                return Result::InvalidData;
+            }
+            height = depth = 1;
+            break;
+
+        case RESOURCE_DIMENSION_TEXTURE2D:
+            if (d3d10ext->miscFlag & RESOURCE_MISC_TEXTURECUBE)
+            {
+                arraySize *= 6;
+                isCubeMap = true;
+            }
+            depth = 1;
+            break;
+
+        case RESOURCE_DIMENSION_TEXTURE3D:
+            if (!(header->flags & DDS_HEADER_FLAGS_VOLUME))
+            {
+                return Result::InvalidData;
+            }
+
+            if (arraySize > 1)
+            {
+                return Result::NotSupported;
+            }
+            break;
+
+        default:
+            return Result::NotSupported;
+        }
+
+        resDim = d3d10ext->resourceDimension;
+    }
+    else
+    {
+        format = GetDXGIFormat( header->ddspf );
+
+        if (format == DXGI_FORMAT_UNKNOWN)
+        {
+           return Result::NotSupported;
+        }
+
+        if (header->flags & DDS_HEADER_FLAGS_VOLUME)
+        {
+            resDim = RESOURCE_DIMENSION_TEXTURE3D;
+        }
+        else
+        {
+            if (header->caps2 & DDS_CUBEMAP)
+            {
+                // We require all six faces to be defined
+                if ((header->caps2 & DDS_CUBEMAP_ALLFACES ) != DDS_CUBEMAP_ALLFACES)
+                {
+                    return Result::NotSupported;
+                }
+
+                arraySize = 6;
+                isCubeMap = true;
+            }
+
+            depth = 1;
+            resDim = RESOURCE_DIMENSION_TEXTURE2D;
+
+            // Note there's no way for a legacy Direct3D 9 DDS to express a '1D' texture
+        }
+
+        assert( BitsPerPixel( format ) != 0 );
+    }
+
+    // An empty dimension would give subresources of zero bytes pointing anywhere in the file
+    if (!width || !height || !depth)
+    {
+        return Result::InvalidData;
+    }
+
+    // Bound sizes (for security purposes we don't trust DDS file metadata larger than the D3D 11.x hardware requirements)
+    if (mipCount > REQ_MIP_LEVELS)
+    {
+        return Result::NotSupported;
+    }
+
+    switch ( resDim )
+    {
+    case RESOURCE_DIMENSION_TEXTURE1D:
+        if ((arraySize > REQ_TEXTURE1D_ARRAY_AXIS_DIMENSION) ||
+            (width > REQ_TEXTURE1D_U_DIMENSION) )
+        {
+            return Result::NotSupported;
+        }
+        break;
+
+    case RESOURCE_DIMENSION_TEXTURE2D:
+        if ( isCubeMap )
+        {
+            // This is the right bound because we set arraySize to (NumCubes*6) above
+            if ((arraySize > REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) ||
+                (width > REQ_TEXTURECUBE_DIMENSION) ||
+                (height > REQ_TEXTURECUBE_DIMENSION))
+            {
+                return Result::NotSupported;
+            }
+        }
+        else if ((arraySize > REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) ||
+                    (width > REQ_TEXTURE2D_U_OR_V_DIMENSION) ||
+                    (height > REQ_TEXTURE2D_U_OR_V_DIMENSION))
+        {
+            return Result::NotSupported;
+        }
+        break;
+
+    case RESOURCE_DIMENSION_TEXTURE3D:
+        if ((arraySize > 1) ||
+            (width > REQ_TEXTURE3D_U_V_OR_W_DIMENSION) ||
+            (height > REQ_TEXTURE3D_U_V_OR_W_DIMENSION) ||
+            (depth > REQ_TEXTURE3D_U_V_OR_W_DIMENSION) )
+        {
+            return Result::NotSupported;
+        }
+        break;
+
+    default:
+        return Result::NotSupported;
+    }
+
+    info.header = header;
+    info.bitData = ddsData + offset;
+    info.bitSize = ddsDataSize - offset;
+    info.resDim = resDim;
+    info.width = width;
+    info.height = height;
+    info.depth = depth;
+    info.mipCount = mipCount;
+    info.arraySize = arraySize;
+    info.format = format;
+    info.isCubeMap = isCubeMap;
+
+    return Result::Ok;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+DDS::Result DDS::EnumerateSubresources( const TextureInfo& info,
+                                        size_t maxsize,
+                                        std::vector<Subresource>& subresources,
+                                        size_t* skipMip )
+{
+    subresources.clear();
+    subresources.reserve( info.mipCount * info.arraySize );
+
+    if ( skipMip )
+    {
+        *skipMip = 0;
+    }
+
+    if ( !info.bitData && info.bitSize )
+    {
+        return Result::Fail;
+    }
+
+    size_t NumBytes = 0;
+    size_t RowBytes = 0;
+    size_t offset = 0;
+
+    for( size_t j = 0; j < info.arraySize; j++ )
+    {
+        size_t w = info.width;
+        size_t h = info.height;
+        size_t d = info.depth;
+        for( size_t i = 0; i < info.mipCount; i++ )
+        {
+            GetSurfaceInfo( w,
+                            h,
+                            info.format,
+                            &NumBytes,
+                            &RowBytes,
+                            nullptr
+                          );
+
+            // Compare against what is left rather than forming a pointer past the end,
+            // and in 64 bits so that a large volume cannot wrap on 32-bit builds
+            const uint64_t mipBytes = uint64_t( NumBytes ) * d;
+            if ( mipBytes > info.bitSize - offset )
+            {
+                return Result::EndOfFile;
+            }
+
+            if ( (info.mipCount <= 1) || !maxsize || (w <= maxsize && h <= maxsize && d <= maxsize) )
+            {
+                Subresource sub;
+                sub.data = info.bitData + offset;
+                sub.rowPitch = RowBytes;
+                sub.slicePitch = NumBytes;
+                sub.width = w;
+                sub.height = h;
+                sub.depth = d;
+                subresources.push_back( sub );
+            }
+            else if ( !j && skipMip )
+            {
+                // Count number of skipped mipmaps (first item only)
+                ++*skipMip;
+            }
+
+            offset += static_cast<size_t>( mipBytes );
+
+            w = w >> 1;
+            h = h >> 1;
+            d = d >> 1;
+            if (w == 0)
+            {
+                w = 1;
+            }
+            if (h == 0)
+            {
+                h = 1;
+            }
+            if (d == 0)
+            {
+                d = 1;
+            }
+        }
+    }
+
+    return subresources.empty() ? Result::Fail : Result::Ok;
+}
+
+
+//--------------------------------------------------------------------------------------
+// MappedFile
+//--------------------------------------------------------------------------------------
+DDS::MappedFile::MappedFile() :
+    m_data( nullptr ),
+    m_size( 0 ),
+    m_error( 0 )
+#ifdef _WIN32
+    ,
+    m_file( nullptr ),
+    m_mapping( nullptr )
+#endif
+{
+}
+
+DDS::MappedFile::~MappedFile()
+{
+    Close();
+}
+
+_Use_decl_annotations_
+DDS::Result DDS::MappedFile::Open( const wchar_t* fileName )
+{
+    Close();
+    m_error = 0;
+
+    if ( !fileName )
+    {
+        return Result::Fail;
+    }
+
+#ifdef _WIN32
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    HANDLE hFile = CreateFile2( fileName,
+                                GENERIC_READ,
+                                FILE_SHARE_READ,
+                                OPEN_EXISTING,
+                                nullptr );
+#else
+    HANDLE hFile = CreateFileW( fileName,
+                                GENERIC_READ,
+                                FILE_SHARE_READ,
+                                nullptr,
+                                OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                nullptr );
+#endif
+
+    if ( hFile == INVALID_HANDLE_VALUE )
+    {
+        m_error = GetLastError();
+        return Result::Fail;
+    }
+    m_file = hFile;
+
+    LARGE_INTEGER FileSize = { 0 };
+    if ( !GetFileSizeEx( hFile, &FileSize ) )
+    {
+        m_error = GetLastError();
+        Close();
+        return Result::Fail;
+    }
+
+    // The whole file has to fit in the address space
+    if ( uint64_t( FileSize.QuadPart ) > SIZE_MAX )
+    {
+        Close();
+        return Result::Fail;
+    }
+
+    // Mapping an empty file fails; leave it empty and let the parser reject it
+    if ( FileSize.QuadPart == 0 )
+    {
+        return Result::Ok;
+    }
+
+    m_mapping = CreateFileMappingW( hFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if ( !m_mapping )
+    {
+        m_error = GetLastError();
+        Close();
+        return Result::Fail;
+    }
+
+    m_data = static_cast<const uint8_t*>( MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 ) );
+    if ( !m_data )
+    {
+        m_error = GetLastError();
+        Close();
+        return Result::Fail;
+    }
+
+    m_size = static_cast<size_t>( FileSize.QuadPart );
+#else
+    // POSIX paths are bytes; convert with the current locale
+    size_t length = wcstombs( nullptr, fileName, 0 );
+    if ( length == size_t(-1) )
+    {
+        m_error = EILSEQ;
+        return Result::Fail;
+    }
+
+    std::vector<char> path( length + 1 );
+    wcstombs( path.data(), fileName, path.size() );
+
+    int fd = open( path.data(), O_RDONLY );
+    if ( fd < 0 )
+    {
+        m_error = errno;
+        return Result::Fail;
+    }
+
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 )
+    {
+        m_error = errno;
+        close( fd );
+        return Result::Fail;
+    }
+
+    if ( uint64_t( st.st_size ) > SIZE_MAX )
+    {
+        close( fd );
+        return Result::Fail;
+    }
+
+    // Mapping an empty file fails; leave it empty and let the parser reject it
+    if ( st.st_size > 0 )
+    {
+        void* data = mmap( nullptr, static_cast<size_t>( st.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+        if ( data == MAP_FAILED )
+        {
+            m_error = errno;
+            close( fd );
+            return Result::Fail;
+        }
+
+        m_data = static_cast<const uint8_t*>( data );
+        m_size = static_cast<size_t>( st.st_size );
+    }
+
+    // The mapping keeps its own reference to the file
+    close( fd );
+#endif
+
+    return Result::Ok;
+}
+
+void DDS::MappedFile::Close()
+{
+#ifdef _WIN32
+    if ( m_data )
+    {
+        UnmapViewOfFile( m_data );
+    }
+    if ( m_mapping )
+    {
+        CloseHandle( m_mapping );
+    }
+    if ( m_file )
+    {
+        CloseHandle( m_file );
+    }
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if ( m_data )
+    {
+        munmap( const_cast<uint8_t*>( m_data ), m_size );
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
@@ -0,0 +1,261 @@
+//--------------------------------------------------------------------------------------
+// File: DDSParser.h
+//
+// Device-independent DDS parsing used by DDSTextureLoader
+//
+// Everything here works on a caller-provided byte range (typically the pages of a
+// memory-mapped file) and never copies pixel data: subresources point straight into
+// the range. Nothing depends on Direct3D, so the parser builds and runs on any
+// platform with <dxgiformat.h> for fuzzing and benchmarking.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef DDSPARSER_H
+#define DDSPARSER_H
+
+#include <dxgiformat.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#ifndef _In_
+#define _In_
+#endif
+#ifndef _In_z_
+#define _In_z_
+#endif
+#ifndef _Out_
+#define _Out_
+#endif
+#ifndef _Out_opt_
+#define _Out_opt_
+#endif
+#ifndef _In_reads_bytes_
+#define _In_reads_bytes_(exp)
+#endif
+#ifndef _Use_decl_annotations_
+#define _Use_decl_annotations_
+#endif
+
+//--------------------------------------------------------------------------------------
+// Macros
+//--------------------------------------------------------------------------------------
+#ifndef MAKEFOURCC
+    #define MAKEFOURCC(ch0, ch1, ch2, ch3)                              \
+                ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) |       \
+                ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24 ))
+#endif /* defined(MAKEFOURCC) */
+
+//--------------------------------------------------------------------------------------
+// DDS file structure definitions
+//
+// See DDS.h in the 'Texconv' sample and the 'DirectXTex' library
+//--------------------------------------------------------------------------------------
+#pragma pack(push,1)
+
+const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+struct DDS_PIXELFORMAT
+{
+    uint32_t    size;
+    uint32_t    flags;
+    uint32_t    fourCC;
+    uint32_t    RGBBitCount;
+    uint32_t    RBitMask;
+    uint32_t    GBitMask;
+    uint32_t    BBitMask;
+    uint32_t    ABitMask;
+};
+
+#define DDS_FOURCC      0x00000004  // DDPF_FOURCC
+#define DDS_RGB         0x00000040  // DDPF_RGB
+#define DDS_LUMINANCE   0x00020000  // DDPF_LUMINANCE
+#define DDS_ALPHA       0x00000002  // DDPF_ALPHA
+#define DDS_BUMPDUDV    0x00080000  // DDPF_BUMPDUDV
+
+#define DDS_HEADER_FLAGS_VOLUME         0x00800000  // DDSD_DEPTH
+
+#define DDS_HEIGHT 0x00000002 // DDSD_HEIGHT
+#define DDS_WIDTH  0x00000004 // DDSD_WIDTH
+
+#define DDS_CUBEMAP_POSITIVEX 0x00000600 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEX
+#define DDS_CUBEMAP_NEGATIVEX 0x00000a00 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEX
+#define DDS_CUBEMAP_POSITIVEY 0x00001200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEY
+#define DDS_CUBEMAP_NEGATIVEY 0x00002200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEY
+#define DDS_CUBEMAP_POSITIVEZ 0x00004200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEZ
+#define DDS_CUBEMAP_NEGATIVEZ 0x00008200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEZ
+
+#define DDS_CUBEMAP_ALLFACES ( DDS_CUBEMAP_POSITIVEX | DDS_CUBEMAP_NEGATIVEX |\
+                               DDS_CUBEMAP_POSITIVEY | DDS_CUBEMAP_NEGATIVEY |\
+                               DDS_CUBEMAP_POSITIVEZ | DDS_CUBEMAP_NEGATIVEZ )
+
+#define DDS_CUBEMAP 0x00000200 // DDSCAPS2_CUBEMAP
+
+enum DDS_MISC_FLAGS2
+{
+    DDS_MISC_FLAGS2_ALPHA_MODE_MASK = 0x7L,
+};
+
+struct DDS_HEADER
+{
+    uint32_t        size;
+    uint32_t        flags;
+    uint32_t        height;
+    uint32_t        width;
+    uint32_t        pitchOrLinearSize;
+    uint32_t        depth; // only if DDS_HEADER_FLAGS_VOLUME is set in flags
+    uint32_t        mipMapCount;
+    uint32_t        reserved1[11];
+    DDS_PIXELFORMAT ddspf;
+    uint32_t        caps;
+    uint32_t        caps2;
+    uint32_t        caps3;
+    uint32_t        caps4;
+    uint32_t        reserved2;
+};
+
+struct DDS_HEADER_DXT10
+{
+    DXGI_FORMAT     dxgiFormat;
+    uint32_t        resourceDimension;
+    uint32_t        miscFlag; // see D3D11_RESOURCE_MISC_FLAG
+    uint32_t        arraySize;
+    uint32_t        miscFlags2;
+};
+
+#pragma pack(pop)
+
+namespace DirectX
+{
+namespace DDS
+{
+    //----------------------------------------------------------------------------------
+    // Parse results. DDSTextureLoader maps these to E_FAIL, ERROR_INVALID_DATA,
+    // ERROR_NOT_SUPPORTED and ERROR_HANDLE_EOF respectively.
+    //----------------------------------------------------------------------------------
+    enum class Result
+    {
+        Ok,
+        Fail,           // Not a DDS file (too small, bad magic or header sizes)
+        InvalidData,    // Inconsistent metadata
+        NotSupported,   // Valid, but not a format or size Direct3D 11 can create
+        EndOfFile,      // The pixel data is shorter than the metadata describes
+    };
+
+    // Same values as D3D11_RESOURCE_DIMENSION
+    enum ResourceDimension : uint32_t
+    {
+        RESOURCE_DIMENSION_UNKNOWN   = 0,
+        RESOURCE_DIMENSION_TEXTURE1D = 2,
+        RESOURCE_DIMENSION_TEXTURE2D = 3,
+        RESOURCE_DIMENSION_TEXTURE3D = 4,
+    };
+
+    //----------------------------------------------------------------------------------
+    // Validated description of a DDS file. header and bitData point into the buffer
+    // that was parsed, so they are only valid while it is.
+    //----------------------------------------------------------------------------------
+    struct TextureInfo
+    {
+        const DDS_HEADER*   header;
+        const uint8_t*      bitData;
+        size_t              bitSize;
+
+        uint32_t            resDim;
+        size_t              width;
+        size_t              height;
+        size_t              depth;
+        size_t              mipCount;
+        size_t              arraySize;  // Six per cube for cube maps
+        DXGI_FORMAT         format;
+        bool                isCubeMap;
+    };
+
+    //----------------------------------------------------------------------------------
+    // One mip level of one array item, in Direct3D subresource order (all mips of
+    // item 0, then item 1, ...). data points into the parsed buffer.
+    //----------------------------------------------------------------------------------
+    struct Subresource
+    {
+        const uint8_t*      data;
+        size_t              rowPitch;
+        size_t              slicePitch;
+        size_t              width;
+        size_t              height;
+        size_t              depth;
+    };
+
+    // Validates the magic value, headers and metadata of the DDS file in ddsData and
+    // bounds its sizes by the Direct3D 11 hardware limits.
+    Result ParseHeader( _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+                        _In_ size_t ddsDataSize,
+                        _Out_ TextureInfo& info );
+
+    // Lists the subresources of info, leaving out mips larger than maxsize (0 for no
+    // limit) unless the texture has only one. skipMip receives the number of mips left
+    // out per item. Fails if the pixel data is too short.
+    Result EnumerateSubresources( _In_ const TextureInfo& info,
+                                  _In_ size_t maxsize,
+                                  _Out_ std::vector<Subresource>& subresources,
+                                  _Out_opt_ size_t* skipMip = nullptr );
+
+    size_t BitsPerPixel( _In_ DXGI_FORMAT fmt );
+
+    void GetSurfaceInfo( _In_ size_t width,
+                         _In_ size_t height,
+                         _In_ DXGI_FORMAT fmt,
+                         _Out_opt_ size_t* outNumBytes,
+                         _Out_opt_ size_t* outRowBytes,
+                         _Out_opt_ size_t* outNumRows );
+
+    DXGI_FORMAT GetDXGIFormat( const DDS_PIXELFORMAT& ddpf );
+
+    DXGI_FORMAT MakeSRGB( _In_ DXGI_FORMAT format );
+
+    //----------------------------------------------------------------------------------
+    // Read-only memory mapping of a whole file (MapViewOfFile on Windows, mmap
+    // elsewhere). Pages are only read from disk when touched, and the data is never
+    // copied into a heap buffer.
+    //----------------------------------------------------------------------------------
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        // On failure, SystemError() has the GetLastError() or errno value.
+        Result Open( _In_z_ const wchar_t* fileName );
+        void Close();
+
+        const uint8_t* Data() const { return m_data; }
+        size_t Size() const { return m_size; }
+        uint32_t SystemError() const { return m_error; }
+
+    private:
+        MappedFile( const MappedFile& );
+        MappedFile& operator=( const MappedFile& );
+
+        const uint8_t*  m_data;
+        size_t          m_size;
+        uint32_t        m_error;
+#ifdef _WIN32
+        void*           m_file;
+        void*           m_mapping;
+#endif
+    };
+
+} // namespace DDS
+} // namespace DirectX
+
+#endif // DDSPARSER_H
@@ -0,0 +1,173 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file DynamicRingBuffer.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "DynamicRingBuffer.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    UINT RoundUp( const UINT value, const UINT multiple )
+    {
+        return ( value + multiple - 1 ) / multiple * multiple;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+DynamicRingBuffer::DynamicRingBuffer( void )
+: mBuffer( nullptr )
+, mAllocator( )
+, mMapped( nullptr )
+, mDiscard( true )
+, mConstants( false )
+, mFrameOpen( false )
+, mNextFence( 1 )
+, mFences( )
+, mFreeQueries( )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+DynamicRingBuffer::~DynamicRingBuffer( void )
+{
+    Release();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void DynamicRingBuffer::Create( ID3D11Device* device, const UINT capacity, const UINT bindFlags )
+{
+    Release();
+
+    // Ranges of a constant buffer are bound by *SetConstantBuffers1(),
+    // which takes whole multiples of ConstantBufferAlignment.
+    mConstants = ( bindFlags & D3D11_BIND_CONSTANT_BUFFER ) != 0;
+    const UINT byteWidth = mConstants ? RoundUp( capacity, ConstantBufferAlignment ) : capacity;
+
+    D3D11_BUFFER_DESC desc;
+    desc.Usage = D3D11_USAGE_DYNAMIC;
+    desc.ByteWidth = byteWidth;
+    desc.BindFlags = bindFlags;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    desc.MiscFlags = 0;
+    desc.StructureByteStride = 0;
+
+    HR( device->CreateBuffer( &desc, 0, &mBuffer ) );
+
+    mAllocator.reset( new FrameRingAllocator( byteWidth ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void DynamicRingBuffer::Release( void )
+{
+    ReleaseCOM( mBuffer );
+    mAllocator.reset();
+    mMapped = nullptr;
+    mDiscard = true;
+    mFrameOpen = false;
+
+    for ( Fence& fence : mFences ) {
+        ReleaseCOM( fence.query );
+    }
+    mFences.clear();
+    for ( ID3D11Query*& query : mFreeQueries ) {
+        ReleaseCOM( query );
+    }
+    mFreeQueries.clear();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+ID3D11Buffer* DynamicRingBuffer::Get( void ) const
+{
+    return mBuffer;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void DynamicRingBuffer::Begin( ID3D11DeviceContext* context )
+{
+    // Everything drawn since the last Begin() is done once this fence is.
+    if ( mFrameOpen ) {
+        Fence fence;
+        fence.value = mNextFence++;
+        if ( mFreeQueries.empty() ) {
+            ID3D11Device* device = nullptr;
+            context->GetDevice( &device );
+
+            D3D11_QUERY_DESC desc;
+            desc.Query = D3D11_QUERY_EVENT;
+            desc.MiscFlags = 0;
+            HR( device->CreateQuery( &desc, &fence.query ) );
+
+            ReleaseCOM( device );
+        } else {
+            fence.query = mFreeQueries.back();
+            mFreeQueries.pop_back();
+        }
+
+        context->End( fence.query );
+        mAllocator->EndFrame( fence.value );
+        mFences.push_back( fence );
+    }
+
+    // Queries complete in order; stop at the first that has not.
+    uint64_t completed = 0;
+    while ( !mFences.empty() &&
+            context->GetData( mFences.front().query, nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH ) == S_OK ) {
+        completed = mFences.front().value;
+        mFreeQueries.push_back( mFences.front().query );
+        mFences.pop_front();
+    }
+    if ( completed > 0 ) {
+        mAllocator->Reclaim( completed );
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mappedData;
+    HR( context->Map( mBuffer, 0, mDiscard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedData ) );
+    mMapped = static_cast<char*>( mappedData.pData );
+    mDiscard = false;
+    mFrameOpen = true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void* DynamicRingBuffer::Allocate( const UINT size, const UINT alignment, UINT& offset )
+{
+    if ( mMapped == nullptr ) {
+        return nullptr;
+    }
+
+    const size_t at = mAllocator->Allocate( size, mConstants ? RoundUp( alignment, ConstantBufferAlignment ) : alignment );
+    if ( at == FrameRingAllocator::InvalidOffset ) {
+        return nullptr;
+    }
+
+    offset = static_cast<UINT>( at );
+    return mMapped + at;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void DynamicRingBuffer::Unmap( ID3D11DeviceContext* context )
+{
+    if ( mMapped != nullptr ) {
+        context->Unmap( mBuffer, 0 );
+        mMapped = nullptr;
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const FrameRingAllocator* DynamicRingBuffer::GetAllocator( void ) const
+{
+    return mAllocator.get();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,98 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file DynamicRingBuffer.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "D3DUtil.h"
+#include "FrameRingAllocator.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// One large dynamic buffer shared by all the per-frame data of its kind
+/// (vertices and instances, or constants), mapped once per frame instead of
+/// once per object. Ranges come from a FrameRingAllocator, so any thread may
+/// allocate and write while the buffer is mapped. The GPU's progress is
+/// followed with event queries; a frame's ranges are reused only once the
+/// GPU has finished the draws issued before the next Begin().
+///
+/// Per frame: Begin(), Allocate() and write, Unmap(), then draw. After the
+/// first frame the buffer is mapped with D3D11_MAP_WRITE_NO_OVERWRITE, which
+/// constant buffers only allow on D3D 11.1 drivers, and binding a range of a
+/// constant buffer takes ID3D11DeviceContext1::VSSetConstantBuffers1(); hence
+/// ConstantBufferAlignment.
+///</summary>
+class DynamicRingBuffer {
+public:
+
+    // 16 constants, the granularity of *SetConstantBuffers1() offsets.
+    static const UINT ConstantBufferAlignment = 256;
+
+    DynamicRingBuffer( void );
+    ~DynamicRingBuffer( void );
+
+    // capacity in bytes. bindFlags is D3D11_BIND_VERTEX_BUFFER,
+    // D3D11_BIND_INDEX_BUFFER or D3D11_BIND_CONSTANT_BUFFER; a constant
+    // buffer's capacity is rounded up to ConstantBufferAlignment, and so are
+    // the alignments of its ranges.
+    void Create( ID3D11Device* device, const UINT capacity, const UINT bindFlags );
+    void Release( void );
+
+    ID3D11Buffer* Get( void ) const;
+
+    // Ends the previous frame with a fence, frees the frames the GPU is done
+    // with and maps the buffer.
+    void Begin( ID3D11DeviceContext* context );
+
+    // Where to write size bytes, or null if the ring is full; offset gets
+    // the byte offset in the buffer, a multiple of alignment. Any thread,
+    // between Begin() and Unmap().
+    void* Allocate( const UINT size, const UINT alignment, UINT& offset );
+
+    // count elements of T. offset is in bytes, a multiple of sizeof( T ),
+    // so with the buffer bound at offset 0 and a stride of sizeof( T ),
+    // offset / sizeof( T ) is the index of the first element
+    // (StartInstanceLocation, BaseVertexLocation). That holds whatever else
+    // the ring holds: each range is aligned to its own element size.
+    template<typename T>
+    T* Allocate( const UINT count, UINT& offset )
+    {
+        return static_cast<T*>( Allocate( count * sizeof( T ), sizeof( T ), offset ) );
+    }
+
+    // Before drawing from anything allocated since Begin().
+    void Unmap( ID3D11DeviceContext* context );
+
+    const FrameRingAllocator* GetAllocator( void ) const;
+
+private:
+
+    DynamicRingBuffer( const DynamicRingBuffer& rhs );
+    DynamicRingBuffer& operator=( const DynamicRingBuffer& rhs );
+
+    struct Fence {
+        ID3D11Query* query;
+        uint64_t value;
+    };
+
+    ID3D11Buffer* mBuffer;
+    std::unique_ptr<FrameRingAllocator> mAllocator;
+    char* mMapped;
+    bool mDiscard;
+    bool mConstants;
+
+    bool mFrameOpen;
+    uint64_t mNextFence;
+    std::deque<Fence> mFences;
+    std::vector<ID3D11Query*> mFreeQueries;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
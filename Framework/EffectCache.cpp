@@ -0,0 +1,563 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file EffectCache.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "EffectCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#include <sys/stat.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    const uint32_t HandleTableMagic = 0x54485846; // "FXHT"
+    const uint32_t HandleTableVersion = 1;
+
+    // Paths go to the C runtime as wide strings on Windows and as multibyte
+    // strings elsewhere.
+#ifndef _WIN32
+    std::string Narrow( const std::wstring& s )
+    {
+        std::string result( s.size() * MB_CUR_MAX + 1, '\0' );
+        const size_t length = std::wcstombs( &result[0], s.c_str(), result.size() );
+        result.resize( length == static_cast<size_t>( -1 ) ? 0 : length );
+        return result;
+    }
+#endif
+
+    std::wstring DirectoryOf( const std::wstring& filename )
+    {
+        const size_t slash = filename.find_last_of( L"/\\" );
+        return slash == std::wstring::npos ? std::wstring() : filename.substr( 0, slash + 1 );
+    }
+
+    bool MakeDirectory( const std::wstring& directory )
+    {
+#ifdef _WIN32
+        return CreateDirectoryW( directory.c_str(), nullptr ) || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+        struct stat info;
+        return mkdir( Narrow( directory ).c_str(), 0755 ) == 0 ||
+               ( stat( Narrow( directory ).c_str(), &info ) == 0 && S_ISDIR( info.st_mode ) );
+#endif
+    }
+
+    // Quoted #include directives of an effect source. Angle-bracket includes
+    // are system headers and left out.
+    std::vector<std::string> FindIncludes( const std::vector<char>& source )
+    {
+        std::vector<std::string> includes;
+        const char* p = source.data();
+        const char* end = p + source.size();
+
+        while ( p < end ) {
+            const char* lineEnd = std::find( p, end, '\n' );
+
+            const char* c = p;
+            while ( c < lineEnd && ( *c == ' ' || *c == '\t' ) ) {
+                ++c;
+            }
+            if ( c < lineEnd && *c == '#' ) {
+                ++c;
+                while ( c < lineEnd && ( *c == ' ' || *c == '\t' ) ) {
+                    ++c;
+                }
+                if ( lineEnd - c > 7 && std::strncmp( c, "include", 7 ) == 0 ) {
+                    const char* open = std::find( c + 7, lineEnd, '"' );
+                    const char* close = open < lineEnd ? std::find( open + 1, lineEnd, '"' ) : lineEnd;
+                    if ( close < lineEnd ) {
+                        includes.push_back( std::string( open + 1, close ) );
+                    }
+                }
+            }
+
+            p = lineEnd + 1;
+        }
+
+        return includes;
+    }
+
+    bool HashSource( const std::wstring& filename,
+                     uint64_t& hash,
+                     std::set<std::wstring>& visited,
+                     std::vector<std::wstring>* dependencies )
+    {
+        // Each file counts once, which also ends include cycles.
+        if ( !visited.insert( filename ).second ) {
+            return true;
+        }
+
+        std::vector<char> source;
+        if ( !EffectCache::ReadFile( filename, source ) ) {
+            return false;
+        }
+
+        if ( dependencies != nullptr ) {
+            dependencies->push_back( filename );
+        }
+
+        hash = EffectCache::Hash( source.data(), source.size(), hash );
+
+        const std::wstring directory = DirectoryOf( filename );
+        for ( auto& include : FindIncludes( source ) ) {
+            // The name is hashed as well, so renaming an include is a change.
+            hash = EffectCache::Hash( include.data(), include.size(), hash );
+
+            if ( !HashSource( directory + std::wstring( include.begin(), include.end() ), hash, visited, dependencies ) ) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    template<typename T>
+    void Put( std::vector<char>& data, const T value )
+    {
+        const char* bytes = reinterpret_cast<const char*>( &value );
+        data.insert( data.end(), bytes, bytes + sizeof( T ) );
+    }
+
+    template<typename T>
+    bool Get( const char*& p, const char* end, T& value )
+    {
+        if ( static_cast<size_t>( end - p ) < sizeof( T ) ) {
+            return false;
+        }
+        std::memcpy( &value, p, sizeof( T ) );
+        p += sizeof( T );
+        return true;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint64_t EffectCache::Hash( const void* data, const size_t size, const uint64_t seed )
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>( data );
+    uint64_t hash = seed;
+
+    for ( size_t i = 0; i < size; ++i ) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool EffectCache::SourceKey( const std::wstring& filename,
+                             const uint64_t salt,
+                             uint64_t& key,
+                             std::vector<std::wstring>* dependencies )
+{
+    std::set<std::wstring> visited;
+    uint64_t hash = Hash( &salt, sizeof( salt ) );
+
+    if ( !HashSource( filename, hash, visited, dependencies ) ) {
+        return false;
+    }
+
+    key = hash;
+    return true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool EffectCache::ReadFile( const std::wstring& filename, std::vector<char>& data )
+{
+#ifdef _WIN32
+    std::ifstream file( filename, std::ios::binary );
+#else
+    std::ifstream file( Narrow( filename ).c_str(), std::ios::binary );
+#endif
+    if ( !file ) {
+        return false;
+    }
+
+    file.seekg( 0, std::ios::end );
+    const std::streamoff size = file.tellg();
+    file.seekg( 0, std::ios::beg );
+    if ( size < 0 ) {
+        return false;
+    }
+
+    data.resize( static_cast<size_t>( size ) );
+    if ( size > 0 ) {
+        file.read( data.data(), size );
+    }
+
+    return static_cast<bool>( file );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool EffectCache::WriteFile( const std::wstring& filename, const void* data, const size_t size )
+{
+    const std::wstring temp = filename + L".tmp";
+
+    {
+#ifdef _WIN32
+        std::ofstream file( temp, std::ios::binary | std::ios::trunc );
+#else
+        std::ofstream file( Narrow( temp ).c_str(), std::ios::binary | std::ios::trunc );
+#endif
+        if ( !file ) {
+            return false;
+        }
+
+        file.write( static_cast<const char*>( data ), static_cast<std::streamsize>( size ) );
+        if ( !file ) {
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    return MoveFileExW( temp.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING ) != 0;
+#else
+    return std::rename( Narrow( temp ).c_str(), Narrow( filename ).c_str() ) == 0;
+#endif
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool EffectCache::FileExists( const std::wstring& filename )
+{
+    int64_t time;
+    return GetModifiedTime( filename, time );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool EffectCache::GetModifiedTime( const std::wstring& filename, int64_t& time )
+{
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if ( !GetFileAttributesExW( filename.c_str(), GetFileExInfoStandard, &attributes ) ) {
+        return false;
+    }
+    time = ( static_cast<int64_t>( attributes.ftLastWriteTime.dwHighDateTime ) << 32 ) |
+           attributes.ftLastWriteTime.dwLowDateTime;
+    return true;
+#else
+    struct stat info;
+    if ( stat( Narrow( filename ).c_str(), &info ) != 0 ) {
+        return false;
+    }
+    time = static_cast<int64_t>( info.st_mtim.tv_sec ) * 1000000000 + info.st_mtim.tv_nsec;
+    return true;
+#endif
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+EffectCache::EffectCache( const std::wstring& directory )
+    : mDirectory( directory )
+{
+    if ( !mDirectory.empty() && mDirectory.back() != L'/' && mDirectory.back() != L'\\' ) {
+        mDirectory += L'/';
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+std::wstring EffectCache::GetPath( const uint64_t key ) const
+{
+    wchar_t name[17];
+    for ( int i = 0; i < 16; ++i ) {
+        name[i] = L"0123456789abcdef"[( key >> ( 60 - 4 * i ) ) & 0xf];
+    }
+    name[16] = L'\0';
+
+    return mDirectory + name + L".fxo";
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool EffectCache::Load( const uint64_t key, std::vector<char>& binary ) const
+{
+    return ReadFile( GetPath( key ), binary ) && !binary.empty();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool EffectCache::Store( const uint64_t key, const void* data, const size_t size ) const
+{
+    if ( !mDirectory.empty() && !MakeDirectory( mDirectory.substr( 0, mDirectory.size() - 1 ) ) ) {
+        return false;
+    }
+
+    return WriteFile( GetPath( key ), data, size );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+EffectHandleTable::EffectHandleTable( void )
+    : mBinaryHash( 0 )
+    , mDirty( false )
+{
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void EffectHandleTable::Reset( const uint64_t binaryHash )
+{
+    mBinaryHash = binaryHash;
+    mTechniques.clear();
+    mVariables.clear();
+    mDirty = false;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint64_t EffectHandleTable::GetBinaryHash( void ) const
+{
+    return mBinaryHash;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool EffectHandleTable::Find( const Kind kind, const std::string& name, uint32_t& index ) const
+{
+    const IndexMap& map = GetMap( kind );
+    const auto it = map.find( name );
+    if ( it == map.end() ) {
+        return false;
+    }
+
+    index = it->second;
+    return true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void EffectHandleTable::Add( const Kind kind, const std::string& name, const uint32_t index )
+{
+    IndexMap& map = GetMap( kind );
+    const auto it = map.find( name );
+
+    if ( it == map.end() || it->second != index ) {
+        map[name] = index;
+        mDirty = true;
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void EffectHandleTable::ForEach( const Kind kind, const std::function<void( const std::string&, uint32_t )>& fn ) const
+{
+    for ( const auto& entry : GetMap( kind ) ) {
+        fn( entry.first, entry.second );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool EffectHandleTable::IsDirty( void ) const
+{
+    return mDirty;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void EffectHandleTable::Serialize( std::vector<char>& data ) const
+{
+    data.clear();
+    Put( data, HandleTableMagic );
+    Put( data, HandleTableVersion );
+    Put( data, mBinaryHash );
+
+    for ( const IndexMap* map : { &mTechniques, &mVariables } ) {
+        // Sorted, so the same table always gives the same bytes.
+        std::vector<std::pair<std::string, uint32_t>> entries( map->begin(), map->end() );
+        std::sort( entries.begin(), entries.end() );
+
+        Put( data, static_cast<uint32_t>( entries.size() ) );
+        for ( auto& entry : entries ) {
+            Put( data, entry.second );
+            Put( data, static_cast<uint32_t>( entry.first.size() ) );
+            data.insert( data.end(), entry.first.begin(), entry.first.end() );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool EffectHandleTable::Deserialize( const char* data, const size_t size )
+{
+    Reset( 0 );
+
+    const char* p = data;
+    const char* end = data + size;
+
+    uint32_t magic;
+    uint32_t version;
+    uint64_t binaryHash;
+    if ( !Get( p, end, magic ) || magic != HandleTableMagic ||
+         !Get( p, end, version ) || version != HandleTableVersion ||
+         !Get( p, end, binaryHash ) ) {
+        return false;
+    }
+
+    for ( IndexMap* map : { &mTechniques, &mVariables } ) {
+        uint32_t count;
+        if ( !Get( p, end, count ) ) {
+            Reset( 0 );
+            return false;
+        }
+
+        for ( uint32_t i = 0; i < count; ++i ) {
+            uint32_t index;
+            uint32_t length;
+            if ( !Get( p, end, index ) || !Get( p, end, length ) || static_cast<size_t>( end - p ) < length ) {
+                Reset( 0 );
+                return false;
+            }
+
+            ( *map )[std::string( p, p + length )] = index;
+            p += length;
+        }
+    }
+
+    mBinaryHash = binaryHash;
+    return true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool EffectHandleTable::Load( const std::wstring& filename, const uint64_t binaryHash )
+{
+    std::vector<char> data;
+    if ( !EffectCache::ReadFile( filename, data ) ||
+         !Deserialize( data.data(), data.size() ) ||
+         mBinaryHash != binaryHash ) {
+        Reset( binaryHash );
+        return false;
+    }
+
+    return true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool EffectHandleTable::Save( const std::wstring& filename )
+{
+    std::vector<char> data;
+    Serialize( data );
+
+    if ( !EffectCache::WriteFile( filename, data.data(), data.size() ) ) {
+        return false;
+    }
+
+    mDirty = false;
+    return true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+EffectHandleTable::IndexMap& EffectHandleTable::GetMap( const Kind kind )
+{
+    return kind == Technique ? mTechniques : mVariables;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const EffectHandleTable::IndexMap& EffectHandleTable::GetMap( const Kind kind ) const
+{
+    return kind == Technique ? mTechniques : mVariables;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+FileWatcher::FileWatcher( const std::chrono::milliseconds interval )
+    : mInterval( interval )
+    , mLastPoll( std::chrono::steady_clock::now() )
+{
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FileWatcher::Watch( const unsigned int tag, const std::vector<std::wstring>& files )
+{
+    std::vector<File>& group = mGroups[tag];
+    group.clear();
+
+    for ( auto& name : files ) {
+        File file;
+        file.name = name;
+        file.time = 0;
+        file.exists = EffectCache::GetModifiedTime( name, file.time );
+        group.push_back( file );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FileWatcher::Unwatch( const unsigned int tag )
+{
+    mGroups.erase( tag );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool FileWatcher::Poll( std::vector<unsigned int>& changed )
+{
+    const auto now = std::chrono::steady_clock::now();
+    if ( now - mLastPoll < mInterval ) {
+        return false;
+    }
+
+    PollNow( changed );
+    return true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FileWatcher::PollNow( std::vector<unsigned int>& changed )
+{
+    mLastPoll = std::chrono::steady_clock::now();
+
+    for ( auto& group : mGroups ) {
+        bool groupChanged = false;
+
+        for ( auto& file : group.second ) {
+            int64_t time = 0;
+            const bool exists = EffectCache::GetModifiedTime( file.name, time );
+
+            // An editor saving through delete and rename can make the file
+            // vanish for a moment; that is reported once it is back.
+            if ( exists && ( !file.exists || time != file.time ) ) {
+                groupChanged = true;
+            }
+
+            file.exists = exists;
+            if ( exists ) {
+                file.time = time;
+            }
+        }
+
+        if ( groupChanged ) {
+            changed.push_back( group.first );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,233 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file EffectCache.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Content-addressed store of compiled effect binaries.
+///
+/// Entries are keyed by a hash of the effect source and every file it
+/// includes, so an edit recompiles once and switching back to an earlier
+/// version of a file finds its binary again. Nothing here needs a device;
+/// Effects does the compiling and creating.
+///</summary>
+class EffectCache {
+public:
+
+    static const uint64_t HashSeed = 14695981039346656037ULL;
+
+    // 64-bit FNV-1a. Chain calls by passing the previous result as seed.
+    static uint64_t Hash( const void* data, const size_t size, const uint64_t seed = HashSeed );
+
+    // Key of the effect source in filename: its bytes and those of every
+    // file it #includes with quotes (relative to the including file),
+    // recursively, combined with salt (compile flags, compiler version).
+    // dependencies, if given, receives every file that was read.
+    static bool SourceKey( const std::wstring& filename,
+                           const uint64_t salt,
+                           uint64_t& key,
+                           std::vector<std::wstring>* dependencies = nullptr );
+
+    static bool ReadFile( const std::wstring& filename, std::vector<char>& data );
+
+    // Writes through a temporary file and a rename, so a reader never sees
+    // half a file.
+    static bool WriteFile( const std::wstring& filename, const void* data, const size_t size );
+
+    static bool FileExists( const std::wstring& filename );
+
+    // Last write time in an unspecified unit; only compared for equality.
+    static bool GetModifiedTime( const std::wstring& filename, int64_t& time );
+
+    explicit EffectCache( const std::wstring& directory );
+
+    std::wstring GetPath( const uint64_t key ) const;
+
+    bool Load( const uint64_t key, std::vector<char>& binary ) const;
+
+    // Creates the directory if needed.
+    bool Store( const uint64_t key, const void* data, const size_t size ) const;
+
+private:
+
+    std::wstring mDirectory;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Technique and variable indices of one effect binary, found by name the
+/// first time and saved next to the binary, so later runs fetch them by
+/// index instead of searching by name or reading descriptions. The table is only trusted for the
+/// binary whose hash it was saved with.
+///</summary>
+class EffectHandleTable {
+public:
+
+    enum Kind {
+        Technique,
+        Variable
+    };
+
+    EffectHandleTable( void );
+
+    // Empties the table for the binary with the given hash.
+    void Reset( const uint64_t binaryHash );
+
+    uint64_t GetBinaryHash( void ) const;
+
+    bool Find( const Kind kind, const std::string& name, uint32_t& index ) const;
+    void Add( const Kind kind, const std::string& name, const uint32_t index );
+
+    // Calls fn( name, index ) for every entry of the kind, in no order.
+    void ForEach( const Kind kind, const std::function<void( const std::string&, uint32_t )>& fn ) const;
+
+    // True when Add() has put in something that is not saved yet.
+    bool IsDirty( void ) const;
+
+    void Serialize( std::vector<char>& data ) const;
+
+    // Fails, leaving the table empty, on bad or truncated data.
+    bool Deserialize( const char* data, const size_t size );
+
+    // Loads filename if it was saved for binaryHash; otherwise resets the
+    // table for binaryHash and returns false.
+    bool Load( const std::wstring& filename, const uint64_t binaryHash );
+    bool Save( const std::wstring& filename );
+
+private:
+
+    typedef std::unordered_map<std::string, uint32_t> IndexMap;
+
+    IndexMap& GetMap( const Kind kind );
+    const IndexMap& GetMap( const Kind kind ) const;
+
+    uint64_t mBinaryHash;
+    IndexMap mTechniques;
+    IndexMap mVariables;
+    bool mDirty;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Polls last write times of groups of files. Each group has a tag; Poll()
+/// reports the tags of groups in which any file changed since it was added
+/// or last reported. Checks run at most once per interval, so Poll() can be
+/// called every frame.
+///</summary>
+class FileWatcher {
+public:
+
+    explicit FileWatcher( const std::chrono::milliseconds interval = std::chrono::milliseconds( 250 ) );
+
+    // Replaces the files of tag.
+    void Watch( const unsigned int tag, const std::vector<std::wstring>& files );
+    void Unwatch( const unsigned int tag );
+
+    // Appends changed tags to changed. Returns false if nothing was checked
+    // because the interval has not passed.
+    bool Poll( std::vector<unsigned int>& changed );
+
+    // Checks now, regardless of the interval.
+    void PollNow( std::vector<unsigned int>& changed );
+
+private:
+
+    struct File {
+        std::wstring name;
+        int64_t time;
+        bool exists;
+    };
+
+    std::unordered_map<unsigned int, std::vector<File>> mGroups;
+    std::chrono::milliseconds mInterval;
+    std::chrono::steady_clock::time_point mLastPoll;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Object created on first use by a factory. Any thread may call Get();
+/// the factory runs once. Reset() destroys the object so the next Get()
+/// creates it again, and must not race with users of the old one.
+///</summary>
+class LazyObject {
+public:
+
+    virtual ~LazyObject( void ) { }
+
+    virtual bool IsLoaded( void ) const = 0;
+    virtual void Reset( void ) = 0;
+
+};
+
+template<typename T>
+class Lazy : public LazyObject {
+public:
+
+    typedef std::function<T*( void )> Factory;
+
+    Lazy( void ) : mObject( nullptr ) { }
+    ~Lazy( void ) { Reset(); }
+
+    void SetFactory( const Factory& factory )
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mFactory = factory;
+    }
+
+    T* Get( void )
+    {
+        T* object = mObject.load( std::memory_order_acquire );
+        if ( object == nullptr ) {
+            std::lock_guard<std::mutex> lock( mMutex );
+            object = mObject.load( std::memory_order_relaxed );
+            if ( object == nullptr && mFactory ) {
+                object = mFactory();
+                mObject.store( object, std::memory_order_release );
+            }
+        }
+        return object;
+    }
+
+    T* operator->( void ) { return Get(); }
+
+    bool IsLoaded( void ) const override { return mObject.load( std::memory_order_acquire ) != nullptr; }
+
+    void Reset( void ) override
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        delete mObject.exchange( nullptr );
+    }
+
+private:
+
+    Lazy( const Lazy& rhs );
+    Lazy& operator=( const Lazy& rhs );
+
+    std::atomic<T*> mObject;
+    std::mutex mMutex;
+    Factory mFactory;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
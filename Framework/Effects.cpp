@@ -4,132 +4,417 @@
 
 #include "Effects.h"
 
+#include <cstring>
+
+#pragma region ConstantBufferStaging
+DynamicConstantBuffer::DynamicConstantBuffer()
+	: mBuffer(0), mVersion(0)
+{
+}
+
+DynamicConstantBuffer::~DynamicConstantBuffer()
+{
+	Release();
+}
+
+void DynamicConstantBuffer::Create(ID3D11Device* device, UINT size)
+{
+	Release();
+
+	D3D11_BUFFER_DESC desc;
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	desc.ByteWidth = size;
+	desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	desc.MiscFlags = 0;
+	desc.StructureByteStride = 0;
+
+	HR(device->CreateBuffer(&desc, 0, &mBuffer));
+}
+
+void DynamicConstantBuffer::Release()
+{
+	ReleaseCOM(mBuffer);
+	// Whatever a new buffer is created for is written in full.
+	mVersion = 0;
+}
+
+void DynamicConstantBuffer::Write(ID3D11DeviceContext* context, const void* data, size_t size)
+{
+	D3D11_MAPPED_SUBRESOURCE mappedData;
+	HR(context->Map(mBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData));
+	memcpy(mappedData.pData, data, size);
+	context->Unmap(mBuffer, 0);
+}
+
+ConstantBufferBinding::ConstantBufferBinding()
+	: mLayout(0), mBuffer(0), mVersion(0)
+{
+}
+
+void ConstantBufferBinding::Bind(ID3DX11Effect* fx, const ConstantBufferLayout& layout, DynamicConstantBuffer* buffer)
+{
+	mLayout = &layout;
+	mMembers.clear();
+	mBuffer = 0;
+	mVersion = 0;
+
+	ID3DX11EffectConstantBuffer* cbuffer = fx->GetConstantBufferByName(layout.name);
+	if (buffer && buffer->Get() && Matches(cbuffer, layout) &&
+		SUCCEEDED(cbuffer->SetConstantBuffer(buffer->Get()))) {
+		mBuffer = buffer;
+		return;
+	}
+
+	for (size_t i = 0; i < layout.memberCount; ++i) {
+		mMembers.push_back(fx->GetVariableByName(layout.members[i].name));
+	}
+}
+
+bool ConstantBufferBinding::Matches(ID3DX11EffectConstantBuffer* cbuffer, const ConstantBufferLayout& layout)
+{
+	D3DX11_EFFECT_TYPE_DESC typeDesc;
+	if (!cbuffer->IsValid() || FAILED(cbuffer->GetType()->GetDesc(&typeDesc)) ||
+		typeDesc.Members != layout.memberCount) {
+		return false;
+	}
+
+	for (size_t i = 0; i < layout.memberCount; ++i) {
+		const ConstantBufferMember& member = layout.members[i];
+		ID3DX11EffectVariable* var = cbuffer->GetMemberByIndex(static_cast<UINT>(i));
+
+		D3DX11_EFFECT_VARIABLE_DESC desc;
+		D3DX11_EFFECT_TYPE_DESC memberType;
+		if (!var->IsValid() || FAILED(var->GetDesc(&desc)) || FAILED(var->GetType()->GetDesc(&memberType)) ||
+			strcmp(desc.Name, member.name) != 0 ||
+			desc.BufferOffset != member.offset ||
+			memberType.UnpackedSize != member.size) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ConstantBufferBinding::SetMembers(const void* data)
+{
+	const char* bytes = static_cast<const char*>(data);
+	for (size_t i = 0; i < mMembers.size(); ++i) {
+		const ConstantBufferMember& member = mLayout->members[i];
+		mMembers[i]->SetRawValue(bytes + member.offset, 0, static_cast<UINT>(member.size));
+	}
+}
+#pragma endregion
+
 #pragma region Effect
+namespace
+{
+	// Flags for effects compiled at run time; they are part of the cache key.
+#if defined( DEBUG ) || defined( _DEBUG )
+	const UINT CompileFlags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+	const UINT CompileFlags = D3DCOMPILE_ENABLE_STRICTNESS;
+#endif
+
+	uint64_t CompileSalt()
+	{
+		const UINT salt[] = { CompileFlags, D3D_COMPILER_VERSION, 0x66780500 }; // fx_5_0
+		return EffectCache::Hash(salt, sizeof(salt));
+	}
+
+	// FX/Basic.fxo -> FX/Basic.fx
+	std::wstring SourceFor(const std::wstring& filename)
+	{
+		const size_t dot = filename.find_last_of(L'.');
+		return (dot == std::wstring::npos ? filename : filename.substr(0, dot)) + L".fx";
+	}
+
+	// FX/Basic.fxo -> FX/Cache/
+	EffectCache CacheFor(const std::wstring& filename)
+	{
+		const size_t slash = filename.find_last_of(L"/\\");
+		return EffectCache((slash == std::wstring::npos ? std::wstring() : filename.substr(0, slash + 1)) + L"Cache");
+	}
+}
+
 Effect::Effect(ID3D11Device* device, const std::wstring& filename)
-	: mFX(0)
+	: mFX(0), mHandleFile(filename + L".handles")
 {
-	std::ifstream fin(filename, std::ios::binary);
-
-	fin.seekg(0, std::ios_base::end);
-	int size = (int)fin.tellg();
-	fin.seekg(0, std::ios_base::beg);
-    if ( size <= 0 ) {
-        throw std::exception( "Size invalid for fx file" );
-    }
-	std::vector<char> compiledShader(size);
+	std::vector<char> compiledShader;
+	if (!LoadBinary(filename, compiledShader, &mDependencies)) {
+		throw std::exception( "Size invalid for fx file" );
+	}
 
-	fin.read(&compiledShader[0], size);
-	fin.close();
-	
-	HR(D3DX11CreateEffectFromMemory(&compiledShader[0], size, 
+	HR(D3DX11CreateEffectFromMemory(&compiledShader[0], compiledShader.size(),
 		0, device, &mFX));
+
+	// Later runs of the same binary only fetch what the table lists, by
+	// index; the first one reads every description once. Either way the
+	// handles are complete here, so lookups afterwards only read them and
+	// any thread may make them.
+	if (!mHandles.Load(mHandleFile, EffectCache::Hash(&compiledShader[0], compiledShader.size())) ||
+		!ResolveSaved()) {
+		EnumerateHandles();
+	}
 }
 
 Effect::~Effect()
 {
 	ReleaseCOM(mFX);
 }
+
+void Effect::SaveHandles()
+{
+	if (mHandles.IsDirty()) {
+		mHandles.Save(mHandleFile);
+	}
+}
+
+bool Effect::LoadBinary(const std::wstring& filename, std::vector<char>& binary,
+	std::vector<std::wstring>* dependencies)
+{
+	if (dependencies) {
+		dependencies->assign(1, filename);
+	}
+
+	const std::wstring source = SourceFor(filename);
+	uint64_t key;
+	if (EffectCache::FileExists(source) &&
+		EffectCache::SourceKey(source, CompileSalt(), key, dependencies) &&
+		CacheFor(filename).Load(key, binary)) {
+		return true;
+	}
+
+	return EffectCache::ReadFile(filename, binary) && !binary.empty();
+}
+
+bool Effect::CompileSource(const std::wstring& filename)
+{
+	const std::wstring source = SourceFor(filename);
+	const EffectCache cache = CacheFor(filename);
+
+	uint64_t key;
+	if (!EffectCache::SourceKey(source, CompileSalt(), key)) {
+		return false;
+	}
+
+	std::vector<char> binary;
+	if (cache.Load(key, binary)) {
+		return true;
+	}
+
+	ID3DBlob* compiledShader = nullptr;
+	ID3DBlob* compilationMsgs = nullptr;
+	HRESULT hr = D3DCompileFromFile(source.c_str(),
+		nullptr,
+		D3D_COMPILE_STANDARD_FILE_INCLUDE,
+		nullptr,
+		"fx_5_0",
+		CompileFlags,
+		0,
+		&compiledShader,
+		&compilationMsgs);
+
+	if (FAILED(hr) && compilationMsgs) {
+		OutputDebugStringA(static_cast<const char*>(compilationMsgs->GetBufferPointer()));
+	}
+	ReleaseCOM(compilationMsgs);
+
+	if (FAILED(hr)) {
+		return false;
+	}
+
+	cache.Store(key, compiledShader->GetBufferPointer(), compiledShader->GetBufferSize());
+	ReleaseCOM(compiledShader);
+
+	return true;
+}
+
+bool Effect::ResolveSaved()
+{
+	bool valid = true;
+
+	mHandles.ForEach(EffectHandleTable::Technique, [this, &valid](const std::string& name, uint32_t index) {
+		ID3DX11EffectTechnique* tech = mFX->GetTechniqueByIndex(index);
+		valid = valid && tech->IsValid();
+		mTechniques[name] = tech;
+	});
+
+	mHandles.ForEach(EffectHandleTable::Variable, [this, &valid](const std::string& name, uint32_t index) {
+		ID3DX11EffectVariable* var = mFX->GetVariableByIndex(index);
+		valid = valid && var->IsValid();
+		mVariables[name] = var;
+	});
+
+	return valid;
+}
+
+void Effect::EnumerateHandles()
+{
+	mHandles.Reset(mHandles.GetBinaryHash());
+	mTechniques.clear();
+	mVariables.clear();
+
+	D3DX11_EFFECT_DESC fxDesc;
+	HR(mFX->GetDesc(&fxDesc));
+
+	for (UINT i = 0; i < fxDesc.Techniques; ++i) {
+		ID3DX11EffectTechnique* tech = mFX->GetTechniqueByIndex(i);
+		D3DX11_TECHNIQUE_DESC desc;
+		if (SUCCEEDED(tech->GetDesc(&desc))) {
+			mHandles.Add(EffectHandleTable::Technique, desc.Name, i);
+			mTechniques[desc.Name] = tech;
+		}
+	}
+
+	for (UINT i = 0; i < fxDesc.GlobalVariables; ++i) {
+		ID3DX11EffectVariable* var = mFX->GetVariableByIndex(i);
+		D3DX11_EFFECT_VARIABLE_DESC desc;
+		if (SUCCEEDED(var->GetDesc(&desc))) {
+			mHandles.Add(EffectHandleTable::Variable, desc.Name, i);
+			mVariables[desc.Name] = var;
+		}
+	}
+}
+
+ID3DX11EffectTechnique* Effect::Technique(const char* name)const
+{
+	auto it = mTechniques.find(name);
+	return it != mTechniques.end() ? it->second : mFX->GetTechniqueByName(name);
+}
+
+ID3DX11EffectVariable* Effect::Variable(const char* name)const
+{
+	auto it = mVariables.find(name);
+	return it != mVariables.end() ? it->second : mFX->GetVariableByName(name);
+}
 #pragma endregion
 
 #pragma region BasicEffect
 BasicEffect::BasicEffect(ID3D11Device* device, const std::wstring& filename)
 	: Effect(device, filename)
 {
-    Light1Tech = mFX->GetTechniqueByName( "Light1" );
-    Light2Tech = mFX->GetTechniqueByName( "Light2" );
-    Light3Tech = mFX->GetTechniqueByName( "Light3" );
-
-    Light0TexTech = mFX->GetTechniqueByName( "Light0Tex" );
-    Light1TexTech = mFX->GetTechniqueByName( "Light1Tex" );
-    Light2TexTech = mFX->GetTechniqueByName( "Light2Tex" );
-    Light3TexTech = mFX->GetTechniqueByName( "Light3Tex" );
-
-    Light0TexAlphaClipTech = mFX->GetTechniqueByName( "Light0TexAlphaClip" );
-    Light1TexAlphaClipTech = mFX->GetTechniqueByName( "Light1TexAlphaClip" );
-    Light2TexAlphaClipTech = mFX->GetTechniqueByName( "Light2TexAlphaClip" );
-    Light3TexAlphaClipTech = mFX->GetTechniqueByName( "Light3TexAlphaClip" );
-
-    Light1FogTech = mFX->GetTechniqueByName( "Light1Fog" );
-    Light2FogTech = mFX->GetTechniqueByName( "Light2Fog" );
-    Light3FogTech = mFX->GetTechniqueByName( "Light3Fog" );
-
-    Light0TexFogTech = mFX->GetTechniqueByName( "Light0TexFog" );
-    Light1TexFogTech = mFX->GetTechniqueByName( "Light1TexFog" );
-    Light2TexFogTech = mFX->GetTechniqueByName( "Light2TexFog" );
-    Light3TexFogTech = mFX->GetTechniqueByName( "Light3TexFog" );
-
-    Light0TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light0TexAlphaClipFog" );
-    Light1TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light1TexAlphaClipFog" );
-    Light2TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light2TexAlphaClipFog" );
-    Light3TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light3TexAlphaClipFog" );
-
-    Light1ReflectTech = mFX->GetTechniqueByName( "Light1Reflect" );
-    Light2ReflectTech = mFX->GetTechniqueByName( "Light2Reflect" );
-    Light3ReflectTech = mFX->GetTechniqueByName( "Light3Reflect" );
-
-    Light0TexReflectTech = mFX->GetTechniqueByName( "Light0TexReflect" );
-    Light1TexReflectTech = mFX->GetTechniqueByName( "Light1TexReflect" );
-    Light2TexReflectTech = mFX->GetTechniqueByName( "Light2TexReflect" );
-    Light3TexReflectTech = mFX->GetTechniqueByName( "Light3TexReflect" );
-
-    Light0TexAlphaClipReflectTech = mFX->GetTechniqueByName( "Light0TexAlphaClipReflect" );
-    Light1TexAlphaClipReflectTech = mFX->GetTechniqueByName( "Light1TexAlphaClipReflect" );
-    Light2TexAlphaClipReflectTech = mFX->GetTechniqueByName( "Light2TexAlphaClipReflect" );
-    Light3TexAlphaClipReflectTech = mFX->GetTechniqueByName( "Light3TexAlphaClipReflect" );
-
-    Light1FogReflectTech = mFX->GetTechniqueByName( "Light1FogReflect" );
-    Light2FogReflectTech = mFX->GetTechniqueByName( "Light2FogReflect" );
-    Light3FogReflectTech = mFX->GetTechniqueByName( "Light3FogReflect" );
-
-    Light0TexFogReflectTech = mFX->GetTechniqueByName( "Light0TexFogReflect" );
-    Light1TexFogReflectTech = mFX->GetTechniqueByName( "Light1TexFogReflect" );
-    Light2TexFogReflectTech = mFX->GetTechniqueByName( "Light2TexFogReflect" );
-    Light3TexFogReflectTech = mFX->GetTechniqueByName( "Light3TexFogReflect" );
-
-    Light0TexAlphaClipFogReflectTech = mFX->GetTechniqueByName( "Light0TexAlphaClipFogReflect" );
-    Light1TexAlphaClipFogReflectTech = mFX->GetTechniqueByName( "Light1TexAlphaClipFogReflect" );
-    Light2TexAlphaClipFogReflectTech = mFX->GetTechniqueByName( "Light2TexAlphaClipFogReflect" );
-    Light3TexAlphaClipFogReflectTech = mFX->GetTechniqueByName( "Light3TexAlphaClipFogReflect" );
-
-    WorldViewProj = mFX->GetVariableByName( "gWorldViewProj" )->AsMatrix();
-    TexTransform = mFX->GetVariableByName( "gTexTransform" )->AsMatrix();
-    WorldViewProjTex = mFX->GetVariableByName( "gWorldViewProjTex" )->AsMatrix();
-    ShadowTransform = mFX->GetVariableByName( "gShadowTransform" )->AsMatrix();
-    World = mFX->GetVariableByName( "gWorld" )->AsMatrix();
-    WorldInvTranspose = mFX->GetVariableByName( "gWorldInvTranspose" )->AsMatrix();
-    EyePosW = mFX->GetVariableByName( "gEyePosW" )->AsVector();
-    FogColor = mFX->GetVariableByName( "gFogColor" )->AsVector();
-    FogStart = mFX->GetVariableByName( "gFogStart" )->AsScalar();
-    FogRange = mFX->GetVariableByName( "gFogRange" )->AsScalar();
-    DirLights = mFX->GetVariableByName( "gDirLights" );
-    Mat = mFX->GetVariableByName( "gMaterial" );
-    DiffuseMap = mFX->GetVariableByName( "gDiffuseMap" )->AsShaderResource();
-    CubeMap = mFX->GetVariableByName( "gCubeMap" )->AsShaderResource();
-    ShadowMap = mFX->GetVariableByName( "gShadowMap" )->AsShaderResource();
-    SsaoMap = mFX->GetVariableByName( "gSsaoMap" )->AsShaderResource();
+    Light1Tech = Technique( "Light1" );
+    Light2Tech = Technique( "Light2" );
+    Light3Tech = Technique( "Light3" );
+
+    Light1InstancedTech = Technique( "Light1Instanced" );
+    Light2InstancedTech = Technique( "Light2Instanced" );
+    Light3InstancedTech = Technique( "Light3Instanced" );
+    Light3TexInstancedTech = Technique( "Light3TexInstanced" );
+    Light3ReflectInstancedTech = Technique( "Light3ReflectInstanced" );
+
+    Light0TexTech = Technique( "Light0Tex" );
+    Light1TexTech = Technique( "Light1Tex" );
+    Light2TexTech = Technique( "Light2Tex" );
+    Light3TexTech = Technique( "Light3Tex" );
+
+    Light0TexAlphaClipTech = Technique( "Light0TexAlphaClip" );
+    Light1TexAlphaClipTech = Technique( "Light1TexAlphaClip" );
+    Light2TexAlphaClipTech = Technique( "Light2TexAlphaClip" );
+    Light3TexAlphaClipTech = Technique( "Light3TexAlphaClip" );
+
+    Light1FogTech = Technique( "Light1Fog" );
+    Light2FogTech = Technique( "Light2Fog" );
+    Light3FogTech = Technique( "Light3Fog" );
+
+    Light0TexFogTech = Technique( "Light0TexFog" );
+    Light1TexFogTech = Technique( "Light1TexFog" );
+    Light2TexFogTech = Technique( "Light2TexFog" );
+    Light3TexFogTech = Technique( "Light3TexFog" );
+
+    Light0TexAlphaClipFogTech = Technique( "Light0TexAlphaClipFog" );
+    Light1TexAlphaClipFogTech = Technique( "Light1TexAlphaClipFog" );
+    Light2TexAlphaClipFogTech = Technique( "Light2TexAlphaClipFog" );
+    Light3TexAlphaClipFogTech = Technique( "Light3TexAlphaClipFog" );
+
+    Light1ReflectTech = Technique( "Light1Reflect" );
+    Light2ReflectTech = Technique( "Light2Reflect" );
+    Light3ReflectTech = Technique( "Light3Reflect" );
+
+    Light0TexReflectTech = Technique( "Light0TexReflect" );
+    Light1TexReflectTech = Technique( "Light1TexReflect" );
+    Light2TexReflectTech = Technique( "Light2TexReflect" );
+    Light3TexReflectTech = Technique( "Light3TexReflect" );
+
+    Light0TexAlphaClipReflectTech = Technique( "Light0TexAlphaClipReflect" );
+    Light1TexAlphaClipReflectTech = Technique( "Light1TexAlphaClipReflect" );
+    Light2TexAlphaClipReflectTech = Technique( "Light2TexAlphaClipReflect" );
+    Light3TexAlphaClipReflectTech = Technique( "Light3TexAlphaClipReflect" );
+
+    Light1FogReflectTech = Technique( "Light1FogReflect" );
+    Light2FogReflectTech = Technique( "Light2FogReflect" );
+    Light3FogReflectTech = Technique( "Light3FogReflect" );
+
+    Light0TexFogReflectTech = Technique( "Light0TexFogReflect" );
+    Light1TexFogReflectTech = Technique( "Light1TexFogReflect" );
+    Light2TexFogReflectTech = Technique( "Light2TexFogReflect" );
+    Light3TexFogReflectTech = Technique( "Light3TexFogReflect" );
+
+    Light0TexAlphaClipFogReflectTech = Technique( "Light0TexAlphaClipFogReflect" );
+    Light1TexAlphaClipFogReflectTech = Technique( "Light1TexAlphaClipFogReflect" );
+    Light2TexAlphaClipFogReflectTech = Technique( "Light2TexAlphaClipFogReflect" );
+    Light3TexAlphaClipFogReflectTech = Technique( "Light3TexAlphaClipFogReflect" );
+
+    WorldViewProj = Variable( "gWorldViewProj" )->AsMatrix();
+    TexTransform = Variable( "gTexTransform" )->AsMatrix();
+    WorldViewProjTex = Variable( "gWorldViewProjTex" )->AsMatrix();
+    ShadowTransform = Variable( "gShadowTransform" )->AsMatrix();
+    World = Variable( "gWorld" )->AsMatrix();
+    WorldInvTranspose = Variable( "gWorldInvTranspose" )->AsMatrix();
+    EyePosW = Variable( "gEyePosW" )->AsVector();
+    FogColor = Variable( "gFogColor" )->AsVector();
+    FogStart = Variable( "gFogStart" )->AsScalar();
+    FogRange = Variable( "gFogRange" )->AsScalar();
+    DirLights = Variable( "gDirLights" );
+    Mat = Variable( "gMaterial" );
+    DiffuseMap = Variable( "gDiffuseMap" )->AsShaderResource();
+    CubeMap = Variable( "gCubeMap" )->AsShaderResource();
+    ShadowMap = Variable( "gShadowMap" )->AsShaderResource();
+    SsaoMap = Variable( "gSsaoMap" )->AsShaderResource();
+
+    // The cbuffers are bound on the first Apply(): binding one directly
+    // replaces the effect's own buffer, which would leave demos that only
+    // use the setters above writing to a buffer nothing draws from.
+    mPerObjectBuffer.Create( device, sizeof( CBPerObject ) );
+    mStaged = false;
 }
 
 BasicEffect::~BasicEffect()
 {
 }
+
+void BasicEffect::Apply( ID3DX11EffectPass* pass, ID3D11DeviceContext* context )
+{
+    if ( !mStaged ) {
+        mPerFrame.Bind( mFX, CBPerFrame::Layout(), &Effects::PerFrameBuffer );
+        mPerObject.Bind( mFX, CBPerObject::Layout(), &mPerObjectBuffer );
+        mStaged = true;
+    }
+
+    mPerFrame.Flush( context, Effects::PerFrame );
+    mPerObject.Flush( context, PerObject );
+
+    pass->Apply( 0, context );
+}
 #pragma endregion
 
 #pragma region TreeSpriteEffect
 TreeSpriteEffect::TreeSpriteEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    Light3Tech = mFX->GetTechniqueByName( "Light3" );
-    Light3TexAlphaClipTech = mFX->GetTechniqueByName( "Light3TexAlphaClip" );
-    Light3TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light3TexAlphaClipFog" );
+    Light3Tech = Technique( "Light3" );
+    Light3TexAlphaClipTech = Technique( "Light3TexAlphaClip" );
+    Light3TexAlphaClipFogTech = Technique( "Light3TexAlphaClipFog" );
 
-    ViewProj = mFX->GetVariableByName( "gViewProj" )->AsMatrix();
-    EyePosW = mFX->GetVariableByName( "gEyePosW" )->AsVector();
-    FogColor = mFX->GetVariableByName( "gFogColor" )->AsVector();
-    FogStart = mFX->GetVariableByName( "gFogStart" )->AsScalar();
-    FogRange = mFX->GetVariableByName( "gFogRange" )->AsScalar();
-    DirLights = mFX->GetVariableByName( "gDirLights" );
-    Mat = mFX->GetVariableByName( "gMaterial" );
-    TreeTextureMapArray = mFX->GetVariableByName( "gTreeMapArray" )->AsShaderResource();
+    ViewProj = Variable( "gViewProj" )->AsMatrix();
+    EyePosW = Variable( "gEyePosW" )->AsVector();
+    FogColor = Variable( "gFogColor" )->AsVector();
+    FogStart = Variable( "gFogStart" )->AsScalar();
+    FogRange = Variable( "gFogRange" )->AsScalar();
+    DirLights = Variable( "gDirLights" );
+    Mat = Variable( "gMaterial" );
+    TreeTextureMapArray = Variable( "gTreeMapArray" )->AsShaderResource();
 }
 
 TreeSpriteEffect::~TreeSpriteEffect()
@@ -141,12 +426,15 @@ TreeSpriteEffect::~TreeSpriteEffect()
 BlurEffect::BlurEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    HorzBlurTech = mFX->GetTechniqueByName( "HorzBlur" );
-    VertBlurTech = mFX->GetTechniqueByName( "VertBlur" );
+    HorzBlurTech = Technique( "HorzBlur" );
+    VertBlurTech = Technique( "VertBlur" );
+    HorzBoxBlurTech = Technique( "HorzBoxBlur" );
+    VertBoxBlurTech = Technique( "VertBoxBlur" );
 
-    Weights = mFX->GetVariableByName( "gWeights" )->AsScalar();
-    InputMap = mFX->GetVariableByName( "gInput" )->AsShaderResource();
-    OutputMap = mFX->GetVariableByName( "gOutput" )->AsUnorderedAccessView();
+    Weights = Variable( "gWeights" )->AsScalar();
+    BoxRadius = Variable( "gBoxRadius" )->AsScalar();
+    InputMap = Variable( "gInput" )->AsShaderResource();
+    OutputMap = Variable( "gOutput" )->AsUnorderedAccessView();
 }
 
 BlurEffect::~BlurEffect()
@@ -158,19 +446,20 @@ BlurEffect::~BlurEffect()
 BezierTessellationEffect::BezierTessellationEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    TessTech = mFX->GetTechniqueByName( "Tess" );
+    TessTech = Technique( "Tess" );
 
-    WorldViewProj = mFX->GetVariableByName( "gWorldViewProj" )->AsMatrix();
-    World = mFX->GetVariableByName( "gWorld" )->AsMatrix();
-    WorldInvTranspose = mFX->GetVariableByName( "gWorldInvTranspose" )->AsMatrix();
-    TexTransform = mFX->GetVariableByName( "gTexTransform" )->AsMatrix();
-    EyePosW = mFX->GetVariableByName( "gEyePosW" )->AsVector();
-    FogColor = mFX->GetVariableByName( "gFogColor" )->AsVector();
-    FogStart = mFX->GetVariableByName( "gFogStart" )->AsScalar();
-    FogRange = mFX->GetVariableByName( "gFogRange" )->AsScalar();
-    DirLights = mFX->GetVariableByName( "gDirLights" );
-    Mat = mFX->GetVariableByName( "gMaterial" );
-    DiffuseMap = mFX->GetVariableByName( "gDiffuseMap" )->AsShaderResource();
+    WorldViewProj = Variable( "gWorldViewProj" )->AsMatrix();
+    World = Variable( "gWorld" )->AsMatrix();
+    WorldInvTranspose = Variable( "gWorldInvTranspose" )->AsMatrix();
+    TexTransform = Variable( "gTexTransform" )->AsMatrix();
+    EyePosW = Variable( "gEyePosW" )->AsVector();
+    FogColor = Variable( "gFogColor" )->AsVector();
+    FogStart = Variable( "gFogStart" )->AsScalar();
+    FogRange = Variable( "gFogRange" )->AsScalar();
+    DirLights = Variable( "gDirLights" );
+    Mat = Variable( "gMaterial" );
+    DiffuseMap = Variable( "gDiffuseMap" )->AsShaderResource();
+    PatchFactors = Variable( "gPatchFactors" )->AsShaderResource();
 }
 
 BezierTessellationEffect::~BezierTessellationEffect()
@@ -182,45 +471,45 @@ BezierTessellationEffect::~BezierTessellationEffect()
 InstancedBasicEffect::InstancedBasicEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    Light1Tech = mFX->GetTechniqueByName( "Light1" );
-    Light2Tech = mFX->GetTechniqueByName( "Light2" );
-    Light3Tech = mFX->GetTechniqueByName( "Light3" );
-
-    Light0TexTech = mFX->GetTechniqueByName( "Light0Tex" );
-    Light1TexTech = mFX->GetTechniqueByName( "Light1Tex" );
-    Light2TexTech = mFX->GetTechniqueByName( "Light2Tex" );
-    Light3TexTech = mFX->GetTechniqueByName( "Light3Tex" );
-
-    Light0TexAlphaClipTech = mFX->GetTechniqueByName( "Light0TexAlphaClip" );
-    Light1TexAlphaClipTech = mFX->GetTechniqueByName( "Light1TexAlphaClip" );
-    Light2TexAlphaClipTech = mFX->GetTechniqueByName( "Light2TexAlphaClip" );
-    Light3TexAlphaClipTech = mFX->GetTechniqueByName( "Light3TexAlphaClip" );
-
-    Light1FogTech = mFX->GetTechniqueByName( "Light1Fog" );
-    Light2FogTech = mFX->GetTechniqueByName( "Light2Fog" );
-    Light3FogTech = mFX->GetTechniqueByName( "Light3Fog" );
-
-    Light0TexFogTech = mFX->GetTechniqueByName( "Light0TexFog" );
-    Light1TexFogTech = mFX->GetTechniqueByName( "Light1TexFog" );
-    Light2TexFogTech = mFX->GetTechniqueByName( "Light2TexFog" );
-    Light3TexFogTech = mFX->GetTechniqueByName( "Light3TexFog" );
-
-    Light0TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light0TexAlphaClipFog" );
-    Light1TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light1TexAlphaClipFog" );
-    Light2TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light2TexAlphaClipFog" );
-    Light3TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light3TexAlphaClipFog" );
-
-    ViewProj = mFX->GetVariableByName( "gViewProj" )->AsMatrix();
-    World = mFX->GetVariableByName( "gWorld" )->AsMatrix();
-    WorldInvTranspose = mFX->GetVariableByName( "gWorldInvTranspose" )->AsMatrix();
-    TexTransform = mFX->GetVariableByName( "gTexTransform" )->AsMatrix();
-    EyePosW = mFX->GetVariableByName( "gEyePosW" )->AsVector();
-    FogColor = mFX->GetVariableByName( "gFogColor" )->AsVector();
-    FogStart = mFX->GetVariableByName( "gFogStart" )->AsScalar();
-    FogRange = mFX->GetVariableByName( "gFogRange" )->AsScalar();
-    DirLights = mFX->GetVariableByName( "gDirLights" );
-    Mat = mFX->GetVariableByName( "gMaterial" );
-    DiffuseMap = mFX->GetVariableByName( "gDiffuseMap" )->AsShaderResource();
+    Light1Tech = Technique( "Light1" );
+    Light2Tech = Technique( "Light2" );
+    Light3Tech = Technique( "Light3" );
+
+    Light0TexTech = Technique( "Light0Tex" );
+    Light1TexTech = Technique( "Light1Tex" );
+    Light2TexTech = Technique( "Light2Tex" );
+    Light3TexTech = Technique( "Light3Tex" );
+
+    Light0TexAlphaClipTech = Technique( "Light0TexAlphaClip" );
+    Light1TexAlphaClipTech = Technique( "Light1TexAlphaClip" );
+    Light2TexAlphaClipTech = Technique( "Light2TexAlphaClip" );
+    Light3TexAlphaClipTech = Technique( "Light3TexAlphaClip" );
+
+    Light1FogTech = Technique( "Light1Fog" );
+    Light2FogTech = Technique( "Light2Fog" );
+    Light3FogTech = Technique( "Light3Fog" );
+
+    Light0TexFogTech = Technique( "Light0TexFog" );
+    Light1TexFogTech = Technique( "Light1TexFog" );
+    Light2TexFogTech = Technique( "Light2TexFog" );
+    Light3TexFogTech = Technique( "Light3TexFog" );
+
+    Light0TexAlphaClipFogTech = Technique( "Light0TexAlphaClipFog" );
+    Light1TexAlphaClipFogTech = Technique( "Light1TexAlphaClipFog" );
+    Light2TexAlphaClipFogTech = Technique( "Light2TexAlphaClipFog" );
+    Light3TexAlphaClipFogTech = Technique( "Light3TexAlphaClipFog" );
+
+    ViewProj = Variable( "gViewProj" )->AsMatrix();
+    World = Variable( "gWorld" )->AsMatrix();
+    WorldInvTranspose = Variable( "gWorldInvTranspose" )->AsMatrix();
+    TexTransform = Variable( "gTexTransform" )->AsMatrix();
+    EyePosW = Variable( "gEyePosW" )->AsVector();
+    FogColor = Variable( "gFogColor" )->AsVector();
+    FogStart = Variable( "gFogStart" )->AsScalar();
+    FogRange = Variable( "gFogRange" )->AsScalar();
+    DirLights = Variable( "gDirLights" );
+    Mat = Variable( "gMaterial" );
+    DiffuseMap = Variable( "gDiffuseMap" )->AsShaderResource();
 }
 
 InstancedBasicEffect::~InstancedBasicEffect()
@@ -232,9 +521,9 @@ InstancedBasicEffect::~InstancedBasicEffect()
 SkyEffect::SkyEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    SkyTech = mFX->GetTechniqueByName( "SkyTech" );
-    WorldViewProj = mFX->GetVariableByName( "gWorldViewProj" )->AsMatrix();
-    CubeMap = mFX->GetVariableByName( "gCubeMap" )->AsShaderResource();
+    SkyTech = Technique( "SkyTech" );
+    WorldViewProj = Variable( "gWorldViewProj" )->AsMatrix();
+    CubeMap = Variable( "gCubeMap" )->AsShaderResource();
 }
 
 SkyEffect::~SkyEffect()
@@ -246,79 +535,79 @@ SkyEffect::~SkyEffect()
 NormalMapEffect::NormalMapEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    Light1Tech = mFX->GetTechniqueByName( "Light1" );
-    Light2Tech = mFX->GetTechniqueByName( "Light2" );
-    Light3Tech = mFX->GetTechniqueByName( "Light3" );
-
-    Light0TexTech = mFX->GetTechniqueByName( "Light0Tex" );
-    Light1TexTech = mFX->GetTechniqueByName( "Light1Tex" );
-    Light2TexTech = mFX->GetTechniqueByName( "Light2Tex" );
-    Light3TexTech = mFX->GetTechniqueByName( "Light3Tex" );
-
-    Light0TexAlphaClipTech = mFX->GetTechniqueByName( "Light0TexAlphaClip" );
-    Light1TexAlphaClipTech = mFX->GetTechniqueByName( "Light1TexAlphaClip" );
-    Light2TexAlphaClipTech = mFX->GetTechniqueByName( "Light2TexAlphaClip" );
-    Light3TexAlphaClipTech = mFX->GetTechniqueByName( "Light3TexAlphaClip" );
-
-    Light1FogTech = mFX->GetTechniqueByName( "Light1Fog" );
-    Light2FogTech = mFX->GetTechniqueByName( "Light2Fog" );
-    Light3FogTech = mFX->GetTechniqueByName( "Light3Fog" );
-
-    Light0TexFogTech = mFX->GetTechniqueByName( "Light0TexFog" );
-    Light1TexFogTech = mFX->GetTechniqueByName( "Light1TexFog" );
-    Light2TexFogTech = mFX->GetTechniqueByName( "Light2TexFog" );
-    Light3TexFogTech = mFX->GetTechniqueByName( "Light3TexFog" );
-
-    Light0TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light0TexAlphaClipFog" );
-    Light1TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light1TexAlphaClipFog" );
-    Light2TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light2TexAlphaClipFog" );
-    Light3TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light3TexAlphaClipFog" );
-
-    Light1ReflectTech = mFX->GetTechniqueByName( "Light1Reflect" );
-    Light2ReflectTech = mFX->GetTechniqueByName( "Light2Reflect" );
-    Light3ReflectTech = mFX->GetTechniqueByName( "Light3Reflect" );
-
-    Light0TexReflectTech = mFX->GetTechniqueByName( "Light0TexReflect" );
-    Light1TexReflectTech = mFX->GetTechniqueByName( "Light1TexReflect" );
-    Light2TexReflectTech = mFX->GetTechniqueByName( "Light2TexReflect" );
-    Light3TexReflectTech = mFX->GetTechniqueByName( "Light3TexReflect" );
-
-    Light0TexAlphaClipReflectTech = mFX->GetTechniqueByName( "Light0TexAlphaClipReflect" );
-    Light1TexAlphaClipReflectTech = mFX->GetTechniqueByName( "Light1TexAlphaClipReflect" );
-    Light2TexAlphaClipReflectTech = mFX->GetTechniqueByName( "Light2TexAlphaClipReflect" );
-    Light3TexAlphaClipReflectTech = mFX->GetTechniqueByName( "Light3TexAlphaClipReflect" );
-
-    Light1FogReflectTech = mFX->GetTechniqueByName( "Light1FogReflect" );
-    Light2FogReflectTech = mFX->GetTechniqueByName( "Light2FogReflect" );
-    Light3FogReflectTech = mFX->GetTechniqueByName( "Light3FogReflect" );
-
-    Light0TexFogReflectTech = mFX->GetTechniqueByName( "Light0TexFogReflect" );
-    Light1TexFogReflectTech = mFX->GetTechniqueByName( "Light1TexFogReflect" );
-    Light2TexFogReflectTech = mFX->GetTechniqueByName( "Light2TexFogReflect" );
-    Light3TexFogReflectTech = mFX->GetTechniqueByName( "Light3TexFogReflect" );
-
-    Light0TexAlphaClipFogReflectTech = mFX->GetTechniqueByName( "Light0TexAlphaClipFogReflect" );
-    Light1TexAlphaClipFogReflectTech = mFX->GetTechniqueByName( "Light1TexAlphaClipFogReflect" );
-    Light2TexAlphaClipFogReflectTech = mFX->GetTechniqueByName( "Light2TexAlphaClipFogReflect" );
-    Light3TexAlphaClipFogReflectTech = mFX->GetTechniqueByName( "Light3TexAlphaClipFogReflect" );
-
-    WorldViewProj = mFX->GetVariableByName( "gWorldViewProj" )->AsMatrix();
-    World = mFX->GetVariableByName( "gWorld" )->AsMatrix();
-    WorldInvTranspose = mFX->GetVariableByName( "gWorldInvTranspose" )->AsMatrix();
-    TexTransform = mFX->GetVariableByName( "gTexTransform" )->AsMatrix();
-    WorldViewProjTex = mFX->GetVariableByName( "gWorldViewProjTex" )->AsMatrix();
-    ShadowTransform = mFX->GetVariableByName( "gShadowTransform" )->AsMatrix();
-    EyePosW = mFX->GetVariableByName( "gEyePosW" )->AsVector();
-    FogColor = mFX->GetVariableByName( "gFogColor" )->AsVector();
-    FogStart = mFX->GetVariableByName( "gFogStart" )->AsScalar();
-    FogRange = mFX->GetVariableByName( "gFogRange" )->AsScalar();
-    DirLights = mFX->GetVariableByName( "gDirLights" );
-    Mat = mFX->GetVariableByName( "gMaterial" );
-    DiffuseMap = mFX->GetVariableByName( "gDiffuseMap" )->AsShaderResource();
-    CubeMap = mFX->GetVariableByName( "gCubeMap" )->AsShaderResource();
-    NormalMap = mFX->GetVariableByName( "gNormalMap" )->AsShaderResource();
-    ShadowMap = mFX->GetVariableByName( "gShadowMap" )->AsShaderResource();
-    SsaoMap = mFX->GetVariableByName( "gSsaoMap" )->AsShaderResource();
+    Light1Tech = Technique( "Light1" );
+    Light2Tech = Technique( "Light2" );
+    Light3Tech = Technique( "Light3" );
+
+    Light0TexTech = Technique( "Light0Tex" );
+    Light1TexTech = Technique( "Light1Tex" );
+    Light2TexTech = Technique( "Light2Tex" );
+    Light3TexTech = Technique( "Light3Tex" );
+
+    Light0TexAlphaClipTech = Technique( "Light0TexAlphaClip" );
+    Light1TexAlphaClipTech = Technique( "Light1TexAlphaClip" );
+    Light2TexAlphaClipTech = Technique( "Light2TexAlphaClip" );
+    Light3TexAlphaClipTech = Technique( "Light3TexAlphaClip" );
+
+    Light1FogTech = Technique( "Light1Fog" );
+    Light2FogTech = Technique( "Light2Fog" );
+    Light3FogTech = Technique( "Light3Fog" );
+
+    Light0TexFogTech = Technique( "Light0TexFog" );
+    Light1TexFogTech = Technique( "Light1TexFog" );
+    Light2TexFogTech = Technique( "Light2TexFog" );
+    Light3TexFogTech = Technique( "Light3TexFog" );
+
+    Light0TexAlphaClipFogTech = Technique( "Light0TexAlphaClipFog" );
+    Light1TexAlphaClipFogTech = Technique( "Light1TexAlphaClipFog" );
+    Light2TexAlphaClipFogTech = Technique( "Light2TexAlphaClipFog" );
+    Light3TexAlphaClipFogTech = Technique( "Light3TexAlphaClipFog" );
+
+    Light1ReflectTech = Technique( "Light1Reflect" );
+    Light2ReflectTech = Technique( "Light2Reflect" );
+    Light3ReflectTech = Technique( "Light3Reflect" );
+
+    Light0TexReflectTech = Technique( "Light0TexReflect" );
+    Light1TexReflectTech = Technique( "Light1TexReflect" );
+    Light2TexReflectTech = Technique( "Light2TexReflect" );
+    Light3TexReflectTech = Technique( "Light3TexReflect" );
+
+    Light0TexAlphaClipReflectTech = Technique( "Light0TexAlphaClipReflect" );
+    Light1TexAlphaClipReflectTech = Technique( "Light1TexAlphaClipReflect" );
+    Light2TexAlphaClipReflectTech = Technique( "Light2TexAlphaClipReflect" );
+    Light3TexAlphaClipReflectTech = Technique( "Light3TexAlphaClipReflect" );
+
+    Light1FogReflectTech = Technique( "Light1FogReflect" );
+    Light2FogReflectTech = Technique( "Light2FogReflect" );
+    Light3FogReflectTech = Technique( "Light3FogReflect" );
+
+    Light0TexFogReflectTech = Technique( "Light0TexFogReflect" );
+    Light1TexFogReflectTech = Technique( "Light1TexFogReflect" );
+    Light2TexFogReflectTech = Technique( "Light2TexFogReflect" );
+    Light3TexFogReflectTech = Technique( "Light3TexFogReflect" );
+
+    Light0TexAlphaClipFogReflectTech = Technique( "Light0TexAlphaClipFogReflect" );
+    Light1TexAlphaClipFogReflectTech = Technique( "Light1TexAlphaClipFogReflect" );
+    Light2TexAlphaClipFogReflectTech = Technique( "Light2TexAlphaClipFogReflect" );
+    Light3TexAlphaClipFogReflectTech = Technique( "Light3TexAlphaClipFogReflect" );
+
+    WorldViewProj = Variable( "gWorldViewProj" )->AsMatrix();
+    World = Variable( "gWorld" )->AsMatrix();
+    WorldInvTranspose = Variable( "gWorldInvTranspose" )->AsMatrix();
+    TexTransform = Variable( "gTexTransform" )->AsMatrix();
+    WorldViewProjTex = Variable( "gWorldViewProjTex" )->AsMatrix();
+    ShadowTransform = Variable( "gShadowTransform" )->AsMatrix();
+    EyePosW = Variable( "gEyePosW" )->AsVector();
+    FogColor = Variable( "gFogColor" )->AsVector();
+    FogStart = Variable( "gFogStart" )->AsScalar();
+    FogRange = Variable( "gFogRange" )->AsScalar();
+    DirLights = Variable( "gDirLights" );
+    Mat = Variable( "gMaterial" );
+    DiffuseMap = Variable( "gDiffuseMap" )->AsShaderResource();
+    CubeMap = Variable( "gCubeMap" )->AsShaderResource();
+    NormalMap = Variable( "gNormalMap" )->AsShaderResource();
+    ShadowMap = Variable( "gShadowMap" )->AsShaderResource();
+    SsaoMap = Variable( "gSsaoMap" )->AsShaderResource();
 }
 
 NormalMapEffect::~NormalMapEffect()
@@ -330,83 +619,83 @@ NormalMapEffect::~NormalMapEffect()
 DisplacementMapEffect::DisplacementMapEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    Light1Tech = mFX->GetTechniqueByName( "Light1" );
-    Light2Tech = mFX->GetTechniqueByName( "Light2" );
-    Light3Tech = mFX->GetTechniqueByName( "Light3" );
-
-    Light0TexTech = mFX->GetTechniqueByName( "Light0Tex" );
-    Light1TexTech = mFX->GetTechniqueByName( "Light1Tex" );
-    Light2TexTech = mFX->GetTechniqueByName( "Light2Tex" );
-    Light3TexTech = mFX->GetTechniqueByName( "Light3Tex" );
-
-    Light0TexAlphaClipTech = mFX->GetTechniqueByName( "Light0TexAlphaClip" );
-    Light1TexAlphaClipTech = mFX->GetTechniqueByName( "Light1TexAlphaClip" );
-    Light2TexAlphaClipTech = mFX->GetTechniqueByName( "Light2TexAlphaClip" );
-    Light3TexAlphaClipTech = mFX->GetTechniqueByName( "Light3TexAlphaClip" );
-
-    Light1FogTech = mFX->GetTechniqueByName( "Light1Fog" );
-    Light2FogTech = mFX->GetTechniqueByName( "Light2Fog" );
-    Light3FogTech = mFX->GetTechniqueByName( "Light3Fog" );
-
-    Light0TexFogTech = mFX->GetTechniqueByName( "Light0TexFog" );
-    Light1TexFogTech = mFX->GetTechniqueByName( "Light1TexFog" );
-    Light2TexFogTech = mFX->GetTechniqueByName( "Light2TexFog" );
-    Light3TexFogTech = mFX->GetTechniqueByName( "Light3TexFog" );
-
-    Light0TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light0TexAlphaClipFog" );
-    Light1TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light1TexAlphaClipFog" );
-    Light2TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light2TexAlphaClipFog" );
-    Light3TexAlphaClipFogTech = mFX->GetTechniqueByName( "Light3TexAlphaClipFog" );
-
-    Light1ReflectTech = mFX->GetTechniqueByName( "Light1Reflect" );
-    Light2ReflectTech = mFX->GetTechniqueByName( "Light2Reflect" );
-    Light3ReflectTech = mFX->GetTechniqueByName( "Light3Reflect" );
-
-    Light0TexReflectTech = mFX->GetTechniqueByName( "Light0TexReflect" );
-    Light1TexReflectTech = mFX->GetTechniqueByName( "Light1TexReflect" );
-    Light2TexReflectTech = mFX->GetTechniqueByName( "Light2TexReflect" );
-    Light3TexReflectTech = mFX->GetTechniqueByName( "Light3TexReflect" );
-
-    Light0TexAlphaClipReflectTech = mFX->GetTechniqueByName( "Light0TexAlphaClipReflect" );
-    Light1TexAlphaClipReflectTech = mFX->GetTechniqueByName( "Light1TexAlphaClipReflect" );
-    Light2TexAlphaClipReflectTech = mFX->GetTechniqueByName( "Light2TexAlphaClipReflect" );
-    Light3TexAlphaClipReflectTech = mFX->GetTechniqueByName( "Light3TexAlphaClipReflect" );
-
-    Light1FogReflectTech = mFX->GetTechniqueByName( "Light1FogReflect" );
-    Light2FogReflectTech = mFX->GetTechniqueByName( "Light2FogReflect" );
-    Light3FogReflectTech = mFX->GetTechniqueByName( "Light3FogReflect" );
-
-    Light0TexFogReflectTech = mFX->GetTechniqueByName( "Light0TexFogReflect" );
-    Light1TexFogReflectTech = mFX->GetTechniqueByName( "Light1TexFogReflect" );
-    Light2TexFogReflectTech = mFX->GetTechniqueByName( "Light2TexFogReflect" );
-    Light3TexFogReflectTech = mFX->GetTechniqueByName( "Light3TexFogReflect" );
-
-    Light0TexAlphaClipFogReflectTech = mFX->GetTechniqueByName( "Light0TexAlphaClipFogReflect" );
-    Light1TexAlphaClipFogReflectTech = mFX->GetTechniqueByName( "Light1TexAlphaClipFogReflect" );
-    Light2TexAlphaClipFogReflectTech = mFX->GetTechniqueByName( "Light2TexAlphaClipFogReflect" );
-    Light3TexAlphaClipFogReflectTech = mFX->GetTechniqueByName( "Light3TexAlphaClipFogReflect" );
-
-    ViewProj = mFX->GetVariableByName( "gViewProj" )->AsMatrix();
-    WorldViewProj = mFX->GetVariableByName( "gWorldViewProj" )->AsMatrix();
-    World = mFX->GetVariableByName( "gWorld" )->AsMatrix();
-    WorldInvTranspose = mFX->GetVariableByName( "gWorldInvTranspose" )->AsMatrix();
-    TexTransform = mFX->GetVariableByName( "gTexTransform" )->AsMatrix();
-    ShadowTransform = mFX->GetVariableByName( "gShadowTransform" )->AsMatrix();
-    EyePosW = mFX->GetVariableByName( "gEyePosW" )->AsVector();
-    FogColor = mFX->GetVariableByName( "gFogColor" )->AsVector();
-    FogStart = mFX->GetVariableByName( "gFogStart" )->AsScalar();
-    FogRange = mFX->GetVariableByName( "gFogRange" )->AsScalar();
-    DirLights = mFX->GetVariableByName( "gDirLights" );
-    Mat = mFX->GetVariableByName( "gMaterial" );
-    HeightScale = mFX->GetVariableByName( "gHeightScale" )->AsScalar();
-    MaxTessDistance = mFX->GetVariableByName( "gMaxTessDistance" )->AsScalar();
-    MinTessDistance = mFX->GetVariableByName( "gMinTessDistance" )->AsScalar();
-    MinTessFactor = mFX->GetVariableByName( "gMinTessFactor" )->AsScalar();
-    MaxTessFactor = mFX->GetVariableByName( "gMaxTessFactor" )->AsScalar();
-    DiffuseMap = mFX->GetVariableByName( "gDiffuseMap" )->AsShaderResource();
-    CubeMap = mFX->GetVariableByName( "gCubeMap" )->AsShaderResource();
-    NormalMap = mFX->GetVariableByName( "gNormalMap" )->AsShaderResource();
-    ShadowMap = mFX->GetVariableByName( "gShadowMap" )->AsShaderResource();
+    Light1Tech = Technique( "Light1" );
+    Light2Tech = Technique( "Light2" );
+    Light3Tech = Technique( "Light3" );
+
+    Light0TexTech = Technique( "Light0Tex" );
+    Light1TexTech = Technique( "Light1Tex" );
+    Light2TexTech = Technique( "Light2Tex" );
+    Light3TexTech = Technique( "Light3Tex" );
+
+    Light0TexAlphaClipTech = Technique( "Light0TexAlphaClip" );
+    Light1TexAlphaClipTech = Technique( "Light1TexAlphaClip" );
+    Light2TexAlphaClipTech = Technique( "Light2TexAlphaClip" );
+    Light3TexAlphaClipTech = Technique( "Light3TexAlphaClip" );
+
+    Light1FogTech = Technique( "Light1Fog" );
+    Light2FogTech = Technique( "Light2Fog" );
+    Light3FogTech = Technique( "Light3Fog" );
+
+    Light0TexFogTech = Technique( "Light0TexFog" );
+    Light1TexFogTech = Technique( "Light1TexFog" );
+    Light2TexFogTech = Technique( "Light2TexFog" );
+    Light3TexFogTech = Technique( "Light3TexFog" );
+
+    Light0TexAlphaClipFogTech = Technique( "Light0TexAlphaClipFog" );
+    Light1TexAlphaClipFogTech = Technique( "Light1TexAlphaClipFog" );
+    Light2TexAlphaClipFogTech = Technique( "Light2TexAlphaClipFog" );
+    Light3TexAlphaClipFogTech = Technique( "Light3TexAlphaClipFog" );
+
+    Light1ReflectTech = Technique( "Light1Reflect" );
+    Light2ReflectTech = Technique( "Light2Reflect" );
+    Light3ReflectTech = Technique( "Light3Reflect" );
+
+    Light0TexReflectTech = Technique( "Light0TexReflect" );
+    Light1TexReflectTech = Technique( "Light1TexReflect" );
+    Light2TexReflectTech = Technique( "Light2TexReflect" );
+    Light3TexReflectTech = Technique( "Light3TexReflect" );
+
+    Light0TexAlphaClipReflectTech = Technique( "Light0TexAlphaClipReflect" );
+    Light1TexAlphaClipReflectTech = Technique( "Light1TexAlphaClipReflect" );
+    Light2TexAlphaClipReflectTech = Technique( "Light2TexAlphaClipReflect" );
+    Light3TexAlphaClipReflectTech = Technique( "Light3TexAlphaClipReflect" );
+
+    Light1FogReflectTech = Technique( "Light1FogReflect" );
+    Light2FogReflectTech = Technique( "Light2FogReflect" );
+    Light3FogReflectTech = Technique( "Light3FogReflect" );
+
+    Light0TexFogReflectTech = Technique( "Light0TexFogReflect" );
+    Light1TexFogReflectTech = Technique( "Light1TexFogReflect" );
+    Light2TexFogReflectTech = Technique( "Light2TexFogReflect" );
+    Light3TexFogReflectTech = Technique( "Light3TexFogReflect" );
+
+    Light0TexAlphaClipFogReflectTech = Technique( "Light0TexAlphaClipFogReflect" );
+    Light1TexAlphaClipFogReflectTech = Technique( "Light1TexAlphaClipFogReflect" );
+    Light2TexAlphaClipFogReflectTech = Technique( "Light2TexAlphaClipFogReflect" );
+    Light3TexAlphaClipFogReflectTech = Technique( "Light3TexAlphaClipFogReflect" );
+
+    ViewProj = Variable( "gViewProj" )->AsMatrix();
+    WorldViewProj = Variable( "gWorldViewProj" )->AsMatrix();
+    World = Variable( "gWorld" )->AsMatrix();
+    WorldInvTranspose = Variable( "gWorldInvTranspose" )->AsMatrix();
+    TexTransform = Variable( "gTexTransform" )->AsMatrix();
+    ShadowTransform = Variable( "gShadowTransform" )->AsMatrix();
+    EyePosW = Variable( "gEyePosW" )->AsVector();
+    FogColor = Variable( "gFogColor" )->AsVector();
+    FogStart = Variable( "gFogStart" )->AsScalar();
+    FogRange = Variable( "gFogRange" )->AsScalar();
+    DirLights = Variable( "gDirLights" );
+    Mat = Variable( "gMaterial" );
+    HeightScale = Variable( "gHeightScale" )->AsScalar();
+    MaxTessDistance = Variable( "gMaxTessDistance" )->AsScalar();
+    MinTessDistance = Variable( "gMinTessDistance" )->AsScalar();
+    MinTessFactor = Variable( "gMinTessFactor" )->AsScalar();
+    MaxTessFactor = Variable( "gMaxTessFactor" )->AsScalar();
+    DiffuseMap = Variable( "gDiffuseMap" )->AsShaderResource();
+    CubeMap = Variable( "gCubeMap" )->AsShaderResource();
+    NormalMap = Variable( "gNormalMap" )->AsShaderResource();
+    ShadowMap = Variable( "gShadowMap" )->AsShaderResource();
 }
 
 DisplacementMapEffect::~DisplacementMapEffect()
@@ -418,33 +707,29 @@ DisplacementMapEffect::~DisplacementMapEffect()
 TerrainEffect::TerrainEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    Light1Tech = mFX->GetTechniqueByName( "Light1" );
-    Light2Tech = mFX->GetTechniqueByName( "Light2" );
-    Light3Tech = mFX->GetTechniqueByName( "Light3" );
-    Light1FogTech = mFX->GetTechniqueByName( "Light1Fog" );
-    Light2FogTech = mFX->GetTechniqueByName( "Light2Fog" );
-    Light3FogTech = mFX->GetTechniqueByName( "Light3Fog" );
-
-    ViewProj = mFX->GetVariableByName( "gViewProj" )->AsMatrix();
-    EyePosW = mFX->GetVariableByName( "gEyePosW" )->AsVector();
-    FogColor = mFX->GetVariableByName( "gFogColor" )->AsVector();
-    FogStart = mFX->GetVariableByName( "gFogStart" )->AsScalar();
-    FogRange = mFX->GetVariableByName( "gFogRange" )->AsScalar();
-    DirLights = mFX->GetVariableByName( "gDirLights" );
-    Mat = mFX->GetVariableByName( "gMaterial" );
-
-    MinDist = mFX->GetVariableByName( "gMinDist" )->AsScalar();
-    MaxDist = mFX->GetVariableByName( "gMaxDist" )->AsScalar();
-    MinTess = mFX->GetVariableByName( "gMinTess" )->AsScalar();
-    MaxTess = mFX->GetVariableByName( "gMaxTess" )->AsScalar();
-    TexelCellSpaceU = mFX->GetVariableByName( "gTexelCellSpaceU" )->AsScalar();
-    TexelCellSpaceV = mFX->GetVariableByName( "gTexelCellSpaceV" )->AsScalar();
-    WorldCellSpace = mFX->GetVariableByName( "gWorldCellSpace" )->AsScalar();
-    WorldFrustumPlanes = mFX->GetVariableByName( "gWorldFrustumPlanes" )->AsVector();
-
-    LayerMapArray = mFX->GetVariableByName( "gLayerMapArray" )->AsShaderResource();
-    BlendMap = mFX->GetVariableByName( "gBlendMap" )->AsShaderResource();
-    HeightMap = mFX->GetVariableByName( "gHeightMap" )->AsShaderResource();
+    Light1Tech = Technique( "Light1" );
+    Light2Tech = Technique( "Light2" );
+    Light3Tech = Technique( "Light3" );
+    Light1FogTech = Technique( "Light1Fog" );
+    Light2FogTech = Technique( "Light2Fog" );
+    Light3FogTech = Technique( "Light3Fog" );
+
+    ViewProj = Variable( "gViewProj" )->AsMatrix();
+    EyePosW = Variable( "gEyePosW" )->AsVector();
+    FogColor = Variable( "gFogColor" )->AsVector();
+    FogStart = Variable( "gFogStart" )->AsScalar();
+    FogRange = Variable( "gFogRange" )->AsScalar();
+    DirLights = Variable( "gDirLights" );
+    Mat = Variable( "gMaterial" );
+
+    TexelCellSpaceU = Variable( "gTexelCellSpaceU" )->AsScalar();
+    TexelCellSpaceV = Variable( "gTexelCellSpaceV" )->AsScalar();
+    WorldCellSpace = Variable( "gWorldCellSpace" )->AsScalar();
+
+    LayerMapArray = Variable( "gLayerMapArray" )->AsShaderResource();
+    BlendMap = Variable( "gBlendMap" )->AsShaderResource();
+    HeightMap = Variable( "gHeightMap" )->AsShaderResource();
+    PatchFactors = Variable( "gPatchFactors" )->AsShaderResource();
 }
 
 TerrainEffect::~TerrainEffect()
@@ -456,25 +741,25 @@ TerrainEffect::~TerrainEffect()
 BuildShadowMapEffect::BuildShadowMapEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    BuildShadowMapTech = mFX->GetTechniqueByName( "BuildShadowMapTech" );
-    BuildShadowMapAlphaClipTech = mFX->GetTechniqueByName( "BuildShadowMapAlphaClipTech" );
+    BuildShadowMapTech = Technique( "BuildShadowMapTech" );
+    BuildShadowMapAlphaClipTech = Technique( "BuildShadowMapAlphaClipTech" );
 
-    TessBuildShadowMapTech = mFX->GetTechniqueByName( "TessBuildShadowMapTech" );
-    TessBuildShadowMapAlphaClipTech = mFX->GetTechniqueByName( "TessBuildShadowMapAlphaClipTech" );
+    TessBuildShadowMapTech = Technique( "TessBuildShadowMapTech" );
+    TessBuildShadowMapAlphaClipTech = Technique( "TessBuildShadowMapAlphaClipTech" );
 
-    ViewProj = mFX->GetVariableByName( "gViewProj" )->AsMatrix();
-    WorldViewProj = mFX->GetVariableByName( "gWorldViewProj" )->AsMatrix();
-    World = mFX->GetVariableByName( "gWorld" )->AsMatrix();
-    WorldInvTranspose = mFX->GetVariableByName( "gWorldInvTranspose" )->AsMatrix();
-    TexTransform = mFX->GetVariableByName( "gTexTransform" )->AsMatrix();
-    EyePosW = mFX->GetVariableByName( "gEyePosW" )->AsVector();
-    HeightScale = mFX->GetVariableByName( "gHeightScale" )->AsScalar();
-    MaxTessDistance = mFX->GetVariableByName( "gMaxTessDistance" )->AsScalar();
-    MinTessDistance = mFX->GetVariableByName( "gMinTessDistance" )->AsScalar();
-    MinTessFactor = mFX->GetVariableByName( "gMinTessFactor" )->AsScalar();
-    MaxTessFactor = mFX->GetVariableByName( "gMaxTessFactor" )->AsScalar();
-    DiffuseMap = mFX->GetVariableByName( "gDiffuseMap" )->AsShaderResource();
-    NormalMap = mFX->GetVariableByName( "gNormalMap" )->AsShaderResource();
+    ViewProj = Variable( "gViewProj" )->AsMatrix();
+    WorldViewProj = Variable( "gWorldViewProj" )->AsMatrix();
+    World = Variable( "gWorld" )->AsMatrix();
+    WorldInvTranspose = Variable( "gWorldInvTranspose" )->AsMatrix();
+    TexTransform = Variable( "gTexTransform" )->AsMatrix();
+    EyePosW = Variable( "gEyePosW" )->AsVector();
+    HeightScale = Variable( "gHeightScale" )->AsScalar();
+    MaxTessDistance = Variable( "gMaxTessDistance" )->AsScalar();
+    MinTessDistance = Variable( "gMinTessDistance" )->AsScalar();
+    MinTessFactor = Variable( "gMinTessFactor" )->AsScalar();
+    MaxTessFactor = Variable( "gMaxTessFactor" )->AsScalar();
+    DiffuseMap = Variable( "gDiffuseMap" )->AsShaderResource();
+    NormalMap = Variable( "gNormalMap" )->AsShaderResource();
 }
 
 BuildShadowMapEffect::~BuildShadowMapEffect()
@@ -486,14 +771,14 @@ BuildShadowMapEffect::~BuildShadowMapEffect()
 DebugTexEffect::DebugTexEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    ViewArgbTech = mFX->GetTechniqueByName( "ViewArgbTech" );
-    ViewRedTech = mFX->GetTechniqueByName( "ViewRedTech" );
-    ViewGreenTech = mFX->GetTechniqueByName( "ViewGreenTech" );
-    ViewBlueTech = mFX->GetTechniqueByName( "ViewBlueTech" );
-    ViewAlphaTech = mFX->GetTechniqueByName( "ViewAlphaTech" );
+    ViewArgbTech = Technique( "ViewArgbTech" );
+    ViewRedTech = Technique( "ViewRedTech" );
+    ViewGreenTech = Technique( "ViewGreenTech" );
+    ViewBlueTech = Technique( "ViewBlueTech" );
+    ViewAlphaTech = Technique( "ViewAlphaTech" );
 
-    WorldViewProj = mFX->GetVariableByName( "gWorldViewProj" )->AsMatrix();
-    Texture = mFX->GetVariableByName( "gTexture" )->AsShaderResource();
+    WorldViewProj = Variable( "gWorldViewProj" )->AsMatrix();
+    Texture = Variable( "gTexture" )->AsShaderResource();
 }
 
 DebugTexEffect::~DebugTexEffect()
@@ -507,14 +792,14 @@ DebugTexEffect::~DebugTexEffect()
 SsaoNormalDepthEffect::SsaoNormalDepthEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    NormalDepthTech = mFX->GetTechniqueByName( "NormalDepth" );
-    NormalDepthAlphaClipTech = mFX->GetTechniqueByName( "NormalDepthAlphaClip" );
+    NormalDepthTech = Technique( "NormalDepth" );
+    NormalDepthAlphaClipTech = Technique( "NormalDepthAlphaClip" );
 
-    WorldView = mFX->GetVariableByName( "gWorldView" )->AsMatrix();
-    WorldInvTransposeView = mFX->GetVariableByName( "gWorldInvTransposeView" )->AsMatrix();
-    WorldViewProj = mFX->GetVariableByName( "gWorldViewProj" )->AsMatrix();
-    TexTransform = mFX->GetVariableByName( "gTexTransform" )->AsMatrix();
-    DiffuseMap = mFX->GetVariableByName( "gDiffuseMap" )->AsShaderResource();
+    WorldView = Variable( "gWorldView" )->AsMatrix();
+    WorldInvTransposeView = Variable( "gWorldInvTransposeView" )->AsMatrix();
+    WorldViewProj = Variable( "gWorldViewProj" )->AsMatrix();
+    TexTransform = Variable( "gTexTransform" )->AsMatrix();
+    DiffuseMap = Variable( "gDiffuseMap" )->AsShaderResource();
 }
 
 SsaoNormalDepthEffect::~SsaoNormalDepthEffect()
@@ -526,18 +811,18 @@ SsaoNormalDepthEffect::~SsaoNormalDepthEffect()
 SsaoEffect::SsaoEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    SsaoTech = mFX->GetTechniqueByName( "Ssao" );
+    SsaoTech = Technique( "Ssao" );
 
-    ViewToTexSpace = mFX->GetVariableByName( "gViewToTexSpace" )->AsMatrix();
-    OffsetVectors = mFX->GetVariableByName( "gOffsetVectors" )->AsVector();
-    FrustumCorners = mFX->GetVariableByName( "gFrustumCorners" )->AsVector();
-    OcclusionRadius = mFX->GetVariableByName( "gOcclusionRadius" )->AsScalar();
-    OcclusionFadeStart = mFX->GetVariableByName( "gOcclusionFadeStart" )->AsScalar();
-    OcclusionFadeEnd = mFX->GetVariableByName( "gOcclusionFadeEnd" )->AsScalar();
-    SurfaceEpsilon = mFX->GetVariableByName( "gSurfaceEpsilon" )->AsScalar();
+    ViewToTexSpace = Variable( "gViewToTexSpace" )->AsMatrix();
+    OffsetVectors = Variable( "gOffsetVectors" )->AsVector();
+    FrustumCorners = Variable( "gFrustumCorners" )->AsVector();
+    OcclusionRadius = Variable( "gOcclusionRadius" )->AsScalar();
+    OcclusionFadeStart = Variable( "gOcclusionFadeStart" )->AsScalar();
+    OcclusionFadeEnd = Variable( "gOcclusionFadeEnd" )->AsScalar();
+    SurfaceEpsilon = Variable( "gSurfaceEpsilon" )->AsScalar();
 
-    NormalDepthMap = mFX->GetVariableByName( "gNormalDepthMap" )->AsShaderResource();
-    RandomVecMap = mFX->GetVariableByName( "gRandomVecMap" )->AsShaderResource();
+    NormalDepthMap = Variable( "gNormalDepthMap" )->AsShaderResource();
+    RandomVecMap = Variable( "gRandomVecMap" )->AsShaderResource();
 }
 
 SsaoEffect::~SsaoEffect()
@@ -549,14 +834,16 @@ SsaoEffect::~SsaoEffect()
 SsaoBlurEffect::SsaoBlurEffect( ID3D11Device* device, const std::wstring& filename )
     : Effect( device, filename )
 {
-    HorzBlurTech = mFX->GetTechniqueByName( "HorzBlur" );
-    VertBlurTech = mFX->GetTechniqueByName( "VertBlur" );
+    HorzBlurTech = Technique( "HorzBlur" );
+    VertBlurTech = Technique( "VertBlur" );
 
-    TexelWidth = mFX->GetVariableByName( "gTexelWidth" )->AsScalar();
-    TexelHeight = mFX->GetVariableByName( "gTexelHeight" )->AsScalar();
+    TexelWidth = Variable( "gTexelWidth" )->AsScalar();
+    TexelHeight = Variable( "gTexelHeight" )->AsScalar();
+    Taps = Variable( "gTaps" )->AsVector();
+    TapCount = Variable( "gTapCount" )->AsScalar();
 
-    NormalDepthMap = mFX->GetVariableByName( "gNormalDepthMap" )->AsShaderResource();
-    InputImage = mFX->GetVariableByName( "gInputImage" )->AsShaderResource();
+    NormalDepthMap = Variable( "gNormalDepthMap" )->AsShaderResource();
+    InputImage = Variable( "gInputImage" )->AsShaderResource();
 }
 
 SsaoBlurEffect::~SsaoBlurEffect()
@@ -566,54 +853,118 @@ SsaoBlurEffect::~SsaoBlurEffect()
 
 #pragma region Effects
 
-BasicEffect* Effects::BasicFX = nullptr;
-TreeSpriteEffect* Effects::TreeSpriteFX = nullptr;
-BlurEffect* Effects::BlurFX = nullptr;
-BezierTessellationEffect* Effects::BezierTessellationFX = nullptr;
-InstancedBasicEffect* Effects::InstancedBasicFX = nullptr;
-SkyEffect* Effects::SkyFX = nullptr;
-NormalMapEffect* Effects::NormalMapFX = nullptr;
-DisplacementMapEffect* Effects::DisplacementMapFX = nullptr;
-TerrainEffect* Effects::TerrainFX = nullptr;
-BuildShadowMapEffect* Effects::BuildShadowMapFX = nullptr;
-DebugTexEffect* Effects::DebugTexFX = nullptr;
-SsaoNormalDepthEffect* Effects::SsaoNormalDepthFX = nullptr;
-SsaoEffect*            Effects::SsaoFX = nullptr;
-SsaoBlurEffect*        Effects::SsaoBlurFX = nullptr;
+ConstantBufferMirror<CBPerFrame> Effects::PerFrame;
+DynamicConstantBuffer Effects::PerFrameBuffer;
+
+Lazy<BasicEffect> Effects::BasicFX;
+Lazy<TreeSpriteEffect> Effects::TreeSpriteFX;
+Lazy<BlurEffect> Effects::BlurFX;
+Lazy<BezierTessellationEffect> Effects::BezierTessellationFX;
+Lazy<InstancedBasicEffect> Effects::InstancedBasicFX;
+Lazy<SkyEffect> Effects::SkyFX;
+Lazy<NormalMapEffect> Effects::NormalMapFX;
+Lazy<DisplacementMapEffect> Effects::DisplacementMapFX;
+Lazy<TerrainEffect> Effects::TerrainFX;
+Lazy<BuildShadowMapEffect> Effects::BuildShadowMapFX;
+Lazy<DebugTexEffect> Effects::DebugTexFX;
+Lazy<SsaoNormalDepthEffect> Effects::SsaoNormalDepthFX;
+Lazy<SsaoEffect>            Effects::SsaoFX;
+Lazy<SsaoBlurEffect>        Effects::SsaoBlurFX;
+
+namespace
+{
+	struct Registration
+	{
+		std::wstring filename;
+		LazyObject* effect;
+	};
+
+	ID3D11Device* sDevice = nullptr;
+	std::vector<Registration> sRegistrations;
+
+	// Effects may be first used from any thread.
+	std::mutex sWatcherMutex;
+	FileWatcher sWatcher;
+
+	template<typename T>
+	void Register(Lazy<T>& fx, const std::wstring& filename)
+	{
+		// The index is the watcher tag.
+		const unsigned int tag = static_cast<unsigned int>(sRegistrations.size());
+		Registration registration = { filename, &fx };
+		sRegistrations.push_back(registration);
+
+		fx.SetFactory([filename, tag]() -> T* {
+			T* effect = new T(sDevice, filename);
+			effect->SaveHandles();
+
+			std::lock_guard<std::mutex> lock(sWatcherMutex);
+			sWatcher.Watch(tag, effect->GetDependencies());
+
+			return effect;
+		});
+	}
+}
 
 void Effects::InitAll(ID3D11Device* device)
 {
-	BasicFX = new BasicEffect(device, L"FX/Basic.fxo");
-    //TreeSpriteFX = new TreeSpriteEffect( device, L"FX/TreeSprite.fxo" );
-    //BlurFX = new BlurEffect( device, L"FX/Blur.fxo" );
-    //BezierTessellationFX = new BezierTessellationEffect( device, L"FX/BezierTessellation.fxo" );
-    //InstancedBasicFX = new InstancedBasicEffect( device, L"FX/InstancedBasic.fxo" );
-    SkyFX = new SkyEffect( device, L"FX/Sky.fxo" );
-    NormalMapFX = new NormalMapEffect( device, L"FX/NormalMap.fxo" );
-    DisplacementMapFX = new DisplacementMapEffect( device, L"FX/DisplacementMap.fxo" );
-    //TerrainFX = new TerrainEffect( device, L"FX/Terrain.fxo" );
-    BuildShadowMapFX = new BuildShadowMapEffect( device, L"FX/BuildShadowMap.fxo" );
-    DebugTexFX = new DebugTexEffect( device, L"FX/DebugTexture.fxo" );
-    SsaoNormalDepthFX = new SsaoNormalDepthEffect( device, L"FX/SsaoNormalDepth.fxo" );
-    SsaoFX = new SsaoEffect( device, L"FX/Ssao.fxo" );
-    SsaoBlurFX = new SsaoBlurEffect( device, L"FX/SsaoBlur.fxo" );
+	sDevice = device;
+	PerFrameBuffer.Create(device, sizeof(CBPerFrame));
+
+	Register(BasicFX, L"FX/Basic.fxo");
+    Register(TreeSpriteFX, L"FX/TreeSprite.fxo");
+    Register(BlurFX, L"FX/Blur.fxo");
+    Register(BezierTessellationFX, L"FX/BezierTessellation.fxo");
+    Register(InstancedBasicFX, L"FX/InstancedBasic.fxo");
+    Register(SkyFX, L"FX/Sky.fxo");
+    Register(NormalMapFX, L"FX/NormalMap.fxo");
+    Register(DisplacementMapFX, L"FX/DisplacementMap.fxo");
+    Register(TerrainFX, L"FX/Terrain.fxo");
+    Register(BuildShadowMapFX, L"FX/BuildShadowMap.fxo");
+    Register(DebugTexFX, L"FX/DebugTexture.fxo");
+    Register(SsaoNormalDepthFX, L"FX/SsaoNormalDepth.fxo");
+    Register(SsaoFX, L"FX/Ssao.fxo");
+    Register(SsaoBlurFX, L"FX/SsaoBlur.fxo");
 }
 
 void Effects::DestroyAll()
 {
-	SafeDelete( BasicFX );
-    SafeDelete( TreeSpriteFX );
-    SafeDelete( BlurFX );
-    SafeDelete( BezierTessellationFX );
-    SafeDelete( InstancedBasicFX );
-    SafeDelete( SkyFX );
-    SafeDelete( NormalMapFX );
-    SafeDelete( DisplacementMapFX );
-    SafeDelete( TerrainFX );
-    SafeDelete( BuildShadowMapFX );
-    SafeDelete( DebugTexFX );
-    SafeDelete( SsaoNormalDepthFX );
-    SafeDelete( SsaoFX );
-    SafeDelete( SsaoBlurFX );
-}
-#pragma endregion
\ No newline at end of file
+	for (auto& registration : sRegistrations) {
+		registration.effect->Reset();
+	}
+	sRegistrations.clear();
+	PerFrameBuffer.Release();
+
+	std::lock_guard<std::mutex> lock(sWatcherMutex);
+	sWatcher = FileWatcher();
+	sDevice = nullptr;
+}
+
+void Effects::ReloadChanged()
+{
+	std::vector<unsigned int> changed;
+	{
+		std::lock_guard<std::mutex> lock(sWatcherMutex);
+		if (!sWatcher.Poll(changed)) {
+			return;
+		}
+	}
+
+	for (auto tag : changed) {
+		Registration& registration = sRegistrations[tag];
+		if (!registration.effect->IsLoaded()) {
+			continue;
+		}
+
+		// With the source at hand, compile it so an edit shows without a
+		// rebuild; otherwise the .fxo itself was rebuilt.
+		if (EffectCache::FileExists(SourceFor(registration.filename)) &&
+			!Effect::CompileSource(registration.filename)) {
+			continue;
+		}
+
+		// Created again, from the new binary, on next use.
+		registration.effect->Reset();
+	}
+}
+#pragma endregion
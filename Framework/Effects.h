@@ -10,8 +10,81 @@
 
 #include "d3dx11effect.h"
 #include "d3dUtil.h"
+#include "ConstantBuffers.h"
+#include "EffectCache.h"
 #include "LightHelper.h"
 
+#pragma region ConstantBufferStaging
+// GPU side of a ConstantBufferMirror: a dynamic buffer rewritten whole with
+// one Map when the mirror changed since the last write.
+class DynamicConstantBuffer
+{
+public:
+	DynamicConstantBuffer();
+	~DynamicConstantBuffer();
+
+	void Create(ID3D11Device* device, UINT size);
+	void Release();
+
+	ID3D11Buffer* Get()const { return mBuffer; }
+
+	template<typename T>
+	void Update(ID3D11DeviceContext* context, const ConstantBufferMirror<T>& mirror)
+	{
+		mirror.Flush(mVersion, [this, context](const void* data, size_t size) { Write(context, data, size); });
+	}
+
+private:
+	DynamicConstantBuffer(const DynamicConstantBuffer& rhs);
+	DynamicConstantBuffer& operator=(const DynamicConstantBuffer& rhs);
+
+	void Write(ID3D11DeviceContext* context, const void* data, size_t size);
+
+	ID3D11Buffer* mBuffer;
+	uint64_t mVersion;
+};
+
+// Feeds one cbuffer of an effect from a ConstantBufferMirror. If the effect
+// was compiled with the mirror's layout, the effect draws straight from a
+// DynamicConstantBuffer; otherwise (an effect that adds members, say) each
+// member is set by name, still only when the mirror changed.
+//
+// A staged cbuffer belongs to its mirror: the per-variable setters of the
+// same cbuffer write to the effect's own buffer, which is no longer drawn
+// from.
+class ConstantBufferBinding
+{
+public:
+	ConstantBufferBinding();
+
+	void Bind(ID3DX11Effect* fx, const ConstantBufferLayout& layout, DynamicConstantBuffer* buffer);
+
+	// True when the effect draws from the DynamicConstantBuffer.
+	bool IsDirect()const { return mBuffer != nullptr; }
+
+	template<typename T>
+	void Flush(ID3D11DeviceContext* context, const ConstantBufferMirror<T>& mirror)
+	{
+		if (mBuffer) {
+			mBuffer->Update(context, mirror);
+		}
+		else {
+			mirror.Flush(mVersion, [this](const void* data, size_t) { SetMembers(data); });
+		}
+	}
+
+private:
+	static bool Matches(ID3DX11EffectConstantBuffer* cbuffer, const ConstantBufferLayout& layout);
+
+	void SetMembers(const void* data);
+
+	const ConstantBufferLayout* mLayout;
+	std::vector<ID3DX11EffectVariable*> mMembers;
+	DynamicConstantBuffer* mBuffer;
+	uint64_t mVersion;
+};
+#pragma endregion
+
 #pragma region Effect
 class Effect
 {
@@ -19,12 +92,52 @@ public:
 	Effect(ID3D11Device* device, const std::wstring& filename);
 	virtual ~Effect();
 
+	// Writes the handle table next to the .fxo if lookups added to it.
+	void SaveHandles();
+
+	// The .fxo, and the .fx source and its includes when they are there.
+	const std::vector<std::wstring>& GetDependencies()const { return mDependencies; }
+
+	// Reads the binary for filename (an .fxo). If the .fx source is next to
+	// it and the cache has a binary for the source as it is now, that one is
+	// used instead, so edits compiled at run time survive a restart.
+	static bool LoadBinary(const std::wstring& filename, std::vector<char>& binary,
+		std::vector<std::wstring>* dependencies = nullptr);
+
+	// Compiles the .fx source next to filename into the cache, unless it is
+	// there already. Returns false, with the errors in the debug output, if
+	// the source does not compile.
+	static bool CompileSource(const std::wstring& filename);
+
 private:
 	Effect(const Effect& rhs);
 	//Effect& operator=(const Effect& rhs);
 
 protected:
+	// Lookups by name in the handles resolved when the effect was created.
+	// A name the effect does not have gets the effect's invalid object, as
+	// GetTechniqueByName/GetVariableByName would return. The handles are
+	// not changed after construction, so these are safe from any thread.
+	ID3DX11EffectTechnique* Technique(const char* name)const;
+	ID3DX11EffectVariable* Variable(const char* name)const;
+
 	ID3DX11Effect* mFX;
+
+private:
+	// Fetches the saved handles by index. Fails if one is not valid, e.g.
+	// a table saved for another binary with a colliding hash.
+	bool ResolveSaved();
+
+	// Reads every technique and global variable description once, and
+	// fills the table (to be saved) and the resolved handles from them.
+	void EnumerateHandles();
+
+	std::wstring mHandleFile;
+	EffectHandleTable mHandles;
+	std::vector<std::wstring> mDependencies;
+
+	std::unordered_map<std::string, ID3DX11EffectTechnique*> mTechniques;
+	std::unordered_map<std::string, ID3DX11EffectVariable*> mVariables;
 };
 #pragma endregion
 
@@ -101,10 +214,33 @@ public:
 
     void SetWorldViewProjTex( DirectX::CXMMATRIX M ) { WorldViewProjTex->SetMatrix( reinterpret_cast<const float*>( &M ) ); }
 
+    // Staged alternative to the setters above: fill Effects::PerFrame and
+    // PerObject, then draw each pass with Apply(), which uploads each
+    // cbuffer at most once and only if it changed. Once an effect has been
+    // applied this way, the setters for the staged cbuffer members no
+    // longer reach the shader; the others (textures, gShadowTransform and
+    // the like) still do.
+    void Apply( ID3DX11EffectPass* pass, ID3D11DeviceContext* context );
+
+    ConstantBufferMirror<CBPerObject> PerObject;
+
 	ID3DX11EffectTechnique* Light1Tech;
 	ID3DX11EffectTechnique* Light2Tech;
 	ID3DX11EffectTechnique* Light3Tech;
 
+    // Invalid in the Basic.fx files without them. World and normal
+    // transforms come per instance (InputLayouts::InstancedPosNormal), so
+    // gWorldViewProj holds just view * proj for these.
+    ID3DX11EffectTechnique* Light1InstancedTech;
+    ID3DX11EffectTechnique* Light2InstancedTech;
+    ID3DX11EffectTechnique* Light3InstancedTech;
+
+    // The same for the shadowed Basic.fx, on PosNormalTexTan vertices
+    // (InputLayouts::InstancedPosNormalTexTan); gShadowTransform holds
+    // just the light's transform for these.
+    ID3DX11EffectTechnique* Light3TexInstancedTech;
+    ID3DX11EffectTechnique* Light3ReflectInstancedTech;
+
     ID3DX11EffectTechnique* Light0TexTech;
     ID3DX11EffectTechnique* Light1TexTech;
     ID3DX11EffectTechnique* Light2TexTech;
@@ -174,6 +310,12 @@ public:
     ID3DX11EffectShaderResourceVariable* CubeMap;
     ID3DX11EffectShaderResourceVariable* ShadowMap;
     ID3DX11EffectShaderResourceVariable* SsaoMap;
+
+private:
+    DynamicConstantBuffer mPerObjectBuffer;
+    ConstantBufferBinding mPerFrame;
+    ConstantBufferBinding mPerObject;
+    bool mStaged;
 };
 #pragma endregion
 
@@ -214,14 +356,18 @@ public:
     BlurEffect( ID3D11Device* device, const std::wstring& filename );
     ~BlurEffect();
 
-    void SetWeights( const float weights[9] ) { Weights->SetFloatArray( weights, 0, 9 ); }
+    void SetWeights( const float weights[11] ) { Weights->SetFloatArray( weights, 0, 11 ); }
+    void SetBoxRadius( int r ) { BoxRadius->SetInt( r ); }
     void SetInputMap( ID3D11ShaderResourceView* tex ) { InputMap->SetResource( tex ); }
     void SetOutputMap( ID3D11UnorderedAccessView* tex ) { OutputMap->SetUnorderedAccessView( tex ); }
 
     ID3DX11EffectTechnique* HorzBlurTech;
     ID3DX11EffectTechnique* VertBlurTech;
+    ID3DX11EffectTechnique* HorzBoxBlurTech;
+    ID3DX11EffectTechnique* VertBoxBlurTech;
 
     ID3DX11EffectScalarVariable* Weights;
+    ID3DX11EffectScalarVariable* BoxRadius;
     ID3DX11EffectShaderResourceVariable* InputMap;
     ID3DX11EffectUnorderedAccessViewVariable* OutputMap;
 };
@@ -244,6 +390,7 @@ public:
     void SetDirLights( const DirectionalLight* lights ) { DirLights->SetRawValue( lights, 0, 3 * sizeof( DirectionalLight ) ); }
     void SetMaterial( const Material& mat ) { Mat->SetRawValue( &mat, 0, sizeof( Material ) ); }
     void SetDiffuseMap( ID3D11ShaderResourceView* tex ) { DiffuseMap->SetResource( tex ); }
+    void SetPatchFactors( ID3D11ShaderResourceView* factors ) { PatchFactors->SetResource( factors ); }
 
     ID3DX11EffectTechnique* TessTech;
 
@@ -259,6 +406,7 @@ public:
     ID3DX11EffectVariable* Mat;
 
     ID3DX11EffectShaderResourceVariable* DiffuseMap;
+    ID3DX11EffectShaderResourceVariable* PatchFactors;
 };
 #pragma endregion
 
@@ -566,18 +714,14 @@ public:
     void SetDirLights( const DirectionalLight* lights ) { DirLights->SetRawValue( lights, 0, 3 * sizeof( DirectionalLight ) ); }
     void SetMaterial( const Material& mat ) { Mat->SetRawValue( &mat, 0, sizeof( Material ) ); }
 
-    void SetMinDist( float f ) { MinDist->SetFloat( f ); }
-    void SetMaxDist( float f ) { MaxDist->SetFloat( f ); }
-    void SetMinTess( float f ) { MinTess->SetFloat( f ); }
-    void SetMaxTess( float f ) { MaxTess->SetFloat( f ); }
     void SetTexelCellSpaceU( float f ) { TexelCellSpaceU->SetFloat( f ); }
     void SetTexelCellSpaceV( float f ) { TexelCellSpaceV->SetFloat( f ); }
     void SetWorldCellSpace( float f ) { WorldCellSpace->SetFloat( f ); }
-    void SetWorldFrustumPlanes( DirectX::XMFLOAT4 planes[6] ) { WorldFrustumPlanes->SetFloatVectorArray( reinterpret_cast<float*>( planes ), 0, 6 ); }
 
     void SetLayerMapArray( ID3D11ShaderResourceView* tex ) { LayerMapArray->SetResource( tex ); }
     void SetBlendMap( ID3D11ShaderResourceView* tex ) { BlendMap->SetResource( tex ); }
     void SetHeightMap( ID3D11ShaderResourceView* tex ) { HeightMap->SetResource( tex ); }
+    void SetPatchFactors( ID3D11ShaderResourceView* factors ) { PatchFactors->SetResource( factors ); }
 
 
     ID3DX11EffectTechnique* Light1Tech;
@@ -597,18 +741,14 @@ public:
     ID3DX11EffectScalarVariable* FogRange;
     ID3DX11EffectVariable* DirLights;
     ID3DX11EffectVariable* Mat;
-    ID3DX11EffectScalarVariable* MinDist;
-    ID3DX11EffectScalarVariable* MaxDist;
-    ID3DX11EffectScalarVariable* MinTess;
-    ID3DX11EffectScalarVariable* MaxTess;
     ID3DX11EffectScalarVariable* TexelCellSpaceU;
     ID3DX11EffectScalarVariable* TexelCellSpaceV;
     ID3DX11EffectScalarVariable* WorldCellSpace;
-    ID3DX11EffectVectorVariable* WorldFrustumPlanes;
 
     ID3DX11EffectShaderResourceVariable* LayerMapArray;
     ID3DX11EffectShaderResourceVariable* BlendMap;
     ID3DX11EffectShaderResourceVariable* HeightMap;
+    ID3DX11EffectShaderResourceVariable* PatchFactors;
 };
 #pragma endregion
 
@@ -741,6 +881,13 @@ public:
     void SetTexelWidth( float f ) { TexelWidth->SetFloat( f ); }
     void SetTexelHeight( float f ) { TexelHeight->SetFloat( f ); }
 
+    // Taps are packed as float4( offset, weight, 0, 0 ), see SsaoBlur.fx.
+    void SetTaps( const DirectX::XMFLOAT4* taps, int count )
+    {
+        Taps->SetFloatVectorArray( reinterpret_cast<const float*>( taps ), 0, count );
+        TapCount->SetInt( count );
+    }
+
     void SetNormalDepthMap( ID3D11ShaderResourceView* srv ) { NormalDepthMap->SetResource( srv ); }
     void SetInputImage( ID3D11ShaderResourceView* srv ) { InputImage->SetResource( srv ); }
 
@@ -749,6 +896,8 @@ public:
 
     ID3DX11EffectScalarVariable* TexelWidth;
     ID3DX11EffectScalarVariable* TexelHeight;
+    ID3DX11EffectVectorVariable* Taps;
+    ID3DX11EffectScalarVariable* TapCount;
 
     ID3DX11EffectShaderResourceVariable* NormalDepthMap;
     ID3DX11EffectShaderResourceVariable* InputImage;
@@ -756,26 +905,37 @@ public:
 #pragma endregion
 
 #pragma region Effects
+// Effects are created on first use, so a demo only pays for the ones it
+// draws with. InitAll() just registers them.
 class Effects
 {
 public:
 	static void InitAll(ID3D11Device* device);
 	static void DestroyAll();
 
-	static BasicEffect* BasicFX;
-    static TreeSpriteEffect* TreeSpriteFX;
-    static BlurEffect* BlurFX;
-    static BezierTessellationEffect* BezierTessellationFX;
-    static InstancedBasicEffect* InstancedBasicFX;
-    static SkyEffect* SkyFX;
-    static NormalMapEffect* NormalMapFX;
-    static DisplacementMapEffect* DisplacementMapFX;
-    static BuildShadowMapEffect* BuildShadowMapFX;
-    static DebugTexEffect* DebugTexFX;
-    static TerrainEffect* TerrainFX;
-    static SsaoNormalDepthEffect* SsaoNormalDepthFX;
-    static SsaoEffect* SsaoFX;
-    static SsaoBlurEffect* SsaoBlurFX;
+	// Call once per frame: reloads effects whose .fxo, .fx source or includes
+	// changed on disk. An effect whose source no longer compiles is kept.
+	static void ReloadChanged();
+
+	// Per-frame constants shared by the effects that draw with Apply(). They
+	// are written to one buffer, once per change, that all of them read.
+	static ConstantBufferMirror<CBPerFrame> PerFrame;
+	static DynamicConstantBuffer PerFrameBuffer;
+
+	static Lazy<BasicEffect> BasicFX;
+    static Lazy<TreeSpriteEffect> TreeSpriteFX;
+    static Lazy<BlurEffect> BlurFX;
+    static Lazy<BezierTessellationEffect> BezierTessellationFX;
+    static Lazy<InstancedBasicEffect> InstancedBasicFX;
+    static Lazy<SkyEffect> SkyFX;
+    static Lazy<NormalMapEffect> NormalMapFX;
+    static Lazy<DisplacementMapEffect> DisplacementMapFX;
+    static Lazy<BuildShadowMapEffect> BuildShadowMapFX;
+    static Lazy<DebugTexEffect> DebugTexFX;
+    static Lazy<TerrainEffect> TerrainFX;
+    static Lazy<SsaoNormalDepthEffect> SsaoNormalDepthFX;
+    static Lazy<SsaoEffect> SsaoFX;
+    static Lazy<SsaoBlurEffect> SsaoBlurFX;
 };
 #pragma endregion
 
@@ -0,0 +1,377 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file FrameGraph.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "FrameGraph.h"
+
+#include <algorithm>
+#include <cassert>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    inline bool Contains( const std::vector<int>& v, const int x )
+    {
+        return std::find( v.begin(), v.end(), x ) != v.end();
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+FrameGraph::FrameGraph( void )
+: mResources( )
+, mPasses( )
+, mExecutionOrder( )
+, mPhysical( )
+, mCompiled( false )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameGraph::Reset( void )
+{
+    mResources.clear();
+    mPasses.clear();
+    mExecutionOrder.clear();
+    mPhysical.clear();
+    mCompiled = false;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+FrameGraph::ResourceHandle FrameGraph::CreateTexture( const std::string& name, const TextureDesc& desc )
+{
+    Resource r;
+    r.name = name;
+    r.desc = desc;
+    r.imported = false;
+    r.output = false;
+    r.refCount = 0;
+    r.firstUse = Invalid;
+    r.lastUse = Invalid;
+    r.physical = Invalid;
+
+    mResources.push_back( r );
+    mCompiled = false;
+
+    return static_cast<ResourceHandle>( mResources.size() - 1 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+FrameGraph::ResourceHandle FrameGraph::ImportTexture( const std::string& name )
+{
+    ResourceHandle h = CreateTexture( name, TextureDesc() );
+
+    // Anything written to an imported texture is visible outside the graph.
+    mResources[h].imported = true;
+    mResources[h].output = true;
+
+    return h;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+FrameGraph::PassHandle FrameGraph::AddPass( const std::string& name,
+                                            const std::vector<ResourceHandle>& reads,
+                                            const std::vector<ResourceHandle>& writes,
+                                            const ExecuteFunc& execute )
+{
+    const PassHandle h = static_cast<PassHandle>( mPasses.size() );
+
+    Pass p;
+    p.name = name;
+    p.reads = reads;
+    p.writes = writes;
+    p.execute = execute;
+    p.sideEffect = false;
+    p.refCount = 0;
+    p.culled = false;
+
+    for ( auto r : reads ) {
+        assert( r >= 0 && r < static_cast<int>( mResources.size() ) );
+        // Reads must come after the producer, except for imported textures.
+        assert( mResources[r].imported || !mResources[r].writers.empty() || Contains( writes, r ) );
+        (void)r;
+    }
+
+    for ( auto w : writes ) {
+        assert( w >= 0 && w < static_cast<int>( mResources.size() ) );
+        mResources[w].writers.push_back( h );
+    }
+
+    mPasses.push_back( p );
+    mCompiled = false;
+
+    return h;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameGraph::SetSideEffect( PassHandle pass )
+{
+    mPasses[pass].sideEffect = true;
+    mCompiled = false;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameGraph::MarkOutput( ResourceHandle resource )
+{
+    mResources[resource].output = true;
+    mCompiled = false;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameGraph::Compile( void )
+{
+    CullPasses();
+    ComputeLifetimes();
+    AssignPhysical();
+
+    mCompiled = true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameGraph::Execute( void ) const
+{
+    assert( mCompiled );
+
+    for ( auto p : mExecutionOrder ) {
+        if ( mPasses[p].execute ) {
+            mPasses[p].execute();
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameGraph::CullPasses( void )
+{
+    // A pass is referenced once per resource it writes; a resource is
+    // referenced once per pass reading it. Reads by a pass that also writes
+    // the resource (in-place updates) do not keep it alive on their own.
+    for ( auto& r : mResources ) {
+        r.refCount = r.output ? 1 : 0;
+    }
+
+    for ( auto& p : mPasses ) {
+        p.refCount = static_cast<int>( p.writes.size() ) + ( p.sideEffect ? 1 : 0 );
+        p.culled = false;
+
+        for ( auto r : p.reads ) {
+            if ( !Contains( p.writes, r ) ) {
+                ++mResources[r].refCount;
+            }
+        }
+    }
+
+    // Flood backwards from every unreferenced resource.
+    std::vector<ResourceHandle> unreferenced;
+    for ( size_t i = 0; i < mResources.size(); ++i ) {
+        if ( mResources[i].refCount == 0 ) {
+            unreferenced.push_back( static_cast<ResourceHandle>( i ) );
+        }
+    }
+
+    while ( !unreferenced.empty() ) {
+        const ResourceHandle r = unreferenced.back();
+        unreferenced.pop_back();
+
+        for ( auto w : mResources[r].writers ) {
+            Pass& writer = mPasses[w];
+            if ( writer.culled || --writer.refCount > 0 ) {
+                continue;
+            }
+
+            writer.culled = true;
+
+            for ( auto read : writer.reads ) {
+                if ( Contains( writer.writes, read ) ) {
+                    continue;
+                }
+
+                if ( --mResources[read].refCount == 0 ) {
+                    unreferenced.push_back( read );
+                }
+            }
+        }
+    }
+
+    mExecutionOrder.clear();
+    for ( size_t i = 0; i < mPasses.size(); ++i ) {
+        if ( !mPasses[i].culled ) {
+            mExecutionOrder.push_back( static_cast<PassHandle>( i ) );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameGraph::ComputeLifetimes( void )
+{
+    for ( auto& r : mResources ) {
+        r.firstUse = Invalid;
+        r.lastUse = Invalid;
+    }
+
+    for ( size_t i = 0; i < mExecutionOrder.size(); ++i ) {
+        const Pass& p = mPasses[mExecutionOrder[i]];
+        const int step = static_cast<int>( i );
+
+        auto touch = [this, step]( ResourceHandle h ) {
+            Resource& r = mResources[h];
+            if ( r.firstUse == Invalid ) {
+                r.firstUse = step;
+            }
+            r.lastUse = step;
+        };
+
+        std::for_each( p.reads.begin(), p.reads.end(), touch );
+        std::for_each( p.writes.begin(), p.writes.end(), touch );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameGraph::AssignPhysical( void )
+{
+    mPhysical.clear();
+
+    // Visit transients in the order they become live.
+    std::vector<ResourceHandle> transients;
+    for ( size_t i = 0; i < mResources.size(); ++i ) {
+        Resource& r = mResources[i];
+        r.physical = Invalid;
+
+        if ( !r.imported && r.firstUse != Invalid ) {
+            transients.push_back( static_cast<ResourceHandle>( i ) );
+        }
+    }
+
+    std::stable_sort( transients.begin(), transients.end(), [this]( ResourceHandle a, ResourceHandle b ) {
+        return mResources[a].firstUse < mResources[b].firstUse;
+    } );
+
+    // Last step at which each physical slot is in use.
+    std::vector<int> busyUntil;
+
+    for ( auto h : transients ) {
+        Resource& r = mResources[h];
+
+        // First fit: any slot of the same description that was released
+        // before this resource becomes live.
+        for ( size_t s = 0; s < mPhysical.size(); ++s ) {
+            if ( mPhysical[s] == r.desc && busyUntil[s] < r.firstUse ) {
+                r.physical = static_cast<int>( s );
+                busyUntil[s] = r.lastUse;
+                break;
+            }
+        }
+
+        if ( r.physical == Invalid ) {
+            r.physical = static_cast<int>( mPhysical.size() );
+            mPhysical.push_back( r.desc );
+            busyUntil.push_back( r.lastUse );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool FrameGraph::IsCulled( PassHandle pass ) const
+{
+    return mPasses[pass].culled;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const std::vector<FrameGraph::PassHandle>& FrameGraph::GetExecutionOrder( void ) const
+{
+    return mExecutionOrder;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+int FrameGraph::GetFirstUse( ResourceHandle resource ) const
+{
+    return mResources[resource].firstUse;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+int FrameGraph::GetLastUse( ResourceHandle resource ) const
+{
+    return mResources[resource].lastUse;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+int FrameGraph::GetPhysicalIndex( ResourceHandle resource ) const
+{
+    return mResources[resource].physical;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t FrameGraph::GetPhysicalCount( void ) const
+{
+    return mPhysical.size();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const FrameGraph::TextureDesc& FrameGraph::GetPhysicalDesc( int physicalIndex ) const
+{
+    return mPhysical[physicalIndex];
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool FrameGraph::IsImported( ResourceHandle resource ) const
+{
+    return mResources[resource].imported;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const std::string& FrameGraph::GetName( ResourceHandle resource ) const
+{
+    return mResources[resource].name;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const std::string& FrameGraph::GetPassName( PassHandle pass ) const
+{
+    return mPasses[pass].name;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const FrameGraph::TextureDesc& FrameGraph::GetDesc( ResourceHandle resource ) const
+{
+    return mResources[resource].desc;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t FrameGraph::GetResourceCount( void ) const
+{
+    return mResources.size();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t FrameGraph::GetPassCount( void ) const
+{
+    return mPasses.size();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,161 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file FrameGraph.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Declares the passes of a frame along with the textures each one reads and
+/// writes, then works out which passes actually contribute to an output and
+/// how long each transient texture lives. Transients with identical
+/// descriptions whose lifetimes do not overlap are assigned the same physical
+/// texture, so a post stack only allocates as many targets as are live at
+/// once.
+///
+/// This class only does the bookkeeping and does not touch the device; see
+/// TransientTexturePool for creating the physical textures.
+///</summary>
+class FrameGraph {
+public:
+
+    typedef int ResourceHandle;
+    typedef int PassHandle;
+
+    static const int Invalid = -1;
+
+    // Description used to decide whether two transients can share memory.
+    struct TextureDesc {
+        TextureDesc( void )
+            : width( 0 ), height( 0 ), format( 0 ), bindFlags( 0 ) { }
+        TextureDesc( unsigned int w, unsigned int h, unsigned int fmt, unsigned int bind )
+            : width( w ), height( h ), format( fmt ), bindFlags( bind ) { }
+
+        bool operator==( const TextureDesc& rhs ) const
+        {
+            return width == rhs.width && height == rhs.height &&
+                format == rhs.format && bindFlags == rhs.bindFlags;
+        }
+
+        bool operator!=( const TextureDesc& rhs ) const { return !( *this == rhs ); }
+
+        unsigned int width;
+        unsigned int height;
+        unsigned int format;    // DXGI_FORMAT
+        unsigned int bindFlags; // D3D11_BIND_FLAG
+    };
+
+    typedef std::function<void( void )> ExecuteFunc;
+
+    FrameGraph( void );
+
+    // Removes all passes and resources so the graph can be declared again.
+    void Reset( void );
+
+    // Declares a texture that only lives within the frame.
+    ResourceHandle CreateTexture( const std::string& name, const TextureDesc& desc );
+
+    // Declares a texture owned outside of the graph (e.g. the back buffer).
+    // Imported textures are never aliased.
+    ResourceHandle ImportTexture( const std::string& name );
+
+    // Declares a pass. A pass may read and write the same resource to
+    // modify it in place. Passes execute in declaration order, so every read
+    // must refer to a resource written by an earlier pass (or imported).
+    PassHandle AddPass( const std::string& name,
+                        const std::vector<ResourceHandle>& reads,
+                        const std::vector<ResourceHandle>& writes,
+                        const ExecuteFunc& execute );
+
+    // Passes with side effects outside the graph are never culled.
+    void SetSideEffect( PassHandle pass );
+
+    // Keeps a resource (and every pass contributing to it) alive.
+    void MarkOutput( ResourceHandle resource );
+
+    ///<summary>
+    /// Culls passes that do not contribute to an output, computes the
+    /// lifetime of every resource over the surviving passes, and assigns
+    /// transients to physical slots.
+    ///</summary>
+    void Compile( void );
+
+    // Runs every surviving pass in order. Compile() must be called first.
+    void Execute( void ) const;
+
+    // Results of Compile().
+
+    bool IsCulled( PassHandle pass ) const;
+    const std::vector<PassHandle>& GetExecutionOrder( void ) const;
+
+    // Index of the first/last surviving pass using the resource, in terms of
+    // execution order, or Invalid if no surviving pass uses it.
+    int GetFirstUse( ResourceHandle resource ) const;
+    int GetLastUse( ResourceHandle resource ) const;
+
+    // Physical slot the transient is aliased to, or Invalid for imported or
+    // unused resources.
+    int GetPhysicalIndex( ResourceHandle resource ) const;
+    size_t GetPhysicalCount( void ) const;
+    const TextureDesc& GetPhysicalDesc( int physicalIndex ) const;
+
+    bool IsImported( ResourceHandle resource ) const;
+    const std::string& GetName( ResourceHandle resource ) const;
+    const std::string& GetPassName( PassHandle pass ) const;
+    const TextureDesc& GetDesc( ResourceHandle resource ) const;
+    size_t GetResourceCount( void ) const;
+    size_t GetPassCount( void ) const;
+
+private:
+
+    struct Resource {
+        std::string name;
+        TextureDesc desc;
+        bool imported;
+        bool output;
+
+        std::vector<PassHandle> writers;
+
+        // Compile() results.
+        int refCount;
+        int firstUse;
+        int lastUse;
+        int physical;
+    };
+
+    struct Pass {
+        std::string name;
+        std::vector<ResourceHandle> reads;
+        std::vector<ResourceHandle> writes;
+        ExecuteFunc execute;
+        bool sideEffect;
+
+        // Compile() results.
+        int refCount;
+        bool culled;
+    };
+
+    void CullPasses( void );
+    void ComputeLifetimes( void );
+    void AssignPhysical( void );
+
+private:
+
+    std::vector<Resource> mResources;
+    std::vector<Pass> mPasses;
+
+    std::vector<PassHandle> mExecutionOrder;
+    std::vector<TextureDesc> mPhysical;
+
+    bool mCompiled;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
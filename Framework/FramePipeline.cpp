@@ -0,0 +1,153 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file FramePipeline.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "FramePipeline.h"
+
+#include <chrono>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+FramePipeline::FramePipeline( void )
+: mMiddle( 1 )
+, mWrite( 0 )
+, mRead( 2 )
+, mPublished( 0 )
+, mSleepers( 0 )
+, mMutex( )
+, mCondition( )
+{
+    reset();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FramePipeline::reset( void )
+{
+    mWrite = 0;
+    mMiddle.store( 1 );
+    mRead = 2;
+
+    for ( unsigned int i = 0; i < SlotCount; ++i ) {
+        mSequence[i] = 0;
+    }
+    mPublished = 0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+unsigned int FramePipeline::getWriteSlot( void ) const
+{
+    return mWrite;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+unsigned int FramePipeline::publish( void )
+{
+    mSequence[mWrite] = ++mPublished;
+
+    const unsigned int previous = mMiddle.exchange( mWrite | FreshBit );
+    mWrite = previous & SlotMask;
+
+    wake();
+
+    return mWrite;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool FramePipeline::isPending( void ) const
+{
+    return ( mMiddle.load() & FreshBit ) != 0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool FramePipeline::waitForConsumer( const unsigned int timeoutMs )
+{
+    if ( !isPending() ) {
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock( mMutex );
+
+    ++mSleepers;
+    const bool consumed = mCondition.wait_for( lock,
+                                               std::chrono::milliseconds( timeoutMs ),
+                                               [this] { return !isPending(); } );
+    --mSleepers;
+
+    return consumed;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool FramePipeline::acquire( void )
+{
+    if ( !isPending() ) {
+        return false;
+    }
+
+    // Only the consumer clears FreshBit, so the slot is still fresh here
+    // (possibly a newer one than seen above).
+    const unsigned int previous = mMiddle.exchange( mRead );
+    mRead = previous & SlotMask;
+
+    wake();
+
+    return true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool FramePipeline::waitForPacket( const unsigned int timeoutMs )
+{
+    if ( acquire() ) {
+        return true;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock( mMutex );
+
+        ++mSleepers;
+        mCondition.wait_for( lock,
+                             std::chrono::milliseconds( timeoutMs ),
+                             [this] { return isPending(); } );
+        --mSleepers;
+    }
+
+    return acquire();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+unsigned int FramePipeline::getReadSlot( void ) const
+{
+    return mRead;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint64_t FramePipeline::getReadSequence( void ) const
+{
+    return mSequence[mRead];
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FramePipeline::wake( void )
+{
+    // Sleepers register under the mutex before re-checking mMiddle, and both
+    // sides use sequentially consistent operations: either the sleeper sees
+    // the exchange, or it is counted here and waiting (holding the mutex
+    // until then) by the time we notify.
+    if ( mSleepers.load() > 0 ) {
+        {
+            std::lock_guard<std::mutex> lock( mMutex );
+        }
+        mCondition.notify_all();
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,102 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file FramePipeline.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Triple-buffered handoff of frame packets from one producer thread (update)
+/// to one consumer thread (render). The packets themselves live with the
+/// caller, indexed by slot; the pipeline only says which slot each side owns.
+///
+/// The producer fills getWriteSlot() and publish()es it; the consumer
+/// acquire()s the newest published slot and reads it through getReadSlot()
+/// until its next acquire. Both are a single atomic exchange, so neither side
+/// ever blocks the other. A slot is never visible to both sides at once, and
+/// the sequence numbers the consumer sees strictly increase.
+///
+/// The wait functions only sleep an idle side; a publish or acquire wakes
+/// the other side, taking a lock only when someone is actually asleep.
+///</summary>
+class FramePipeline
+{
+
+public:
+
+    static const unsigned int SlotCount = 3;
+
+    FramePipeline( void );
+
+    // Not thread-safe; call while neither side is running.
+    void reset( void );
+
+    // Producer:
+
+    unsigned int getWriteSlot( void ) const;
+
+    // Hands the write slot to the consumer and returns the next write slot.
+    // A packet the consumer never acquired is overwritten by the next one.
+    unsigned int publish( void );
+
+    // True while a published packet has not been acquired yet.
+    bool isPending( void ) const;
+
+    // Waits until the consumer acquired the last published packet. Returns
+    // false on timeout.
+    bool waitForConsumer( const unsigned int timeoutMs );
+
+    // Consumer:
+
+    // Takes the newest published packet, if there is one newer than the
+    // current read slot.
+    bool acquire( void );
+
+    // acquire(), waiting up to timeoutMs for a packet to be published.
+    bool waitForPacket( const unsigned int timeoutMs );
+
+    unsigned int getReadSlot( void ) const;
+
+    // 1-based publish number of the packet in the read slot; 0 before the
+    // first acquire.
+    uint64_t getReadSequence( void ) const;
+
+private:
+
+    FramePipeline( const FramePipeline& rhs );
+    FramePipeline& operator=( const FramePipeline& rhs );
+
+    void wake( void );
+
+private:
+
+    static const unsigned int FreshBit = 0x4;
+    static const unsigned int SlotMask = 0x3;
+
+    // Slot between the two sides, plus FreshBit if it holds a packet the
+    // consumer has not acquired.
+    std::atomic<unsigned int> mMiddle;
+
+    unsigned int mWrite; // Producer only.
+    unsigned int mRead;  // Consumer only.
+
+    // Written by the producer before publishing a slot and read by the
+    // consumer after acquiring it, so the exchange orders the accesses.
+    uint64_t mSequence[SlotCount];
+    uint64_t mPublished; // Producer only.
+
+    std::atomic<unsigned int> mSleepers;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,98 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file FrameRingAllocator.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "FrameRingAllocator.h"
+
+#include <cassert>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+FrameRingAllocator::FrameRingAllocator( const size_t capacity )
+: mCapacity( capacity )
+, mHead( 0 )
+, mTail( 0 )
+, mFrames( )
+{
+    assert( capacity > 0 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t FrameRingAllocator::Allocate( const size_t size, const size_t alignment )
+{
+    if ( alignment == 0 || size > mCapacity ) {
+        return InvalidOffset;
+    }
+
+    uint64_t head = mHead.load( std::memory_order_relaxed );
+    for ( ;; ) {
+        // Aligned as an offset in the ring, not as a count, so the capacity
+        // does not have to be a multiple of the alignment.
+        const uint64_t lap = head - head % mCapacity;
+        const uint64_t offset = ( head % mCapacity + alignment - 1 ) / alignment * alignment;
+        uint64_t start = lap + offset;
+        if ( offset + size > mCapacity ) {
+            // Skip to the start of the ring, where any alignment holds.
+            start = lap + mCapacity;
+        }
+        const uint64_t end = start + size;
+
+        // The tail only moves forward, so a stale one errs on the full side.
+        if ( end - mTail.load( std::memory_order_acquire ) > mCapacity ) {
+            return InvalidOffset;
+        }
+
+        if ( mHead.compare_exchange_weak( head, end, std::memory_order_relaxed ) ) {
+            return static_cast<size_t>( start % mCapacity );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameRingAllocator::EndFrame( const uint64_t fence )
+{
+    assert( mFrames.empty() || mFrames.back().fence < fence );
+
+    Frame frame;
+    frame.fence = fence;
+    frame.end = mHead.load( std::memory_order_relaxed );
+    mFrames.push_back( frame );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameRingAllocator::Reclaim( const uint64_t completedFence )
+{
+    uint64_t tail = mTail.load( std::memory_order_relaxed );
+    while ( !mFrames.empty() && mFrames.front().fence <= completedFence ) {
+        tail = mFrames.front().end;
+        mFrames.pop_front();
+    }
+    // Publishes that the consumer is done with everything before tail.
+    mTail.store( tail, std::memory_order_release );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t FrameRingAllocator::GetCapacity( void ) const
+{
+    return mCapacity;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t FrameRingAllocator::GetUsed( void ) const
+{
+    return static_cast<size_t>( mHead.load( std::memory_order_relaxed ) - mTail.load( std::memory_order_relaxed ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t FrameRingAllocator::GetPendingFrameCount( void ) const
+{
+    return mFrames.size();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
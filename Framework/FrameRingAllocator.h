@@ -0,0 +1,79 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file FrameRingAllocator.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Hands out ranges of one large buffer, front to back around a ring, for
+/// data that lives for a frame or so: dynamic vertices, instances,
+/// constants. It only deals in offsets, so it works for any buffer.
+///
+/// Any number of threads may Allocate() at once; each allocation is one
+/// atomic compare-exchange on the head. Memory comes back a whole frame at
+/// a time: EndFrame() tags everything allocated since the last call with a
+/// fence value, and Reclaim() frees the frames whose fence the consumer (the
+/// GPU) has passed. Fences must be increasing.
+///
+/// An allocation never straddles the end of the ring; what is left there is
+/// skipped and comes back with its frame. Offsets are aligned within the
+/// ring itself, so the capacity need not be a multiple of any alignment and
+/// one ring may hold ranges of any mix of alignments.
+///</summary>
+class FrameRingAllocator {
+public:
+
+    static const size_t InvalidOffset = ~size_t( 0 );
+
+    explicit FrameRingAllocator( const size_t capacity );
+
+    // Offset of size bytes, a multiple of alignment (any power of two or
+    // not), or InvalidOffset if the frames not reclaimed yet hold too much
+    // of the ring. Thread safe.
+    size_t Allocate( const size_t size, const size_t alignment );
+
+    // Closes the current frame. Not to be called while Allocate() runs.
+    void EndFrame( const uint64_t fence );
+
+    // Frees the frames with a fence up to completedFence.
+    void Reclaim( const uint64_t completedFence );
+
+    size_t GetCapacity( void ) const;
+
+    // Bytes not free: frames waiting for their fence and the current one.
+    size_t GetUsed( void ) const;
+
+    // Frames ended and not reclaimed yet.
+    size_t GetPendingFrameCount( void ) const;
+
+private:
+
+    FrameRingAllocator( const FrameRingAllocator& rhs );
+    FrameRingAllocator& operator=( const FrameRingAllocator& rhs );
+
+    struct Frame {
+        uint64_t fence;
+        uint64_t end;
+    };
+
+    // Head and tail count bytes since the start and only grow, so a stale
+    // value can never be mistaken for a current one; the offset in the ring
+    // is the count modulo the capacity.
+    const size_t mCapacity;
+    std::atomic<uint64_t> mHead;
+    std::atomic<uint64_t> mTail;
+
+    std::deque<Frame> mFrames;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
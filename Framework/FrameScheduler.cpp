@@ -0,0 +1,162 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file FrameScheduler.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "FrameScheduler.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+FrameScheduler::FrameScheduler( const Clock& clock )
+: mClock( &clock )
+, mFixedStep( 0.0 )
+, mMaxSteps( 5 )
+, mAccumulator( 0.0 )
+, mStepTime( 0.0 )
+, mDropped( 0.0 )
+, mFrameCap( 0.0 )
+, mNextFrame( 0 )
+, mFrameScheduled( false )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameScheduler::setFixedStep( const double seconds, const unsigned int maxStepsPerFrame )
+{
+    mFixedStep = ( seconds > 0.0 ) ? seconds : 0.0;
+    mMaxSteps = ( maxStepsPerFrame > 0 ) ? maxStepsPerFrame : 1;
+    mAccumulator = 0.0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+double FrameScheduler::getFixedStep( void ) const
+{
+    return mFixedStep;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool FrameScheduler::isFixedStep( void ) const
+{
+    return mFixedStep > 0.0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameScheduler::setFrameCap( const double framesPerSecond )
+{
+    mFrameCap = ( framesPerSecond > 0.0 ) ? framesPerSecond : 0.0;
+    mFrameScheduled = false;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+double FrameScheduler::getFrameCap( void ) const
+{
+    return mFrameCap;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameScheduler::reset( void )
+{
+    mAccumulator = 0.0;
+    mStepTime = 0.0;
+    mDropped = 0.0;
+    mFrameScheduled = false;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void FrameScheduler::waitForNextFrame( void )
+{
+    if ( mFrameCap <= 0.0 ) {
+        return;
+    }
+
+    const int64_t period = static_cast<int64_t>( mClock->frequency() / mFrameCap );
+    const int64_t now = mClock->now();
+
+    if ( !mFrameScheduled ) {
+        mNextFrame = now + period;
+        mFrameScheduled = true;
+        return;
+    }
+
+    if ( now < mNextFrame ) {
+        mClock->waitUntil( mNextFrame );
+        mNextFrame += period;
+    }
+    else if ( now - mNextFrame > period ) {
+        // More than a frame behind: start over from now rather than rushing
+        // out several frames to catch up.
+        mNextFrame = now + period;
+    }
+    else {
+        // Scheduling from the deadline instead of from now keeps the
+        // average rate exact despite wake-up jitter.
+        mNextFrame += period;
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+unsigned int FrameScheduler::advance( const double elapsed )
+{
+    if ( !isFixedStep() ) {
+        mStepTime = ( elapsed > 0.0 ) ? elapsed : 0.0;
+        return 1;
+    }
+
+    mStepTime = mFixedStep;
+
+    if ( elapsed > 0.0 ) {
+        mAccumulator += elapsed;
+    }
+
+    unsigned int steps = static_cast<unsigned int>( mAccumulator / mFixedStep );
+    if ( steps > mMaxSteps ) {
+        const double excess = ( steps - mMaxSteps ) * mFixedStep;
+        mDropped += excess;
+        mAccumulator -= excess;
+        steps = mMaxSteps;
+    }
+
+    mAccumulator -= steps * mFixedStep;
+
+    // Rounding can leave the remainder a hair outside [0, step).
+    if ( mAccumulator < 0.0 ) {
+        mAccumulator = 0.0;
+    }
+
+    return steps;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+float FrameScheduler::getStepTime( void ) const
+{
+    return static_cast<float>( mStepTime );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+float FrameScheduler::getAlpha( void ) const
+{
+    if ( !isFixedStep() ) {
+        return 1.f;
+    }
+
+    return static_cast<float>( mAccumulator / mFixedStep );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+double FrameScheduler::getDroppedTime( void ) const
+{
+    return mDropped;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
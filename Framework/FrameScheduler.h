@@ -0,0 +1,78 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file FrameScheduler.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Clock.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Decides how many simulation steps each rendered frame runs and paces
+/// frames to an optional cap.
+///
+/// With a fixed step, elapsed time is accumulated and consumed in whole
+/// steps; the remainder, as a fraction of a step, is the interpolation
+/// factor between the last two simulation states. At most maxStepsPerFrame
+/// steps run per frame, and time beyond that is dropped so a long stall
+/// cannot snowball into ever longer frames.
+///
+/// With no fixed step (the default) every frame runs one step of the
+/// elapsed time, which is the classic variable timestep loop.
+///</summary>
+class FrameScheduler
+{
+
+public:
+
+    // The clock must outlive the scheduler.
+    explicit FrameScheduler( const Clock& clock = Clock::system() );
+
+    // Seconds per simulation step; 0 selects the variable timestep.
+    void setFixedStep( const double seconds, const unsigned int maxStepsPerFrame = 5 );
+    double getFixedStep( void ) const;
+    bool isFixedStep( void ) const;
+
+    // Frames per second to cap rendering at; 0 disables the cap.
+    void setFrameCap( const double framesPerSecond );
+    double getFrameCap( void ) const;
+
+    // Forgets accumulated time and the frame cap's schedule.
+    void reset( void );
+
+    // Waits until the next frame is due under the frame cap.
+    void waitForNextFrame( void );
+
+    // Adds elapsed seconds and returns the number of steps to run this frame.
+    unsigned int advance( const double elapsed );
+
+    // The dt to pass to each step returned by advance().
+    float getStepTime( void ) const;
+
+    // How far rendering is between the previous and current simulation
+    // state, in [0, 1). Always 1 for the variable timestep.
+    float getAlpha( void ) const;
+
+    // Total simulated time dropped by the step limit since reset().
+    double getDroppedTime( void ) const;
+
+private:
+
+    const Clock* mClock;
+
+    double mFixedStep;
+    unsigned int mMaxSteps;
+    double mAccumulator;
+    double mStepTime;
+    double mDropped;
+
+    double mFrameCap;
+    int64_t mNextFrame;
+    bool mFrameScheduled;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
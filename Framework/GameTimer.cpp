@@ -4,16 +4,15 @@
 
 #include "GameTimer.h"
 
-#include <Windows.h>
-
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
 //using namespace D3DApp;
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
-GameTimer::GameTimer( void )
-: mSecondsPerCount( 0.0 )
+GameTimer::GameTimer( const Clock& clock )
+: mClock( &clock )
+, mSecondsPerCount( 0.0 )
 , mDeltaTime( -1.0 )
 , mBaseTime( 0 )
 , mPausedTime( 0 )
@@ -22,9 +21,7 @@ GameTimer::GameTimer( void )
 , mStopped( false )
 {
     // Get initial seconds per count.
-    __int64 countsPerSec;
-    QueryPerformanceFrequency( 
-        reinterpret_cast<LARGE_INTEGER*>( &countsPerSec ) );
+    __int64 countsPerSec = mClock->frequency();
     mSecondsPerCount = 1.0 / static_cast<double>( countsPerSec );
 }
 
@@ -53,8 +50,7 @@ float GameTimer::deltaTime( void ) const
 
 void GameTimer::reset( void )
 {
-    __int64 currTime;
-    QueryPerformanceCounter( reinterpret_cast<LARGE_INTEGER*>( &currTime ) );
+    __int64 currTime = mClock->now();
 
     mBaseTime = currTime;
     mPrevTime = currTime;
@@ -67,8 +63,7 @@ void GameTimer::reset( void )
 void GameTimer::start( void )
 {
     if ( mStopped ) {
-        __int64 startTime;
-        QueryPerformanceCounter( reinterpret_cast<LARGE_INTEGER*>( &startTime ) );
+        __int64 startTime = mClock->now();
 
         mPausedTime += ( startTime - mStopTime );
         mPrevTime = startTime;
@@ -82,8 +77,7 @@ void GameTimer::start( void )
 void GameTimer::stop( void )
 {
     if ( !mStopped ) {
-        __int64 currTime;
-        QueryPerformanceCounter( reinterpret_cast<LARGE_INTEGER*>( &currTime ) );
+        __int64 currTime = mClock->now();
 
         mStopTime = currTime;
         mStopped = true;
@@ -99,8 +93,7 @@ void GameTimer::tick( void )
         return;
     }
 
-    __int64 currTime;
-    QueryPerformanceCounter( reinterpret_cast<LARGE_INTEGER*>( &currTime ) );
+    __int64 currTime = mClock->now();
     mCurrTime = currTime;
 
     mDeltaTime = ( mCurrTime - mPrevTime ) * mSecondsPerCount;
@@ -6,6 +6,10 @@
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
+#include "Clock.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
 //namespace D3DApp {
 
     class GameTimer
@@ -13,7 +17,8 @@
 
     public:
 
-        GameTimer( void );
+        // The clock must outlive the timer.
+        explicit GameTimer( const Clock& clock = Clock::system() );
 
         float totalTime( void ) const;
         float deltaTime( void ) const;
@@ -25,6 +30,8 @@
 
     private:
 
+        const Clock* mClock;
+
         double mSecondsPerCount;
         double mDeltaTime;
 
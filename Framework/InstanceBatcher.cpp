@@ -0,0 +1,136 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file InstanceBatcher.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "InstanceBatcher.h"
+#include "JobSystem.h"
+#include "MathHelper.h"
+
+#include <algorithm>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // Inverse transposes are computed four at a time; chunks given to jobs
+    // are a multiple of that so only the last one has a scalar tail.
+    const size_t BatchWidth = 4;
+    const size_t ChunkSize = 1024;
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+InstanceBatcher::InstanceBatcher( void )
+: mItems( )
+, mBatchIndices( )
+, mBatches( )
+, mInstances( )
+, mObjects( )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void InstanceBatcher::Clear( void )
+{
+    mItems.clear();
+    mBatchIndices.clear();
+    mBatches.clear();
+    mInstances.clear();
+    mObjects.clear();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void InstanceBatcher::Add( const unsigned int mesh, const unsigned int material, const DirectX::XMFLOAT4X4& world, const void* object )
+{
+    const uint64_t key = ( static_cast<uint64_t>( mesh ) << 32 ) | material;
+
+    auto found = mBatchIndices.find( key );
+    if ( found == mBatchIndices.end() ) {
+        Batch batch;
+        batch.mesh = mesh;
+        batch.material = material;
+        batch.object = object;
+        batch.firstInstance = 0;
+        batch.instanceCount = 0;
+
+        found = mBatchIndices.emplace( key, static_cast<uint32_t>( mBatches.size() ) ).first;
+        mBatches.push_back( batch );
+    }
+
+    ++mBatches[found->second].instanceCount;
+
+    Item item;
+    item.world = world;
+    item.object = object;
+    item.batch = found->second;
+    mItems.push_back( item );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void InstanceBatcher::Build( JobSystem* jobs )
+{
+    // Where each group starts, then every object goes to the next free slot
+    // of its group.
+    std::vector<size_t> next( mBatches.size() );
+    size_t offset = 0;
+    for ( size_t b = 0; b < mBatches.size(); ++b ) {
+        mBatches[b].firstInstance = offset;
+        next[b] = offset;
+        offset += mBatches[b].instanceCount;
+    }
+
+    mInstances.resize( mItems.size() );
+    mObjects.resize( mItems.size() );
+    for ( const Item& item : mItems ) {
+        const size_t slot = next[item.batch]++;
+        mInstances[slot].World = item.world;
+        mObjects[slot] = item.object;
+    }
+
+    const size_t count = mInstances.size();
+    auto inverseTranspose = [this, count]( size_t begin, size_t end ) {
+        begin *= ChunkSize;
+        end = std::min( end * ChunkSize, count );
+        MathHelper::InverseTransposeBatch( &mInstances[begin].World, sizeof( Instance ),
+                                           &mInstances[begin].WorldInvTranspose, sizeof( Instance ),
+                                           end - begin );
+    };
+
+    static_assert( ChunkSize % BatchWidth == 0, "Chunks must hold whole SIMD batches" );
+    const size_t chunkCount = ( count + ChunkSize - 1 ) / ChunkSize;
+    if ( jobs == nullptr || count < ParallelThreshold ) {
+        if ( count > 0 ) {
+            inverseTranspose( 0, chunkCount );
+        }
+    } else {
+        jobs->ParallelFor( 0, chunkCount, 1, inverseTranspose );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const std::vector<InstanceBatcher::Batch>& InstanceBatcher::GetBatches( void ) const
+{
+    return mBatches;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const std::vector<InstanceBatcher::Instance>& InstanceBatcher::GetInstances( void ) const
+{
+    return mInstances;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const void* InstanceBatcher::GetInstanceObject( const size_t instance ) const
+{
+    return mObjects[instance];
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,93 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file InstanceBatcher.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <DirectXMath.h>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+class JobSystem;
+
+///<summary>
+/// Groups the objects of a frame that share a mesh and a material, so each
+/// group can be drawn with one instanced draw, and lays out their
+/// per-instance data contiguously, group after group, ready to be uploaded
+/// to a DynamicRingBuffer in one go.
+///
+/// Mesh and material are whatever small integers the caller gives them, as
+/// for RenderQueue keys. Groups come out in the order their first object
+/// was added, and objects keep their order within a group, so the layout is
+/// the same every frame for the same scene. Nothing here needs a device.
+///</summary>
+class InstanceBatcher {
+public:
+
+    ///<summary>
+    /// Per-instance vertex data, matching the WORLD and WORLDINVTRANSPOSE
+    /// elements of InputLayoutDesc::InstancedPosNormal and
+    /// InputLayoutDesc::InstancedPosNormalTexTan. Both matrices are row
+    /// major, as the shaders declare them.
+    ///</summary>
+    struct Instance {
+        DirectX::XMFLOAT4X4 World;
+        DirectX::XMFLOAT4X4 WorldInvTranspose;
+    };
+
+    struct Batch {
+        unsigned int mesh;
+        unsigned int material;
+        const void* object;     // of the first instance
+        size_t firstInstance;
+        size_t instanceCount;
+    };
+
+    // Below this many instances the inverse transposes are computed on the
+    // calling thread.
+    static const size_t ParallelThreshold = 4096;
+
+    InstanceBatcher( void );
+
+    // Forgets the objects of the last frame; capacity is kept.
+    void Clear( void );
+
+    // object is passed through, and handed back by GetInstanceObject().
+    void Add( const unsigned int mesh, const unsigned int material, const DirectX::XMFLOAT4X4& world, const void* object );
+
+    // Groups what was added and fills in the instances. jobs may be null.
+    void Build( JobSystem* jobs );
+
+    const std::vector<Batch>& GetBatches( void ) const;
+    const std::vector<Instance>& GetInstances( void ) const;
+
+    // The object given with the instance at index in GetInstances().
+    const void* GetInstanceObject( const size_t instance ) const;
+
+private:
+
+    InstanceBatcher( const InstanceBatcher& rhs );
+    InstanceBatcher& operator=( const InstanceBatcher& rhs );
+
+    struct Item {
+        DirectX::XMFLOAT4X4 world;
+        const void* object;
+        uint32_t batch;
+    };
+
+    std::vector<Item> mItems;
+    std::unordered_map<uint64_t, uint32_t> mBatchIndices;
+    std::vector<Batch> mBatches;
+    std::vector<Instance> mInstances;
+    std::vector<const void*> mObjects;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,94 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file InstanceBuffer.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "InstanceBuffer.h"
+
+#include <cstring>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+InstanceBuffer::InstanceBuffer( void )
+: mRing( )
+, mStride( 0 )
+, mCapacity( 0 )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+InstanceBuffer::~InstanceBuffer( void )
+{
+    Release();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void InstanceBuffer::Create( ID3D11Device* device, const UINT stride, const UINT capacity )
+{
+    mRing.Create( device, stride * capacity, D3D11_BIND_VERTEX_BUFFER );
+    mStride = stride;
+    mCapacity = capacity;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void InstanceBuffer::Release( void )
+{
+    mRing.Release();
+    mCapacity = 0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+ID3D11Buffer* InstanceBuffer::Get( void ) const
+{
+    return mRing.Get();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+UINT InstanceBuffer::GetStride( void ) const
+{
+    return mStride;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+UINT InstanceBuffer::GetCapacity( void ) const
+{
+    return mCapacity;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void InstanceBuffer::Begin( ID3D11DeviceContext* context )
+{
+    mRing.Begin( context );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool InstanceBuffer::Upload( const void* data, const UINT count, UINT& startInstance )
+{
+    // Aligned to the stride, so the byte offset is a whole instance index.
+    UINT offset = 0;
+    void* dst = mRing.Allocate( count * mStride, mStride, offset );
+    if ( dst == nullptr ) {
+        return false;
+    }
+
+    std::memcpy( dst, data, count * mStride );
+    startInstance = offset / mStride;
+    return true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void InstanceBuffer::Unmap( ID3D11DeviceContext* context )
+{
+    mRing.Unmap( context );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,57 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file InstanceBuffer.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "DynamicRingBuffer.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Dynamic vertex buffer of per-instance data of one stride, on a
+/// DynamicRingBuffer: mapped once a frame, written by any number of
+/// uploads, and reused only once the GPU is done with a frame's instances.
+/// Uploads come back as instance indices, to draw with as
+/// StartInstanceLocation with the buffer bound at offset 0.
+///</summary>
+class InstanceBuffer {
+public:
+
+    InstanceBuffer( void );
+    ~InstanceBuffer( void );
+
+    // stride is the size of one instance in bytes, capacity the number of
+    // instances the ring holds over the frames the GPU is behind.
+    void Create( ID3D11Device* device, const UINT stride, const UINT capacity );
+    void Release( void );
+
+    ID3D11Buffer* Get( void ) const;
+    UINT GetStride( void ) const;
+    UINT GetCapacity( void ) const;
+
+    // Once a frame, before the uploads.
+    void Begin( ID3D11DeviceContext* context );
+
+    // Copies count instances into the buffer and sets startInstance to the
+    // index of the first. Fails if the ring is full. Any thread, between
+    // Begin() and Unmap().
+    bool Upload( const void* data, const UINT count, UINT& startInstance );
+
+    // Before drawing the instances uploaded since Begin().
+    void Unmap( ID3D11DeviceContext* context );
+
+private:
+
+    InstanceBuffer( const InstanceBuffer& rhs );
+    InstanceBuffer& operator=( const InstanceBuffer& rhs );
+
+    DynamicRingBuffer mRing;
+    UINT mStride;
+    UINT mCapacity;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,305 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file JobSystem.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "JobSystem.h"
+
+#include <algorithm>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // Set on worker threads only.
+    thread_local JobSystem* tOwner = nullptr;
+    thread_local unsigned int tWorkerIndex = 0;
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+JobCounter::JobCounter( void )
+: mCount( 0 )
+, mMutex( )
+, mContinuations( )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool JobCounter::IsDone( void ) const
+{
+    return mCount.load() == 0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+JobSystem::JobSystem( const unsigned int workerCount )
+: mQueues( )
+, mWorkers( )
+, mNextQueue( 0 )
+, mQueuedCount( 0 )
+, mSleepers( 0 )
+, mSleepMutex( )
+, mWakeCondition( )
+, mStopping( false )
+{
+    // With no workers, jobs still need a queue for Wait() to run them from.
+    const unsigned int queueCount = std::max( workerCount, 1u );
+    for ( unsigned int i = 0; i < queueCount; ++i ) {
+        mQueues.emplace_back( new WorkQueue );
+    }
+
+    for ( unsigned int i = 0; i < workerCount; ++i ) {
+        mWorkers.emplace_back( &JobSystem::WorkerMain, this, i );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+JobSystem::~JobSystem( void )
+{
+    {
+        std::lock_guard<std::mutex> lock( mSleepMutex );
+        mStopping = true;
+    }
+    mWakeCondition.notify_all();
+
+    // Workers finish whatever is still queued before they exit.
+    for ( auto& worker : mWorkers ) {
+        worker.join();
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+JobSystem& JobSystem::Instance( void )
+{
+    static JobSystem jobSystem( std::max( std::thread::hardware_concurrency(), 1u ) - 1 );
+    return jobSystem;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+unsigned int JobSystem::GetWorkerCount( void ) const
+{
+    return static_cast<unsigned int>( mWorkers.size() );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void JobSystem::Run( Job job, JobCounter* counter )
+{
+    if ( counter ) {
+        ++counter->mCount;
+    }
+
+    Task task = { std::move( job ), counter };
+    Push( std::move( task ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void JobSystem::RunAfter( JobCounter& dependency, Job job, JobCounter* counter )
+{
+    {
+        std::lock_guard<std::mutex> lock( dependency.mMutex );
+
+        // Finish() decrements under this mutex, so a non-zero count here is
+        // guaranteed to release the continuation later.
+        if ( dependency.mCount.load() != 0 ) {
+            if ( counter ) {
+                ++counter->mCount;
+            }
+            dependency.mContinuations.emplace_back( std::move( job ), counter );
+            return;
+        }
+    }
+
+    Run( std::move( job ), counter );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void JobSystem::Wait( JobCounter& counter )
+{
+    while ( !counter.IsDone() ) {
+        Task task;
+        if ( TryGetTask( task ) ) {
+            Execute( task );
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+
+    // The job that brought the count to zero may still be releasing the
+    // mutex; the caller is free to destroy the counter once we have it.
+    std::lock_guard<std::mutex> lock( counter.mMutex );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void JobSystem::ParallelFor( const size_t begin, const size_t end, const size_t grainSize, const RangeJob& body )
+{
+    if ( end <= begin ) {
+        return;
+    }
+
+    const size_t grain = std::max( grainSize, static_cast<size_t>( 1 ) );
+    const size_t chunkCount = ( end - begin + grain - 1 ) / grain;
+
+    if ( chunkCount == 1 || mWorkers.empty() ) {
+        body( begin, end );
+        return;
+    }
+
+    JobCounter counter;
+
+    for ( size_t i = 1; i < chunkCount; ++i ) {
+        const size_t first = begin + i * grain;
+        const size_t last = std::min( first + grain, end );
+
+        Run( [&body, first, last] { body( first, last ); }, &counter );
+    }
+
+    // The calling thread takes the first range itself, then helps with the
+    // rest.
+    body( begin, std::min( begin + grain, end ) );
+
+    Wait( counter );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void JobSystem::Push( Task task )
+{
+    // Workers push to their own queue; anyone else spreads jobs around.
+    const unsigned int index = ( tOwner == this )
+        ? tWorkerIndex
+        : mNextQueue++ % static_cast<unsigned int>( mQueues.size() );
+
+    WorkQueue& queue = *mQueues[index];
+    {
+        std::lock_guard<std::mutex> lock( queue.mutex );
+        queue.tasks.push_back( std::move( task ) );
+    }
+
+    ++mQueuedCount;
+
+    // A sleeper registers under mSleepMutex before re-checking mQueuedCount,
+    // so either it sees the job or it is counted here and gets notified.
+    if ( mSleepers.load() > 0 ) {
+        {
+            std::lock_guard<std::mutex> lock( mSleepMutex );
+        }
+        mWakeCondition.notify_one();
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool JobSystem::TryGetTask( Task& task )
+{
+    if ( mQueuedCount.load() == 0 ) {
+        return false;
+    }
+
+    const unsigned int queueCount = static_cast<unsigned int>( mQueues.size() );
+    const bool isWorker = ( tOwner == this );
+    const unsigned int self = isWorker ? tWorkerIndex : 0;
+
+    // Own queue: newest first.
+    if ( isWorker ) {
+        WorkQueue& queue = *mQueues[self];
+        std::lock_guard<std::mutex> lock( queue.mutex );
+
+        if ( !queue.tasks.empty() ) {
+            task = std::move( queue.tasks.back() );
+            queue.tasks.pop_back();
+            --mQueuedCount;
+            return true;
+        }
+    }
+
+    // Steal: oldest first, starting with the next queue over so thieves
+    // spread out.
+    for ( unsigned int i = isWorker ? 1 : 0; i < queueCount; ++i ) {
+        WorkQueue& queue = *mQueues[( self + i ) % queueCount];
+        std::lock_guard<std::mutex> lock( queue.mutex );
+
+        if ( !queue.tasks.empty() ) {
+            task = std::move( queue.tasks.front() );
+            queue.tasks.pop_front();
+            --mQueuedCount;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void JobSystem::Execute( Task& task )
+{
+    task.job();
+    task.job = nullptr;
+
+    Finish( task.counter );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void JobSystem::Finish( JobCounter* counter )
+{
+    if ( !counter ) {
+        return;
+    }
+
+    std::vector<std::pair<Job, JobCounter*>> ready;
+    {
+        std::lock_guard<std::mutex> lock( counter->mMutex );
+
+        if ( --counter->mCount == 0 ) {
+            ready.swap( counter->mContinuations );
+        }
+    }
+
+    // The counter may be gone by now; only the continuations are used.
+    for ( auto& continuation : ready ) {
+        Task task = { std::move( continuation.first ), continuation.second };
+        Push( std::move( task ) );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void JobSystem::WorkerMain( const unsigned int index )
+{
+    tOwner = this;
+    tWorkerIndex = index;
+
+    for ( ;; ) {
+        Task task;
+        if ( TryGetTask( task ) ) {
+            Execute( task );
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock( mSleepMutex );
+
+        ++mSleepers;
+        mWakeCondition.wait( lock, [this] { return mStopping || mQueuedCount.load() > 0; } );
+        --mSleepers;
+
+        if ( mStopping && mQueuedCount.load() == 0 ) {
+            break;
+        }
+    }
+
+    tOwner = nullptr;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,144 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file JobSystem.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+class JobSystem;
+
+///<summary>
+/// Counts unfinished jobs. Jobs started with a counter increment it when
+/// queued and decrement it when done; JobSystem::Wait() returns once it is
+/// zero, and jobs queued with RunAfter() start when it reaches zero.
+///</summary>
+class JobCounter
+{
+
+public:
+
+    JobCounter( void );
+
+    bool IsDone( void ) const;
+
+private:
+
+    friend class JobSystem;
+
+    JobCounter( const JobCounter& rhs );
+    JobCounter& operator=( const JobCounter& rhs );
+
+    std::atomic<int> mCount;
+
+    // Jobs waiting for mCount to reach zero, with their own counters. The
+    // mutex also keeps Wait() from returning while the last job to finish
+    // still uses the counter.
+    std::mutex mMutex;
+    std::vector<std::pair<std::function<void( void )>, JobCounter*>> mContinuations;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Pool of worker threads, one per core besides the calling thread, that
+/// every parallel Framework feature shares instead of starting its own.
+///
+/// Each worker owns a deque: it pushes and pops its own jobs at the back
+/// (newest first, which keeps nested work cache-warm) while idle workers
+/// steal from the front of the others (oldest first, which tends to be the
+/// largest piece left). Jobs queued from other threads are spread round-robin.
+///
+/// Wait() never just blocks: the waiting thread runs queued jobs until its
+/// counter is done, so jobs may wait on jobs without starving the pool, and
+/// a pool with no workers still makes progress on the waiting thread.
+///</summary>
+class JobSystem
+{
+
+public:
+
+    typedef std::function<void( void )> Job;
+
+    // Body of a ParallelFor(), called with a half-open [begin, end) range.
+    typedef std::function<void( size_t, size_t )> RangeJob;
+
+    // workerCount threads are started; the thread calling Wait() is the
+    // extra one.
+    explicit JobSystem( const unsigned int workerCount );
+    ~JobSystem( void );
+
+    // Shared instance with hardware_concurrency() - 1 workers.
+    static JobSystem& Instance( void );
+
+    unsigned int GetWorkerCount( void ) const;
+
+    // Queues job. If counter is given, it is incremented now and
+    // decremented when the job has run.
+    void Run( Job job, JobCounter* counter = nullptr );
+
+    // Queues job once dependency reaches zero (right away if it already is).
+    void RunAfter( JobCounter& dependency, Job job, JobCounter* counter = nullptr );
+
+    // Runs other jobs until counter reaches zero.
+    void Wait( JobCounter& counter );
+
+    // Calls body over [begin, end) in ranges of about grainSize elements and
+    // returns when all are done. The calling thread takes part.
+    void ParallelFor( const size_t begin, const size_t end, const size_t grainSize, const RangeJob& body );
+
+private:
+
+    JobSystem( const JobSystem& rhs );
+    JobSystem& operator=( const JobSystem& rhs );
+
+    struct Task {
+        Job job;
+        JobCounter* counter;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void Push( Task task );
+
+    // Pops from this thread's own queue, then steals from the others.
+    bool TryGetTask( Task& task );
+    void Execute( Task& task );
+    void Finish( JobCounter* counter );
+
+    void WorkerMain( const unsigned int index );
+
+private:
+
+    std::vector<std::unique_ptr<WorkQueue>> mQueues;
+    std::vector<std::thread> mWorkers;
+
+    std::atomic<unsigned int> mNextQueue;
+    std::atomic<int> mQueuedCount;
+
+    // Idle workers sleep here; Push() only takes the mutex to wake them.
+    std::atomic<int> mSleepers;
+    std::mutex mSleepMutex;
+    std::condition_variable mWakeCondition;
+    std::atomic<bool> mStopping;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
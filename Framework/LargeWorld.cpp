@@ -0,0 +1,146 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file LargeWorld.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "LargeWorld.h"
+
+#include <cmath>
+
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const float LargeWorld::SectorSize = 1024.f;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // Instances per job; a few microseconds of work each.
+    const size_t RebaseGrain = 2048;
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+WorldPosition::WorldPosition( void )
+: sector( 0, 0, 0 )
+, offset( 0.f, 0.f, 0.f )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+WorldPosition WorldPosition::FromDouble( const double x, const double y, const double z )
+{
+    const double size = static_cast<double>( LargeWorld::SectorSize );
+
+    const double sx = floor( x / size );
+    const double sy = floor( y / size );
+    const double sz = floor( z / size );
+
+    WorldPosition p;
+    p.sector = XMINT3( static_cast<int32_t>( sx ), static_cast<int32_t>( sy ), static_cast<int32_t>( sz ) );
+    p.offset = XMFLOAT3( static_cast<float>( x - sx * size ),
+                         static_cast<float>( y - sy * size ),
+                         static_cast<float>( z - sz * size ) );
+
+    return p;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+WorldPosition WorldPosition::Offset( FXMVECTOR delta ) const
+{
+    const XMVECTOR size = XMVectorReplicate( LargeWorld::SectorSize );
+
+    // Carry whole sectors out of the offset so it stays in [0, SectorSize).
+    XMVECTOR o = XMVectorAdd( XMLoadFloat3( &offset ), delta );
+    XMVECTOR carry = XMVectorFloor( XMVectorDivide( o, size ) );
+    o = XMVectorNegativeMultiplySubtract( carry, size, o );
+
+    WorldPosition p;
+    XMStoreSInt3( &p.sector, XMVectorAdd( XMLoadSInt3( &sector ), carry ) );
+    XMStoreFloat3( &p.offset, o );
+
+    return p;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void WorldPosition::ToDouble( double& x, double& y, double& z ) const
+{
+    const double size = static_cast<double>( LargeWorld::SectorSize );
+
+    x = sector.x * size + offset.x;
+    y = sector.y * size + offset.y;
+    z = sector.z * size + offset.z;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+XMVECTOR XM_CALLCONV LargeWorld::RelativeTo( const WorldPosition& p, const WorldPosition& origin )
+{
+    // Sector indices convert to float exactly up to 2^24, and SectorSize is a
+    // power of two, so the sector term is exact and only the (small) offset
+    // difference rounds.
+    XMVECTOR sectors = XMVectorSubtract( XMLoadSInt3( &p.sector ), XMLoadSInt3( &origin.sector ) );
+    XMVECTOR offsets = XMVectorSubtract( XMLoadFloat3( &p.offset ), XMLoadFloat3( &origin.offset ) );
+
+    return XMVectorSetW( XMVectorMultiplyAdd( sectors, XMVectorReplicate( SectorSize ), offsets ), 0.f );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+XMMATRIX XM_CALLCONV LargeWorld::RebaseWorldMatrix( const Instance& instance, const WorldPosition& origin )
+{
+    XMMATRIX W = XMLoadFloat3x3( &instance.axes );
+    W.r[3] = XMVectorSetW( RelativeTo( instance.position, origin ), 1.f );
+
+    return W;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void LargeWorld::RebaseWorldMatrices( const Instance* instances,
+                                      const size_t count,
+                                      const WorldPosition& origin,
+                                      XMFLOAT4X4* out,
+                                      const size_t outStride,
+                                      JobSystem* jobs )
+{
+    // Each range writes only its own instances, so ranges need no locking.
+    auto rebase = [&]( const size_t begin, const size_t end ) {
+        // Hoist the origin out of the loop; each instance is then two loads,
+        // a subtract and a multiply-add for the translation plus the 3x3 copy.
+        const XMVECTOR originSector = XMLoadSInt3( &origin.sector );
+        const XMVECTOR originOffset = XMLoadFloat3( &origin.offset );
+        const XMVECTOR size = XMVectorReplicate( SectorSize );
+        const XMVECTOR wOne = XMVectorSet( 0.f, 0.f, 0.f, 1.f );
+
+        unsigned char* dst = reinterpret_cast<unsigned char*>( out ) + begin * outStride;
+
+        for ( size_t i = begin; i < end; ++i, dst += outStride ) {
+            const Instance& inst = instances[i];
+
+            XMVECTOR sectors = XMVectorSubtract( XMLoadSInt3( &inst.position.sector ), originSector );
+            XMVECTOR offsets = XMVectorSubtract( XMLoadFloat3( &inst.position.offset ), originOffset );
+
+            XMMATRIX W = XMLoadFloat3x3( &inst.axes );
+            W.r[3] = XMVectorAdd( XMVectorMultiplyAdd( sectors, size, offsets ), wOne );
+
+            XMStoreFloat4x4( reinterpret_cast<XMFLOAT4X4*>( dst ), W );
+        }
+    };
+
+    if ( jobs != nullptr && count >= ParallelThreshold ) {
+        jobs->ParallelFor( 0, count, RebaseGrain, rebase );
+    } else {
+        rebase( 0, count );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
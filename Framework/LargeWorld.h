@@ -0,0 +1,89 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file LargeWorld.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+class JobSystem;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// A world space position split into an integer sector and a float offset
+/// within the sector. A float alone only resolves about a millimeter at
+/// 10 km, which shows up as vertex jitter; the offset here never grows past
+/// LargeWorld::SectorSize, so precision is the same anywhere in the world.
+///</summary>
+struct WorldPosition {
+    WorldPosition( void );
+
+    // Builds a normalized position from absolute double coordinates.
+    static WorldPosition FromDouble( const double x, const double y, const double z );
+
+    // Returns this position moved by a (small) float delta.
+    WorldPosition Offset( DirectX::FXMVECTOR delta ) const;
+
+    // Absolute coordinates, for debugging and tools.
+    void ToDouble( double& x, double& y, double& z ) const;
+
+    DirectX::XMINT3 sector;
+    DirectX::XMFLOAT3 offset;
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Helpers for rendering relative to the camera. Objects keep their
+/// placement as a WorldPosition, and every frame their world matrices are
+/// rebuilt with the camera at the origin, so everything near the camera is
+/// rendered with full float precision no matter how far from the world
+/// origin it is.
+///</summary>
+class LargeWorld {
+public:
+
+    // Sector edge length in world units. A power of two, so converting
+    // sector differences to float is exact.
+    static const float SectorSize;
+
+    // With fewer instances than this, RebaseWorldMatrices() runs on the
+    // calling thread.
+    static const size_t ParallelThreshold = 16384;
+
+    // Orientation and scale of an object (the upper 3x3 of its world matrix)
+    // and where it is in the world.
+    struct Instance {
+        DirectX::XMFLOAT3X3 axes;
+        WorldPosition position;
+    };
+
+    // Position of p relative to origin, as a float vector (w = 0).
+    static DirectX::XMVECTOR XM_CALLCONV RelativeTo( const WorldPosition& p, const WorldPosition& origin );
+
+    // World matrix of a single instance relative to origin.
+    static DirectX::XMMATRIX XM_CALLCONV RebaseWorldMatrix( const Instance& instance, const WorldPosition& origin );
+
+    ///<summary>
+    /// Writes the world matrix of each instance relative to origin. The
+    /// output is strided so it can go straight into a per-instance vertex
+    /// layout whose first member is the world matrix. jobs may be null;
+    /// otherwise large counts are split over it.
+    ///</summary>
+    static void RebaseWorldMatrices( const Instance* instances,
+                                     const size_t count,
+                                     const WorldPosition& origin,
+                                     DirectX::XMFLOAT4X4* out,
+                                     const size_t outStride = sizeof( DirectX::XMFLOAT4X4 ),
+                                     JobSystem* jobs = nullptr );
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -33,48 +33,92 @@ float MathHelper::AngleFromXY( float x, float y )
 
 DirectX::XMVECTOR MathHelper::RandUnitVec3()
 {
-    DirectX::XMVECTOR One = DirectX::XMVectorSet( 1.0f, 1.0f, 1.0f, 1.0f );
-    DirectX::XMVECTOR Zero = DirectX::XMVectorZero();
-
-    // Keep trying until we get a point on/in the hemisphere.
-    while ( true )
-    {
-        // Generate random point in the cube [-1,1]^3.
-        DirectX::XMVECTOR v = DirectX::XMVectorSet( MathHelper::RandF( -1.0f, 1.0f ), MathHelper::RandF( -1.0f, 1.0f ), MathHelper::RandF( -1.0f, 1.0f ), 0.0f );
-
-        // Ignore points outside the unit sphere in order to get an even distribution 
-        // over the unit sphere.  Otherwise points will clump more on the sphere near 
-        // the corners of the cube.
-
-        if ( DirectX::XMVector3Greater( DirectX::XMVector3LengthSq( v ), One ) )
-            continue;
-
-        return DirectX::XMVector3Normalize( v );
-    }
+    return Random::ThreadLocal().NextUnitVec3();
 }
 
 DirectX::XMVECTOR MathHelper::RandHemisphereUnitVec3( DirectX::XMVECTOR n )
 {
-    DirectX::XMVECTOR One = DirectX::XMVectorSet( 1.0f, 1.0f, 1.0f, 1.0f );
-    DirectX::XMVECTOR Zero = DirectX::XMVectorZero();
+    return Random::ThreadLocal().NextHemisphereUnitVec3( n );
+}
 
-    // Keep trying until we get a point on/in the hemisphere.
-    while ( true )
-    {
-        // Generate random point in the cube [-1,1]^3.
-        DirectX::XMVECTOR v = DirectX::XMVectorSet( MathHelper::RandF( -1.0f, 1.0f ), MathHelper::RandF( -1.0f, 1.0f ), MathHelper::RandF( -1.0f, 1.0f ), 0.0f );
+void MathHelper::InverseTransposeBatch( const DirectX::XMFLOAT4X4* worlds, size_t worldStride,
+                                        DirectX::XMFLOAT4X4* results, size_t resultStride,
+                                        size_t count )
+{
+    using namespace DirectX;
 
-        // Ignore points outside the unit sphere in order to get an even distribution 
-        // over the unit sphere.  Otherwise points will clump more on the sphere near 
-        // the corners of the cube.
+    auto world = [worlds, worldStride]( size_t i ) {
+        return reinterpret_cast<const XMFLOAT4X4*>( reinterpret_cast<const char*>( worlds ) + i*worldStride );
+    };
+    auto result = [results, resultStride]( size_t i ) {
+        return reinterpret_cast<XMFLOAT4X4*>( reinterpret_cast<char*>( results ) + i*resultStride );
+    };
 
-        if ( DirectX::XMVector3Greater( DirectX::XMVector3LengthSq( v ), One ) )
-            continue;
+    const XMVECTOR zero = XMVectorZero();
+    const XMFLOAT4 lastRow( 0.0f, 0.0f, 0.0f, 1.0f );
 
-        // Ignore points in the bottom hemisphere.
-        if ( DirectX::XMVector3Less( DirectX::XMVector3Dot( n, v ), Zero ) )
+    size_t i = 0;
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        const XMFLOAT4X4* m[4] = { world( i ), world( i + 1 ), world( i + 2 ), world( i + 3 ) };
+
+        // Rows 0-2 of the four matrices, transposed so that each vector holds
+        // one element of all four: a[r][c] lane k is element (r,c) of m[k].
+        XMVECTOR a[3][4];
+        for ( int r = 0; r < 3; ++r )
+        {
+            XMMATRIX rows(
+                XMLoadFloat4( reinterpret_cast<const XMFLOAT4*>( m[0]->m[r] ) ),
+                XMLoadFloat4( reinterpret_cast<const XMFLOAT4*>( m[1]->m[r] ) ),
+                XMLoadFloat4( reinterpret_cast<const XMFLOAT4*>( m[2]->m[r] ) ),
+                XMLoadFloat4( reinterpret_cast<const XMFLOAT4*>( m[3]->m[r] ) ) );
+            XMMATRIX lanes = XMMatrixTranspose( rows );
+            for ( int c = 0; c < 4; ++c )
+                a[r][c] = lanes.r[c];
+        }
+
+        // Projective matrices need the full 4x4 inverse.
+        if ( !XMVector4Equal( a[0][3], zero ) || !XMVector4Equal( a[1][3], zero ) || !XMVector4Equal( a[2][3], zero ) )
+        {
+            for ( size_t k = i; k < i + 4; ++k )
+                XMStoreFloat4x4( result( k ), InverseTranspose( XMLoadFloat4x4( world( k ) ) ) );
             continue;
-
-        return DirectX::XMVector3Normalize( v );
+        }
+
+        // The inverse transpose of the upper 3x3 is its cofactor matrix over
+        // the determinant; translation does not enter into it.
+        XMVECTOR c[3][3];
+        c[0][0] = XMVectorSubtract( XMVectorMultiply( a[1][1], a[2][2] ), XMVectorMultiply( a[1][2], a[2][1] ) );
+        c[0][1] = XMVectorSubtract( XMVectorMultiply( a[1][2], a[2][0] ), XMVectorMultiply( a[1][0], a[2][2] ) );
+        c[0][2] = XMVectorSubtract( XMVectorMultiply( a[1][0], a[2][1] ), XMVectorMultiply( a[1][1], a[2][0] ) );
+        c[1][0] = XMVectorSubtract( XMVectorMultiply( a[0][2], a[2][1] ), XMVectorMultiply( a[0][1], a[2][2] ) );
+        c[1][1] = XMVectorSubtract( XMVectorMultiply( a[0][0], a[2][2] ), XMVectorMultiply( a[0][2], a[2][0] ) );
+        c[1][2] = XMVectorSubtract( XMVectorMultiply( a[0][1], a[2][0] ), XMVectorMultiply( a[0][0], a[2][1] ) );
+        c[2][0] = XMVectorSubtract( XMVectorMultiply( a[0][1], a[1][2] ), XMVectorMultiply( a[0][2], a[1][1] ) );
+        c[2][1] = XMVectorSubtract( XMVectorMultiply( a[0][2], a[1][0] ), XMVectorMultiply( a[0][0], a[1][2] ) );
+        c[2][2] = XMVectorSubtract( XMVectorMultiply( a[0][0], a[1][1] ), XMVectorMultiply( a[0][1], a[1][0] ) );
+
+        XMVECTOR det = XMVectorMultiply( a[0][0], c[0][0] );
+        det = XMVectorMultiplyAdd( a[0][1], c[0][1], det );
+        det = XMVectorMultiplyAdd( a[0][2], c[0][2], det );
+        const XMVECTOR invDet = XMVectorReciprocal( det );
+
+        // Back from lanes to rows, with a zero fourth column.
+        for ( int r = 0; r < 3; ++r )
+        {
+            XMMATRIX lanes(
+                XMVectorMultiply( c[r][0], invDet ),
+                XMVectorMultiply( c[r][1], invDet ),
+                XMVectorMultiply( c[r][2], invDet ),
+                zero );
+            XMMATRIX rows = XMMatrixTranspose( lanes );
+            for ( int k = 0; k < 4; ++k )
+                XMStoreFloat4( reinterpret_cast<XMFLOAT4*>( result( i + k )->m[r] ), rows.r[k] );
+        }
+        for ( int k = 0; k < 4; ++k )
+            *reinterpret_cast<XMFLOAT4*>( result( i + k )->m[3] ) = lastRow;
     }
-}
\ No newline at end of file
+
+    for ( ; i < count; ++i )
+        XMStoreFloat4x4( result( i ), InverseTranspose( XMLoadFloat4x4( world( i ) ) ) );
+}
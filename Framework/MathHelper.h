@@ -5,15 +5,17 @@
 #include <DirectXMath.h>
 #include <DirectXPackedVector.h>
 
+#include "Random.h"
+
 //using namespace DirectX;
 //using namespace DirectX::PackedVector;
 
 class MathHelper {
 public:
-    // Returns random float in [0, 1).
+    // Returns random float in [0, 1), from the calling thread's generator.
     static float RandF()
     {
-        return (float)( rand() ) / (float)RAND_MAX;
+        return Random::ThreadLocal().NextFloat();
     }
 
     // Returns random float in [a, b).
@@ -61,6 +63,14 @@ public:
         return DirectX::XMMatrixTranspose( XMMatrixInverse( &det, A ) );
     }
 
+    // InverseTranspose() of count matrices, four at a time across SIMD lanes.
+    // Strides are in bytes, so the matrices may sit inside larger structs.
+    // Matrices whose last column is not (0,0,0,1) take the scalar path.
+    static void InverseTransposeBatch( const DirectX::XMFLOAT4X4* worlds, size_t worldStride,
+                                       DirectX::XMFLOAT4X4* results, size_t resultStride,
+                                       size_t count );
+
+    // Uniform unit vectors, sampled directly from the calling thread's generator.
     static DirectX::XMVECTOR RandUnitVec3();
     static DirectX::XMVECTOR RandHemisphereUnitVec3( DirectX::XMVECTOR n );
 
@@ -0,0 +1,261 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file MipGenerator.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "MipGenerator.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    const size_t RowsPerJob = 16;
+
+    // Kaiser window parameters, in destination texels; the same as the
+    // defaults of common offline mip tools.
+    const float KaiserRadius = 3.0f;
+    const float KaiserAlpha = 4.0f;
+
+    // Source taps of one destination texel. Indices are clamped to the
+    // image, so edge texels can appear more than once.
+    struct Taps {
+        std::vector<int> index;
+        std::vector<float> weight;
+    };
+
+    // Zeroth order modified Bessel function of the first kind.
+    float BesselI0( const float x )
+    {
+        float sum = 1.0f;
+        float term = 1.0f;
+        const float halfSq = 0.25f * x * x;
+
+        for ( int k = 1; k < 32 && term > sum * 1e-8f; ++k ) {
+            term *= halfSq / static_cast<float>( k * k );
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    float Sinc( const float x )
+    {
+        if ( std::fabs( x ) < 1e-5f ) {
+            return 1.0f;
+        }
+
+        const float px = XM_PI * x;
+        return std::sin( px ) / px;
+    }
+
+    float Kaiser( const float x )
+    {
+        const float t = x / KaiserRadius;
+        if ( t <= -1.0f || t >= 1.0f ) {
+            return 0.0f;
+        }
+
+        return Sinc( x ) * BesselI0( KaiserAlpha * std::sqrt( 1.0f - t * t ) ) / BesselI0( KaiserAlpha );
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    // Weights for resampling srcSize texels to dstSize along one axis. They
+    // only depend on the destination texel, so each row or column reuses
+    // the same table.
+    std::vector<Taps> BuildTaps( const int srcSize, const int dstSize, const MipGenerator::Filter filter )
+    {
+        const float scale = static_cast<float>( srcSize ) / static_cast<float>( dstSize );
+        std::vector<Taps> table( dstSize );
+
+        for ( int x = 0; x < dstSize; ++x ) {
+            Taps& taps = table[x];
+
+            // Footprint of the destination texel in source coordinates.
+            const float center = ( static_cast<float>( x ) + 0.5f ) * scale;
+            const float radius = ( filter == MipGenerator::Box ? 0.5f : KaiserRadius ) * scale;
+
+            const int first = static_cast<int>( std::floor( center - radius ) );
+            const int last = static_cast<int>( std::ceil( center + radius ) );
+
+            float total = 0.0f;
+            for ( int i = first; i < last; ++i ) {
+                float w;
+                if ( filter == MipGenerator::Box ) {
+                    // Area of the source texel [i, i+1) inside the footprint.
+                    w = std::min( center + radius, static_cast<float>( i + 1 ) ) -
+                        std::max( center - radius, static_cast<float>( i ) );
+                }
+                else {
+                    w = Kaiser( ( static_cast<float>( i ) + 0.5f - center ) / scale );
+                }
+
+                if ( w == 0.0f ) {
+                    continue;
+                }
+
+                taps.index.push_back( std::min( std::max( i, 0 ), srcSize - 1 ) );
+                taps.weight.push_back( w );
+                total += w;
+            }
+
+            assert( total > 0.0f );
+            for ( auto& w : taps.weight ) {
+                w /= total;
+            }
+        }
+
+        return table;
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    template<typename Fn>
+    void ForEachRow( const unsigned int count, Fn fn )
+    {
+        JobSystem::Instance().ParallelFor( 0, count, RowsPerJob, [&fn]( size_t first, size_t last ) {
+            for ( size_t y = first; y < last; ++y ) {
+                fn( static_cast<unsigned int>( y ) );
+            }
+        } );
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+unsigned int MipGenerator::FullChainLength( const unsigned int width, const unsigned int height )
+{
+    unsigned int size = std::max( width, height );
+    unsigned int levels = 1;
+
+    while ( size > 1 ) {
+        size >>= 1;
+        ++levels;
+    }
+
+    return levels;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+std::vector<MipGenerator::Image> MipGenerator::Generate( const Image& top,
+                                                         const Filter filter,
+                                                         const bool srgb,
+                                                         const unsigned int levels )
+{
+    const unsigned int fullChain = FullChainLength( top.width, top.height );
+    const unsigned int count = ( levels == 0 ) ? fullChain : std::min( levels, fullChain );
+
+    std::vector<Image> chain( count );
+    chain[0] = top;
+
+    if ( srgb ) {
+        SrgbToLinear( chain[0] );
+    }
+
+    // Every level is filtered from the linear float level above it.
+    for ( unsigned int i = 1; i < count; ++i ) {
+        Downsample( chain[i - 1], chain[i], filter );
+    }
+
+    if ( srgb ) {
+        for ( auto& level : chain ) {
+            LinearToSrgb( level );
+        }
+    }
+
+    return chain;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void MipGenerator::Downsample( const Image& src, Image& dst, const Filter filter )
+{
+    const unsigned int width = std::max( src.width >> 1, 1u );
+    const unsigned int height = std::max( src.height >> 1, 1u );
+
+    const std::vector<Taps> columns = BuildTaps( src.width, width, filter );
+    const std::vector<Taps> rows = BuildTaps( src.height, height, filter );
+
+    // Horizontal pass: src.width x src.height -> width x src.height.
+    Image temp( width, src.height );
+
+    ForEachRow( src.height, [&]( const unsigned int y ) {
+        const XMFLOAT4* in = &src.texels[y * src.width];
+        XMFLOAT4* out = &temp.texels[y * width];
+
+        for ( unsigned int x = 0; x < width; ++x ) {
+            const Taps& taps = columns[x];
+
+            XMVECTOR acc = XMVectorZero();
+            for ( size_t k = 0; k < taps.index.size(); ++k ) {
+                acc = XMVectorMultiplyAdd( XMVectorReplicate( taps.weight[k] ), XMLoadFloat4( in + taps.index[k] ), acc );
+            }
+
+            XMStoreFloat4( out + x, acc );
+        }
+    } );
+
+    // Vertical pass: whole rows at a time, so the inner loop streams through
+    // memory.
+    dst = Image( width, height );
+    const bool clampRinging = ( filter == Kaiser );
+
+    ForEachRow( height, [&]( const unsigned int y ) {
+        const Taps& taps = rows[y];
+        XMFLOAT4* out = &dst.texels[y * width];
+
+        for ( unsigned int x = 0; x < width; ++x ) {
+            XMVECTOR acc = XMVectorZero();
+            for ( size_t k = 0; k < taps.index.size(); ++k ) {
+                acc = XMVectorMultiplyAdd( XMVectorReplicate( taps.weight[k] ),
+                                           XMLoadFloat4( &temp.texels[taps.index[k] * width + x] ),
+                                           acc );
+            }
+
+            // Negative lobes can undershoot next to hard edges.
+            if ( clampRinging ) {
+                acc = XMVectorSaturate( acc );
+            }
+
+            XMStoreFloat4( out + x, acc );
+        }
+    } );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void MipGenerator::SrgbToLinear( Image& image )
+{
+    ForEachRow( image.height, [&image]( const unsigned int y ) {
+        XMFLOAT4* row = &image.texels[y * image.width];
+
+        for ( unsigned int x = 0; x < image.width; ++x ) {
+            XMStoreFloat4( row + x, XMColorSRGBToRGB( XMLoadFloat4( row + x ) ) );
+        }
+    } );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void MipGenerator::LinearToSrgb( Image& image )
+{
+    ForEachRow( image.height, [&image]( const unsigned int y ) {
+        XMFLOAT4* row = &image.texels[y * image.width];
+
+        for ( unsigned int x = 0; x < image.width; ++x ) {
+            XMStoreFloat4( row + x, XMColorRGBToSRGB( XMLoadFloat4( row + x ) ) );
+        }
+    } );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
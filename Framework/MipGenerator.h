@@ -0,0 +1,58 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file MipGenerator.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "CpuBlur.h"
+
+#include <vector>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Builds mip chains on the CPU for the offline texture pipeline.
+///
+/// Each level is resampled from the one above it with a separable filter in
+/// linear space: sRGB input is decoded first and only re-encoded when the
+/// texels are written out, so mips do not darken the way averaging gamma
+/// encoded values does. Levels are kept as float, so the error of 8-bit
+/// rounding does not accumulate down the chain.
+///
+/// Texels are filtered four channels at a time with DirectXMath and rows are
+/// split across the job system. Odd sizes are handled by the same polyphase
+/// weights as even ones, and borders are clamped.
+///</summary>
+class MipGenerator {
+public:
+
+    typedef CpuBlur::Image Image;
+
+    enum Filter {
+        Box,    // 2x2 average for even sizes; cheap, slightly soft.
+        Kaiser  // Kaiser-windowed sinc; sharper, with some ringing clamped off.
+    };
+
+    // Number of levels in a full chain down to 1x1.
+    static unsigned int FullChainLength( const unsigned int width, const unsigned int height );
+
+    // Returns levels 0..levels-1, where level 0 is a copy of top. levels of 0
+    // means the full chain. Input and output are linear unless srgb is set,
+    // in which case rgb is decoded before and encoded after filtering; alpha
+    // is always linear.
+    static std::vector<Image> Generate( const Image& top,
+                                        const Filter filter,
+                                        const bool srgb,
+                                        const unsigned int levels = 0 );
+
+    // Halves (rounding down, at least 1) both dimensions of a linear image.
+    static void Downsample( const Image& src, Image& dst, const Filter filter );
+
+    static void SrgbToLinear( Image& image );
+    static void LinearToSrgb( Image& image );
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,87 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file PatchFactorBuffer.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "PatchFactorBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+PatchFactorBuffer::PatchFactorBuffer( void )
+: mBuffer( nullptr )
+, mSRV( nullptr )
+, mPatchCount( 0 )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+PatchFactorBuffer::~PatchFactorBuffer( void )
+{
+    Release();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void PatchFactorBuffer::Create( ID3D11Device* device, const UINT patchCount )
+{
+    Release();
+
+    D3D11_BUFFER_DESC desc;
+    desc.Usage = D3D11_USAGE_DYNAMIC;
+    desc.ByteWidth = patchCount * sizeof( TessellationFactors::PatchFactors );
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    desc.StructureByteStride = sizeof( TessellationFactors::PatchFactors );
+
+    HR( device->CreateBuffer( &desc, 0, &mBuffer ) );
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+    srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    srvDesc.Buffer.FirstElement = 0;
+    srvDesc.Buffer.NumElements = patchCount;
+
+    HR( device->CreateShaderResourceView( mBuffer, &srvDesc, &mSRV ) );
+
+    mPatchCount = patchCount;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void PatchFactorBuffer::Release( void )
+{
+    ReleaseCOM( mSRV );
+    ReleaseCOM( mBuffer );
+    mPatchCount = 0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+ID3D11ShaderResourceView* PatchFactorBuffer::GetSRV( void ) const
+{
+    return mSRV;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void PatchFactorBuffer::Update( ID3D11DeviceContext* context, const std::vector<TessellationFactors::PatchFactors>& factors )
+{
+    if ( mBuffer == nullptr || factors.empty() ) {
+        return;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    HR( context->Map( mBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped ) );
+
+    const size_t count = std::min( factors.size(), static_cast<size_t>( mPatchCount ) );
+    std::memcpy( mapped.pData, factors.data(), count * sizeof( TessellationFactors::PatchFactors ) );
+
+    context->Unmap( mBuffer, 0 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,44 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file PatchFactorBuffer.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "D3DUtil.h"
+#include "TessellationFactors.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Dynamic structured buffer of TessellationFactors::PatchFactors, one per
+/// patch, bound to the hull shader as
+/// StructuredBuffer<PatchFactors> and indexed by SV_PrimitiveID.
+///</summary>
+class PatchFactorBuffer {
+public:
+
+    PatchFactorBuffer( void );
+    ~PatchFactorBuffer( void );
+
+    void Create( ID3D11Device* device, const UINT patchCount );
+    void Release( void );
+
+    ID3D11ShaderResourceView* GetSRV( void ) const;
+
+    // Replaces the contents with factors; extra patches are ignored.
+    void Update( ID3D11DeviceContext* context, const std::vector<TessellationFactors::PatchFactors>& factors );
+
+private:
+
+    PatchFactorBuffer( const PatchFactorBuffer& rhs );
+    PatchFactorBuffer& operator=( const PatchFactorBuffer& rhs );
+
+    ID3D11Buffer* mBuffer;
+    ID3D11ShaderResourceView* mSRV;
+    UINT mPatchCount;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,330 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file PlanarReflection.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "PlanarReflection.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // The mirror clipped by the six frustum planes gains at most one corner
+    // per plane.
+    const int MaxClippedCorners = PlanarReflection::MirrorCorners + 6;
+
+    inline float Sign( const float x )
+    {
+        return x > 0.f ? 1.f : ( x < 0.f ? -1.f : 0.f );
+    }
+
+    inline float PlaneDot( const XMFLOAT4& plane, const XMFLOAT3& p )
+    {
+        return plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w;
+    }
+
+    // a * column a + b * column b of M, as a plane scaled to a unit normal.
+    XMFLOAT4 ColumnPlane( const XMFLOAT4X4& M, const float a, const int colA, const float b, const int colB )
+    {
+        XMFLOAT4 plane(
+            a * M( 0, colA ) + b * M( 0, colB ),
+            a * M( 1, colA ) + b * M( 1, colB ),
+            a * M( 2, colA ) + b * M( 2, colB ),
+            a * M( 3, colA ) + b * M( 3, colB ) );
+
+        const float length = std::sqrt( plane.x * plane.x + plane.y * plane.y + plane.z * plane.z );
+        if ( length > 0.f ) {
+            plane.x /= length;
+            plane.y /= length;
+            plane.z /= length;
+            plane.w /= length;
+        }
+        return plane;
+    }
+
+    // Keeps the part of the polygon on the positive side of the plane.
+    int ClipPolygon( const XMFLOAT3* in, const int count, const XMFLOAT4& plane, XMFLOAT3* out )
+    {
+        int outCount = 0;
+        for ( int i = 0; i < count; ++i ) {
+            const XMFLOAT3& a = in[i];
+            const XMFLOAT3& b = in[( i + 1 ) % count];
+            const float da = PlaneDot( plane, a );
+            const float db = PlaneDot( plane, b );
+
+            if ( da >= 0.f ) {
+                out[outCount++] = a;
+            }
+            if ( ( da >= 0.f ) != ( db >= 0.f ) ) {
+                const float t = da / ( da - db );
+                out[outCount++] = XMFLOAT3( a.x + t * ( b.x - a.x ), a.y + t * ( b.y - a.y ), a.z + t * ( b.z - a.z ) );
+            }
+        }
+        return outCount;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+PlanarReflection::PlanarReflection( void )
+: mPlane( 0.f, 0.f, -1.f, 0.f )
+, mVisible( false )
+, mScreenBounds( 0.f, 0.f, 0.f, 0.f )
+{
+    for ( int c = 0; c < MirrorCorners; ++c ) {
+        mCorners[c] = XMFLOAT3( 0.f, 0.f, 0.f );
+    }
+    for ( int p = 0; p < 6; ++p ) {
+        mFrustumPlanes[p] = XMFLOAT4( 0.f, 0.f, 0.f, 0.f );
+    }
+
+    XMStoreFloat4x4( &mReflection, XMMatrixIdentity() );
+    XMStoreFloat4x4( &mReflectedView, XMMatrixIdentity() );
+    XMStoreFloat4x4( &mObliqueProj, XMMatrixIdentity() );
+    XMStoreFloat4x4( &mReflectedViewProj, XMMatrixIdentity() );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void PlanarReflection::SetMirror( const XMFLOAT3 corners[MirrorCorners], const XMFLOAT3& normal )
+{
+    for ( int c = 0; c < MirrorCorners; ++c ) {
+        mCorners[c] = corners[c];
+    }
+
+    const float length = std::sqrt( normal.x * normal.x + normal.y * normal.y + normal.z * normal.z );
+    const XMFLOAT3 n( normal.x / length, normal.y / length, normal.z / length );
+    mPlane = XMFLOAT4( n.x, n.y, n.z, -( n.x * corners[0].x + n.y * corners[0].y + n.z * corners[0].z ) );
+
+    // p' = p - 2 (n.p + d) n, as a row-vector matrix.
+    const float N[4] = { n.x, n.y, n.z, mPlane.w };
+    for ( int i = 0; i < 4; ++i ) {
+        for ( int j = 0; j < 4; ++j ) {
+            const float identity = i == j ? 1.f : 0.f;
+            mReflection( i, j ) = j < 3 ? identity - 2.f * N[i] * N[j] : identity;
+        }
+    }
+
+    mVisible = false;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const XMFLOAT4& PlanarReflection::GetPlane( void ) const
+{
+    return mPlane;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool PlanarReflection::Update( const XMFLOAT3& eye, FXMMATRIX view, CXMMATRIX proj )
+{
+    mVisible = false;
+
+    // From behind, the mirror shows nothing.
+    if ( PlaneDot( mPlane, eye ) <= 0.f ) {
+        return false;
+    }
+
+    // What of the mirror is inside the camera's frustum, and where that is
+    // on screen.
+    XMFLOAT4X4 viewProj;
+    XMStoreFloat4x4( &viewProj, XMMatrixMultiply( view, proj ) );
+
+    const XMFLOAT4 cameraPlanes[6] = {
+        ColumnPlane( viewProj, 1.f, 3, +1.f, 0 ),
+        ColumnPlane( viewProj, 1.f, 3, -1.f, 0 ),
+        ColumnPlane( viewProj, 1.f, 3, +1.f, 1 ),
+        ColumnPlane( viewProj, 1.f, 3, -1.f, 1 ),
+        ColumnPlane( viewProj, 0.f, 3, +1.f, 2 ),
+        ColumnPlane( viewProj, 1.f, 3, -1.f, 2 )
+    };
+
+    XMFLOAT3 polygon[2][MaxClippedCorners];
+    int count = MirrorCorners;
+    for ( int c = 0; c < MirrorCorners; ++c ) {
+        polygon[0][c] = mCorners[c];
+    }
+    int current = 0;
+    for ( int p = 0; p < 6 && count > 0; ++p ) {
+        count = ClipPolygon( polygon[current], count, cameraPlanes[p], polygon[1 - current] );
+        current = 1 - current;
+    }
+    if ( count < 3 ) {
+        return false;
+    }
+
+    XMFLOAT4 bounds( 1.f, 1.f, -1.f, -1.f );
+    for ( int c = 0; c < count; ++c ) {
+        const XMFLOAT3& p = polygon[current][c];
+        const float x = p.x * viewProj._11 + p.y * viewProj._21 + p.z * viewProj._31 + viewProj._41;
+        const float y = p.x * viewProj._12 + p.y * viewProj._22 + p.z * viewProj._32 + viewProj._42;
+        const float w = p.x * viewProj._14 + p.y * viewProj._24 + p.z * viewProj._34 + viewProj._44;
+        if ( w <= 0.f ) {
+            continue;
+        }
+        bounds.x = std::min( bounds.x, x / w );
+        bounds.y = std::min( bounds.y, y / w );
+        bounds.z = std::max( bounds.z, x / w );
+        bounds.w = std::max( bounds.w, y / w );
+    }
+    bounds.x = std::max( bounds.x, -1.f );
+    bounds.y = std::max( bounds.y, -1.f );
+    bounds.z = std::min( bounds.z, 1.f );
+    bounds.w = std::min( bounds.w, 1.f );
+    if ( bounds.z <= bounds.x || bounds.w <= bounds.y ) {
+        return false;
+    }
+    mScreenBounds = bounds;
+
+    // The reflected camera, with the mirror plane, taken into its view
+    // space, for the near plane.
+    const XMMATRIX reflectedView = XMMatrixMultiply( XMLoadFloat4x4( &mReflection ), view );
+    XMStoreFloat4x4( &mReflectedView, reflectedView );
+
+    XMFLOAT4X4 toWorld;
+    XMStoreFloat4x4( &toWorld, XMMatrixInverse( nullptr, reflectedView ) );
+    const float C[4] = { mPlane.x, mPlane.y, mPlane.z, mPlane.w };
+    float clip[4];
+    for ( int i = 0; i < 4; ++i ) {
+        clip[i] = toWorld( i, 0 ) * C[0] + toWorld( i, 1 ) * C[1] + toWorld( i, 2 ) * C[2] + toWorld( i, 3 ) * C[3];
+    }
+
+    XMStoreFloat4x4( &mObliqueProj, proj );
+    ObliqueProjection( mObliqueProj, XMFLOAT4( clip[0], clip[1], clip[2], clip[3] ) );
+
+    const XMMATRIX reflectedViewProj = XMMatrixMultiply( reflectedView, XMLoadFloat4x4( &mObliqueProj ) );
+    XMStoreFloat4x4( &mReflectedViewProj, reflectedViewProj );
+
+    // Its frustum, cut down to the mirror's screen bounds. Through the
+    // reflected view these planes hold unreflected geometry.
+    const XMFLOAT4X4& M = mReflectedViewProj;
+    mFrustumPlanes[0] = ColumnPlane( M, +1.f, 0, -bounds.x, 3 );
+    mFrustumPlanes[1] = ColumnPlane( M, -1.f, 0, +bounds.z, 3 );
+    mFrustumPlanes[2] = ColumnPlane( M, +1.f, 1, -bounds.y, 3 );
+    mFrustumPlanes[3] = ColumnPlane( M, -1.f, 1, +bounds.w, 3 );
+    mFrustumPlanes[4] = ColumnPlane( M, +1.f, 2, 0.f, 3 );
+    mFrustumPlanes[5] = ColumnPlane( M, -1.f, 2, +1.f, 3 );
+
+    mVisible = true;
+    return true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool PlanarReflection::IsVisible( void ) const
+{
+    return mVisible;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+XMMATRIX PlanarReflection::GetReflection( void ) const
+{
+    return XMLoadFloat4x4( &mReflection );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+XMMATRIX PlanarReflection::GetReflectedView( void ) const
+{
+    return XMLoadFloat4x4( &mReflectedView );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+XMMATRIX PlanarReflection::GetObliqueProj( void ) const
+{
+    return XMLoadFloat4x4( &mObliqueProj );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+XMMATRIX PlanarReflection::GetReflectedViewProj( void ) const
+{
+    return XMLoadFloat4x4( &mReflectedViewProj );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const XMFLOAT4& PlanarReflection::GetScreenBounds( void ) const
+{
+    return mScreenBounds;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const XMFLOAT4* PlanarReflection::GetFrustumPlanes( void ) const
+{
+    return mFrustumPlanes;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool PlanarReflection::IsSphereVisible( const XMFLOAT3& center, const float radius ) const
+{
+    if ( !mVisible ) {
+        return false;
+    }
+
+    for ( int p = 0; p < 6; ++p ) {
+        if ( PlaneDot( mFrustumPlanes[p], center ) < -radius ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool PlanarReflection::IsBoxVisible( const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax ) const
+{
+    if ( !mVisible ) {
+        return false;
+    }
+
+    // The corner furthest along each plane's normal.
+    for ( int p = 0; p < 6; ++p ) {
+        const XMFLOAT4& plane = mFrustumPlanes[p];
+        const XMFLOAT3 corner(
+            plane.x >= 0.f ? boundsMax.x : boundsMin.x,
+            plane.y >= 0.f ? boundsMax.y : boundsMin.y,
+            plane.z >= 0.f ? boundsMax.z : boundsMin.z );
+        if ( PlaneDot( plane, corner ) < 0.f ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void PlanarReflection::ObliqueProjection( XMFLOAT4X4& proj, const XMFLOAT4& clipPlane )
+{
+    // The view-space corner of the frustum opposite the clip plane, on the
+    // far plane: x and y at the edge the plane leans away from, z' = w'.
+    const float qx = ( Sign( clipPlane.x ) - proj._31 ) / proj._11;
+    const float qy = ( Sign( clipPlane.y ) - proj._32 ) / proj._22;
+    const float qz = 1.f;
+    const float qw = ( 1.f - proj._33 ) / proj._43;
+
+    const float dot = clipPlane.x * qx + clipPlane.y * qy + clipPlane.z * qz + clipPlane.w * qw;
+    if ( dot <= 0.f ) {
+        return;
+    }
+
+    // z' becomes the distance to the clip plane, scaled so that corner
+    // still lands on depth 1.
+    const float scale = qz / dot;
+    proj._13 = scale * clipPlane.x;
+    proj._23 = scale * clipPlane.y;
+    proj._33 = scale * clipPlane.z;
+    proj._43 = scale * clipPlane.w;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
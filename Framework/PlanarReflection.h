@@ -0,0 +1,95 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file PlanarReflection.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <DirectXMath.h>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// The camera that sees a flat mirror's reflection, and what it needs to
+/// draw, worked out once per frame.
+///
+/// The reflected view is the mirror reflection followed by the camera's
+/// view, so unreflected world geometry drawn with it lands where its
+/// reflection shows. Its projection has the near plane swapped for the
+/// mirror plane (Lengyel's oblique near plane), so whatever is behind the
+/// mirror is clipped instead of showing through. Its frustum is shrunk to
+/// the rectangle the mirror covers on screen, which is all the stencil
+/// lets through anyway, and geometry is culled against that.
+///
+/// Update() says whether there is anything to draw at all: nothing when
+/// the eye is behind the mirror or the mirror is off screen. Matrices
+/// follow DirectXMath: row vectors, left handed, depth 0 to 1. Nothing
+/// here needs a device.
+///</summary>
+class PlanarReflection {
+public:
+
+    static const int MirrorCorners = 4;
+
+    PlanarReflection( void );
+
+    // A flat convex mirror, corners in order around its edge, facing
+    // along normal.
+    void SetMirror( const DirectX::XMFLOAT3 corners[MirrorCorners], const DirectX::XMFLOAT3& normal );
+
+    // The mirror plane, positive in front.
+    const DirectX::XMFLOAT4& GetPlane( void ) const;
+
+    // Works out the reflected camera for the camera at eye. False when the
+    // mirror faces away or is off screen, and the reflection can be
+    // skipped.
+    bool Update( const DirectX::XMFLOAT3& eye, DirectX::FXMMATRIX view, DirectX::CXMMATRIX proj );
+
+    bool IsVisible( void ) const;
+
+    // Reflection about the mirror plane, for world matrices and light
+    // directions.
+    DirectX::XMMATRIX GetReflection( void ) const;
+
+    DirectX::XMMATRIX GetReflectedView( void ) const;
+    DirectX::XMMATRIX GetObliqueProj( void ) const;
+    DirectX::XMMATRIX GetReflectedViewProj( void ) const;
+
+    // What the mirror covers in normalized device coordinates: min x,
+    // min y, max x, max y.
+    const DirectX::XMFLOAT4& GetScreenBounds( void ) const;
+
+    // Six world-space planes facing in around what the reflected camera
+    // can show (left, right, bottom, top, mirror, far), for unreflected
+    // geometry.
+    const DirectX::XMFLOAT4* GetFrustumPlanes( void ) const;
+
+    // Whether unreflected geometry in these bounds can show in the mirror.
+    bool IsSphereVisible( const DirectX::XMFLOAT3& center, const float radius ) const;
+    bool IsBoxVisible( const DirectX::XMFLOAT3& boundsMin, const DirectX::XMFLOAT3& boundsMax ) const;
+
+    // Replaces the near plane of proj with clipPlane, given in view space
+    // and positive on the side to keep, which the eye must be behind. The
+    // far plane is tilted as little as it can be while keeping depth
+    // within 0 to 1.
+    static void ObliqueProjection( DirectX::XMFLOAT4X4& proj, const DirectX::XMFLOAT4& clipPlane );
+
+private:
+
+    DirectX::XMFLOAT3 mCorners[MirrorCorners];
+    DirectX::XMFLOAT4 mPlane;
+
+    bool mVisible;
+
+    DirectX::XMFLOAT4X4 mReflection;
+    DirectX::XMFLOAT4X4 mReflectedView;
+    DirectX::XMFLOAT4X4 mObliqueProj;
+    DirectX::XMFLOAT4X4 mReflectedViewProj;
+
+    DirectX::XMFLOAT4 mScreenBounds;
+    DirectX::XMFLOAT4 mFrustumPlanes[6];
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
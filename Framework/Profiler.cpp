@@ -0,0 +1,325 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file Profiler.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+// Single producer (the owning thread), single consumer (drain()) ring.
+struct Profiler::ThreadBuffer {
+    explicit ThreadBuffer( const unsigned int threadIndex )
+    : head( 0 )
+    , tail( 0 )
+    , dropped( 0 )
+    , depth( 0 )
+    , index( threadIndex )
+    {
+
+    }
+
+    Event events[RingCapacity];
+
+    std::atomic<unsigned int> head; // Written by the owning thread.
+    std::atomic<unsigned int> tail; // Written by drain().
+    std::atomic<unsigned int> dropped;
+
+    unsigned int depth; // Owning thread only.
+    unsigned int index;
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+Profiler::Zone::Zone( const char* name )
+: mName( name )
+, mBegin( 0 )
+, mDepth( Profiler::instance().enterZone() )
+{
+    mBegin = Profiler::instance().getClock().now();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+Profiler::Zone::~Zone( void )
+{
+    Profiler& profiler = Profiler::instance();
+
+    const int64_t end = profiler.getClock().now();
+    profiler.leaveZone();
+    profiler.record( mName, mBegin, end, mDepth );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+Profiler& Profiler::instance( void )
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+Profiler::Profiler( void )
+: mClock( &Clock::system() )
+, mBuffersMutex( )
+, mBuffers( )
+, mFrameBegin( 0 )
+, mFrameTimes( FrameHistory, 0.0 )
+, mFrameCount( 0 )
+, mCapturing( false )
+, mCaptureBegin( 0 )
+, mCaptured( )
+, mDropped( 0 )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+Profiler::~Profiler( void )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Profiler::setClock( const Clock& clock )
+{
+    mClock = &clock;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const Clock& Profiler::getClock( void ) const
+{
+    return *mClock;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+Profiler::ThreadBuffer& Profiler::getThreadBuffer( void )
+{
+    thread_local ThreadBuffer* buffer = nullptr;
+
+    if ( !buffer ) {
+        std::lock_guard<std::mutex> lock( mBuffersMutex );
+
+        // Buffers are never freed before the profiler, so zones recorded by a
+        // thread that has since exited are still collected.
+        mBuffers.emplace_back( new ThreadBuffer( static_cast<unsigned int>( mBuffers.size() ) ) );
+        buffer = mBuffers.back().get();
+    }
+
+    return *buffer;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+unsigned int Profiler::enterZone( void )
+{
+    return getThreadBuffer().depth++;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Profiler::leaveZone( void )
+{
+    --getThreadBuffer().depth;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Profiler::record( const char* name, const int64_t begin, const int64_t end, const unsigned int depth )
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+
+    const unsigned int head = buffer.head.load( std::memory_order_relaxed );
+    const unsigned int tail = buffer.tail.load( std::memory_order_acquire );
+
+    if ( head - tail >= RingCapacity ) {
+        buffer.dropped.fetch_add( 1, std::memory_order_relaxed );
+        return;
+    }
+
+    Event& e = buffer.events[head % RingCapacity];
+    e.name = name;
+    e.begin = begin;
+    e.end = end;
+    e.threadIndex = buffer.index;
+    e.depth = depth;
+
+    buffer.head.store( head + 1, std::memory_order_release );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Profiler::drain( void )
+{
+    std::lock_guard<std::mutex> lock( mBuffersMutex );
+
+    for ( auto& buffer : mBuffers ) {
+        const unsigned int head = buffer->head.load( std::memory_order_acquire );
+        unsigned int tail = buffer->tail.load( std::memory_order_relaxed );
+
+        if ( mCapturing ) {
+            for ( ; tail != head; ++tail ) {
+                const Event& e = buffer->events[tail % RingCapacity];
+                if ( e.end >= mCaptureBegin ) {
+                    mCaptured.push_back( e );
+                }
+            }
+        }
+        else {
+            tail = head;
+        }
+
+        buffer->tail.store( tail, std::memory_order_release );
+        mDropped += buffer->dropped.exchange( 0, std::memory_order_relaxed );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Profiler::beginFrame( void )
+{
+    enterZone();
+    mFrameBegin = mClock->now();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Profiler::endFrame( void )
+{
+    const int64_t end = mClock->now();
+
+    leaveZone();
+    record( "Frame", mFrameBegin, end, 0 );
+
+    const double ms = 1000.0 * static_cast<double>( end - mFrameBegin ) / mClock->frequency();
+    mFrameTimes[mFrameCount % FrameHistory] = ms;
+    ++mFrameCount;
+
+    drain();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+Profiler::FrameStats Profiler::getFrameStats( void ) const
+{
+    FrameStats stats = { 0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+    const size_t n = std::min( mFrameCount, FrameHistory );
+    if ( n == 0 ) {
+        return stats;
+    }
+
+    std::vector<double> sorted( mFrameTimes.begin(), mFrameTimes.begin() + n );
+    std::sort( sorted.begin(), sorted.end() );
+
+    // Nearest-rank percentile.
+    auto percentile = [&sorted, n]( const double p ) {
+        size_t rank = static_cast<size_t>( ceil( p * n ) );
+        return sorted[rank > 0 ? rank - 1 : 0];
+    };
+
+    double sum = 0.0;
+    for ( auto t : sorted ) {
+        sum += t;
+    }
+
+    stats.frameCount = n;
+    stats.meanMs = sum / n;
+    stats.p50Ms = percentile( 0.50 );
+    stats.p95Ms = percentile( 0.95 );
+    stats.p99Ms = percentile( 0.99 );
+    stats.maxMs = sorted.back();
+
+    return stats;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Profiler::beginCapture( void )
+{
+    // Throw away anything recorded before the capture.
+    drain();
+
+    mCaptured.clear();
+    mDropped = 0;
+    mCaptureBegin = mClock->now();
+    mCapturing = true;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Profiler::endCapture( void )
+{
+    drain();
+    mCapturing = false;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool Profiler::isCapturing( void ) const
+{
+    return mCapturing;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const std::vector<Profiler::Event>& Profiler::getCapturedEvents( void ) const
+{
+    return mCaptured;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t Profiler::getDroppedCount( void ) const
+{
+    return mDropped;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool Profiler::writeChromeTrace( const std::string& path ) const
+{
+    std::ofstream out( path.c_str() );
+    if ( !out ) {
+        return false;
+    }
+
+    // Timestamps are in microseconds relative to the start of the capture.
+    const double toMicroseconds = 1000000.0 / mClock->frequency();
+
+    out << "{\"traceEvents\":[\n";
+
+    bool first = true;
+    for ( auto& e : mCaptured ) {
+        std::string name( e.name );
+        for ( size_t i = 0; i < name.size(); ++i ) {
+            if ( name[i] == '"' || name[i] == '\\' ) {
+                name.insert( i++, 1, '\\' );
+            }
+        }
+
+        if ( !first ) {
+            out << ",\n";
+        }
+        first = false;
+
+        out << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.threadIndex
+            << ",\"ts\":" << ( e.begin - mCaptureBegin ) * toMicroseconds
+            << ",\"dur\":" << ( e.end - e.begin ) * toMicroseconds << "}";
+    }
+
+    out << "\n]}\n";
+
+    return out.good();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
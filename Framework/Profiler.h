@@ -0,0 +1,150 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file Profiler.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Clock.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#define PROFILE_CONCAT_IMPL( a, b ) a##b
+#define PROFILE_CONCAT( a, b ) PROFILE_CONCAT_IMPL( a, b )
+
+// Times the rest of the enclosing scope as a zone. The name must be a string
+// literal (or otherwise outlive any capture it appears in).
+#if defined( PROFILER_DISABLED )
+#define PROFILE_ZONE( name ) ( (void)0 )
+#else
+#define PROFILE_ZONE( name ) Profiler::Zone PROFILE_CONCAT( profileZone, __LINE__ )( name )
+#endif
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Hierarchical CPU profiler. Zones are recorded into a per-thread ring
+/// buffer that only its own thread writes, so recording takes no locks; the
+/// main thread drains every ring in endFrame().
+///
+/// Frame times are kept for the last FrameHistory frames to report
+/// percentiles, which show spikes that an average hides. Between
+/// beginCapture() and endCapture() every zone is kept and can be written as
+/// Chrome trace JSON (chrome://tracing or ui.perfetto.dev).
+///</summary>
+class Profiler
+{
+
+public:
+
+    struct Event {
+        const char* name;
+        int64_t begin;
+        int64_t end;
+        unsigned int threadIndex;
+        unsigned int depth;
+    };
+
+    struct FrameStats {
+        size_t frameCount;
+        double meanMs;
+        double p50Ms;
+        double p95Ms;
+        double p99Ms;
+        double maxMs;
+    };
+
+    // Records the time from construction to destruction as a zone.
+    class Zone
+    {
+
+    public:
+
+        explicit Zone( const char* name );
+        ~Zone( void );
+
+    private:
+
+        Zone( const Zone& rhs );
+        Zone& operator=( const Zone& rhs );
+
+        const char* mName;
+        int64_t mBegin;
+        unsigned int mDepth;
+
+    };
+
+    static const size_t FrameHistory = 1024;
+
+    // Zones per thread that may be pending between two endFrame() calls;
+    // further zones are dropped and counted.
+    static const unsigned int RingCapacity = 8192;
+
+    static Profiler& instance( void );
+
+    // The clock must outlive the profiler. Only call while no zones are open.
+    void setClock( const Clock& clock );
+    const Clock& getClock( void ) const;
+
+    // Brackets a frame on the main thread. endFrame() also collects the
+    // zones every thread finished since the last call.
+    void beginFrame( void );
+    void endFrame( void );
+
+    FrameStats getFrameStats( void ) const;
+
+    void beginCapture( void );
+    void endCapture( void );
+    bool isCapturing( void ) const;
+
+    const std::vector<Event>& getCapturedEvents( void ) const;
+    size_t getDroppedCount( void ) const;
+
+    // Writes the last capture as Chrome trace JSON.
+    bool writeChromeTrace( const std::string& path ) const;
+
+    // Called by Zone.
+    void record( const char* name, const int64_t begin, const int64_t end, const unsigned int depth );
+    unsigned int enterZone( void );
+    void leaveZone( void );
+
+private:
+
+    struct ThreadBuffer;
+
+    Profiler( void );
+    ~Profiler( void );
+
+    Profiler( const Profiler& rhs );
+    Profiler& operator=( const Profiler& rhs );
+
+    ThreadBuffer& getThreadBuffer( void );
+    void drain( void );
+
+private:
+
+    const Clock* mClock;
+
+    // Guards mBuffers; only taken when a thread records its first zone and
+    // when draining.
+    std::mutex mBuffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> mBuffers;
+
+    int64_t mFrameBegin;
+    std::vector<double> mFrameTimes;
+    size_t mFrameCount;
+
+    bool mCapturing;
+    int64_t mCaptureBegin;
+    std::vector<Event> mCaptured;
+    size_t mDropped;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,153 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file RadixSort.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "JobSystem.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Stable LSD radix sort of records by their unsigned integer key member,
+/// smallest key first, eight bits a pass. Digits in which no two keys
+/// differ are skipped, which is most of them when the keys are packed
+/// fields and only some of the fields vary.
+///
+/// With a job system and at least parallelThreshold records, each pass is
+/// split into chunks: the chunks count their digits in parallel, the
+/// counts are turned into write offsets digit-major then chunk by chunk
+/// (which keeps the sort stable), and the chunks scatter in parallel.
+///
+/// RenderQueue, TransparencySorter and Vegetation all sort with it.
+///</summary>
+class RadixSort {
+public:
+
+    static const unsigned int DigitBits = 8;
+    static const size_t DigitCount = size_t( 1 ) << DigitBits;
+
+    // Records per chunk when sorting in parallel; smaller chunks spend
+    // more on histograms than they gain.
+    static const size_t MinChunkSize = 4096;
+
+    // Sorts records by records[i].key, using scratch (resized to match) as
+    // the other buffer. jobs may be null to sort on the calling thread.
+    template <typename Record>
+    static void Sort( std::vector<Record>& records,
+                      std::vector<Record>& scratch,
+                      JobSystem* jobs,
+                      const size_t parallelThreshold );
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+template <typename Record>
+void RadixSort::Sort( std::vector<Record>& records,
+                      std::vector<Record>& scratch,
+                      JobSystem* jobs,
+                      const size_t parallelThreshold )
+{
+    const size_t count = records.size();
+    if ( count < 2 ) {
+        return;
+    }
+
+    const unsigned int keyBits = sizeof( records[0].key ) * 8;
+    static_assert( sizeof( records[0].key ) <= sizeof( uint64_t ), "Radix sort keys are at most 64 bits" );
+
+    size_t chunkCount = 1;
+    if ( jobs != nullptr && count >= parallelThreshold ) {
+        chunkCount = std::min<size_t>( jobs->GetWorkerCount() + 1, count / MinChunkSize );
+        chunkCount = std::max<size_t>( chunkCount, 1 );
+    }
+    const size_t chunkSize = ( count + chunkCount - 1 ) / chunkCount;
+
+    auto forEachChunk = [&]( const std::function<void( size_t, size_t, size_t )>& body ) {
+        auto run = [&]( size_t firstChunk, size_t lastChunk ) {
+            for ( size_t c = firstChunk; c < lastChunk; ++c ) {
+                body( c, c * chunkSize, std::min( count, ( c + 1 ) * chunkSize ) );
+            }
+        };
+        if ( chunkCount == 1 ) {
+            run( 0, 1 );
+        } else {
+            jobs->ParallelFor( 0, chunkCount, 1, run );
+        }
+    };
+
+    // Bits that differ between any two keys.
+    const uint64_t first = static_cast<uint64_t>( records[0].key );
+    std::vector<uint64_t> varyingPerChunk( chunkCount, 0 );
+    forEachChunk( [&]( size_t c, size_t begin, size_t end ) {
+        uint64_t bits = 0;
+        for ( size_t i = begin; i < end; ++i ) {
+            bits |= static_cast<uint64_t>( records[i].key ) ^ first;
+        }
+        varyingPerChunk[c] = bits;
+    } );
+
+    uint64_t varying = 0;
+    for ( size_t c = 0; c < chunkCount; ++c ) {
+        varying |= varyingPerChunk[c];
+    }
+    if ( varying == 0 ) {
+        return;
+    }
+
+    // Per chunk: digit counts, then where the chunk writes each digit.
+    std::vector<size_t> histograms( chunkCount * DigitCount );
+    scratch.resize( count );
+
+    Record* src = records.data();
+    Record* dst = scratch.data();
+
+    for ( unsigned int shift = 0; shift < keyBits; shift += DigitBits ) {
+        if ( ( ( varying >> shift ) & ( DigitCount - 1 ) ) == 0 ) {
+            continue;
+        }
+
+        forEachChunk( [&]( size_t c, size_t begin, size_t end ) {
+            size_t* histogram = &histograms[c * DigitCount];
+            std::fill( histogram, histogram + DigitCount, size_t( 0 ) );
+            for ( size_t i = begin; i < end; ++i ) {
+                ++histogram[( static_cast<uint64_t>( src[i].key ) >> shift ) & ( DigitCount - 1 )];
+            }
+        } );
+
+        size_t offset = 0;
+        for ( size_t digit = 0; digit < DigitCount; ++digit ) {
+            for ( size_t c = 0; c < chunkCount; ++c ) {
+                const size_t n = histograms[c * DigitCount + digit];
+                histograms[c * DigitCount + digit] = offset;
+                offset += n;
+            }
+        }
+        assert( offset == count );
+
+        forEachChunk( [&]( size_t c, size_t begin, size_t end ) {
+            size_t* offsets = &histograms[c * DigitCount];
+            for ( size_t i = begin; i < end; ++i ) {
+                dst[offsets[( static_cast<uint64_t>( src[i].key ) >> shift ) & ( DigitCount - 1 )]++] = src[i];
+            }
+        } );
+
+        std::swap( src, dst );
+    }
+
+    if ( src != records.data() ) {
+        records.swap( scratch );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
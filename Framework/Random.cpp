@@ -0,0 +1,313 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file Random.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Random.h"
+
+#include <atomic>
+#include <cmath>
+
+#if defined( _XM_SSE_INTRINSICS_ )
+#include <emmintrin.h>
+#endif
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    std::atomic<uint64_t> gThreadLocalSeed( Random::DefaultSeed );
+    std::atomic<uint64_t> gNextThreadStream( 0 );
+
+    // Used only to expand the seed into the generator state.
+    inline uint64_t SplitMix64( uint64_t& x )
+    {
+        uint64_t z = ( x += 0x9e3779b97f4a7c15ULL );
+        z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+        z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+        return z ^ ( z >> 31 );
+    }
+
+    inline uint32_t Rotl( const uint32_t x, const int k )
+    {
+        return ( x << k ) | ( x >> ( 32 - k ) );
+    }
+
+    // 2^-24, so the top 24 bits of an output map to [0, 1).
+    const float FloatScale = 1.f / 16777216.f;
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+Random::Random( const uint64_t seed, const uint64_t stream )
+: mBufferPos( 4 )
+{
+    Seed( seed, stream );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Random::Seed( const uint64_t seed, const uint64_t stream )
+{
+    // Mix the stream into the seed so neighboring streams start far apart.
+    uint64_t x = seed;
+    uint64_t s = SplitMix64( x ) ^ ( stream * 0xd1342543de82ef95ULL );
+
+    for ( int lane = 0; lane < 4; ++lane ) {
+        const uint64_t a = SplitMix64( s );
+        const uint64_t b = SplitMix64( s );
+
+        mState[0][lane] = static_cast<uint32_t>( a );
+        mState[1][lane] = static_cast<uint32_t>( a >> 32 );
+        mState[2][lane] = static_cast<uint32_t>( b );
+        mState[3][lane] = static_cast<uint32_t>( b >> 32 ) | 1u; // never all zero
+    }
+
+    mBufferPos = 4;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Random::Next4( uint32_t out[4] )
+{
+#if defined( _XM_SSE_INTRINSICS_ )
+    __m128i s0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( mState[0] ) );
+    __m128i s1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( mState[1] ) );
+    __m128i s2 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( mState[2] ) );
+    __m128i s3 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( mState[3] ) );
+
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( out ), _mm_add_epi32( s0, s3 ) );
+
+    const __m128i t = _mm_slli_epi32( s1, 9 );
+    s2 = _mm_xor_si128( s2, s0 );
+    s3 = _mm_xor_si128( s3, s1 );
+    s1 = _mm_xor_si128( s1, s2 );
+    s0 = _mm_xor_si128( s0, s3 );
+    s2 = _mm_xor_si128( s2, t );
+    s3 = _mm_or_si128( _mm_slli_epi32( s3, 11 ), _mm_srli_epi32( s3, 21 ) );
+
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( mState[0] ), s0 );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( mState[1] ), s1 );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( mState[2] ), s2 );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( mState[3] ), s3 );
+#else
+    for ( int lane = 0; lane < 4; ++lane ) {
+        uint32_t& s0 = mState[0][lane];
+        uint32_t& s1 = mState[1][lane];
+        uint32_t& s2 = mState[2][lane];
+        uint32_t& s3 = mState[3][lane];
+
+        out[lane] = s0 + s3;
+
+        const uint32_t t = s1 << 9;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = Rotl( s3, 11 );
+    }
+#endif
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+XMVECTOR XM_CALLCONV Random::Next4Floats( void )
+{
+    uint32_t bits[4];
+    Next4( bits );
+
+#if defined( _XM_SSE_INTRINSICS_ )
+    // The top 24 bits fit a float mantissa exactly, so the result is < 1.
+    __m128i top = _mm_srli_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( bits ) ), 8 );
+    return _mm_mul_ps( _mm_cvtepi32_ps( top ), _mm_set1_ps( FloatScale ) );
+#else
+    return XMVectorSet( ( bits[0] >> 8 ) * FloatScale,
+                        ( bits[1] >> 8 ) * FloatScale,
+                        ( bits[2] >> 8 ) * FloatScale,
+                        ( bits[3] >> 8 ) * FloatScale );
+#endif
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void XM_CALLCONV Random::Next4UnitVec3( XMVECTOR& x, XMVECTOR& y, XMVECTOR& z )
+{
+    // Archimedes: z is uniform in [-1, 1] and the azimuth is uniform, which
+    // gives a uniform distribution over the sphere.
+    const XMVECTOR u = Next4Floats();
+    const XMVECTOR v = Next4Floats();
+
+    const XMVECTOR one = XMVectorReplicate( 1.f );
+    z = XMVectorNegativeMultiplySubtract( XMVectorReplicate( 2.f ), u, one );
+
+    XMVECTOR r = XMVectorSqrt( XMVectorMax( XMVectorNegativeMultiplySubtract( z, z, one ), XMVectorZero() ) );
+
+    // Azimuth in [-pi, pi), the range XMVectorSinCos expects.
+    XMVECTOR phi = XMVectorMultiplyAdd( v, XMVectorReplicate( XM_2PI ), XMVectorReplicate( -XM_PI ) );
+
+    XMVECTOR s, c;
+    XMVectorSinCos( &s, &c, phi );
+
+    x = XMVectorMultiply( r, c );
+    y = XMVectorMultiply( r, s );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint32_t Random::Take( void )
+{
+    if ( mBufferPos == 4 ) {
+        Next4( mBuffer );
+        mBufferPos = 0;
+    }
+
+    return mBuffer[mBufferPos++];
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint32_t Random::NextUInt( void )
+{
+    return Take();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint32_t Random::NextUInt( const uint32_t bound )
+{
+    // Multiply-shift maps onto [0, bound) from the high bits, which are the
+    // strongest bits of xoshiro128+. The bias is at most bound / 2^32.
+    return static_cast<uint32_t>( ( static_cast<uint64_t>( Take() ) * bound ) >> 32 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+float Random::NextFloat( void )
+{
+    return ( Take() >> 8 ) * FloatScale;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+float Random::NextFloat( const float a, const float b )
+{
+    return a + NextFloat() * ( b - a );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+XMVECTOR XM_CALLCONV Random::NextUnitVec3( void )
+{
+    const float z = 1.f - 2.f * NextFloat();
+    const float r = sqrtf( ( 1.f - z * z ) > 0.f ? ( 1.f - z * z ) : 0.f );
+    const float phi = XM_2PI * NextFloat() - XM_PI;
+
+    float s, c;
+    XMScalarSinCos( &s, &c, phi );
+
+    return XMVectorSet( r * c, r * s, z, 0.f );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+XMVECTOR XM_CALLCONV Random::NextHemisphereUnitVec3( FXMVECTOR n )
+{
+    // Reflecting the lower half onto the upper half keeps the distribution
+    // uniform and never rejects a sample.
+    XMVECTOR v = NextUnitVec3();
+    XMVECTOR d = XMVectorMin( XMVector3Dot( n, v ), XMVectorZero() );
+
+    return XMVectorNegativeMultiplySubtract( XMVectorAdd( d, d ), n, v );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Random::FillFloats( float* out, const size_t count, const float a, const float b )
+{
+    const XMVECTOR scale = XMVectorReplicate( b - a );
+    const XMVECTOR bias = XMVectorReplicate( a );
+
+    size_t i = 0;
+    for ( ; i + 4 <= count; i += 4 ) {
+        XMStoreFloat4( reinterpret_cast<XMFLOAT4*>( out + i ),
+                       XMVectorMultiplyAdd( Next4Floats(), scale, bias ) );
+    }
+
+    if ( i < count ) {
+        XMFLOAT4 tail;
+        XMStoreFloat4( &tail, XMVectorMultiplyAdd( Next4Floats(), scale, bias ) );
+
+        const float* t = &tail.x;
+        for ( size_t k = 0; i < count; ++i, ++k ) {
+            out[i] = t[k];
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Random::FillUnitVec3( XMFLOAT3* out, const size_t count )
+{
+    for ( size_t i = 0; i < count; i += 4 ) {
+        XMVECTOR x, y, z;
+        Next4UnitVec3( x, y, z );
+
+        // SoA to AoS: row k of the transpose is vector k.
+        XMMATRIX M = XMMatrixTranspose( XMMATRIX( x, y, z, XMVectorZero() ) );
+
+        for ( size_t k = 0; k < 4 && i + k < count; ++k ) {
+            XMStoreFloat3( &out[i + k], M.r[k] );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Random::FillHemisphereUnitVec3( XMFLOAT3* out, const size_t count, FXMVECTOR n )
+{
+    const XMVECTOR nx = XMVectorSplatX( n );
+    const XMVECTOR ny = XMVectorSplatY( n );
+    const XMVECTOR nz = XMVectorSplatZ( n );
+    const XMVECTOR minusTwo = XMVectorReplicate( -2.f );
+
+    for ( size_t i = 0; i < count; i += 4 ) {
+        XMVECTOR x, y, z;
+        Next4UnitVec3( x, y, z );
+
+        // v -= 2 * min(dot(n, v), 0) * n, four vectors at a time.
+        XMVECTOR d = XMVectorMultiply( x, nx );
+        d = XMVectorMultiplyAdd( y, ny, d );
+        d = XMVectorMultiplyAdd( z, nz, d );
+        d = XMVectorMultiply( XMVectorMin( d, XMVectorZero() ), minusTwo );
+
+        x = XMVectorMultiplyAdd( d, nx, x );
+        y = XMVectorMultiplyAdd( d, ny, y );
+        z = XMVectorMultiplyAdd( d, nz, z );
+
+        XMMATRIX M = XMMatrixTranspose( XMMATRIX( x, y, z, XMVectorZero() ) );
+
+        for ( size_t k = 0; k < 4 && i + k < count; ++k ) {
+            XMStoreFloat3( &out[i + k], M.r[k] );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+Random& Random::ThreadLocal( void )
+{
+    thread_local Random random( gThreadLocalSeed.load(), gNextThreadStream++ );
+    return random;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Random::SetThreadLocalSeed( const uint64_t seed )
+{
+    gThreadLocalSeed = seed;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
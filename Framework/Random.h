@@ -0,0 +1,92 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file Random.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Small, fast pseudo random number generator: four interleaved xoshiro128+
+/// streams stepped together, so one step yields four numbers (with SSE2 when
+/// DirectXMath uses intrinsics).
+///
+/// A generator is fully determined by its (seed, stream) pair, so parallel
+/// work that needs reproducible output should give each task its own
+/// generator with the task index as the stream. ThreadLocal() is for
+/// everything else, e.g. MathHelper::RandF().
+///
+/// Unit and hemisphere vectors are sampled directly (no rejection loops), so
+/// every call consumes the same amount of the stream.
+///</summary>
+class Random {
+public:
+
+    explicit Random( const uint64_t seed = DefaultSeed, const uint64_t stream = 0 );
+
+    void Seed( const uint64_t seed, const uint64_t stream = 0 );
+
+    // Uniform 32-bit integer.
+    uint32_t NextUInt( void );
+
+    // Uniform integer in [0, bound).
+    uint32_t NextUInt( const uint32_t bound );
+
+    // Uniform float in [0, 1) with 24 bits of resolution.
+    float NextFloat( void );
+
+    // Uniform float in [a, b).
+    float NextFloat( const float a, const float b );
+
+    // Uniformly distributed unit vector (w = 0).
+    DirectX::XMVECTOR XM_CALLCONV NextUnitVec3( void );
+
+    // Uniformly distributed unit vector in the hemisphere about the unit
+    // vector n (w = 0).
+    DirectX::XMVECTOR XM_CALLCONV NextHemisphereUnitVec3( DirectX::FXMVECTOR n );
+
+    // Batch versions, four results per step.
+
+    void FillFloats( float* out, const size_t count, const float a = 0.f, const float b = 1.f );
+    void FillUnitVec3( DirectX::XMFLOAT3* out, const size_t count );
+    void FillHemisphereUnitVec3( DirectX::XMFLOAT3* out, const size_t count, DirectX::FXMVECTOR n );
+
+    // The calling thread's generator. Each thread is seeded from the seed set
+    // with SetThreadLocalSeed() and the order in which threads first use it.
+    static Random& ThreadLocal( void );
+
+    // Seed for thread-local generators created after this call.
+    static void SetThreadLocalSeed( const uint64_t seed );
+
+    static const uint64_t DefaultSeed = 0x853c49e6748fea9bULL;
+
+private:
+
+    // Steps all four lanes and returns their outputs.
+    void Next4( uint32_t out[4] );
+    DirectX::XMVECTOR XM_CALLCONV Next4Floats( void );
+
+    // Fills x, y, z with four uniform unit vectors in SoA form.
+    void XM_CALLCONV Next4UnitVec3( DirectX::XMVECTOR& x, DirectX::XMVECTOR& y, DirectX::XMVECTOR& z );
+
+    uint32_t Take( void );
+
+private:
+
+    // mState[k] holds word k of the xoshiro128+ state for each of the lanes.
+    uint32_t mState[4][4];
+
+    // Outputs of the last step not yet handed out by the scalar functions.
+    uint32_t mBuffer[4];
+    unsigned int mBufferPos;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,311 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file ReflectionProbes.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "ReflectionProbes.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    const float InverseSqrt2 = 0.70710678f;
+
+    inline float Component( const XMFLOAT3& v, const unsigned int axis )
+    {
+        return axis == 0 ? v.x : ( axis == 1 ? v.y : v.z );
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+ReflectionProbes::Settings::Settings( void )
+: facesPerFrame( 2 )
+, nearZ( 0.1f )
+, farZ( 1000.f )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+ReflectionProbes::ReflectionProbes( void )
+: mFrame( 0 )
+{
+    mStats = Stats();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void ReflectionProbes::Clear( void )
+{
+    mProbes.clear();
+    mPrevious.clear();
+    mUpdates.clear();
+    mDrawList.clear();
+    mStats = Stats();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint32_t ReflectionProbes::AddProbe( const XMFLOAT3& position, const float radius, const uint32_t owner )
+{
+    Probe probe;
+    probe.position = position;
+    probe.radius = radius;
+    probe.owner = owner;
+    probe.priority = 0.f;
+    probe.nextFace = 0;
+    for ( unsigned int f = 0; f < FaceCount; ++f ) {
+        probe.pending[f] = true;
+        probe.lastUpdate[f] = mFrame;
+    }
+
+    mProbes.push_back( probe );
+    return static_cast<uint32_t>( mProbes.size() - 1 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void ReflectionProbes::MoveProbe( const uint32_t probe, const XMFLOAT3& position )
+{
+    Probe& p = mProbes[probe];
+    if ( p.position.x != position.x || p.position.y != position.y || p.position.z != position.z ) {
+        p.position = position;
+        Invalidate( probe );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void ReflectionProbes::Invalidate( const uint32_t probe )
+{
+    std::fill( mProbes[probe].pending, mProbes[probe].pending + FaceCount, true );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t ReflectionProbes::GetProbeCount( void ) const
+{
+    return mProbes.size();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const XMFLOAT3& ReflectionProbes::GetPosition( const uint32_t probe ) const
+{
+    return mProbes[probe].position;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void ReflectionProbes::Schedule( const View& view, const Object* objects, const size_t count, const Settings& settings )
+{
+    ++mFrame;
+    mUpdates.clear();
+    mDrawList.clear();
+    mCandidates.clear();
+    mStats = Stats();
+
+    // A different set of objects leaves nothing to compare against.
+    const bool sameObjects = mPrevious.size() == count;
+
+    for ( uint32_t p = 0; p < mProbes.size(); ++p ) {
+        Probe& probe = mProbes[p];
+
+        for ( unsigned int f = 0; f < FaceCount; ++f ) {
+            if ( !sameObjects ) {
+                probe.pending[f] = true;
+            }
+
+            // Something that moved into the face or out of it.
+            for ( size_t o = 0; o < count && !probe.pending[f]; ++o ) {
+                if ( !objects[o].moving || o == probe.owner ) {
+                    continue;
+                }
+                probe.pending[f] =
+                    FaceContains( probe.position, f, settings.nearZ, settings.farZ, objects[o].center, objects[o].radius ) ||
+                    FaceContains( probe.position, f, settings.nearZ, settings.farZ, mPrevious[o].center, mPrevious[o].radius );
+            }
+
+            if ( !probe.pending[f] ) {
+                ++mStats.facesClean;
+                continue;
+            }
+            ++mStats.facesPending;
+        }
+
+        probe.priority = ScreenArea( view, probe.position, probe.radius );
+        if ( probe.priority <= 0.f ) {
+            continue;
+        }
+
+        for ( unsigned int f = 0; f < FaceCount; ++f ) {
+            if ( probe.pending[f] ) {
+                Candidate candidate;
+                const float age = static_cast<float>( mFrame - probe.lastUpdate[f] );
+                candidate.score = probe.priority * age * age;
+                candidate.probe = p;
+                candidate.face = f;
+                candidate.turn = ( f + FaceCount - probe.nextFace ) % FaceCount;
+                mCandidates.push_back( candidate );
+            }
+        }
+    }
+
+    const size_t picked = std::min<size_t>( settings.facesPerFrame, mCandidates.size() );
+    std::partial_sort( mCandidates.begin(), mCandidates.begin() + picked, mCandidates.end(),
+        []( const Candidate& a, const Candidate& b ) {
+            if ( a.score != b.score ) {
+                return a.score > b.score;
+            }
+            if ( a.probe != b.probe ) {
+                return a.probe < b.probe;
+            }
+            return a.turn < b.turn;
+        } );
+
+    for ( size_t c = 0; c < picked; ++c ) {
+        const Candidate& candidate = mCandidates[c];
+        Probe& probe = mProbes[candidate.probe];
+
+        FaceUpdate update;
+        update.probe = candidate.probe;
+        update.face = candidate.face;
+        update.first = mDrawList.size();
+
+        for ( size_t o = 0; o < count; ++o ) {
+            if ( o == probe.owner ) {
+                continue;
+            }
+            if ( FaceContains( probe.position, candidate.face, settings.nearZ, settings.farZ, objects[o].center, objects[o].radius ) ) {
+                mDrawList.push_back( static_cast<uint32_t>( o ) );
+            }
+            else {
+                ++mStats.objectsCulled;
+            }
+        }
+
+        update.count = mDrawList.size() - update.first;
+        mUpdates.push_back( update );
+
+        probe.pending[candidate.face] = false;
+        probe.lastUpdate[candidate.face] = mFrame;
+        probe.nextFace = ( candidate.face + 1 ) % FaceCount;
+    }
+
+    mStats.facesUpdated = mUpdates.size();
+    mStats.objectsDrawn = mDrawList.size();
+
+    mPrevious.assign( objects, objects + count );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const std::vector<ReflectionProbes::FaceUpdate>& ReflectionProbes::GetUpdates( void ) const
+{
+    return mUpdates;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const std::vector<uint32_t>& ReflectionProbes::GetDrawList( void ) const
+{
+    return mDrawList;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+float ReflectionProbes::GetPriority( const uint32_t probe ) const
+{
+    return mProbes[probe].priority;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const ReflectionProbes::Stats& ReflectionProbes::GetStats( void ) const
+{
+    return mStats;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void ReflectionProbes::GetFaceBasis( const unsigned int face, XMFLOAT3& look, XMFLOAT3& up )
+{
+    static const XMFLOAT3 looks[FaceCount] = {
+        XMFLOAT3( +1.f, 0.f, 0.f ),
+        XMFLOAT3( -1.f, 0.f, 0.f ),
+        XMFLOAT3( 0.f, +1.f, 0.f ),
+        XMFLOAT3( 0.f, -1.f, 0.f ),
+        XMFLOAT3( 0.f, 0.f, +1.f ),
+        XMFLOAT3( 0.f, 0.f, -1.f )
+    };
+
+    // World up, except when looking along it.
+    static const XMFLOAT3 ups[FaceCount] = {
+        XMFLOAT3( 0.f, 1.f, 0.f ),
+        XMFLOAT3( 0.f, 1.f, 0.f ),
+        XMFLOAT3( 0.f, 0.f, -1.f ),
+        XMFLOAT3( 0.f, 0.f, +1.f ),
+        XMFLOAT3( 0.f, 1.f, 0.f ),
+        XMFLOAT3( 0.f, 1.f, 0.f )
+    };
+
+    look = looks[face];
+    up = ups[face];
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool ReflectionProbes::FaceContains( const XMFLOAT3& position,
+                                     const unsigned int face,
+                                     const float nearZ,
+                                     const float farZ,
+                                     const XMFLOAT3& center,
+                                     const float radius )
+{
+    const XMFLOAT3 offset( center.x - position.x, center.y - position.y, center.z - position.z );
+
+    // Distance along the face's axis and across it on the other two.
+    const unsigned int axis = face / 2;
+    const float along = ( face % 2 == 0 ? 1.f : -1.f ) * Component( offset, axis );
+    const float a = Component( offset, ( axis + 1 ) % 3 );
+    const float b = Component( offset, ( axis + 2 ) % 3 );
+
+    if ( along < nearZ - radius || along > farZ + radius ) {
+        return false;
+    }
+
+    // The four sides of a 90 degree frustum lean 45 degrees off the axis.
+    const float reach = -radius / InverseSqrt2;
+    return along - std::fabs( a ) >= reach && along - std::fabs( b ) >= reach;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+float ReflectionProbes::ScreenArea( const View& view, const XMFLOAT3& center, const float radius )
+{
+    for ( int p = 0; view.frustumPlanes != nullptr && p < 6; ++p ) {
+        const XMFLOAT4& plane = view.frustumPlanes[p];
+        if ( plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius ) {
+            return 0.f;
+        }
+    }
+
+    const float dx = center.x - view.eye.x;
+    const float dy = center.y - view.eye.y;
+    const float dz = center.z - view.eye.z;
+    const float distance = std::sqrt( dx * dx + dy * dy + dz * dz );
+
+    // Closer than its radius, the sphere fills the screen; say it covers
+    // a circle as tall as the view.
+    const float pixels = distance > radius ? radius * view.pixelScale / distance : view.pixelScale;
+    return XM_PI * pixels * pixels;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,172 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file ReflectionProbes.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <DirectXMath.h>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Decides which faces of which dynamic cube maps to render each frame, and
+/// what to draw into each.
+///
+/// A face only needs rendering when something that moved is, or was last
+/// frame, inside its frustum, or when it has never been rendered since its
+/// probe was added, moved or invalidated. Of the faces that need it, at
+/// most facesPerFrame are handed out per frame, best score first. A face
+/// scores its probe's priority, the area the probe covers on screen,
+/// times the square of the frames since the face was last rendered, so
+/// large probes come back more often while a probe a hundred times
+/// smaller still waits only about ten times as long; faces of the same
+/// probe and age come in round-robin order. Probes outside the view are
+/// not updated at all until they come back.
+///
+/// Each face handed out comes with its own draw list: the objects whose
+/// bounding spheres reach into its frustum, leaving out the object the
+/// probe belongs to. Faces are in D3D cube order +X, -X, +Y, -Y, +Z, -Z.
+/// Nothing here needs a device; the caller renders what Schedule() picks.
+///</summary>
+class ReflectionProbes {
+public:
+
+    static const unsigned int FaceCount = 6;
+    static const uint32_t NoObject = 0xFFFFFFFF;
+
+    // What a probe sees, as a bounding sphere. moving is set for objects
+    // that may have changed since the last Schedule().
+    struct Object {
+        DirectX::XMFLOAT3 center;
+        float radius;
+        bool moving;
+    };
+
+    struct Settings {
+        Settings( void );
+
+        unsigned int facesPerFrame;
+        float nearZ;
+        float farZ;
+    };
+
+    struct View {
+        DirectX::XMFLOAT3 eye;
+
+        // Pixels covered by one unit at unit distance: half the viewport
+        // height times the (1, 1) element of the projection.
+        float pixelScale;
+
+        // Six world-space planes facing in, or null.
+        const DirectX::XMFLOAT4* frustumPlanes;
+    };
+
+    // A face to render this frame; its objects are drawList[first] on.
+    struct FaceUpdate {
+        uint32_t probe;
+        uint32_t face;
+        size_t first;
+        size_t count;
+    };
+
+    struct Stats {
+        size_t facesPending;    // needing an update, including those picked
+        size_t facesUpdated;
+        size_t facesClean;      // left alone as nothing moved in them
+        size_t objectsDrawn;
+        size_t objectsCulled;
+    };
+
+    ReflectionProbes( void );
+
+    void Clear( void );
+
+    // Adds a probe at position whose reflector has the given bounding
+    // radius. owner, if given, is the index of the reflector among the
+    // objects, which its own faces do not draw.
+    uint32_t AddProbe( const DirectX::XMFLOAT3& position, const float radius, const uint32_t owner = NoObject );
+
+    // Moving a probe needs all its faces rendered again.
+    void MoveProbe( const uint32_t probe, const DirectX::XMFLOAT3& position );
+
+    // Marks every face of the probe as needing rendering, for changes the
+    // scheduler cannot see (lighting, materials).
+    void Invalidate( const uint32_t probe );
+
+    size_t GetProbeCount( void ) const;
+    const DirectX::XMFLOAT3& GetPosition( const uint32_t probe ) const;
+
+    // Picks the faces to render this frame and builds their draw lists.
+    // Faces picked are taken to be rendered before the next call.
+    // objects must be the same set, in the same order, every frame.
+    void Schedule( const View& view, const Object* objects, const size_t count, const Settings& settings );
+
+    const std::vector<FaceUpdate>& GetUpdates( void ) const;
+    const std::vector<uint32_t>& GetDrawList( void ) const;
+
+    // Priority of the probe in the last Schedule(); 0 if it was not seen.
+    float GetPriority( const uint32_t probe ) const;
+
+    // Counts of the last Schedule().
+    const Stats& GetStats( void ) const;
+
+    // The direction a face looks along and its up vector, as cube map
+    // cameras are built.
+    static void GetFaceBasis( const unsigned int face, DirectX::XMFLOAT3& look, DirectX::XMFLOAT3& up );
+
+    // True if the sphere reaches into the frustum of the face of a cube map
+    // at position.
+    static bool FaceContains( const DirectX::XMFLOAT3& position,
+                              const unsigned int face,
+                              const float nearZ,
+                              const float farZ,
+                              const DirectX::XMFLOAT3& center,
+                              const float radius );
+
+    // Pixels a sphere covers on screen; 0 when it is outside the frustum.
+    static float ScreenArea( const View& view, const DirectX::XMFLOAT3& center, const float radius );
+
+private:
+
+    ReflectionProbes( const ReflectionProbes& rhs );
+    ReflectionProbes& operator=( const ReflectionProbes& rhs );
+
+    struct Probe {
+        DirectX::XMFLOAT3 position;
+        float radius;
+        uint32_t owner;
+        float priority;
+        unsigned int nextFace;  // where the round robin goes on from
+        bool pending[FaceCount];
+        uint64_t lastUpdate[FaceCount];
+    };
+
+    struct Candidate {
+        float score;
+        uint32_t probe;
+        uint32_t face;
+        unsigned int turn;      // place in the probe's round robin
+    };
+
+    std::vector<Probe> mProbes;
+
+    // Where the objects were at the last Schedule(), so faces they left are
+    // rendered without them.
+    std::vector<Object> mPrevious;
+
+    std::vector<Candidate> mCandidates;
+    std::vector<FaceUpdate> mUpdates;
+    std::vector<uint32_t> mDrawList;
+
+    uint64_t mFrame;
+    Stats mStats;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
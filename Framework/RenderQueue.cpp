@@ -0,0 +1,356 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file RenderQueue.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "RenderQueue.h"
+#include "RadixSort.h"
+
+#include <algorithm>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    static_assert( RenderQueue::PassBits + RenderQueue::TechniqueBits + RenderQueue::StateBits +
+                   RenderQueue::MaterialBits + RenderQueue::MeshBits + RenderQueue::DepthBits == 64,
+                   "Sort key fields must fill 64 bits" );
+
+    inline uint64_t Field( const unsigned int value, const unsigned int bits )
+    {
+        return static_cast<uint64_t>( value ) & ( ( uint64_t( 1 ) << bits ) - 1 );
+    }
+
+    // Whether b draws right after a with nothing to rebind in between.
+    bool CanMerge( const RenderItem& a, const RenderItem& b )
+    {
+        return a.instanceCount == 0 && b.instanceCount == 0 &&
+               a.topology == b.topology &&
+               a.inputLayout == b.inputLayout &&
+               a.vertexBuffer == b.vertexBuffer && a.vertexStride == b.vertexStride &&
+               a.indexBuffer == b.indexBuffer && a.indexFormat == b.indexFormat &&
+               a.rasterizerState == b.rasterizerState &&
+               a.blendState == b.blendState &&
+               a.depthStencilState == b.depthStencilState && a.stencilRef == b.stencilRef &&
+               a.technique == b.technique && a.pass == b.pass &&
+               a.object == b.object &&
+               a.baseVertex == b.baseVertex &&
+               a.startIndex + a.indexCount == b.startIndex;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+RenderItem::RenderItem( void )
+: topology( 0 )
+, inputLayout( nullptr )
+, vertexBuffer( nullptr )
+, vertexStride( 0 )
+, instanceBuffer( nullptr )
+, instanceStride( 0 )
+, indexBuffer( nullptr )
+, indexFormat( 0 )
+, rasterizerState( nullptr )
+, blendState( nullptr )
+, depthStencilState( nullptr )
+, stencilRef( 0 )
+, technique( nullptr )
+, pass( 0 )
+, object( nullptr )
+, indexCount( 0 )
+, startIndex( 0 )
+, baseVertex( 0 )
+, instanceCount( 0 )
+, startInstance( 0 )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint64_t RenderQueue::MakeKey( const unsigned int pass,
+                               const unsigned int technique,
+                               const unsigned int state,
+                               const unsigned int material,
+                               const unsigned int mesh,
+                               const unsigned int depth )
+{
+    uint64_t key = Field( pass, PassBits );
+    key = ( key << TechniqueBits ) | Field( technique, TechniqueBits );
+    key = ( key << StateBits ) | Field( state, StateBits );
+    key = ( key << MaterialBits ) | Field( material, MaterialBits );
+    key = ( key << MeshBits ) | Field( mesh, MeshBits );
+    key = ( key << DepthBits ) | Field( depth, DepthBits );
+    return key;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+unsigned int RenderQueue::QuantizeDepth( const float z, const float nearZ, const float farZ, const bool backToFront )
+{
+    const unsigned int maxDepth = ( 1u << DepthBits ) - 1;
+
+    float t = farZ > nearZ ? ( z - nearZ ) / ( farZ - nearZ ) : 0.f;
+    // Written so NaN ends up at 0 too.
+    t = t > 0.f ? std::min( t, 1.f ) : 0.f;
+
+    const unsigned int depth = static_cast<unsigned int>( t * maxDepth + 0.5f );
+    return backToFront ? maxDepth - depth : depth;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+RenderQueue::RenderQueue( void )
+: mItems( )
+, mEntries( )
+, mScratch( )
+{
+    Clear();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void RenderQueue::Clear( void )
+{
+    mItems.clear();
+    mEntries.clear();
+    InvalidateState();
+
+    mStats.draws = 0;
+    mStats.stateChanges = 0;
+    mStats.redundantStates = 0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void RenderQueue::Submit( const uint64_t key, const RenderItem& item )
+{
+    Entry entry;
+    entry.key = key;
+    entry.index = static_cast<uint32_t>( mItems.size() );
+
+    mItems.push_back( item );
+    mEntries.push_back( entry );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t RenderQueue::GetSize( void ) const
+{
+    return mEntries.size();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void RenderQueue::Sort( JobSystem* jobs )
+{
+    RadixSort::Sort( mEntries, mScratch, jobs, ParallelThreshold );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t RenderQueue::Merge( void )
+{
+    if ( mEntries.empty() ) {
+        return 0;
+    }
+
+    size_t last = 0;
+    for ( size_t i = 1; i < mEntries.size(); ++i ) {
+        RenderItem& merged = mItems[mEntries[last].index];
+        const RenderItem& item = mItems[mEntries[i].index];
+        if ( CanMerge( merged, item ) ) {
+            merged.indexCount += item.indexCount;
+        } else {
+            mEntries[++last] = mEntries[i];
+        }
+    }
+
+    mEntries.resize( last + 1 );
+    return mEntries.size();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void RenderQueue::Execute( RenderBackend& backend )
+{
+    mStats.draws = 0;
+    mStats.stateChanges = 0;
+    mStats.redundantStates = 0;
+
+    for ( const Entry& entry : mEntries ) {
+        const RenderItem& item = mItems[entry.index];
+
+        if ( Track( mTopology.Change( item.topology ) ) ) {
+            backend.SetTopology( item.topology );
+        }
+        if ( Track( mInputLayout.Change( item.inputLayout ) ) ) {
+            backend.SetInputLayout( item.inputLayout );
+        }
+
+        const BoundBuffer vertexBuffer = { item.vertexBuffer, item.vertexStride };
+        if ( Track( mVertexBuffer.Change( vertexBuffer ) ) ) {
+            backend.SetVertexBuffer( item.vertexBuffer, item.vertexStride );
+        }
+
+        // Draws that are not instanced do not read slot 1, so whatever was
+        // last bound there can stay.
+        if ( item.instanceCount > 0 ) {
+            const BoundBuffer instanceBuffer = { item.instanceBuffer, item.instanceStride };
+            if ( Track( mInstanceBuffer.Change( instanceBuffer ) ) ) {
+                backend.SetInstanceBuffer( item.instanceBuffer, item.instanceStride );
+            }
+        }
+
+        const BoundBuffer indexBuffer = { item.indexBuffer, item.indexFormat };
+        if ( Track( mIndexBuffer.Change( indexBuffer ) ) ) {
+            backend.SetIndexBuffer( item.indexBuffer, item.indexFormat );
+        }
+
+        if ( Track( mRasterizerState.Change( item.rasterizerState ) ) ) {
+            backend.SetRasterizerState( item.rasterizerState );
+        }
+        if ( Track( mBlendState.Change( item.blendState ) ) ) {
+            backend.SetBlendState( item.blendState );
+        }
+
+        const BoundBuffer depthStencilState = { item.depthStencilState, item.stencilRef };
+        if ( Track( mDepthStencilState.Change( depthStencilState ) ) ) {
+            backend.SetDepthStencilState( item.depthStencilState, item.stencilRef );
+        }
+
+        backend.Draw( item );
+        ++mStats.draws;
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void RenderQueue::InvalidateState( void )
+{
+    mTopology.valid = false;
+    mInputLayout.valid = false;
+    mVertexBuffer.valid = false;
+    mInstanceBuffer.valid = false;
+    mIndexBuffer.valid = false;
+    mRasterizerState.valid = false;
+    mBlendState.valid = false;
+    mDepthStencilState.valid = false;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint64_t RenderQueue::GetKey( const size_t i ) const
+{
+    return mEntries[i].key;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const RenderItem& RenderQueue::GetItem( const size_t i ) const
+{
+    return mItems[mEntries[i].index];
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const RenderQueue::Stats& RenderQueue::GetStats( void ) const
+{
+    return mStats;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool RenderQueue::Track( const bool changed )
+{
+    if ( changed ) {
+        ++mStats.stateChanges;
+    } else {
+        ++mStats.redundantStates;
+    }
+    return changed;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void RenderCommandLog::Clear( void )
+{
+    mCommands.clear();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const std::vector<RenderCommandLog::Command>& RenderCommandLog::GetCommands( void ) const
+{
+    return mCommands;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t RenderCommandLog::GetStateChangeCount( void ) const
+{
+    return static_cast<size_t>( std::count_if( mCommands.begin(), mCommands.end(), []( const Command& c ) {
+        return c.type != DrawItem;
+    } ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void RenderCommandLog::SetTopology( const unsigned int topology )
+{
+    Record( Topology, nullptr, topology, nullptr );
+}
+
+void RenderCommandLog::SetInputLayout( const void* layout )
+{
+    Record( InputLayout, layout, 0, nullptr );
+}
+
+void RenderCommandLog::SetVertexBuffer( const void* buffer, const unsigned int stride )
+{
+    Record( VertexBuffer, buffer, stride, nullptr );
+}
+
+void RenderCommandLog::SetInstanceBuffer( const void* buffer, const unsigned int stride )
+{
+    Record( InstanceBuffer, buffer, stride, nullptr );
+}
+
+void RenderCommandLog::SetIndexBuffer( const void* buffer, const unsigned int format )
+{
+    Record( IndexBuffer, buffer, format, nullptr );
+}
+
+void RenderCommandLog::SetRasterizerState( const void* state )
+{
+    Record( RasterizerState, state, 0, nullptr );
+}
+
+void RenderCommandLog::SetBlendState( const void* state )
+{
+    Record( BlendState, state, 0, nullptr );
+}
+
+void RenderCommandLog::SetDepthStencilState( const void* state, const unsigned int stencilRef )
+{
+    Record( DepthStencilState, state, stencilRef, nullptr );
+}
+
+void RenderCommandLog::Draw( const RenderItem& item )
+{
+    Record( DrawItem, item.object, 0, &item );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void RenderCommandLog::Record( const Type type, const void* handle, const unsigned int value, const RenderItem* item )
+{
+    Command command;
+    command.type = type;
+    command.handle = handle;
+    command.value = value;
+    command.item = item;
+    mCommands.push_back( command );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,279 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file RenderQueue.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+class JobSystem;
+
+///<summary>
+/// One draw and everything it binds. Device objects are held as opaque
+/// handles (ID3D11InputLayout*, ID3D11RasterizerState* and so on for the
+/// device backend); null means the device default, as it does for the
+/// RenderStates objects. technique, pass and object are not bound by the
+/// queue and only passed through to RenderBackend::Draw().
+///
+/// An item with an instanceCount draws that many instances, reading
+/// per-instance data from instanceBuffer starting at startInstance.
+///</summary>
+struct RenderItem {
+
+    RenderItem( void );
+
+    unsigned int topology;      // D3D11_PRIMITIVE_TOPOLOGY
+    const void* inputLayout;
+    const void* vertexBuffer;
+    unsigned int vertexStride;
+    const void* instanceBuffer;
+    unsigned int instanceStride;
+    const void* indexBuffer;
+    unsigned int indexFormat;   // DXGI_FORMAT
+    const void* rasterizerState;
+    const void* blendState;
+    const void* depthStencilState;
+    unsigned int stencilRef;
+
+    const void* technique;
+    unsigned int pass;
+    const void* object;
+
+    unsigned int indexCount;
+    unsigned int startIndex;
+    int baseVertex;
+    unsigned int instanceCount; // 0 for a draw that is not instanced
+    unsigned int startInstance;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// What RenderQueue::Execute() drives. Setters are only called when the
+/// value differs from what the backend last received.
+///</summary>
+class RenderBackend {
+public:
+
+    virtual ~RenderBackend( void ) { }
+
+    virtual void SetTopology( const unsigned int topology ) = 0;
+    virtual void SetInputLayout( const void* layout ) = 0;
+    virtual void SetVertexBuffer( const void* buffer, const unsigned int stride ) = 0;
+    virtual void SetInstanceBuffer( const void* buffer, const unsigned int stride ) = 0;
+    virtual void SetIndexBuffer( const void* buffer, const unsigned int format ) = 0;
+    virtual void SetRasterizerState( const void* state ) = 0;
+    virtual void SetBlendState( const void* state ) = 0;
+    virtual void SetDepthStencilState( const void* state, const unsigned int stencilRef ) = 0;
+
+    // Per-object constants, the effect pass and the draw call itself.
+    virtual void Draw( const RenderItem& item ) = 0;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Collects the draws of a frame, sorts them by a 64-bit key and issues
+/// them, skipping state that is already bound.
+///
+/// The key orders draws by, from the most significant bits down:
+///
+///   pass       4 bits   shadow, opaque, transparent...
+///   technique  8 bits
+///   state     12 bits   rasterizer/blend/depth combination
+///   material  12 bits
+///   mesh      12 bits
+///   depth     16 bits   front to back, or back to front for blending
+///
+/// Ids are whatever small integers the submitter gives each technique,
+/// state combination, material and mesh; the closer draws sharing them end
+/// up, the fewer state changes are issued. Fields are masked to their
+/// width.
+///
+/// Sorting is RadixSort's stable LSD radix sort on 8-bit digits, split
+/// over the job system for large queues. Equal keys keep submission order,
+/// so a frame sorts the same way every time.
+///</summary>
+class RenderQueue {
+public:
+
+    static const unsigned int PassBits = 4;
+    static const unsigned int TechniqueBits = 8;
+    static const unsigned int StateBits = 12;
+    static const unsigned int MaterialBits = 12;
+    static const unsigned int MeshBits = 12;
+    static const unsigned int DepthBits = 16;
+
+    // Queues below this size are sorted on the calling thread.
+    static const size_t ParallelThreshold = 16384;
+
+    struct Stats {
+        size_t draws;
+        size_t stateChanges;    // setter calls made
+        size_t redundantStates; // setter calls skipped
+    };
+
+    static uint64_t MakeKey( const unsigned int pass,
+                             const unsigned int technique,
+                             const unsigned int state,
+                             const unsigned int material,
+                             const unsigned int mesh,
+                             const unsigned int depth );
+
+    // Depth in [nearZ, farZ] as a key field; the far end first when
+    // backToFront is set.
+    static unsigned int QuantizeDepth( const float z, const float nearZ, const float farZ, const bool backToFront );
+
+    RenderQueue( void );
+
+    // Empties the queue and forgets the bound state; capacity is kept.
+    void Clear( void );
+
+    void Submit( const uint64_t key, const RenderItem& item );
+
+    size_t GetSize( void ) const;
+
+    // Sorts the submitted draws by key. jobs may be null to sort serially.
+    void Sort( JobSystem* jobs );
+
+    // Folds each draw into the one before it, in sorted order, when both
+    // bind the same state, technique, pass and object, are not instanced,
+    // and it carries on the index range of the same buffer where the
+    // other ends. The merged draw keeps the first key. Returns the number
+    // of draws left.
+    size_t Merge( void );
+
+    // Issues the draws in sorted order (submission order if Sort() was not
+    // called). State bound by an earlier Execute() is assumed to still be
+    // bound; call InvalidateState() if something else used the context.
+    void Execute( RenderBackend& backend );
+
+    void InvalidateState( void );
+
+    // Keys and items in sorted order, for inspection.
+    uint64_t GetKey( const size_t i ) const;
+    const RenderItem& GetItem( const size_t i ) const;
+
+    // Counts of the last Execute().
+    const Stats& GetStats( void ) const;
+
+private:
+
+    RenderQueue( const RenderQueue& rhs );
+    RenderQueue& operator=( const RenderQueue& rhs );
+
+    struct Entry {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    // What the backend has bound; valid is false until first set.
+    template<typename T>
+    struct Bound {
+        Bound( void ) : value( ), valid( false ) { }
+
+        // True, and remembers value, if it differs from what is bound.
+        bool Change( const T& v )
+        {
+            if ( valid && value == v ) {
+                return false;
+            }
+            value = v;
+            valid = true;
+            return true;
+        }
+
+        T value;
+        bool valid;
+    };
+
+    struct BoundBuffer {
+        bool operator==( const BoundBuffer& rhs ) const { return buffer == rhs.buffer && value == rhs.value; }
+
+        const void* buffer;
+        unsigned int value;     // stride, format or stencil reference
+    };
+
+    bool Track( const bool changed );
+
+private:
+
+    std::vector<RenderItem> mItems;
+    std::vector<Entry> mEntries;
+    std::vector<Entry> mScratch;
+
+    Bound<unsigned int> mTopology;
+    Bound<const void*> mInputLayout;
+    Bound<BoundBuffer> mVertexBuffer;
+    Bound<BoundBuffer> mInstanceBuffer;
+    Bound<BoundBuffer> mIndexBuffer;
+    Bound<const void*> mRasterizerState;
+    Bound<const void*> mBlendState;
+    Bound<BoundBuffer> mDepthStencilState;
+
+    Stats mStats;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Backend that records what it is told instead of drawing, to check the
+/// queue on the CPU: replaying the log gives the state each draw ran with.
+///</summary>
+class RenderCommandLog : public RenderBackend {
+public:
+
+    enum Type {
+        Topology,
+        InputLayout,
+        VertexBuffer,
+        InstanceBuffer,
+        IndexBuffer,
+        RasterizerState,
+        BlendState,
+        DepthStencilState,
+        DrawItem
+    };
+
+    struct Command {
+        Type type;
+        const void* handle;     // buffer, layout or state; the object for Draw
+        unsigned int value;     // topology, stride, format or stencil reference
+        const RenderItem* item; // DrawItem only
+    };
+
+    void Clear( void );
+
+    const std::vector<Command>& GetCommands( void ) const;
+
+    // Commands that are not DrawItem.
+    size_t GetStateChangeCount( void ) const;
+
+    void SetTopology( const unsigned int topology ) override;
+    void SetInputLayout( const void* layout ) override;
+    void SetVertexBuffer( const void* buffer, const unsigned int stride ) override;
+    void SetInstanceBuffer( const void* buffer, const unsigned int stride ) override;
+    void SetIndexBuffer( const void* buffer, const unsigned int format ) override;
+    void SetRasterizerState( const void* state ) override;
+    void SetBlendState( const void* state ) override;
+    void SetDepthStencilState( const void* state, const unsigned int stencilRef ) override;
+    void Draw( const RenderItem& item ) override;
+
+private:
+
+    void Record( const Type type, const void* handle, const unsigned int value, const RenderItem* item );
+
+    std::vector<Command> mCommands;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
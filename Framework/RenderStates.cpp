@@ -14,6 +14,7 @@ ID3D11BlendState*      RenderStates::NoRenderTargetWritesBS = 0;
 
 ID3D11DepthStencilState* RenderStates::MarkMirrorDSS = 0;
 ID3D11DepthStencilState* RenderStates::DrawReflectionDSS = 0;
+ID3D11DepthStencilState* RenderStates::DrawMirrorDSS = 0;
 ID3D11DepthStencilState* RenderStates::NoDoubleBlendDSS = 0;
 ID3D11DepthStencilState* RenderStates::LessEqualDSS = 0;
 ID3D11DepthStencilState* RenderStates::EqualsDSS = 0;
@@ -171,6 +172,35 @@ void RenderStates::InitAll( ID3D11Device* device )
 
     HR( device->CreateDepthStencilState( &drawReflectionDesc, &DrawReflectionDSS ) );
 
+    //
+    // DrawMirrorDSS
+    //
+
+    // Blends the mirror over the pixels marked in the stencil buffer whatever
+    // the reflection left in the depth buffer (a reflection drawn with an
+    // oblique projection is nearer than the mirror), and puts the mirror's
+    // own depth back for what is drawn after it.
+    D3D11_DEPTH_STENCIL_DESC drawMirrorDesc;
+    drawMirrorDesc.DepthEnable = true;
+    drawMirrorDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+    drawMirrorDesc.DepthFunc = D3D11_COMPARISON_ALWAYS;
+    drawMirrorDesc.StencilEnable = true;
+    drawMirrorDesc.StencilReadMask = 0xff;
+    drawMirrorDesc.StencilWriteMask = 0xff;
+
+    drawMirrorDesc.FrontFace.StencilFailOp = D3D11_STENCIL_OP_KEEP;
+    drawMirrorDesc.FrontFace.StencilDepthFailOp = D3D11_STENCIL_OP_KEEP;
+    drawMirrorDesc.FrontFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
+    drawMirrorDesc.FrontFace.StencilFunc = D3D11_COMPARISON_EQUAL;
+
+    // We are not rendering backfacing polygons, so these settings do not matter.
+    drawMirrorDesc.BackFace.StencilFailOp = D3D11_STENCIL_OP_KEEP;
+    drawMirrorDesc.BackFace.StencilDepthFailOp = D3D11_STENCIL_OP_KEEP;
+    drawMirrorDesc.BackFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
+    drawMirrorDesc.BackFace.StencilFunc = D3D11_COMPARISON_EQUAL;
+
+    HR( device->CreateDepthStencilState( &drawMirrorDesc, &DrawMirrorDSS ) );
+
     //
     // NoDoubleBlendDSS
     //
@@ -221,6 +251,7 @@ void RenderStates::DestroyAll()
 
     ReleaseCOM( MarkMirrorDSS );
     ReleaseCOM( DrawReflectionDSS );
+    ReleaseCOM( DrawMirrorDSS );
     ReleaseCOM( NoDoubleBlendDSS );
     ReleaseCOM( LessEqualDSS );
     ReleaseCOM( EqualsDSS );
@@ -28,6 +28,7 @@ public:
     // Depth/stencil states.
     static ID3D11DepthStencilState* MarkMirrorDSS;
     static ID3D11DepthStencilState* DrawReflectionDSS;
+    static ID3D11DepthStencilState* DrawMirrorDSS;
     static ID3D11DepthStencilState* NoDoubleBlendDSS;
     static ID3D11DepthStencilState* LessEqualDSS;
     static ID3D11DepthStencilState* EqualsDSS;
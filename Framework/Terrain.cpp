@@ -121,6 +121,7 @@ void Terrain::Init(ID3D11Device* device, ID3D11DeviceContext* dc, const InitInfo
 	BuildQuadPatchVB(device);
 	BuildQuadPatchIB(device);
 	BuildHeightmapSRV(device);
+	BuildTessellationPatches(device);
 
 	std::vector<std::wstring> layerFilenames;
 	layerFilenames.push_back(mInfo.LayerMapFilename0);
@@ -128,88 +129,7 @@ void Terrain::Init(ID3D11Device* device, ID3D11DeviceContext* dc, const InitInfo
 	layerFilenames.push_back(mInfo.LayerMapFilename2);
 	layerFilenames.push_back(mInfo.LayerMapFilename3);
 	layerFilenames.push_back(mInfo.LayerMapFilename4);
-	/*mLayerMapArraySRV = d3dHelper::CreateTexture2DArraySRV(device, dc, layerFilenames);
-
-	HR(D3DX11CreateShaderResourceViewFromFile(device, 
-		mInfo.BlendMapFilename.c_str(), 0, 0, &mBlendMapSRV, 0));*/
-
-    std::vector<ID3D11Texture2D*> textures;
-    textures.resize( layerFilenames.size() );
-    for ( auto& i : layerFilenames ) {
-        static int j = 0;
-
-        HR( CreateDDSTextureFromFileEx( device,
-                                        i.c_str(),
-                                        0,
-                                        D3D11_USAGE_STAGING,
-                                        0,
-                                        D3D11_CPU_ACCESS_WRITE | D3D11_CPU_ACCESS_READ,
-                                        0,
-                                        0,
-                                        reinterpret_cast<ID3D11Resource**>( &textures[j++] ),
-                                        nullptr ) );
-    }
-
-    // Create texture array.
-    D3D11_TEXTURE2D_DESC desc;
-    textures[0]->GetDesc( &desc );
-
-    D3D11_TEXTURE2D_DESC arrayDesc;
-    arrayDesc.Width = desc.Width;
-    arrayDesc.Height = desc.Height;
-    arrayDesc.MipLevels = desc.MipLevels;
-    arrayDesc.ArraySize = textures.size();
-    arrayDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    arrayDesc.SampleDesc.Count = 1;
-    arrayDesc.SampleDesc.Quality = 0;
-    arrayDesc.Usage = D3D11_USAGE_DEFAULT;
-    arrayDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-    arrayDesc.CPUAccessFlags = 0;
-    arrayDesc.MiscFlags = 0;
-
-    ID3D11Texture2D* texArray = nullptr;
-    HR( device->CreateTexture2D( &arrayDesc, 0, &texArray ) );
-
-    // Copy individual texture elements into array.
-    for ( UINT texElement = 0; texElement < textures.size(); ++texElement ) {
-        for ( UINT mipLevel = 0; mipLevel < desc.MipLevels; ++mipLevel ) {
-            D3D11_MAPPED_SUBRESOURCE mappedTex2D;
-            HR( dc->Map(    textures[texElement],
-                            mipLevel,
-                            D3D11_MAP_READ,
-                            0,
-                            &mappedTex2D ) );
-
-            dc->UpdateSubresource( texArray,
-                                    D3D11CalcSubresource( mipLevel,
-                                    texElement,
-                                    desc.MipLevels ),
-                                    0,
-                                    mappedTex2D.pData,
-                                    mappedTex2D.RowPitch,
-                                    mappedTex2D.DepthPitch );
-            dc->Unmap( textures[texElement], mipLevel );
-        }
-    }
-
-    // Create resource view to texture array.
-    D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
-    viewDesc.Format = arrayDesc.Format;
-    viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
-    viewDesc.Texture2DArray.MostDetailedMip = 0;
-    viewDesc.Texture2DArray.MipLevels = arrayDesc.MipLevels;
-    viewDesc.Texture2DArray.FirstArraySlice = 0;
-    viewDesc.Texture2DArray.ArraySize = textures.size();
-
-    HR( device->CreateShaderResourceView(   texArray,
-                                            &viewDesc,
-                                            &mLayerMapArraySRV ) );
-
-    // Cleanup textures.
-    ReleaseCOM( texArray );
-    for ( auto& i : textures ) {
-        ReleaseCOM( i );
-    }
+	HR(TextureHelper::CreateTexture2DArraySRV(device, layerFilenames, &mLayerMapArraySRV));
 
     TexMetadata data;
     std::unique_ptr<ScratchImage> image( new ScratchImage() );
@@ -239,8 +159,20 @@ void Terrain::Draw(ID3D11DeviceContext* dc, const Camera& cam, DirectionalLight
 	XMMATRIX worldInvTranspose = MathHelper::InverseTranspose(world);
 	XMMATRIX worldViewProj = world*viewProj;
 
-	XMFLOAT4 worldPlanes[6];
-	ExtractFrustumPlanes(worldPlanes, viewProj);
+	// Tessellation factors for this view; patches outside it get 0.
+	D3D11_VIEWPORT viewport;
+	UINT numViewports = 1;
+	dc->RSGetViewports(&numViewports, &viewport);
+
+	XMFLOAT4X4 proj;
+	XMStoreFloat4x4(&proj, cam.Proj());
+
+	TessellationFactors::View tessView;
+	tessView.eye = cam.GetPosition();
+	tessView.pixelScale = 0.5f*viewport.Height*proj._22;
+	tessView.frustumPlanes = cam.GetFrustumPlanes();
+	mTessFactors.Compute(tessView, mTessSettings);
+	mPatchFactorBuffer.Update(dc, mTessFactors.GetFactors());
 
 	// Set per frame constants.
 	Effects::TerrainFX->SetViewProj(viewProj);
@@ -249,18 +181,14 @@ void Terrain::Draw(ID3D11DeviceContext* dc, const Camera& cam, DirectionalLight
 	Effects::TerrainFX->SetFogColor(Colors::Silver);
 	Effects::TerrainFX->SetFogStart(15.0f);
 	Effects::TerrainFX->SetFogRange(175.0f);
-	Effects::TerrainFX->SetMinDist(20.0f);
-	Effects::TerrainFX->SetMaxDist(500.0f);
-	Effects::TerrainFX->SetMinTess(0.0f);
-	Effects::TerrainFX->SetMaxTess(6.0f);
 	Effects::TerrainFX->SetTexelCellSpaceU(1.0f / mInfo.HeightmapWidth);
 	Effects::TerrainFX->SetTexelCellSpaceV(1.0f / mInfo.HeightmapHeight);
 	Effects::TerrainFX->SetWorldCellSpace(mInfo.CellSpacing);
-	Effects::TerrainFX->SetWorldFrustumPlanes(worldPlanes);
 	
 	Effects::TerrainFX->SetLayerMapArray(mLayerMapArraySRV);
 	Effects::TerrainFX->SetBlendMap(mBlendMapSRV);
 	Effects::TerrainFX->SetHeightMap(mHeightMapSRV);
+	Effects::TerrainFX->SetPatchFactors(mPatchFactorBuffer.GetSRV());
 
 	Effects::TerrainFX->SetMaterial(mMat);
 
@@ -523,9 +451,108 @@ void Terrain::BuildHeightmapSRV(ID3D11Device* device)
 	srvDesc.Format = texDesc.Format;
 	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
 	srvDesc.Texture2D.MostDetailedMip = 0;
-	srvDesc.Texture2D.MipLevels = -1;
+	srvDesc.Texture2D.MipLevels = texDesc.MipLevels;
 	HR(device->CreateShaderResourceView(hmapTex, &srvDesc, &mHeightMapSRV));
 
 	// SRV saves reference.
 	ReleaseCOM(hmapTex);
-}
\ No newline at end of file
+}
+
+XMFLOAT3 Terrain::HeightmapPoint(UINT row, UINT col)const
+{
+	return XMFLOAT3(-0.5f*GetWidth() + col*mInfo.CellSpacing,
+	                mHeightmap[row*mInfo.HeightmapWidth + col],
+	                0.5f*GetDepth() - row*mInfo.CellSpacing);
+}
+
+float Terrain::EdgeDeviation(UINT row0, UINT col0, UINT row1, UINT col1)const
+{
+	// How far the heightmap along a patch edge is from the straight line
+	// between its ends.
+	float h0 = mHeightmap[row0*mInfo.HeightmapWidth + col0];
+	float h1 = mHeightmap[row1*mInfo.HeightmapWidth + col1];
+
+	float deviation = 0.0f;
+	for(UINT k = 1; k < CellsPerPatch; ++k)
+	{
+		float t = (float)k / CellsPerPatch;
+		UINT row = row0 + (row1 - row0)*k/CellsPerPatch;
+		UINT col = col0 + (col1 - col0)*k/CellsPerPatch;
+		float h = mHeightmap[row*mInfo.HeightmapWidth + col];
+		deviation = MathHelper::Max(deviation, fabsf(h - (h0 + (h1 - h0)*t)));
+	}
+
+	return deviation;
+}
+
+float Terrain::PatchDeviation(UINT i, UINT j)const
+{
+	// How far the heightmap over a patch is from the bilinear patch
+	// through its corners.
+	UINT x0 = j*CellsPerPatch;
+	UINT y0 = i*CellsPerPatch;
+	UINT w = mInfo.HeightmapWidth;
+
+	float h00 = mHeightmap[y0*w + x0];
+	float h01 = mHeightmap[y0*w + x0 + CellsPerPatch];
+	float h10 = mHeightmap[(y0 + CellsPerPatch)*w + x0];
+	float h11 = mHeightmap[(y0 + CellsPerPatch)*w + x0 + CellsPerPatch];
+
+	float deviation = 0.0f;
+	for(UINT y = 0; y <= (UINT)CellsPerPatch; ++y)
+	{
+		float v = (float)y / CellsPerPatch;
+		for(UINT x = 0; x <= (UINT)CellsPerPatch; ++x)
+		{
+			float u = (float)x / CellsPerPatch;
+			float flat = (h00 + (h01 - h00)*u) + ((h10 + (h11 - h10)*u) - (h00 + (h01 - h00)*u))*v;
+			deviation = MathHelper::Max(deviation, fabsf(mHeightmap[(y0 + y)*w + x0 + x] - flat));
+		}
+	}
+
+	return deviation;
+}
+
+void Terrain::BuildTessellationPatches(ID3D11Device* device)
+{
+	// The patches BuildQuadPatchIB() draws, in the same order, so the patch
+	// index is the hull shader's SV_PrimitiveID. Corners are in the order
+	// of the index buffer: upper left, upper right, lower left, lower right.
+	mTessFactors.Clear();
+
+	for(UINT i = 0; i < mNumPatchVertRows-1; ++i)
+	{
+		for(UINT j = 0; j < mNumPatchVertCols-1; ++j)
+		{
+			UINT x0 = j*CellsPerPatch;
+			UINT x1 = (j+1)*CellsPerPatch;
+			UINT y0 = i*CellsPerPatch;
+			UINT y1 = (i+1)*CellsPerPatch;
+
+			XMFLOAT3 corners[4] =
+			{
+				HeightmapPoint(y0, x0),
+				HeightmapPoint(y0, x1),
+				HeightmapPoint(y1, x0),
+				HeightmapPoint(y1, x1)
+			};
+
+			// Edges in SV_TessFactor order: u = 0, v = 0, u = 1, v = 1.
+			float edgeDeviation[4] =
+			{
+				EdgeDeviation(y0, x0, y1, x0),
+				EdgeDeviation(y0, x0, y0, x1),
+				EdgeDeviation(y0, x1, y1, x1),
+				EdgeDeviation(y1, x0, y1, x1)
+			};
+
+			XMFLOAT2 boundsY = mPatchBoundsY[i*(mNumPatchVertCols-1)+j];
+			XMFLOAT3 boundsMin(corners[2].x, boundsY.x, corners[2].z);
+			XMFLOAT3 boundsMax(corners[1].x, boundsY.y, corners[1].z);
+
+			mTessFactors.AddPatch(corners, edgeDeviation, PatchDeviation(i, j), boundsMin, boundsMax);
+		}
+	}
+
+	mPatchFactorBuffer.Create(device, mNumPatchQuadFaces);
+}
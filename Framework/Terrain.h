@@ -8,6 +8,8 @@
 #define TERRAIN_H
 
 #include "d3dUtil.h"
+#include "PatchFactorBuffer.h"
+#include "TessellationFactors.h"
 
 class Camera;
 struct DirectionalLight;
@@ -55,6 +57,10 @@ private:
 	void BuildQuadPatchVB(ID3D11Device* device);
 	void BuildQuadPatchIB(ID3D11Device* device);
 	void BuildHeightmapSRV(ID3D11Device* device);
+	void BuildTessellationPatches(ID3D11Device* device);
+	float EdgeDeviation(UINT row0, UINT col0, UINT row1, UINT col1)const;
+	float PatchDeviation(UINT i, UINT j)const;
+	DirectX::XMFLOAT3 HeightmapPoint(UINT row, UINT col)const;
 
 private:
 
@@ -84,6 +90,12 @@ private:
 
 	std::vector<DirectX::XMFLOAT2> mPatchBoundsY;
 	std::vector<float> mHeightmap;
+
+	// Per-patch tessellation factors, from the on-screen size of each
+	// patch edge and how rough the heightmap is along it.
+	TessellationFactors mTessFactors;
+	TessellationFactors::Settings mTessSettings;
+	PatchFactorBuffer mPatchFactorBuffer;
 };
 
 #endif // TERRAIN_H
\ No newline at end of file
@@ -0,0 +1,288 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file TessellationFactors.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "TessellationFactors.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    inline float Distance( const XMFLOAT3& a, const XMFLOAT3& b )
+    {
+        const float dx = b.x - a.x;
+        const float dy = b.y - a.y;
+        const float dz = b.z - a.z;
+        return std::sqrt( dx * dx + dy * dy + dz * dz );
+    }
+
+    inline XMFLOAT3 Lerp( const XMFLOAT3& a, const XMFLOAT3& b, const float t )
+    {
+        return XMFLOAT3( a.x + ( b.x - a.x ) * t, a.y + ( b.y - a.y ) * t, a.z + ( b.z - a.z ) * t );
+    }
+
+    inline bool operator<( const XMFLOAT3& a, const XMFLOAT3& b )
+    {
+        return std::memcmp( &a, &b, sizeof( XMFLOAT3 ) ) < 0;
+    }
+
+    // Furthest a cubic's inner control points are from where a straight
+    // line would put them; the curve is no further from the chord.
+    float CubicDeviation( const XMFLOAT3& p0, const XMFLOAT3& p1, const XMFLOAT3& p2, const XMFLOAT3& p3 )
+    {
+        return std::max( Distance( p1, Lerp( p0, p3, 1.f / 3.f ) ),
+                         Distance( p2, Lerp( p0, p3, 2.f / 3.f ) ) );
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TessellationFactors::Settings::Settings( void )
+: targetEdgePixels( 16.f )
+, maxErrorPixels( 0.5f )
+, minFactor( 1.f )
+, maxFactor( 64.f )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+bool TessellationFactors::EdgeKey::operator==( const EdgeKey& rhs ) const
+{
+    return std::memcmp( bits, rhs.bits, sizeof( bits ) ) == 0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t TessellationFactors::EdgeKeyHash::operator()( const EdgeKey& key ) const
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for ( const uint32_t bits : key.bits ) {
+        hash = ( hash ^ bits ) * 1099511628211ULL;
+    }
+    return static_cast<size_t>( hash );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TessellationFactors::TessellationFactors( void )
+: mEdges( )
+, mPatches( )
+, mEdgeIndices( )
+, mEdgeFactors( )
+, mFactors( )
+, mStats( )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TessellationFactors::Clear( void )
+{
+    mEdges.clear();
+    mPatches.clear();
+    mEdgeIndices.clear();
+    mEdgeFactors.clear();
+    mFactors.clear();
+    mStats = Stats();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint32_t TessellationFactors::AddPatch( const XMFLOAT3 corners[4],
+                                        const float edgeDeviation[4],
+                                        const float interiorDeviation,
+                                        const XMFLOAT3& boundsMin,
+                                        const XMFLOAT3& boundsMax )
+{
+    // Corners at the ends of each edge, in SV_TessFactor order.
+    static const int ends[4][2] = { { 0, 2 }, { 0, 1 }, { 1, 3 }, { 2, 3 } };
+
+    Patch patch;
+    for ( int e = 0; e < 4; ++e ) {
+        patch.edges[e] = FindEdge( corners[ends[e][0]], corners[ends[e][1]], edgeDeviation[e] );
+    }
+    patch.boundsMin = boundsMin;
+    patch.boundsMax = boundsMax;
+    patch.deviation = interiorDeviation;
+
+    mPatches.push_back( patch );
+    return static_cast<uint32_t>( mPatches.size() - 1 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint32_t TessellationFactors::AddBezierPatch( const XMFLOAT3 controlPoints[16] )
+{
+    const XMFLOAT3* p = controlPoints;
+
+    const XMFLOAT3 corners[4] = { p[0], p[3], p[12], p[15] };
+
+    const float edgeDeviation[4] = {
+        CubicDeviation( p[0], p[4], p[8], p[12] ),
+        CubicDeviation( p[0], p[1], p[2], p[3] ),
+        CubicDeviation( p[3], p[7], p[11], p[15] ),
+        CubicDeviation( p[12], p[13], p[14], p[15] )
+    };
+
+    // The flat patch through the corners, raised to a bicubic, has its
+    // control points at the thirds; the surface strays from it no more
+    // than the control points do.
+    float interiorDeviation = 0.f;
+    XMFLOAT3 boundsMin = p[0];
+    XMFLOAT3 boundsMax = p[0];
+    for ( int v = 0; v < 4; ++v ) {
+        for ( int u = 0; u < 4; ++u ) {
+            const XMFLOAT3& cp = p[v * 4 + u];
+            const XMFLOAT3 flat = Lerp( Lerp( corners[0], corners[1], u / 3.f ),
+                                        Lerp( corners[2], corners[3], u / 3.f ),
+                                        v / 3.f );
+            interiorDeviation = std::max( interiorDeviation, Distance( cp, flat ) );
+
+            boundsMin = XMFLOAT3( std::min( boundsMin.x, cp.x ), std::min( boundsMin.y, cp.y ), std::min( boundsMin.z, cp.z ) );
+            boundsMax = XMFLOAT3( std::max( boundsMax.x, cp.x ), std::max( boundsMax.y, cp.y ), std::max( boundsMax.z, cp.z ) );
+        }
+    }
+
+    return AddPatch( corners, edgeDeviation, interiorDeviation, boundsMin, boundsMax );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t TessellationFactors::GetPatchCount( void ) const
+{
+    return mPatches.size();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t TessellationFactors::GetEdgeCount( void ) const
+{
+    return mEdges.size();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+float TessellationFactors::EdgeFactor( const float length,
+                                       const float deviation,
+                                       const float distance,
+                                       const float pixelScale,
+                                       const Settings& settings )
+{
+    // The curve fits in a sphere about its middle; from inside that
+    // sphere it is as large as it gets.
+    const float radius = 0.5f * length + deviation;
+    const float pixels = pixelScale / std::max( distance, std::max( radius, 1e-6f ) );
+
+    // The curve is no longer than the way over its furthest point.
+    float factor = ( length + 2.f * deviation ) * pixels / settings.targetEdgePixels;
+    if ( settings.maxErrorPixels > 0.f ) {
+        factor = std::min( factor, std::sqrt( deviation * pixels / settings.maxErrorPixels ) );
+    }
+
+    return std::min( settings.maxFactor, std::max( settings.minFactor, factor ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TessellationFactors::Compute( const View& view, const Settings& settings )
+{
+    mStats = Stats();
+
+    mEdgeFactors.resize( mEdges.size() );
+    for ( size_t e = 0; e < mEdges.size(); ++e ) {
+        const Edge& edge = mEdges[e];
+        mEdgeFactors[e] = EdgeFactor( edge.length, edge.deviation, Distance( edge.center, view.eye ), view.pixelScale, settings );
+    }
+
+    mFactors.resize( mPatches.size() );
+    for ( size_t i = 0; i < mPatches.size(); ++i ) {
+        const Patch& patch = mPatches[i];
+        PatchFactors& factors = mFactors[i];
+        std::memset( &factors, 0, sizeof( factors ) );
+
+        const XMFLOAT3& lo = patch.boundsMin;
+        const XMFLOAT3& hi = patch.boundsMax;
+
+        bool culled = false;
+        for ( int p = 0; view.frustumPlanes != nullptr && p < 6 && !culled; ++p ) {
+            const XMFLOAT4& plane = view.frustumPlanes[p];
+            const float x = plane.x >= 0.f ? hi.x : lo.x;
+            const float y = plane.y >= 0.f ? hi.y : lo.y;
+            const float z = plane.z >= 0.f ? hi.z : lo.z;
+            culled = plane.x * x + plane.y * y + plane.z * z + plane.w < 0.f;
+        }
+        if ( culled ) {
+            ++mStats.patchesCulled;
+            continue;
+        }
+
+        for ( int e = 0; e < 4; ++e ) {
+            factors.edges[e] = mEdgeFactors[patch.edges[e]];
+        }
+
+        // Inside factors follow the edges across from each other, unless
+        // the middle of the patch needs more.
+        const XMFLOAT3 center( 0.5f * ( lo.x + hi.x ), 0.5f * ( lo.y + hi.y ), 0.5f * ( lo.z + hi.z ) );
+        const float interior = EdgeFactor( Distance( lo, hi ), patch.deviation, Distance( center, view.eye ), view.pixelScale, settings );
+        factors.inside[0] = std::max( interior, std::max( factors.edges[1], factors.edges[3] ) );
+        factors.inside[1] = std::max( interior, std::max( factors.edges[0], factors.edges[2] ) );
+
+        mStats.triangles += 2.0 * factors.inside[0] * factors.inside[1];
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const std::vector<TessellationFactors::PatchFactors>& TessellationFactors::GetFactors( void ) const
+{
+    return mFactors;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const TessellationFactors::Stats& TessellationFactors::GetStats( void ) const
+{
+    return mStats;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint32_t TessellationFactors::FindEdge( const XMFLOAT3& a, const XMFLOAT3& b, const float deviation )
+{
+    // Adding zero turns -0 into 0, which would otherwise be another edge.
+    const XMFLOAT3 p( a.x + 0.f, a.y + 0.f, a.z + 0.f );
+    const XMFLOAT3 q( b.x + 0.f, b.y + 0.f, b.z + 0.f );
+    const XMFLOAT3& first = q < p ? q : p;
+    const XMFLOAT3& second = q < p ? p : q;
+
+    EdgeKey key;
+    std::memcpy( &key.bits[0], &first, sizeof( XMFLOAT3 ) );
+    std::memcpy( &key.bits[3], &second, sizeof( XMFLOAT3 ) );
+
+    auto found = mEdgeIndices.find( key );
+    if ( found != mEdgeIndices.end() ) {
+        return found->second;
+    }
+
+    Edge edge;
+    edge.center = Lerp( a, b, 0.5f );
+    edge.length = Distance( a, b );
+    edge.deviation = deviation;
+
+    mEdges.push_back( edge );
+    const uint32_t index = static_cast<uint32_t>( mEdges.size() - 1 );
+    mEdgeIndices.emplace( key, index );
+    return index;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
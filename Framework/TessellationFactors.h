@@ -0,0 +1,153 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file TessellationFactors.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <DirectXMath.h>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Tessellation factors of quad patches, worked out on the CPU from how
+/// long each edge is on screen and how far the surface strays from the
+/// flat patch, for the hull shader to read by SV_PrimitiveID instead of
+/// guessing from distance.
+///
+/// Patches use the quad domain: corners in the order (u, v) = (0, 0),
+/// (1, 0), (0, 1), (1, 1), and edges in SV_TessFactor order u = 0, v = 0,
+/// u = 1, v = 1. Patches that share two corner positions share the edge
+/// between them, and its factor is computed once, so the two sides always
+/// agree and no cracks open between patches.
+///
+/// An edge is given as its end points and its deviation: how far the
+/// curve along it can be from the straight line between them. The number
+/// of segments is the smaller of what keeps segments near
+/// targetEdgePixels long and what keeps the tessellated edge within
+/// maxErrorPixels of the curve (an error that falls with the square of
+/// the segment count), so flat edges stay coarse however close they are.
+/// Nothing here needs a device; PatchFactorBuffer uploads the result.
+///</summary>
+class TessellationFactors {
+public:
+
+    // What the hull shader reads per patch; 32 bytes, as the HLSL
+    // struct { float4 Edges; float2 Inside; float2 Pad; }.
+    struct PatchFactors {
+        float edges[4];
+        float inside[2];
+        float pad[2];
+    };
+
+    struct Settings {
+        Settings( void );
+
+        float targetEdgePixels;
+        float maxErrorPixels;   // 0 to tessellate by length alone
+        float minFactor;
+        float maxFactor;
+    };
+
+    struct View {
+        DirectX::XMFLOAT3 eye;
+
+        // Pixels covered by one unit at unit distance: half the viewport
+        // height times the (1, 1) element of the projection.
+        float pixelScale;
+
+        // Six world-space planes facing in, or null. Patches outside get
+        // factors of 0, which makes the hardware drop them.
+        const DirectX::XMFLOAT4* frustumPlanes;
+    };
+
+    struct Stats {
+        size_t patchesCulled;
+        double triangles;       // roughly what the tessellator makes
+    };
+
+    TessellationFactors( void );
+
+    void Clear( void );
+
+    // Adds a patch and returns its index, which is the SV_PrimitiveID it
+    // must be drawn as. edgeDeviation follows the edge order; an edge that
+    // is already known keeps the deviation it was first given.
+    uint32_t AddPatch( const DirectX::XMFLOAT3 corners[4],
+                       const float edgeDeviation[4],
+                       const float interiorDeviation,
+                       const DirectX::XMFLOAT3& boundsMin,
+                       const DirectX::XMFLOAT3& boundsMax );
+
+    // A bicubic Bezier patch, control points row by row (v), u along a
+    // row, as BezierTessellation.fx evaluates them. Deviations are bounded
+    // through the control points, which hold the patch in their hull.
+    uint32_t AddBezierPatch( const DirectX::XMFLOAT3 controlPoints[16] );
+
+    size_t GetPatchCount( void ) const;
+    size_t GetEdgeCount( void ) const;
+
+    void Compute( const View& view, const Settings& settings );
+
+    const std::vector<PatchFactors>& GetFactors( void ) const;
+
+    // Counts of the last Compute().
+    const Stats& GetStats( void ) const;
+
+    // Segments for a curve of the given chord length and deviation whose
+    // middle is distance away.
+    static float EdgeFactor( const float length,
+                             const float deviation,
+                             const float distance,
+                             const float pixelScale,
+                             const Settings& settings );
+
+private:
+
+    TessellationFactors( const TessellationFactors& rhs );
+    TessellationFactors& operator=( const TessellationFactors& rhs );
+
+    struct Edge {
+        DirectX::XMFLOAT3 center;
+        float length;
+        float deviation;
+    };
+
+    struct Patch {
+        uint32_t edges[4];
+        DirectX::XMFLOAT3 boundsMin;
+        DirectX::XMFLOAT3 boundsMax;
+        float deviation;
+    };
+
+    // Both end points, the lesser first, as bits.
+    struct EdgeKey {
+        bool operator==( const EdgeKey& rhs ) const;
+
+        uint32_t bits[6];
+    };
+
+    struct EdgeKeyHash {
+        size_t operator()( const EdgeKey& key ) const;
+    };
+
+    uint32_t FindEdge( const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b, const float deviation );
+
+    std::vector<Edge> mEdges;
+    std::vector<Patch> mPatches;
+    std::unordered_map<EdgeKey, uint32_t, EdgeKeyHash> mEdgeIndices;
+
+    std::vector<float> mEdgeFactors;
+    std::vector<PatchFactors> mFactors;
+
+    Stats mStats;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,213 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file TextureArrayBuilder.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "TextureArrayBuilder.h"
+#include "JobSystem.h"
+
+#include <cassert>
+#include <cstring>
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TextureArrayBuilder::TextureArrayBuilder( void )
+: mLayers( )
+, mFailedLayer( 0 )
+, mInfo( )
+, mSubresources( )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TextureArrayBuilder::AddFile( const std::wstring& filename )
+{
+    Layer layer;
+    layer.filename = filename;
+    layer.data = nullptr;
+    layer.size = 0;
+    layer.status = Ok;
+
+    mLayers.push_back( std::move( layer ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TextureArrayBuilder::AddMemory( const uint8_t* data, const size_t size )
+{
+    Layer layer;
+    layer.data = data;
+    layer.size = size;
+    layer.status = Ok;
+
+    mLayers.push_back( std::move( layer ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TextureArrayBuilder::Status TextureArrayBuilder::Build( JobSystem* jobs )
+{
+    mSubresources.clear();
+    memset( &mInfo, 0, sizeof( mInfo ) );
+
+    if ( mLayers.empty() ) {
+        return Fail( NoLayers, 0 );
+    }
+
+    // Layers are independent until they are compared, so each is mapped and
+    // parsed on its own job.
+    auto parse = [this]( size_t first, size_t last ) {
+        for ( size_t i = first; i < last; ++i ) {
+            ParseLayer( mLayers[i] );
+        }
+    };
+
+    if ( jobs ) {
+        jobs->ParallelFor( 0, mLayers.size(), 1, parse );
+    } else {
+        parse( 0, mLayers.size() );
+    }
+
+    const DDS::TextureInfo& base = mLayers[0].info;
+
+    for ( size_t i = 0; i < mLayers.size(); ++i ) {
+        const Layer& layer = mLayers[i];
+
+        if ( layer.status != Ok ) {
+            return Fail( layer.status, i );
+        }
+        if ( layer.info.format != base.format ) {
+            return Fail( FormatMismatch, i );
+        }
+        if ( layer.info.width != base.width || layer.info.height != base.height ) {
+            return Fail( SizeMismatch, i );
+        }
+        if ( layer.info.mipCount != base.mipCount ) {
+            return Fail( MipCountMismatch, i );
+        }
+    }
+
+    mInfo = base;
+    mInfo.arraySize = mLayers.size();
+
+    mSubresources.reserve( mInfo.mipCount * mInfo.arraySize );
+    for ( const Layer& layer : mLayers ) {
+        mSubresources.insert( mSubresources.end(), layer.subresources.begin(), layer.subresources.end() );
+    }
+
+    return Ok;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t TextureArrayBuilder::GetFailedLayer( void ) const
+{
+    return mFailedLayer;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t TextureArrayBuilder::GetWidth( void ) const
+{
+    return mInfo.width;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t TextureArrayBuilder::GetHeight( void ) const
+{
+    return mInfo.height;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t TextureArrayBuilder::GetMipLevels( void ) const
+{
+    return mInfo.mipCount;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t TextureArrayBuilder::GetArraySize( void ) const
+{
+    return mInfo.arraySize;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+DXGI_FORMAT TextureArrayBuilder::GetFormat( void ) const
+{
+    return mInfo.format;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const std::vector<DDS::Subresource>& TextureArrayBuilder::GetSubresources( void ) const
+{
+    return mSubresources;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TextureArrayBuilder::Clear( void )
+{
+    mLayers.clear();
+    mSubresources.clear();
+    memset( &mInfo, 0, sizeof( mInfo ) );
+    mFailedLayer = 0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TextureArrayBuilder::ParseLayer( Layer& layer )
+{
+    layer.subresources.clear();
+
+    // Files stay mapped from the first Build() until Clear().
+    if ( !layer.filename.empty() && !layer.file ) {
+        std::unique_ptr<DDS::MappedFile> file( new DDS::MappedFile() );
+        if ( file->Open( layer.filename.c_str() ) != DDS::Result::Ok ) {
+            layer.status = OpenFailed;
+            return;
+        }
+
+        layer.data = file->Data();
+        layer.size = file->Size();
+        layer.file = std::move( file );
+    }
+
+    if ( DDS::ParseHeader( layer.data, layer.size, layer.info ) != DDS::Result::Ok ) {
+        layer.status = ParseFailed;
+        return;
+    }
+
+    if ( layer.info.resDim != DDS::RESOURCE_DIMENSION_TEXTURE2D ||
+         layer.info.isCubeMap || layer.info.arraySize != 1 ) {
+        layer.status = NotTexture2D;
+        return;
+    }
+
+    if ( DDS::EnumerateSubresources( layer.info, 0, layer.subresources ) != DDS::Result::Ok ) {
+        layer.status = ParseFailed;
+        return;
+    }
+
+    assert( layer.subresources.size() == layer.info.mipCount );
+    layer.status = Ok;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TextureArrayBuilder::Status TextureArrayBuilder::Fail( const Status status, const size_t layer )
+{
+    mSubresources.clear();
+    memset( &mInfo, 0, sizeof( mInfo ) );
+    mFailedLayer = layer;
+
+    return status;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
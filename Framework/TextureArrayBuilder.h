@@ -0,0 +1,107 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file TextureArrayBuilder.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <DirectXTex/DDSTextureLoader/DDSParser.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Assembles the initial data of a 2D texture array from one DDS file per
+/// layer, so the array can be created in a single call instead of going
+/// through a staging texture and a map per layer and mip.
+///
+/// Files are memory-mapped and parsed on the job system, one job per layer;
+/// the subresources point straight into the mapped pages. Every layer must be
+/// a single 2D texture with the same format, size and mip count as the first.
+///
+/// It does not depend on a device: the result is the array description plus
+/// the subresource table in D3D11CalcSubresource() order, which
+/// TextureHelper::CreateTexture2DArraySRV() passes to CreateTexture2D().
+///</summary>
+class TextureArrayBuilder {
+public:
+
+    enum Status {
+        Ok,
+        NoLayers,
+        OpenFailed,     // A file could not be mapped.
+        ParseFailed,    // Not a valid DDS file, or shorter than its header says.
+        NotTexture2D,   // 1D, volume, cube map or already an array.
+        FormatMismatch,
+        SizeMismatch,
+        MipCountMismatch
+    };
+
+    TextureArrayBuilder( void );
+
+    // Layers are added in array order. Memory must stay valid until Clear()
+    // or destruction, as the subresources point into it.
+    void AddFile( const std::wstring& filename );
+    void AddMemory( const uint8_t* data, const size_t size );
+
+    // Parses all layers and, if they agree, builds the subresource table.
+    // Can be called again after adding more layers. jobs may be null, to
+    // parse every layer on the calling thread.
+    Status Build( JobSystem* jobs );
+
+    // Layer that made Build() fail.
+    size_t GetFailedLayer( void ) const;
+
+    size_t GetWidth( void ) const;
+    size_t GetHeight( void ) const;
+    size_t GetMipLevels( void ) const;
+    size_t GetArraySize( void ) const;
+    DXGI_FORMAT GetFormat( void ) const;
+
+    // All mips of layer 0, then of layer 1, ... Valid after a successful Build()
+    // until Clear().
+    const std::vector<DirectX::DDS::Subresource>& GetSubresources( void ) const;
+
+    // Unmaps the files and forgets all layers.
+    void Clear( void );
+
+private:
+
+    TextureArrayBuilder( const TextureArrayBuilder& rhs );
+    TextureArrayBuilder& operator=( const TextureArrayBuilder& rhs );
+
+    struct Layer {
+        std::wstring filename;
+        std::unique_ptr<DirectX::DDS::MappedFile> file;
+        const uint8_t* data;
+        size_t size;
+
+        Status status;
+        DirectX::DDS::TextureInfo info;
+        std::vector<DirectX::DDS::Subresource> subresources;
+    };
+
+    // Runs on a job; touches only its own layer.
+    static void ParseLayer( Layer& layer );
+
+    Status Fail( const Status status, const size_t layer );
+
+private:
+
+    std::vector<Layer> mLayers;
+
+    size_t mFailedLayer;
+    DirectX::DDS::TextureInfo mInfo;
+    std::vector<DirectX::DDS::Subresource> mSubresources;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -1,41 +1,317 @@
 #include "TextureMgr.h"
+#include <iterator>
 
+using namespace DirectX;
 
-TextureMgr::TextureMgr() : md3dDevice(0)
+TextureMgr::TextureMgr()
+: md3dDevice(0), mPlaceholderSRV(0), mBudget(0), mResidentBytes(0), mUseClock(0), mPending(0)
 {
 }
 
 TextureMgr::~TextureMgr()
 {
-	for(auto it = mTextureSRV.begin(); it != mTextureSRV.end(); ++it)
-    {
-		ReleaseCOM(it->second);
-    }
+	// Load jobs write into this object; let them finish first.
+	JobSystem::Instance().Wait(mLoads);
 
-	mTextureSRV.clear();
+	for(auto it = mEntries.begin(); it != mEntries.end(); ++it)
+	{
+		ReleaseCOM(it->SRV);
+	}
+
+	mEntries.clear();
+	mHandles.clear();
+
+	ReleaseCOM(mPlaceholderSRV);
 }
 
-void TextureMgr::Init(ID3D11Device* device)
+void TextureMgr::Init(ID3D11Device* device, size_t budgetBytes)
 {
 	md3dDevice = device;
+	mBudget = budgetBytes;
+
+	// 1x1 mid-grey stand-in for textures that are still loading.
+	const UINT grey = 0xff808080;
+
+	D3D11_TEXTURE2D_DESC texDesc;
+	texDesc.Width = 1;
+	texDesc.Height = 1;
+	texDesc.MipLevels = 1;
+	texDesc.ArraySize = 1;
+	texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	texDesc.SampleDesc.Count = 1;
+	texDesc.SampleDesc.Quality = 0;
+	texDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	texDesc.CPUAccessFlags = 0;
+	texDesc.MiscFlags = 0;
+
+	D3D11_SUBRESOURCE_DATA initData;
+	initData.pSysMem = &grey;
+	initData.SysMemPitch = sizeof(UINT);
+	initData.SysMemSlicePitch = 0;
+
+	ID3D11Texture2D* tex = 0;
+	HR(md3dDevice->CreateTexture2D(&texDesc, &initData, &tex));
+	HR(md3dDevice->CreateShaderResourceView(tex, 0, &mPlaceholderSRV));
+	ReleaseCOM(tex);
 }
 
 ID3D11ShaderResourceView* TextureMgr::CreateTexture(std::wstring filename)
 {
+	// The reference is never released, so the texture is never evicted.
+	Handle handle = Request(filename);
+
+	if( GetEntry(handle).Status == State_Loading )
+	{
+		Flush();
+	}
+
+	return GetEntry(handle).SRV;
+}
+
+TextureMgr::Handle TextureMgr::Request(const std::wstring& filename)
+{
+	auto it = mHandles.find(filename);
+
+	// Already known: share it, and stream it back in if it was evicted or
+	// try again if it failed (the file may have been fixed since).
+	if( it != mHandles.end() )
+	{
+		Entry& entry = GetEntry(it->second);
+		++entry.RefCount;
+
+		if( entry.Status == State_Evicted || entry.Status == State_Failed )
+		{
+			StartLoad(it->second);
+		}
+
+		return it->second;
+	}
+
+	Entry entry;
+	entry.Filename = filename;
+	entry.Status = State_Loading;
+	entry.RefCount = 1;
+	entry.SRV = 0;
+	entry.Bytes = 0;
+	entry.LastUsed = ++mUseClock;
+
+	mEntries.push_back(entry);
+
+	Handle handle = static_cast<Handle>(mEntries.size());
+	mHandles[filename] = handle;
+
+	StartLoad(handle);
+
+	return handle;
+}
+
+void TextureMgr::AddRef(Handle handle)
+{
+	++GetEntry(handle).RefCount;
+}
+
+void TextureMgr::Release(Handle handle)
+{
+	Entry& entry = GetEntry(handle);
+	assert(entry.RefCount > 0);
+
+	// Unreferenced textures stay resident until the budget needs the space.
+	--entry.RefCount;
+}
+
+ID3D11ShaderResourceView* TextureMgr::GetSRV(Handle handle)
+{
+	Entry& entry = GetEntry(handle);
+	entry.LastUsed = ++mUseClock;
+
+	// Still wanted after all; the placeholder stands in until it is back.
+	if( entry.Status == State_Evicted )
+	{
+		StartLoad(handle);
+	}
+
+	return entry.Status == State_Resident ? entry.SRV : mPlaceholderSRV;
+}
+
+bool TextureMgr::IsResident(Handle handle)const
+{
+	return GetEntry(handle).Status == State_Resident;
+}
+
+bool TextureMgr::IsFailed(Handle handle)const
+{
+	return GetEntry(handle).Status == State_Failed;
+}
+
+void TextureMgr::Update(UINT maxCreates)
+{
+	std::vector<LoadResult> completed;
+	{
+		std::lock_guard<std::mutex> lock(mCompletedMutex);
+
+		if( maxCreates == 0 || mCompleted.size() <= maxCreates )
+		{
+			completed.swap(mCompleted);
+		}
+		else
+		{
+			// Spread texture creation over several frames.
+			completed.insert(completed.end(),
+				std::make_move_iterator(mCompleted.begin()),
+				std::make_move_iterator(mCompleted.begin() + maxCreates));
+			mCompleted.erase(mCompleted.begin(), mCompleted.begin() + maxCreates);
+		}
+	}
+
+	for(size_t i = 0; i < completed.size(); ++i)
+	{
+		CreateResident(completed[i]);
+		--mPending;
+	}
+
+	Evict();
+}
+
+void TextureMgr::Flush()
+{
+	// Help the job system with the loads instead of just blocking.
+	JobSystem::Instance().Wait(mLoads);
+
+	Update();
+}
+
+size_t TextureMgr::GetResidentBytes()const
+{
+	return mResidentBytes;
+}
+
+size_t TextureMgr::GetPendingCount()const
+{
+	return mPending;
+}
+
+TextureMgr::Entry& TextureMgr::GetEntry(Handle handle)
+{
+	assert(handle != InvalidHandle && handle <= mEntries.size());
+	return mEntries[handle - 1];
+}
+
+const TextureMgr::Entry& TextureMgr::GetEntry(Handle handle)const
+{
+	assert(handle != InvalidHandle && handle <= mEntries.size());
+	return mEntries[handle - 1];
+}
+
+void TextureMgr::StartLoad(Handle handle)
+{
+	Entry& entry = GetEntry(handle);
+	entry.Status = State_Loading;
+	++mPending;
+
+	// The job gets its own copy of the name; mEntries may reallocate.
+	std::wstring filename = entry.Filename;
+
+	JobSystem::Instance().Run([this, handle, filename]()
+	{
+		LoadResult load;
+		load.Id = handle;
+		load.Result = E_FAIL;
+		load.File.reset(new DDS::MappedFile());
+		load.Bytes = 0;
+
+		DDS::TextureInfo info;
+		std::vector<DDS::Subresource> subresources;
+
+		if( load.File->Open(filename.c_str()) == DDS::Result::Ok &&
+			DDS::ParseHeader(load.File->Data(), load.File->Size(), info) == DDS::Result::Ok &&
+			DDS::EnumerateSubresources(info, 0, subresources) == DDS::Result::Ok )
+		{
+			// Touch every page of the pixels so the disk reads happen here and
+			// not when the owning thread creates the texture.
+			uint8_t sum = 0;
+			for(size_t offset = 0; offset < info.bitSize; offset += 4096)
+			{
+				sum ^= info.bitData[offset];
+			}
+			volatile uint8_t sink = sum;
+			(void)sink;
+
+			load.Result = S_OK;
+			load.Bytes = info.bitSize;
+		}
+		else
+		{
+			load.File.reset();
+		}
+
+		std::lock_guard<std::mutex> lock(mCompletedMutex);
+		mCompleted.push_back(std::move(load));
+	}, &mLoads);
+}
+
+void TextureMgr::CreateResident(LoadResult& load)
+{
+	Entry& entry = GetEntry(load.Id);
+
 	ID3D11ShaderResourceView* srv = 0;
+	HRESULT hr = load.Result;
 
-	// Does it already exist?
-	if( mTextureSRV.find(filename) != mTextureSRV.end() )
+	if( SUCCEEDED(hr) )
 	{
-		srv = mTextureSRV[filename];
+		// The in-tree loader parses the mapped file again (cheap, it is just
+		// the header) and hands Direct3D pointers into its pages.
+		hr = CreateDDSTextureFromMemory(md3dDevice,
+			load.File->Data(), load.File->Size(), nullptr, &srv);
 	}
-	else
+
+	// Unmaps the file; Direct3D has its own copy now.
+	load.File.reset();
+
+	if( FAILED(hr) )
 	{
-		//HR(D3DX11CreateShaderResourceViewFromFile(md3dDevice, filename.c_str(), 0, 0, &srv, 0 ));
+		entry.Status = State_Failed;
+		return;
+	}
+
+	entry.Status = State_Resident;
+	entry.SRV = srv;
+	entry.Bytes = load.Bytes;
+	entry.LastUsed = ++mUseClock;
 
-		mTextureSRV[filename] = srv;
+	mResidentBytes += entry.Bytes;
+}
+
+void TextureMgr::Evict()
+{
+	if( mResidentBytes <= mBudget )
+	{
+		return;
+	}
+
+	// Unreferenced resident textures, least recently used first. Referenced
+	// ones are never evicted, so the budget can be exceeded by live textures.
+	std::vector<Handle> candidates;
+	for(size_t i = 0; i < mEntries.size(); ++i)
+	{
+		if( mEntries[i].Status == State_Resident && mEntries[i].RefCount == 0 )
+		{
+			candidates.push_back(static_cast<Handle>(i + 1));
+		}
 	}
 
-	return srv;
+	std::sort(candidates.begin(), candidates.end(), [this](Handle a, Handle b)
+	{
+		return GetEntry(a).LastUsed < GetEntry(b).LastUsed;
+	});
+
+	for(size_t i = 0; i < candidates.size() && mResidentBytes > mBudget; ++i)
+	{
+		Entry& entry = GetEntry(candidates[i]);
+
+		ReleaseCOM(entry.SRV);
+		mResidentBytes -= entry.Bytes;
+		entry.Bytes = 0;
+		entry.Status = State_Evicted;
+	}
 }
- 
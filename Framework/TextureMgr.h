@@ -2,29 +2,121 @@
 #define TEXTUREMGR_H
 
 #include "d3dUtil.h"
+#include "JobSystem.h"
+#include <DirectXTex/DDSTextureLoader/DDSParser.h>
 #include <map>
+#include <mutex>
 
 ///<summary>
-/// Simple texture manager to avoid loading duplicate textures from file.  That can
-/// happen, for example, if multiple meshes reference the same texture filename. 
+/// Texture manager that streams DDS files in the background and avoids loading
+/// duplicate textures from file.  That can happen, for example, if multiple
+/// meshes reference the same texture filename.
+///
+/// Request() returns a handle right away; the file is mapped, parsed and paged
+/// in on the job system, and the GPU texture is created from the mapped file on
+/// the owning thread in Update().
+/// Until then GetSRV() returns a placeholder, so startup never waits on disk.
+/// Requests for a file that is already loading share the load.
+///
+/// Handles are reference counted. Textures nobody references stay cached until
+/// the resident total exceeds the budget; then the least recently used ones are
+/// evicted, and a later Request() or GetSRV() streams them back in. A load that
+/// failed is tried again by the next Request().
+///
+/// Everything except the file loads runs on the owning thread.
 ///</summary>
 class TextureMgr
 {
 public:
+	typedef UINT Handle;
+	static const Handle InvalidHandle = 0;
+
 	TextureMgr();
 	~TextureMgr();
 
-	void Init(ID3D11Device* device);
+	void Init(ID3D11Device* device, size_t budgetBytes = 256*1024*1024);
 
+	// Loads synchronously and returns a view the manager keeps alive until it
+	// is destroyed.
 	ID3D11ShaderResourceView* CreateTexture(std::wstring filename);
 
+	// Starts streaming filename (unless it is loaded or loading already, but
+	// again if it failed) and returns a handle holding one reference.
+	Handle Request(const std::wstring& filename);
+	void AddRef(Handle handle);
+	void Release(Handle handle);
+
+	// The texture, or the placeholder while it is not resident (or failed).
+	// An evicted texture is streamed back in.
+	ID3D11ShaderResourceView* GetSRV(Handle handle);
+	bool IsResident(Handle handle)const;
+	bool IsFailed(Handle handle)const;
+
+	// Call once per frame: creates GPU textures for finished loads (at most
+	// maxCreates, 0 for all) and evicts down to the budget.
+	void Update(UINT maxCreates = 0);
+
+	// Blocks until every requested load has finished and is resident.
+	void Flush();
+
+	size_t GetResidentBytes()const;
+	size_t GetPendingCount()const;
+
 private:
 	TextureMgr(const TextureMgr& rhs);
 	TextureMgr& operator=(const TextureMgr& rhs);
-	
+
+	enum State
+	{
+		State_Loading,
+		State_Resident,
+		State_Evicted,
+		State_Failed
+	};
+
+	struct Entry
+	{
+		std::wstring Filename;
+		State Status;
+		int RefCount;
+		ID3D11ShaderResourceView* SRV;
+		size_t Bytes;
+		UINT64 LastUsed;
+	};
+
+	// A mapped and parsed file handed from a load job back to the owning
+	// thread.
+	struct LoadResult
+	{
+		Handle Id;
+		HRESULT Result;
+		std::unique_ptr<DirectX::DDS::MappedFile> File;
+		size_t Bytes;
+	};
+
+	Entry& GetEntry(Handle handle);
+	const Entry& GetEntry(Handle handle)const;
+
+	void StartLoad(Handle handle);
+	void CreateResident(LoadResult& load);
+	void Evict();
+
 private:
 	ID3D11Device* md3dDevice;
-	std::map<std::wstring, ID3D11ShaderResourceView*> mTextureSRV;
+	ID3D11ShaderResourceView* mPlaceholderSRV;
+
+	std::vector<Entry> mEntries;
+	std::map<std::wstring, Handle> mHandles;
+
+	size_t mBudget;
+	size_t mResidentBytes;
+	UINT64 mUseClock;
+
+	// Finished loads waiting for Update(); the only state the jobs touch.
+	std::mutex mCompletedMutex;
+	std::vector<LoadResult> mCompleted;
+	JobCounter mLoads;
+	size_t mPending;
 };
 
-#endif // TEXTUREMGR_H
\ No newline at end of file
+#endif // TEXTUREMGR_H
@@ -0,0 +1,130 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file TransientTexturePool.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "TransientTexturePool.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TransientTexturePool::TransientTexturePool( void )
+: mSlots( )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TransientTexturePool::~TransientTexturePool( void )
+{
+    ReleaseAll();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TransientTexturePool::Realize( ID3D11Device* device, const FrameGraph& graph )
+{
+    std::vector<Texture> previous;
+    previous.swap( mSlots );
+
+    mSlots.resize( graph.GetPhysicalCount() );
+
+    for ( size_t i = 0; i < mSlots.size(); ++i ) {
+        const FrameGraph::TextureDesc& desc = graph.GetPhysicalDesc( static_cast<int>( i ) );
+
+        // Take over a texture from last time if one matches.
+        auto it = std::find_if( previous.begin(), previous.end(), [&desc]( const Texture& t ) {
+            return t.texture != nullptr && t.desc == desc;
+        } );
+
+        if ( it != previous.end() ) {
+            mSlots[i] = *it;
+            *it = Texture();
+        }
+        else {
+            mSlots[i].desc = desc;
+            Create( device, mSlots[i] );
+        }
+    }
+
+    for ( auto& t : previous ) {
+        Release( t );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const TransientTexturePool::Texture& TransientTexturePool::Get( const FrameGraph& graph,
+                                                                FrameGraph::ResourceHandle resource ) const
+{
+    const int slot = graph.GetPhysicalIndex( resource );
+    assert( slot != FrameGraph::Invalid && slot < static_cast<int>( mSlots.size() ) );
+
+    return mSlots[slot];
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TransientTexturePool::ReleaseAll( void )
+{
+    for ( auto& t : mSlots ) {
+        Release( t );
+    }
+
+    mSlots.clear();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t TransientTexturePool::GetMemoryUsage( void ) const
+{
+    size_t bytes = 0;
+    for ( auto& t : mSlots ) {
+        bytes += t.desc.width * t.desc.height *
+            DirectX::BitsPerPixel( static_cast<DXGI_FORMAT>( t.desc.format ) ) / 8;
+    }
+
+    return bytes;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TransientTexturePool::Create( ID3D11Device* device, Texture& t )
+{
+    D3D11_TEXTURE2D_DESC texDesc;
+    texDesc.Width = t.desc.width;
+    texDesc.Height = t.desc.height;
+    texDesc.MipLevels = 1;
+    texDesc.ArraySize = 1;
+    texDesc.Format = static_cast<DXGI_FORMAT>( t.desc.format );
+    texDesc.SampleDesc.Count = 1;
+    texDesc.SampleDesc.Quality = 0;
+    texDesc.Usage = D3D11_USAGE_DEFAULT;
+    texDesc.BindFlags = t.desc.bindFlags;
+    texDesc.CPUAccessFlags = 0;
+    texDesc.MiscFlags = 0;
+
+    HR( device->CreateTexture2D( &texDesc, nullptr, &t.texture ) );
+
+    // Null descriptions create views of the whole texture in its own format.
+    if ( t.desc.bindFlags & D3D11_BIND_SHADER_RESOURCE ) {
+        HR( device->CreateShaderResourceView( t.texture, nullptr, &t.srv ) );
+    }
+    if ( t.desc.bindFlags & D3D11_BIND_RENDER_TARGET ) {
+        HR( device->CreateRenderTargetView( t.texture, nullptr, &t.rtv ) );
+    }
+    if ( t.desc.bindFlags & D3D11_BIND_UNORDERED_ACCESS ) {
+        HR( device->CreateUnorderedAccessView( t.texture, nullptr, &t.uav ) );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TransientTexturePool::Release( Texture& t )
+{
+    ReleaseCOM( t.srv );
+    ReleaseCOM( t.rtv );
+    ReleaseCOM( t.uav );
+    ReleaseCOM( t.texture );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,63 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file TransientTexturePool.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "D3DUtil.h"
+#include "FrameGraph.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Owns the physical textures behind a compiled FrameGraph, one per physical
+/// slot. Textures are kept between calls to Realize() and reused whenever a
+/// slot's description is unchanged, so steady-state frames and graphs that
+/// only change shape do not allocate.
+///</summary>
+class TransientTexturePool {
+public:
+
+    struct Texture {
+        Texture( void ) : texture( nullptr ), srv( nullptr ), rtv( nullptr ), uav( nullptr ) { }
+
+        FrameGraph::TextureDesc desc;
+
+        ID3D11Texture2D* texture;
+        ID3D11ShaderResourceView* srv;
+        ID3D11RenderTargetView* rtv;
+        ID3D11UnorderedAccessView* uav;
+    };
+
+    TransientTexturePool( void );
+    ~TransientTexturePool( void );
+
+    // Makes sure there is a texture for every physical slot of the graph,
+    // reusing textures with a matching description and releasing the rest.
+    void Realize( ID3D11Device* device, const FrameGraph& graph );
+
+    // Views of the physical texture a transient resource is aliased to.
+    const Texture& Get( const FrameGraph& graph, FrameGraph::ResourceHandle resource ) const;
+
+    void ReleaseAll( void );
+
+    // Total bytes of texture memory held by the pool (ignoring padding).
+    size_t GetMemoryUsage( void ) const;
+
+private:
+
+    TransientTexturePool( const TransientTexturePool& rhs );
+    TransientTexturePool& operator=( const TransientTexturePool& rhs );
+
+    static void Create( ID3D11Device* device, Texture& t );
+    static void Release( Texture& t );
+
+private:
+
+    std::vector<Texture> mSlots;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,187 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file TransparencySorter.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "TransparencySorter.h"
+#include "JobSystem.h"
+#include "RadixSort.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    static_assert( TransparencySorter::DepthBits + TransparencySorter::StateBits <= 64,
+                   "Transparency key fields must fit in 64 bits" );
+
+    // Triangles handed to a job at a time when building keys and writing
+    // the sorted indices.
+    const size_t TriangleGrain = 4096;
+
+    inline uint64_t Field( const unsigned int value, const unsigned int bits )
+    {
+        return static_cast<uint64_t>( value ) & ( ( uint64_t( 1 ) << bits ) - 1 );
+    }
+
+    // The bits of z, flipped so they compare as unsigned integers in the
+    // order the floats do.
+    inline uint32_t SortableBits( const float z )
+    {
+        uint32_t bits;
+        std::memcpy( &bits, &z, sizeof( bits ) );
+        return ( bits & 0x80000000u ) != 0 ? ~bits : bits | 0x80000000u;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+unsigned int TransparencySorter::QuantizeDepth( const float z, const float nearZ, const float farZ )
+{
+    const unsigned int maxDepth = ( 1u << DepthBits ) - 1;
+
+    float t = farZ > nearZ ? ( z - nearZ ) / ( farZ - nearZ ) : 0.f;
+    // Written so NaN ends up at 0 too.
+    t = t > 0.f ? std::min( t, 1.f ) : 0.f;
+
+    const unsigned int depth = static_cast<unsigned int>( static_cast<double>( t ) * maxDepth + 0.5 );
+    return maxDepth - depth;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+uint64_t TransparencySorter::MakeKey( const unsigned int depth, const unsigned int state )
+{
+    uint64_t key = Field( depth, DepthBits );
+    key = ( key << StateBits ) | Field( state, StateBits );
+    return key << ( 64 - DepthBits - StateBits );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TransparencySorter::TransparencySorter( void )
+: mDepthAxis( 0.f, 0.f, 1.f, 0.f )
+, mNearZ( 0.f )
+, mFarZ( 1.f )
+{
+    mStats.items = 0;
+    mStats.draws = 0;
+    mStats.triangles = 0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TransparencySorter::Begin( FXMMATRIX view, const float nearZ, const float farZ )
+{
+    XMFLOAT4X4 v;
+    XMStoreFloat4x4( &v, view );
+    mDepthAxis = XMFLOAT4( v._13, v._23, v._33, v._43 );
+    mNearZ = nearZ;
+    mFarZ = farZ;
+
+    mQueue.Clear();
+
+    mStats.items = 0;
+    mStats.draws = 0;
+    mStats.triangles = 0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TransparencySorter::Submit( const RenderItem& item, const XMFLOAT3& center, const unsigned int state )
+{
+    const float z = mDepthAxis.x * center.x + mDepthAxis.y * center.y + mDepthAxis.z * center.z + mDepthAxis.w;
+    mQueue.Submit( MakeKey( QuantizeDepth( z, mNearZ, mFarZ ), state ), item );
+    ++mStats.items;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TransparencySorter::Sort( JobSystem* jobs )
+{
+    mQueue.Sort( jobs );
+    mStats.draws = mQueue.Merge();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TransparencySorter::Execute( RenderBackend& backend )
+{
+    mQueue.Execute( backend );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const RenderQueue& TransparencySorter::GetQueue( void ) const
+{
+    return mQueue;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void TransparencySorter::SortTriangles( const XMFLOAT3* positions,
+                                        const uint32_t* indices,
+                                        const size_t triangleCount,
+                                        FXMMATRIX worldView,
+                                        JobSystem* jobs,
+                                        uint32_t* sortedIndices )
+{
+    mStats.triangles += triangleCount;
+    if ( triangleCount == 0 ) {
+        return;
+    }
+
+    // Only the order matters, so the sum of the corners stands in for the
+    // centre and the translation is left out.
+    XMFLOAT4X4 m;
+    XMStoreFloat4x4( &m, worldView );
+    const XMFLOAT3 axis( m._13, m._23, m._33 );
+
+    const bool parallel = jobs != nullptr && triangleCount >= ParallelThreshold;
+    auto forRange = [&]( const std::function<void( size_t, size_t )>& body ) {
+        if ( parallel ) {
+            jobs->ParallelFor( 0, triangleCount, TriangleGrain, body );
+        } else {
+            body( 0, triangleCount );
+        }
+    };
+
+    // Keys far first.
+    mTriangles.resize( triangleCount );
+    forRange( [&]( size_t begin, size_t end ) {
+        for ( size_t t = begin; t < end; ++t ) {
+            const XMFLOAT3& p0 = positions[indices[3 * t + 0]];
+            const XMFLOAT3& p1 = positions[indices[3 * t + 1]];
+            const XMFLOAT3& p2 = positions[indices[3 * t + 2]];
+            const float z = axis.x * ( p0.x + p1.x + p2.x ) + axis.y * ( p0.y + p1.y + p2.y ) + axis.z * ( p0.z + p1.z + p2.z );
+
+            mTriangles[t].key = ~SortableBits( z );
+            mTriangles[t].index = static_cast<uint32_t>( t );
+        }
+    } );
+
+    RadixSort::Sort( mTriangles, mScratch, jobs, ParallelThreshold );
+
+    forRange( [&]( size_t begin, size_t end ) {
+        for ( size_t i = begin; i < end; ++i ) {
+            const uint32_t* triangle = &indices[3 * mTriangles[i].index];
+            sortedIndices[3 * i + 0] = triangle[0];
+            sortedIndices[3 * i + 1] = triangle[1];
+            sortedIndices[3 * i + 2] = triangle[2];
+        }
+    } );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const TransparencySorter::Stats& TransparencySorter::GetStats( void ) const
+{
+    return mStats;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
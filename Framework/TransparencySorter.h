@@ -0,0 +1,110 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file TransparencySorter.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "RenderQueue.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+class JobSystem;
+
+///<summary>
+/// The blended draws of a frame, drawn back to front.
+///
+/// Draws are queued with the world-space point they are sorted by and a
+/// state id. Their key is view depth first, quantized over the range given
+/// to Begin() and inverted so the far end sorts first, then the state id,
+/// so draws that land in the same depth step are grouped by state. The
+/// sort is RenderQueue's parallel radix sort; afterwards, draws that carry
+/// on each other's index range with the same state are merged.
+///
+/// A mesh that overlaps itself, like the waves, is not fixed by ordering
+/// it against other draws; SortTriangles() orders its triangles back to
+/// front instead, for an index buffer rewritten every frame. It sorts with
+/// the same RadixSort. That is a full sort of the mesh every frame, so
+/// callers should only use it where the overlap shows.
+///</summary>
+class TransparencySorter {
+public:
+
+    static const unsigned int DepthBits = 24;
+    static const unsigned int StateBits = 16;
+
+    // Meshes with fewer triangles than this are sorted on the calling
+    // thread.
+    static const size_t ParallelThreshold = 16384;
+
+    struct Stats {
+        size_t items;           // submitted
+        size_t draws;           // left after merging
+        size_t triangles;       // sorted by SortTriangles()
+    };
+
+    // Depth as a key field, far end first.
+    static unsigned int QuantizeDepth( const float z, const float nearZ, const float farZ );
+
+    static uint64_t MakeKey( const unsigned int depth, const unsigned int state );
+
+    TransparencySorter( void );
+
+    // Starts a frame seen through view, depths clamped to [nearZ, farZ].
+    void Begin( DirectX::FXMMATRIX view, const float nearZ, const float farZ );
+
+    void Submit( const RenderItem& item, const DirectX::XMFLOAT3& center, const unsigned int state );
+
+    // Sorts back to front and merges. jobs may be null to sort serially.
+    void Sort( JobSystem* jobs );
+
+    void Execute( RenderBackend& backend );
+
+    // The sorted draws, for inspection.
+    const RenderQueue& GetQueue( void ) const;
+
+    // Writes the triangleCount triangles of indices to sortedIndices, the
+    // furthest from the camera first, by the view depth of their centres.
+    // worldView takes positions to view space. jobs may be null.
+    void SortTriangles( const DirectX::XMFLOAT3* positions,
+                        const uint32_t* indices,
+                        const size_t triangleCount,
+                        DirectX::FXMMATRIX worldView,
+                        JobSystem* jobs,
+                        uint32_t* sortedIndices );
+
+    // Counts since the last Begin().
+    const Stats& GetStats( void ) const;
+
+private:
+
+    TransparencySorter( const TransparencySorter& rhs );
+    TransparencySorter& operator=( const TransparencySorter& rhs );
+
+    struct Triangle {
+        uint32_t key;
+        uint32_t index;
+    };
+
+    RenderQueue mQueue;
+
+    // Third column of the view matrix: view depth is a dot product with it.
+    DirectX::XMFLOAT4 mDepthAxis;
+    float mNearZ;
+    float mFarZ;
+
+    std::vector<Triangle> mTriangles;
+    std::vector<Triangle> mScratch;
+
+    Stats mStats;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,415 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file Vegetation.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Vegetation.h"
+#include "JobSystem.h"
+#include "RadixSort.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // Candidate points tried around each active one before it is retired.
+    const int PoissonTries = 30;
+
+    // Cells handed to a job at a time.
+    const size_t CellGrain = 64;
+
+    const uint32_t Culled = 0xFFFFFFFF;
+
+    // Non-negative floats order the same as their bits.
+    inline uint32_t SortableBits( const float value )
+    {
+        uint32_t bits;
+        std::memcpy( &bits, &value, sizeof( bits ) );
+        return bits;
+    }
+
+    inline float PlaneDistance( const XMFLOAT4& plane, const float x, const float y, const float z )
+    {
+        return plane.x * x + plane.y * y + plane.z * z + plane.w;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+Vegetation::Desc::Desc( void )
+: minX( -50.f )
+, minZ( -50.f )
+, maxX( 50.f )
+, maxZ( 50.f )
+, spacing( 5.f )
+, cellSize( 32.f )
+, size( 24.f, 24.f )
+, centerHeight( 10.f )
+, minHeight( -1e30f )
+, maxTrees( 0 )
+, seed( 1 )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+Vegetation::Vegetation( void )
+: mTrees( )
+, mCells( )
+, mVisibility( )
+, mOffsets( )
+, mCandidates( )
+, mScratch( )
+, mStats( )
+{
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Vegetation::Place( const Desc& desc, const HeightFunc& height )
+{
+    mTrees.clear();
+    mCells.clear();
+    mStats = Stats();
+
+    const float width = desc.maxX - desc.minX;
+    const float depth = desc.maxZ - desc.minZ;
+    if ( width <= 0.f || depth <= 0.f || desc.spacing <= 0.f || desc.cellSize <= 0.f ) {
+        return;
+    }
+
+    // Bridson's sampling, growing out from the newest point so the working
+    // set stays small. The background grid is fine enough that a cell
+    // holds at most one point, so a candidate only has to be checked
+    // against the 5x5 cells around it.
+    const float r = desc.spacing;
+    const float r2 = r * r;
+    const float gridSize = r / std::sqrt( 2.f );
+    const int gridX = std::max( 1, static_cast<int>( std::ceil( width / gridSize ) ) );
+    const int gridZ = std::max( 1, static_cast<int>( std::ceil( depth / gridSize ) ) );
+
+    std::vector<XMFLOAT2> points;
+    std::vector<int32_t> grid( static_cast<size_t>( gridX ) * gridZ, -1 );
+    std::vector<uint32_t> active;
+    std::vector<VegetationSprite> trees;
+
+    Random random( desc.seed );
+
+    auto gridIndex = [&]( const float x, const float z, int& gx, int& gz ) {
+        gx = std::min( gridX - 1, static_cast<int>( ( x - desc.minX ) / gridSize ) );
+        gz = std::min( gridZ - 1, static_cast<int>( ( z - desc.minZ ) / gridSize ) );
+    };
+
+    auto add = [&]( const float x, const float z ) {
+        int gx, gz;
+        gridIndex( x, z, gx, gz );
+        grid[static_cast<size_t>( gz ) * gridX + gx] = static_cast<int32_t>( points.size() );
+        active.push_back( static_cast<uint32_t>( points.size() ) );
+        points.push_back( XMFLOAT2( x, z ) );
+
+        // Points under minHeight still keep others away, so the shore does
+        // not get a row of trees crammed along it.
+        const float y = height( x, z );
+        if ( y >= desc.minHeight ) {
+            VegetationSprite tree;
+            tree.pos = XMFLOAT3( x, y + desc.centerHeight, z );
+            tree.size = desc.size;
+            trees.push_back( tree );
+        }
+    };
+
+    auto fits = [&]( const float x, const float z ) {
+        if ( x < desc.minX || x >= desc.maxX || z < desc.minZ || z >= desc.maxZ ) {
+            return false;
+        }
+        int gx, gz;
+        gridIndex( x, z, gx, gz );
+        for ( int j = std::max( 0, gz - 2 ); j <= std::min( gridZ - 1, gz + 2 ); ++j ) {
+            for ( int i = std::max( 0, gx - 2 ); i <= std::min( gridX - 1, gx + 2 ); ++i ) {
+                // Corner cells are at least r away.
+                if ( std::abs( i - gx ) == 2 && std::abs( j - gz ) == 2 ) {
+                    continue;
+                }
+                const int32_t other = grid[static_cast<size_t>( j ) * gridX + i];
+                if ( other >= 0 ) {
+                    const float dx = points[other].x - x;
+                    const float dz = points[other].y - z;
+                    if ( dx * dx + dz * dz < r2 ) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    };
+
+    const float ringRadius = r * 1.0001f;
+    XMFLOAT2 ring[PoissonTries];
+    for ( int t = 0; t < PoissonTries; ++t ) {
+        const float angle = XM_2PI * t / PoissonTries;
+        ring[t] = XMFLOAT2( std::cos( angle ), std::sin( angle ) );
+    }
+
+    const size_t maxTrees = desc.maxTrees > 0 ? desc.maxTrees : static_cast<size_t>( -1 );
+
+    add( random.NextFloat( desc.minX, desc.maxX ), random.NextFloat( desc.minZ, desc.maxZ ) );
+    while ( !active.empty() && trees.size() < maxTrees ) {
+        const XMFLOAT2 center = points[active.back()];
+
+        // Candidates on a ring just past r at evenly spaced angles, turned
+        // by a random amount (Roberts' variant of Bridson's algorithm):
+        // denser than uniform samples in the annulus, and no trig per try.
+        const float angle = random.NextFloat( 0.f, XM_2PI );
+        const float turnCos = std::cos( angle );
+        const float turnSin = std::sin( angle );
+
+        bool found = false;
+        for ( int t = 0; t < PoissonTries; ++t ) {
+            const XMFLOAT2& direction = ring[t];
+            const float x = center.x + ringRadius * ( direction.x * turnCos - direction.y * turnSin );
+            const float z = center.y + ringRadius * ( direction.x * turnSin + direction.y * turnCos );
+            if ( fits( x, z ) ) {
+                add( x, z );
+                found = true;
+                break;
+            }
+        }
+
+        if ( !found ) {
+            active.pop_back();
+        }
+    }
+
+    // Bucket the trees into culling cells, keeping each cell contiguous.
+    const int cellsX = std::max( 1, static_cast<int>( std::ceil( width / desc.cellSize ) ) );
+    const int cellsZ = std::max( 1, static_cast<int>( std::ceil( depth / desc.cellSize ) ) );
+    const size_t cellCount = static_cast<size_t>( cellsX ) * cellsZ;
+
+    auto cellOf = [&]( const VegetationSprite& tree ) {
+        const int cx = std::min( cellsX - 1, std::max( 0, static_cast<int>( ( tree.pos.x - desc.minX ) / desc.cellSize ) ) );
+        const int cz = std::min( cellsZ - 1, std::max( 0, static_cast<int>( ( tree.pos.z - desc.minZ ) / desc.cellSize ) ) );
+        return static_cast<size_t>( cz ) * cellsX + cx;
+    };
+
+    std::vector<uint32_t> counts( cellCount + 1, 0 );
+    for ( const VegetationSprite& tree : trees ) {
+        ++counts[cellOf( tree ) + 1];
+    }
+    for ( size_t c = 1; c <= cellCount; ++c ) {
+        counts[c] += counts[c - 1];
+    }
+
+    mCells.reserve( cellCount );
+    for ( size_t c = 0; c < cellCount; ++c ) {
+        if ( counts[c + 1] > counts[c] ) {
+            Cell cell;
+            cell.boundsMin = XMFLOAT3( +FLT_MAX, +FLT_MAX, +FLT_MAX );
+            cell.boundsMax = XMFLOAT3( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+            cell.first = counts[c];
+            cell.count = counts[c + 1] - counts[c];
+            mCells.push_back( cell );
+        }
+    }
+
+    mTrees.resize( trees.size() );
+    std::vector<uint32_t> next( counts.begin(), counts.end() - 1 );
+    for ( const VegetationSprite& tree : trees ) {
+        mTrees[next[cellOf( tree )]++] = tree;
+    }
+
+    // A sprite turns about y to face the eye, so it can reach half its
+    // width out in both x and z.
+    for ( Cell& cell : mCells ) {
+        for ( uint32_t i = cell.first; i < cell.first + cell.count; ++i ) {
+            const VegetationSprite& tree = mTrees[i];
+            const float hw = 0.5f * tree.size.x;
+            const float hh = 0.5f * tree.size.y;
+            cell.boundsMin.x = std::min( cell.boundsMin.x, tree.pos.x - hw );
+            cell.boundsMin.y = std::min( cell.boundsMin.y, tree.pos.y - hh );
+            cell.boundsMin.z = std::min( cell.boundsMin.z, tree.pos.z - hw );
+            cell.boundsMax.x = std::max( cell.boundsMax.x, tree.pos.x + hw );
+            cell.boundsMax.y = std::max( cell.boundsMax.y, tree.pos.y + hh );
+            cell.boundsMax.z = std::max( cell.boundsMax.z, tree.pos.z + hw );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t Vegetation::GetTreeCount( void ) const
+{
+    return mTrees.size();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+size_t Vegetation::GetCellCount( void ) const
+{
+    return mCells.size();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const std::vector<VegetationSprite>& Vegetation::GetTrees( void ) const
+{
+    return mTrees;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Vegetation::Gather( const XMFLOAT4 planes[6],
+                         const XMFLOAT3& eye,
+                         const float fadeStart,
+                         const float fadeEnd,
+                         std::vector<VegetationSprite>& sprites,
+                         JobSystem* jobs )
+{
+    sprites.clear();
+
+    const size_t cellCount = mCells.size();
+    const bool parallel = jobs != nullptr && mTrees.size() >= ParallelThreshold;
+    const float fadeEnd2 = fadeEnd * fadeEnd;
+
+    // Cells: out of view or range, partly in view, or wholly in view.
+    mVisibility.resize( cellCount );
+    auto classify = [&]( const size_t begin, const size_t end ) {
+        for ( size_t c = begin; c < end; ++c ) {
+            const Cell& cell = mCells[c];
+            const XMFLOAT3& lo = cell.boundsMin;
+            const XMFLOAT3& hi = cell.boundsMax;
+
+            const float dx = std::max( 0.f, std::max( lo.x - eye.x, eye.x - hi.x ) );
+            const float dy = std::max( 0.f, std::max( lo.y - eye.y, eye.y - hi.y ) );
+            const float dz = std::max( 0.f, std::max( lo.z - eye.z, eye.z - hi.z ) );
+
+            Visibility visibility = dx * dx + dy * dy + dz * dz > fadeEnd2 ? Outside : Inside;
+            for ( int p = 0; p < 6 && visibility != Outside; ++p ) {
+                const XMFLOAT4& plane = planes[p];
+                // The corners furthest in and furthest out along the normal.
+                const float in = PlaneDistance( plane, plane.x >= 0.f ? hi.x : lo.x,
+                                                       plane.y >= 0.f ? hi.y : lo.y,
+                                                       plane.z >= 0.f ? hi.z : lo.z );
+                const float out = PlaneDistance( plane, plane.x >= 0.f ? lo.x : hi.x,
+                                                        plane.y >= 0.f ? lo.y : hi.y,
+                                                        plane.z >= 0.f ? lo.z : hi.z );
+                if ( in < 0.f ) {
+                    visibility = Outside;
+                } else if ( out < 0.f ) {
+                    visibility = Partial;
+                }
+            }
+            mVisibility[c] = static_cast<uint8_t>( visibility );
+        }
+    };
+
+    if ( parallel ) {
+        jobs->ParallelFor( 0, cellCount, CellGrain, classify );
+    } else {
+        classify( 0, cellCount );
+    }
+
+    // Where each cell's candidates go.
+    mOffsets.resize( cellCount + 1 );
+    mOffsets[0] = 0;
+    size_t cellsVisible = 0;
+    for ( size_t c = 0; c < cellCount; ++c ) {
+        const bool visible = mVisibility[c] != Outside;
+        mOffsets[c + 1] = mOffsets[c] + ( visible ? mCells[c].count : 0 );
+        cellsVisible += visible ? 1 : 0;
+    }
+
+    const size_t candidateCount = mOffsets[cellCount];
+    mCandidates.resize( candidateCount );
+
+    auto fill = [&]( const size_t begin, const size_t end ) {
+        for ( size_t c = begin; c < end; ++c ) {
+            if ( mVisibility[c] == Outside ) {
+                continue;
+            }
+            const Cell& cell = mCells[c];
+            const bool partial = mVisibility[c] == Partial;
+            Candidate* out = &mCandidates[mOffsets[c]];
+
+            for ( uint32_t i = cell.first; i < cell.first + cell.count; ++i, ++out ) {
+                const VegetationSprite& tree = mTrees[i];
+                const float dx = tree.pos.x - eye.x;
+                const float dy = tree.pos.y - eye.y;
+                const float dz = tree.pos.z - eye.z;
+                const float distance2 = dx * dx + dy * dy + dz * dz;
+
+                bool visible = distance2 <= fadeEnd2;
+                if ( visible && partial ) {
+                    // The sprite's box, as the cell bounds are built.
+                    const float hw = 0.5f * tree.size.x;
+                    const float hh = 0.5f * tree.size.y;
+                    for ( int p = 0; p < 6; ++p ) {
+                        const XMFLOAT4& plane = planes[p];
+                        const float reach = hw * ( std::fabs( plane.x ) + std::fabs( plane.z ) ) + hh * std::fabs( plane.y );
+                        if ( PlaneDistance( plane, tree.pos.x, tree.pos.y, tree.pos.z ) < -reach ) {
+                            visible = false;
+                            break;
+                        }
+                    }
+                }
+
+                out->key = visible ? SortableBits( distance2 ) : Culled;
+                out->tree = i;
+            }
+        }
+    };
+
+    if ( parallel ) {
+        jobs->ParallelFor( 0, cellCount, CellGrain, fill );
+    } else {
+        fill( 0, cellCount );
+    }
+
+    RadixSort::Sort( mCandidates, mScratch, jobs, ParallelThreshold );
+
+    // Nearest first; culled sprites sorted to the end.
+    const float fadeRange = fadeEnd - fadeStart;
+    sprites.reserve( candidateCount );
+    for ( const Candidate& candidate : mCandidates ) {
+        if ( candidate.key == Culled ) {
+            break;
+        }
+
+        VegetationSprite sprite = mTrees[candidate.tree];
+        if ( fadeRange > 0.f ) {
+            float distance2;
+            std::memcpy( &distance2, &candidate.key, sizeof( distance2 ) );
+            const float scale = std::min( 1.f, std::max( 0.f, ( fadeEnd - std::sqrt( distance2 ) ) / fadeRange ) );
+
+            // Shrink towards the base, so the tree stays on the ground.
+            const float base = sprite.pos.y - 0.5f * sprite.size.y;
+            sprite.size.x *= scale;
+            sprite.size.y *= scale;
+            sprite.pos.y = base + 0.5f * sprite.size.y;
+        }
+        sprites.push_back( sprite );
+    }
+
+    mStats.cellsTested = cellCount;
+    mStats.cellsVisible = cellsVisible;
+    mStats.spritesTested = candidateCount;
+    mStats.spritesVisible = sprites.size();
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+const Vegetation::Stats& Vegetation::GetStats( void ) const
+{
+    return mStats;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
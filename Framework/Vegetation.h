@@ -0,0 +1,143 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file Vegetation.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <DirectXMath.h>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+class JobSystem;
+
+///<summary>
+/// One tree as the sprite shaders take it; same layout as
+/// Vertex::TreePointSprite.
+///</summary>
+struct VegetationSprite {
+    DirectX::XMFLOAT3 pos;      // center of the sprite
+    DirectX::XMFLOAT2 size;
+};
+
+///<summary>
+/// Trees scattered over a height field, kept in a grid of cells so that a
+/// frame only looks at the cells in view.
+///
+/// Place() spreads trees with Poisson-disk sampling (no two closer than the
+/// spacing, no visible clumps or gaps) and buckets them by cell. Gather()
+/// then culls cells against the frustum and by distance, tests the sprites
+/// of the cells the frustum cuts, and returns what is left nearest first.
+/// Between fadeStart and fadeEnd sprites shrink towards their base, so
+/// they fade out instead of popping. Nothing here needs a device.
+///</summary>
+class Vegetation {
+public:
+
+    typedef std::function<float( float x, float z )> HeightFunc;
+
+    struct Desc {
+        Desc( void );
+
+        // Area to fill.
+        float minX;
+        float minZ;
+        float maxX;
+        float maxZ;
+
+        // Closest two trees may be.
+        float spacing;
+
+        // Side of a culling cell; a few times the spacing or more.
+        float cellSize;
+
+        DirectX::XMFLOAT2 size;
+
+        // Height of the sprite center above the ground.
+        float centerHeight;
+
+        // No trees where the ground is lower (under water).
+        float minHeight;
+
+        // 0 to fill the area.
+        size_t maxTrees;
+
+        uint64_t seed;
+    };
+
+    struct Stats {
+        size_t cellsTested;
+        size_t cellsVisible;    // in view and in range, in part at least
+        size_t spritesTested;
+        size_t spritesVisible;
+    };
+
+    // With fewer trees than this, Gather() runs on the calling thread.
+    static const size_t ParallelThreshold = 65536;
+
+    Vegetation( void );
+
+    void Place( const Desc& desc, const HeightFunc& height );
+
+    size_t GetTreeCount( void ) const;
+    size_t GetCellCount( void ) const;
+
+    // Trees in cell order.
+    const std::vector<VegetationSprite>& GetTrees( void ) const;
+
+    // Replaces the sprites with the visible ones, nearest to eye first.
+    // planes are the six frustum planes of ExtractFrustumPlanes(), facing
+    // in. Sprites past fadeEnd are dropped. jobs may be null.
+    void Gather( const DirectX::XMFLOAT4 planes[6],
+                 const DirectX::XMFLOAT3& eye,
+                 const float fadeStart,
+                 const float fadeEnd,
+                 std::vector<VegetationSprite>& sprites,
+                 JobSystem* jobs );
+
+    // Counts of the last Gather().
+    const Stats& GetStats( void ) const;
+
+private:
+
+    Vegetation( const Vegetation& rhs );
+    Vegetation& operator=( const Vegetation& rhs );
+
+    struct Cell {
+        DirectX::XMFLOAT3 boundsMin;
+        DirectX::XMFLOAT3 boundsMax;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    enum Visibility : uint8_t {
+        Outside,
+        Partial,
+        Inside
+    };
+
+    // Squared distance as sortable bits, and the tree.
+    struct Candidate {
+        uint32_t key;
+        uint32_t tree;
+    };
+
+    std::vector<VegetationSprite> mTrees;
+    std::vector<Cell> mCells;
+
+    std::vector<uint8_t> mVisibility;
+    std::vector<uint32_t> mOffsets;
+    std::vector<Candidate> mCandidates;
+    std::vector<Candidate> mScratch;
+
+    Stats mStats;
+
+};
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
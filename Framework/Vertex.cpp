@@ -35,6 +35,38 @@ const D3D11_INPUT_ELEMENT_DESC InputLayoutDesc::InstancedBasic32[8] =
     { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 64,  D3D11_INPUT_PER_INSTANCE_DATA, 1 }
 };
 
+// Per-instance data is an InstanceBatcher::Instance.
+const D3D11_INPUT_ELEMENT_DESC InputLayoutDesc::InstancedPosNormal[10] =
+{
+    { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLDINVTRANSPOSE", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 64, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLDINVTRANSPOSE", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 80, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLDINVTRANSPOSE", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 96, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLDINVTRANSPOSE", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 112, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+};
+
+// PosNormalTexTan vertices with an InstanceBatcher::Instance each.
+const D3D11_INPUT_ELEMENT_DESC InputLayoutDesc::InstancedPosNormalTexTan[12] =
+{
+    { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, 24, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TANGENT",  0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 32, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLDINVTRANSPOSE", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 64, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLDINVTRANSPOSE", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 80, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLDINVTRANSPOSE", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 96, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "WORLDINVTRANSPOSE", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 112, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+};
+
 const D3D11_INPUT_ELEMENT_DESC InputLayoutDesc::PosNormalTexTan[4] =
 {
     { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
@@ -58,6 +90,8 @@ ID3D11InputLayout* InputLayouts::Basic32 = nullptr;
 ID3D11InputLayout* InputLayouts::Pos = nullptr;
 ID3D11InputLayout* InputLayouts::TreePointSprite = nullptr;
 ID3D11InputLayout* InputLayouts::InstancedBasic32 = nullptr;
+ID3D11InputLayout* InputLayouts::InstancedPosNormal = nullptr;
+ID3D11InputLayout* InputLayouts::InstancedPosNormalTexTan = nullptr;
 ID3D11InputLayout* InputLayouts::PosNormalTexTan = nullptr;
 ID3D11InputLayout* InputLayouts::Terrain = nullptr;
 
@@ -95,6 +129,28 @@ void InputLayouts::InitAll(ID3D11Device* device)
     HR( device->CreateInputLayout( InputLayoutDesc::InstancedBasic32, 8, passDesc.pIAInputSignature,
                                    passDesc.IAInputSignatureSize, &InstancedBasic32 ) );*/
 
+    //
+    // InstancedPosNormal, for the Basic.fx files that have instanced techniques.
+    //
+
+    if ( Effects::BasicFX->Light1InstancedTech->IsValid() )
+    {
+        Effects::BasicFX->Light1InstancedTech->GetPassByIndex( 0 )->GetDesc( &passDesc );
+        HR( device->CreateInputLayout( InputLayoutDesc::InstancedPosNormal, 10, passDesc.pIAInputSignature,
+                                       passDesc.IAInputSignatureSize, &InstancedPosNormal ) );
+    }
+
+    //
+    // InstancedPosNormalTexTan, for the shadowed Basic.fx's instanced techniques.
+    //
+
+    if ( Effects::BasicFX->Light3TexInstancedTech->IsValid() )
+    {
+        Effects::BasicFX->Light3TexInstancedTech->GetPassByIndex( 0 )->GetDesc( &passDesc );
+        HR( device->CreateInputLayout( InputLayoutDesc::InstancedPosNormalTexTan, 12, passDesc.pIAInputSignature,
+                                       passDesc.IAInputSignatureSize, &InstancedPosNormalTexTan ) );
+    }
+
     //
     // NormalMap
     //
@@ -117,6 +173,8 @@ void InputLayouts::DestroyAll()
     ReleaseCOM( Pos );
     ReleaseCOM( TreePointSprite );
     ReleaseCOM( InstancedBasic32 );
+    ReleaseCOM( InstancedPosNormal );
+    ReleaseCOM( InstancedPosNormalTexTan );
     ReleaseCOM( PosNormalTexTan );
     ReleaseCOM( Terrain );
 }
@@ -59,6 +59,8 @@ public:
     static const D3D11_INPUT_ELEMENT_DESC Pos[1];
     static const D3D11_INPUT_ELEMENT_DESC TreePointSprite[2];
     static const D3D11_INPUT_ELEMENT_DESC InstancedBasic32[8];
+    static const D3D11_INPUT_ELEMENT_DESC InstancedPosNormal[10];
+    static const D3D11_INPUT_ELEMENT_DESC InstancedPosNormalTexTan[12];
     static const D3D11_INPUT_ELEMENT_DESC PosNormalTexTan[4];
     static const D3D11_INPUT_ELEMENT_DESC Terrain[3];
 };
@@ -73,6 +75,8 @@ public:
     static ID3D11InputLayout* Pos;
     static ID3D11InputLayout* TreePointSprite;
     static ID3D11InputLayout* InstancedBasic32;
+    static ID3D11InputLayout* InstancedPosNormal;
+    static ID3D11InputLayout* InstancedPosNormalTexTan;
     static ID3D11InputLayout* PosNormalTexTan;
     static ID3D11InputLayout* Terrain;
 };
@@ -3,6 +3,7 @@
 //***************************************************************************************
 
 #include "Waves.h"
+#include "JobSystem.h"
 #include <algorithm>
 #include <vector>
 #include <cassert>
@@ -111,8 +112,14 @@ void Waves::Update(float dt)
 	// Only update the simulation at the specified time step.
 	if( t >= mTimeStep )
 	{
+		// Rows are independent (each reads only the current solution), so
+		// they are split across the job system in bands.
+		JobSystem& jobs = JobSystem::Instance();
+
 		// Only update interior points; we use zero boundary conditions.
-		for(UINT i = 1; i < mNumRows-1; ++i)
+		jobs.ParallelFor(1, mNumRows-1, RowsPerJob, [this](size_t first, size_t last)
+		{
+		for(UINT i = (UINT)first; i < (UINT)last; ++i)
 		{
 			for(UINT j = 1; j < mNumCols-1; ++j)
 			{
@@ -134,6 +141,7 @@ void Waves::Update(float dt)
 						 mCurrSolution[i*mNumCols+j-1].y);
 			}
 		}
+		});
 
 		// We just overwrote the previous buffer with the new data, so
 		// this data needs to become the current solution and the old
@@ -145,7 +153,9 @@ void Waves::Update(float dt)
 		//
 		// Compute normals using finite difference scheme.
 		//
-		for(UINT i = 1; i < mNumRows-1; ++i)
+		jobs.ParallelFor(1, mNumRows-1, RowsPerJob, [this](size_t first, size_t last)
+		{
+		for(UINT i = (UINT)first; i < (UINT)last; ++i)
 		{
 			for(UINT j = 1; j < mNumCols-1; ++j)
 			{
@@ -165,6 +175,7 @@ void Waves::Update(float dt)
 				XMStoreFloat3(&mTangentX[i*mNumCols+j], T);
 			}
 		}
+		});
 	}
 }
 
@@ -28,6 +28,14 @@ public:
 	// Returns the solution at the ith grid point.
 	const DirectX::XMFLOAT3& operator[](int i)const { return mCurrSolution[i]; }
 
+	// Returns the ith grid point blended between the previous (alpha = 0) and
+	// current (alpha = 1) solutions, for rendering between fixed steps.
+	DirectX::XMFLOAT3 Interpolated(int i, float alpha)const
+	{
+		const float y0 = mPrevSolution[i].y;
+		return DirectX::XMFLOAT3(mCurrSolution[i].x, y0 + alpha*(mCurrSolution[i].y - y0), mCurrSolution[i].z);
+	}
+
 	// Returns the solution normal at the ith grid point.
 	const DirectX::XMFLOAT3& normal(int i)const { return mNormals[i]; }
 
@@ -39,6 +47,9 @@ public:
 	void Disturb(UINT i, UINT j, float magnitude);
 
 private:
+	// Grid rows per job when updating in parallel.
+	static const UINT RowsPerJob = 16;
+
 	UINT mNumRows;
 	UINT mNumCols;
 
@@ -2,12 +2,19 @@
 /// \file main.cpp
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
 
+#include <algorithm>
+#include <vector>
+
 #include "D3DApp.h"
+#include "D3DRenderBackend.h"
 #include "d3dx11Effect.h"
 #include "Effects.h"
 #include "GeometryGenerator.h"
+#include "InstanceBatcher.h"
+#include "InstanceBuffer.h"
 #include "LightHelper.h"
 #include "MathHelper.h"
+#include "RenderQueue.h"
 #include "Vertex.h"
 
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -36,9 +43,23 @@ private:
 
     void buildShapeBuffers( void );
     void buildSkullBuffers( void );
+    void buildSceneObjects( void );
 
 private:
 
+    // What drawScene() queues for each object. Ids go into the sort key.
+    struct SceneObject {
+        const XMFLOAT4X4* world;
+        const Material* material;
+        unsigned int materialId;
+        unsigned int meshId;
+        ID3D11Buffer* vb;
+        ID3D11Buffer* ib;
+        UINT indexCount;
+        UINT startIndex;
+        int baseVertex;
+    };
+
     ID3D11Buffer* mShapesVB;
     ID3D11Buffer* mShapesIB;
     ID3D11Buffer* mSkullVB;
@@ -76,6 +97,11 @@ private:
 
     UINT mSkullIndexCount;
 
+    std::vector<SceneObject> mObjects;
+    InstanceBatcher mBatcher;
+    InstanceBuffer mInstanceBuffer;
+    RenderQueue mRenderQueue;
+
     UINT mLightCount;
 
     XMFLOAT3 mEyePosW;
@@ -189,6 +215,7 @@ App::~App( void )
     ReleaseCOM( mShapesIB );
     ReleaseCOM( mSkullVB );
     ReleaseCOM( mSkullIB );   
+    mInstanceBuffer.Release();
 
     Effects::DestroyAll();
     InputLayouts::DestroyAll();
@@ -207,6 +234,9 @@ bool App::init( void )
 
     buildShapeBuffers();
     buildSkullBuffers();
+    buildSceneObjects();
+
+    mInstanceBuffer.Create( mD3DDevice, sizeof( InstanceBatcher::Instance ), 1024 );
 
     return true;
 }
@@ -262,6 +292,9 @@ void App::updateScene( const float dt )
 
 void App::drawScene( void )
 {
+    // Picks up edits to the .fx files while the demo runs.
+    Effects::ReloadChanged();
+
     mD3DImmediateContext->ClearRenderTargetView( mRenderTargetView,
                                                  reinterpret_cast<const float*>( &Colors::LightSteelBlue ) );
     mD3DImmediateContext->ClearDepthStencilView( mDepthStencilView,
@@ -269,119 +302,132 @@ void App::drawScene( void )
                                                  1.f,
                                                  0 );
 
-    mD3DImmediateContext->IASetInputLayout( InputLayouts::PosNormal );
-    mD3DImmediateContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-
     // Set constant buffers.
     XMMATRIX view = XMLoadFloat4x4( &mView );
     XMMATRIX proj = XMLoadFloat4x4( &mProj );
     XMMATRIX viewProj = view * proj;
 
     // Set per-frame constants.
-    Effects::BasicFX->SetDirLights( mDirLights );
-    Effects::BasicFX->SetEyePosW( mEyePosW );
+    CBPerFrame& perFrame = Effects::PerFrame.Edit();
+    std::copy( mDirLights, mDirLights + 3, perFrame.DirLights );
+    perFrame.EyePosW = mEyePosW;
+
+    BasicEffect* fx = Effects::BasicFX.Get();
 
     // Figure out which tech to use.
-    ID3DX11EffectTechnique* tech = Effects::BasicFX->Light1Tech;
+    ID3DX11EffectTechnique* tech = fx->Light1Tech;
+    ID3DX11EffectTechnique* instancedTech = fx->Light1InstancedTech;
     switch ( mLightCount ) {
     default:
     case 1:
         break;
 
     case 2:
-        tech = Effects::BasicFX->Light2Tech;
+        tech = fx->Light2Tech;
+        instancedTech = fx->Light2InstancedTech;
         break;
 
     case 3:
-        tech = Effects::BasicFX->Light3Tech;
+        tech = fx->Light3Tech;
+        instancedTech = fx->Light3InstancedTech;
         break;
     }
 
-    D3DX11_TECHNIQUE_DESC techDesc;
-    tech->GetDesc( &techDesc );
-    const UINT stride = sizeof( Vertex::PosNormal );
-    const UINT offset = 0;
-    for ( UINT p = 0; p < techDesc.Passes; ++p ) {
-        // Bind shape VBs.
-        mD3DImmediateContext->IASetVertexBuffers( 0, 1, &mShapesVB, &stride, &offset );
-        mD3DImmediateContext->IASetIndexBuffer( mShapesIB, DXGI_FORMAT_R32_UINT, 0 );
-
-        // Prepare to draw grid.
-        // Calculate matrices.
-        XMMATRIX world = XMLoadFloat4x4( &mGridWorld );
-        XMMATRIX worldInvTranspose = MathHelper::InverseTranspose( world );
-        XMMATRIX worldViewProj = world * view * proj;
-
-        // Set constant buffers.
-        Effects::BasicFX->SetWorld( world );
-        Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-        Effects::BasicFX->SetWorldViewProj( worldViewProj );
-        Effects::BasicFX->SetMaterial( mGridMat );
-
-        tech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-        mD3DImmediateContext->DrawIndexed( mGridIndexCount, mGridIndexOffset, mGridVertexOffset );
-
-        // Draw box.
-        world = XMLoadFloat4x4( &mBoxWorld );
-        worldInvTranspose = MathHelper::InverseTranspose( world );
-        worldViewProj = world*view*proj;
-
-        Effects::BasicFX->SetWorld( world );
-        Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-        Effects::BasicFX->SetWorldViewProj( worldViewProj );
-        Effects::BasicFX->SetMaterial( mBoxMat );
-
-        tech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-        mD3DImmediateContext->DrawIndexed( mBoxIndexCount, mBoxIndexOffset, mBoxVertexOffset );
-
-        // Draw the cylinders.
-        for ( int i = 0; i < 10; ++i )
-        {
-            world = XMLoadFloat4x4( &mCylWorld[i] );
-            worldInvTranspose = MathHelper::InverseTranspose( world );
-            worldViewProj = world*view*proj;
-
-            Effects::BasicFX->SetWorld( world );
-            Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-            Effects::BasicFX->SetWorldViewProj( worldViewProj );
-            Effects::BasicFX->SetMaterial( mCylinderMat );
-
-            tech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-            mD3DImmediateContext->DrawIndexed( mCylinderIndexCount, mCylinderIndexOffset, mCylinderVertexOffset );
-        }
+    // Group the objects sharing a mesh and a material; each group with more
+    // than one object is drawn with one instanced draw, from instance data
+    // written for all groups at once.
+    bool instancing = InputLayouts::InstancedPosNormal != nullptr;
+
+    mBatcher.Clear();
+    for ( const SceneObject& object : mObjects ) {
+        mBatcher.Add( object.meshId, object.materialId, *object.world, &object );
+    }
+    mBatcher.Build( nullptr );
+
+    // All the groups' instances go into one mapping of the ring.
+    mInstanceBuffer.Begin( mD3DImmediateContext );
 
-        // Draw the spheres.
-        for ( int i = 0; i < 10; ++i )
-        {
-            world = XMLoadFloat4x4( &mSphereWorld[i] );
-            worldInvTranspose = MathHelper::InverseTranspose( world );
-            worldViewProj = world*view*proj;
+    const std::vector<InstanceBatcher::Instance>& instances = mBatcher.GetInstances();
+    UINT startInstance = 0;
+    if ( instancing && !instances.empty() ) {
+        if ( !mInstanceBuffer.Upload( instances.data(), static_cast<UINT>( instances.size() ), startInstance ) ) {
+            // No room left this frame; draw one by one.
+            instancing = false;
+        }
+    }
 
-            Effects::BasicFX->SetWorld( world );
-            Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-            Effects::BasicFX->SetWorldViewProj( worldViewProj );
-            Effects::BasicFX->SetMaterial( mSphereMat );
+    mInstanceBuffer.Unmap( mD3DImmediateContext );
+
+    auto makeItem = [&view]( const SceneObject& object, ID3DX11EffectTechnique* technique, UINT pass, float& depth ) {
+        depth = XMVectorGetZ( XMVector3Transform( XMLoadFloat3( reinterpret_cast<const XMFLOAT3*>( &object.world->_41 ) ), view ) );
+
+        RenderItem item;
+        item.topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+        item.inputLayout = InputLayouts::PosNormal;
+        item.vertexBuffer = object.vb;
+        item.vertexStride = sizeof( Vertex::PosNormal );
+        item.indexBuffer = object.ib;
+        item.indexFormat = DXGI_FORMAT_R32_UINT;
+        item.technique = technique;
+        item.pass = pass;
+        item.object = &object;
+        item.indexCount = object.indexCount;
+        item.startIndex = object.startIndex;
+        item.baseVertex = object.baseVertex;
+        return item;
+    };
+
+    // Queue every object; sorted by material and mesh, each buffer and
+    // material is bound once. Clear() also forgets the bound state, since
+    // the context may have been used elsewhere since the last frame.
+    mRenderQueue.Clear();
 
-            tech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-            mD3DImmediateContext->DrawIndexed( mSphereIndexCount, mSphereIndexOffset, mSphereVertexOffset );
+    D3DX11_TECHNIQUE_DESC techDesc;
+    tech->GetDesc( &techDesc );
+    for ( UINT p = 0; p < techDesc.Passes; ++p ) {
+        for ( const InstanceBatcher::Batch& batch : mBatcher.GetBatches() ) {
+            float depth = 0.f;
+
+            if ( instancing && batch.instanceCount > 1 ) {
+                // Sorted by where the first of the group is.
+                RenderItem item = makeItem( *static_cast<const SceneObject*>( batch.object ), instancedTech, p, depth );
+                item.inputLayout = InputLayouts::InstancedPosNormal;
+                item.instanceBuffer = mInstanceBuffer.Get();
+                item.instanceStride = mInstanceBuffer.GetStride();
+                item.instanceCount = static_cast<UINT>( batch.instanceCount );
+                item.startInstance = startInstance + static_cast<UINT>( batch.firstInstance );
+
+                const unsigned int quantized = RenderQueue::QuantizeDepth( depth, 1.f, 1000.f, false );
+                mRenderQueue.Submit( RenderQueue::MakeKey( p, 1, 0, batch.material, batch.mesh, quantized ), item );
+                continue;
+            }
+
+            for ( size_t i = batch.firstInstance; i < batch.firstInstance + batch.instanceCount; ++i ) {
+                const SceneObject& object = *static_cast<const SceneObject*>( mBatcher.GetInstanceObject( i ) );
+                const RenderItem item = makeItem( object, tech, p, depth );
+
+                const unsigned int quantized = RenderQueue::QuantizeDepth( depth, 1.f, 1000.f, false );
+                mRenderQueue.Submit( RenderQueue::MakeKey( p, 0, 0, object.materialId, object.meshId, quantized ), item );
+            }
         }
+    }
 
-        // Draw skull.
-        mD3DImmediateContext->IASetVertexBuffers( 0, 1, &mSkullVB, &stride, &offset );
-        mD3DImmediateContext->IASetIndexBuffer( mSkullIB, DXGI_FORMAT_R32_UINT, 0 );
+    // A scene this size sorts on this thread.
+    mRenderQueue.Sort( nullptr );
 
-        world = XMLoadFloat4x4( &mSkullWorld );
-        worldInvTranspose = MathHelper::InverseTranspose( world );
-        worldViewProj = world*view*proj;
+    D3DRenderBackend backend( mD3DImmediateContext, [fx, &viewProj]( ID3D11DeviceContext* context, const RenderItem& item ) {
+        const SceneObject& object = *static_cast<const SceneObject*>( item.object );
 
-        Effects::BasicFX->SetWorld( world );
-        Effects::BasicFX->SetWorldInvTranspose( worldInvTranspose );
-        Effects::BasicFX->SetWorldViewProj( worldViewProj );
-        Effects::BasicFX->SetMaterial( mSkullMat );
+        // Instances bring their own world transforms.
+        CBPerObject perObject;
+        perObject.SetTransforms( item.instanceCount > 0 ? XMMatrixIdentity() : XMLoadFloat4x4( object.world ), viewProj );
+        perObject.Mat = *object.material;
+        fx->PerObject.Set( perObject );
 
-        tech->GetPassByIndex( p )->Apply( 0, mD3DImmediateContext );
-        mD3DImmediateContext->DrawIndexed( mSkullIndexCount, 0, 0 );
-    }
+        ID3DX11EffectTechnique* technique = static_cast<ID3DX11EffectTechnique*>( const_cast<void*>( item.technique ) );
+        fx->Apply( technique->GetPassByIndex( item.pass ), context );
+    } );
+    mRenderQueue.Execute( backend );
 
     HR( mSwapChain->Present( 0, 0 ) );
 }
@@ -604,4 +650,35 @@ void App::buildSkullBuffers( void )
     HR( mD3DDevice->CreateBuffer( &ibd, &iinitData, &mSkullIB ) );
 }
 
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void App::buildSceneObjects( void )
+{
+    enum { GridMaterial, BoxMaterial, CylinderMaterial, SphereMaterial, SkullMaterial };
+    enum { GridMesh, BoxMesh, CylinderMesh, SphereMesh, SkullMesh };
+
+    auto add = [this]( const XMFLOAT4X4& world, const Material& material, unsigned int materialId, unsigned int meshId,
+                       ID3D11Buffer* vb, ID3D11Buffer* ib, UINT indexCount, UINT startIndex, int baseVertex ) {
+        SceneObject object = { &world, &material, materialId, meshId, vb, ib, indexCount, startIndex, baseVertex };
+        mObjects.push_back( object );
+    };
+
+    mObjects.clear();
+
+    add( mGridWorld, mGridMat, GridMaterial, GridMesh,
+         mShapesVB, mShapesIB, mGridIndexCount, mGridIndexOffset, mGridVertexOffset );
+    add( mBoxWorld, mBoxMat, BoxMaterial, BoxMesh,
+         mShapesVB, mShapesIB, mBoxIndexCount, mBoxIndexOffset, mBoxVertexOffset );
+
+    for ( int i = 0; i < 10; ++i ) {
+        add( mCylWorld[i], mCylinderMat, CylinderMaterial, CylinderMesh,
+             mShapesVB, mShapesIB, mCylinderIndexCount, mCylinderIndexOffset, mCylinderVertexOffset );
+        add( mSphereWorld[i], mSphereMat, SphereMaterial, SphereMesh,
+             mShapesVB, mShapesIB, mSphereIndexCount, mSphereIndexOffset, mSphereVertexOffset );
+    }
+
+    add( mSkullWorld, mSkullMat, SkullMaterial, SkullMesh,
+         mSkullVB, mSkullIB, mSkullIndexCount, 0, 0 );
+}
+
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
\ No newline at end of file
@@ -0,0 +1,350 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file BezierPatchTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <random>
+
+#include <DirectXMath.h>
+
+#include "BezierPatch.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // BezierTessellation.fx's patch.
+    const XMFLOAT3 DemoPatch[16] = {
+        XMFLOAT3( -10.f, -10.f, 15.f ), XMFLOAT3( -5.f, 0.f, 15.f ), XMFLOAT3( 5.f, 0.f, 15.f ), XMFLOAT3( 10.f, 0.f, 15.f ),
+        XMFLOAT3( -15.f, 0.f, 5.f ), XMFLOAT3( -5.f, 0.f, 5.f ), XMFLOAT3( 5.f, 20.f, 5.f ), XMFLOAT3( 15.f, 0.f, 5.f ),
+        XMFLOAT3( -15.f, 0.f, -5.f ), XMFLOAT3( -5.f, 0.f, -5.f ), XMFLOAT3( 5.f, 0.f, -5.f ), XMFLOAT3( 15.f, 0.f, -5.f ),
+        XMFLOAT3( -10.f, 10.f, -15.f ), XMFLOAT3( -5.f, 0.f, -15.f ), XMFLOAT3( 5.f, 0.f, -15.f ), XMFLOAT3( 25.f, 10.f, -15.f ),
+    };
+
+    // Control points are within +-ControlRange, and the tolerances below
+    // scale with it: float rounding of sums of that size.
+    const float ControlRange = 30.f;
+    const double PositionTolerance = 1e-5 * ControlRange;
+    const double DerivativeTolerance = 1e-4 * ControlRange;
+    const double NormalTolerance = 1e-3;
+
+    struct Reference {
+        double position[3];
+        double dPdu[3];
+        double dPdv[3];
+        double normal[3];
+    };
+
+    // Bernstein basis B(i, 3) and its derivative 3 (B(i-1, 2) - B(i, 2)),
+    // in double.
+    double Bernstein( const int i, const double t )
+    {
+        static const double binomial[4] = { 1.0, 3.0, 3.0, 1.0 };
+        return binomial[i] * std::pow( t, i ) * std::pow( 1.0 - t, 3 - i );
+    }
+
+    double BernsteinDerivative( const int i, const double t )
+    {
+        const double s = 1.0 - t;
+        const double quadratic[3] = { s * s, 2.0 * s * t, t * t };
+        return 3.0 * ( ( i > 0 ? quadratic[i - 1] : 0.0 ) - ( i < 3 ? quadratic[i] : 0.0 ) );
+    }
+
+    // P( u, v ) = sum over rows j and columns i of B_i( u ) B_j( v ) P_ji.
+    Reference Evaluate( const XMFLOAT3 controlPoints[16], const double u, const double v )
+    {
+        Reference r = {};
+        for ( int j = 0; j < 4; ++j ) {
+            for ( int i = 0; i < 4; ++i ) {
+                const XMFLOAT3& p = controlPoints[j * 4 + i];
+                const double cp[3] = { p.x, p.y, p.z };
+                for ( int c = 0; c < 3; ++c ) {
+                    r.position[c] += Bernstein( i, u ) * Bernstein( j, v ) * cp[c];
+                    r.dPdu[c] += BernsteinDerivative( i, u ) * Bernstein( j, v ) * cp[c];
+                    r.dPdv[c] += Bernstein( i, u ) * BernsteinDerivative( j, v ) * cp[c];
+                }
+            }
+        }
+
+        const double* a = r.dPdu;
+        const double* b = r.dPdv;
+        r.normal[0] = a[1] * b[2] - a[2] * b[1];
+        r.normal[1] = a[2] * b[0] - a[0] * b[2];
+        r.normal[2] = a[0] * b[1] - a[1] * b[0];
+        const double length = std::sqrt( r.normal[0] * r.normal[0] + r.normal[1] * r.normal[1] + r.normal[2] * r.normal[2] );
+        for ( int c = 0; c < 3; ++c ) {
+            r.normal[c] /= length;
+        }
+        return r;
+    }
+
+    double Distance( const XMFLOAT3& a, const double b[3] )
+    {
+        const double dx = a.x - b[0];
+        const double dy = a.y - b[1];
+        const double dz = a.z - b[2];
+        return std::sqrt( dx * dx + dy * dy + dz * dz );
+    }
+
+    double Distance( const XMFLOAT3& a, const XMFLOAT3& b )
+    {
+        const double q[3] = { b.x, b.y, b.z };
+        return Distance( a, q );
+    }
+
+    // The demo patch, then random ones.
+    void MakePatch( const int index, std::mt19937& rng, XMFLOAT3 controlPoints[16] )
+    {
+        std::uniform_real_distribution<float> coordinate( -ControlRange, ControlRange );
+        for ( int i = 0; i < 16; ++i ) {
+            controlPoints[i] = index == 0 ? DemoPatch[i] : XMFLOAT3( coordinate( rng ), coordinate( rng ), coordinate( rng ) );
+        }
+    }
+
+    bool Contains( const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax, const XMFLOAT3& p, const float slack )
+    {
+        return p.x >= boundsMin.x - slack && p.y >= boundsMin.y - slack && p.z >= boundsMin.z - slack &&
+               p.x <= boundsMax.x + slack && p.y <= boundsMax.y + slack && p.z <= boundsMax.z + slack;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( BezierPatch_EvaluateMatchesBernstein )
+{
+    std::mt19937 rng( 7 );
+    std::uniform_real_distribution<float> unit( 0.f, 1.f );
+
+    double maxPosition = 0.0;
+    double maxDerivative = 0.0;
+    double maxNormal = 0.0;
+
+    for ( int trial = 0; trial < 200; ++trial ) {
+        XMFLOAT3 controlPoints[16];
+        MakePatch( trial, rng, controlPoints );
+        const BezierPatch patch( controlPoints );
+
+        for ( int k = 0; k < 100; ++k ) {
+            // The corners first, then anywhere.
+            const float u = k < 4 ? float( k & 1 ) : unit( rng );
+            const float v = k < 4 ? float( k >> 1 ) : unit( rng );
+            const Reference expected = Evaluate( controlPoints, u, v );
+
+            XMFLOAT3 position, dPdu, dPdv, normal;
+            patch.Evaluate( u, v, &position, &dPdu, &dPdv, &normal );
+
+            maxPosition = std::max( maxPosition, Distance( position, expected.position ) );
+            maxDerivative = std::max( maxDerivative, Distance( dPdu, expected.dPdu ) );
+            maxDerivative = std::max( maxDerivative, Distance( dPdv, expected.dPdv ) );
+            maxNormal = std::max( maxNormal, Distance( normal, expected.normal ) );
+
+            // The position-only overload is the same formula.
+            CHECK( Distance( patch.Evaluate( u, v ), position ) <= PositionTolerance );
+        }
+    }
+
+    CHECK( maxPosition <= PositionTolerance );
+    CHECK( maxDerivative <= DerivativeTolerance );
+    CHECK( maxNormal <= NormalTolerance );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( BezierPatch_EvaluateBatchMatchesEvaluate )
+{
+    std::mt19937 rng( 17 );
+    std::uniform_real_distribution<float> unit( 0.f, 1.f );
+
+    for ( int trial = 0; trial < 50; ++trial ) {
+        XMFLOAT3 controlPoints[16];
+        MakePatch( trial, rng, controlPoints );
+        const BezierPatch patch( controlPoints );
+
+        // Not a multiple of four, so the tail is covered.
+        const size_t Count = 103;
+        std::vector<XMFLOAT2> uv( Count );
+        for ( auto& q : uv ) {
+            q = XMFLOAT2( unit( rng ), unit( rng ) );
+        }
+
+        std::vector<XMFLOAT3> positions( Count ), dPdu( Count ), dPdv( Count ), normals( Count );
+        patch.EvaluateBatch( uv.data(), Count, positions.data(), dPdu.data(), dPdv.data(), normals.data() );
+
+        for ( size_t k = 0; k < Count; ++k ) {
+            XMFLOAT3 position, du, dv, normal;
+            patch.Evaluate( uv[k].x, uv[k].y, &position, &du, &dv, &normal );
+
+            CHECK( Distance( positions[k], position ) <= PositionTolerance );
+            CHECK( Distance( dPdu[k], du ) <= DerivativeTolerance );
+            CHECK( Distance( dPdv[k], dv ) <= DerivativeTolerance );
+            CHECK( Distance( normals[k], normal ) <= NormalTolerance );
+        }
+
+        // Null outputs are skipped.
+        std::vector<XMFLOAT3> onlyNormals( Count );
+        patch.EvaluateBatch( uv.data(), Count, nullptr, nullptr, nullptr, onlyNormals.data() );
+        for ( size_t k = 0; k < Count; ++k ) {
+            CHECK( Distance( onlyNormals[k], normals[k] ) <= NormalTolerance );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( BezierPatch_DerivativesMatchFiniteDifferences )
+{
+    const BezierPatch patch( DemoPatch );
+
+    std::mt19937 rng( 3 );
+    std::uniform_real_distribution<float> unit( 0.01f, 0.99f );
+
+    // Central differences in double around the float evaluation; h is big
+    // enough for float positions to resolve.
+    const float h = 1e-3f;
+    for ( int k = 0; k < 100; ++k ) {
+        const float u = unit( rng );
+        const float v = unit( rng );
+
+        XMFLOAT3 dPdu, dPdv;
+        patch.Evaluate( u, v, nullptr, &dPdu, &dPdv, nullptr );
+
+        const XMFLOAT3 a = patch.Evaluate( u + h, v );
+        const XMFLOAT3 b = patch.Evaluate( u - h, v );
+        const XMFLOAT3 c = patch.Evaluate( u, v + h );
+        const XMFLOAT3 d = patch.Evaluate( u, v - h );
+
+        const double du[3] = { ( a.x - b.x ) / ( 2.0 * h ), ( a.y - b.y ) / ( 2.0 * h ), ( a.z - b.z ) / ( 2.0 * h ) };
+        const double dv[3] = { ( c.x - d.x ) / ( 2.0 * h ), ( c.y - d.y ) / ( 2.0 * h ), ( c.z - d.z ) / ( 2.0 * h ) };
+
+        CHECK( Distance( dPdu, du ) <= 0.05 );
+        CHECK( Distance( dPdv, dv ) <= 0.05 );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( BezierPatch_NormalsAtCollapsedCornersAreUnit )
+{
+    // The first row collapsed to a point: dP/du vanishes along v = 0.
+    XMFLOAT3 controlPoints[16];
+    std::copy( DemoPatch, DemoPatch + 16, controlPoints );
+    for ( int i = 0; i < 4; ++i ) {
+        controlPoints[i] = XMFLOAT3( 0.f, 0.f, 15.f );
+    }
+    const BezierPatch patch( controlPoints );
+
+    const XMFLOAT2 uv[5] = {
+        XMFLOAT2( 0.f, 0.f ), XMFLOAT2( 0.5f, 0.f ), XMFLOAT2( 1.f, 0.f ), XMFLOAT2( 0.3f, 0.2f ), XMFLOAT2( 0.f, 0.f ),
+    };
+    XMFLOAT3 normals[5];
+    patch.EvaluateBatch( uv, 5, nullptr, nullptr, nullptr, normals );
+
+    for ( int k = 0; k < 5; ++k ) {
+        const XMFLOAT3& n = normals[k];
+        CHECK_NEAR( std::sqrt( n.x * n.x + n.y * n.y + n.z * n.z ), 1.f, 1e-3f );
+
+        XMFLOAT3 single;
+        patch.Evaluate( uv[k].x, uv[k].y, nullptr, nullptr, nullptr, &single );
+        CHECK( Distance( single, n ) <= NormalTolerance );
+    }
+
+    // Away from the collapsed edge the normal is the reference one.
+    const Reference expected = Evaluate( controlPoints, 0.3, 0.2 );
+    CHECK( Distance( normals[3], expected.normal ) <= NormalTolerance );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( BezierPatch_BoundsHoldThePatchAndTighten )
+{
+    std::mt19937 rng( 23 );
+
+    const int Samples = 40;
+    for ( int trial = 0; trial < 100; ++trial ) {
+        XMFLOAT3 controlPoints[16];
+        MakePatch( trial, rng, controlPoints );
+        const BezierPatch patch( controlPoints );
+
+        double previousVolume = 1e30;
+        for ( unsigned int subdivisions = 0; subdivisions <= 4; ++subdivisions ) {
+            XMFLOAT3 boundsMin, boundsMax;
+            patch.GetBounds( boundsMin, boundsMax, subdivisions );
+
+            const double volume = double( boundsMax.x - boundsMin.x ) * ( boundsMax.y - boundsMin.y ) * ( boundsMax.z - boundsMin.z );
+            CHECK( volume <= previousVolume * ( 1.0 + 1e-6 ) );
+            previousVolume = volume;
+
+            bool contained = true;
+            for ( int a = 0; a <= Samples; ++a ) {
+                for ( int b = 0; b <= Samples; ++b ) {
+                    const XMFLOAT3 p = patch.Evaluate( float( a ) / Samples, float( b ) / Samples );
+                    contained = contained && Contains( boundsMin, boundsMax, p, 1e-3f );
+                }
+            }
+            CHECK( contained );
+        }
+    }
+
+    // Four subdivisions leave the demo patch's box within a few hundredths
+    // of the densely sampled surface.
+    const BezierPatch patch( DemoPatch );
+    XMFLOAT3 sampledMin( 1e9f, 1e9f, 1e9f );
+    XMFLOAT3 sampledMax( -1e9f, -1e9f, -1e9f );
+    for ( int a = 0; a <= 400; ++a ) {
+        for ( int b = 0; b <= 400; ++b ) {
+            const XMFLOAT3 p = patch.Evaluate( a / 400.f, b / 400.f );
+            sampledMin = XMFLOAT3( std::min( sampledMin.x, p.x ), std::min( sampledMin.y, p.y ), std::min( sampledMin.z, p.z ) );
+            sampledMax = XMFLOAT3( std::max( sampledMax.x, p.x ), std::max( sampledMax.y, p.y ), std::max( sampledMax.z, p.z ) );
+        }
+    }
+
+    XMFLOAT3 boundsMin, boundsMax;
+    patch.GetBounds( boundsMin, boundsMax, 4 );
+    CHECK_NEAR( boundsMin.x, sampledMin.x, 0.05f );
+    CHECK_NEAR( boundsMin.y, sampledMin.y, 0.05f );
+    CHECK_NEAR( boundsMin.z, sampledMin.z, 0.05f );
+    CHECK_NEAR( boundsMax.x, sampledMax.x, 0.05f );
+    CHECK_NEAR( boundsMax.y, sampledMax.y, 0.05f );
+    CHECK_NEAR( boundsMax.z, sampledMax.z, 0.05f );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( BezierPatch_BakeSamplesTheSurface )
+{
+    const BezierPatch patch( DemoPatch );
+
+    const UINT Resolution = 16;
+    GeometryGenerator::MeshData mesh;
+    patch.Bake( Resolution, mesh );
+
+    CHECK( mesh.vertices.size() == ( Resolution + 1 ) * ( Resolution + 1 ) );
+    CHECK( mesh.indices.size() == Resolution * Resolution * 6 );
+
+    for ( const auto& vertex : mesh.vertices ) {
+        CHECK( Distance( vertex.position, patch.Evaluate( vertex.texC.x, vertex.texC.y ) ) <= PositionTolerance );
+    }
+
+    // Clockwise front faces (left handed): the face normal e1 x e2 agrees
+    // with the vertex normal.
+    int backFacing = 0;
+    for ( size_t t = 0; t + 2 < mesh.indices.size(); t += 3 ) {
+        const XMFLOAT3& a = mesh.vertices[mesh.indices[t]].position;
+        const XMFLOAT3& b = mesh.vertices[mesh.indices[t + 1]].position;
+        const XMFLOAT3& c = mesh.vertices[mesh.indices[t + 2]].position;
+        const XMFLOAT3& n = mesh.vertices[mesh.indices[t]].normal;
+
+        const XMFLOAT3 e1( b.x - a.x, b.y - a.y, b.z - a.z );
+        const XMFLOAT3 e2( c.x - a.x, c.y - a.y, c.z - a.z );
+        const XMFLOAT3 face( e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x );
+        backFacing += face.x * n.x + face.y * n.y + face.z * n.z < 0.f ? 1 : 0;
+    }
+    CHECK( backFacing == 0 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
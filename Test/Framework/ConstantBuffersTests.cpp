@@ -0,0 +1,213 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file ConstantBuffersTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ConstantBuffers.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // A member as the HLSL compiler places it, written out by hand from
+    // Basic.fx and LightHelper.fx: ": packoffset( c<reg>.<component> )".
+    struct PackOffset {
+        const char* name;
+        size_t reg;
+        size_t component;
+        size_t size;
+    };
+
+    // cbuffer cbPerFrame {
+    //     DirectionalLight gDirLights[3];  // 4 registers each: c0 - c11
+    //     float3 gEyePosW;                 // c12.xyz
+    //     float gFogStart;                 // c12.w
+    //     float gFogRange;                 // c13.x
+    //     float4 gFogColor;                // c14, as it does not fit in c13
+    // };
+    const PackOffset PerFrame[] = {
+        { "gDirLights", 0,  0, 3 * 64 },
+        { "gEyePosW",   12, 0, 12 },
+        { "gFogStart",  12, 3, 4 },
+        { "gFogRange",  13, 0, 4 },
+        { "gFogColor",  14, 0, 16 }
+    };
+    const size_t PerFrameRegisters = 15;
+
+    // cbuffer cbPerObject {
+    //     float4x4 gWorld;                 // c0 - c3
+    //     float4x4 gWorldInvTranspose;     // c4 - c7
+    //     float4x4 gWorldViewProj;         // c8 - c11
+    //     float4x4 gTexTransform;          // c12 - c15
+    //     Material gMaterial;              // c16 - c19
+    // };
+    const PackOffset PerObject[] = {
+        { "gWorld",             0,  0, 64 },
+        { "gWorldInvTranspose", 4,  0, 64 },
+        { "gWorldViewProj",     8,  0, 64 },
+        { "gTexTransform",      12, 0, 64 },
+        { "gMaterial",          16, 0, 64 }
+    };
+    const size_t PerObjectRegisters = 20;
+
+    template<size_t N>
+    bool MatchesHlsl( const ConstantBufferLayout& layout, const PackOffset ( &expected )[N], const size_t registers )
+    {
+        if ( layout.memberCount != N || layout.size != registers * 16 ) {
+            return false;
+        }
+        for ( size_t i = 0; i < N; ++i ) {
+            const ConstantBufferMember& member = layout.members[i];
+            if ( std::string( member.name ) != expected[i].name ||
+                 member.offset != expected[i].reg * 16 + expected[i].component * 4 ||
+                 member.size != expected[i].size ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Counts uploads and keeps the last one.
+    struct Uploads {
+        int count;
+        std::vector<char> last;
+
+        Uploads( void ) : count( 0 ) { }
+
+        void operator()( const void* data, size_t size )
+        {
+            ++count;
+            last.assign( static_cast<const char*>( data ), static_cast<const char*>( data ) + size );
+        }
+    };
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( ConstantBuffers_LayoutsMatchHlslPacking )
+{
+    CHECK( std::string( CBPerFrame::Layout().name ) == "cbPerFrame" );
+    CHECK( MatchesHlsl( CBPerFrame::Layout(), PerFrame, PerFrameRegisters ) );
+    CHECK( offsetof( CBPerFrame, EyePosW ) == 12 * 16 );
+    CHECK( offsetof( CBPerFrame, FogStart ) == 12 * 16 + 12 );
+    CHECK( offsetof( CBPerFrame, FogRange ) == 13 * 16 );
+    CHECK( offsetof( CBPerFrame, FogColor ) == 14 * 16 );
+    CHECK( sizeof( DirectionalLight ) == 4 * 16 );
+
+    CHECK( std::string( CBPerObject::Layout().name ) == "cbPerObject" );
+    CHECK( MatchesHlsl( CBPerObject::Layout(), PerObject, PerObjectRegisters ) );
+    CHECK( offsetof( CBPerObject, Mat ) == 16 * 16 );
+    CHECK( sizeof( Material ) == 4 * 16 );
+
+    // The packing rule the static_asserts use, on cases worked out by hand:
+    // a float3 and a float share a register, a float2 after a float3 and a
+    // float4 after a float do not, and structures start a new register.
+    CHECK( HlslPackOffset( 12, 4, false ) == 12 );
+    CHECK( HlslPackOffset( 12, 8, false ) == 16 );
+    CHECK( HlslPackOffset( 4, 16, false ) == 16 );
+    CHECK( HlslPackOffset( 8, 8, false ) == 8 );
+    CHECK( HlslPackOffset( 4, 4, true ) == 16 );
+    CHECK( HlslPackOffset( 32, 64, true ) == 32 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( ConstantBuffers_TransformsAreStoredTransposed )
+{
+    CBPerObject object;
+    CHECK( object.TexTransform.m[0][0] == 1.f && object.TexTransform.m[3][3] == 1.f );
+
+    const XMMATRIX world = XMMatrixMultiply( XMMatrixScaling( 2.f, 4.f, 8.f ), XMMatrixTranslation( 1.f, 2.f, 3.f ) );
+    object.SetTransforms( world, XMMatrixScaling( 1.f, 1.f, 0.5f ) );
+
+    // Translation in the last column, where a column-major float4x4 reads it.
+    CHECK( object.World.m[0][3] == 1.f && object.World.m[1][3] == 2.f && object.World.m[2][3] == 3.f );
+    CHECK( object.World.m[3][0] == 0.f && object.World.m[0][0] == 2.f );
+
+    // The inverse transpose of the scale, without translation.
+    CHECK_NEAR( object.WorldInvTranspose.m[0][0], 0.5f, 1e-6f );
+    CHECK_NEAR( object.WorldInvTranspose.m[1][1], 0.25f, 1e-6f );
+    CHECK_NEAR( object.WorldInvTranspose.m[2][2], 0.125f, 1e-6f );
+    CHECK( object.WorldInvTranspose.m[0][3] == 0.f && object.WorldInvTranspose.m[3][0] == 0.f );
+
+    CHECK( object.WorldViewProj.m[2][2] == 4.f && object.WorldViewProj.m[2][3] == 1.5f );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( ConstantBuffers_MirrorUploadsOnlyWhenChanged )
+{
+    ConstantBufferMirror<CBPerFrame> mirror;
+    const uint64_t initial = mirror.GetVersion();
+    CHECK( initial != 0 );
+
+    // The first flush of a new target always uploads; the next has nothing
+    // to do.
+    Uploads buffer;
+    uint64_t uploaded = 0;
+    CHECK( mirror.Flush( uploaded, std::ref( buffer ) ) );
+    CHECK( buffer.count == 1 && buffer.last.size() == sizeof( CBPerFrame ) );
+    CHECK( uploaded == mirror.GetVersion() );
+    CHECK( !mirror.Flush( uploaded, std::ref( buffer ) ) );
+    CHECK( buffer.count == 1 );
+
+    // Setting what is there already is not a change.
+    mirror.Set( CBPerFrame() );
+    CHECK( mirror.GetVersion() == initial );
+    CHECK( !mirror.Flush( uploaded, std::ref( buffer ) ) );
+
+    // Many setters between two draws: one upload, with all of them in it.
+    CBPerFrame frame;
+    frame.FogStart = 5.f;
+    mirror.Set( frame );
+    frame.FogRange = 150.f;
+    mirror.Set( frame );
+    mirror.Edit().EyePosW = XMFLOAT3( 1.f, 2.f, 3.f );
+    CHECK( mirror.GetVersion() == initial + 3 );
+
+    CHECK( mirror.Flush( uploaded, std::ref( buffer ) ) );
+    CHECK( !mirror.Flush( uploaded, std::ref( buffer ) ) );
+    CHECK( buffer.count == 2 );
+    CHECK( std::memcmp( buffer.last.data(), &mirror.Get(), sizeof( CBPerFrame ) ) == 0 );
+    CHECK( mirror.Get().FogStart == 5.f && mirror.Get().FogRange == 150.f && mirror.Get().EyePosW.z == 3.f );
+
+    // Edit() counts as a change even if nothing is written.
+    mirror.Edit();
+    CHECK( mirror.Flush( uploaded, std::ref( buffer ) ) );
+    CHECK( buffer.count == 3 );
+
+    // Each target keeps its own version: one that falls behind catches up
+    // with a single upload of the latest data.
+    Uploads other;
+    uint64_t otherUploaded = 0;
+    CHECK( mirror.Flush( otherUploaded, std::ref( other ) ) );
+    mirror.Edit().FogColor = XMFLOAT4( 1.f, 0.f, 0.f, 1.f );
+    mirror.Edit().FogColor.y = 1.f;
+    CHECK( mirror.Flush( otherUploaded, std::ref( other ) ) );
+    CHECK( other.count == 2 && buffer.count == 3 );
+    CHECK( mirror.Flush( uploaded, std::ref( buffer ) ) );
+    CHECK( buffer.count == 4 && buffer.last == other.last );
+
+    // A draw loop: per-object data changes for some objects only.
+    ConstantBufferMirror<CBPerObject> perObject;
+    Uploads objectBuffer;
+    uint64_t objectUploaded = 0;
+    for ( int draw = 0; draw < 10; ++draw ) {
+        if ( draw % 3 == 0 ) {
+            perObject.Edit().Mat.diffuse.x = static_cast<float>( draw );
+        }
+        perObject.Flush( objectUploaded, std::ref( objectBuffer ) );
+    }
+    CHECK( objectBuffer.count == 4 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,212 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file CpuBlurTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <DirectXMath.h>
+
+#include "BlurKernel.h"
+#include "CpuBlur.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    CpuBlur::Image RandomImage( const unsigned int width,
+                                const unsigned int height,
+                                const float offset,
+                                const unsigned int seed )
+    {
+        std::mt19937 rng( seed );
+        std::uniform_real_distribution<float> value( 0.f, 1.f );
+
+        CpuBlur::Image image( width, height );
+        for ( auto& texel : image.texels ) {
+            texel = XMFLOAT4( offset + value( rng ), offset + value( rng ), offset + value( rng ), offset + value( rng ) );
+        }
+        return image;
+    }
+
+    // One box pass along a row or column of doubles, clamped at the borders.
+    std::vector<double> NaiveBox( const std::vector<double>& in, const int radius )
+    {
+        const int n = static_cast<int>( in.size() );
+        std::vector<double> out( n );
+        for ( int i = 0; i < n; ++i ) {
+            double sum = 0.0;
+            for ( int k = -radius; k <= radius; ++k ) {
+                sum += in[std::min( std::max( i + k, 0 ), n - 1 )];
+            }
+            out[i] = sum / ( 2 * radius + 1 );
+        }
+        return out;
+    }
+
+    // Horizontal then vertical box blur in double, each window summed from
+    // scratch.
+    std::vector<double> NaiveBox( const CpuBlur::Image& src, const int channel, const int radius )
+    {
+        const unsigned int w = src.width;
+        const unsigned int h = src.height;
+        std::vector<double> image( w * h );
+        for ( size_t i = 0; i < image.size(); ++i ) {
+            image[i] = ( &src.texels[i].x )[channel];
+        }
+
+        std::vector<double> line;
+        for ( unsigned int y = 0; y < h; ++y ) {
+            line.assign( image.begin() + y * w, image.begin() + ( y + 1 ) * w );
+            line = NaiveBox( line, radius );
+            std::copy( line.begin(), line.end(), image.begin() + y * w );
+        }
+        for ( unsigned int x = 0; x < w; ++x ) {
+            line.resize( h );
+            for ( unsigned int y = 0; y < h; ++y ) {
+                line[y] = image[y * w + x];
+            }
+            line = NaiveBox( line, radius );
+            for ( unsigned int y = 0; y < h; ++y ) {
+                image[y * w + x] = line[y];
+            }
+        }
+        return image;
+    }
+
+    // Largest difference from NaiveBox over the texels at or past (minX, minY).
+    double MaxError( const CpuBlur::Image& actual,
+                     const CpuBlur::Image& src,
+                     const int radius,
+                     const unsigned int minX = 0,
+                     const unsigned int minY = 0 )
+    {
+        double maxError = 0.0;
+        for ( int c = 0; c < 4; ++c ) {
+            const std::vector<double> expected = NaiveBox( src, c, radius );
+            for ( unsigned int y = minY; y < src.height; ++y ) {
+                for ( unsigned int x = minX; x < src.width; ++x ) {
+                    const size_t i = y * src.width + x;
+                    maxError = std::max( maxError, std::fabs( ( &actual.texels[i].x )[c] - expected[i] ) );
+                }
+            }
+        }
+        return maxError;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( CpuBlur_BoxMatchesNaiveWindows )
+{
+    // Wider and taller than the 256 texel resync interval, and radii up to
+    // past the image edges.
+    const CpuBlur::Image src = RandomImage( 300, 270, 0.f, 1 );
+
+    const int radii[] = { 0, 1, 4, 30, 45, 128, 400 };
+    for ( const int radius : radii ) {
+        for ( unsigned int threads = 1; threads <= 4; threads += 3 ) {
+            CpuBlur::Image dst;
+            CpuBlur::Box( src, dst, radius, threads );
+
+            CHECK( dst.width == src.width && dst.height == src.height );
+            CHECK( MaxError( dst, src, radius ) <= 1e-4 );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( CpuBlur_BoxDoesNotDriftAlongLongRows )
+{
+    // A bright HDR texel near the start swamps the running sum while it is in
+    // the window, and what the sum rounds away then would stay missing for
+    // the rest of the row if the sum were never recomputed. Past the next
+    // resync the blur must be as accurate as anywhere else.
+    const int radius = 40;
+    const unsigned int length = 4096;
+    const unsigned int past = 512;
+
+    CpuBlur::Image rows = RandomImage( length, 2, 0.f, 2 );
+    rows.at( 20, 0 ) = rows.at( 21, 1 ) = XMFLOAT4( 1e6f, 1e6f, 1e6f, 1e6f );
+
+    CpuBlur::Image columns = RandomImage( 2, length, 0.f, 3 );
+    columns.at( 0, 20 ) = columns.at( 1, 21 ) = XMFLOAT4( 1e6f, 1e6f, 1e6f, 1e6f );
+
+    CpuBlur::Image dst;
+    CpuBlur::Box( rows, dst, radius, 1 );
+    CHECK( MaxError( dst, rows, radius, past, 0 ) <= 1e-5 );
+
+    CpuBlur::Box( columns, dst, radius, 1 );
+    CHECK( MaxError( dst, columns, radius, 0, past ) <= 1e-5 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( CpuBlur_IteratedBoxApproximatesGaussian )
+{
+    // An impulse blurs into the kernel itself, so compare the two kernels.
+    const unsigned int size = 385;
+    const unsigned int center = size / 2;
+
+    for ( const float sigma : { 3.f, 12.f, 35.f } ) {
+        CpuBlur::Image impulse( size, size );
+        impulse.at( center, center ) = XMFLOAT4( 1.f, 1.f, 1.f, 1.f );
+
+        CpuBlur::Image box;
+        CpuBlur::IteratedBox( impulse, box, sigma, 3 );
+
+        CpuBlur::Image gaussian;
+        CpuBlur::Separable( impulse, gaussian, BlurKernel::Gaussian( sigma ) );
+
+        // The box kernel integrates to one, has the Gaussian's variance (up
+        // to the odd box widths), and its shape, a quadratic spline, stays
+        // close to the Gaussian's.
+        double boxTotal = 0.0;
+        double boxVariance = 0.0;
+        double maxError = 0.0;
+        const double peak = gaussian.at( center, center ).x;
+        for ( unsigned int y = 0; y < size; ++y ) {
+            for ( unsigned int x = 0; x < size; ++x ) {
+                const double value = box.at( x, y ).x;
+                const double dx = static_cast<double>( x ) - center;
+                boxTotal += value;
+                boxVariance += dx * dx * value;
+                maxError = std::max( maxError, std::fabs( value - gaussian.at( x, y ).x ) );
+            }
+        }
+
+        CHECK_NEAR( boxTotal, 1.0, 1e-3 );
+        CHECK_NEAR( std::sqrt( boxVariance ), sigma, 0.1 * sigma );
+        CHECK( maxError <= 0.15 * peak );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+BENCHMARK( CpuBlur_BoxAgainstSeparable )
+{
+    const CpuBlur::Image src = RandomImage( 1024, 1024, 0.f, 4 );
+
+    for ( const int radius : { 4, 16, 64 } ) {
+        CpuBlur::Image dst;
+        const double boxMs = Test::TimeMs( [&]() {
+            CpuBlur::Box( src, dst, radius );
+        } );
+
+        const std::vector<float> weights( 2 * radius + 1, 1.f / ( 2 * radius + 1 ) );
+        const double separableMs = Test::TimeMs( [&]() {
+            CpuBlur::Separable( src, dst, weights );
+        } );
+
+        std::printf( "    radius %3d: box %7.1f ms, separable %7.1f ms\n", radius, boxMs, separableMs );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
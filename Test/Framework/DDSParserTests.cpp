@@ -0,0 +1,308 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file DDSParserTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "DirectXTex/DDSTextureLoader/DDSParser.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    const size_t HeaderSize = sizeof( uint32_t ) + sizeof( DDS_HEADER );
+    const size_t ExtendedHeaderSize = HeaderSize + sizeof( DDS_HEADER_DXT10 );
+
+    // Bytes of all mips of one layer, the way the parser lays them out.
+    size_t LayerBytes( size_t width, size_t height, const size_t mips, const DXGI_FORMAT format )
+    {
+        size_t total = 0;
+        for ( size_t mip = 0; mip < mips; ++mip ) {
+            size_t bytes = 0;
+            DDS::GetSurfaceInfo( width, height, format, &bytes, nullptr, nullptr );
+            total += bytes;
+            width = width > 1 ? width / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+        }
+        return total;
+    }
+
+    // A 2D texture (or array) with a DX10 header. Every pixel byte holds its
+    // offset, so a subresource pointing at the wrong place shows.
+    std::vector<uint8_t> MakeDDS( const uint32_t width, const uint32_t height, const uint32_t mips,
+                                  const uint32_t arraySize = 1,
+                                  const DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM )
+    {
+        const size_t pixelBytes = LayerBytes( width, height, mips, format ) * arraySize;
+        std::vector<uint8_t> file( ExtendedHeaderSize + pixelBytes );
+
+        DDS_HEADER header = {};
+        header.size = sizeof( DDS_HEADER );
+        header.flags = DDS_WIDTH | DDS_HEIGHT;
+        header.width = width;
+        header.height = height;
+        header.mipMapCount = mips;
+        header.ddspf.size = sizeof( DDS_PIXELFORMAT );
+        header.ddspf.flags = DDS_FOURCC;
+        header.ddspf.fourCC = MAKEFOURCC( 'D', 'X', '1', '0' );
+
+        DDS_HEADER_DXT10 extension = {};
+        extension.dxgiFormat = format;
+        extension.resourceDimension = DDS::RESOURCE_DIMENSION_TEXTURE2D;
+        extension.arraySize = arraySize;
+
+        std::memcpy( file.data(), &DDS_MAGIC, sizeof( uint32_t ) );
+        std::memcpy( file.data() + sizeof( uint32_t ), &header, sizeof( header ) );
+        std::memcpy( file.data() + HeaderSize, &extension, sizeof( extension ) );
+        for ( size_t i = ExtendedHeaderSize; i < file.size(); ++i ) {
+            file[i] = static_cast<uint8_t>( i );
+        }
+        return file;
+    }
+
+    // Parses and enumerates a copy of bytes in a buffer of exactly that size,
+    // so the address sanitizer or a guard page catches any read past the end.
+    // A file that makes it through must describe only bytes inside it.
+    DDS::Result ParseCopy( const std::vector<uint8_t>& bytes, const size_t size, bool& inBounds )
+    {
+        std::unique_ptr<uint8_t[]> copy( new uint8_t[size ? size : 1] );
+        std::memcpy( copy.get(), bytes.data(), size );
+
+        inBounds = true;
+
+        DDS::TextureInfo info;
+        DDS::Result result = DDS::ParseHeader( copy.get(), size, info );
+        if ( result != DDS::Result::Ok ) {
+            return result;
+        }
+
+        std::vector<DDS::Subresource> subresources;
+        result = DDS::EnumerateSubresources( info, 0, subresources );
+        if ( result != DDS::Result::Ok ) {
+            return result;
+        }
+
+        const uint8_t* end = copy.get() + size;
+        for ( const DDS::Subresource& sub : subresources ) {
+            const uint64_t bytes = uint64_t( sub.slicePitch ) * sub.depth;
+            inBounds = inBounds && sub.data >= info.bitData && sub.data <= end &&
+                       bytes <= uint64_t( end - sub.data );
+        }
+        return result;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( DDSParser_EnumeratesMipsInFileOrder )
+{
+    const std::vector<uint8_t> file = MakeDDS( 64, 16, 7, 2 );
+
+    DDS::TextureInfo info;
+    CHECK( DDS::ParseHeader( file.data(), file.size(), info ) == DDS::Result::Ok );
+    CHECK( info.resDim == DDS::RESOURCE_DIMENSION_TEXTURE2D );
+    CHECK( info.width == 64 && info.height == 16 && info.depth == 1 );
+    CHECK( info.mipCount == 7 && info.arraySize == 2 && !info.isCubeMap );
+    CHECK( info.format == DXGI_FORMAT_R8G8B8A8_UNORM );
+    CHECK( info.bitData == file.data() + ExtendedHeaderSize );
+    CHECK( info.bitSize == file.size() - ExtendedHeaderSize );
+
+    std::vector<DDS::Subresource> subresources;
+    CHECK( DDS::EnumerateSubresources( info, 0, subresources ) == DDS::Result::Ok );
+    CHECK( subresources.size() == 14 );
+
+    // Back to back, mips of layer 0 and then of layer 1, halving down to 1.
+    bool packed = true;
+    const uint8_t* expected = info.bitData;
+    for ( size_t i = 0; i < subresources.size(); ++i ) {
+        const DDS::Subresource& sub = subresources[i];
+        const size_t mip = i % 7;
+        const size_t width = 64 >> mip;
+        const size_t height = mip < 4 ? 16 >> mip : 1;
+        packed = packed && sub.data == expected && sub.width == width && sub.height == height &&
+                 sub.depth == 1 && sub.rowPitch == width * 4 && sub.slicePitch == width * 4 * height;
+        expected += sub.slicePitch;
+    }
+    CHECK( packed );
+    CHECK( expected == file.data() + file.size() );
+
+    // Mips over the size limit are left out and counted once per layer.
+    size_t skipMip = 0;
+    CHECK( DDS::EnumerateSubresources( info, 16, subresources, &skipMip ) == DDS::Result::Ok );
+    CHECK( skipMip == 2 );
+    CHECK( subresources.size() == 10 );
+    CHECK( subresources[0].width == 16 && subresources[5].width == 16 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( DDSParser_RejectsBadMetadata )
+{
+    DDS::TextureInfo info;
+
+    std::vector<uint8_t> file = MakeDDS( 8, 8, 1 );
+    DDS_HEADER* header = reinterpret_cast<DDS_HEADER*>( file.data() + sizeof( uint32_t ) );
+    DDS_HEADER_DXT10* extension = reinterpret_cast<DDS_HEADER_DXT10*>( file.data() + HeaderSize );
+
+    CHECK( DDS::ParseHeader( nullptr, file.size(), info ) == DDS::Result::Fail );
+
+    file[0] = 'X';
+    CHECK( DDS::ParseHeader( file.data(), file.size(), info ) == DDS::Result::Fail );
+    file[0] = 'D';
+
+    header->size = 0;
+    CHECK( DDS::ParseHeader( file.data(), file.size(), info ) == DDS::Result::Fail );
+    header->size = sizeof( DDS_HEADER );
+
+    header->width = 0;
+    CHECK( DDS::ParseHeader( file.data(), file.size(), info ) == DDS::Result::InvalidData );
+    header->width = 8;
+
+    extension->arraySize = 0;
+    CHECK( DDS::ParseHeader( file.data(), file.size(), info ) == DDS::Result::InvalidData );
+    extension->arraySize = 1;
+
+    // Beyond what Direct3D 11 can create.
+    header->mipMapCount = 16;
+    CHECK( DDS::ParseHeader( file.data(), file.size(), info ) == DDS::Result::NotSupported );
+    header->mipMapCount = 1;
+
+    header->width = 16385;
+    CHECK( DDS::ParseHeader( file.data(), file.size(), info ) == DDS::Result::NotSupported );
+    header->width = 8;
+
+    extension->arraySize = 2049;
+    CHECK( DDS::ParseHeader( file.data(), file.size(), info ) == DDS::Result::NotSupported );
+    extension->arraySize = 1;
+
+    extension->dxgiFormat = DXGI_FORMAT_P8;
+    CHECK( DDS::ParseHeader( file.data(), file.size(), info ) == DDS::Result::NotSupported );
+    extension->dxgiFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+    extension->resourceDimension = 7;
+    CHECK( DDS::ParseHeader( file.data(), file.size(), info ) == DDS::Result::NotSupported );
+    extension->resourceDimension = DDS::RESOURCE_DIMENSION_TEXTURE2D;
+
+    CHECK( DDS::ParseHeader( file.data(), file.size(), info ) == DDS::Result::Ok );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( DDSParser_TruncatedFilesFailCleanly )
+{
+    // Uncompressed and block-compressed, so partial blocks get cut too.
+    const std::vector<uint8_t> files[] = {
+        MakeDDS( 32, 8, 6, 3 ),
+        MakeDDS( 20, 12, 5, 2, DXGI_FORMAT_BC1_UNORM )
+    };
+
+    for ( const std::vector<uint8_t>& file : files ) {
+        bool inBounds = true;
+        CHECK( ParseCopy( file, file.size(), inBounds ) == DDS::Result::Ok );
+        CHECK( inBounds );
+
+        // Too short for the headers is not a DDS file; anything longer is
+        // missing pixel data.
+        bool rejected = true;
+        for ( size_t size = 0; size < file.size(); ++size ) {
+            const DDS::Result result = ParseCopy( file, size, inBounds );
+            rejected = rejected && result == ( size < ExtendedHeaderSize ? DDS::Result::Fail
+                                                                          : DDS::Result::EndOfFile );
+        }
+        CHECK( rejected );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( DDSParser_CorruptHeadersStayInBounds )
+{
+    const std::vector<uint8_t> file = MakeDDS( 32, 32, 6, 2 );
+
+    // Every single bit of the headers flipped: whatever the parser makes of
+    // it, an accepted file never describes bytes outside the buffer.
+    size_t accepted = 0;
+    bool inBounds = true;
+    for ( size_t bit = 0; bit < ExtendedHeaderSize * 8; ++bit ) {
+        std::vector<uint8_t> corrupt = file;
+        corrupt[bit / 8] ^= static_cast<uint8_t>( 1u << ( bit % 8 ) );
+
+        bool ok = true;
+        accepted += ParseCopy( corrupt, corrupt.size(), ok ) == DDS::Result::Ok ? 1 : 0;
+        inBounds = inBounds && ok;
+    }
+    CHECK( inBounds );
+    CHECK( accepted > 0 );
+
+    // Random words in the sizes, counts and format, in the legacy header
+    // layout as well, and cut at a random length.
+    std::mt19937 rng( 37 );
+    std::uniform_int_distribution<uint32_t> word;
+    // Word indices into the file: header flags, height, width, depth, mip
+    // count, pixel format flags, fourCC and bit count, caps2, and the DX10
+    // format, dimension, misc flags and array size.
+    const size_t fields[] = { 2, 3, 4, 6, 7, 20, 21, 22, 28, 32, 33, 34, 35 };
+
+    for ( int i = 0; i < 20000; ++i ) {
+        std::vector<uint8_t> corrupt = file;
+        uint32_t* words = reinterpret_cast<uint32_t*>( corrupt.data() );
+        for ( int j = 0; j < 3; ++j ) {
+            const size_t field = fields[word( rng ) % ( sizeof( fields ) / sizeof( fields[0] ) )];
+            const uint32_t value = word( rng );
+            // Small values reach the interesting branches far more often.
+            words[field] = ( value & 1 ) ? value : value % 64;
+        }
+        if ( i % 4 == 0 ) {
+            // A legacy RGBA header instead of the DX10 one.
+            words[20] = DDS_RGB;
+            words[22] = 32;
+            words[23] = 0x000000ff;
+            words[24] = 0x0000ff00;
+            words[25] = 0x00ff0000;
+            words[26] = 0xff000000;
+        }
+
+        const size_t size = ( i % 3 == 0 ) ? word( rng ) % ( corrupt.size() + 1 ) : corrupt.size();
+
+        bool ok = true;
+        ParseCopy( corrupt, size, ok );
+        inBounds = inBounds && ok;
+    }
+    CHECK( inBounds );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+BENCHMARK( DDSParser_ParseAndEnumerate )
+{
+    // A 512 layer array of 256x256 BC1 layers with full mips: the subresource
+    // table is what a large texture array load spends its parsing time on.
+    const std::vector<uint8_t> file = MakeDDS( 256, 256, 9, 512, DXGI_FORMAT_BC1_UNORM );
+    const int iterations = 200;
+
+    size_t count = 0;
+    std::vector<DDS::Subresource> subresources;
+    const double ms = Test::TimeMs( [&]() {
+        for ( int i = 0; i < iterations; ++i ) {
+            DDS::TextureInfo info;
+            DDS::ParseHeader( file.data(), file.size(), info );
+            DDS::EnumerateSubresources( info, 0, subresources );
+            count += subresources.size();
+        }
+    } );
+
+    CHECK( count == size_t( iterations ) * 9 * 512 );
+    std::printf( "    %zu subresources: %.3f ms per parse, %.1f ns per subresource\n",
+                 subresources.size(), ms / iterations, ms * 1e6 / count );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
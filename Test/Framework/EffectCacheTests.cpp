@@ -0,0 +1,308 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file EffectCacheTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EffectCache.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // Scratch files under the working directory, removed again when done.
+    class ScratchDirectory {
+    public:
+
+        ScratchDirectory( void )
+        : mCache( L"EffectCacheTests" )
+        {
+            // Store() creates the directory.
+            const char marker = 0;
+            mCache.Store( 0, &marker, 1 );
+            mFiles.push_back( mCache.GetPath( 0 ) );
+        }
+
+        ~ScratchDirectory( void )
+        {
+            for ( const std::wstring& file : mFiles ) {
+                std::remove( std::string( file.begin(), file.end() ).c_str() );
+            }
+            std::remove( "EffectCacheTests" );
+        }
+
+        const EffectCache& GetCache( void ) const
+        {
+            return mCache;
+        }
+
+        std::wstring Write( const std::wstring& name, const std::string& text )
+        {
+            const std::wstring path = L"EffectCacheTests/" + name;
+            EffectCache::WriteFile( path, text.data(), text.size() );
+            mFiles.push_back( path );
+            return path;
+        }
+
+        void Track( const std::wstring& path )
+        {
+            mFiles.push_back( path );
+        }
+
+    private:
+
+        EffectCache mCache;
+        std::vector<std::wstring> mFiles;
+    };
+
+    EffectHandleTable MakeTable( void )
+    {
+        EffectHandleTable table;
+        table.Reset( 0x0123456789abcdefULL );
+        table.Add( EffectHandleTable::Technique, "Light1", 0 );
+        table.Add( EffectHandleTable::Technique, "Light3TexInstanced", 6 );
+        table.Add( EffectHandleTable::Variable, "gWorld", 2 );
+        table.Add( EffectHandleTable::Variable, "gDiffuseMap", 11 );
+        table.Add( EffectHandleTable::Variable, "", 12 );
+        return table;
+    }
+
+    bool IsEmpty( const EffectHandleTable& table )
+    {
+        size_t entries = 0;
+        auto count = [&entries]( const std::string&, uint32_t ) { ++entries; };
+        table.ForEach( EffectHandleTable::Technique, count );
+        table.ForEach( EffectHandleTable::Variable, count );
+        return entries == 0;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( EffectHandleTable_SerializeRoundTrip )
+{
+    EffectHandleTable table = MakeTable();
+    CHECK( table.IsDirty() );
+
+    std::vector<char> data;
+    table.Serialize( data );
+    CHECK( table.Save( L"EffectHandleTableTests.handles" ) );
+    CHECK( !table.IsDirty() );
+
+    // Adding what is there already is not a change.
+    table.Add( EffectHandleTable::Variable, "gWorld", 2 );
+    CHECK( !table.IsDirty() );
+    table.Add( EffectHandleTable::Variable, "gWorld", 3 );
+    CHECK( table.IsDirty() );
+    table.Add( EffectHandleTable::Variable, "gWorld", 2 );
+
+    EffectHandleTable copy;
+    CHECK( copy.Deserialize( data.data(), data.size() ) );
+    CHECK( copy.GetBinaryHash() == 0x0123456789abcdefULL );
+    CHECK( !copy.IsDirty() );
+
+    uint32_t index = 0;
+    CHECK( copy.Find( EffectHandleTable::Technique, "Light1", index ) && index == 0 );
+    CHECK( copy.Find( EffectHandleTable::Technique, "Light3TexInstanced", index ) && index == 6 );
+    CHECK( copy.Find( EffectHandleTable::Variable, "gWorld", index ) && index == 2 );
+    CHECK( copy.Find( EffectHandleTable::Variable, "gDiffuseMap", index ) && index == 11 );
+    CHECK( copy.Find( EffectHandleTable::Variable, "", index ) && index == 12 );
+
+    // Kinds are kept apart.
+    CHECK( !copy.Find( EffectHandleTable::Variable, "Light1", index ) );
+    CHECK( !copy.Find( EffectHandleTable::Technique, "gWorld", index ) );
+
+    // The same table always serializes to the same bytes, whatever order
+    // its entries were added in.
+    std::vector<char> again;
+    copy.Serialize( again );
+    CHECK( again == data );
+
+    // A saved table is only trusted for the binary it was saved with.
+    EffectHandleTable loaded;
+    CHECK( loaded.Load( L"EffectHandleTableTests.handles", 0x0123456789abcdefULL ) );
+    CHECK( loaded.Find( EffectHandleTable::Variable, "gDiffuseMap", index ) && index == 11 );
+
+    CHECK( !loaded.Load( L"EffectHandleTableTests.handles", 42 ) );
+    CHECK( loaded.GetBinaryHash() == 42 && IsEmpty( loaded ) );
+
+    CHECK( !loaded.Load( L"EffectHandleTableTests.missing", 43 ) );
+    CHECK( loaded.GetBinaryHash() == 43 && IsEmpty( loaded ) );
+
+    std::remove( "EffectHandleTableTests.handles" );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( EffectHandleTable_RejectsCorruptData )
+{
+    std::vector<char> data;
+    MakeTable().Serialize( data );
+
+    // Every truncation fails and leaves the table empty. Each is read from a
+    // buffer of exactly its size, so a read past the end shows under the
+    // address sanitizer.
+    bool rejected = true;
+    for ( size_t size = 0; size < data.size(); ++size ) {
+        std::vector<char> cut( data.begin(), data.begin() + size );
+        EffectHandleTable table = MakeTable();
+        rejected = rejected && !table.Deserialize( cut.data(), cut.size() ) &&
+                   table.GetBinaryHash() == 0 && IsEmpty( table ) && !table.IsDirty();
+    }
+    CHECK( rejected );
+
+    EffectHandleTable table;
+
+    std::vector<char> corrupt = data;
+    corrupt[0] ^= 1;
+    CHECK( !table.Deserialize( corrupt.data(), corrupt.size() ) );
+
+    corrupt = data;
+    corrupt[4] ^= 1;
+    CHECK( !table.Deserialize( corrupt.data(), corrupt.size() ) );
+
+    // A technique count, then a name length, far beyond the data.
+    const size_t firstCount = 16;
+    corrupt = data;
+    const uint32_t huge = 0xffffffffu;
+    std::memcpy( &corrupt[firstCount], &huge, sizeof( huge ) );
+    CHECK( !table.Deserialize( corrupt.data(), corrupt.size() ) );
+    CHECK( IsEmpty( table ) );
+
+    corrupt = data;
+    std::memcpy( &corrupt[firstCount + 8], &huge, sizeof( huge ) );
+    CHECK( !table.Deserialize( corrupt.data(), corrupt.size() ) );
+    CHECK( IsEmpty( table ) );
+
+    // Any single bit flipped: rejected, or read without running off the end.
+    bool bounded = true;
+    for ( size_t bit = 0; bit < data.size() * 8; ++bit ) {
+        corrupt = data;
+        corrupt[bit / 8] ^= static_cast<char>( 1 << ( bit % 8 ) );
+        if ( !table.Deserialize( corrupt.data(), corrupt.size() ) ) {
+            bounded = bounded && IsEmpty( table );
+        }
+    }
+    CHECK( bounded );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( EffectCache_KeysFollowSourceAndIncludes )
+{
+    // FNV-1a reference values, and chaining.
+    CHECK( EffectCache::Hash( "", 0 ) == EffectCache::HashSeed );
+    CHECK( EffectCache::Hash( "a", 1 ) == 0xaf63dc4c8601ec8cULL );
+    CHECK( EffectCache::Hash( "foobar", 6 ) == 0x85944171f73967e8ULL );
+    CHECK( EffectCache::Hash( "bar", 3, EffectCache::Hash( "foo", 3 ) ) == EffectCache::Hash( "foobar", 6 ) );
+
+    ScratchDirectory scratch;
+    const std::wstring main = scratch.Write( L"Basic.fx", "#include \"Light.fxh\"\n  #  include \"Common.fxh\"\n#include <system.fxh>\nfloat4 main;\n" );
+    const std::wstring light = scratch.Write( L"Light.fxh", "#include \"Common.fxh\"\nfloat3 light;\n" );
+    const std::wstring common = scratch.Write( L"Common.fxh", "// Includes its includer: a cycle.\n#include \"Light.fxh\"\nfloat common;\n" );
+
+    uint64_t key = 0;
+    std::vector<std::wstring> dependencies;
+    CHECK( EffectCache::SourceKey( main, 1, key, &dependencies ) );
+
+    // Every quoted include once, system headers left out, cycles cut.
+    CHECK( dependencies.size() == 3 );
+    CHECK( std::count( dependencies.begin(), dependencies.end(), main ) == 1 );
+    CHECK( std::count( dependencies.begin(), dependencies.end(), light ) == 1 );
+    CHECK( std::count( dependencies.begin(), dependencies.end(), common ) == 1 );
+
+    uint64_t same = 0;
+    CHECK( EffectCache::SourceKey( main, 1, same ) && same == key );
+
+    // Compile flags are part of the key.
+    uint64_t salted = 0;
+    CHECK( EffectCache::SourceKey( main, 2, salted ) && salted != key );
+
+    // An edit to an include two levels down changes the key, and undoing it
+    // gives the old key back, so the old binary is found again.
+    scratch.Write( L"Common.fxh", "// Includes its includer: a cycle.\n#include \"Light.fxh\"\nfloat common2;\n" );
+    uint64_t edited = 0;
+    CHECK( EffectCache::SourceKey( main, 1, edited ) && edited != key );
+
+    scratch.Write( L"Common.fxh", "// Includes its includer: a cycle.\n#include \"Light.fxh\"\nfloat common;\n" );
+    CHECK( EffectCache::SourceKey( main, 1, same ) && same == key );
+
+    // A missing include makes the source unkeyable.
+    const std::wstring broken = scratch.Write( L"Broken.fx", "#include \"Missing.fxh\"\n" );
+    CHECK( !EffectCache::SourceKey( broken, 1, same ) );
+
+    // Binaries are stored under their key.
+    const EffectCache& cache = scratch.GetCache();
+    const std::wstring path = cache.GetPath( key );
+    CHECK( path.size() == std::wstring( L"EffectCacheTests/" ).size() + 16 + 4 );
+    CHECK( path.compare( path.size() - 4, 4, L".fxo" ) == 0 );
+    CHECK( cache.GetPath( edited ) != path );
+
+    const char binary[] = "compiled";
+    std::vector<char> loaded;
+    CHECK( !cache.Load( key, loaded ) );
+    CHECK( cache.Store( key, binary, sizeof( binary ) ) );
+    scratch.Track( path );
+    CHECK( cache.Load( key, loaded ) );
+    CHECK( loaded.size() == sizeof( binary ) && std::memcmp( loaded.data(), binary, sizeof( binary ) ) == 0 );
+    CHECK( !cache.Load( edited, loaded ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( Lazy_FactoryRunsOnceUnderConcurrentGet )
+{
+    std::atomic<int> created( 0 );
+
+    Lazy<int> lazy;
+    lazy.SetFactory( [&created]() {
+        // Slow enough that the other threads pile up behind it.
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+        return new int( ++created );
+    } );
+    CHECK( !lazy.IsLoaded() );
+
+    const int threadCount = 8;
+    std::atomic<int> ready( 0 );
+    std::vector<int*> seen( threadCount, nullptr );
+    std::vector<std::thread> threads;
+    for ( int i = 0; i < threadCount; ++i ) {
+        threads.emplace_back( [&, i]() {
+            ++ready;
+            while ( ready.load() < threadCount ) {
+                std::this_thread::yield();
+            }
+            seen[i] = lazy.Get();
+        } );
+    }
+    for ( std::thread& thread : threads ) {
+        thread.join();
+    }
+
+    CHECK( created.load() == 1 );
+    CHECK( lazy.IsLoaded() );
+    CHECK( seen[0] != nullptr && *seen[0] == 1 );
+    CHECK( std::count( seen.begin(), seen.end(), seen[0] ) == threadCount );
+
+    // Reset() destroys it; the next Get() runs the factory again.
+    lazy.Reset();
+    CHECK( !lazy.IsLoaded() );
+    CHECK( *lazy.Get() == 2 );
+    CHECK( *lazy.Get() == 2 && created.load() == 2 );
+
+    // Without a factory there is nothing to get.
+    Lazy<int> empty;
+    CHECK( empty.Get() == nullptr && !empty.IsLoaded() );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,219 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file FrameGraphTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <string>
+#include <vector>
+
+#include "FrameGraph.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // Values of DXGI_FORMAT and D3D11_BIND_FLAG, so the tests do not need
+    // the Windows headers.
+    const unsigned int FormatRGBA8 = 28;
+    const unsigned int FormatR16F = 54;
+    const unsigned int BindTarget = 0x20 | 0x8; // render target | shader resource
+
+    const FrameGraph::TextureDesc FullRGBA8( 1280, 720, FormatRGBA8, BindTarget );
+    const FrameGraph::TextureDesc HalfR16F( 640, 360, FormatR16F, BindTarget );
+
+    // Adds a pass that appends its name to log when it runs.
+    FrameGraph::PassHandle AddLoggedPass( FrameGraph& graph,
+                                          std::vector<std::string>& log,
+                                          const std::string& name,
+                                          const std::vector<FrameGraph::ResourceHandle>& reads,
+                                          const std::vector<FrameGraph::ResourceHandle>& writes )
+    {
+        return graph.AddPass( name, reads, writes, [&log, name]() {
+            log.push_back( name );
+        } );
+    }
+
+    bool LifetimesOverlap( const FrameGraph& graph, FrameGraph::ResourceHandle a, FrameGraph::ResourceHandle b )
+    {
+        return graph.GetFirstUse( a ) <= graph.GetLastUse( b ) && graph.GetFirstUse( b ) <= graph.GetLastUse( a );
+    }
+
+    // No two transients sharing a physical slot may be live at once, and
+    // each slot has its transients' description.
+    bool AliasingIsSafe( const FrameGraph& graph )
+    {
+        const FrameGraph::ResourceHandle count = static_cast<FrameGraph::ResourceHandle>( graph.GetResourceCount() );
+        for ( FrameGraph::ResourceHandle a = 0; a < count; ++a ) {
+            const int slot = graph.GetPhysicalIndex( a );
+            if ( slot == FrameGraph::Invalid ) {
+                continue;
+            }
+            if ( graph.GetPhysicalDesc( slot ) != graph.GetDesc( a ) ) {
+                return false;
+            }
+            for ( FrameGraph::ResourceHandle b = a + 1; b < count; ++b ) {
+                if ( graph.GetPhysicalIndex( b ) == slot && LifetimesOverlap( graph, a, b ) ) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FrameGraph_CullsPassesThatReachNoOutput )
+{
+    FrameGraph graph;
+    std::vector<std::string> log;
+
+    const FrameGraph::ResourceHandle scene = graph.CreateTexture( "Scene", FullRGBA8 );
+    const FrameGraph::ResourceHandle unused = graph.CreateTexture( "Unused", FullRGBA8 );
+    const FrameGraph::ResourceHandle debug = graph.CreateTexture( "Debug", FullRGBA8 );
+    const FrameGraph::ResourceHandle backBuffer = graph.ImportTexture( "BackBuffer" );
+    const FrameGraph::ResourceHandle gpuTimer = graph.ImportTexture( "GpuTimer" );
+
+    const FrameGraph::PassHandle scenePass = AddLoggedPass( graph, log, "Scene", { }, { scene } );
+    const FrameGraph::PassHandle unusedPass = AddLoggedPass( graph, log, "Unused", { scene }, { unused } );
+    const FrameGraph::PassHandle debugPass = AddLoggedPass( graph, log, "Debug", { scene }, { debug } );
+    const FrameGraph::PassHandle compositePass = AddLoggedPass( graph, log, "Composite", { scene }, { backBuffer } );
+    const FrameGraph::PassHandle readbackPass = AddLoggedPass( graph, log, "Readback", { debug }, { } );
+    const FrameGraph::PassHandle timerPass = AddLoggedPass( graph, log, "Timer", { }, { gpuTimer } );
+    graph.SetSideEffect( readbackPass );
+    graph.Compile();
+
+    CHECK( !graph.IsCulled( scenePass ) );
+    CHECK( graph.IsCulled( unusedPass ) );
+    CHECK( !graph.IsCulled( debugPass ) );
+    CHECK( !graph.IsCulled( compositePass ) );
+    CHECK( !graph.IsCulled( readbackPass ) );
+    CHECK( !graph.IsCulled( timerPass ) );
+
+    CHECK( graph.GetFirstUse( unused ) == FrameGraph::Invalid );
+    CHECK( graph.GetPhysicalIndex( unused ) == FrameGraph::Invalid );
+    CHECK( graph.GetPhysicalIndex( backBuffer ) == FrameGraph::Invalid );
+
+    graph.Execute();
+    const std::vector<std::string> expected = { "Scene", "Debug", "Composite", "Readback", "Timer" };
+    CHECK( log == expected );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FrameGraph_CullsWholeUnusedChains )
+{
+    FrameGraph graph;
+    std::vector<std::string> log;
+
+    const FrameGraph::ResourceHandle a = graph.CreateTexture( "A", FullRGBA8 );
+    const FrameGraph::ResourceHandle b = graph.CreateTexture( "B", FullRGBA8 );
+    const FrameGraph::ResourceHandle backBuffer = graph.ImportTexture( "BackBuffer" );
+
+    const FrameGraph::PassHandle first = AddLoggedPass( graph, log, "First", { }, { a } );
+    const FrameGraph::PassHandle inPlace = AddLoggedPass( graph, log, "InPlace", { a }, { a } );
+    const FrameGraph::PassHandle second = AddLoggedPass( graph, log, "Second", { a }, { b } );
+    const FrameGraph::PassHandle clear = AddLoggedPass( graph, log, "Clear", { }, { backBuffer } );
+    graph.Compile();
+
+    // Nothing reads B, so Second goes, then A, so everything writing it.
+    CHECK( graph.IsCulled( first ) );
+    CHECK( graph.IsCulled( inPlace ) );
+    CHECK( graph.IsCulled( second ) );
+    CHECK( !graph.IsCulled( clear ) );
+    CHECK( graph.GetPhysicalCount() == 0 );
+
+    graph.Execute();
+    CHECK( log.size() == 1 && log[0] == "Clear" );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FrameGraph_PostStackAliasesDeadTargets )
+{
+    // Scene -> Bloom -> Tonemap -> Fxaa -> back buffer, each pass reading
+    // the previous target: only two full-size targets are ever live.
+    FrameGraph graph;
+    std::vector<std::string> log;
+
+    const FrameGraph::ResourceHandle scene = graph.CreateTexture( "Scene", FullRGBA8 );
+    const FrameGraph::ResourceHandle bloom = graph.CreateTexture( "Bloom", FullRGBA8 );
+    const FrameGraph::ResourceHandle tonemapped = graph.CreateTexture( "Tonemapped", FullRGBA8 );
+    const FrameGraph::ResourceHandle fxaa = graph.CreateTexture( "Fxaa", FullRGBA8 );
+    const FrameGraph::ResourceHandle backBuffer = graph.ImportTexture( "BackBuffer" );
+
+    AddLoggedPass( graph, log, "Scene", { }, { scene } );
+    AddLoggedPass( graph, log, "Bloom", { scene }, { bloom } );
+    AddLoggedPass( graph, log, "Tonemap", { bloom }, { tonemapped } );
+    AddLoggedPass( graph, log, "Fxaa", { tonemapped }, { fxaa } );
+    AddLoggedPass( graph, log, "Composite", { fxaa }, { backBuffer } );
+    graph.Compile();
+
+    CHECK( graph.GetPhysicalCount() == 2 );
+    CHECK( AliasingIsSafe( graph ) );
+    CHECK( graph.GetPhysicalIndex( scene ) == graph.GetPhysicalIndex( tonemapped ) );
+    CHECK( graph.GetPhysicalIndex( bloom ) == graph.GetPhysicalIndex( fxaa ) );
+
+    CHECK( graph.GetFirstUse( scene ) == 0 && graph.GetLastUse( scene ) == 1 );
+    CHECK( graph.GetFirstUse( fxaa ) == 3 && graph.GetLastUse( fxaa ) == 4 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FrameGraph_DifferentDescriptionsNeverAlias )
+{
+    // The SSAO demo's graph: the half-size R16 ambient maps may not share
+    // memory with the full-size normal/depth map, and the blur's ping-pong
+    // target lives alongside the ambient map it blurs.
+    FrameGraph graph;
+    std::vector<std::string> log;
+
+    const FrameGraph::ResourceHandle normalDepth = graph.CreateTexture( "NormalDepth", FullRGBA8 );
+    const FrameGraph::ResourceHandle ambient = graph.CreateTexture( "Ambient", HalfR16F );
+    const FrameGraph::ResourceHandle ambientTemp = graph.CreateTexture( "AmbientTemp", HalfR16F );
+    const FrameGraph::ResourceHandle shadowMap = graph.ImportTexture( "ShadowMap" );
+    const FrameGraph::ResourceHandle backBuffer = graph.ImportTexture( "BackBuffer" );
+
+    AddLoggedPass( graph, log, "ShadowMap", { }, { shadowMap } );
+    AddLoggedPass( graph, log, "NormalDepth", { }, { normalDepth } );
+    AddLoggedPass( graph, log, "Ssao", { normalDepth }, { ambient } );
+    AddLoggedPass( graph, log, "SsaoBlur", { ambient, normalDepth }, { ambient, ambientTemp } );
+    AddLoggedPass( graph, log, "Scene", { ambient, shadowMap }, { backBuffer } );
+    graph.Compile();
+
+    CHECK( graph.GetExecutionOrder().size() == 5 );
+    CHECK( graph.GetPhysicalCount() == 3 );
+    CHECK( AliasingIsSafe( graph ) );
+    CHECK( graph.GetPhysicalIndex( ambient ) != graph.GetPhysicalIndex( ambientTemp ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FrameGraph_ResetDeclaresAgain )
+{
+    FrameGraph graph;
+    std::vector<std::string> log;
+
+    const FrameGraph::ResourceHandle target = graph.CreateTexture( "Target", FullRGBA8 );
+    AddLoggedPass( graph, log, "Draw", { }, { target } );
+    AddLoggedPass( graph, log, "Present", { target }, { graph.ImportTexture( "BackBuffer" ) } );
+    graph.Compile();
+    CHECK( graph.GetPhysicalCount() == 1 );
+
+    // As on a resize: the same graph at a new size.
+    graph.Reset();
+    CHECK( graph.GetPassCount() == 0 && graph.GetResourceCount() == 0 );
+
+    const FrameGraph::TextureDesc resized( 1920, 1080, FormatRGBA8, BindTarget );
+    const FrameGraph::ResourceHandle again = graph.CreateTexture( "Target", resized );
+    AddLoggedPass( graph, log, "Draw", { }, { again } );
+    AddLoggedPass( graph, log, "Present", { again }, { graph.ImportTexture( "BackBuffer" ) } );
+    graph.Compile();
+
+    CHECK( graph.GetPhysicalCount() == 1 );
+    CHECK( graph.GetPhysicalDesc( 0 ) == resized );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
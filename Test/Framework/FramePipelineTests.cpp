@@ -0,0 +1,208 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file FramePipelineTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "FramePipeline.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // A packet big enough that a torn or overwritten one shows: every word
+    // is derived from the sequence number.
+    struct Packet {
+        uint64_t sequence;
+        uint64_t words[64];
+    };
+
+    void Fill( Packet& packet, const uint64_t sequence )
+    {
+        packet.sequence = sequence;
+        for ( uint64_t i = 0; i < 64; ++i ) {
+            packet.words[i] = sequence * 0x9e3779b97f4a7c15ULL + i;
+        }
+    }
+
+    bool IsWhole( const Packet& packet )
+    {
+        for ( uint64_t i = 0; i < 64; ++i ) {
+            if ( packet.words[i] != packet.sequence * 0x9e3779b97f4a7c15ULL + i ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool SlotsAreDistinct( const FramePipeline& pipeline )
+    {
+        return pipeline.getWriteSlot() != pipeline.getReadSlot() &&
+               pipeline.getWriteSlot() < FramePipeline::SlotCount &&
+               pipeline.getReadSlot() < FramePipeline::SlotCount;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FramePipeline_FreshPacketIsAcquiredOnce )
+{
+    FramePipeline pipeline;
+
+    // Nothing published yet.
+    CHECK( !pipeline.isPending() );
+    CHECK( !pipeline.acquire() );
+    CHECK( pipeline.getReadSequence() == 0 );
+    CHECK( SlotsAreDistinct( pipeline ) );
+
+    const unsigned int first = pipeline.getWriteSlot();
+    const unsigned int next = pipeline.publish();
+    CHECK( next != first );
+    CHECK( pipeline.isPending() );
+    CHECK( pipeline.waitForConsumer( 0 ) == false );
+
+    CHECK( pipeline.acquire() );
+    CHECK( pipeline.getReadSlot() == first );
+    CHECK( pipeline.getReadSequence() == 1 );
+    CHECK( !pipeline.isPending() );
+    CHECK( pipeline.waitForConsumer( 0 ) );
+
+    // Acquiring again without a publish keeps the packet being read.
+    CHECK( !pipeline.acquire() );
+    CHECK( pipeline.getReadSlot() == first );
+    CHECK( pipeline.getReadSequence() == 1 );
+
+    // Two publishes before an acquire: the older packet is dropped and the
+    // consumer gets the newest.
+    pipeline.publish();
+    CHECK( SlotsAreDistinct( pipeline ) );
+    pipeline.publish();
+    CHECK( SlotsAreDistinct( pipeline ) );
+    CHECK( pipeline.acquire() );
+    CHECK( pipeline.getReadSequence() == 3 );
+    CHECK( !pipeline.acquire() );
+
+    // The producer never gets the slot being read back.
+    bool distinct = true;
+    for ( int i = 0; i < 10; ++i ) {
+        pipeline.publish();
+        distinct = distinct && SlotsAreDistinct( pipeline );
+        if ( i % 3 == 0 ) {
+            pipeline.acquire();
+            distinct = distinct && SlotsAreDistinct( pipeline );
+        }
+    }
+    CHECK( distinct );
+
+    pipeline.reset();
+    CHECK( !pipeline.isPending() );
+    CHECK( pipeline.getReadSequence() == 0 );
+    CHECK( pipeline.waitForPacket( 0 ) == false );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FramePipeline_ConsumerSeesWholeNewestPackets )
+{
+    const uint64_t count = 200000;
+
+    FramePipeline pipeline;
+    Packet packets[FramePipeline::SlotCount];
+    Fill( packets[pipeline.getReadSlot()], 0 );
+
+    // Publish count, only ever increased by the producer after a publish.
+    std::atomic<uint64_t> published( 0 );
+
+    std::thread producer( [&]() {
+        for ( uint64_t sequence = 1; sequence <= count; ++sequence ) {
+            Fill( packets[pipeline.getWriteSlot()], sequence );
+            pipeline.publish();
+            published.store( sequence );
+        }
+    } );
+
+    bool whole = true;
+    bool ordered = true;
+    bool newest = true;
+    uint64_t last = 0;
+    uint64_t acquired = 0;
+
+    while ( last < count ) {
+        const uint64_t before = published.load();
+        if ( !pipeline.waitForPacket( 1 ) ) {
+            // Only the consumer takes packets, so one published since the
+            // last acquire must still be there.
+            newest = newest && before <= last;
+            continue;
+        }
+        ++acquired;
+
+        // At least as new as anything published before the acquire.
+        const Packet& packet = packets[pipeline.getReadSlot()];
+        const uint64_t sequence = packet.sequence;
+        newest = newest && sequence >= before;
+        ordered = ordered && sequence > last && sequence == pipeline.getReadSequence();
+
+        // Read it twice, a while apart: the producer must not be writing
+        // into it meanwhile.
+        whole = whole && IsWhole( packet );
+        for ( volatile int spin = 0; spin < 200; ++spin ) {
+        }
+        whole = whole && IsWhole( packet ) && packet.sequence == sequence;
+
+        last = sequence;
+    }
+
+    producer.join();
+
+    CHECK( whole );
+    CHECK( ordered );
+    CHECK( newest );
+    CHECK( last == count );
+    CHECK( acquired > 0 && acquired <= count );
+    CHECK( !pipeline.isPending() );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FramePipeline_LockstepHandsOverEveryPacket )
+{
+    // The way D3DApp runs it: the producer waits for the consumer before
+    // starting the next packet, so none is dropped.
+    const uint64_t count = 20000;
+
+    FramePipeline pipeline;
+    Packet packets[FramePipeline::SlotCount];
+
+    std::thread producer( [&]() {
+        for ( uint64_t sequence = 1; sequence <= count; ++sequence ) {
+            while ( !pipeline.waitForConsumer( 10 ) ) {
+            }
+            Fill( packets[pipeline.getWriteSlot()], sequence );
+            pipeline.publish();
+        }
+    } );
+
+    bool consecutive = true;
+    uint64_t last = 0;
+    while ( last < count ) {
+        if ( !pipeline.waitForPacket( 10 ) ) {
+            continue;
+        }
+        const Packet& packet = packets[pipeline.getReadSlot()];
+        consecutive = consecutive && IsWhole( packet ) && packet.sequence == last + 1;
+        last = packet.sequence;
+    }
+
+    producer.join();
+
+    CHECK( consecutive );
+    CHECK( last == count );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,113 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file FrameRingAllocatorTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "FrameRingAllocator.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FrameRingAllocator_MixedStridesStayAligned )
+{
+    // Neither stride divides the capacity, and each lap of the ring starts
+    // somewhere else in both strides' cycles.
+    FrameRingAllocator ring( 1000 );
+    const size_t strides[] = { 12, 64, 48, 7 };
+
+    bool aligned = true;
+    bool inside = true;
+    size_t allocations = 0;
+    for ( uint64_t frame = 1; frame <= 200; ++frame ) {
+        for ( const size_t stride : strides ) {
+            const size_t count = 1 + ( frame * stride ) % 5;
+            const size_t offset = ring.Allocate( count * stride, stride );
+            if ( offset == FrameRingAllocator::InvalidOffset ) {
+                continue;
+            }
+            ++allocations;
+            aligned = aligned && offset % stride == 0;
+            inside = inside && offset + count * stride <= ring.GetCapacity();
+        }
+        ring.EndFrame( frame );
+        ring.Reclaim( frame );
+    }
+
+    CHECK( aligned );
+    CHECK( inside );
+    CHECK( allocations == 200 * 4 );
+    CHECK( ring.GetPendingFrameCount() == 0 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FrameRingAllocator_KeepsFramesUntilTheirFence )
+{
+    FrameRingAllocator ring( 256 );
+
+    CHECK( ring.Allocate( 100, 4 ) == 0 );
+    ring.EndFrame( 1 );
+    CHECK( ring.Allocate( 100, 4 ) == 100 );
+    ring.EndFrame( 2 );
+
+    // 56 bytes are left at the end and 0 at the start: full until frame 1
+    // is reclaimed, and then the allocation skips the end.
+    CHECK( ring.Allocate( 64, 4 ) == FrameRingAllocator::InvalidOffset );
+    ring.Reclaim( 1 );
+    CHECK( ring.Allocate( 64, 4 ) == 0 );
+    CHECK( ring.Allocate( 64, 4 ) == FrameRingAllocator::InvalidOffset );
+    ring.EndFrame( 3 );
+
+    ring.Reclaim( 3 );
+    CHECK( ring.GetUsed() == 0 );
+    CHECK( ring.Allocate( 0, 0 ) == FrameRingAllocator::InvalidOffset );
+    CHECK( ring.Allocate( 257, 1 ) == FrameRingAllocator::InvalidOffset );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FrameRingAllocator_ConcurrentRangesNeverOverlap )
+{
+    FrameRingAllocator ring( 4093 );
+
+    for ( uint64_t frame = 1; frame <= 100; ++frame ) {
+        std::vector<std::pair<size_t, size_t>> ranges[4];
+        std::vector<std::thread> threads;
+        for ( size_t t = 0; t < 4; ++t ) {
+            threads.emplace_back( [&ring, &ranges, t]() {
+                const size_t stride = 4 + 12 * t;
+                for ( int i = 0; i < 16; ++i ) {
+                    const size_t offset = ring.Allocate( stride * 3, stride );
+                    if ( offset != FrameRingAllocator::InvalidOffset ) {
+                        ranges[t].push_back( std::make_pair( offset, offset + stride * 3 ) );
+                    }
+                }
+            } );
+        }
+        for ( std::thread& thread : threads ) {
+            thread.join();
+        }
+        ring.EndFrame( frame );
+        ring.Reclaim( frame );
+
+        std::vector<std::pair<size_t, size_t>> all;
+        for ( const auto& thread : ranges ) {
+            all.insert( all.end(), thread.begin(), thread.end() );
+        }
+        std::sort( all.begin(), all.end() );
+
+        bool disjoint = true;
+        for ( size_t i = 1; i < all.size(); ++i ) {
+            disjoint = disjoint && all[i - 1].second <= all[i].first;
+        }
+        CHECK( disjoint );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
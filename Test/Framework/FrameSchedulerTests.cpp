@@ -0,0 +1,153 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file FrameSchedulerTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <random>
+
+#include "Clock.h"
+#include "FrameScheduler.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // A power of two, so whole steps add up without rounding.
+    const double Step = 1.0 / 64.0;
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FrameScheduler_StepsForElapsedTime )
+{
+    MockClock clock;
+    FrameScheduler scheduler( clock );
+
+    // Variable timestep: one step of whatever elapsed.
+    CHECK( !scheduler.isFixedStep() );
+    CHECK( scheduler.advance( 0.02 ) == 1 );
+    CHECK( scheduler.getStepTime() == 0.02f );
+    CHECK( scheduler.getAlpha() == 1.f );
+
+    scheduler.setFixedStep( Step );
+    CHECK( scheduler.isFixedStep() );
+
+    CHECK( scheduler.advance( 3.5 * Step ) == 3 );
+    CHECK( scheduler.getStepTime() == static_cast<float>( Step ) );
+    CHECK( scheduler.getAlpha() == 0.5f );
+
+    // The half step left over completes with the next one.
+    CHECK( scheduler.advance( 0.75 * Step ) == 1 );
+    CHECK( scheduler.getAlpha() == 0.25f );
+
+    CHECK( scheduler.advance( 0.5 * Step ) == 0 );
+    CHECK( scheduler.getAlpha() == 0.75f );
+
+    // Negative elapsed time (a clock stepping back) adds nothing.
+    CHECK( scheduler.advance( -1.0 ) == 0 );
+    CHECK( scheduler.getAlpha() == 0.75f );
+
+    CHECK( scheduler.getDroppedTime() == 0.0 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FrameScheduler_ClampsStepsAndCountsDroppedTime )
+{
+    MockClock clock;
+    FrameScheduler scheduler( clock );
+    scheduler.setFixedStep( Step, 4 );
+
+    // A stall ten and a quarter steps long runs four, drops six and keeps
+    // the quarter for interpolation.
+    CHECK( scheduler.advance( 10.25 * Step ) == 4 );
+    CHECK( scheduler.getDroppedTime() == 6.0 * Step );
+    CHECK( scheduler.getAlpha() == 0.25f );
+
+    CHECK( scheduler.advance( 0.0 ) == 0 );
+    CHECK( scheduler.advance( 5.0 * Step ) == 4 );
+    CHECK( scheduler.getDroppedTime() == 7.0 * Step );
+
+    scheduler.reset();
+    CHECK( scheduler.getDroppedTime() == 0.0 );
+    CHECK( scheduler.getAlpha() == 0.f );
+
+    // Over many uneven frames, every second is either simulated, dropped or
+    // still waiting as the remainder, and alpha stays in [0, 1).
+    std::mt19937 rng( 7 );
+    std::uniform_real_distribution<double> frameTime( 0.0, 8.0 * Step );
+
+    double elapsed = 0.0;
+    double simulated = 0.0;
+    bool alphaInRange = true;
+    for ( int frame = 0; frame < 10000; ++frame ) {
+        const double dt = frameTime( rng );
+        elapsed += dt;
+
+        const unsigned int steps = scheduler.advance( dt );
+        CHECK( steps <= 4 );
+        simulated += steps * Step;
+
+        const float alpha = scheduler.getAlpha();
+        alphaInRange = alphaInRange && alpha >= 0.f && alpha < 1.f;
+    }
+    CHECK( alphaInRange );
+    CHECK( scheduler.getDroppedTime() > 0.0 );
+    CHECK_NEAR( simulated + scheduler.getDroppedTime() + scheduler.getAlpha() * Step, elapsed, 1e-6 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( FrameScheduler_FrameCapDeadlinesDoNotDrift )
+{
+    MockClock clock( 1000000 );
+    FrameScheduler scheduler( clock );
+    scheduler.setFrameCap( 100.0 );
+    const int64_t period = 10000;
+
+    // The first frame only sets the schedule.
+    scheduler.waitForNextFrame();
+    CHECK( clock.now() == 0 );
+
+    // Uneven frame times and late wake-ups: each wait still ends on a whole
+    // number of periods from the start, because the next deadline follows
+    // from the last one rather than from when the wait returned.
+    bool onSchedule = true;
+    for ( int64_t frame = 1; frame <= 100; ++frame ) {
+        clock.advance( 3000 + ( frame * 37 ) % 5000 );
+        scheduler.waitForNextFrame();
+        onSchedule = onSchedule && clock.now() == frame * period;
+
+        clock.advance( 250 );
+    }
+    CHECK( onSchedule );
+
+    // Less than a period late: no wait, and the schedule stays where it was.
+    const int64_t start = 100 * period;
+    clock.setTime( start + 15000 );
+    scheduler.waitForNextFrame();
+    CHECK( clock.now() == start + 15000 );
+
+    clock.advance( 1000 );
+    scheduler.waitForNextFrame();
+    CHECK( clock.now() == start + 2 * period );
+
+    // More than a period late: start over from now instead of rushing.
+    clock.setTime( start + 2 * period + 50000 );
+    scheduler.waitForNextFrame();
+    CHECK( clock.now() == start + 2 * period + 50000 );
+
+    scheduler.waitForNextFrame();
+    CHECK( clock.now() == start + 2 * period + 50000 + period );
+
+    // Without a cap nothing waits.
+    scheduler.setFrameCap( 0.0 );
+    const int64_t now = clock.now();
+    scheduler.waitForNextFrame();
+    scheduler.waitForNextFrame();
+    CHECK( clock.now() == now );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
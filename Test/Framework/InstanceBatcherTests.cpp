@@ -0,0 +1,264 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file InstanceBatcherTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "InstanceBatcher.h"
+#include "JobSystem.h"
+#include "MathHelper.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // A scaled, rotated and translated world matrix; every fifth one also
+    // has a projective last column, which takes the scalar path.
+    XMFLOAT4X4 RandomWorld( std::mt19937& rng, const size_t index )
+    {
+        std::uniform_real_distribution<float> scale( 0.25f, 4.f );
+        std::uniform_real_distribution<float> angle( -MathHelper::Pi, MathHelper::Pi );
+        std::uniform_real_distribution<float> offset( -100.f, 100.f );
+
+        XMMATRIX world = XMMatrixScaling( scale( rng ), scale( rng ), scale( rng ) );
+        world = XMMatrixMultiply( world, XMMatrixRotationX( angle( rng ) ) );
+        world = XMMatrixMultiply( world, XMMatrixRotationY( angle( rng ) ) );
+        world = XMMatrixMultiply( world, XMMatrixTranslation( offset( rng ), offset( rng ), offset( rng ) ) );
+
+        XMFLOAT4X4 result;
+        XMStoreFloat4x4( &result, world );
+        if ( index % 5 == 4 ) {
+            result.m[0][3] = 0.125f;
+            result.m[2][3] = -0.25f;
+        }
+        return result;
+    }
+
+    // Within single precision of the one-at-a-time InverseTranspose().
+    bool MatchesScalar( const XMFLOAT4X4& world, const XMFLOAT4X4& result )
+    {
+        XMFLOAT4X4 expected;
+        XMStoreFloat4x4( &expected, MathHelper::InverseTranspose( XMLoadFloat4x4( &world ) ) );
+        for ( int r = 0; r < 4; ++r ) {
+            for ( int c = 0; c < 4; ++c ) {
+                if ( std::fabs( result.m[r][c] - expected.m[r][c] ) > 1e-4f * ( 1.f + std::fabs( expected.m[r][c] ) ) ) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool SameMatrix( const XMFLOAT4X4& a, const XMFLOAT4X4& b )
+    {
+        return std::memcmp( &a, &b, sizeof( XMFLOAT4X4 ) ) == 0;
+    }
+
+    // Adds one object per world, cycling through three mesh/material pairs;
+    // objects are the addresses of their world matrices.
+    void AddObjects( InstanceBatcher& batcher, const std::vector<XMFLOAT4X4>& worlds )
+    {
+        const unsigned int meshes[] = { 7, 3, 7 };
+        const unsigned int materials[] = { 1, 1, 2 };
+        for ( size_t i = 0; i < worlds.size(); ++i ) {
+            batcher.Add( meshes[i % 3], materials[i % 3], worlds[i], &worlds[i] );
+        }
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( InstanceBatcher_GroupsInFirstAddedOrder )
+{
+    std::mt19937 rng( 43 );
+    std::vector<XMFLOAT4X4> worlds;
+    for ( size_t i = 0; i < 6; ++i ) {
+        worlds.push_back( RandomWorld( rng, i ) );
+    }
+
+    // Objects 0 - 5 as (mesh, material): (2,0) (1,0) (2,0) (2,5) (1,0) (2,0).
+    const unsigned int meshes[] = { 2, 1, 2, 2, 1, 2 };
+    const unsigned int materials[] = { 0, 0, 0, 5, 0, 0 };
+
+    InstanceBatcher batcher;
+    for ( size_t i = 0; i < 6; ++i ) {
+        batcher.Add( meshes[i], materials[i], worlds[i], &worlds[i] );
+    }
+    batcher.Build( nullptr );
+
+    // Groups in the order their first object came; objects in theirs.
+    const std::vector<InstanceBatcher::Batch>& batches = batcher.GetBatches();
+    CHECK( batches.size() == 3 );
+    CHECK( batches[0].mesh == 2 && batches[0].material == 0 && batches[0].object == &worlds[0] );
+    CHECK( batches[0].firstInstance == 0 && batches[0].instanceCount == 3 );
+    CHECK( batches[1].mesh == 1 && batches[1].material == 0 && batches[1].object == &worlds[1] );
+    CHECK( batches[1].firstInstance == 3 && batches[1].instanceCount == 2 );
+    CHECK( batches[2].mesh == 2 && batches[2].material == 5 && batches[2].object == &worlds[3] );
+    CHECK( batches[2].firstInstance == 5 && batches[2].instanceCount == 1 );
+
+    const size_t order[] = { 0, 2, 5, 1, 4, 3 };
+    const std::vector<InstanceBatcher::Instance>& instances = batcher.GetInstances();
+    CHECK( instances.size() == 6 );
+
+    bool mapped = true;
+    for ( size_t i = 0; i < 6; ++i ) {
+        mapped = mapped && batcher.GetInstanceObject( i ) == &worlds[order[i]] &&
+                 SameMatrix( instances[i].World, worlds[order[i]] ) &&
+                 MatchesScalar( worlds[order[i]], instances[i].WorldInvTranspose );
+    }
+    CHECK( mapped );
+
+    // Building again, or clearing and adding the same frame, gives the same
+    // layout.
+    batcher.Build( nullptr );
+    CHECK( batcher.GetBatches().size() == 3 && batcher.GetInstances().size() == 6 );
+    CHECK( batcher.GetInstanceObject( 3 ) == &worlds[1] );
+
+    batcher.Clear();
+    CHECK( batcher.GetBatches().empty() && batcher.GetInstances().empty() );
+    batcher.Build( nullptr );
+    CHECK( batcher.GetInstances().empty() );
+
+    for ( size_t i = 0; i < 6; ++i ) {
+        batcher.Add( meshes[i], materials[i], worlds[i], &worlds[i] );
+    }
+    batcher.Build( nullptr );
+
+    bool stable = batcher.GetBatches().size() == 3;
+    for ( size_t i = 0; stable && i < 6; ++i ) {
+        stable = batcher.GetInstanceObject( i ) == &worlds[order[i]] &&
+                 SameMatrix( batcher.GetInstances()[i].World, worlds[order[i]] );
+    }
+    CHECK( stable );
+    CHECK( batcher.GetBatches()[2].firstInstance == 5 && batcher.GetBatches()[2].object == &worlds[3] );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( InstanceBatcher_BatchesTileTheInstances )
+{
+    std::mt19937 rng( 4096 );
+    JobSystem jobs( 3 );
+
+    // Below the threshold, above it by a scalar tail, and in several chunks.
+    const size_t counts[] = { 1, 11, 1001, InstanceBatcher::ParallelThreshold + 7, 3 * 1024 * 3 + 2 };
+    for ( const size_t count : counts ) {
+        std::vector<XMFLOAT4X4> worlds;
+        for ( size_t i = 0; i < count; ++i ) {
+            worlds.push_back( RandomWorld( rng, i ) );
+        }
+
+        InstanceBatcher serial;
+        InstanceBatcher parallel;
+        AddObjects( serial, worlds );
+        AddObjects( parallel, worlds );
+        serial.Build( nullptr );
+        parallel.Build( &jobs );
+
+        // Each batch starts where the one before ended, and together they
+        // cover every instance once.
+        const std::vector<InstanceBatcher::Batch>& batches = parallel.GetBatches();
+        CHECK( batches.size() == std::min<size_t>( count, 3 ) );
+
+        size_t next = 0;
+        bool contiguous = true;
+        for ( const InstanceBatcher::Batch& batch : batches ) {
+            contiguous = contiguous && batch.firstInstance == next && batch.instanceCount > 0 &&
+                         parallel.GetInstanceObject( batch.firstInstance ) == batch.object;
+            next += batch.instanceCount;
+        }
+        CHECK( contiguous && next == count );
+        CHECK( parallel.GetInstances().size() == count );
+
+        // Every instance is the object it maps back to, with its inverse
+        // transpose, and the serial and parallel builds agree exactly.
+        bool mapped = true;
+        bool same = serial.GetInstances().size() == count;
+        for ( size_t i = 0; i < count; ++i ) {
+            const XMFLOAT4X4* world = static_cast<const XMFLOAT4X4*>( parallel.GetInstanceObject( i ) );
+            const InstanceBatcher::Instance& instance = parallel.GetInstances()[i];
+            mapped = mapped && SameMatrix( instance.World, *world ) && MatchesScalar( *world, instance.WorldInvTranspose );
+            same = same && serial.GetInstanceObject( i ) == world &&
+                   SameMatrix( serial.GetInstances()[i].World, instance.World ) &&
+                   SameMatrix( serial.GetInstances()[i].WorldInvTranspose, instance.WorldInvTranspose );
+        }
+        CHECK( mapped );
+        CHECK( same );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( MathHelper_InverseTransposeBatchMatchesScalar )
+{
+    std::mt19937 rng( 66 );
+
+    // Matrices inside larger structs, at strides other than a matrix; the
+    // rest of each result, and the entry past the last, must not be touched.
+    struct Source {
+        float before;
+        XMFLOAT4X4 world;
+        float after[3];
+    };
+    struct Result {
+        XMFLOAT4X4 inverseTranspose;
+        float sentinel[5];
+    };
+
+    for ( size_t count = 0; count <= 19; ++count ) {
+        std::vector<Source> sources( count );
+        for ( size_t i = 0; i < count; ++i ) {
+            sources[i].before = -1.f;
+            sources[i].world = RandomWorld( rng, i + count );
+            sources[i].after[0] = sources[i].after[1] = sources[i].after[2] = -2.f;
+        }
+
+        std::vector<Result> results( count + 1 );
+        for ( Result& result : results ) {
+            std::memset( &result.inverseTranspose, 0, sizeof( XMFLOAT4X4 ) );
+            for ( float& sentinel : result.sentinel ) {
+                sentinel = 42.f;
+            }
+        }
+        results[count].inverseTranspose.m[0][0] = 42.f;
+
+        MathHelper::InverseTransposeBatch( count ? &sources[0].world : nullptr, sizeof( Source ),
+                                           &results[0].inverseTranspose, sizeof( Result ), count );
+
+        bool matches = true;
+        bool untouched = results[count].inverseTranspose.m[0][0] == 42.f;
+        for ( size_t i = 0; i < count; ++i ) {
+            matches = matches && MatchesScalar( sources[i].world, results[i].inverseTranspose );
+            for ( const float sentinel : results[i].sentinel ) {
+                untouched = untouched && sentinel == 42.f;
+            }
+        }
+        CHECK( matches );
+        CHECK( untouched );
+    }
+
+    // Packed matrices, as for a plain array.
+    std::vector<XMFLOAT4X4> worlds;
+    for ( size_t i = 0; i < 64; ++i ) {
+        worlds.push_back( RandomWorld( rng, i ) );
+    }
+    std::vector<XMFLOAT4X4> results( worlds.size() );
+    MathHelper::InverseTransposeBatch( worlds.data(), sizeof( XMFLOAT4X4 ), results.data(), sizeof( XMFLOAT4X4 ), worlds.size() );
+
+    bool matches = true;
+    for ( size_t i = 0; i < worlds.size(); ++i ) {
+        matches = matches && MatchesScalar( worlds[i], results[i] );
+    }
+    CHECK( matches );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
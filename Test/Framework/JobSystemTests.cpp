@@ -0,0 +1,162 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file JobSystemTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "JobSystem.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( JobSystem_NestedParallelForCoversEveryIndexOnce )
+{
+    JobSystem jobs( 4 );
+
+    for ( int round = 0; round < 50; ++round ) {
+        std::vector<std::atomic<int>> hits( 10000 );
+        for ( auto& hit : hits ) {
+            hit = 0;
+        }
+
+        // Outer ranges start inner loops, so workers wait on jobs that are
+        // queued behind them.
+        jobs.ParallelFor( 0, 1000, 7, [&]( size_t begin, size_t end ) {
+            jobs.ParallelFor( begin * 10, end * 10, 13, [&]( size_t first, size_t last ) {
+                for ( size_t i = first; i < last; ++i ) {
+                    ++hits[i];
+                }
+            } );
+        } );
+
+        bool once = true;
+        for ( auto& hit : hits ) {
+            once = once && hit == 1;
+        }
+        CHECK( once );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( JobSystem_RunAfterOrdersDependencyChains )
+{
+    JobSystem jobs( 4 );
+
+    for ( int round = 0; round < 200; ++round ) {
+        JobCounter first;
+        JobCounter second;
+        JobCounter third;
+        std::atomic<int> stage( 0 );
+        std::atomic<int> startedEarly( 0 );
+
+        for ( int i = 0; i < 20; ++i ) {
+            jobs.Run( [&]() {
+                if ( stage != 0 ) {
+                    ++startedEarly;
+                }
+            }, &first );
+        }
+        jobs.RunAfter( first, [&]() { stage = 1; }, &second );
+        jobs.RunAfter( second, [&]() {
+            if ( stage != 1 ) {
+                ++startedEarly;
+            }
+            stage = 2;
+        }, &third );
+
+        jobs.Wait( third );
+
+        CHECK( startedEarly == 0 );
+        CHECK( stage == 2 );
+        CHECK( first.IsDone() && second.IsDone() && third.IsDone() );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( JobSystem_ManyThreadsQueueConcurrently )
+{
+    JobSystem jobs( 3 );
+
+    JobCounter counter;
+    std::atomic<int> ran( 0 );
+
+    // Jobs queued from threads outside the pool, and from jobs themselves.
+    std::vector<std::thread> producers;
+    for ( int p = 0; p < 4; ++p ) {
+        producers.emplace_back( [&]() {
+            for ( int i = 0; i < 2500; ++i ) {
+                jobs.Run( [&]() {
+                    jobs.Run( [&]() { ++ran; }, &counter );
+                    ++ran;
+                }, &counter );
+            }
+        } );
+    }
+    for ( auto& producer : producers ) {
+        producer.join();
+    }
+
+    jobs.Wait( counter );
+
+    CHECK( ran == 4 * 2500 * 2 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( JobSystem_NoWorkersRunsOnTheWaitingThread )
+{
+    JobSystem jobs( 0 );
+
+    JobCounter counter;
+    std::atomic<int> ran( 0 );
+    for ( int i = 0; i < 100; ++i ) {
+        jobs.Run( [&]() { ++ran; }, &counter );
+    }
+    jobs.Wait( counter );
+    CHECK( ran == 100 );
+
+    size_t covered = 0;
+    jobs.ParallelFor( 0, 100, 3, [&]( size_t begin, size_t end ) {
+        covered += end - begin;
+    } );
+    CHECK( covered == 100 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+// Times the same ParallelFor over pools of 0 (calling thread only), 1, 2, 4
+// ... workers, up to the shared instance's count.
+BENCHMARK( JobSystem_ParallelForScaling )
+{
+    std::vector<float> values( size_t( 1 ) << 22 );
+
+    const unsigned int maxWorkers = std::max( 1u, JobSystem::Instance().GetWorkerCount() );
+    double serialMs = 0.0;
+
+    for ( unsigned int workers = 0; workers <= maxWorkers; workers = workers ? workers * 2 : 1 ) {
+        JobSystem jobs( workers );
+
+        const double ms = Test::TimeMs( [&]() {
+            for ( int pass = 0; pass < 10; ++pass ) {
+                jobs.ParallelFor( 0, values.size(), 16384, [&]( size_t begin, size_t end ) {
+                    for ( size_t i = begin; i < end; ++i ) {
+                        const float x = static_cast<float>( i );
+                        values[i] = std::sqrt( std::sin( x * 0.001f ) + 2.0f ) * std::cos( x );
+                    }
+                } );
+            }
+        } );
+
+        if ( workers == 0 ) {
+            serialMs = ms;
+        }
+        std::printf( "    %u workers: %8.1f ms  (%.2fx)\n", workers, ms, serialMs / ms );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,106 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file LargeWorldTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "JobSystem.h"
+#include "LargeWorld.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // Instances scattered over count / 64 km, each with its own axes.
+    std::vector<LargeWorld::Instance> RandomInstances( const size_t count, const unsigned int seed )
+    {
+        std::mt19937 rng( seed );
+        std::uniform_real_distribution<double> position( 0.0, count * 16.0 );
+        std::uniform_real_distribution<float> axis( -1.f, 1.f );
+
+        std::vector<LargeWorld::Instance> instances( count );
+        for ( LargeWorld::Instance& instance : instances ) {
+            for ( int r = 0; r < 3; ++r ) {
+                for ( int c = 0; c < 3; ++c ) {
+                    instance.axes.m[r][c] = axis( rng );
+                }
+            }
+            instance.position = WorldPosition::FromDouble( position( rng ), position( rng ) * 0.01, position( rng ) );
+        }
+        return instances;
+    }
+
+    // Per-instance vertex data with the world matrix first, as the demos
+    // lay it out.
+    struct InstancedData {
+        XMFLOAT4X4 world;
+        XMFLOAT4 color;
+    };
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( LargeWorld_ParallelRebaseMatchesSingleInstances )
+{
+    JobSystem jobs( 4 );
+
+    const size_t count = 3 * LargeWorld::ParallelThreshold + 17;
+    const std::vector<LargeWorld::Instance> instances = RandomInstances( count, 1 );
+    const WorldPosition origin = WorldPosition::FromDouble( count * 8.0, 12.5, count * 4.0 );
+
+    for ( JobSystem* pool : { static_cast<JobSystem*>( nullptr ), &jobs } ) {
+        // Strided, with the colors left alone.
+        std::vector<InstancedData> data( count );
+        for ( InstancedData& d : data ) {
+            d.color = XMFLOAT4( 0.25f, 0.5f, 0.75f, 1.f );
+        }
+        LargeWorld::RebaseWorldMatrices( &instances[0], count, origin, &data[0].world, sizeof( InstancedData ), pool );
+
+        bool same = true;
+        bool colorsKept = true;
+        for ( size_t i = 0; i < count; ++i ) {
+            XMFLOAT4X4 expected;
+            XMStoreFloat4x4( &expected, LargeWorld::RebaseWorldMatrix( instances[i], origin ) );
+            same = same && std::memcmp( &expected, &data[i].world, sizeof( expected ) ) == 0;
+            colorsKept = colorsKept && data[i].color.y == 0.5f && data[i].color.w == 1.f;
+        }
+        CHECK( same );
+        CHECK( colorsKept );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+BENCHMARK( LargeWorld_RebaseWorldMatrices )
+{
+    const WorldPosition origin = WorldPosition::FromDouble( 5e5, 100.0, 5e5 );
+
+    for ( const size_t count : { size_t( 10000 ), size_t( 100000 ), size_t( 1000000 ) } ) {
+        const std::vector<LargeWorld::Instance> instances = RandomInstances( count, 2 );
+        std::vector<InstancedData> data( count );
+
+        for ( int parallel = 0; parallel < 2; ++parallel ) {
+            JobSystem* jobs = parallel ? &JobSystem::Instance() : nullptr;
+
+            const int Repeats = 10;
+            const double ms = Test::TimeMs( [&]() {
+                for ( int r = 0; r < Repeats; ++r ) {
+                    LargeWorld::RebaseWorldMatrices( &instances[0], count, origin, &data[0].world, sizeof( InstancedData ), jobs );
+                }
+            } ) / Repeats;
+
+            std::printf( "    %7zu instances (%s): %.3f ms\n", count, parallel ? "jobs  " : "serial", ms );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,360 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file PlanarReflectionTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <random>
+
+#include <DirectXMath.h>
+
+#include "PlanarReflection.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // The Mirror demo's mirror: 5 x 4 in the z = 0 plane, facing -z.
+    const float MirrorWidth = 5.f;
+    const float MirrorHeight = 4.f;
+
+    void SetDemoMirror( PlanarReflection& reflection )
+    {
+        const XMFLOAT3 corners[PlanarReflection::MirrorCorners] = {
+            XMFLOAT3( -2.5f, 0.f, 0.f ),
+            XMFLOAT3( -2.5f, 4.f, 0.f ),
+            XMFLOAT3( 2.5f, 4.f, 0.f ),
+            XMFLOAT3( 2.5f, 0.f, 0.f ),
+        };
+        reflection.SetMirror( corners, XMFLOAT3( 0.f, 0.f, -1.f ) );
+    }
+
+    XMMATRIX LookAt( const XMFLOAT3& eye, const XMFLOAT3& target )
+    {
+        return XMMatrixLookAtLH( XMLoadFloat3( &eye ), XMLoadFloat3( &target ), XMVectorSet( 0.f, 1.f, 0.f, 0.f ) );
+    }
+
+    XMMATRIX DemoProj( void )
+    {
+        return XMMatrixPerspectiveFovLH( 0.25f * XM_PI, 800.f / 600.f, 1.f, 1000.f );
+    }
+
+    // Row vector p times M.
+    XMFLOAT4 Transform( const XMFLOAT4X4& M, const XMFLOAT4& p )
+    {
+        return XMFLOAT4(
+            p.x * M( 0, 0 ) + p.y * M( 1, 0 ) + p.z * M( 2, 0 ) + p.w * M( 3, 0 ),
+            p.x * M( 0, 1 ) + p.y * M( 1, 1 ) + p.z * M( 2, 1 ) + p.w * M( 3, 1 ),
+            p.x * M( 0, 2 ) + p.y * M( 1, 2 ) + p.z * M( 2, 2 ) + p.w * M( 3, 2 ),
+            p.x * M( 0, 3 ) + p.y * M( 1, 3 ) + p.z * M( 2, 3 ) + p.w * M( 3, 3 ) );
+    }
+
+    XMFLOAT4X4 Store( FXMMATRIX M )
+    {
+        XMFLOAT4X4 stored;
+        XMStoreFloat4x4( &stored, M );
+        return stored;
+    }
+
+    // Cameras in front of the mirror looking roughly at it, from the same
+    // seed every run.
+    struct RandomCamera {
+        XMFLOAT3 eye;
+        XMFLOAT4X4 view;
+    };
+
+    RandomCamera MakeCamera( std::mt19937& rng )
+    {
+        std::uniform_real_distribution<float> unit( -1.f, 1.f );
+
+        RandomCamera camera;
+        camera.eye = XMFLOAT3( 8.f * unit( rng ), 2.f + 3.f * unit( rng ), -2.f - 12.f * std::fabs( unit( rng ) ) );
+        const XMFLOAT3 target( 4.f * unit( rng ), 2.f + 2.f * unit( rng ), 3.f * unit( rng ) );
+        camera.view = Store( LookAt( camera.eye, target ) );
+        return camera;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( PlanarReflection_ReflectsAboutTheMirrorPlane )
+{
+    PlanarReflection reflection;
+    SetDemoMirror( reflection );
+
+    const XMFLOAT4 plane = reflection.GetPlane();
+    CHECK_NEAR( plane.x, 0.f, 1e-6f );
+    CHECK_NEAR( plane.y, 0.f, 1e-6f );
+    CHECK_NEAR( plane.z, -1.f, 1e-6f );
+    CHECK_NEAR( plane.w, 0.f, 1e-6f );
+
+    const XMFLOAT4X4 R = Store( reflection.GetReflection() );
+
+    const XMFLOAT4 onMirror = Transform( R, XMFLOAT4( 1.f, 2.f, 0.f, 1.f ) );
+    CHECK_NEAR( onMirror.x, 1.f, 1e-6f );
+    CHECK_NEAR( onMirror.y, 2.f, 1e-6f );
+    CHECK_NEAR( onMirror.z, 0.f, 1e-6f );
+
+    const XMFLOAT4 inFront = Transform( R, XMFLOAT4( 1.f, 2.f, -3.f, 1.f ) );
+    CHECK_NEAR( inFront.x, 1.f, 1e-6f );
+    CHECK_NEAR( inFront.z, 3.f, 1e-6f );
+    CHECK_NEAR( inFront.w, 1.f, 1e-6f );
+
+    // Directions flip too, and reflecting twice is the identity.
+    const XMFLOAT4 direction = Transform( R, XMFLOAT4( 0.f, 0.f, 1.f, 0.f ) );
+    CHECK_NEAR( direction.z, -1.f, 1e-6f );
+    CHECK_NEAR( direction.w, 0.f, 1e-6f );
+
+    const XMFLOAT4X4 twice = Store( XMMatrixMultiply( reflection.GetReflection(), reflection.GetReflection() ) );
+    for ( int i = 0; i < 4; ++i ) {
+        for ( int j = 0; j < 4; ++j ) {
+            CHECK_NEAR( twice( i, j ), i == j ? 1.f : 0.f, 1e-6f );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( PlanarReflection_SkipsMirrorsThatCannotShow )
+{
+    PlanarReflection reflection;
+    SetDemoMirror( reflection );
+    const XMMATRIX proj = DemoProj();
+
+    // Behind the mirror.
+    const XMFLOAT3 behind( 0.f, 2.f, 5.f );
+    CHECK( !reflection.Update( behind, LookAt( behind, XMFLOAT3( 0.f, 2.f, 0.f ) ), proj ) );
+    CHECK( !reflection.IsVisible() );
+
+    // In front, looking away.
+    const XMFLOAT3 away( 0.f, 2.f, -5.f );
+    CHECK( !reflection.Update( away, LookAt( away, XMFLOAT3( 0.f, 2.f, -10.f ) ), proj ) );
+    CHECK( !reflection.IsSphereVisible( XMFLOAT3( 0.f, 2.f, -3.f ), 1.f ) );
+
+    // In front, looking at it.
+    const XMFLOAT3 facing( 0.f, 2.f, -10.f );
+    CHECK( reflection.Update( facing, LookAt( facing, XMFLOAT3( 0.f, 2.f, 0.f ) ), proj ) );
+    CHECK( reflection.IsVisible() );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( PlanarReflection_ObliqueProjectionClipsAtTheMirror )
+{
+    PlanarReflection reflection;
+    SetDemoMirror( reflection );
+    const XMMATRIX proj = DemoProj();
+
+    std::mt19937 rng( 5 );
+    std::uniform_real_distribution<float> unit( -1.f, 1.f );
+
+    int visible = 0;
+    for ( int c = 0; c < 500; ++c ) {
+        const RandomCamera camera = MakeCamera( rng );
+        if ( !reflection.Update( camera.eye, XMLoadFloat4x4( &camera.view ), proj ) ) {
+            continue;
+        }
+        ++visible;
+
+        const XMFLOAT4X4 standard = Store( XMMatrixMultiply( reflection.GetReflectedView(), proj ) );
+        const XMFLOAT4X4 oblique = Store( reflection.GetReflectedViewProj() );
+
+        for ( int s = 0; s < 200; ++s ) {
+            const XMFLOAT4 p( 10.f * unit( rng ), 2.f + 6.f * unit( rng ), 15.f * unit( rng ), 1.f );
+            const XMFLOAT4 a = Transform( standard, p );
+            const XMFLOAT4 o = Transform( oblique, p );
+
+            // Only depth changes: x, y and w are the standard projection's.
+            CHECK_NEAR( o.x, a.x, 1e-3f * ( 1.f + std::fabs( a.x ) ) );
+            CHECK_NEAR( o.y, a.y, 1e-3f * ( 1.f + std::fabs( a.y ) ) );
+            CHECK_NEAR( o.w, a.w, 1e-3f * ( 1.f + std::fabs( a.w ) ) );
+
+            if ( o.w <= 0.01f ) {
+                continue;
+            }
+
+            // Reflected geometry behind the mirror (z > 0 here) is clipped
+            // by the near plane; in front of it, it is not.
+            if ( p.z > 1e-2f ) {
+                CHECK( o.z < 0.f );
+            }
+            if ( p.z < -1e-2f ) {
+                CHECK( o.z >= 0.f );
+
+                // And the tilted far plane keeps what the standard frustum
+                // shows within depth 1.
+                const bool inStandard = a.w > 0.f && a.z <= a.w && std::fabs( a.x ) <= a.w && std::fabs( a.y ) <= a.w;
+                if ( inStandard ) {
+                    CHECK( o.z <= 1.0001f * o.w );
+                }
+            }
+        }
+    }
+
+    // Most of the cameras see the mirror; the checks above ran.
+    CHECK( visible > 250 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( PlanarReflection_ObliqueProjectionPutsThePlaneAtDepthZero )
+{
+    const XMFLOAT4X4 original = Store( DemoProj() );
+
+    // A tilted view-space plane in front of the eye, positive away from it.
+    XMFLOAT4 plane( 0.2f, -0.3f, 1.f, -4.f );
+    const float length = std::sqrt( plane.x * plane.x + plane.y * plane.y + plane.z * plane.z );
+    plane = XMFLOAT4( plane.x / length, plane.y / length, plane.z / length, plane.w / length );
+
+    XMFLOAT4X4 oblique = original;
+    PlanarReflection::ObliqueProjection( oblique, plane );
+
+    std::mt19937 rng( 11 );
+    std::uniform_real_distribution<float> unit( -1.f, 1.f );
+
+    for ( int s = 0; s < 1000; ++s ) {
+        // A point on the plane: pick x and y, solve for z.
+        const float x = 3.f * unit( rng );
+        const float y = 3.f * unit( rng );
+        const float z = -( plane.x * x + plane.y * y + plane.w ) / plane.z;
+        const XMFLOAT4 clip = Transform( oblique, XMFLOAT4( x, y, z, 1.f ) );
+        CHECK_NEAR( clip.z / clip.w, 0.f, 1e-4f );
+
+        // Only the third column changes.
+        const XMFLOAT4 before = Transform( original, XMFLOAT4( x, y, z, 1.f ) );
+        CHECK_NEAR( clip.x, before.x, 1e-4f );
+        CHECK_NEAR( clip.y, before.y, 1e-4f );
+        CHECK_NEAR( clip.w, before.w, 1e-4f );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( PlanarReflection_ScreenBoundsCoverTheMirror )
+{
+    PlanarReflection reflection;
+    SetDemoMirror( reflection );
+    const XMMATRIX proj = DemoProj();
+
+    std::mt19937 rng( 7 );
+
+    const int Samples = 60;
+    for ( int c = 0; c < 1000; ++c ) {
+        const RandomCamera camera = MakeCamera( rng );
+        const XMMATRIX view = XMLoadFloat4x4( &camera.view );
+        const bool visible = reflection.Update( camera.eye, view, proj );
+
+        // Brute force: where a grid over the mirror lands on screen.
+        const XMFLOAT4X4 viewProj = Store( XMMatrixMultiply( view, proj ) );
+        float minX = 2.f, minY = 2.f, maxX = -2.f, maxY = -2.f;
+        bool any = false;
+        for ( int i = 0; i <= Samples; ++i ) {
+            for ( int j = 0; j <= Samples; ++j ) {
+                const XMFLOAT4 p( -0.5f * MirrorWidth + MirrorWidth * i / Samples, MirrorHeight * j / Samples, 0.f, 1.f );
+                const XMFLOAT4 clip = Transform( viewProj, p );
+                if ( clip.w <= 0.f ) {
+                    continue;
+                }
+                const float x = clip.x / clip.w;
+                const float y = clip.y / clip.w;
+                const float z = clip.z / clip.w;
+                if ( x < -1.f || x > 1.f || y < -1.f || y > 1.f || z < 0.f || z > 1.f ) {
+                    continue;
+                }
+                any = true;
+                minX = std::min( minX, x );
+                minY = std::min( minY, y );
+                maxX = std::max( maxX, x );
+                maxY = std::max( maxY, y );
+            }
+        }
+
+        if ( any && maxX - minX > 0.05f && maxY - minY > 0.05f ) {
+            CHECK( visible );
+        }
+        if ( !visible || !any ) {
+            continue;
+        }
+
+        // Covers every sample, and is no more than a sample spacing or so
+        // bigger than they are.
+        const XMFLOAT4 bounds = reflection.GetScreenBounds();
+        CHECK( bounds.x <= minX + 1e-3f && bounds.y <= minY + 1e-3f );
+        CHECK( bounds.z >= maxX - 1e-3f && bounds.w >= maxY - 1e-3f );
+        CHECK( bounds.x >= minX - 0.1f && bounds.y >= minY - 0.1f );
+        CHECK( bounds.z <= maxX + 0.1f && bounds.w <= maxY + 0.1f );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( PlanarReflection_CullingNeverDropsVisibleGeometry )
+{
+    PlanarReflection reflection;
+    SetDemoMirror( reflection );
+    const XMMATRIX proj = DemoProj();
+
+    std::mt19937 rng( 13 );
+    std::uniform_real_distribution<float> unit( -1.f, 1.f );
+
+    int culled = 0;
+    int tested = 0;
+    for ( int c = 0; c < 300; ++c ) {
+        const RandomCamera camera = MakeCamera( rng );
+        if ( !reflection.Update( camera.eye, XMLoadFloat4x4( &camera.view ), proj ) ) {
+            continue;
+        }
+
+        const XMFLOAT4X4 viewProj = Store( reflection.GetReflectedViewProj() );
+        const XMFLOAT4 bounds = reflection.GetScreenBounds();
+
+        for ( int s = 0; s < 100; ++s ) {
+            const XMFLOAT3 center( 10.f * unit( rng ), 2.f + 6.f * unit( rng ), 15.f * unit( rng ) );
+            const float radius = 0.01f + 0.5f * std::fabs( unit( rng ) );
+
+            // Sample the sphere: any point inside the mirror's screen
+            // rectangle and depth range means it can show.
+            bool shows = false;
+            for ( int k = 0; k < 200 && !shows; ++k ) {
+                XMFLOAT3 d;
+                do {
+                    d = XMFLOAT3( unit( rng ), unit( rng ), unit( rng ) );
+                } while ( d.x * d.x + d.y * d.y + d.z * d.z > 1.f );
+
+                const XMFLOAT4 clip = Transform( viewProj,
+                    XMFLOAT4( center.x + radius * d.x, center.y + radius * d.y, center.z + radius * d.z, 1.f ) );
+                if ( clip.w <= 0.f ) {
+                    continue;
+                }
+                const float x = clip.x / clip.w;
+                const float y = clip.y / clip.w;
+                const float z = clip.z / clip.w;
+                shows = x >= bounds.x && x <= bounds.z && y >= bounds.y && y <= bounds.w && z >= 0.f && z <= 1.f;
+            }
+
+            const bool sphereVisible = reflection.IsSphereVisible( center, radius );
+            if ( shows ) {
+                CHECK( sphereVisible );
+            }
+
+            // The box around the sphere is never culled when the sphere isn't.
+            const XMFLOAT3 boxMin( center.x - radius, center.y - radius, center.z - radius );
+            const XMFLOAT3 boxMax( center.x + radius, center.y + radius, center.z + radius );
+            if ( sphereVisible ) {
+                CHECK( reflection.IsBoxVisible( boxMin, boxMax ) );
+            }
+
+            culled += sphereVisible ? 0 : 1;
+            ++tested;
+        }
+    }
+
+    // The frustum is tight enough to cull a good share of the samples.
+    CHECK( culled > tested / 4 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
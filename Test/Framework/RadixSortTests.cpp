@@ -0,0 +1,149 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file RadixSortTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <random>
+
+#include "JobSystem.h"
+#include "RadixSort.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    struct Record32 {
+        uint32_t key;
+        uint32_t order;
+    };
+
+    struct Record64 {
+        uint64_t key;
+        uint32_t order;
+    };
+
+    // Sorts records serially and on jobs, and checks both against
+    // std::stable_sort: same keys, and equal keys in submission order.
+    template <typename Record>
+    void CheckSort( std::vector<Record> records, JobSystem& jobs )
+    {
+        for ( size_t i = 0; i < records.size(); ++i ) {
+            records[i].order = static_cast<uint32_t>( i );
+        }
+
+        std::vector<Record> expected = records;
+        std::stable_sort( expected.begin(), expected.end(), []( const Record& a, const Record& b ) {
+            return a.key < b.key;
+        } );
+
+        for ( int parallel = 0; parallel < 2; ++parallel ) {
+            std::vector<Record> sorted = records;
+            std::vector<Record> scratch;
+
+            // A threshold of 0 goes parallel whenever there are records
+            // for more than one chunk.
+            RadixSort::Sort( sorted, scratch, parallel ? &jobs : nullptr, 0 );
+
+            CHECK( sorted.size() == expected.size() );
+            bool same = sorted.size() == expected.size();
+            for ( size_t i = 0; same && i < sorted.size(); ++i ) {
+                same = sorted[i].key == expected[i].key && sorted[i].order == expected[i].order;
+            }
+            CHECK( same );
+        }
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( RadixSort_MatchesStableSort )
+{
+    JobSystem jobs( 3 );
+    std::mt19937_64 rng( 7 );
+
+    const size_t sizes[] = { 0, 1, 2, 17, 255, 4096, 40000, 200000 };
+    for ( const size_t size : sizes ) {
+        // Keys over the full width, so every digit is sorted.
+        std::vector<Record64> wide( size );
+        for ( auto& r : wide ) {
+            r.key = rng();
+        }
+        CheckSort( wide, jobs );
+
+        // Few distinct keys: long runs of ties, which stability decides.
+        std::vector<Record32> ties( size );
+        for ( auto& r : ties ) {
+            r.key = static_cast<uint32_t>( rng() % 5 );
+        }
+        CheckSort( ties, jobs );
+
+        // Only a middle field varies, so most digits are skipped.
+        std::vector<Record64> packed( size );
+        for ( auto& r : packed ) {
+            r.key = ( uint64_t( 0xABCD ) << 48 ) | ( ( rng() & 0xFFF ) << 20 ) | 0x5;
+        }
+        CheckSort( packed, jobs );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( RadixSort_SortedAndReversedInput )
+{
+    JobSystem jobs( 3 );
+
+    std::vector<Record32> ascending( 50000 );
+    std::vector<Record32> descending( 50000 );
+    for ( size_t i = 0; i < ascending.size(); ++i ) {
+        ascending[i].key = static_cast<uint32_t>( i * 2654435761u >> 8 ) & 0xFFFFFF00u;
+        descending[i].key = static_cast<uint32_t>( ascending.size() - i );
+    }
+    std::sort( ascending.begin(), ascending.end(), []( const Record32& a, const Record32& b ) { return a.key < b.key; } );
+
+    CheckSort( ascending, jobs );
+    CheckSort( descending, jobs );
+
+    // All keys equal: nothing moves.
+    std::vector<Record32> same( 10000 );
+    for ( auto& r : same ) {
+        r.key = 42;
+    }
+    CheckSort( same, jobs );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+// A million 64-bit keys: std::sort, then RadixSort serial and on the
+// shared job system.
+BENCHMARK( RadixSort_MillionKeys )
+{
+    std::mt19937_64 rng( 11 );
+    std::vector<Record64> records( 1000000 );
+    for ( size_t i = 0; i < records.size(); ++i ) {
+        // Packed like a RenderQueue key: a few fields vary.
+        records[i].key = ( ( rng() & 0x3 ) << 60 ) | ( ( rng() & 0xFFF ) << 28 ) | ( rng() & 0xFFFF );
+        records[i].order = static_cast<uint32_t>( i );
+    }
+
+    std::vector<Record64> sorted = records;
+    const double stdMs = Test::TimeMs( [&]() {
+        std::stable_sort( sorted.begin(), sorted.end(), []( const Record64& a, const Record64& b ) {
+            return a.key < b.key;
+        } );
+    } );
+    std::printf( "    std::stable_sort:   %7.1f ms\n", stdMs );
+
+    std::vector<Record64> scratch;
+    for ( int parallel = 0; parallel < 2; ++parallel ) {
+        sorted = records;
+        const double ms = Test::TimeMs( [&]() {
+            RadixSort::Sort( sorted, scratch, parallel ? &JobSystem::Instance() : nullptr, 16384 );
+        } );
+        std::printf( "    RadixSort (%s): %7.1f ms\n", parallel ? "jobs  " : "serial", ms );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,243 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file RandomTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "Random.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // Plain scalar xoshiro128+, four lanes seeded the way Random::Seed()
+    // does it. Whichever path Random was built with (SSE2 or scalar) has to
+    // produce exactly this.
+    class ReferenceXoshiro {
+    public:
+
+        ReferenceXoshiro( const uint64_t seed, const uint64_t stream )
+        {
+            uint64_t x = seed;
+            uint64_t s = SplitMix64( x ) ^ ( stream * 0xd1342543de82ef95ULL );
+            for ( int lane = 0; lane < 4; ++lane ) {
+                const uint64_t a = SplitMix64( s );
+                const uint64_t b = SplitMix64( s );
+                mState[lane][0] = static_cast<uint32_t>( a );
+                mState[lane][1] = static_cast<uint32_t>( a >> 32 );
+                mState[lane][2] = static_cast<uint32_t>( b );
+                mState[lane][3] = static_cast<uint32_t>( b >> 32 ) | 1u;
+            }
+        }
+
+        uint32_t Next( const int lane )
+        {
+            uint32_t* s = mState[lane];
+            const uint32_t result = s[0] + s[3];
+            const uint32_t t = s[1] << 9;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = ( s[3] << 11 ) | ( s[3] >> 21 );
+            return result;
+        }
+
+    private:
+
+        static uint64_t SplitMix64( uint64_t& x )
+        {
+            uint64_t z = ( x += 0x9e3779b97f4a7c15ULL );
+            z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+            z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+            return z ^ ( z >> 31 );
+        }
+
+        uint32_t mState[4][4];
+    };
+
+    std::vector<uint32_t> Draw( Random& random, const size_t count )
+    {
+        std::vector<uint32_t> values( count );
+        for ( auto& value : values ) {
+            value = random.NextUInt();
+        }
+        return values;
+    }
+
+    size_t CountEqual( const std::vector<uint32_t>& a, const std::vector<uint32_t>& b )
+    {
+        size_t equal = 0;
+        for ( size_t i = 0; i < a.size(); ++i ) {
+            equal += a[i] == b[i] ? 1 : 0;
+        }
+        return equal;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( Random_SameSeedAndStreamRepeat )
+{
+    Random a( 1234, 7 );
+    Random b( 1234, 7 );
+    const std::vector<uint32_t> first = Draw( a, 1001 );
+    CHECK( first == Draw( b, 1001 ) );
+
+    // Seeding again starts the sequence over, whatever was buffered.
+    a.Seed( 1234, 7 );
+    CHECK( first == Draw( a, 1001 ) );
+
+    // The batch functions are as repeatable as the scalar ones.
+    std::vector<float> floatsA( 103 ), floatsB( 103 );
+    std::vector<XMFLOAT3> vectorsA( 57 ), vectorsB( 57 );
+    a.Seed( 99, 3 );
+    b.Seed( 99, 3 );
+    a.FillFloats( floatsA.data(), floatsA.size(), -2.f, 5.f );
+    b.FillFloats( floatsB.data(), floatsB.size(), -2.f, 5.f );
+    a.FillUnitVec3( vectorsA.data(), vectorsA.size() );
+    b.FillUnitVec3( vectorsB.data(), vectorsB.size() );
+    CHECK( floatsA == floatsB );
+    CHECK( std::memcmp( vectorsA.data(), vectorsB.data(), vectorsA.size() * sizeof( XMFLOAT3 ) ) == 0 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( Random_StreamsDiverge )
+{
+    // Neighboring streams of one seed, and one stream of neighboring seeds,
+    // share no more outputs than chance would (1 in 2^32 per value).
+    const size_t count = 4096;
+    std::vector<std::vector<uint32_t>> streams;
+    for ( uint64_t stream = 0; stream < 8; ++stream ) {
+        Random random( 42, stream );
+        streams.push_back( Draw( random, count ) );
+    }
+    for ( size_t i = 0; i < streams.size(); ++i ) {
+        for ( size_t j = i + 1; j < streams.size(); ++j ) {
+            CHECK( CountEqual( streams[i], streams[j] ) <= 1 );
+        }
+    }
+
+    Random seed42( 42, 0 );
+    Random seed43( 43, 0 );
+    CHECK( CountEqual( Draw( seed42, count ), Draw( seed43, count ) ) <= 1 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( Random_MatchesScalarReference )
+{
+    for ( uint64_t stream = 0; stream < 3; ++stream ) {
+        Random random( Random::DefaultSeed, stream );
+        ReferenceXoshiro reference( Random::DefaultSeed, stream );
+
+        // One step of the four lanes hands out lane 0 to 3 in order.
+        bool same = true;
+        for ( int step = 0; step < 256; ++step ) {
+            for ( int lane = 0; lane < 4; ++lane ) {
+                same = same && random.NextUInt() == reference.Next( lane );
+            }
+        }
+        CHECK( same );
+    }
+
+    // The vector conversion to [0, 1) gives what the scalar one does.
+    Random batch( 5, 1 );
+    Random scalar( 5, 1 );
+    std::vector<float> floats( 4 * 64 + 3 );
+    batch.FillFloats( floats.data(), floats.size() );
+
+    bool same = true;
+    for ( const float value : floats ) {
+        same = same && value == scalar.NextFloat();
+        same = same && value >= 0.f && value < 1.f;
+    }
+    CHECK( same );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( Random_UnitVectorsHaveUnitLength )
+{
+    // An odd count, with a sentinel past the end the tail must not touch.
+    const size_t count = 10001;
+    std::vector<XMFLOAT3> vectors( count + 1, XMFLOAT3( 7.f, 7.f, 7.f ) );
+
+    Random random( 11, 0 );
+    random.FillUnitVec3( vectors.data(), count );
+
+    double maxError = 0.0;
+    XMFLOAT3 mean( 0.f, 0.f, 0.f );
+    for ( size_t i = 0; i < count; ++i ) {
+        const XMFLOAT3& v = vectors[i];
+        const double length = std::sqrt( double( v.x ) * v.x + double( v.y ) * v.y + double( v.z ) * v.z );
+        maxError = std::max( maxError, std::fabs( length - 1.0 ) );
+        mean.x += v.x / count;
+        mean.y += v.y / count;
+        mean.z += v.z / count;
+    }
+    CHECK( maxError <= 1e-4 );
+    CHECK( vectors[count].x == 7.f && vectors[count].y == 7.f && vectors[count].z == 7.f );
+
+    // Uniform over the sphere, so the mean is close to the center.
+    CHECK( std::fabs( mean.x ) < 0.05f && std::fabs( mean.y ) < 0.05f && std::fabs( mean.z ) < 0.05f );
+
+    for ( int i = 0; i < 1000; ++i ) {
+        CHECK_NEAR( XMVectorGetX( XMVector3Length( random.NextUnitVec3() ) ), 1.f, 1e-4f );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( Random_HemisphereVectorsStayInHemisphere )
+{
+    // Unit normals, one of them off the axes.
+    const XMFLOAT3 normals[] = {
+        XMFLOAT3( 0.f, 1.f, 0.f ),
+        XMFLOAT3( 0.f, 0.f, -1.f ),
+        XMFLOAT3( 0.57735f, -0.57735f, 0.57735f )
+    };
+
+    Random random( 12, 0 );
+    for ( const XMFLOAT3& normal : normals ) {
+        const XMVECTOR n = XMLoadFloat3( &normal );
+
+        const size_t count = 4003;
+        std::vector<XMFLOAT3> vectors( count );
+        random.FillHemisphereUnitVec3( vectors.data(), count, n );
+
+        float minDot = 1.f;
+        double meanDot = 0.0;
+        double maxError = 0.0;
+        for ( const XMFLOAT3& v : vectors ) {
+            const XMVECTOR x = XMLoadFloat3( &v );
+            const float dot = XMVectorGetX( XMVector3Dot( n, x ) );
+            minDot = std::min( minDot, dot );
+            meanDot += dot / count;
+            maxError = std::max( maxError, double( std::fabs( XMVectorGetX( XMVector3Length( x ) ) - 1.f ) ) );
+        }
+
+        // Uniform over the hemisphere: cos(theta) is uniform in [0, 1].
+        CHECK( minDot >= -1e-5f );
+        CHECK( maxError <= 1e-4 );
+        CHECK_NEAR( meanDot, 0.5, 0.03 );
+
+        for ( int i = 0; i < 200; ++i ) {
+            CHECK( XMVectorGetX( XMVector3Dot( n, random.NextHemisphereUnitVec3( n ) ) ) >= -1e-5f );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
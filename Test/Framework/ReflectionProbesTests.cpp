@@ -0,0 +1,340 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file ReflectionProbesTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "ReflectionProbes.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    enum { PosX, NegX, PosY, NegY, PosZ, NegZ };
+
+    // A view without frustum planes: every probe is on screen.
+    ReflectionProbes::View MakeView( const XMFLOAT4* planes = nullptr )
+    {
+        ReflectionProbes::View view;
+        view.eye = XMFLOAT3( 0.f, 0.f, -10.f );
+        view.pixelScale = 500.f;
+        view.frustumPlanes = planes;
+        return view;
+    }
+
+    ReflectionProbes::Settings MakeSettings( const unsigned int facesPerFrame )
+    {
+        ReflectionProbes::Settings settings;
+        settings.facesPerFrame = facesPerFrame;
+        return settings;
+    }
+
+    ReflectionProbes::Object MakeObject( const float x, const float y, const float z, const float radius, const bool moving )
+    {
+        ReflectionProbes::Object object;
+        object.center = XMFLOAT3( x, y, z );
+        object.radius = radius;
+        object.moving = moving;
+        return object;
+    }
+
+    // The updates of the last Schedule() as probe * FaceCount + face.
+    std::vector<uint32_t> Picked( const ReflectionProbes& probes )
+    {
+        std::vector<uint32_t> picked;
+        for ( const ReflectionProbes::FaceUpdate& update : probes.GetUpdates() ) {
+            picked.push_back( update.probe * ReflectionProbes::FaceCount + update.face );
+        }
+        return picked;
+    }
+
+    // The draw list of the update for the face, or a list holding only
+    // NoObject if the face was not picked.
+    std::vector<uint32_t> DrawListOf( const ReflectionProbes& probes, const uint32_t probe, const uint32_t face )
+    {
+        for ( const ReflectionProbes::FaceUpdate& update : probes.GetUpdates() ) {
+            if ( update.probe == probe && update.face == face ) {
+                const uint32_t* first = probes.GetDrawList().data() + update.first;
+                return std::vector<uint32_t>( first, first + update.count );
+            }
+        }
+        const uint32_t missing = ReflectionProbes::NoObject;
+        return std::vector<uint32_t>( 1, missing );
+    }
+
+    // Schedules until nothing is pending, at most frames times.
+    void RenderAll( ReflectionProbes& probes, const ReflectionProbes::Object* objects, const size_t count, const int frames = 12 )
+    {
+        for ( int frame = 0; frame < frames; ++frame ) {
+            probes.Schedule( MakeView(), objects, count, MakeSettings( 6 ) );
+            if ( probes.GetStats().facesPending == 0 ) {
+                return;
+            }
+        }
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( ReflectionProbes_BudgetAndRoundRobin )
+{
+    // A new probe with nothing around it: six faces, two a frame.
+    ReflectionProbes single;
+    single.AddProbe( XMFLOAT3( 0.f, 0.f, 0.f ), 1.f );
+
+    const size_t pending[] = { 6, 4, 2, 0 };
+    const std::vector<uint32_t> expected[] = { { PosX, NegX }, { PosY, NegY }, { PosZ, NegZ }, { } };
+    for ( int frame = 0; frame < 4; ++frame ) {
+        single.Schedule( MakeView(), nullptr, 0, MakeSettings( 2 ) );
+        CHECK( Picked( single ) == expected[frame] );
+        CHECK( single.GetStats().facesPending == pending[frame] );
+        CHECK( single.GetStats().facesUpdated == expected[frame].size() );
+        CHECK( single.GetStats().facesClean == 6 - pending[frame] );
+    }
+
+    // Something moving all around the probe keeps every face pending; with
+    // four a frame the faces still come round in turn, oldest first and
+    // then on from where the last frame stopped.
+    ReflectionProbes busy;
+    busy.AddProbe( XMFLOAT3( 0.f, 0.f, 0.f ), 1.f );
+    const ReflectionProbes::Object around = MakeObject( 0.f, 0.f, 0.f, 2.f, true );
+
+    std::vector<uint32_t> sequence;
+    for ( int frame = 0; frame < 6; ++frame ) {
+        busy.Schedule( MakeView(), &around, 1, MakeSettings( 4 ) );
+        CHECK( busy.GetUpdates().size() == 4 );
+        CHECK( busy.GetStats().facesPending == 6 );
+        const std::vector<uint32_t> picked = Picked( busy );
+        sequence.insert( sequence.end(), picked.begin(), picked.end() );
+    }
+
+    bool roundRobin = sequence.size() == 24;
+    for ( size_t i = 0; roundRobin && i < sequence.size(); ++i ) {
+        roundRobin = sequence[i] == i % 6;
+    }
+    CHECK( roundRobin );
+
+    // Two probes the same size on screen share the budget: the first one's
+    // faces go first, then the second's, as they have waited longer.
+    ReflectionProbes pair;
+    pair.AddProbe( XMFLOAT3( -5.f, 0.f, 0.f ), 1.f );
+    pair.AddProbe( XMFLOAT3( 5.f, 0.f, 0.f ), 1.f );
+
+    const std::vector<uint32_t> pairs[] = { { 0, 1, 2 }, { 3, 4, 5 }, { 6, 7, 8 }, { 9, 10, 11 }, { } };
+    for ( int frame = 0; frame < 5; ++frame ) {
+        pair.Schedule( MakeView(), nullptr, 0, MakeSettings( 3 ) );
+        CHECK( Picked( pair ) == pairs[frame] );
+    }
+    CHECK( pair.GetPriority( 0 ) == pair.GetPriority( 1 ) && pair.GetPriority( 0 ) > 0.f );
+
+    // The bigger probe on screen is served first.
+    ReflectionProbes sizes;
+    sizes.AddProbe( XMFLOAT3( -5.f, 0.f, 0.f ), 1.f );
+    sizes.AddProbe( XMFLOAT3( 5.f, 0.f, 0.f ), 3.f );
+    sizes.Schedule( MakeView(), nullptr, 0, MakeSettings( 2 ) );
+    CHECK( sizes.GetPriority( 1 ) > sizes.GetPriority( 0 ) );
+    CHECK( Picked( sizes ) == std::vector<uint32_t>( { 6, 7 } ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( ReflectionProbes_FacesStayCleanUntilSomethingMoves )
+{
+    ReflectionProbes probes;
+    probes.AddProbe( XMFLOAT3( 0.f, 0.f, 0.f ), 1.f );
+
+    // One object ahead on +X, one ahead on -Z.
+    ReflectionProbes::Object objects[] = {
+        MakeObject( 20.f, 0.f, 0.f, 1.f, false ),
+        MakeObject( 0.f, 0.f, -20.f, 1.f, false )
+    };
+
+    probes.Schedule( MakeView(), objects, 2, MakeSettings( 6 ) );
+    CHECK( probes.GetUpdates().size() == 6 );
+    CHECK( DrawListOf( probes, 0, PosX ) == std::vector<uint32_t>( { 0 } ) );
+    CHECK( DrawListOf( probes, 0, NegZ ) == std::vector<uint32_t>( { 1 } ) );
+    CHECK( DrawListOf( probes, 0, PosY ).empty() );
+    CHECK( probes.GetStats().objectsDrawn == 2 && probes.GetStats().objectsCulled == 10 );
+
+    // Nothing moves: nothing to do, frame after frame, whatever the budget.
+    for ( int frame = 0; frame < 3; ++frame ) {
+        probes.Schedule( MakeView(), objects, 2, MakeSettings( 6 ) );
+        CHECK( probes.GetUpdates().empty() && probes.GetDrawList().empty() );
+        CHECK( probes.GetStats().facesClean == 6 && probes.GetStats().facesPending == 0 );
+    }
+
+    // Something moving inside one face only touches that face.
+    objects[0].center.x = 25.f;
+    objects[0].moving = true;
+    probes.Schedule( MakeView(), objects, 2, MakeSettings( 6 ) );
+    CHECK( Picked( probes ) == std::vector<uint32_t>( { PosX } ) );
+    CHECK( probes.GetStats().facesClean == 5 );
+
+    objects[0].moving = false;
+    probes.Schedule( MakeView(), objects, 2, MakeSettings( 6 ) );
+    CHECK( probes.GetUpdates().empty() );
+
+    // Changes the scheduler cannot see, and a different set of objects,
+    // need everything again.
+    probes.Invalidate( 0 );
+    probes.Schedule( MakeView(), objects, 2, MakeSettings( 6 ) );
+    CHECK( probes.GetUpdates().size() == 6 );
+
+    probes.Schedule( MakeView(), objects, 1, MakeSettings( 6 ) );
+    CHECK( probes.GetUpdates().size() == 6 );
+
+    probes.MoveProbe( 0, XMFLOAT3( 0.f, 0.f, 0.f ) );
+    probes.Schedule( MakeView(), objects, 1, MakeSettings( 6 ) );
+    CHECK( probes.GetUpdates().empty() );
+    probes.MoveProbe( 0, XMFLOAT3( 0.f, 1.f, 0.f ) );
+    probes.Schedule( MakeView(), objects, 1, MakeSettings( 6 ) );
+    CHECK( probes.GetUpdates().size() == 6 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( ReflectionProbes_ObjectLeavingAFaceMarksItPending )
+{
+    ReflectionProbes probes;
+    probes.AddProbe( XMFLOAT3( 0.f, 0.f, 0.f ), 1.f );
+
+    ReflectionProbes::Object object = MakeObject( 20.f, 0.f, 0.f, 1.f, false );
+    RenderAll( probes, &object, 1 );
+    CHECK( probes.GetStats().facesPending == 0 );
+
+    // From +X to +Y in one frame: +Y to draw it, and +X, where it is no
+    // longer but was last rendered, to draw it gone.
+    object = MakeObject( 0.f, 20.f, 0.f, 1.f, true );
+    probes.Schedule( MakeView(), &object, 1, MakeSettings( 6 ) );
+    CHECK( Picked( probes ) == std::vector<uint32_t>( { PosX, PosY } ) );
+    CHECK( DrawListOf( probes, 0, PosX ).empty() );
+    CHECK( DrawListOf( probes, 0, PosY ) == std::vector<uint32_t>( { 0 } ) );
+
+    // On a budget of one, the face left behind is still pending next frame,
+    // after +Z, which has waited longer.
+    object = MakeObject( 0.f, 0.f, 20.f, 1.f, true );
+    probes.Schedule( MakeView(), &object, 1, MakeSettings( 1 ) );
+    CHECK( probes.GetStats().facesPending == 2 );
+    CHECK( Picked( probes ) == std::vector<uint32_t>( { PosZ } ) );
+    CHECK( DrawListOf( probes, 0, PosZ ) == std::vector<uint32_t>( { 0 } ) );
+
+    object.moving = false;
+    probes.Schedule( MakeView(), &object, 1, MakeSettings( 1 ) );
+    CHECK( probes.GetStats().facesPending == 1 );
+    CHECK( Picked( probes ) == std::vector<uint32_t>( { PosY } ) );
+    CHECK( DrawListOf( probes, 0, PosY ).empty() );
+
+    probes.Schedule( MakeView(), &object, 1, MakeSettings( 1 ) );
+    CHECK( probes.GetStats().facesPending == 0 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( ReflectionProbes_OwnerIsNotDrawn )
+{
+    // The reflector sits on its probe, as big as it; something else is
+    // ahead on +X.
+    ReflectionProbes::Object objects[] = {
+        MakeObject( 0.f, 0.f, 0.f, 2.f, true ),
+        MakeObject( 20.f, 0.f, 0.f, 1.f, false )
+    };
+
+    ReflectionProbes probes;
+    probes.AddProbe( XMFLOAT3( 0.f, 0.f, 0.f ), 2.f, 0 );
+    probes.AddProbe( XMFLOAT3( 0.f, 0.f, 0.f ), 2.f );
+
+    probes.Schedule( MakeView(), objects, 2, MakeSettings( 12 ) );
+    CHECK( probes.GetUpdates().size() == 12 );
+
+    bool ownerLeftOut = true;
+    bool othersDrawn = true;
+    for ( uint32_t face = 0; face < ReflectionProbes::FaceCount; ++face ) {
+        const std::vector<uint32_t> owned = DrawListOf( probes, 0, face );
+        const std::vector<uint32_t> unowned = DrawListOf( probes, 1, face );
+        ownerLeftOut = ownerLeftOut && std::find( owned.begin(), owned.end(), 0u ) == owned.end();
+        othersDrawn = othersDrawn && std::find( unowned.begin(), unowned.end(), 0u ) != unowned.end();
+    }
+    CHECK( ownerLeftOut );
+    CHECK( othersDrawn );
+    CHECK( DrawListOf( probes, 0, PosX ) == std::vector<uint32_t>( { 1 } ) );
+
+    // The owner is neither drawn nor counted as culled.
+    CHECK( probes.GetStats().objectsDrawn == 1 + 7 );
+    CHECK( probes.GetStats().objectsCulled == 5 + 5 );
+
+    // The reflector moving does not dirty its own probe; it does the other.
+    probes.Schedule( MakeView(), objects, 2, MakeSettings( 12 ) );
+    CHECK( probes.GetUpdates().size() == 6 );
+    CHECK( probes.GetStats().facesClean == 6 );
+
+    bool onlyUnowned = true;
+    for ( const ReflectionProbes::FaceUpdate& update : probes.GetUpdates() ) {
+        onlyUnowned = onlyUnowned && update.probe == 1;
+    }
+    CHECK( onlyUnowned );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( ReflectionProbes_OffScreenProbesWait )
+{
+    // A box looking down +Z from z = 0 to 100, 20 wide and high.
+    const XMFLOAT4 ahead[6] = {
+        XMFLOAT4( 1.f, 0.f, 0.f, 10.f ),
+        XMFLOAT4( -1.f, 0.f, 0.f, 10.f ),
+        XMFLOAT4( 0.f, 1.f, 0.f, 10.f ),
+        XMFLOAT4( 0.f, -1.f, 0.f, 10.f ),
+        XMFLOAT4( 0.f, 0.f, 1.f, 0.f ),
+        XMFLOAT4( 0.f, 0.f, -1.f, 100.f )
+    };
+
+    // The same box turned round to look down -Z.
+    const XMFLOAT4 behind[6] = {
+        ahead[0], ahead[1], ahead[2], ahead[3],
+        XMFLOAT4( 0.f, 0.f, -1.f, 0.f ),
+        XMFLOAT4( 0.f, 0.f, 1.f, 100.f )
+    };
+
+    ReflectionProbes probes;
+    probes.AddProbe( XMFLOAT3( 0.f, 0.f, 50.f ), 1.f );
+    probes.AddProbe( XMFLOAT3( 0.f, 0.f, -50.f ), 1.f );
+
+    // A sphere just behind a plane by less than its radius is still seen.
+    CHECK( ReflectionProbes::ScreenArea( MakeView( ahead ), XMFLOAT3( 0.f, 10.5f, 50.f ), 1.f ) > 0.f );
+    CHECK( ReflectionProbes::ScreenArea( MakeView( ahead ), XMFLOAT3( 0.f, 11.5f, 50.f ), 1.f ) == 0.f );
+
+    // Only the probe in view is updated, however much budget is left; the
+    // other's faces stay pending.
+    probes.Schedule( MakeView( ahead ), nullptr, 0, MakeSettings( 12 ) );
+    CHECK( Picked( probes ) == std::vector<uint32_t>( { 0, 1, 2, 3, 4, 5 } ) );
+    CHECK( probes.GetPriority( 0 ) > 0.f && probes.GetPriority( 1 ) == 0.f );
+    CHECK( probes.GetStats().facesPending == 12 );
+
+    for ( int frame = 0; frame < 3; ++frame ) {
+        probes.Schedule( MakeView( ahead ), nullptr, 0, MakeSettings( 12 ) );
+        CHECK( probes.GetUpdates().empty() );
+        CHECK( probes.GetStats().facesPending == 6 && probes.GetStats().facesClean == 6 );
+    }
+
+    // Turning round brings it into view, and it is caught up.
+    probes.Schedule( MakeView( behind ), nullptr, 0, MakeSettings( 12 ) );
+    CHECK( Picked( probes ) == std::vector<uint32_t>( { 6, 7, 8, 9, 10, 11 } ) );
+    CHECK( probes.GetPriority( 0 ) == 0.f && probes.GetPriority( 1 ) > 0.f );
+
+    // An off-screen probe's faces are not handed out even when something
+    // moves in them, and a new set of objects dirties all of them.
+    const ReflectionProbes::Object passing = MakeObject( 0.f, 0.f, 60.f, 1.f, true );
+    probes.Schedule( MakeView( behind ), &passing, 1, MakeSettings( 12 ) );
+    CHECK( Picked( probes ) == std::vector<uint32_t>( { 6, 7, 8, 9, 10, 11 } ) );
+    probes.Schedule( MakeView( behind ), &passing, 1, MakeSettings( 12 ) );
+    CHECK( Picked( probes ) == std::vector<uint32_t>( { 6 + PosZ } ) );
+    CHECK( probes.GetStats().facesPending == 6 + 1 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
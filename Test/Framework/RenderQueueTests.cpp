@@ -0,0 +1,329 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file RenderQueueTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "RenderQueue.h"
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // Stand-ins for device objects; only their addresses matter.
+    char Layouts[2];
+    char VertexBuffers[3];
+    char InstanceBuffers[2];
+    char IndexBuffers[2];
+    char RasterizerStates[2];
+    char BlendStates[2];
+    char DepthStencilStates[2];
+
+    const unsigned int Triangles = 4;   // D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST
+    const unsigned int Lines = 2;       // D3D11_PRIMITIVE_TOPOLOGY_LINELIST
+    const unsigned int Index16 = 57;    // DXGI_FORMAT_R16_UINT
+    const unsigned int Index32 = 42;    // DXGI_FORMAT_R32_UINT
+
+    // A slot of the pipeline as the replay saw it; set is false until the
+    // log first binds it, so a bound null is told apart from nothing bound.
+    struct Slot {
+        Slot( void ) : handle( nullptr ), value( 0 ), set( false ) { }
+
+        void Bind( const void* h, const unsigned int v )
+        {
+            handle = h;
+            value = v;
+            set = true;
+        }
+
+        bool Is( const void* h, const unsigned int v ) const
+        {
+            return set && handle == h && value == v;
+        }
+
+        const void* handle;
+        unsigned int value;
+        bool set;
+    };
+
+    // Replays a log and checks each draw ran with the state its item asks
+    // for. draws receives the items in the order they were drawn.
+    bool ReplayMatches( const RenderCommandLog& log, std::vector<const RenderItem*>& draws )
+    {
+        Slot topology, layout, vertexBuffer, instanceBuffer, indexBuffer, rasterizer, blend, depthStencil;
+
+        bool matches = true;
+        draws.clear();
+        for ( const RenderCommandLog::Command& command : log.GetCommands() ) {
+            switch ( command.type ) {
+            case RenderCommandLog::Topology:          topology.Bind( nullptr, command.value ); break;
+            case RenderCommandLog::InputLayout:       layout.Bind( command.handle, 0 ); break;
+            case RenderCommandLog::VertexBuffer:      vertexBuffer.Bind( command.handle, command.value ); break;
+            case RenderCommandLog::InstanceBuffer:    instanceBuffer.Bind( command.handle, command.value ); break;
+            case RenderCommandLog::IndexBuffer:       indexBuffer.Bind( command.handle, command.value ); break;
+            case RenderCommandLog::RasterizerState:   rasterizer.Bind( command.handle, 0 ); break;
+            case RenderCommandLog::BlendState:        blend.Bind( command.handle, 0 ); break;
+            case RenderCommandLog::DepthStencilState: depthStencil.Bind( command.handle, command.value ); break;
+
+            case RenderCommandLog::DrawItem: {
+                const RenderItem& item = *command.item;
+                matches = matches &&
+                          topology.Is( nullptr, item.topology ) &&
+                          layout.Is( item.inputLayout, 0 ) &&
+                          vertexBuffer.Is( item.vertexBuffer, item.vertexStride ) &&
+                          indexBuffer.Is( item.indexBuffer, item.indexFormat ) &&
+                          rasterizer.Is( item.rasterizerState, 0 ) &&
+                          blend.Is( item.blendState, 0 ) &&
+                          depthStencil.Is( item.depthStencilState, item.stencilRef ) &&
+                          ( item.instanceCount == 0 || instanceBuffer.Is( item.instanceBuffer, item.instanceStride ) );
+                draws.push_back( &item );
+                break;
+            }
+            }
+        }
+        return matches;
+    }
+
+    // Setter calls a minimal backend needs for items drawn in this order,
+    // starting from nothing bound, counted without the queue's bookkeeping.
+    size_t CountChanges( const std::vector<const RenderItem*>& draws )
+    {
+        size_t changes = 0;
+        const RenderItem* previous = nullptr;
+        const RenderItem* previousInstanced = nullptr;
+        for ( const RenderItem* item : draws ) {
+            if ( !previous ) {
+                changes += 7;
+            } else {
+                changes += item->topology != previous->topology ? 1 : 0;
+                changes += item->inputLayout != previous->inputLayout ? 1 : 0;
+                changes += item->vertexBuffer != previous->vertexBuffer || item->vertexStride != previous->vertexStride ? 1 : 0;
+                changes += item->indexBuffer != previous->indexBuffer || item->indexFormat != previous->indexFormat ? 1 : 0;
+                changes += item->rasterizerState != previous->rasterizerState ? 1 : 0;
+                changes += item->blendState != previous->blendState ? 1 : 0;
+                changes += item->depthStencilState != previous->depthStencilState || item->stencilRef != previous->stencilRef ? 1 : 0;
+            }
+            if ( item->instanceCount > 0 ) {
+                changes += !previousInstanced || item->instanceBuffer != previousInstanced->instanceBuffer ||
+                           item->instanceStride != previousInstanced->instanceStride ? 1 : 0;
+                previousInstanced = item;
+            }
+            previous = item;
+        }
+        return changes;
+    }
+
+    // Setters Execute() considers per draw.
+    size_t CountSetters( const std::vector<const RenderItem*>& draws )
+    {
+        size_t setters = 0;
+        for ( const RenderItem* item : draws ) {
+            setters += item->instanceCount > 0 ? 8 : 7;
+        }
+        return setters;
+    }
+
+    RenderItem MakeItem( const unsigned int mesh, const unsigned int state )
+    {
+        RenderItem item;
+        item.topology = Triangles;
+        item.inputLayout = &Layouts[0];
+        item.vertexBuffer = &VertexBuffers[mesh % 3];
+        item.vertexStride = 32;
+        item.indexBuffer = &IndexBuffers[mesh % 2];
+        item.indexFormat = Index32;
+        item.rasterizerState = ( state & 1 ) ? &RasterizerStates[1] : nullptr;
+        item.blendState = ( state & 2 ) ? &BlendStates[1] : nullptr;
+        item.depthStencilState = ( state & 4 ) ? &DepthStencilStates[1] : nullptr;
+        item.stencilRef = ( state & 4 ) ? 1 : 0;
+        item.indexCount = 36;
+        return item;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( RenderQueue_BindsOnlyWhatChanges )
+{
+    // Three draws: the second only changes the blend state, the third only
+    // the vertex buffer (and its stride).
+    RenderItem a = MakeItem( 0, 0 );
+    RenderItem b = a;
+    b.blendState = &BlendStates[1];
+    RenderItem c = b;
+    c.vertexBuffer = &VertexBuffers[2];
+    c.vertexStride = 44;
+
+    RenderQueue queue;
+    queue.Submit( RenderQueue::MakeKey( 1, 0, 0, 0, 2, 0 ), c );
+    queue.Submit( RenderQueue::MakeKey( 1, 0, 0, 0, 0, 0 ), a );
+    queue.Submit( RenderQueue::MakeKey( 1, 0, 0, 0, 1, 0 ), b );
+    queue.Sort( nullptr );
+
+    RenderCommandLog log;
+    queue.Execute( log );
+
+    const std::vector<RenderCommandLog::Command>& commands = log.GetCommands();
+    CHECK( commands.size() == 7 + 1 + 1 + 1 + 1 + 1 );
+
+    // Everything for the first draw, in the order Execute() binds it.
+    const RenderCommandLog::Type first[] = {
+        RenderCommandLog::Topology, RenderCommandLog::InputLayout, RenderCommandLog::VertexBuffer,
+        RenderCommandLog::IndexBuffer, RenderCommandLog::RasterizerState, RenderCommandLog::BlendState,
+        RenderCommandLog::DepthStencilState, RenderCommandLog::DrawItem
+    };
+    bool inOrder = true;
+    for ( size_t i = 0; i < 8; ++i ) {
+        inOrder = inOrder && commands[i].type == first[i];
+    }
+    CHECK( inOrder );
+
+    // Nulls are bound too: they mean the device default, not "unknown".
+    CHECK( commands[4].handle == nullptr && commands[5].handle == nullptr );
+
+    CHECK( commands[8].type == RenderCommandLog::BlendState && commands[8].handle == &BlendStates[1] );
+    CHECK( commands[9].type == RenderCommandLog::DrawItem && commands[9].item->blendState == &BlendStates[1] );
+    CHECK( commands[10].type == RenderCommandLog::VertexBuffer && commands[10].handle == &VertexBuffers[2] &&
+           commands[10].value == 44 );
+    CHECK( commands[11].type == RenderCommandLog::DrawItem );
+
+    const RenderQueue::Stats& stats = queue.GetStats();
+    CHECK( stats.draws == 3 );
+    CHECK( stats.stateChanges == 9 && stats.stateChanges == log.GetStateChangeCount() );
+    CHECK( stats.redundantStates == 3 * 7 - 9 );
+
+    std::vector<const RenderItem*> draws;
+    CHECK( ReplayMatches( log, draws ) );
+    CHECK( draws.size() == 3 && draws[0]->blendState == nullptr && draws[2]->vertexStride == 44 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( RenderQueue_ReplayedStateMatchesEachDraw )
+{
+    // Draws over a handful of shared and distinct resources, some instanced,
+    // keyed the way a demo would key them.
+    std::mt19937 rng( 42 );
+    std::uniform_int_distribution<unsigned int> pick( 0, 1023 );
+
+    const size_t count = 500;
+    std::vector<unsigned int> submitted( count );
+
+    RenderQueue queue;
+    for ( size_t i = 0; i < count; ++i ) {
+        const unsigned int pass = pick( rng ) % 3;
+        const unsigned int technique = pick( rng ) % 2;
+        const unsigned int state = pick( rng ) % 8;
+        const unsigned int mesh = pick( rng ) % 6;
+        const unsigned int depth = pick( rng );
+
+        RenderItem item = MakeItem( mesh, state );
+        item.topology = technique ? Lines : Triangles;
+        item.inputLayout = &Layouts[technique];
+        item.indexFormat = ( mesh % 2 ) ? Index16 : Index32;
+        if ( pick( rng ) % 4 == 0 ) {
+            item.instanceBuffer = &InstanceBuffers[mesh % 2];
+            item.instanceStride = 64;
+            item.instanceCount = 10;
+        }
+
+        // object tells draws apart, and where each was submitted.
+        submitted[i] = static_cast<unsigned int>( i );
+        item.object = &submitted[i];
+
+        queue.Submit( RenderQueue::MakeKey( pass, technique, state, 0, mesh, depth % 4 ), item );
+    }
+    queue.Sort( nullptr );
+
+    RenderCommandLog log;
+    queue.Execute( log );
+
+    std::vector<const RenderItem*> draws;
+    CHECK( ReplayMatches( log, draws ) );
+    CHECK( draws.size() == count );
+
+    // Drawn in key order, submission order among equal keys, and exactly
+    // the items the queue lists.
+    bool sorted = true;
+    for ( size_t i = 0; i < draws.size(); ++i ) {
+        sorted = sorted && draws[i] == &queue.GetItem( i );
+        if ( i > 0 ) {
+            const unsigned int before = *static_cast<const unsigned int*>( draws[i - 1]->object );
+            const unsigned int after = *static_cast<const unsigned int*>( draws[i]->object );
+            sorted = sorted && ( queue.GetKey( i - 1 ) < queue.GetKey( i ) ||
+                                 ( queue.GetKey( i - 1 ) == queue.GetKey( i ) && before < after ) );
+        }
+    }
+    CHECK( sorted );
+
+    // No setter call more and none less than the order needs.
+    const RenderQueue::Stats& stats = queue.GetStats();
+    CHECK( stats.draws == count );
+    CHECK( stats.stateChanges == log.GetStateChangeCount() );
+    CHECK( stats.stateChanges == CountChanges( draws ) );
+    CHECK( stats.stateChanges + stats.redundantStates == CountSetters( draws ) );
+
+    // Sorting is what makes the draws share state.
+    std::shuffle( submitted.begin(), submitted.end(), rng );
+    RenderQueue shuffled;
+    for ( size_t i = 0; i < count; ++i ) {
+        shuffled.Submit( 0, *draws[submitted[i]] );
+    }
+    RenderCommandLog shuffledLog;
+    shuffled.Execute( shuffledLog );
+    CHECK( shuffled.GetStats().stateChanges > stats.stateChanges );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( RenderQueue_ClearAndInvalidateForceRebind )
+{
+    RenderQueue queue;
+    for ( unsigned int i = 0; i < 12; ++i ) {
+        queue.Submit( RenderQueue::MakeKey( 0, 0, i % 4, 0, i % 3, 0 ), MakeItem( i % 3, i % 4 ) );
+    }
+    queue.Sort( nullptr );
+
+    RenderCommandLog log;
+    queue.Execute( log );
+    const size_t firstChanges = queue.GetStats().stateChanges;
+    CHECK( firstChanges == log.GetStateChangeCount() );
+
+    std::vector<const RenderItem*> draws;
+    CHECK( ReplayMatches( log, draws ) );
+
+    // Executed again, the last draw's state is assumed still bound: the
+    // first draw only rebinds what differs from the last one.
+    log.Clear();
+    queue.Execute( log );
+    const RenderItem& last = queue.GetItem( queue.GetSize() - 1 );
+    std::vector<const RenderItem*> again( 1, &last );
+    again.insert( again.end(), draws.begin(), draws.end() );
+    CHECK( queue.GetStats().stateChanges == CountChanges( again ) - 7 );
+    CHECK( queue.GetStats().stateChanges < firstChanges );
+
+    // After InvalidateState() nothing is assumed: the first draw binds
+    // everything again, and the log replays correctly on its own.
+    queue.InvalidateState();
+    log.Clear();
+    queue.Execute( log );
+    CHECK( queue.GetStats().stateChanges == firstChanges );
+    CHECK( ReplayMatches( log, draws ) );
+
+    // Clear() forgets the bound state as well as the draws.
+    queue.Clear();
+    CHECK( queue.GetSize() == 0 );
+    CHECK( queue.GetStats().draws == 0 && queue.GetStats().stateChanges == 0 );
+    queue.Submit( 0, MakeItem( 0, 0 ) );
+    log.Clear();
+    queue.Execute( log );
+    CHECK( queue.GetStats().stateChanges == 7 && queue.GetStats().redundantStates == 0 );
+    CHECK( ReplayMatches( log, draws ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,213 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file TessellationFactorsTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+
+#include <DirectXMath.h>
+
+#include "TessellationFactors.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // An N x N grid of bicubic patches over a wavy height field, sharing
+    // their boundary control points: the control net is ( 3N + 1 )^2.
+    const int GridPatches = 8;
+    const int NetSize = 3 * GridPatches + 1;
+
+    struct PatchGrid {
+        XMFLOAT3 controlPoints[GridPatches * GridPatches][16];
+    };
+
+    void MakeGrid( PatchGrid& grid )
+    {
+        const float spacing = 2.f;
+        for ( int i = 0; i < GridPatches; ++i ) {
+            for ( int j = 0; j < GridPatches; ++j ) {
+                for ( int v = 0; v < 4; ++v ) {
+                    for ( int u = 0; u < 4; ++u ) {
+                        const float x = ( 3 * j + u ) * spacing - NetSize;
+                        const float z = ( 3 * i + v ) * spacing - NetSize;
+                        const float y = 3.f * std::sin( 0.3f * x ) * std::cos( 0.2f * z );
+                        grid.controlPoints[i * GridPatches + j][v * 4 + u] = XMFLOAT3( x, y, z );
+                    }
+                }
+            }
+        }
+    }
+
+    TessellationFactors::View MakeView( const XMFLOAT3& eye )
+    {
+        TessellationFactors::View view;
+        view.eye = eye;
+        view.pixelScale = 0.5f * 1080.f * 2.414f;
+        view.frustumPlanes = nullptr;
+        return view;
+    }
+
+    const XMFLOAT3 Eyes[] = {
+        XMFLOAT3( 0.f, 10.f, -30.f ),
+        XMFLOAT3( 5.f, 2.f, 3.f ),
+        XMFLOAT3( -40.f, 60.f, 10.f ),
+        XMFLOAT3( 0.f, -5.f, 0.f ),
+    };
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( TessellationFactors_SharedEdgesGetMatchingFactors )
+{
+    static PatchGrid grid;
+    MakeGrid( grid );
+
+    TessellationFactors factors;
+    for ( int p = 0; p < GridPatches * GridPatches; ++p ) {
+        CHECK( factors.AddBezierPatch( grid.controlPoints[p] ) == uint32_t( p ) );
+    }
+
+    // Each shared edge is stored once.
+    CHECK( factors.GetEdgeCount() == size_t( 2 * GridPatches * ( GridPatches + 1 ) ) );
+
+    const TessellationFactors::Settings settings;
+    for ( const XMFLOAT3& eye : Eyes ) {
+        factors.Compute( MakeView( eye ), settings );
+        const auto& F = factors.GetFactors();
+
+        for ( int i = 0; i < GridPatches; ++i ) {
+            for ( int j = 0; j < GridPatches; ++j ) {
+                const TessellationFactors::PatchFactors& f = F[i * GridPatches + j];
+
+                for ( int e = 0; e < 4; ++e ) {
+                    CHECK( f.edges[e] >= settings.minFactor && f.edges[e] <= settings.maxFactor );
+                }
+                CHECK( f.inside[0] >= std::max( f.edges[1], f.edges[3] ) );
+                CHECK( f.inside[1] >= std::max( f.edges[0], f.edges[2] ) );
+
+                // Bit for bit: our u = 1 edge is the next patch's u = 0, and
+                // our v = 1 edge the next row's v = 0.
+                if ( j + 1 < GridPatches ) {
+                    CHECK( f.edges[2] == F[i * GridPatches + j + 1].edges[0] );
+                }
+                if ( i + 1 < GridPatches ) {
+                    CHECK( f.edges[3] == F[( i + 1 ) * GridPatches + j].edges[1] );
+                }
+            }
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( TessellationFactors_SharedEdgesMatchWhateverTheOrientation )
+{
+    static PatchGrid grid;
+    MakeGrid( grid );
+
+    // Every patch mirrored in u, added last to first: each edge is now met
+    // from the other end, and u = 0 and u = 1 trade places.
+    TessellationFactors factors;
+    for ( int p = GridPatches * GridPatches - 1; p >= 0; --p ) {
+        XMFLOAT3 mirrored[16];
+        for ( int v = 0; v < 4; ++v ) {
+            for ( int u = 0; u < 4; ++u ) {
+                mirrored[v * 4 + u] = grid.controlPoints[p][v * 4 + ( 3 - u )];
+            }
+        }
+        factors.AddBezierPatch( mirrored );
+    }
+
+    CHECK( factors.GetEdgeCount() == size_t( 2 * GridPatches * ( GridPatches + 1 ) ) );
+
+    const TessellationFactors::Settings settings;
+    for ( const XMFLOAT3& eye : Eyes ) {
+        factors.Compute( MakeView( eye ), settings );
+        const auto& F = factors.GetFactors();
+
+        // Patch ( i, j ) was added as index N^2 - 1 - ( i N + j ).
+        auto at = [&]( const int i, const int j ) -> const TessellationFactors::PatchFactors& {
+            return F[GridPatches * GridPatches - 1 - ( i * GridPatches + j )];
+        };
+
+        for ( int i = 0; i < GridPatches; ++i ) {
+            for ( int j = 0; j < GridPatches; ++j ) {
+                // Mirrored, the right hand neighbour's shared edge is its
+                // u = 1 and ours is u = 0.
+                if ( j + 1 < GridPatches ) {
+                    CHECK( at( i, j ).edges[0] == at( i, j + 1 ).edges[2] );
+                }
+                if ( i + 1 < GridPatches ) {
+                    CHECK( at( i, j ).edges[3] == at( i + 1, j ).edges[1] );
+                }
+            }
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( TessellationFactors_SharedEdgesOfPlainQuadsMatch )
+{
+    // Two quads sharing the edge from ( 1, 0, 0 ) to ( 1, 0, 1 ) with
+    // different interiors; the second gives the shared edge a different
+    // deviation, which is ignored since the edge is already known.
+    const XMFLOAT3 left[4] = {
+        XMFLOAT3( 0.f, 0.f, 0.f ), XMFLOAT3( 1.f, 0.f, 0.f ), XMFLOAT3( 0.f, 0.f, 1.f ), XMFLOAT3( 1.f, 0.f, 1.f ),
+    };
+    const XMFLOAT3 right[4] = {
+        XMFLOAT3( 1.f, 0.f, 0.f ), XMFLOAT3( 3.f, 0.f, 0.f ), XMFLOAT3( 1.f, 0.f, 1.f ), XMFLOAT3( 3.f, 0.f, 1.f ),
+    };
+    const float leftDeviation[4] = { 0.f, 0.f, 0.2f, 0.f };
+    const float rightDeviation[4] = { 0.5f, 0.1f, 0.f, 0.1f };
+
+    TessellationFactors factors;
+    factors.AddPatch( left, leftDeviation, 0.1f, XMFLOAT3( 0.f, -0.2f, 0.f ), XMFLOAT3( 1.f, 0.2f, 1.f ) );
+    factors.AddPatch( right, rightDeviation, 0.3f, XMFLOAT3( 1.f, -0.5f, 0.f ), XMFLOAT3( 3.f, 0.5f, 1.f ) );
+    CHECK( factors.GetEdgeCount() == 7 );
+
+    const TessellationFactors::Settings settings;
+    for ( const XMFLOAT3& eye : Eyes ) {
+        factors.Compute( MakeView( eye ), settings );
+        CHECK( factors.GetFactors()[0].edges[2] == factors.GetFactors()[1].edges[0] );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( TessellationFactors_FlatPatchesStayCoarse )
+{
+    XMFLOAT3 controlPoints[16];
+    for ( int v = 0; v < 4; ++v ) {
+        for ( int u = 0; u < 4; ++u ) {
+            controlPoints[v * 4 + u] = XMFLOAT3( u * 3.f, 0.f, v * 3.f );
+        }
+    }
+
+    TessellationFactors factors;
+    factors.AddBezierPatch( controlPoints );
+
+    // However close the eye is.
+    TessellationFactors::View view = MakeView( XMFLOAT3( 4.f, 0.5f, 4.f ) );
+    const TessellationFactors::Settings settings;
+    factors.Compute( view, settings );
+
+    const TessellationFactors::PatchFactors& f = factors.GetFactors()[0];
+    for ( int e = 0; e < 4; ++e ) {
+        CHECK( f.edges[e] == 1.f );
+    }
+    CHECK( f.inside[0] == 1.f && f.inside[1] == 1.f );
+
+    // By length alone it is as fine as allowed.
+    TessellationFactors::Settings lengthOnly;
+    lengthOnly.maxErrorPixels = 0.f;
+    factors.Compute( view, lengthOnly );
+    CHECK( factors.GetFactors()[0].edges[0] == lengthOnly.maxFactor );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
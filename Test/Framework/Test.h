@@ -0,0 +1,74 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file Test.h
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#pragma once
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+///<summary>
+/// Just enough of a test harness for the Framework's headless code. Files
+/// define cases with TEST_CASE or BENCHMARK, which register themselves
+/// before main() runs; CHECK and CHECK_NEAR record a failure and keep going.
+///
+/// Benchmarks only run when asked for (-bench) since they take a while and
+/// their numbers mean nothing in a Debug build.
+///</summary>
+namespace Test {
+
+    typedef void ( *Function )( void );
+
+    struct Case {
+        const char* name;
+        Function function;
+        bool benchmark;
+    };
+
+    std::vector<Case>& Registry( void );
+
+    struct Registrar {
+        Registrar( const char* name, Function function, bool benchmark );
+    };
+
+    void Fail( const char* file, const int line, const char* expression );
+
+    // Failures recorded by the case that is running.
+    int FailureCount( void );
+
+    // Wall time of fn() in milliseconds.
+    template <typename Fn>
+    double TimeMs( Fn fn )
+    {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>( stop - start ).count();
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#define TEST_REGISTER( name, benchmark ) \
+    static void name( void ); \
+    static Test::Registrar name##Registrar( #name, name, benchmark ); \
+    static void name( void )
+
+#define TEST_CASE( name ) TEST_REGISTER( name, false )
+#define BENCHMARK( name ) TEST_REGISTER( name, true )
+
+#define CHECK( expression ) \
+    ( ( expression ) ? (void)0 : Test::Fail( __FILE__, __LINE__, #expression ) )
+
+#define CHECK_NEAR( actual, expected, tolerance ) \
+    ( std::fabs( ( actual ) - ( expected ) ) <= ( tolerance ) ? (void)0 \
+        : Test::Fail( __FILE__, __LINE__, #actual " ~= " #expected ) )
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,212 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file TextureArrayBuilderTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "JobSystem.h"
+#include "TextureArrayBuilder.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    const size_t PixelOffset = sizeof( uint32_t ) + sizeof( DDS_HEADER ) + sizeof( DDS_HEADER_DXT10 );
+
+    // An in-memory DDS file with a DX10 header. The pixel bytes carry seed,
+    // so the layers differ.
+    std::vector<uint8_t> MakeDDS( const uint32_t width, const uint32_t height, const uint32_t mips,
+                                  const DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM,
+                                  const uint32_t arraySize = 1, const uint8_t seed = 0 )
+    {
+        size_t pixelBytes = 0;
+        for ( uint32_t mip = 0; mip < mips; ++mip ) {
+            size_t bytes = 0;
+            DDS::GetSurfaceInfo( std::max( width >> mip, 1u ), std::max( height >> mip, 1u ), format,
+                                 &bytes, nullptr, nullptr );
+            pixelBytes += bytes;
+        }
+
+        std::vector<uint8_t> file( PixelOffset + pixelBytes * arraySize );
+
+        DDS_HEADER header = {};
+        header.size = sizeof( DDS_HEADER );
+        header.flags = DDS_WIDTH | DDS_HEIGHT;
+        header.width = width;
+        header.height = height;
+        header.mipMapCount = mips;
+        header.ddspf.size = sizeof( DDS_PIXELFORMAT );
+        header.ddspf.flags = DDS_FOURCC;
+        header.ddspf.fourCC = MAKEFOURCC( 'D', 'X', '1', '0' );
+
+        DDS_HEADER_DXT10 extension = {};
+        extension.dxgiFormat = format;
+        extension.resourceDimension = DDS::RESOURCE_DIMENSION_TEXTURE2D;
+        extension.arraySize = arraySize;
+
+        std::memcpy( file.data(), &DDS_MAGIC, sizeof( uint32_t ) );
+        std::memcpy( file.data() + sizeof( uint32_t ), &header, sizeof( header ) );
+        std::memcpy( file.data() + sizeof( uint32_t ) + sizeof( DDS_HEADER ), &extension, sizeof( extension ) );
+        for ( size_t i = PixelOffset; i < file.size(); ++i ) {
+            file[i] = static_cast<uint8_t>( i + seed );
+        }
+        return file;
+    }
+
+    bool SameSubresource( const DDS::Subresource& a, const DDS::Subresource& b )
+    {
+        return a.data == b.data && a.rowPitch == b.rowPitch && a.slicePitch == b.slicePitch &&
+               a.width == b.width && a.height == b.height && a.depth == b.depth;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( TextureArrayBuilder_SubresourcesAreLayerMajor )
+{
+    const uint32_t mips = 5;
+    std::vector<std::vector<uint8_t>> files;
+    for ( uint8_t layer = 0; layer < 3; ++layer ) {
+        files.push_back( MakeDDS( 32, 16, mips, DXGI_FORMAT_R8G8B8A8_UNORM, 1, layer ) );
+    }
+
+    TextureArrayBuilder builder;
+    for ( const auto& file : files ) {
+        builder.AddMemory( file.data(), file.size() );
+    }
+    CHECK( builder.Build( nullptr ) == TextureArrayBuilder::Ok );
+    CHECK( builder.GetWidth() == 32 && builder.GetHeight() == 16 );
+    CHECK( builder.GetMipLevels() == mips && builder.GetArraySize() == 3 );
+    CHECK( builder.GetFormat() == DXGI_FORMAT_R8G8B8A8_UNORM );
+
+    // D3D11CalcSubresource( mip, layer, mips ): all mips of layer 0, then of
+    // layer 1, each pointing into its own file.
+    const std::vector<DDS::Subresource>& subresources = builder.GetSubresources();
+    CHECK( subresources.size() == 3 * mips );
+
+    bool ordered = true;
+    for ( size_t layer = 0; layer < 3; ++layer ) {
+        const uint8_t* expected = files[layer].data() + PixelOffset;
+        for ( size_t mip = 0; mip < mips; ++mip ) {
+            const DDS::Subresource& sub = subresources[layer * mips + mip];
+            const size_t width = 32 >> mip;
+            const size_t height = std::max<size_t>( 16 >> mip, 1 );
+            ordered = ordered && sub.data == expected && sub.width == width && sub.height == height &&
+                      sub.rowPitch == width * 4 && sub.slicePitch == width * 4 * height;
+            expected += sub.slicePitch;
+        }
+        ordered = ordered && expected == files[layer].data() + files[layer].size();
+    }
+    CHECK( ordered );
+
+    // More layers can be added and the table built again.
+    const std::vector<uint8_t> extra = MakeDDS( 32, 16, mips, DXGI_FORMAT_R8G8B8A8_UNORM, 1, 3 );
+    builder.AddMemory( extra.data(), extra.size() );
+    CHECK( builder.Build( nullptr ) == TextureArrayBuilder::Ok );
+    CHECK( builder.GetArraySize() == 4 && builder.GetSubresources().size() == 4 * mips );
+    CHECK( builder.GetSubresources()[3 * mips].data == extra.data() + PixelOffset );
+
+    builder.Clear();
+    CHECK( builder.Build( nullptr ) == TextureArrayBuilder::NoLayers );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( TextureArrayBuilder_RejectsMismatchedLayers )
+{
+    const std::vector<uint8_t> base = MakeDDS( 16, 16, 5 );
+    const std::vector<uint8_t> bc1 = MakeDDS( 16, 16, 5, DXGI_FORMAT_BC1_UNORM );
+    const std::vector<uint8_t> fewerMips = MakeDDS( 16, 16, 3 );
+    const std::vector<uint8_t> smaller = MakeDDS( 16, 8, 5 );
+    const std::vector<uint8_t> array = MakeDDS( 16, 16, 5, DXGI_FORMAT_R8G8B8A8_UNORM, 2 );
+
+    struct Case {
+        const std::vector<uint8_t>* file;
+        size_t size;
+        TextureArrayBuilder::Status status;
+    };
+    const Case cases[] = {
+        { &bc1, bc1.size(), TextureArrayBuilder::FormatMismatch },
+        { &fewerMips, fewerMips.size(), TextureArrayBuilder::MipCountMismatch },
+        { &smaller, smaller.size(), TextureArrayBuilder::SizeMismatch },
+        { &array, array.size(), TextureArrayBuilder::NotTexture2D },
+        { &base, base.size() - 1, TextureArrayBuilder::ParseFailed }
+    };
+
+    for ( const Case& c : cases ) {
+        // The odd layer out is the third of four.
+        TextureArrayBuilder builder;
+        builder.AddMemory( base.data(), base.size() );
+        builder.AddMemory( base.data(), base.size() );
+        builder.AddMemory( c.file->data(), c.size );
+        builder.AddMemory( base.data(), base.size() );
+
+        CHECK( builder.Build( nullptr ) == c.status );
+        CHECK( builder.GetFailedLayer() == 2 );
+
+        // Nothing of the failed build is left to create a texture from.
+        CHECK( builder.GetSubresources().empty() );
+        CHECK( builder.GetArraySize() == 0 && builder.GetMipLevels() == 0 );
+        CHECK( builder.GetFormat() == DXGI_FORMAT_UNKNOWN );
+    }
+
+    TextureArrayBuilder missing;
+    missing.AddMemory( base.data(), base.size() );
+    missing.AddFile( L"TextureArrayBuilderTests.missing.dds" );
+    CHECK( missing.Build( nullptr ) == TextureArrayBuilder::OpenFailed );
+    CHECK( missing.GetFailedLayer() == 1 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( TextureArrayBuilder_ParallelMatchesSerial )
+{
+    std::vector<std::vector<uint8_t>> files;
+    for ( uint8_t layer = 0; layer < 64; ++layer ) {
+        files.push_back( MakeDDS( 64, 32, 7, DXGI_FORMAT_BC3_UNORM, 1, layer ) );
+    }
+
+    TextureArrayBuilder serial;
+    TextureArrayBuilder parallel;
+    for ( const auto& file : files ) {
+        serial.AddMemory( file.data(), file.size() );
+        parallel.AddMemory( file.data(), file.size() );
+    }
+
+    JobSystem jobs( 3 );
+    CHECK( serial.Build( nullptr ) == TextureArrayBuilder::Ok );
+    CHECK( parallel.Build( &jobs ) == TextureArrayBuilder::Ok );
+
+    CHECK( parallel.GetWidth() == serial.GetWidth() && parallel.GetHeight() == serial.GetHeight() );
+    CHECK( parallel.GetMipLevels() == serial.GetMipLevels() );
+    CHECK( parallel.GetArraySize() == serial.GetArraySize() && parallel.GetArraySize() == 64 );
+    CHECK( parallel.GetFormat() == serial.GetFormat() );
+
+    const std::vector<DDS::Subresource>& a = serial.GetSubresources();
+    const std::vector<DDS::Subresource>& b = parallel.GetSubresources();
+    CHECK( a.size() == 64 * 7 && a.size() == b.size() );
+
+    bool same = a.size() == b.size();
+    for ( size_t i = 0; same && i < a.size(); ++i ) {
+        same = SameSubresource( a[i], b[i] );
+    }
+    CHECK( same );
+
+    // A bad layer is reported the same way either way.
+    const std::vector<uint8_t> bad = MakeDDS( 64, 32, 7 );
+    serial.AddMemory( bad.data(), bad.size() );
+    parallel.AddMemory( bad.data(), bad.size() );
+    CHECK( serial.Build( nullptr ) == TextureArrayBuilder::FormatMismatch );
+    CHECK( parallel.Build( &jobs ) == TextureArrayBuilder::FormatMismatch );
+    CHECK( serial.GetFailedLayer() == 64 && parallel.GetFailedLayer() == 64 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
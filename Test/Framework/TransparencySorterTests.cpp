@@ -0,0 +1,275 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file TransparencySorterTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <random>
+
+#include <DirectXMath.h>
+
+#include "JobSystem.h"
+#include "TransparencySorter.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    // The Blend demo's camera, looking at the origin.
+    const XMFLOAT3 Eye( 30.f, 20.f, -40.f );
+
+    XMMATRIX DemoView( void )
+    {
+        return XMMatrixLookAtLH( XMLoadFloat3( &Eye ), XMVectorZero(), XMVectorSet( 0.f, 1.f, 0.f, 0.f ) );
+    }
+
+    float ViewDepth( const XMFLOAT4X4& view, const XMFLOAT3& p )
+    {
+        return p.x * view( 0, 2 ) + p.y * view( 1, 2 ) + p.z * view( 2, 2 ) + view( 3, 2 );
+    }
+
+    // Handles only compared by address.
+    int gObjects[4];
+    int gIndexBuffer;
+    int gBlendState;
+
+    RenderItem MakeStrip( const unsigned int first, const int object )
+    {
+        RenderItem item;
+        item.object = &gObjects[object];
+        item.indexBuffer = &gIndexBuffer;
+        item.blendState = &gBlendState;
+        item.startIndex = first * 6;
+        item.indexCount = 6;
+        return item;
+    }
+
+    // A rolling grid like the Waves demo's, two triangles a cell.
+    void MakeWaves( const int n, std::vector<XMFLOAT3>& positions, std::vector<uint32_t>& indices )
+    {
+        positions.resize( n * n );
+        for ( int i = 0; i < n; ++i ) {
+            for ( int j = 0; j < n; ++j ) {
+                const float y = 2.f * std::sin( i * 0.3f ) * std::cos( j * 0.2f );
+                positions[i * n + j] = XMFLOAT3( j - 0.5f * n, y, i - 0.5f * n );
+            }
+        }
+
+        indices.clear();
+        for ( int i = 0; i + 1 < n; ++i ) {
+            for ( int j = 0; j + 1 < n; ++j ) {
+                const uint32_t a = i * n + j;
+                const uint32_t b = a + 1;
+                const uint32_t c = a + n;
+                const uint32_t d = c + 1;
+                const uint32_t quad[6] = { a, b, c, c, b, d };
+                indices.insert( indices.end(), quad, quad + 6 );
+            }
+        }
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( TransparencySorter_KeysPutTheFarEndFirst )
+{
+    const unsigned int nearest = ( 1u << TransparencySorter::DepthBits ) - 1;
+
+    CHECK( TransparencySorter::QuantizeDepth( 1000.f, 1.f, 1000.f ) == 0 );
+    CHECK( TransparencySorter::QuantizeDepth( 1.f, 1.f, 1000.f ) == nearest );
+    CHECK( TransparencySorter::QuantizeDepth( 500.f, 1.f, 1000.f ) > TransparencySorter::QuantizeDepth( 501.f, 1.f, 1000.f ) );
+
+    // Out of range and NaN depths are clamped.
+    CHECK( TransparencySorter::QuantizeDepth( 5000.f, 1.f, 1000.f ) == 0 );
+    CHECK( TransparencySorter::QuantizeDepth( -5.f, 1.f, 1000.f ) == nearest );
+    CHECK( TransparencySorter::QuantizeDepth( std::nanf( "" ), 1.f, 1000.f ) == nearest );
+
+    // Depth outranks state.
+    CHECK( TransparencySorter::MakeKey( 1, 0 ) > TransparencySorter::MakeKey( 0, 0xFFFF ) );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( TransparencySorter_SortsBackToFront )
+{
+    JobSystem jobs( 3 );
+    std::mt19937 rng( 7 );
+    std::uniform_real_distribution<float> unit( -1.f, 1.f );
+
+    const XMMATRIX view = DemoView();
+    XMFLOAT4X4 viewRows;
+    XMStoreFloat4x4( &viewRows, view );
+
+    // Enough draws for the parallel sort; every fourth strip is another
+    // object, so few merge.
+    const unsigned int Count = 50000;
+    std::vector<XMFLOAT3> centers( Count );
+    for ( auto& c : centers ) {
+        c = XMFLOAT3( 80.f * unit( rng ), 10.f * unit( rng ), 80.f * unit( rng ) );
+    }
+
+    TransparencySorter sorter;
+    for ( int parallel = 0; parallel < 2; ++parallel ) {
+        sorter.Begin( view, 1.f, 1000.f );
+        for ( unsigned int i = 0; i < Count; ++i ) {
+            sorter.Submit( MakeStrip( i, i % 4 ), centers[i], i % 4 );
+        }
+        sorter.Sort( parallel ? &jobs : nullptr );
+
+        const RenderQueue& queue = sorter.GetQueue();
+        CHECK( sorter.GetStats().items == Count );
+        CHECK( sorter.GetStats().draws == queue.GetSize() );
+
+        float previous = 1e30f;
+        bool backToFront = true;
+        size_t indices = 0;
+        for ( size_t i = 0; i < queue.GetSize(); ++i ) {
+            const RenderItem& item = queue.GetItem( i );
+            indices += item.indexCount;
+
+            const float z = std::max( ViewDepth( viewRows, centers[item.startIndex / 6] ), 1.f );
+            backToFront = backToFront && z <= previous + 1e-4f;
+            previous = z;
+        }
+        CHECK( backToFront );
+
+        // Merging loses nothing.
+        CHECK( indices == 6u * Count );
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( TransparencySorter_MergesRunsThatCarryOn )
+{
+    const XMMATRIX view = DemoView();
+    TransparencySorter sorter;
+
+    // Strips of one buffer, each further from the eye than the last: sorted
+    // back to front they run backwards through the buffer and stay apart.
+    sorter.Begin( view, 1.f, 1000.f );
+    for ( unsigned int i = 0; i < 10; ++i ) {
+        const float t = 1.f - 0.05f * i;
+        sorter.Submit( MakeStrip( i, 0 ), XMFLOAT3( Eye.x * t, Eye.y * t, Eye.z * t ), 0 );
+    }
+    sorter.Sort( nullptr );
+    CHECK( sorter.GetStats().draws == 10 );
+
+    // Each nearer than the last: they sort in buffer order and become one
+    // draw of all sixty indices.
+    sorter.Begin( view, 1.f, 1000.f );
+    for ( unsigned int i = 0; i < 10; ++i ) {
+        const float t = 0.05f * i;
+        sorter.Submit( MakeStrip( i, 0 ), XMFLOAT3( Eye.x * t, Eye.y * t, Eye.z * t ), 0 );
+    }
+    sorter.Sort( nullptr );
+    CHECK( sorter.GetStats().draws == 1 );
+    CHECK( sorter.GetQueue().GetItem( 0 ).indexCount == 60 );
+    CHECK( sorter.GetQueue().GetItem( 0 ).startIndex == 0 );
+
+    // Another object in the middle breaks the run in three.
+    sorter.Begin( view, 1.f, 1000.f );
+    for ( unsigned int i = 0; i < 4; ++i ) {
+        const float t = 0.1f * i;
+        sorter.Submit( MakeStrip( i, i == 2 ? 1 : 0 ), XMFLOAT3( Eye.x * t, Eye.y * t, Eye.z * t ), 0 );
+    }
+    sorter.Sort( nullptr );
+    CHECK( sorter.GetStats().draws == 3 );
+
+    RenderCommandLog log;
+    sorter.Execute( log );
+    size_t draws = 0;
+    for ( const RenderCommandLog::Command& command : log.GetCommands() ) {
+        draws += command.type == RenderCommandLog::DrawItem ? 1 : 0;
+    }
+    CHECK( draws == 3 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( TransparencySorter_SortTrianglesBackToFront )
+{
+    JobSystem jobs( 3 );
+
+    std::vector<XMFLOAT3> positions;
+    std::vector<uint32_t> indices;
+    MakeWaves( 160, positions, indices );
+    const size_t triangleCount = indices.size() / 3;
+
+    const XMMATRIX view = DemoView();
+    XMFLOAT4X4 viewRows;
+    XMStoreFloat4x4( &viewRows, view );
+
+    TransparencySorter sorter;
+    std::vector<uint32_t> serial( indices.size() );
+    std::vector<uint32_t> parallel( indices.size() );
+
+    sorter.Begin( view, 1.f, 1000.f );
+    sorter.SortTriangles( positions.data(), indices.data(), triangleCount, view, nullptr, serial.data() );
+    sorter.SortTriangles( positions.data(), indices.data(), triangleCount, view, &jobs, parallel.data() );
+    CHECK( sorter.GetStats().triangles == 2 * triangleCount );
+
+    // The same order either way, the furthest centre first.
+    CHECK( serial == parallel );
+
+    float previous = 1e30f;
+    bool backToFront = true;
+    for ( size_t t = 0; t < triangleCount; ++t ) {
+        XMFLOAT3 center( 0.f, 0.f, 0.f );
+        for ( int k = 0; k < 3; ++k ) {
+            const XMFLOAT3& p = positions[serial[3 * t + k]];
+            center = XMFLOAT3( center.x + p.x / 3.f, center.y + p.y / 3.f, center.z + p.z / 3.f );
+        }
+        const float z = ViewDepth( viewRows, center );
+        backToFront = backToFront && z <= previous + 1e-3f;
+        previous = z;
+    }
+    CHECK( backToFront );
+
+    // Whole triangles are moved, none lost: each output triangle is one
+    // of the input's, with its winding.
+    std::vector<uint64_t> before, after;
+    for ( size_t t = 0; t < triangleCount; ++t ) {
+        before.push_back( ( uint64_t( indices[3 * t] ) << 42 ) | ( uint64_t( indices[3 * t + 1] ) << 21 ) | indices[3 * t + 2] );
+        after.push_back( ( uint64_t( serial[3 * t] ) << 42 ) | ( uint64_t( serial[3 * t + 1] ) << 21 ) | serial[3 * t + 2] );
+    }
+    std::sort( before.begin(), before.end() );
+    std::sort( after.begin(), after.end() );
+    CHECK( before == after );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+// The Waves demo's grid and a denser one, sorted serially and on the
+// shared job system.
+BENCHMARK( TransparencySorter_SortTriangles )
+{
+    const XMMATRIX view = DemoView();
+    TransparencySorter sorter;
+
+    const int sizes[] = { 160, 512 };
+    for ( const int n : sizes ) {
+        std::vector<XMFLOAT3> positions;
+        std::vector<uint32_t> indices;
+        MakeWaves( n, positions, indices );
+        const size_t triangleCount = indices.size() / 3;
+        std::vector<uint32_t> sorted( indices.size() );
+
+        for ( int parallel = 0; parallel < 2; ++parallel ) {
+            const int Repeats = 10;
+            const double ms = Test::TimeMs( [&]() {
+                for ( int r = 0; r < Repeats; ++r ) {
+                    sorter.SortTriangles( positions.data(), indices.data(), triangleCount, view,
+                                          parallel ? &JobSystem::Instance() : nullptr, sorted.data() );
+                }
+            } ) / Repeats;
+            std::printf( "    %7zu triangles (%s): %.2f ms\n", triangleCount, parallel ? "jobs  " : "serial", ms );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,238 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file VegetationTests.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <algorithm>
+#include <set>
+#include <utility>
+
+#include <DirectXMath.h>
+
+#include "JobSystem.h"
+#include "Vegetation.h"
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    float Height( float x, float z )
+    {
+        return 0.3f * ( z * std::sin( 0.1f * x ) + x * std::cos( 0.1f * z ) );
+    }
+
+    // A 90 degree frustum looking down +z from eye, planes facing in.
+    void LookDownZ( const XMFLOAT3& eye, const float farZ, XMFLOAT4 planes[6] )
+    {
+        const float s = 1.f / std::sqrt( 2.f );
+        planes[0] = XMFLOAT4( s, 0.f, s, -( s * eye.x + s * eye.z ) );
+        planes[1] = XMFLOAT4( -s, 0.f, s, -( -s * eye.x + s * eye.z ) );
+        planes[2] = XMFLOAT4( 0.f, s, s, -( s * eye.y + s * eye.z ) );
+        planes[3] = XMFLOAT4( 0.f, -s, s, -( -s * eye.y + s * eye.z ) );
+        planes[4] = XMFLOAT4( 0.f, 0.f, 1.f, -( eye.z + 1.f ) );
+        planes[5] = XMFLOAT4( 0.f, 0.f, -1.f, eye.z + farZ );
+    }
+
+    // What Gather() should keep: in range, and the sprite's box not
+    // wholly outside a plane.
+    bool ShouldShow( const VegetationSprite& tree, const XMFLOAT4 planes[6], const XMFLOAT3& eye, const float fadeEnd )
+    {
+        const float dx = tree.pos.x - eye.x;
+        const float dy = tree.pos.y - eye.y;
+        const float dz = tree.pos.z - eye.z;
+        if ( dx * dx + dy * dy + dz * dz > fadeEnd * fadeEnd ) {
+            return false;
+        }
+
+        const float halfWidth = 0.5f * tree.size.x;
+        const float halfHeight = 0.5f * tree.size.y;
+        for ( int i = 0; i < 6; ++i ) {
+            const XMFLOAT4& p = planes[i];
+            const float extent = halfWidth * ( std::fabs( p.x ) + std::fabs( p.z ) ) + halfHeight * std::fabs( p.y );
+            if ( p.x * tree.pos.x + p.y * tree.pos.y + p.z * tree.pos.z + p.w < -extent ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Gathers and checks against the brute force answer: the same trees,
+    // nearest first, shrunk towards their base by the fade.
+    void CheckGather( Vegetation& vegetation, const Vegetation::Desc& desc,
+                      const XMFLOAT3& eye, const float fadeStart, const float fadeEnd, JobSystem* jobs )
+    {
+        XMFLOAT4 planes[6];
+        LookDownZ( eye, 5000.f, planes );
+
+        std::vector<VegetationSprite> sprites;
+        vegetation.Gather( planes, eye, fadeStart, fadeEnd, sprites, jobs );
+
+        std::multiset<std::pair<float, float>> expected;
+        for ( const VegetationSprite& tree : vegetation.GetTrees() ) {
+            if ( ShouldShow( tree, planes, eye, fadeEnd ) ) {
+                expected.insert( std::make_pair( tree.pos.x, tree.pos.z ) );
+            }
+        }
+
+        std::multiset<std::pair<float, float>> gathered;
+        float lastDistanceSq = -1.f;
+        for ( const VegetationSprite& sprite : sprites ) {
+            gathered.insert( std::make_pair( sprite.pos.x, sprite.pos.z ) );
+
+            // Undo the fade to find the tree's own center.
+            const float base = sprite.pos.y - 0.5f * sprite.size.y;
+            const float dx = sprite.pos.x - eye.x;
+            const float dy = base + 0.5f * desc.size.y - eye.y;
+            const float dz = sprite.pos.z - eye.z;
+            const float distanceSq = dx * dx + dy * dy + dz * dz;
+            CHECK( distanceSq >= lastDistanceSq * ( 1.f - 1e-5f ) );
+            lastDistanceSq = distanceSq;
+
+            const float fade = std::min( 1.f, std::max( 0.f, ( fadeEnd - std::sqrt( distanceSq ) ) / ( fadeEnd - fadeStart ) ) );
+            CHECK_NEAR( sprite.size.x, desc.size.x * fade, 1e-3f );
+
+            const float ground = Height( sprite.pos.x, sprite.pos.z ) + desc.centerHeight - 0.5f * desc.size.y;
+            CHECK_NEAR( base, ground, 1e-2f * std::max( 1.f, std::fabs( base ) ) );
+        }
+
+        CHECK( gathered == expected );
+    }
+
+    // About treeCount trees at a spacing of 4.
+    Vegetation::Desc LargeForest( const size_t treeCount )
+    {
+        const float half = std::sqrt( float( treeCount ) ) * 2.9f;
+
+        Vegetation::Desc desc;
+        desc.minX = -half;
+        desc.maxX = half;
+        desc.minZ = -half;
+        desc.maxZ = half;
+        desc.spacing = 4.f;
+        desc.cellSize = 64.f;
+        desc.maxTrees = treeCount;
+        desc.seed = 7;
+        return desc;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( Vegetation_PlaceKeepsTreesApart )
+{
+    Vegetation::Desc desc;
+    desc.minX = -75.f;
+    desc.maxX = 75.f;
+    desc.minZ = -75.f;
+    desc.maxZ = 75.f;
+    desc.spacing = 6.f;
+    desc.cellSize = 25.f;
+    desc.minHeight = -2.f;
+
+    Vegetation vegetation;
+    vegetation.Place( desc, Height );
+
+    const std::vector<VegetationSprite>& trees = vegetation.GetTrees();
+    CHECK( trees.size() > 200 );
+
+    float closestSq = 1e9f;
+    for ( size_t i = 0; i < trees.size(); ++i ) {
+        for ( size_t j = i + 1; j < trees.size(); ++j ) {
+            const float dx = trees[i].pos.x - trees[j].pos.x;
+            const float dz = trees[i].pos.z - trees[j].pos.z;
+            closestSq = std::min( closestSq, dx * dx + dz * dz );
+        }
+    }
+    CHECK( std::sqrt( closestSq ) >= desc.spacing - 1e-4f );
+
+    for ( const VegetationSprite& tree : trees ) {
+        CHECK( Height( tree.pos.x, tree.pos.z ) >= desc.minHeight );
+        CHECK( tree.pos.x >= desc.minX && tree.pos.x < desc.maxX );
+        CHECK( tree.pos.z >= desc.minZ && tree.pos.z < desc.maxZ );
+    }
+
+    Vegetation::Desc capped = desc;
+    capped.maxTrees = 100;
+    Vegetation few;
+    few.Place( capped, Height );
+    CHECK( few.GetTreeCount() == 100 );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+TEST_CASE( Vegetation_GatherMatchesBruteForce )
+{
+    Vegetation::Desc desc;
+    desc.minX = -75.f;
+    desc.maxX = 75.f;
+    desc.minZ = -75.f;
+    desc.maxZ = 75.f;
+    desc.spacing = 6.f;
+    desc.cellSize = 25.f;
+    desc.minHeight = -2.f;
+
+    Vegetation vegetation;
+    vegetation.Place( desc, Height );
+
+    CheckGather( vegetation, desc, XMFLOAT3( 0.f, 20.f, -100.f ), 60.f, 150.f, nullptr );
+    CheckGather( vegetation, desc, XMFLOAT3( 10.f, 5.f, 0.f ), 20.f, 40.f, nullptr );
+    CheckGather( vegetation, desc, XMFLOAT3( 10.f, 5.f, 0.f ), 40.f, 40.f, nullptr );
+
+    // Enough trees for Gather() to go parallel, which must not change the
+    // answer.
+    const Vegetation::Desc large = LargeForest( 2 * Vegetation::ParallelThreshold );
+    Vegetation forest;
+    forest.Place( large, Height );
+
+    JobSystem jobs( 3 );
+    const XMFLOAT3 eye( 0.f, 30.f, 0.5f * large.minZ );
+    CheckGather( forest, large, eye, 300.f, 600.f, nullptr );
+    CheckGather( forest, large, eye, 300.f, 600.f, &jobs );
+    CheckGather( forest, large, eye, 1e5f, 2e5f, &jobs );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+// Places a million trees and gathers everything in view, on the calling
+// thread and then on the shared job system.
+BENCHMARK( Vegetation_MillionTrees )
+{
+    const Vegetation::Desc desc = LargeForest( 1000000 );
+
+    Vegetation vegetation;
+    const double placeMs = Test::TimeMs( [&]() { vegetation.Place( desc, Height ); } );
+    std::printf( "    place: %zu trees in %zu cells, %.1f ms\n", vegetation.GetTreeCount(), vegetation.GetCellCount(), placeMs );
+
+    const XMFLOAT3 eye( 0.f, 30.f, 0.5f * desc.minZ );
+    XMFLOAT4 planes[6];
+    LookDownZ( eye, 5000.f, planes );
+
+    // Near range (most cells culled by distance) and everything in the
+    // frustum (the worst case).
+    const float ranges[2][2] = { { 300.f, 600.f }, { 1e5f, 2e5f } };
+
+    std::vector<VegetationSprite> sprites;
+    for ( const auto& range : ranges ) {
+        for ( int parallel = 0; parallel < 2; ++parallel ) {
+            JobSystem* jobs = parallel ? &JobSystem::Instance() : nullptr;
+
+            const int Repeats = 10;
+            const double ms = Test::TimeMs( [&]() {
+                for ( int r = 0; r < Repeats; ++r ) {
+                    vegetation.Gather( planes, eye, range[0], range[1], sprites, jobs );
+                }
+            } ) / Repeats;
+
+            const Vegetation::Stats& stats = vegetation.GetStats();
+            std::printf( "    gather to %6.0f (%s): %7zu sprites, %5zu of %5zu cells, %.2f ms\n",
+                         range[1], parallel ? "jobs  " : "serial", sprites.size(),
+                         stats.cellsVisible, stats.cellsTested, ms );
+        }
+    }
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
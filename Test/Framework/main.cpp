@@ -0,0 +1,97 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file main.cpp
+// Runs the Framework's headless tests, and with -bench the benchmarks too.
+// A name on the command line runs only the cases whose name contains it.
+// Returns the number of failed cases.
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "Test.h"
+
+#include <cstring>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    int gFailures = 0;
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+std::vector<Test::Case>& Test::Registry( void )
+{
+    static std::vector<Case> registry;
+    return registry;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+Test::Registrar::Registrar( const char* name, Function function, bool benchmark )
+{
+    Case entry = { name, function, benchmark };
+    Registry().push_back( entry );
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+void Test::Fail( const char* file, const int line, const char* expression )
+{
+    // Stop a broken case from flooding the output.
+    if ( gFailures < 10 ) {
+        std::printf( "    %s(%d): CHECK( %s ) failed\n", file, line, expression );
+    }
+    ++gFailures;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+int Test::FailureCount( void )
+{
+    return gFailures;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+int main( int argc, char** argv )
+{
+    bool runBenchmarks = false;
+    const char* filter = nullptr;
+
+    for ( int i = 1; i < argc; ++i ) {
+        if ( std::strcmp( argv[i], "-bench" ) == 0 ) {
+            runBenchmarks = true;
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    int failedCases = 0;
+    int ranCases = 0;
+
+    for ( const Test::Case& entry : Test::Registry() ) {
+        if ( entry.benchmark && !runBenchmarks ) {
+            continue;
+        }
+        if ( filter != nullptr && std::strstr( entry.name, filter ) == nullptr ) {
+            continue;
+        }
+
+        std::printf( "%s %s\n", entry.benchmark ? "[bench]" : "[test ]", entry.name );
+
+        gFailures = 0;
+        entry.function();
+        ++ranCases;
+
+        if ( gFailures > 0 ) {
+            std::printf( "    FAILED with %d failed checks\n", gFailures );
+            ++failedCases;
+        }
+    }
+
+    std::printf( "%d of %d cases passed\n", ranCases - failedCases, ranCases );
+
+    return failedCases;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -0,0 +1,391 @@
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+/// \file main.cpp
+///
+/// TexBuild: offline mip generation and block compression for demo assets.
+///
+///   TexBuild [-f bc1|bc3|bc5|bc7|rgba] [-srgb] [-filter box|kaiser]
+///            [-mips N] input.dds output.dds
+///
+/// The input is an uncompressed 8-bit RGBA or BGRA DDS (2D, array or cube);
+/// only the top mip of each item is read and the chain is rebuilt. The output
+/// always has a DX10 header. Defaults: bc7, box filter, full chain; -srgb is
+/// implied by an _SRGB input format.
+///
+/// It needs no device and no Windows APIs, so it also runs on build machines:
+///
+///   cl /EHsc /O2 /std:c++14 /I%D3D11_FRAMEWORK% main.cpp
+///      %D3D11_FRAMEWORK%\JobSystem.cpp %D3D11_FRAMEWORK%\MipGenerator.cpp
+///      %D3D11_FRAMEWORK%\BlockCompressor.cpp
+///      %D3D11_FRAMEWORK%\DirectXTex\DDSTextureLoader\DDSParser.cpp
+///
+///   g++ -std=c++14 -O2 -pthread -I../../Framework -I<DirectXMath>/Inc
+///       -I<DirectX-Headers>/include/directx -I<DirectX-Headers>/include/wsl/stubs
+///       main.cpp ../../Framework/{JobSystem,MipGenerator,BlockCompressor}.cpp
+///       ../../Framework/DirectXTex/DDSTextureLoader/DDSParser.cpp
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+#include "BlockCompressor.h"
+#include "MipGenerator.h"
+
+#include <DirectXTex/DDSTextureLoader/DDSParser.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+using namespace DirectX;
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+namespace {
+
+    struct Options {
+        Options( void )
+            : rgba( false )
+            , format( BlockCompressor::BC7 )
+            , srgb( false )
+            , filter( MipGenerator::Box )
+            , mips( 0 )
+        {
+        }
+
+        bool rgba;  // Uncompressed output instead of format.
+        BlockCompressor::Format format;
+        bool srgb;
+        MipGenerator::Filter filter;
+        unsigned int mips;
+        std::string input;
+        std::string output;
+    };
+
+    // Byte order of an uncompressed input format.
+    struct Layout {
+        bool valid;
+        bool bgr;
+        bool opaque;  // X8: alpha is undefined and read as 1.
+        bool srgb;
+    };
+
+    Layout GetLayout( const DXGI_FORMAT format )
+    {
+        Layout layout = { true, false, false, false };
+
+        switch ( format ) {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+            break;
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            layout.srgb = true;
+            break;
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+            layout.bgr = true;
+            break;
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            layout.bgr = layout.srgb = true;
+            break;
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+            layout.bgr = layout.opaque = true;
+            break;
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+            layout.bgr = layout.opaque = layout.srgb = true;
+            break;
+        default:
+            layout.valid = false;
+            break;
+        }
+
+        return layout;
+    }
+
+    DXGI_FORMAT GetOutputFormat( const Options& options )
+    {
+        if ( options.rgba ) {
+            return options.srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+        }
+
+        switch ( options.format ) {
+        case BlockCompressor::BC1:
+            return options.srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+        case BlockCompressor::BC3:
+            return options.srgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+        case BlockCompressor::BC5:
+            return DXGI_FORMAT_BC5_UNORM;
+        case BlockCompressor::BC7:
+        default:
+            return options.srgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+        }
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    MipGenerator::Image LoadImage( const DDS::Subresource& subresource, const Layout& layout )
+    {
+        MipGenerator::Image image( static_cast<unsigned int>( subresource.width ),
+                                   static_cast<unsigned int>( subresource.height ) );
+
+        for ( unsigned int y = 0; y < image.height; ++y ) {
+            const uint8_t* in = subresource.data + y * subresource.rowPitch;
+            for ( unsigned int x = 0; x < image.width; ++x, in += 4 ) {
+                XMFLOAT4& texel = image.at( x, y );
+                texel.x = in[layout.bgr ? 2 : 0] / 255.0f;
+                texel.y = in[1] / 255.0f;
+                texel.z = in[layout.bgr ? 0 : 2] / 255.0f;
+                texel.w = layout.opaque ? 1.0f : in[3] / 255.0f;
+            }
+        }
+
+        return image;
+    }
+
+    std::vector<uint8_t> ToRGBA8( const MipGenerator::Image& image )
+    {
+        std::vector<uint8_t> rgba( image.texels.size() * 4 );
+
+        for ( size_t i = 0; i < image.texels.size(); ++i ) {
+            const float channels[4] = { image.texels[i].x, image.texels[i].y, image.texels[i].z, image.texels[i].w };
+            for ( int c = 0; c < 4; ++c ) {
+                const float v = channels[c] < 0.0f ? 0.0f : ( channels[c] > 1.0f ? 1.0f : channels[c] );
+                rgba[i * 4 + c] = static_cast<uint8_t>( v * 255.0f + 0.5f );
+            }
+        }
+
+        return rgba;
+    }
+
+    // Squared error over the channels the format keeps. BC1 drops the color
+    // of texels below half alpha, so those are left out when cutout is set.
+    double SquaredError( const std::vector<uint8_t>& a, const std::vector<uint8_t>& b,
+                         const int channels, const bool cutout, size_t& samples )
+    {
+        double sum = 0.0;
+        for ( size_t i = 0; i < a.size(); i += 4 ) {
+            if ( cutout && a[i + 3] < 128 ) {
+                continue;
+            }
+            for ( int c = 0; c < channels; ++c ) {
+                const double d = static_cast<double>( a[i + c] ) - static_cast<double>( b[i + c] );
+                sum += d * d;
+            }
+            samples += channels;
+        }
+        return sum;
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    bool WriteDDS( const std::string& filename,
+                   const DDS::TextureInfo& info,
+                   const DXGI_FORMAT format,
+                   const size_t mipCount,
+                   const std::vector<std::vector<uint8_t>>& surfaces,
+                   const size_t linearSize )
+    {
+        std::ofstream file( filename.c_str(), std::ios::binary );
+        if ( !file ) {
+            return false;
+        }
+
+        DDS_HEADER header;
+        std::memset( &header, 0, sizeof( header ) );
+        header.size = sizeof( DDS_HEADER );
+        header.flags = 0x1 | DDS_HEIGHT | DDS_WIDTH | 0x1000 | 0x20000 | 0x80000; // CAPS, PIXELFORMAT, MIPMAPCOUNT, LINEARSIZE
+        header.height = static_cast<uint32_t>( info.height );
+        header.width = static_cast<uint32_t>( info.width );
+        header.pitchOrLinearSize = static_cast<uint32_t>( linearSize );
+        header.mipMapCount = static_cast<uint32_t>( mipCount );
+        header.ddspf.size = sizeof( DDS_PIXELFORMAT );
+        header.ddspf.flags = DDS_FOURCC;
+        header.ddspf.fourCC = MAKEFOURCC( 'D', 'X', '1', '0' );
+        header.caps = 0x1000 | ( mipCount > 1 ? 0x400008 : 0 ); // TEXTURE, MIPMAP | COMPLEX
+        header.caps2 = info.isCubeMap ? DDS_CUBEMAP_ALLFACES : 0;
+
+        DDS_HEADER_DXT10 dx10;
+        std::memset( &dx10, 0, sizeof( dx10 ) );
+        dx10.dxgiFormat = format;
+        dx10.resourceDimension = DDS::RESOURCE_DIMENSION_TEXTURE2D;
+        dx10.miscFlag = info.isCubeMap ? 0x4 : 0; // D3D11_RESOURCE_MISC_TEXTURECUBE
+        dx10.arraySize = static_cast<uint32_t>( info.isCubeMap ? info.arraySize / 6 : info.arraySize );
+
+        file.write( reinterpret_cast<const char*>( &DDS_MAGIC ), sizeof( DDS_MAGIC ) );
+        file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+        file.write( reinterpret_cast<const char*>( &dx10 ), sizeof( dx10 ) );
+
+        for ( auto& surface : surfaces ) {
+            file.write( reinterpret_cast<const char*>( surface.data() ), surface.size() );
+        }
+
+        return static_cast<bool>( file );
+    }
+
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+    int Usage( void )
+    {
+        std::fprintf( stderr,
+                      "usage: TexBuild [-f bc1|bc3|bc5|bc7|rgba] [-srgb] [-filter box|kaiser] [-mips N] input.dds output.dds\n" );
+        return 1;
+    }
+
+    bool ParseOptions( const int argc, char* argv[], Options& options )
+    {
+        std::vector<std::string> files;
+
+        for ( int i = 1; i < argc; ++i ) {
+            const std::string arg = argv[i];
+
+            if ( arg == "-f" && i + 1 < argc ) {
+                const std::string value = argv[++i];
+                if ( value == "bc1" ) options.format = BlockCompressor::BC1;
+                else if ( value == "bc3" ) options.format = BlockCompressor::BC3;
+                else if ( value == "bc5" ) options.format = BlockCompressor::BC5;
+                else if ( value == "bc7" ) options.format = BlockCompressor::BC7;
+                else if ( value == "rgba" ) options.rgba = true;
+                else return false;
+            }
+            else if ( arg == "-srgb" ) {
+                options.srgb = true;
+            }
+            else if ( arg == "-filter" && i + 1 < argc ) {
+                const std::string value = argv[++i];
+                if ( value == "box" ) options.filter = MipGenerator::Box;
+                else if ( value == "kaiser" ) options.filter = MipGenerator::Kaiser;
+                else return false;
+            }
+            else if ( arg == "-mips" && i + 1 < argc ) {
+                options.mips = static_cast<unsigned int>( std::strtoul( argv[++i], nullptr, 10 ) );
+            }
+            else if ( !arg.empty() && arg[0] != '-' ) {
+                files.push_back( arg );
+            }
+            else {
+                return false;
+            }
+        }
+
+        if ( files.size() != 2 ) {
+            return false;
+        }
+
+        options.input = files[0];
+        options.output = files[1];
+        return true;
+    }
+
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+int main( int argc, char* argv[] )
+{
+    Options options;
+    if ( !ParseOptions( argc, argv, options ) ) {
+        return Usage();
+    }
+
+    std::wstring inputName( options.input.size(), L'\0' );
+    inputName.resize( std::mbstowcs( &inputName[0], options.input.c_str(), options.input.size() ) );
+
+    DDS::MappedFile file;
+    if ( file.Open( inputName.c_str() ) != DDS::Result::Ok ) {
+        std::fprintf( stderr, "%s: cannot open (error %u)\n", options.input.c_str(), file.SystemError() );
+        return 1;
+    }
+
+    DDS::TextureInfo info;
+    std::vector<DDS::Subresource> subresources;
+    if ( DDS::ParseHeader( file.Data(), file.Size(), info ) != DDS::Result::Ok ||
+         DDS::EnumerateSubresources( info, 0, subresources ) != DDS::Result::Ok ) {
+        std::fprintf( stderr, "%s: not a valid DDS file\n", options.input.c_str() );
+        return 1;
+    }
+
+    const Layout layout = GetLayout( info.format );
+    if ( !layout.valid || info.resDim != DDS::RESOURCE_DIMENSION_TEXTURE2D ) {
+        std::fprintf( stderr, "%s: expected an uncompressed 8-bit RGBA or BGRA 2D texture\n", options.input.c_str() );
+        return 1;
+    }
+
+    if ( layout.srgb ) {
+        options.srgb = true;
+    }
+    if ( options.srgb && !options.rgba && options.format == BlockCompressor::BC5 ) {
+        std::fprintf( stderr, "warning: BC5 has no sRGB format; filtering in linear space\n" );
+        options.srgb = false;
+    }
+
+    const DXGI_FORMAT outputFormat = GetOutputFormat( options );
+    const int errorChannels = ( !options.rgba && options.format == BlockCompressor::BC5 ) ? 2 : 3;
+
+    std::vector<std::vector<uint8_t>> surfaces;
+    size_t mipCount = 0;
+    size_t outputBytes = 0;
+    double squaredError = 0.0;
+    size_t errorSamples = 0;
+
+    for ( size_t item = 0; item < info.arraySize; ++item ) {
+        const DDS::Subresource& top = subresources[item * info.mipCount];
+        const std::vector<MipGenerator::Image> chain =
+            MipGenerator::Generate( LoadImage( top, layout ), options.filter, options.srgb, options.mips );
+
+        mipCount = chain.size();
+
+        for ( size_t level = 0; level < chain.size(); ++level ) {
+            const MipGenerator::Image& image = chain[level];
+            std::vector<uint8_t> rgba = ToRGBA8( image );
+
+            if ( options.rgba ) {
+                surfaces.push_back( rgba );
+            }
+            else {
+                std::vector<uint8_t> blocks( BlockCompressor::SurfaceBytes( options.format, image.width, image.height ) );
+                BlockCompressor::Compress( options.format, rgba.data(), image.width, image.height, image.width * 4, blocks.data() );
+
+                if ( level == 0 ) {
+                    std::vector<uint8_t> decoded( rgba.size() );
+                    BlockCompressor::Decompress( options.format, blocks.data(), image.width, image.height,
+                                                 decoded.data(), image.width * 4 );
+                    squaredError += SquaredError( rgba, decoded, errorChannels,
+                                                  options.format == BlockCompressor::BC1, errorSamples );
+                }
+
+                surfaces.push_back( std::move( blocks ) );
+            }
+
+            outputBytes += surfaces.back().size();
+        }
+    }
+
+    const size_t linearSize = options.rgba ? info.width * 4
+                                           : BlockCompressor::SurfaceBytes( options.format,
+                                                                            static_cast<unsigned int>( info.width ),
+                                                                            static_cast<unsigned int>( info.height ) );
+
+    if ( !WriteDDS( options.output, info, outputFormat, mipCount, surfaces, linearSize ) ) {
+        std::fprintf( stderr, "%s: cannot write\n", options.output.c_str() );
+        return 1;
+    }
+
+    std::printf( "%s: %zux%zu x%zu, %zu mips, %zu -> %zu bytes (%.2f:1)",
+                 options.output.c_str(), info.width, info.height, info.arraySize, mipCount,
+                 info.bitSize, outputBytes, static_cast<double>( info.bitSize ) / static_cast<double>( outputBytes ) );
+
+    if ( errorSamples > 0 ) {
+        const double mse = squaredError / static_cast<double>( errorSamples );
+        if ( mse > 0.0 ) {
+            std::printf( ", top mip PSNR %.2f dB", 10.0 * std::log10( 255.0 * 255.0 / mse ) );
+        }
+        else {
+            std::printf( ", lossless" );
+        }
+    }
+    std::printf( "\n" );
+
+    return 0;
+}
+
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //